@@ -12,6 +12,7 @@ public:
   // static constexpr int32_t NOT_CONNECTED = 0x80040407;
   // static constexpr int32_t DRIVER_ERROR = 0x80040500;
   // static constexpr int32_t INVALID_OPERATION = 0x8004040B;
+  // static constexpr int32_t ACTION_NOT_IMPLEMENTED = 0x8004040C;
   // static constexpr int32_t UNSPECIFIED_ERROR = 0x800404FF;
 
   static constexpr int32_t NOT_IMPLEMENTED = 0x400;
@@ -19,6 +20,7 @@ public:
   static constexpr int32_t NOT_CONNECTED = 0x407;
   static constexpr int32_t DRIVER_ERROR = 0x500;
   static constexpr int32_t INVALID_OPERATION = 0x40B;
+  static constexpr int32_t ACTION_NOT_IMPLEMENTED = 0x40C;
   static constexpr int32_t UNSPECIFIED_ERROR = 0x4FF;
 
   alpaca_exception(const int32_t error_code, std::string error_message);
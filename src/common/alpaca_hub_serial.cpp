@@ -12,78 +12,65 @@ std::vector<std::string> split(const std::string &input,
 
 namespace alpaca_hub_serial {
 
-blocking_reader::blocking_reader(const std::string &command,
-                                 asio::serial_port &port, size_t timeout,
-                                 asio::io_context &io_ctx,
-                                 bool warn_on_serial_timeout)
-    : port(port), timeout(timeout), _io_ctx(io_ctx), timer(port.get_executor()),
-      read_error(true), _command(command),
-      _warn_on_serial_timeout(warn_on_serial_timeout) {}
-
-void blocking_reader::read_complete(const asio::error_code &error,
-                                    size_t bytes_transferred) {
-  // spdlog::trace("read_complete invoked: msg: {0}", error.message());
-  // spdlog::trace("  bytes read:               {0}", bytes_transferred);
-
-  if (error.message() != "Success") {
-    read_error = true;
-    return;
-  } else {
-    read_error = false;
-    // reset the timer
-    // timer.expires_from_now(std::chrono::milliseconds(timeout));
-  }
-  // Read has finished, so cancel the
-  // timer.
-  // spdlog::trace("canceling timer in read_complete");
-  timer.cancel();
-}
-
-// Called when the timer's deadline expires.
-void blocking_reader::time_out(const asio::error_code &error) {
-  // Was the timeout was cancelled?
-  // spdlog::trace("time_out invoked {0}", error.message());
-  if (error.message() != "Success") {
-    // yes
-    return;
-  }
-  // no, we have timed out, so kill
-  // the read operation
-  // The read callback will be called
-  // with an error
-  if (_warn_on_serial_timeout)
+void log_serial_timeout(const std::string &command, bool warn) {
+  if (warn)
     spdlog::warn(
-        "calling port.cancel() - ensure that all serial commands are "
+        "serial read timed out - ensure that all serial commands are "
         "explicit if they expect a response or not. Command associated: {}",
-        _command);
+        command);
   else
-    spdlog::trace("Serial timeout for cmd: \"{}\"", _command);
-  port.cancel();
+    spdlog::trace("Serial timeout for cmd: \"{}\"", command);
 }
 
-bool blocking_reader::read_char(char &val) {
-  using namespace std::chrono_literals;
+frame_reader::frame_reader(asio::serial_port &port, asio::io_context &io_ctx,
+                           bool warn_on_serial_timeout,
+                           size_t initial_capacity)
+    : _port(port), _io_ctx(io_ctx),
+      _warn_on_serial_timeout(warn_on_serial_timeout), _rx(initial_capacity) {}
 
-  val = c = '\0';
-  // After a timeout & cancel we need
-  // to do a reset for subsequent reads to work.
-  _io_ctx.reset();
-  // Asynchronously read 1 character.
-  port.async_read_some(asio::buffer(&c, 1),
-                       std::bind(&blocking_reader::read_complete, this,
-                                 std::placeholders::_1, std::placeholders::_2));
+bool frame_reader::fill(clock_t::time_point deadline,
+                        const std::string &command) {
+  bool completed = false;
+  asio::error_code read_error;
+  size_t bytes_read = 0;
 
-  // Setup a deadline time to implement our timeout.
-  timer.expires_from_now(std::chrono::milliseconds(timeout));
-  timer.async_wait(
-      std::bind(&blocking_reader::time_out, this, std::placeholders::_1));
-  // This will block until a character is read
-  // or until the it is cancelled.
+  // After a timeout & cancel, or just running out of work, the context has
+  // to be restarted for the next run to do anything
+  _io_ctx.restart();
+  _port.async_read_some(
+      _rx.prepare(),
+      [&](const asio::error_code &error, size_t bytes_transferred) {
+        completed = true;
+        read_error = error;
+        bytes_read = bytes_transferred;
+      });
 
-  _io_ctx.run();
+  // No timer needed, this returns as soon as the read completes or at the
+  // deadline, whichever comes first
+  _io_ctx.run_until(deadline);
 
-  if (!read_error)
-    val = c;
-  return !read_error;
+  bool timed_out = false;
+  if (!completed) {
+    // The handler refers to our locals so let it run (with
+    // operation_aborted, or with the bytes if they just made it) before
+    // going anywhere
+    _port.cancel();
+    _io_ctx.restart();
+    _io_ctx.run();
+    timed_out = true;
+  }
+  _rx.commit(bytes_read);
+
+  if (timed_out || read_error == asio::error::operation_aborted) {
+    log_serial_timeout(command, _warn_on_serial_timeout);
+    return false;
+  }
+
+  if (read_error) {
+    spdlog::warn("serial read failed for cmd: \"{}\": {}", command,
+                 read_error.message());
+    return false;
+  }
+  return true;
 }
 } // namespace alpaca_hub_serial
@@ -1,55 +1,177 @@
 #ifndef ALPACA_HUB_SERIAL_HPP
 #define ALPACA_HUB_SERIAL_HPP
 
-// #include "asio/"
 #include "asio/io_context.hpp"
 #include "asio/serial_port.hpp"
-#include "asio/steady_timer.hpp"
 #include "spdlog/spdlog.h"
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 std::vector<std::string> split(const std::string &input,
                                const std::string &regex);
 
 namespace alpaca_hub_serial {
 
-// This is an attempt to summarize how this works with the ASIO weirdness
+// Receive buffer for serial replies, shared by frame_reader and
+// serial_channel_t. Bytes go in at the end with prepare() / commit() and
+// frames come off the front with take_frame().
+class rx_buffer_t {
+public:
+  explicit rx_buffer_t(size_t initial_capacity = 512)
+      : _buffer(std::max<size_t>(initial_capacity, 16)), _begin(0), _end(0) {}
+
+  // Space at the end to read into. Usually the buffer is empty and we just
+  // rewind, otherwise the leftovers slide down or it grows for a long frame.
+  asio::mutable_buffer prepare() {
+    if (_begin == _end) {
+      _begin = _end = 0;
+    } else if (_end == _buffer.size()) {
+      if (_begin > 0) {
+        std::copy(_buffer.begin() + _begin, _buffer.begin() + _end,
+                  _buffer.begin());
+        _end -= _begin;
+        _begin = 0;
+      } else {
+        _buffer.resize(_buffer.size() * 2);
+      }
+    }
+    return asio::buffer(_buffer.data() + _end, _buffer.size() - _end);
+  }
+  void commit(size_t n_bytes) { _end += n_bytes; }
+
+  std::string_view pending() const {
+    return std::string_view(_buffer.data() + _begin, _end - _begin);
+  }
+  size_t size() const { return _end - _begin; }
+  void discard() { _begin = _end = 0; }
+
+  // frame_length is handed everything buffered so far and returns the length
+  // of the frame at the front of it, or 0 if it needs more bytes. frame
+  // points into the buffer so it's only good until the next prepare().
+  template <typename frame_length_fn>
+  bool take_frame(frame_length_fn &&frame_length, std::string_view &frame) {
+    auto n = frame_length(pending());
+    if (n == 0)
+      return false;
+    take(std::min(n, size()), frame);
+    return true;
+  }
+
+  void take(size_t n_bytes, std::string_view &frame) {
+    frame = std::string_view(_buffer.data() + _begin, n_bytes);
+    _begin += n_bytes;
+  }
+
+private:
+  std::vector<char> _buffer;
+  size_t _begin;
+  size_t _end;
+};
+
+// Frame shapes for the readers below
+inline auto ends_with_any(std::string terminators) {
+  return [terminators = std::move(terminators)](
+             std::string_view pending) -> size_t {
+    auto pos = pending.find_first_of(terminators);
+    return pos == std::string_view::npos ? 0 : pos + 1;
+  };
+}
+
+inline auto fixed_length(size_t n_bytes) {
+  return [n_bytes](std::string_view pending) -> size_t {
+    return pending.size() >= n_bytes ? n_bytes : 0;
+  };
+}
+
+// Reads replies off a serial port a frame at a time, blocking the caller.
 //
-// The way this reader works is as follows:
-// 1. It is initialized with an existing asio::serial_port, a timeout in
-// milliseconds, and an asio::io_context
-// 2. When the read_char is invoked, it resets the context and registers
-// two handlers, 1 for timeout and another as a read_callback
-// 3. When the read_complete:
-//     - successfully reads, it cancels the timer which invokes the timeout
-//       which receives a non successful error code which means we still have
-//       to try and read more
-//     - when it doesn't successfully read, it sets the read_error to true
-//       which tells the caller that there is no more to read
-// 4. When the time_out callback is invoked it:
-//     - if it is an actual timeout, it cancels the async read operation
-//       which invokes the read_complete callback with an error code
-//     - if it is a result of the read_complete success, it will
-//       simply return
-class blocking_reader {
-  asio::serial_port &port;
-  size_t timeout;
-  char c;
-  asio::steady_timer timer;
-  bool read_error;
-  asio::io_context &_io_ctx;
-  std::string _command;
+// The old blocking_reader ran the io_context once per character, with a
+// fresh timer each time, which is a handful of syscalls for every byte of
+// every reply. This one asks for whatever is available into a buffer it
+// keeps between calls and only goes back to the port when the bytes it has
+// don't make up a whole frame yet.
+//
+// A frame can end on any of a set of terminators ('#' for the LX200 mounts,
+// '\n' for the Pegasus and PrimaLuce units), be a fixed number of bytes (the
+// QHY filterwheel) or be decided by a predicate. Each read gets one deadline
+// for the whole frame rather than one per character.
+//
+// Anything that arrives after the end of a frame stays buffered for the next
+// read, same as it would have stayed in the OS buffer before.
+//
+// The drivers go through serial_channel_t (serial_reactor.hpp) instead,
+// this is for tools like SerialConsole that own their io_context.
+class frame_reader {
+public:
+  using clock_t = std::chrono::steady_clock;
+
+  frame_reader(asio::serial_port &port, asio::io_context &io_ctx,
+               bool warn_on_serial_timeout = true,
+               size_t initial_capacity = 512);
+
+  frame_reader(const frame_reader &) = delete;
+  frame_reader &operator=(const frame_reader &) = delete;
+
+  // All of the reads below return true with frame set to the complete frame
+  // (terminator included). On a timeout or read error they return false with
+  // frame set to whatever partial bytes had arrived, which are consumed.
+  //
+  // frame points into the reader's buffer so it's only good until the next
+  // call. command is only used for logging.
+  bool read_until(std::string_view terminators,
+                  std::chrono::milliseconds timeout, std::string_view &frame,
+                  const std::string &command = "") {
+    return read_frame(ends_with_any(std::string(terminators)), timeout, frame,
+                      command);
+  }
+
+  bool read_exactly(size_t n_bytes, std::chrono::milliseconds timeout,
+                    std::string_view &frame,
+                    const std::string &command = "") {
+    return read_frame(fixed_length(n_bytes), timeout, frame, command);
+  }
 
-  // Called when an async read completes or has been cancelled
-  void read_complete(const asio::error_code &error, size_t bytes_transferred);
-  // Called when the timer's deadline expires.
-  void time_out(const asio::error_code &error);
+  // frame_length is handed everything buffered so far and returns the length
+  // of the frame at the front of it, or 0 if it needs more bytes
+  template <typename frame_length_fn>
+  bool read_frame(frame_length_fn frame_length,
+                  std::chrono::milliseconds timeout, std::string_view &frame,
+                  const std::string &command = "") {
+    auto deadline = clock_t::now() + timeout;
+    while (!_rx.take_frame(frame_length, frame)) {
+      if (!fill(deadline, command)) {
+        // The last fill may still have brought in the end of the frame
+        if (_rx.take_frame(frame_length, frame))
+          return true;
+        _rx.take(_rx.size(), frame);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Throws away anything buffered, e.g. after (re)opening the port
+  void discard() { _rx.discard(); }
+  size_t buffered() const { return _rx.size(); }
+
+private:
+  asio::serial_port &_port;
+  asio::io_context &_io_ctx;
   bool _warn_on_serial_timeout;
-public:
-  blocking_reader(const std::string &command, asio::serial_port &port, size_t timeout,
-                  asio::io_context &io_ctx, bool warn_on_serial_timeout = true);
-  bool read_char(char &val);
+  rx_buffer_t _rx;
+
+  // Does a single read of whatever is available, waiting no later than
+  // deadline. Returns false on a timeout or error.
+  bool fill(clock_t::time_point deadline, const std::string &command);
 };
+
+// Logs a reply that didn't complete in time. A warning unless the device is
+// expected to go quiet (e.g. the filterwheel while it's moving).
+void log_serial_timeout(const std::string &command, bool warn);
 } // namespace alpaca_hub_serial
 
 #endif
@@ -0,0 +1,192 @@
+#include "alpaca_response.hpp"
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using json_buffer_t = fmt::memory_buffer;
+
+template <typename T> struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T> struct is_map : std::false_type {};
+template <typename V, typename C, typename A>
+struct is_map<std::map<std::string, V, C, A>> : std::true_type {};
+
+template <typename T> struct is_variant : std::false_type {};
+template <typename... Ts>
+struct is_variant<std::variant<Ts...>> : std::true_type {};
+
+template <typename T> struct always_false : std::false_type {};
+
+void write_raw(json_buffer_t &out, std::string_view s) {
+  out.append(s.data(), s.data() + s.size());
+}
+
+// Same escaping as nlohmann's dump() with ensure_ascii off. Anything that
+// isn't plain ASCII is handed to nlohmann so it gets its UTF-8 checking
+// (and throws on bad UTF-8) exactly like before.
+void write_string(json_buffer_t &out, std::string_view s) {
+  for (unsigned char c : s)
+    if (c >= 0x80) {
+      write_raw(out, nlohmann::json(std::string(s)).dump());
+      return;
+    }
+
+  // Runs of characters that don't need escaping go in with one append
+  out.push_back('"');
+  size_t run = 0;
+  for (size_t i = 0; i < s.size(); i++) {
+    unsigned char c = s[i];
+    if (c > 0x1f && c != '"' && c != '\\')
+      continue;
+
+    write_raw(out, s.substr(run, i - run));
+    run = i + 1;
+    switch (c) {
+    case '\b':
+      write_raw(out, "\\b");
+      break;
+    case '\t':
+      write_raw(out, "\\t");
+      break;
+    case '\n':
+      write_raw(out, "\\n");
+      break;
+    case '\f':
+      write_raw(out, "\\f");
+      break;
+    case '\r':
+      write_raw(out, "\\r");
+      break;
+    case '"':
+      write_raw(out, "\\\"");
+      break;
+    case '\\':
+      write_raw(out, "\\\\");
+      break;
+    default:
+      fmt::format_to(std::back_inserter(out), "\\u{:04x}",
+                     static_cast<unsigned>(c));
+    }
+  }
+  write_raw(out, s.substr(run));
+  out.push_back('"');
+}
+
+// nlohmann's own shortest round trip formatting, so 1 comes out as 1.0 and
+// 1e-05 as 1e-05 like it always has
+void write_double(json_buffer_t &out, double value) {
+  if (!std::isfinite(value)) {
+    write_raw(out, "null");
+    return;
+  }
+  char buf[64];
+  char *end = nlohmann::detail::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, end);
+}
+
+template <typename T> void write_json(json_buffer_t &out, const T &value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    write_raw(out, value ? "true" : "false");
+  } else if constexpr (std::is_enum_v<T>) {
+    write_json(out, static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_integral_v<T>) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    write_double(out, value);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    write_string(out, value);
+  } else if constexpr (std::is_same_v<T, axis_rate>) {
+    write_raw(out, "{\"Maximum\":");
+    write_double(out, value.Max);
+    write_raw(out, ",\"Minimum\":");
+    write_double(out, value.Min);
+    out.push_back('}');
+  } else if constexpr (is_vector<T>::value) {
+    out.push_back('[');
+    bool first = true;
+    for (const typename T::value_type &item : value) {
+      if (!first)
+        out.push_back(',');
+      first = false;
+      write_json(out, item);
+    }
+    out.push_back(']');
+  } else if constexpr (is_map<T>::value) {
+    out.push_back('{');
+    bool first = true;
+    for (auto &[key, item] : value) {
+      if (!first)
+        out.push_back(',');
+      first = false;
+      write_string(out, key);
+      out.push_back(':');
+      write_json(out, item);
+    }
+    out.push_back('}');
+  } else if constexpr (is_variant<T>::value) {
+    std::visit([&out](const auto &item) { write_json(out, item); }, value);
+  } else {
+    static_assert(always_false<T>::value, "no JSON writer for this type");
+  }
+}
+
+} // namespace
+
+device_variant_t &alpaca_response_t::operator[](std::string_view key) {
+  for (size_t i = 0; i < field_count; i++)
+    if (key == field_names[i]) {
+      _fields[i].set = true;
+      return _fields[i].value;
+    }
+  return _extra[std::string(key)];
+}
+
+bool alpaca_response_t::contains(std::string_view key) const {
+  for (size_t i = 0; i < field_count; i++)
+    if (key == field_names[i])
+      return _fields[i].set;
+  return _extra.count(std::string(key)) > 0;
+}
+
+std::string alpaca_response_t::dump() const {
+  fmt::memory_buffer out;
+  dump_to(out);
+  return std::string(out.data(), out.size());
+}
+
+void alpaca_response_t::dump_to(fmt::memory_buffer &out) const {
+  bool first = true;
+  auto write_member = [&out, &first](std::string_view key,
+                                     const device_variant_t &value) {
+    if (!first)
+      out.push_back(',');
+    first = false;
+    write_string(out, key);
+    out.push_back(':');
+    write_json(out, value);
+  };
+
+  // Both lists are already sorted, merge them
+  out.push_back('{');
+  auto extra = _extra.begin();
+  for (size_t i = 0; i < field_count; i++) {
+    if (!_fields[i].set)
+      continue;
+    for (; extra != _extra.end() &&
+           std::string_view(extra->first) < field_names[i];
+         ++extra)
+      write_member(extra->first, extra->second);
+    write_member(field_names[i], _fields[i].value);
+  }
+  for (; extra != _extra.end(); ++extra)
+    write_member(extra->first, extra->second);
+  out.push_back('}');
+}
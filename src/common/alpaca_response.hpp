@@ -0,0 +1,59 @@
+#ifndef ALPACA_RESPONSE_HPP
+#define ALPACA_RESPONSE_HPP
+
+#include "interfaces/i_alpaca_device.hpp"
+#include <array>
+#include <cstddef>
+#include <fmt/format.h>
+#include <map>
+#include <string>
+#include <string_view>
+
+// The body of an Alpaca JSON response.
+//
+// It's used like the std::map<std::string, device_variant_t> it replaces,
+// response_map["Value"] = ..., but the envelope keys every response has get
+// a fixed slot each so filling them in doesn't allocate. Anything else
+// (Rank and Type for imagearray, whatever details() returns) goes in a map.
+//
+// dump() writes it straight out as JSON instead of building a
+// nlohmann::json tree first. The output is byte for byte what
+// nlohmann::json(the_map).dump() gave, keys in sorted order, numbers and
+// escaping done the same way, so clients can't tell the difference.
+class alpaca_response_t {
+public:
+  // Like std::map::operator[], asking for a key adds it
+  device_variant_t &operator[](std::string_view key);
+
+  bool contains(std::string_view key) const;
+
+  // Usually one allocation, for the string itself
+  std::string dump() const;
+  void dump_to(fmt::memory_buffer &out) const;
+
+private:
+  // In the order they sort in
+  enum field_enum {
+    client_id,
+    client_transaction_id,
+    error_message,
+    error_number,
+    server_transaction_id,
+    value,
+    field_count
+  };
+
+  static constexpr std::array<std::string_view, field_count> field_names = {
+      "ClientID",    "ClientTransactionID", "ErrorMessage",
+      "ErrorNumber", "ServerTransactionID", "Value"};
+
+  struct field_t {
+    bool set = false;
+    device_variant_t value;
+  };
+
+  std::array<field_t, field_count> _fields;
+  std::map<std::string, device_variant_t> _extra;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "astrometry.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace astrometry {
+
+namespace {
+constexpr double pi = 3.14159265358979323846;
+constexpr double deg_to_rad = pi / 180.0;
+constexpr double rad_to_deg = 180.0 / pi;
+
+// Julian date of the unix epoch and of J2000.0
+constexpr double jd_unix_epoch = 2440587.5;
+constexpr double jd_j2000 = 2451545.0;
+
+constexpr double sidereal_rate_arcsec = 15.041067;
+
+double wrap(double value, double range) {
+  value = std::fmod(value, range);
+  return value < 0 ? value + range : value;
+}
+
+double seconds_since_unix_epoch(std::chrono::system_clock::time_point when) {
+  return std::chrono::duration<double>(when.time_since_epoch()).count();
+}
+
+// The refraction formulas are for 10C and 1010hPa
+double weather_factor(const site_t &site) {
+  return (site.pressure_hpa / 1010.0) * (283.0 / (273.0 + site.temperature_c));
+}
+} // namespace
+
+double julian_date(std::chrono::system_clock::time_point when) {
+  return jd_unix_epoch + seconds_since_unix_epoch(when) / 86400.0;
+}
+
+double greenwich_sidereal_time(std::chrono::system_clock::time_point when) {
+  // Days since J2000 worked out from the epoch offset directly, a double
+  // holding the whole julian date loses about 40us of precision
+  double d = seconds_since_unix_epoch(when) / 86400.0 +
+             (jd_unix_epoch - jd_j2000);
+  double t = d / 36525.0;
+  // Meeus 12.4
+  double degrees = 280.46061837 + 360.98564736629 * d +
+                   0.000387933 * t * t - t * t * t / 38710000.0;
+  return wrap(degrees, 360.0) / 15.0;
+}
+
+double local_sidereal_time(std::chrono::system_clock::time_point when,
+                           double longitude) {
+  return wrap(greenwich_sidereal_time(when) + longitude / 15.0, 24.0);
+}
+
+double hour_angle(double local_sidereal_time, double right_ascension) {
+  return wrap(local_sidereal_time - right_ascension + 12.0, 24.0) - 12.0;
+}
+
+horizontal_t to_horizontal(const equatorial_t &position,
+                           double local_sidereal_time, const site_t &site) {
+  double h =
+      hour_angle(local_sidereal_time, position.right_ascension) * 15.0 *
+      deg_to_rad;
+  double dec = position.declination * deg_to_rad;
+  double lat = site.latitude * deg_to_rad;
+
+  // Meeus 13.5 and 13.6, with the azimuth turned round to start at north
+  horizontal_t result;
+  result.altitude =
+      std::asin(std::sin(lat) * std::sin(dec) +
+                std::cos(lat) * std::cos(dec) * std::cos(h)) *
+      rad_to_deg;
+  result.azimuth =
+      wrap(std::atan2(-std::cos(dec) * std::sin(h),
+                      std::sin(dec) * std::cos(lat) -
+                          std::cos(dec) * std::sin(lat) * std::cos(h)) *
+               rad_to_deg,
+           360.0);
+
+  if (site.refraction)
+    result.altitude += refraction(result.altitude, site);
+  return result;
+}
+
+equatorial_t to_equatorial(const horizontal_t &position,
+                           double local_sidereal_time, const site_t &site) {
+  double altitude = position.altitude;
+  if (site.refraction)
+    altitude -= refraction_from_apparent(altitude, site);
+
+  double alt = altitude * deg_to_rad;
+  double az = position.azimuth * deg_to_rad;
+  double lat = site.latitude * deg_to_rad;
+
+  equatorial_t result;
+  result.declination =
+      std::asin(std::sin(lat) * std::sin(alt) +
+                std::cos(lat) * std::cos(alt) * std::cos(az)) *
+      rad_to_deg;
+  double h = std::atan2(-std::sin(az) * std::cos(alt),
+                        std::cos(lat) * std::sin(alt) -
+                            std::sin(lat) * std::cos(alt) * std::cos(az)) *
+             rad_to_deg;
+  result.right_ascension = wrap(local_sidereal_time - h / 15.0, 24.0);
+  return result;
+}
+
+// Both formulas go wrong well below the horizon, nothing we'd be pointing
+// at is down there anyway
+double refraction(double true_altitude, const site_t &site) {
+  if (true_altitude < -1.0)
+    return 0;
+  // Meeus 16.4, in arc minutes
+  double arcmin =
+      1.02 / std::tan((true_altitude + 10.3 / (true_altitude + 5.11)) *
+                      deg_to_rad);
+  return std::max(arcmin, 0.0) * weather_factor(site) / 60.0;
+}
+
+double refraction_from_apparent(double apparent_altitude, const site_t &site) {
+  if (apparent_altitude < -1.0)
+    return 0;
+  // Meeus 16.3, in arc minutes
+  double arcmin =
+      1.0 / std::tan((apparent_altitude + 7.31 / (apparent_altitude + 4.4)) *
+                     deg_to_rad);
+  return std::max(arcmin, 0.0) * weather_factor(site) / 60.0;
+}
+
+// Looking west of the meridian is the normal pointing state, which ASCOM
+// calls pierEast
+pier_side_enum destination_side_of_pier(const equatorial_t &target,
+                                        double local_sidereal_time) {
+  if (hour_angle(local_sidereal_time, target.right_ascension) >= 0)
+    return pier_side_enum::east;
+  return pier_side_enum::west;
+}
+
+double tracking_rate_arcsec(drive_rate_enum rate) {
+  switch (rate) {
+  case drive_rate_enum::lunar:
+    return 14.685;
+  case drive_rate_enum::solar:
+    return 15.0;
+  case drive_rate_enum::king:
+    return 15.0369;
+  case drive_rate_enum::sidereal:
+  default:
+    return sidereal_rate_arcsec;
+  }
+}
+
+equatorial_t extrapolate(const equatorial_t &from,
+                         std::chrono::steady_clock::duration elapsed,
+                         bool tracking, drive_rate_enum rate) {
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  double drift_arcsec = sidereal_rate_arcsec;
+  if (tracking)
+    drift_arcsec -= tracking_rate_arcsec(rate);
+
+  equatorial_t result = from;
+  // 54000 arc seconds to an hour of RA
+  result.right_ascension =
+      wrap(from.right_ascension + seconds * drift_arcsec / 54000.0, 24.0);
+  return result;
+}
+
+} // namespace astrometry
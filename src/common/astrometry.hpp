@@ -0,0 +1,77 @@
+#ifndef ASTROMETRY_HPP
+#define ASTROMETRY_HPP
+
+#include "interfaces/i_alpaca_device.hpp"
+#include <chrono>
+
+// The bits of positional astronomy the mount drivers need so they can answer
+// sidereal time, alt / az and pier side questions themselves instead of
+// asking the mount every time. Formulas are from Meeus, Astronomical
+// Algorithms, and are good to a few arc seconds which is plenty for
+// reporting where the mount is pointing.
+namespace astrometry {
+
+struct equatorial_t {
+  // Hours
+  double right_ascension = 0;
+  // Degrees
+  double declination = 0;
+};
+
+struct horizontal_t {
+  // Degrees
+  double altitude = 0;
+  // Degrees east of north
+  double azimuth = 0;
+};
+
+struct site_t {
+  // Degrees, north positive
+  double latitude = 0;
+  // Degrees, east positive like ASCOM, not west positive like LX200
+  double longitude = 0;
+  // When set altitudes are apparent ones, lifted by the atmosphere
+  bool refraction = false;
+  double pressure_hpa = 1010;
+  double temperature_c = 10;
+};
+
+double julian_date(std::chrono::system_clock::time_point when);
+
+// Mean sidereal time in hours, ignoring nutation which is at most a second
+double greenwich_sidereal_time(std::chrono::system_clock::time_point when);
+double local_sidereal_time(std::chrono::system_clock::time_point when,
+                           double longitude);
+
+// Hours west of the meridian, -12 to 12
+double hour_angle(double local_sidereal_time, double right_ascension);
+
+horizontal_t to_horizontal(const equatorial_t &position,
+                           double local_sidereal_time, const site_t &site);
+equatorial_t to_equatorial(const horizontal_t &position,
+                           double local_sidereal_time, const site_t &site);
+
+// Degrees the atmosphere lifts something at true_altitude (Saemundsson)
+double refraction(double true_altitude, const site_t &site);
+// Degrees to take off an apparent_altitude to get the true one (Bennett)
+double refraction_from_apparent(double apparent_altitude, const site_t &site);
+
+// Which side of the pier a German equatorial mount ends up on when it slews
+// to target the normal way, counterweights down. Doesn't know about the
+// mount's meridian limits, a target on the meridian counts as west of it.
+pier_side_enum destination_side_of_pier(const equatorial_t &target,
+                                        double local_sidereal_time);
+
+// Arc seconds per second the mount turns the RA axis at for rate
+double tracking_rate_arcsec(drive_rate_enum rate);
+
+// Where a mount that read from at some point is pointing elapsed later. The
+// sky turns at the sidereal rate so any difference between that and the
+// tracking rate shows up as a drift in RA, all of it when not tracking.
+equatorial_t extrapolate(const equatorial_t &from,
+                         std::chrono::steady_clock::duration elapsed,
+                         bool tracking, drive_rate_enum rate);
+
+} // namespace astrometry
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef CALL_TIMINGS_HPP
+#define CALL_TIMINGS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+// Running stats for a named call, all times in milliseconds
+struct call_timing_t {
+  uint64_t count = 0;
+  double last_ms = 0;
+  double max_ms = 0;
+  double total_ms = 0;
+
+  double mean_ms() const { return count ? total_ms / count : 0; }
+};
+
+// Collects how long driver / SDK calls take so they can be shown in
+// details(). Recording is cheap enough to leave on all the time.
+class call_timings_t {
+public:
+  void record(const std::string &name,
+              std::chrono::steady_clock::duration duration) {
+    double ms =
+        std::chrono::duration<double, std::milli>(duration).count();
+    std::lock_guard lock(_timings_mtx);
+    auto &timing = _timings[name];
+    timing.count++;
+    timing.last_ms = ms;
+    timing.max_ms = std::max(timing.max_ms, ms);
+    timing.total_ms += ms;
+  }
+
+  // Times fn() and records it under name, returns whatever fn() returns
+  template <typename F> auto time(const std::string &name, F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    if constexpr (std::is_void_v<decltype(fn())>) {
+      fn();
+      record(name, std::chrono::steady_clock::now() - start);
+    } else {
+      auto result = fn();
+      record(name, std::chrono::steady_clock::now() - start);
+      return result;
+    }
+  }
+
+  std::map<std::string, call_timing_t> snapshot() {
+    std::lock_guard lock(_timings_mtx);
+    return _timings;
+  }
+
+  // Flattened for details(), e.g. "ExpQHYCCDSingleFrame.mean_ms"
+  std::map<std::string, double> summary() {
+    std::map<std::string, double> result;
+    for (auto &[name, timing] : snapshot()) {
+      result[name + ".count"] = timing.count;
+      result[name + ".last_ms"] = timing.last_ms;
+      result[name + ".mean_ms"] = timing.mean_ms();
+      result[name + ".max_ms"] = timing.max_ms;
+    }
+    return result;
+  }
+
+  void clear() {
+    std::lock_guard lock(_timings_mtx);
+    _timings.clear();
+  }
+
+private:
+  std::mutex _timings_mtx;
+  std::map<std::string, call_timing_t> _timings;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef CAMERA_CONFIG_HPP
+#define CAMERA_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// The settings that have to be pushed to a camera before an exposure. The
+// driver keeps what the client asked for (desired) and what the camera was
+// last told (applied) so exposure start only pays for what changed.
+struct camera_config_t {
+  int readout_mode = 0;
+  short bin = 1;
+  uint32_t start_x = 0;
+  uint32_t start_y = 0;
+  uint32_t num_x = 0;
+  uint32_t num_y = 0;
+  // Values as the SDK expects them, i.e. after any index -> value mapping
+  double gain = 0;
+  double offset = 0;
+  int usb_traffic = 0;
+  double exposure_us = 0;
+};
+
+enum camera_config_field_t : uint32_t {
+  CONFIG_READOUT_MODE = 1 << 0,
+  CONFIG_BIN = 1 << 1,
+  CONFIG_ROI = 1 << 2,
+  CONFIG_GAIN = 1 << 3,
+  CONFIG_OFFSET = 1 << 4,
+  CONFIG_USB_TRAFFIC = 1 << 5,
+  CONFIG_EXPOSURE = 1 << 6,
+  CONFIG_ALL = (1 << 7) - 1
+};
+
+// Tracks which fields have been applied to the camera and with what values.
+// Anything that hasn't been applied yet (or was invalidated, e.g. because
+// the SDK was re-initialized) always shows up as changed.
+class camera_config_tracker_t {
+public:
+  // Bitmask of camera_config_field_t that differ between desired and
+  // what was last applied
+  uint32_t diff(const camera_config_t &desired) const {
+    uint32_t changed = CONFIG_ALL & ~_valid;
+
+    if (desired.readout_mode != _applied.readout_mode)
+      changed |= CONFIG_READOUT_MODE;
+    if (desired.bin != _applied.bin)
+      changed |= CONFIG_BIN;
+    if (desired.start_x != _applied.start_x ||
+        desired.start_y != _applied.start_y ||
+        desired.num_x != _applied.num_x || desired.num_y != _applied.num_y)
+      changed |= CONFIG_ROI;
+    if (desired.gain != _applied.gain)
+      changed |= CONFIG_GAIN;
+    if (desired.offset != _applied.offset)
+      changed |= CONFIG_OFFSET;
+    if (desired.usb_traffic != _applied.usb_traffic)
+      changed |= CONFIG_USB_TRAFFIC;
+    if (desired.exposure_us != _applied.exposure_us)
+      changed |= CONFIG_EXPOSURE;
+
+    return changed;
+  }
+
+  // Records fields of config as applied. Only call this once the SDK has
+  // accepted them.
+  void mark_applied(const camera_config_t &config, uint32_t fields) {
+    if (fields & CONFIG_READOUT_MODE)
+      _applied.readout_mode = config.readout_mode;
+    if (fields & CONFIG_BIN)
+      _applied.bin = config.bin;
+    if (fields & CONFIG_ROI) {
+      _applied.start_x = config.start_x;
+      _applied.start_y = config.start_y;
+      _applied.num_x = config.num_x;
+      _applied.num_y = config.num_y;
+    }
+    if (fields & CONFIG_GAIN)
+      _applied.gain = config.gain;
+    if (fields & CONFIG_OFFSET)
+      _applied.offset = config.offset;
+    if (fields & CONFIG_USB_TRAFFIC)
+      _applied.usb_traffic = config.usb_traffic;
+    if (fields & CONFIG_EXPOSURE)
+      _applied.exposure_us = config.exposure_us;
+
+    _valid |= fields & CONFIG_ALL;
+  }
+
+  void invalidate(uint32_t fields = CONFIG_ALL) { _valid &= ~fields; }
+
+  const camera_config_t &applied() const { return _applied; }
+
+private:
+  camera_config_t _applied;
+  uint32_t _valid = 0;
+};
+
+// e.g. "bin,roi,exposure" for logging and details()
+inline std::string camera_config_fields_to_string(uint32_t fields) {
+  static const std::pair<uint32_t, const char *> names[] = {
+      {CONFIG_READOUT_MODE, "readout_mode"},
+      {CONFIG_BIN, "bin"},
+      {CONFIG_ROI, "roi"},
+      {CONFIG_GAIN, "gain"},
+      {CONFIG_OFFSET, "offset"},
+      {CONFIG_USB_TRAFFIC, "usb_traffic"},
+      {CONFIG_EXPOSURE, "exposure"}};
+
+  std::string result;
+  for (auto &[field, name] : names) {
+    if (!(fields & field))
+      continue;
+    if (!result.empty())
+      result += ",";
+    result += name;
+  }
+  return result;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef CAMERA_FRAME_HPP
+#define CAMERA_FRAME_HPP
+
+#include "common/frame_buffer_pool.hpp"
+#include "common/image_bytes.hpp"
+#include "common/image_kernels.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// A single frame as it came off the sensor. The pixel data stays in the
+// native row major layout (x varies fastest) and is never modified once the
+// frame has been handed out, so it is shared as a shared_ptr<const> between
+// any number of downloaders without copying.
+//
+// Anything that needs Alpaca's [x][y] ordering should go through
+// copy_columns() which transposes a band of columns at a time.
+//
+// The pixels live in a buffer borrowed from the camera's frame_buffer_pool_t,
+// it goes back to the pool once the last reference to the frame is dropped.
+struct camera_frame_t {
+  // BYTE for 8bpp and UINT16 for anything deeper
+  image_array_element_types pixel_type = image_array_element_types::UINT16;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // 0 = Monochrome, 2 = RGGB etc. (same as i_alpaca_camera::sensor_type)
+  int sensor_type = 0;
+  int bayer_offset_x = 0;
+  int bayer_offset_y = 0;
+
+  short bin_x = 1;
+  short bin_y = 1;
+  uint32_t start_x = 0;
+  uint32_t start_y = 0;
+
+  double exposure_duration = 0;
+  // FITS style CCYY-MM-DDThh:mm:ss
+  std::string exposure_start_time;
+  double gain = 0;
+  double offset = 0;
+
+  frame_buffer_ptr_t buffer;
+
+  uint8_t *data() { return buffer ? buffer->data() : nullptr; }
+  const uint8_t *data() const { return buffer ? buffer->data() : nullptr; }
+  size_t data_size() const { return buffer ? buffer->size() : 0; }
+
+  uint8_t bytes_per_pixel() const {
+    return pixel_type == image_array_element_types::BYTE ? 1 : 2;
+  }
+
+  size_t num_pixels() const { return static_cast<size_t>(width) * height; }
+
+  // Size of the pixel data in ImageBytes / Alpaca order, which is the same
+  // as the native size since we only reorder
+  size_t size_bytes() const { return num_pixels() * bytes_per_pixel(); }
+
+  template <typename T> const T *pixels() const {
+    return reinterpret_cast<const T *>(data());
+  }
+
+  uint32_t pixel(uint32_t x, uint32_t y) const {
+    size_t idx = static_cast<size_t>(y) * width + x;
+    if (bytes_per_pixel() == 1)
+      return data()[idx];
+    return pixels<uint16_t>()[idx];
+  }
+
+  // Writes columns [x_begin, x_end) into dst in Alpaca order, i.e. each
+  // column is height contiguous elements of dst_type (defaults to the
+  // native pixel type)
+  void copy_columns(uint32_t x_begin, uint32_t x_end, uint8_t *dst,
+                    image_array_element_types dst_type =
+                        image_array_element_types::UNKNOWN) const {
+    if (dst_type == image_array_element_types::UNKNOWN)
+      dst_type = pixel_type;
+    image_kernels::transpose_convert(data(), pixel_type, dst, dst_type,
+                                     width, height, x_begin, x_end);
+  }
+};
+
+using camera_frame_ptr_t = std::shared_ptr<const camera_frame_t>;
+
+#endif
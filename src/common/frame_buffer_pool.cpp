@@ -0,0 +1,184 @@
+#include "frame_buffer_pool.hpp"
+#include "alpaca_exception.hpp"
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+size_t round_up(size_t size, size_t multiple) {
+  return ((size + multiple - 1) / multiple) * multiple;
+}
+} // namespace
+
+frame_buffer_t::frame_buffer_t(size_t capacity, bool lock_pages,
+                               bool huge_pages)
+    : _data(nullptr), _capacity(capacity), _mapped_size(0), _size(0),
+      _locked(false), _huge_pages(false) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  _mapped_size = round_up(std::max<size_t>(capacity, 1), page_size);
+  void *mem = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  // This needs hugetlbfs pages reserved (vm.nr_hugepages) so it is fine for
+  // it to fail, we fall back to transparent huge pages below
+  if (huge_pages) {
+    size_t huge_size = round_up(_mapped_size, huge_page_size);
+    mem = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+      _mapped_size = huge_size;
+      _huge_pages = true;
+    } else {
+      spdlog::debug("MAP_HUGETLB failed for {} bytes, using regular pages",
+                    huge_size);
+    }
+  }
+#endif
+
+  if (mem == MAP_FAILED)
+    mem = mmap(nullptr, _mapped_size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (mem == MAP_FAILED)
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("Unable to allocate {} bytes for frame buffer", capacity));
+
+  _data = static_cast<uint8_t *>(mem);
+
+#ifdef MADV_HUGEPAGE
+  if (huge_pages && !_huge_pages)
+    _huge_pages = madvise(_data, _mapped_size, MADV_HUGEPAGE) == 0;
+#endif
+
+  if (lock_pages) {
+    // This is subject to RLIMIT_MEMLOCK, so if it fails we just carry on
+    // with pageable memory
+    if (mlock(_data, _mapped_size) == 0)
+      _locked = true;
+    else
+      spdlog::warn("unable to lock {} bytes of frame buffer memory, check "
+                   "ulimit -l",
+                   _mapped_size);
+  }
+
+  spdlog::debug("allocated frame buffer of {} bytes, locked: {}, huge pages: "
+                "{}",
+                _mapped_size, _locked, _huge_pages);
+}
+
+frame_buffer_t::~frame_buffer_t() {
+  if (_locked)
+    munlock(_data, _mapped_size);
+  munmap(_data, _mapped_size);
+}
+
+void frame_buffer_t::resize(size_t size) {
+  if (size > _capacity)
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("frame of {} bytes does not fit in {} byte buffer", size,
+                    _capacity));
+  _size = size;
+}
+
+frame_buffer_ptr_t make_frame_buffer(size_t size) {
+  frame_buffer_ptr_t buffer(new frame_buffer_t(size),
+                            [](frame_buffer_t *b) { delete b; });
+  buffer->resize(size);
+  return buffer;
+}
+
+frame_buffer_pool_t::frame_buffer_pool_t(size_t buffer_size, bool lock_pages,
+                                         bool huge_pages)
+    : _buffer_size(buffer_size), _buffer_count(0), _max_buffer_count(0),
+      _lock_pages(lock_pages), _huge_pages(huge_pages) {}
+
+std::shared_ptr<frame_buffer_pool_t>
+frame_buffer_pool_t::create(size_t buffer_count, size_t buffer_size,
+                            bool lock_pages, bool huge_pages,
+                            size_t max_buffer_count) {
+  // Private constructor so no make_shared here
+  std::shared_ptr<frame_buffer_pool_t> pool(
+      new frame_buffer_pool_t(buffer_size, lock_pages, huge_pages));
+
+  for (size_t i = 0; i < buffer_count; i++)
+    pool->_free_buffers.push_back(std::make_unique<frame_buffer_t>(
+        buffer_size, lock_pages, huge_pages));
+  pool->_buffer_count = buffer_count;
+  pool->_max_buffer_count = max_buffer_count;
+
+  spdlog::debug("created frame buffer pool with {} buffers of {} bytes",
+                buffer_count, buffer_size);
+  return pool;
+}
+
+frame_buffer_ptr_t frame_buffer_pool_t::acquire(size_t size) {
+  if (size > _buffer_size)
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("requested frame of {} bytes exceeds pool buffer size {}",
+                    size, _buffer_size));
+
+  std::unique_ptr<frame_buffer_t> buffer;
+  {
+    std::lock_guard lock(_pool_mtx);
+    if (!_free_buffers.empty()) {
+      buffer = std::move(_free_buffers.back());
+      _free_buffers.pop_back();
+    } else if (_max_buffer_count && _buffer_count >= _max_buffer_count) {
+      throw alpaca_exception(
+          alpaca_exception::DRIVER_ERROR,
+          fmt::format("all {} frame buffers are still held by earlier frames",
+                      _buffer_count));
+    } else {
+      _buffer_count++;
+    }
+  }
+
+  if (!buffer) {
+    spdlog::warn("all {} frame buffers are in use, allocating another",
+                 _buffer_count - 1);
+    try {
+      buffer = std::make_unique<frame_buffer_t>(_buffer_size, _lock_pages,
+                                                _huge_pages);
+    } catch (...) {
+      std::lock_guard lock(_pool_mtx);
+      _buffer_count--;
+      throw;
+    }
+  }
+
+  buffer->resize(size);
+  std::weak_ptr<frame_buffer_pool_t> weak_pool = shared_from_this();
+  return frame_buffer_ptr_t(buffer.release(), [weak_pool](frame_buffer_t *b) {
+    if (auto pool = weak_pool.lock())
+      pool->release(b);
+    else
+      delete b;
+  });
+}
+
+void frame_buffer_pool_t::release(frame_buffer_t *buffer) {
+  std::lock_guard lock(_pool_mtx);
+  _free_buffers.emplace_back(buffer);
+}
+
+size_t frame_buffer_pool_t::buffer_size() { return _buffer_size; }
+
+size_t frame_buffer_pool_t::buffer_count() {
+  std::lock_guard lock(_pool_mtx);
+  return _buffer_count;
+}
+
+size_t frame_buffer_pool_t::max_buffer_count() {
+  std::lock_guard lock(_pool_mtx);
+  return _max_buffer_count;
+}
+
+size_t frame_buffer_pool_t::free_count() {
+  std::lock_guard lock(_pool_mtx);
+  return _free_buffers.size();
+}
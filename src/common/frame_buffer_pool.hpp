@@ -0,0 +1,89 @@
+#ifndef FRAME_BUFFER_POOL_HPP
+#define FRAME_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A page aligned block of memory big enough for one frame. These are mmap'd
+// so they can be page-locked (and optionally backed by huge pages) which
+// keeps USB transfers from the SDK from faulting pages in mid readout.
+class frame_buffer_t {
+public:
+  frame_buffer_t(size_t capacity, bool lock_pages = false,
+                 bool huge_pages = false);
+  ~frame_buffer_t();
+
+  frame_buffer_t(const frame_buffer_t &) = delete;
+  frame_buffer_t &operator=(const frame_buffer_t &) = delete;
+
+  uint8_t *data() { return _data; }
+  const uint8_t *data() const { return _data; }
+  size_t capacity() const { return _capacity; }
+
+  // How much of the buffer the current frame uses
+  size_t size() const { return _size; }
+  void resize(size_t size);
+
+  bool locked() const { return _locked; }
+  bool huge_pages() const { return _huge_pages; }
+
+private:
+  uint8_t *_data;
+  size_t _capacity;
+  size_t _mapped_size;
+  size_t _size;
+  bool _locked;
+  bool _huge_pages;
+};
+
+// Hands the buffer back to its pool (if the pool still exists) when the last
+// frame referencing it goes away
+using frame_buffer_ptr_t =
+    std::unique_ptr<frame_buffer_t, std::function<void(frame_buffer_t *)>>;
+
+// Buffers that don't come from a pool, mostly useful for tests and tools
+frame_buffer_ptr_t make_frame_buffer(size_t size);
+
+// Preallocated frame buffers so every exposure reads into its own buffer and
+// a frame stays valid until every download holding it has finished. With two
+// buffers exposure N+1 can be read out while frame N is still downloading.
+//
+// If every buffer is still in use when a new one is needed we allocate
+// another one rather than blocking the readout, the pool then keeps it. That
+// stops at max_buffer_count if one is given, each of these can be a 100MB+
+// locked buffer so a few slow clients sitting on frames mustn't be able to
+// grow it forever. Past that acquire() throws. 0 lets it grow for as long
+// as something holds on to the buffers.
+class frame_buffer_pool_t
+    : public std::enable_shared_from_this<frame_buffer_pool_t> {
+public:
+  static std::shared_ptr<frame_buffer_pool_t>
+  create(size_t buffer_count, size_t buffer_size, bool lock_pages = true,
+         bool huge_pages = false, size_t max_buffer_count = 0);
+
+  frame_buffer_ptr_t acquire(size_t size);
+
+  size_t buffer_size();
+  size_t buffer_count();
+  // 0 if it can grow without limit
+  size_t max_buffer_count();
+  size_t free_count();
+
+private:
+  frame_buffer_pool_t(size_t buffer_size, bool lock_pages, bool huge_pages);
+  void release(frame_buffer_t *buffer);
+
+  std::mutex _pool_mtx;
+  std::vector<std::unique_ptr<frame_buffer_t>> _free_buffers;
+  size_t _buffer_size;
+  size_t _buffer_count;
+  size_t _max_buffer_count;
+  bool _lock_pages;
+  bool _huge_pages;
+};
+
+#endif
@@ -0,0 +1,335 @@
+#include "frame_stats.hpp"
+#include "alpaca_exception.hpp"
+#include "image_kernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Converts a median absolute deviation into a gaussian sigma
+constexpr double mad_to_sigma = 1.4826;
+constexpr double sigma_to_fwhm = 2.35482;
+// Local maxima are checked over a 5x5 box so stars need to be this far from
+// the edge
+constexpr uint32_t edge_margin = 2;
+
+struct star_measurement_t {
+  double hfr;
+  double fwhm;
+};
+
+struct band_stars_t {
+  uint32_t count = 0;
+  std::vector<star_measurement_t> measured;
+};
+
+// Half flux radius and a second moment FWHM about the flux weighted
+// centroid, using only pixels a noise sigma above the background
+template <typename T>
+bool measure_star(const T *pixels, uint32_t width, uint32_t height, uint32_t x,
+                  uint32_t y, double background, double noise,
+                  uint32_t radius, star_measurement_t &result) {
+  uint32_t x0 = x > radius ? x - radius : 0;
+  uint32_t y0 = y > radius ? y - radius : 0;
+  uint32_t x1 = std::min(width - 1, x + radius);
+  uint32_t y1 = std::min(height - 1, y + radius);
+  double r2_max = double(radius) * radius;
+  double floor = background + noise;
+
+  double flux = 0, sum_x = 0, sum_y = 0;
+  for (uint32_t yy = y0; yy <= y1; yy++) {
+    const T *row = pixels + size_t(yy) * width;
+    double dy = double(yy) - y;
+    for (uint32_t xx = x0; xx <= x1; xx++) {
+      double dx = double(xx) - x;
+      if (row[xx] <= floor || dx * dx + dy * dy > r2_max)
+        continue;
+      double f = row[xx] - background;
+      flux += f;
+      sum_x += f * xx;
+      sum_y += f * yy;
+    }
+  }
+  if (flux <= 0)
+    return false;
+
+  double cx = sum_x / flux;
+  double cy = sum_y / flux;
+  double sum_r = 0, sum_r2 = 0;
+  for (uint32_t yy = y0; yy <= y1; yy++) {
+    const T *row = pixels + size_t(yy) * width;
+    for (uint32_t xx = x0; xx <= x1; xx++) {
+      double px = double(xx) - x;
+      double py = double(yy) - y;
+      if (row[xx] <= floor || px * px + py * py > r2_max)
+        continue;
+      double f = row[xx] - background;
+      double dx = xx - cx;
+      double dy = yy - cy;
+      double r2 = dx * dx + dy * dy;
+      sum_r += f * std::sqrt(r2);
+      sum_r2 += f * r2;
+    }
+  }
+
+  result.hfr = sum_r / flux;
+  result.fwhm = sigma_to_fwhm * std::sqrt(sum_r2 / (2 * flux));
+  return true;
+}
+
+// Peak of its own 5x5 neighbourhood. Ties go to the first pixel in raster
+// order so a flat topped star is only counted once.
+template <typename T>
+bool is_local_max(const T *pixels, uint32_t width, uint32_t x, uint32_t y) {
+  T v = pixels[size_t(y) * width + x];
+  for (int dy = -2; dy <= 2; dy++) {
+    const T *row = pixels + size_t(int64_t(y) + dy) * width;
+    for (int dx = -2; dx <= 2; dx++) {
+      if (dx == 0 && dy == 0)
+        continue;
+      T n = row[int64_t(x) + dx];
+      if (n > v || (n == v && (dy < 0 || (dy == 0 && dx < 0))))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Single hot pixels pass the local max test, real stars spill into their
+// neighbours
+template <typename T>
+bool has_neighbours(const T *pixels, uint32_t width, uint32_t x, uint32_t y,
+                    double level) {
+  int above = 0;
+  for (int dy = -1; dy <= 1; dy++)
+    for (int dx = -1; dx <= 1; dx++)
+      if ((dx || dy) &&
+          pixels[size_t(int64_t(y) + dy) * width + int64_t(x) + dx] > level)
+        above++;
+  return above >= 2;
+}
+
+template <typename T>
+void detect_stars(const camera_frame_t &frame, uint32_t row_begin,
+                  uint32_t row_end, T threshold, double background,
+                  double noise, const frame_stats_options_t &options,
+                  band_stars_t &stars) {
+  const T *pixels = frame.pixels<T>();
+  uint32_t width = frame.width;
+  uint32_t height = frame.height;
+  const T saturated = std::numeric_limits<T>::max();
+  double neighbour_level = background + 3 * noise;
+
+  row_begin = std::max(row_begin, edge_margin);
+  row_end = std::min(row_end, height - edge_margin);
+  uint32_t x_end = width - edge_margin;
+
+  for (uint32_t y = row_begin; y < row_end; y++) {
+    const T *row = pixels + size_t(y) * width;
+    uint32_t x = edge_margin;
+    while (x < x_end) {
+      x += image_kernels::find_above(row + x, x_end - x, threshold);
+      if (x >= x_end)
+        break;
+
+      if (is_local_max(pixels, width, x, y) &&
+          has_neighbours(pixels, width, x, y, neighbour_level)) {
+        stars.count++;
+        // Saturated stars still count but their profile is meaningless
+        star_measurement_t m;
+        if (row[x] < saturated &&
+            stars.measured.size() < options.max_stars_per_band &&
+            measure_star(pixels, width, height, x, y, background, noise,
+                         options.star_radius, m))
+          stars.measured.push_back(m);
+      }
+      x++;
+    }
+  }
+}
+
+double median_of(std::vector<double> &values) {
+  if (values.empty())
+    return 0;
+  auto mid = values.begin() + values.size() / 2;
+  std::nth_element(values.begin(), mid, values.end());
+  return *mid;
+}
+
+template <typename T>
+void compute(const camera_frame_t &frame, worker_pool_t &pool,
+             const frame_stats_options_t &options, frame_stats_t &stats) {
+  const T *pixels = frame.pixels<T>();
+  const size_t levels = size_t(std::numeric_limits<T>::max()) + 1;
+  const size_t num_pixels = frame.num_pixels();
+
+  // Histogram first, everything but the star metrics falls out of it. Each
+  // band gets its own so there's no sharing between threads.
+  size_t bands = std::min<size_t>(pool.concurrency(), frame.height);
+  size_t rows_per_band = (frame.height + bands - 1) / bands;
+  std::vector<std::vector<uint32_t>> band_histograms(bands);
+  pool.parallel_for(bands, [&](size_t band) {
+    auto &histogram = band_histograms[band];
+    histogram.assign(levels, 0);
+    size_t begin = band * rows_per_band * frame.width;
+    size_t end = std::min(num_pixels, begin + rows_per_band * frame.width);
+    for (size_t i = begin; i < end; i++)
+      histogram[pixels[i]]++;
+  });
+
+  stats.histogram.assign(levels, 0);
+  for (auto &histogram : band_histograms)
+    for (size_t v = 0; v < levels; v++)
+      stats.histogram[v] += histogram[v];
+  band_histograms.clear();
+
+  auto &histogram = stats.histogram;
+  double sum = 0, sum_sq = 0;
+  uint64_t seen = 0;
+  bool have_min = false;
+  bool have_median = false;
+  const uint64_t half = (num_pixels + 1) / 2;
+  for (size_t v = 0; v < levels; v++) {
+    if (!histogram[v])
+      continue;
+    if (!have_min) {
+      stats.min = v;
+      have_min = true;
+    }
+    stats.max = v;
+    sum += double(v) * histogram[v];
+    sum_sq += double(v) * v * histogram[v];
+    seen += histogram[v];
+    if (!have_median && seen >= half) {
+      stats.median = v;
+      have_median = true;
+    }
+  }
+  stats.mean = sum / num_pixels;
+  stats.std_dev =
+      std::sqrt(std::max(0.0, sum_sq / num_pixels - stats.mean * stats.mean));
+
+  // Median absolute deviation, growing out from the median until half the
+  // pixels are covered
+  uint64_t covered = histogram[stats.median];
+  size_t mad = 0;
+  while (covered < half) {
+    mad++;
+    if (stats.median >= mad)
+      covered += histogram[stats.median - mad];
+    if (stats.median + mad < levels)
+      covered += histogram[stats.median + mad];
+  }
+  stats.background = stats.median;
+  stats.noise = mad * mad_to_sigma;
+
+  if (frame.width <= 2 * edge_margin || frame.height <= 2 * edge_margin)
+    return;
+
+  // Quantization can make the MAD 0 on very clean frames, keep the
+  // threshold at least a few ADU above the sky
+  double detection_noise = std::max(stats.noise, 1.0);
+  double threshold = std::ceil(stats.background +
+                               options.detection_sigma * detection_noise);
+  if (threshold >= levels - 1)
+    return;
+
+  // Smaller bands than for the histogram since stars aren't spread evenly
+  bands = std::min<size_t>(pool.concurrency() * 4, frame.height);
+  rows_per_band = (frame.height + bands - 1) / bands;
+  std::vector<band_stars_t> band_stars(bands);
+  pool.parallel_for(bands, [&](size_t band) {
+    uint32_t begin = band * rows_per_band;
+    uint32_t end = std::min<size_t>(frame.height, begin + rows_per_band);
+    detect_stars<T>(frame, begin, end, T(threshold), stats.background,
+                    detection_noise, options, band_stars[band]);
+  });
+
+  std::vector<double> hfrs, fwhms;
+  for (auto &stars : band_stars) {
+    stats.star_count += stars.count;
+    for (auto &m : stars.measured) {
+      hfrs.push_back(m.hfr);
+      fwhms.push_back(m.fwhm);
+    }
+  }
+  stats.median_hfr = median_of(hfrs);
+  stats.median_fwhm = median_of(fwhms);
+}
+
+double round_3(double v) { return std::round(v * 1000) / 1000; }
+
+} // namespace
+
+frame_stats_t compute_frame_stats(const camera_frame_t &frame,
+                                  worker_pool_t &pool,
+                                  const frame_stats_options_t &options) {
+  auto start = std::chrono::steady_clock::now();
+  frame_stats_t stats;
+  stats.width = frame.width;
+  stats.height = frame.height;
+
+  if (frame.num_pixels() > 0 && frame.data()) {
+    if (frame.bytes_per_pixel() == 1)
+      compute<uint8_t>(frame, pool, options, stats);
+    else
+      compute<uint16_t>(frame, pool, options, stats);
+  }
+
+  stats.compute_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return stats;
+}
+
+std::vector<uint32_t> rebin_histogram(const std::vector<uint32_t> &histogram,
+                                      size_t bins) {
+  bins = std::min(bins, histogram.size());
+  std::vector<uint32_t> result(bins, 0);
+  if (bins == 0)
+    return result;
+  for (size_t v = 0; v < histogram.size(); v++)
+    result[v * bins / histogram.size()] += histogram[v];
+  return result;
+}
+
+std::string frame_stats_to_json(const frame_stats_t &stats,
+                                size_t histogram_bins) {
+  nlohmann::json j;
+  j["Width"] = stats.width;
+  j["Height"] = stats.height;
+  j["Min"] = stats.min;
+  j["Max"] = stats.max;
+  j["Mean"] = round_3(stats.mean);
+  j["Median"] = stats.median;
+  j["StdDev"] = round_3(stats.std_dev);
+  j["Background"] = round_3(stats.background);
+  j["Noise"] = round_3(stats.noise);
+  j["StarCount"] = stats.star_count;
+  j["MedianHFR"] = round_3(stats.median_hfr);
+  j["MedianFWHM"] = round_3(stats.median_fwhm);
+  j["ComputeMs"] = round_3(stats.compute_ms);
+  if (histogram_bins)
+    j["Histogram"] = rebin_histogram(stats.histogram, histogram_bins);
+  return j.dump();
+}
+
+size_t frame_stats_histogram_bins(
+    const std::map<std::string, std::string> &action_params) {
+  auto parameters = action_params.find("Parameters");
+  if (parameters == action_params.end() || parameters->second.empty())
+    return 0;
+  try {
+    return std::stoul(parameters->second);
+  } catch (std::exception &ex) {
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("FrameStats Parameters should be the number of "
+                    "histogram bins, got: {}",
+                    parameters->second));
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include "common/camera_frame.hpp"
+#include "common/worker_pool.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Statistics worked out on the hub so focus / exposure planning clients
+// don't have to download whole frames to get them
+struct frame_stats_t {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  uint32_t min = 0;
+  uint32_t max = 0;
+  double mean = 0;
+  uint32_t median = 0;
+  double std_dev = 0;
+
+  // Robust estimates of the sky: the median and 1.4826 * MAD, so stars and
+  // hot pixels don't drag them around
+  double background = 0;
+  double noise = 0;
+
+  uint32_t star_count = 0;
+  // Medians over the detected stars, in (binned) pixels. 0 if no stars.
+  double median_hfr = 0;
+  double median_fwhm = 0;
+
+  // One bin per ADU, i.e. 256 bins for 8 bit frames and 65536 for 16 bit
+  std::vector<uint32_t> histogram;
+
+  double compute_ms = 0;
+};
+
+struct frame_stats_options_t {
+  // Pixels this many noise sigmas above the background can start a star
+  double detection_sigma = 5;
+  // Stars are measured within this many pixels of their peak
+  uint32_t star_radius = 10;
+  // Per row band, stops a very noisy frame from taking forever
+  uint32_t max_stars_per_band = 500;
+};
+
+frame_stats_t compute_frame_stats(const camera_frame_t &frame,
+                                  worker_pool_t &pool,
+                                  const frame_stats_options_t &options = {});
+
+// Folds the full histogram down to bins buckets of equal width
+std::vector<uint32_t> rebin_histogram(const std::vector<uint32_t> &histogram,
+                                      size_t bins);
+
+// Compact JSON for the FrameStats action. The histogram is only included if
+// histogram_bins is non zero.
+std::string frame_stats_to_json(const frame_stats_t &stats,
+                                size_t histogram_bins = 0);
+
+// The FrameStats action's Parameters is the number of histogram bins to
+// include, empty or missing leaves the histogram out. Throws
+// alpaca_exception INVALID_VALUE if it isn't a number.
+size_t frame_stats_histogram_bins(
+    const std::map<std::string, std::string> &action_params);
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef IMAGE_ARRAY_JSON_WRITER_HPP
+#define IMAGE_ARRAY_JSON_WRITER_HPP
+
+#include "common/camera_frame.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Produces the JSON imagearray response a piece at a time so we never have
+// to hold a nlohmann::json tree (or one giant dumped string) of the whole
+// frame in memory.
+//
+// Each dimension1 entry ("row" of the Alpaca [x][y] array) is a column of
+// the frame, so we transpose a band of columns into a small scratch buffer
+// and format from there.
+//
+// prefix is the rest of the response serialized as an object, e.g.
+// {"ClientTransactionID":1,...,"Type":2} and "Value" is spliced in as the
+// last key. Since Value sorts last alphabetically this matches what
+// response_map.dump() would produce byte for byte.
+class image_array_json_writer_t {
+public:
+  image_array_json_writer_t(std::string prefix, camera_frame_ptr_t frame)
+      : _prefix(std::move(prefix)), _frame(std::move(frame)), _next_row(0),
+        _started(false), _finished(false) {
+    if (!_prefix.empty() && _prefix.back() == '}')
+      _prefix.pop_back();
+  }
+
+  bool finished() const { return _finished; }
+
+  // Fills chunk with at least one row (or the opening / closing pieces) and
+  // keeps adding rows until it is around target_size. Returns false once
+  // everything has been written.
+  bool next_chunk(std::string &chunk, size_t target_size = 256 * 1024) {
+    chunk.clear();
+    if (_finished)
+      return false;
+
+    if (!_started) {
+      chunk.append(_prefix);
+      chunk.append(_prefix.size() > 1 ? ",\"Value\":[" : "\"Value\":[");
+      _started = true;
+    }
+
+    // Worst case is 5 digits and a comma per element plus the brackets
+    uint32_t dimension1 = _frame->width;
+    uint32_t dimension2 = _frame->height;
+    size_t row_size = static_cast<size_t>(dimension2) * 6 + 3;
+    uint32_t band = std::max<size_t>(1, target_size / row_size);
+    uint32_t band_end =
+        std::min<uint64_t>(dimension1, uint64_t(_next_row) + band);
+
+    chunk.reserve(chunk.size() + (band_end - _next_row) * row_size + 2);
+    _scratch.resize(static_cast<size_t>(band_end - _next_row) * dimension2 *
+                    _frame->bytes_per_pixel());
+    _frame->copy_columns(_next_row, band_end, _scratch.data());
+
+    for (uint32_t row = _next_row; row < band_end; row++) {
+      if (row > 0)
+        chunk.push_back(',');
+      append_row(chunk, row - _next_row, dimension2);
+    }
+    _next_row = band_end;
+
+    if (_next_row >= dimension1) {
+      chunk.append("]}");
+      _finished = true;
+      _scratch = std::vector<uint8_t>();
+    }
+    return true;
+  }
+
+private:
+  void append_row(std::string &chunk, uint32_t band_row,
+                  uint32_t dimension2) const {
+    char num_buf[16];
+    size_t offset = static_cast<size_t>(band_row) * dimension2;
+    chunk.push_back('[');
+    for (uint32_t col = 0; col < dimension2; col++) {
+      uint32_t val = 0;
+      if (_frame->bytes_per_pixel() == 1)
+        val = _scratch[offset + col];
+      else
+        val = reinterpret_cast<const uint16_t *>(_scratch.data())[offset + col];
+
+      if (col > 0)
+        chunk.push_back(',');
+      auto res = std::to_chars(num_buf, num_buf + sizeof(num_buf), val);
+      chunk.append(num_buf, res.ptr);
+    }
+    chunk.push_back(']');
+  }
+
+  std::string _prefix;
+  camera_frame_ptr_t _frame;
+  std::vector<uint8_t> _scratch;
+  uint32_t _next_row;
+  bool _started;
+  bool _finished;
+};
+
+#endif
@@ -2,8 +2,10 @@
 #define IMAGE_BYTES_H
 
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 #include <spdlog/spdlog.h>
+#include <string>
 #include <vector>
 
 enum image_array_element_types {
@@ -19,6 +21,32 @@ enum image_array_element_types {
   UINT32 = 9
 };
 
+// This is the fixed 44 byte ImageBytes metadata block. Every field is a 32 bit
+// little endian int so there is no padding and it can be written straight to
+// the wire in front of the pixel data.
+struct image_bytes_header_t {
+  int32_t metadata_version = 1;
+  int32_t error_number = 0;
+  uint32_t client_transaction_number = 0;
+  uint32_t server_transaction_number = 0;
+  int32_t data_start = 44;
+  int32_t image_element_type = INT32;
+  int32_t transmission_element_type = INT32;
+  int32_t rank = 2;
+  int32_t dimension1 = 0;
+  int32_t dimension2 = 0;
+  int32_t dimension3 = 0;
+
+  std::string to_string() const {
+    std::string header(sizeof(image_bytes_header_t), '\0');
+    std::memcpy(&header[0], this, sizeof(image_bytes_header_t));
+    return header;
+  }
+};
+
+static_assert(sizeof(image_bytes_header_t) == 44,
+              "ImageBytes header must be exactly 44 bytes");
+
 template <typename T> struct image_bytes_t {
   int metadata_version = 1;
   int error_number = 0;
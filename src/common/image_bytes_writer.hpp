@@ -0,0 +1,66 @@
+#ifndef IMAGE_BYTES_WRITER_HPP
+#define IMAGE_BYTES_WRITER_HPP
+
+#include "common/camera_frame.hpp"
+#include "common/image_bytes.hpp"
+#include <algorithm>
+#include <string>
+
+// Produces an ImageBytes response body from a camera frame a band of columns
+// at a time. The header goes out with the first chunk and the rest is
+// transposed straight from the frame buffer, so the only memory used beyond
+// the (shared) frame is the chunk currently being written.
+class image_bytes_writer_t {
+public:
+  image_bytes_writer_t(image_bytes_header_t header, camera_frame_ptr_t frame)
+      : _header(header), _frame(std::move(frame)), _next_column(0),
+        _started(false), _finished(false) {
+    _header.dimension1 = _frame->width;
+    _header.dimension2 = _frame->height;
+    _header.transmission_element_type = _frame->pixel_type;
+  }
+
+  size_t content_length() const {
+    return sizeof(image_bytes_header_t) + _frame->size_bytes();
+  }
+
+  bool finished() const { return _finished; }
+
+  bool next_chunk(std::string &chunk, size_t target_size = 4 * 1024 * 1024) {
+    chunk.clear();
+    if (_finished)
+      return false;
+
+    if (!_started) {
+      chunk.append(_header.to_string());
+      _started = true;
+    }
+
+    size_t column_size =
+        static_cast<size_t>(_frame->height) * _frame->bytes_per_pixel();
+    uint32_t num_columns = 1;
+    if (column_size > 0)
+      num_columns = std::max<size_t>(1, target_size / column_size);
+    uint32_t end_column =
+        std::min<uint64_t>(_frame->width, uint64_t(_next_column) + num_columns);
+
+    size_t offset = chunk.size();
+    chunk.resize(offset + (end_column - _next_column) * column_size);
+    _frame->copy_columns(_next_column, end_column,
+                         reinterpret_cast<uint8_t *>(&chunk[offset]));
+    _next_column = end_column;
+
+    if (_next_column >= _frame->width)
+      _finished = true;
+    return true;
+  }
+
+private:
+  image_bytes_header_t _header;
+  camera_frame_ptr_t _frame;
+  uint32_t _next_column;
+  bool _started;
+  bool _finished;
+};
+
+#endif
@@ -0,0 +1,600 @@
+#include "image_kernels.hpp"
+#include "alpaca_exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define IMAGE_KERNELS_HAVE_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define IMAGE_KERNELS_HAVE_NEON 1
+#endif
+
+namespace image_kernels {
+
+namespace {
+
+// Both the scalar and SIMD versions walk the frame in square tiles so the
+// rows being read and the columns being written stay in cache
+constexpr uint32_t tile_size = 64;
+
+using kernel_fn_t = void (*)(const void *src, void *dst, uint32_t width,
+                             uint32_t height, uint32_t x_begin,
+                             uint32_t x_end);
+
+template <typename D, typename S> inline D saturate_cast(S v) {
+  using dl = std::numeric_limits<D>;
+  if constexpr (std::is_floating_point_v<D>) {
+    return static_cast<D>(v);
+  } else if constexpr (std::is_floating_point_v<S>) {
+    if (std::isnan(v))
+      return 0;
+    if (v <= static_cast<S>(dl::min()))
+      return dl::min();
+    if (v >= static_cast<S>(dl::max()))
+      return dl::max();
+    return static_cast<D>(v);
+  } else {
+    if constexpr (std::is_signed_v<S>) {
+      if (v < 0) {
+        if constexpr (!std::is_signed_v<D>)
+          return 0;
+        else if (static_cast<int64_t>(v) < static_cast<int64_t>(dl::min()))
+          return dl::min();
+        return static_cast<D>(v);
+      }
+    }
+    if (static_cast<uint64_t>(v) > static_cast<uint64_t>(dl::max()))
+      return dl::max();
+    return static_cast<D>(v);
+  }
+}
+
+template <typename Src, typename Dst>
+inline void transpose_pixel(const Src *src, Dst *dst, uint32_t width,
+                            uint32_t height, uint32_t x_begin, uint32_t x,
+                            uint32_t y) {
+  dst[static_cast<size_t>(x - x_begin) * height + y] =
+      saturate_cast<Dst>(src[static_cast<size_t>(y) * width + x]);
+}
+
+template <typename Src, typename Dst>
+void transpose_scalar(const void *src_v, void *dst_v, uint32_t width,
+                      uint32_t height, uint32_t x_begin, uint32_t x_end) {
+  auto src = static_cast<const Src *>(src_v);
+  auto dst = static_cast<Dst *>(dst_v);
+  for (uint32_t y0 = 0; y0 < height; y0 += tile_size) {
+    uint32_t y1 = std::min(y0 + tile_size, height);
+    for (uint32_t x0 = x_begin; x0 < x_end; x0 += tile_size) {
+      uint32_t x1 = std::min(x0 + tile_size, x_end);
+      for (uint32_t x = x0; x < x1; x++)
+        for (uint32_t y = y0; y < y1; y++)
+          transpose_pixel(src, dst, width, height, x_begin, x, y);
+    }
+  }
+}
+
+// Handles the tiling and everything around the 8x8 blocks that the SIMD
+// kernels do
+#define DEFINE_BLOCKED_TRANSPOSE(NAME, TARGET)                                 \
+  template <typename Src, typename Dst,                                        \
+            void (*Block)(const Src *, uint32_t, Dst *, uint32_t)>             \
+  TARGET void NAME(const void *src_v, void *dst_v, uint32_t width,             \
+                   uint32_t height, uint32_t x_begin, uint32_t x_end) {        \
+    auto src = static_cast<const Src *>(src_v);                                \
+    auto dst = static_cast<Dst *>(dst_v);                                      \
+    uint32_t block_height = height - height % 8;                               \
+    for (uint32_t yt = 0; yt < block_height; yt += tile_size) {                \
+      uint32_t yt_end = std::min(yt + tile_size, block_height);                \
+      for (uint32_t xt = x_begin; xt < x_end; xt += tile_size) {               \
+        uint32_t xt_end = std::min(xt + tile_size, x_end);                     \
+        for (uint32_t y = yt; y < yt_end; y += 8) {                            \
+          uint32_t x = xt;                                                     \
+          for (; x + 8 <= xt_end; x += 8)                                      \
+            Block(src + static_cast<size_t>(y) * width + x, width,             \
+                  dst + static_cast<size_t>(x - x_begin) * height + y,         \
+                  height);                                                     \
+          for (; x < xt_end; x++)                                              \
+            for (uint32_t yy = y; yy < y + 8; yy++)                            \
+              transpose_pixel(src, dst, width, height, x_begin, x, yy);        \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    for (uint32_t y = block_height; y < height; y++)                           \
+      for (uint32_t x = x_begin; x < x_end; x++)                               \
+        transpose_pixel(src, dst, width, height, x_begin, x, y);               \
+  }
+
+#if defined(IMAGE_KERNELS_HAVE_AVX2)
+
+// The 8x8 16 bit transpose only needs SSE2 but the widening stores want
+// AVX2, and every AVX2 machine has the rest
+AVX2_TARGET inline void transpose_8x8_u16(__m128i r[8]) {
+  __m128i b0 = _mm_unpacklo_epi16(r[0], r[1]);
+  __m128i b1 = _mm_unpackhi_epi16(r[0], r[1]);
+  __m128i b2 = _mm_unpacklo_epi16(r[2], r[3]);
+  __m128i b3 = _mm_unpackhi_epi16(r[2], r[3]);
+  __m128i b4 = _mm_unpacklo_epi16(r[4], r[5]);
+  __m128i b5 = _mm_unpackhi_epi16(r[4], r[5]);
+  __m128i b6 = _mm_unpacklo_epi16(r[6], r[7]);
+  __m128i b7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+  __m128i c0 = _mm_unpacklo_epi32(b0, b2);
+  __m128i c1 = _mm_unpackhi_epi32(b0, b2);
+  __m128i c2 = _mm_unpacklo_epi32(b1, b3);
+  __m128i c3 = _mm_unpackhi_epi32(b1, b3);
+  __m128i c4 = _mm_unpacklo_epi32(b4, b6);
+  __m128i c5 = _mm_unpackhi_epi32(b4, b6);
+  __m128i c6 = _mm_unpacklo_epi32(b5, b7);
+  __m128i c7 = _mm_unpackhi_epi32(b5, b7);
+
+  r[0] = _mm_unpacklo_epi64(c0, c4);
+  r[1] = _mm_unpackhi_epi64(c0, c4);
+  r[2] = _mm_unpacklo_epi64(c1, c5);
+  r[3] = _mm_unpackhi_epi64(c1, c5);
+  r[4] = _mm_unpacklo_epi64(c2, c6);
+  r[5] = _mm_unpackhi_epi64(c2, c6);
+  r[6] = _mm_unpacklo_epi64(c3, c7);
+  r[7] = _mm_unpackhi_epi64(c3, c7);
+}
+
+AVX2_TARGET inline void load_8x8(const uint16_t *src, uint32_t stride,
+                                 __m128i r[8]) {
+  for (int i = 0; i < 8; i++)
+    r[i] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(src + static_cast<size_t>(i) * stride));
+  transpose_8x8_u16(r);
+}
+
+// 8 bit data is widened to 16 bit first so both share the same transpose
+AVX2_TARGET inline void load_8x8(const uint8_t *src, uint32_t stride,
+                                 __m128i r[8]) {
+  for (int i = 0; i < 8; i++)
+    r[i] = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(
+        src + static_cast<size_t>(i) * stride)));
+  transpose_8x8_u16(r);
+}
+
+template <typename Src>
+AVX2_TARGET void block_avx2_to_u8(const Src *src, uint32_t src_stride,
+                                  uint8_t *dst, uint32_t dst_stride) {
+  __m128i r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++) {
+    __m128i v = r[i];
+    // packus works on signed values so clamp anything above 255 first
+    if constexpr (sizeof(Src) > 1)
+      v = _mm_min_epu16(v, _mm_set1_epi16(0xff));
+    _mm_storel_epi64(
+        reinterpret_cast<__m128i *>(dst + static_cast<size_t>(i) * dst_stride),
+        _mm_packus_epi16(v, v));
+  }
+}
+
+template <typename Src>
+AVX2_TARGET void block_avx2_to_u16(const Src *src, uint32_t src_stride,
+                                   uint16_t *dst, uint32_t dst_stride) {
+  __m128i r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + static_cast<size_t>(i) * dst_stride),
+        r[i]);
+}
+
+template <typename Src>
+AVX2_TARGET void block_avx2_to_i16(const Src *src, uint32_t src_stride,
+                                   int16_t *dst, uint32_t dst_stride) {
+  __m128i r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + static_cast<size_t>(i) * dst_stride),
+        _mm_min_epu16(r[i], _mm_set1_epi16(0x7fff)));
+}
+
+// Works for both Int32 and UInt32 since the values are at most 16 bits
+template <typename Src, typename Dst>
+AVX2_TARGET void block_avx2_to_32(const Src *src, uint32_t src_stride,
+                                  Dst *dst, uint32_t dst_stride) {
+  __m128i r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + static_cast<size_t>(i) * dst_stride),
+        _mm256_cvtepu16_epi32(r[i]));
+}
+
+DEFINE_BLOCKED_TRANSPOSE(transpose_avx2, AVX2_TARGET)
+
+kernel_fn_t avx2_kernel(image_array_element_types src_type,
+                        image_array_element_types dst_type) {
+  using t = image_array_element_types;
+  if (src_type == t::BYTE) {
+    switch (dst_type) {
+    case t::BYTE:
+      return transpose_avx2<uint8_t, uint8_t, block_avx2_to_u8<uint8_t>>;
+    case t::INT16:
+      return transpose_avx2<uint8_t, int16_t, block_avx2_to_i16<uint8_t>>;
+    case t::UINT16:
+      return transpose_avx2<uint8_t, uint16_t, block_avx2_to_u16<uint8_t>>;
+    case t::INT32:
+      return transpose_avx2<uint8_t, int32_t,
+                            block_avx2_to_32<uint8_t, int32_t>>;
+    case t::UINT32:
+      return transpose_avx2<uint8_t, uint32_t,
+                            block_avx2_to_32<uint8_t, uint32_t>>;
+    default:
+      return nullptr;
+    }
+  }
+
+  if (src_type == t::UINT16) {
+    switch (dst_type) {
+    case t::BYTE:
+      return transpose_avx2<uint16_t, uint8_t, block_avx2_to_u8<uint16_t>>;
+    case t::INT16:
+      return transpose_avx2<uint16_t, int16_t, block_avx2_to_i16<uint16_t>>;
+    case t::UINT16:
+      return transpose_avx2<uint16_t, uint16_t, block_avx2_to_u16<uint16_t>>;
+    case t::INT32:
+      return transpose_avx2<uint16_t, int32_t,
+                            block_avx2_to_32<uint16_t, int32_t>>;
+    case t::UINT32:
+      return transpose_avx2<uint16_t, uint32_t,
+                            block_avx2_to_32<uint16_t, uint32_t>>;
+    default:
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+#endif
+
+#if defined(IMAGE_KERNELS_HAVE_NEON)
+
+inline void transpose_8x8_u16(uint16x8_t r[8]) {
+  uint16x8x2_t t01 = vtrnq_u16(r[0], r[1]);
+  uint16x8x2_t t23 = vtrnq_u16(r[2], r[3]);
+  uint16x8x2_t t45 = vtrnq_u16(r[4], r[5]);
+  uint16x8x2_t t67 = vtrnq_u16(r[6], r[7]);
+
+  // columns 0/4 and 2/6 from the even lanes, 1/5 and 3/7 from the odd
+  uint32x4x2_t u02 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[0]),
+                               vreinterpretq_u32_u16(t23.val[0]));
+  uint32x4x2_t u13 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[1]),
+                               vreinterpretq_u32_u16(t23.val[1]));
+  uint32x4x2_t v02 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[0]),
+                               vreinterpretq_u32_u16(t67.val[0]));
+  uint32x4x2_t v13 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[1]),
+                               vreinterpretq_u32_u16(t67.val[1]));
+
+  auto low = [](uint32x4_t a, uint32x4_t b) {
+    return vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(a), vget_low_u32(b)));
+  };
+  auto high = [](uint32x4_t a, uint32x4_t b) {
+    return vreinterpretq_u16_u32(
+        vcombine_u32(vget_high_u32(a), vget_high_u32(b)));
+  };
+
+  r[0] = low(u02.val[0], v02.val[0]);
+  r[1] = low(u13.val[0], v13.val[0]);
+  r[2] = low(u02.val[1], v02.val[1]);
+  r[3] = low(u13.val[1], v13.val[1]);
+  r[4] = high(u02.val[0], v02.val[0]);
+  r[5] = high(u13.val[0], v13.val[0]);
+  r[6] = high(u02.val[1], v02.val[1]);
+  r[7] = high(u13.val[1], v13.val[1]);
+}
+
+inline void load_8x8(const uint16_t *src, uint32_t stride, uint16x8_t r[8]) {
+  for (int i = 0; i < 8; i++)
+    r[i] = vld1q_u16(src + static_cast<size_t>(i) * stride);
+  transpose_8x8_u16(r);
+}
+
+inline void load_8x8(const uint8_t *src, uint32_t stride, uint16x8_t r[8]) {
+  for (int i = 0; i < 8; i++)
+    r[i] = vmovl_u8(vld1_u8(src + static_cast<size_t>(i) * stride));
+  transpose_8x8_u16(r);
+}
+
+template <typename Src>
+void block_neon_to_u8(const Src *src, uint32_t src_stride, uint8_t *dst,
+                      uint32_t dst_stride) {
+  uint16x8_t r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    vst1_u8(dst + static_cast<size_t>(i) * dst_stride, vqmovn_u16(r[i]));
+}
+
+template <typename Src>
+void block_neon_to_u16(const Src *src, uint32_t src_stride, uint16_t *dst,
+                       uint32_t dst_stride) {
+  uint16x8_t r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    vst1q_u16(dst + static_cast<size_t>(i) * dst_stride, r[i]);
+}
+
+template <typename Src>
+void block_neon_to_i16(const Src *src, uint32_t src_stride, int16_t *dst,
+                       uint32_t dst_stride) {
+  uint16x8_t r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++)
+    vst1q_s16(dst + static_cast<size_t>(i) * dst_stride,
+              vreinterpretq_s16_u16(vminq_u16(r[i], vdupq_n_u16(0x7fff))));
+}
+
+template <typename Src, typename Dst>
+void block_neon_to_32(const Src *src, uint32_t src_stride, Dst *dst,
+                      uint32_t dst_stride) {
+  uint16x8_t r[8];
+  load_8x8(src, src_stride, r);
+  for (int i = 0; i < 8; i++) {
+    auto out = reinterpret_cast<uint32_t *>(dst + static_cast<size_t>(i) *
+                                                      dst_stride);
+    vst1q_u32(out, vmovl_u16(vget_low_u16(r[i])));
+    vst1q_u32(out + 4, vmovl_u16(vget_high_u16(r[i])));
+  }
+}
+
+DEFINE_BLOCKED_TRANSPOSE(transpose_neon, )
+
+kernel_fn_t neon_kernel(image_array_element_types src_type,
+                        image_array_element_types dst_type) {
+  using t = image_array_element_types;
+  if (src_type == t::BYTE) {
+    switch (dst_type) {
+    case t::BYTE:
+      return transpose_neon<uint8_t, uint8_t, block_neon_to_u8<uint8_t>>;
+    case t::INT16:
+      return transpose_neon<uint8_t, int16_t, block_neon_to_i16<uint8_t>>;
+    case t::UINT16:
+      return transpose_neon<uint8_t, uint16_t, block_neon_to_u16<uint8_t>>;
+    case t::INT32:
+      return transpose_neon<uint8_t, int32_t,
+                            block_neon_to_32<uint8_t, int32_t>>;
+    case t::UINT32:
+      return transpose_neon<uint8_t, uint32_t,
+                            block_neon_to_32<uint8_t, uint32_t>>;
+    default:
+      return nullptr;
+    }
+  }
+
+  if (src_type == t::UINT16) {
+    switch (dst_type) {
+    case t::BYTE:
+      return transpose_neon<uint16_t, uint8_t, block_neon_to_u8<uint16_t>>;
+    case t::INT16:
+      return transpose_neon<uint16_t, int16_t, block_neon_to_i16<uint16_t>>;
+    case t::UINT16:
+      return transpose_neon<uint16_t, uint16_t, block_neon_to_u16<uint16_t>>;
+    case t::INT32:
+      return transpose_neon<uint16_t, int32_t,
+                            block_neon_to_32<uint16_t, int32_t>>;
+    case t::UINT32:
+      return transpose_neon<uint16_t, uint32_t,
+                            block_neon_to_32<uint16_t, uint32_t>>;
+    default:
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+#endif
+
+template <typename T>
+size_t find_above_scalar(const T *src, size_t begin, size_t count,
+                         T threshold) {
+  for (size_t i = begin; i < count; i++)
+    if (src[i] > threshold)
+      return i;
+  return count;
+}
+
+#if defined(IMAGE_KERNELS_HAVE_AVX2)
+
+// There's no unsigned compare in AVX2, but v > t is the same as
+// max(v, t + 1) == v. A threshold at the type's max can never be exceeded
+// so that case never gets here.
+AVX2_TARGET size_t find_above_avx2(const uint16_t *src, size_t count,
+                                   uint16_t threshold) {
+  const __m256i t = _mm256_set1_epi16(static_cast<short>(threshold + 1));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    int mask =
+        _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_max_epu16(v, t), v));
+    if (mask)
+      return i + __builtin_ctz(mask) / 2;
+  }
+  return find_above_scalar(src, i, count, threshold);
+}
+
+AVX2_TARGET size_t find_above_avx2(const uint8_t *src, size_t count,
+                                   uint8_t threshold) {
+  const __m256i t = _mm256_set1_epi8(static_cast<char>(threshold + 1));
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    int mask =
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v));
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+  return find_above_scalar(src, i, count, threshold);
+}
+
+#endif
+
+#if defined(IMAGE_KERNELS_HAVE_NEON)
+
+// NEON has no movemask, so find the block with vmaxv and let the scalar loop
+// pick out the pixel
+size_t find_above_neon(const uint16_t *src, size_t count, uint16_t threshold) {
+  const uint16x8_t t = vdupq_n_u16(threshold);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    if (vmaxvq_u16(vcgtq_u16(vld1q_u16(src + i), t)))
+      return find_above_scalar(src, i, i + 8, threshold);
+  return find_above_scalar(src, i, count, threshold);
+}
+
+size_t find_above_neon(const uint8_t *src, size_t count, uint8_t threshold) {
+  const uint8x16_t t = vdupq_n_u8(threshold);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16)
+    if (vmaxvq_u8(vcgtq_u8(vld1q_u8(src + i), t)))
+      return find_above_scalar(src, i, i + 16, threshold);
+  return find_above_scalar(src, i, count, threshold);
+}
+
+#endif
+
+// Calls fn with a value of the C++ type matching the Alpaca element type
+template <typename F> auto visit_element_type(image_array_element_types type, F &&fn) {
+  using t = image_array_element_types;
+  switch (type) {
+  case t::INT16:
+    return fn(int16_t{});
+  case t::INT32:
+    return fn(int32_t{});
+  case t::DOUBLE:
+    return fn(double{});
+  case t::SINGLE:
+    return fn(float{});
+  case t::UINT64:
+    return fn(uint64_t{});
+  case t::BYTE:
+    return fn(uint8_t{});
+  case t::INT64:
+    return fn(int64_t{});
+  case t::UINT16:
+    return fn(uint16_t{});
+  case t::UINT32:
+    return fn(uint32_t{});
+  default:
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Unsupported image element type: {}", int(type)));
+  }
+}
+
+kernel_fn_t scalar_kernel(image_array_element_types src_type,
+                          image_array_element_types dst_type) {
+  return visit_element_type(src_type, [dst_type](auto src_v) {
+    return visit_element_type(dst_type, [](auto dst_v) {
+      return static_cast<kernel_fn_t>(
+          transpose_scalar<decltype(src_v), decltype(dst_v)>);
+    });
+  });
+}
+
+kernel_isa_t detect_isa() {
+#if defined(IMAGE_KERNELS_HAVE_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return kernel_isa_t::AVX2;
+#elif defined(IMAGE_KERNELS_HAVE_NEON)
+  // NEON is part of the base aarch64 ISA so there is nothing to check
+  return kernel_isa_t::NEON;
+#endif
+  return kernel_isa_t::SCALAR;
+}
+
+} // namespace
+
+kernel_isa_t active_isa() {
+  static const kernel_isa_t isa = detect_isa();
+  return isa;
+}
+
+const char *isa_name(kernel_isa_t isa) {
+  switch (isa) {
+  case kernel_isa_t::AVX2:
+    return "avx2";
+  case kernel_isa_t::NEON:
+    return "neon";
+  default:
+    return "scalar";
+  }
+}
+
+size_t element_size(image_array_element_types type) {
+  return visit_element_type(type, [](auto v) { return sizeof(v); });
+}
+
+void transpose_convert(kernel_isa_t isa, const void *src,
+                       image_array_element_types src_type, void *dst,
+                       image_array_element_types dst_type, uint32_t width,
+                       uint32_t height, uint32_t x_begin, uint32_t x_end) {
+  x_end = std::min(x_end, width);
+  if (x_begin >= x_end || height == 0)
+    return;
+
+  kernel_fn_t kernel = nullptr;
+#if defined(IMAGE_KERNELS_HAVE_AVX2)
+  if (isa == kernel_isa_t::AVX2 && active_isa() == kernel_isa_t::AVX2)
+    kernel = avx2_kernel(src_type, dst_type);
+#elif defined(IMAGE_KERNELS_HAVE_NEON)
+  if (isa == kernel_isa_t::NEON)
+    kernel = neon_kernel(src_type, dst_type);
+#endif
+  if (!kernel)
+    kernel = scalar_kernel(src_type, dst_type);
+
+  kernel(src, dst, width, height, x_begin, x_end);
+}
+
+void transpose_convert(const void *src, image_array_element_types src_type,
+                       void *dst, image_array_element_types dst_type,
+                       uint32_t width, uint32_t height, uint32_t x_begin,
+                       uint32_t x_end) {
+  transpose_convert(active_isa(), src, src_type, dst, dst_type, width, height,
+                    x_begin, x_end);
+}
+
+template <typename T>
+size_t find_above_dispatch(kernel_isa_t isa, const T *src, size_t count,
+                           T threshold) {
+  if (threshold == std::numeric_limits<T>::max())
+    return count;
+#if defined(IMAGE_KERNELS_HAVE_AVX2)
+  if (isa == kernel_isa_t::AVX2 && active_isa() == kernel_isa_t::AVX2)
+    return find_above_avx2(src, count, threshold);
+#elif defined(IMAGE_KERNELS_HAVE_NEON)
+  if (isa == kernel_isa_t::NEON)
+    return find_above_neon(src, count, threshold);
+#endif
+  return find_above_scalar(src, 0, count, threshold);
+}
+
+size_t find_above(kernel_isa_t isa, const uint16_t *src, size_t count,
+                  uint16_t threshold) {
+  return find_above_dispatch(isa, src, count, threshold);
+}
+
+size_t find_above(kernel_isa_t isa, const uint8_t *src, size_t count,
+                  uint8_t threshold) {
+  return find_above_dispatch(isa, src, count, threshold);
+}
+
+size_t find_above(const uint16_t *src, size_t count, uint16_t threshold) {
+  return find_above_dispatch(active_isa(), src, count, threshold);
+}
+
+size_t find_above(const uint8_t *src, size_t count, uint8_t threshold) {
+  return find_above_dispatch(active_isa(), src, count, threshold);
+}
+
+} // namespace image_kernels
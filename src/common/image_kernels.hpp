@@ -0,0 +1,56 @@
+#ifndef IMAGE_KERNELS_HPP
+#define IMAGE_KERNELS_HPP
+
+#include "common/image_bytes.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Kernels for turning the row major sensor buffer into Alpaca's [x][y]
+// order while converting the element type at the same time, so we only
+// touch every pixel once on the way out.
+//
+// The 8 and 16 bit sources going to Byte / UInt16 / Int32 are the ones we
+// actually send so they get SIMD paths (AVX2 on x86_64, NEON on aarch64).
+// Everything else goes through the scalar version which handles every
+// image_array_element_types combination.
+namespace image_kernels {
+
+enum class kernel_isa_t { SCALAR, AVX2, NEON };
+
+// What transpose_convert will use on this machine, decided once at startup
+kernel_isa_t active_isa();
+const char *isa_name(kernel_isa_t isa);
+
+size_t element_size(image_array_element_types type);
+
+// Transposes columns [x_begin, x_end) of a width x height row major src
+// buffer of src_type into dst, converting each element to dst_type. dst
+// starts at column x_begin and each column is height elements long.
+//
+// Narrowing conversions saturate rather than wrap.
+void transpose_convert(const void *src, image_array_element_types src_type,
+                       void *dst, image_array_element_types dst_type,
+                       uint32_t width, uint32_t height, uint32_t x_begin,
+                       uint32_t x_end);
+
+// Same as above but forcing a particular implementation. If the isa isn't
+// available (or doesn't handle the combination) the scalar version is used.
+void transpose_convert(kernel_isa_t isa, const void *src,
+                       image_array_element_types src_type, void *dst,
+                       image_array_element_types dst_type, uint32_t width,
+                       uint32_t height, uint32_t x_begin, uint32_t x_end);
+
+// Index of the first of the count pixels in src that is above threshold, or
+// count if none are. Star detection spends nearly all of its time skipping
+// over background so this gets the SIMD treatment too.
+size_t find_above(const uint16_t *src, size_t count, uint16_t threshold);
+size_t find_above(const uint8_t *src, size_t count, uint8_t threshold);
+
+size_t find_above(kernel_isa_t isa, const uint16_t *src, size_t count,
+                  uint16_t threshold);
+size_t find_above(kernel_isa_t isa, const uint8_t *src, size_t count,
+                  uint8_t threshold);
+
+} // namespace image_kernels
+
+#endif
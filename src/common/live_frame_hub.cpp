@@ -0,0 +1,104 @@
+#include "live_frame_hub.hpp"
+#include <algorithm>
+
+live_subscription_t::live_subscription_t(size_t depth,
+                                         std::function<void()> notify)
+    : _frames(depth), _notify(std::move(notify)), _dropped(0),
+      _closed(false) {}
+
+bool live_subscription_t::try_pop(camera_frame_ptr_t &frame) {
+  return _frames.try_pop(frame);
+}
+
+void live_subscription_t::offer(const camera_frame_ptr_t &frame) {
+  if (_closed)
+    return;
+  if (!_frames.try_push(frame)) {
+    _dropped++;
+    return;
+  }
+  if (_notify)
+    _notify();
+}
+
+void live_subscription_t::close() {
+  if (_closed.exchange(true))
+    return;
+  if (_notify)
+    _notify();
+}
+
+live_frame_hub_t::live_frame_hub_t(size_t max_queued)
+    : _max_queued(max_queued),
+      _subscribers(std::make_shared<const subscriber_list_t>()) {}
+
+void live_frame_hub_t::set_max_queued(size_t max_queued) {
+  std::lock_guard lock(_subscribe_mtx);
+  _max_queued = max_queued;
+}
+
+size_t live_frame_hub_t::max_queued() {
+  std::lock_guard lock(_subscribe_mtx);
+  return _max_queued;
+}
+
+live_subscription_ptr_t
+live_frame_hub_t::subscribe(size_t depth, std::function<void()> notify) {
+  std::lock_guard lock(_subscribe_mtx);
+  auto subscribers =
+      std::make_shared<subscriber_list_t>(*std::atomic_load(&_subscribers));
+
+  if (_max_queued) {
+    size_t queued = 0;
+    for (auto &subscription : *subscribers)
+      queued += subscription->depth();
+    if (queued + 2 > _max_queued)
+      return nullptr;
+    // The ring rounds up to a power of two, so round what's left down
+    size_t room = 2;
+    while (room * 2 <= _max_queued - queued)
+      room *= 2;
+    depth = std::min(depth, room);
+  }
+
+  auto subscription =
+      std::make_shared<live_subscription_t>(depth, std::move(notify));
+  subscribers->push_back(subscription);
+  std::atomic_store(&_subscribers,
+                    std::shared_ptr<const subscriber_list_t>(subscribers));
+  return subscription;
+}
+
+void live_frame_hub_t::unsubscribe(
+    const live_subscription_ptr_t &subscription) {
+  std::lock_guard lock(_subscribe_mtx);
+  auto subscribers =
+      std::make_shared<subscriber_list_t>(*std::atomic_load(&_subscribers));
+  subscribers->erase(
+      std::remove(subscribers->begin(), subscribers->end(), subscription),
+      subscribers->end());
+  std::atomic_store(&_subscribers,
+                    std::shared_ptr<const subscriber_list_t>(subscribers));
+}
+
+void live_frame_hub_t::publish(const camera_frame_ptr_t &frame) {
+  auto subscribers = std::atomic_load(&_subscribers);
+  for (auto &subscription : *subscribers)
+    subscription->offer(frame);
+}
+
+void live_frame_hub_t::close_all() {
+  std::shared_ptr<const subscriber_list_t> subscribers;
+  {
+    std::lock_guard lock(_subscribe_mtx);
+    subscribers = std::atomic_load(&_subscribers);
+    std::atomic_store(&_subscribers,
+                      std::make_shared<const subscriber_list_t>());
+  }
+  for (auto &subscription : *subscribers)
+    subscription->close();
+}
+
+size_t live_frame_hub_t::subscriber_count() const {
+  return std::atomic_load(&_subscribers)->size();
+}
@@ -0,0 +1,85 @@
+#ifndef LIVE_FRAME_HUB_HPP
+#define LIVE_FRAME_HUB_HPP
+
+#include "common/camera_frame.hpp"
+#include "common/spsc_ring.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// One reader of a live frame stream. Each subscription has its own small
+// ring so every reader can fall behind independently, frames that don't fit
+// are dropped for that reader only.
+class live_subscription_t {
+public:
+  // notify is called on the producer thread after every frame that's
+  // queued and once more when the stream closes. It needs to be quick.
+  live_subscription_t(size_t depth, std::function<void()> notify);
+
+  // Reader only
+  bool try_pop(camera_frame_ptr_t &frame);
+
+  bool empty() const { return _frames.empty(); }
+  // How many frames it can hold, depth rounded up to a power of two
+  size_t depth() const { return _frames.capacity(); }
+  bool closed() const { return _closed; }
+  uint64_t dropped() const { return _dropped; }
+
+private:
+  friend class live_frame_hub_t;
+  void offer(const camera_frame_ptr_t &frame);
+  void close();
+
+  spsc_ring_t<camera_frame_ptr_t> _frames;
+  std::function<void()> _notify;
+  std::atomic<uint64_t> _dropped;
+  std::atomic<bool> _closed;
+};
+
+using live_subscription_ptr_t = std::shared_ptr<live_subscription_t>;
+
+// Fans frames from a single producer (the camera worker) out to any number
+// of readers without ever blocking the producer. The reader list is copy on
+// write so publish() doesn't take a lock, only subscribing does.
+//
+// Every queued frame holds on to a frame buffer, so with a bounded pool
+// behind it the subscriptions mustn't be able to queue more frames than
+// there are buffers or the producer starves and nobody gets anything.
+// max_queued caps the total, 0 for no limit.
+class live_frame_hub_t {
+public:
+  explicit live_frame_hub_t(size_t max_queued = 0);
+
+  // For subscriptions made after this, e.g. when a new live session's
+  // frames are a different size
+  void set_max_queued(size_t max_queued);
+  size_t max_queued();
+
+  // depth is cut down to what's left of max_queued. Null if that isn't
+  // enough for the smallest subscription.
+  live_subscription_ptr_t subscribe(size_t depth,
+                                    std::function<void()> notify = {});
+  void unsubscribe(const live_subscription_ptr_t &subscription);
+
+  // Producer only
+  void publish(const camera_frame_ptr_t &frame);
+
+  // Producer only. Ends every current subscription, e.g. when live mode
+  // stops.
+  void close_all();
+
+  size_t subscriber_count() const;
+
+private:
+  using subscriber_list_t = std::vector<live_subscription_ptr_t>;
+
+  // Guarded by _subscribe_mtx
+  size_t _max_queued;
+  std::mutex _subscribe_mtx;
+  std::shared_ptr<const subscriber_list_t> _subscribers;
+};
+
+#endif
@@ -0,0 +1,364 @@
+#include "lx200_codec.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace lx200 {
+
+namespace {
+
+// Walks a reply the same way the old anchored regexes did, each step either
+// takes exactly what it's asked for or fails. Like regex_search anything after
+// the closing # is left alone, the mounts sometimes run two replies together.
+class scanner_t {
+public:
+  explicit scanner_t(std::string_view text) : _text(text) {}
+
+  bool digits(size_t count, int &value) {
+    if (_text.size() < count)
+      return false;
+    // from_chars would take a leading '-' and fewer digits than we want
+    for (size_t i = 0; i < count; i++)
+      if (_text[i] < '0' || _text[i] > '9')
+        return false;
+    std::from_chars(_text.data(), _text.data() + count, value);
+    _text.remove_prefix(count);
+    return true;
+  }
+
+  bool literal(char c) {
+    if (_text.empty() || _text.front() != c)
+      return false;
+    _text.remove_prefix(1);
+    return true;
+  }
+
+  bool sign(char &plus_or_minus) {
+    if (_text.empty() || (_text.front() != '+' && _text.front() != '-'))
+      return false;
+    plus_or_minus = _text.front();
+    _text.remove_prefix(1);
+    return true;
+  }
+
+  bool at_end() const { return _text.empty(); }
+
+private:
+  std::string_view _text;
+};
+
+// The only time parsing allocates
+[[noreturn]] void throw_parse_error(std::string_view resp) {
+  throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                         fmt::format("problem parsing response {0}", resp));
+}
+
+} // namespace
+
+int parse_standard_response(std::string_view resp) {
+  scanner_t scan(resp);
+  int value;
+  scan.literal('e');
+  if (!(scan.digits(1, value) && scan.literal('#')))
+    throw_parse_error(resp);
+  return value;
+}
+
+double hh_mm_ss::as_decimal() { return hh + (mm / 60.0) + (ss / 3600.0); }
+
+hh_mm_ss::hh_mm_ss() : hh(0), mm(0), ss(0){};
+// sdd_mm_ss(std::initializer_list<sdd_mm_ss>) {};
+// CTOR to support easy initialization
+hh_mm_ss::hh_mm_ss(const double &val) {
+  hh = val;
+  mm = (val - hh) * 60.0;
+  ss = std::round((val - hh - (mm / 60.0)) * 3600.0);
+
+  if (ss == 60) {
+    mm += 1;
+    ss = 0;
+  }
+
+  if (mm == 60) {
+    hh += 1;
+    mm = 0;
+  }
+}
+
+// 12:34:56#
+hh_mm_ss parse_hh_mm_ss_response(std::string_view resp) {
+  hh_mm_ss data;
+  scanner_t scan(resp);
+  if (!(scan.digits(2, data.hh) && scan.literal(':') &&
+        scan.digits(2, data.mm) && scan.literal(':') &&
+        scan.digits(2, data.ss) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+double dd_mm_ss::as_decimal() { return dd + (mm / 60.0) + (ss / 3600.0); }
+
+// 12*34:56#
+dd_mm_ss parse_dd_mm_ss_response(std::string_view resp) {
+  dd_mm_ss data;
+  scanner_t scan(resp);
+  if (!(scan.digits(2, data.dd) && scan.literal('*') &&
+        scan.digits(2, data.mm) && scan.literal(':') &&
+        scan.digits(2, data.ss) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+double sdd_mm_ss::as_decimal() {
+  double value = dd + (mm / 60.0) + (ss / 3600.0);
+  if (plus_or_minus == '-')
+    value = value * -1;
+  return value;
+}
+
+sdd_mm_ss::sdd_mm_ss() : plus_or_minus('+'), dd(0), mm(0), ss(0){};
+
+// sdd_mm_ss(std::initializer_list<sdd_mm_ss>) {};
+// CTOR to support easy initialization
+sdd_mm_ss::sdd_mm_ss(const double &val) {
+  // 40.33333333333333
+  // 40.333333333333336
+  double abs_val = std::abs(val);
+  dd = abs_val;
+  mm = (abs_val - dd) * 60.0;
+  ss = std::round((abs_val - dd - (mm / 60.0)) * 3600.0);
+
+  if (ss == 60) {
+    mm += 1;
+    ss = 0;
+  }
+
+  if (mm == 60) {
+    dd += 1;
+    mm = 0;
+  }
+
+  plus_or_minus = '+';
+  if (val < 0) {
+    plus_or_minus = '-';
+  }
+}
+
+// +12*34:56#
+sdd_mm_ss parse_sdd_mm_ss_response(std::string_view resp) {
+  sdd_mm_ss data;
+  scanner_t scan(resp);
+  if (!(scan.sign(data.plus_or_minus) && scan.digits(2, data.dd) &&
+        scan.literal('*') && scan.digits(2, data.mm) && scan.literal(':') &&
+        scan.digits(2, data.ss) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+double sddd_mm_ss::as_decimal() {
+  double value = ddd + (mm / 60.0) + (ss / 3600.0);
+  if (plus_or_minus == '-')
+    value = value * -1;
+  return value;
+}
+
+sddd_mm_ss::sddd_mm_ss() : plus_or_minus('+'), ddd(0), mm(0), ss(0){};
+
+// sdd_mm_ss(std::initializer_list<sdd_mm_ss>) {};
+// CTOR to support easy initialization
+sddd_mm_ss::sddd_mm_ss(const double &val) {
+  double abs_val = std::abs(val);
+  ddd = abs_val;
+  mm = (abs_val - ddd) * 60.0;
+  ss = std::round((abs_val - ddd - (mm / 60.0)) * 3600.0);
+  if (ss == 60) {
+    mm += 1;
+    ss = 0;
+  }
+
+  if (mm == 60) {
+    ddd += 1;
+    mm = 0;
+  }
+
+  plus_or_minus = '+';
+  if (val < 0) {
+    plus_or_minus = '-';
+  }
+}
+
+// -098*00:00#
+sddd_mm_ss parse_sddd_mm_ss_response(std::string_view resp) {
+  sddd_mm_ss data;
+  scanner_t scan(resp);
+  if (!(scan.sign(data.plus_or_minus) && scan.digits(3, data.ddd) &&
+        scan.literal('*') && scan.digits(2, data.mm) && scan.literal(':') &&
+        scan.digits(2, data.ss) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+// 04/10/87#
+mm_dd_yy parse_mm_dd_yy_response(std::string_view resp) {
+  mm_dd_yy data;
+  scanner_t scan(resp);
+  if (!(scan.digits(2, data.mm) && scan.literal('/') &&
+        scan.digits(2, data.dd) && scan.literal('/') &&
+        scan.digits(2, data.yy) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+// -05:00#
+shh_mm parse_shh_mm_response(std::string_view resp) {
+  shh_mm data;
+  scanner_t scan(resp);
+  if (!(scan.sign(data.plus_or_minus) && scan.digits(2, data.hh) &&
+        scan.literal(':') && scan.digits(2, data.mm) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+double sdd_mm::as_decimal() {
+  double value = dd + (mm / 60.0);
+  if (plus_or_minus == '-')
+    value = value * -1;
+  return value;
+}
+
+sdd_mm::sdd_mm() : plus_or_minus('+'), dd(0), mm(0){};
+
+// sdd_mm_ss(std::initializer_list<sdd_mm_ss>) {};
+// CTOR to support easy initialization
+sdd_mm::sdd_mm(const double &val) {
+  double abs_val = std::abs(val);
+  dd = abs_val;
+  mm = std::round((abs_val - dd) * 60.0);
+
+  if (mm == 60) {
+    dd += 1;
+    mm = 0;
+  }
+
+  plus_or_minus = '+';
+  if (val < 0) {
+    plus_or_minus = '-';
+  }
+}
+
+// +40*30#
+sdd_mm parse_sdd_mm_response(std::string_view resp) {
+  sdd_mm data;
+  scanner_t scan(resp);
+  if (!(scan.sign(data.plus_or_minus) && scan.digits(2, data.dd) &&
+        scan.literal('*') && scan.digits(2, data.mm) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+double sddd_mm::as_decimal() {
+  double value = ddd + (mm / 60.0);
+  if (plus_or_minus == '-')
+    value = value * -1;
+  return value;
+}
+
+sddd_mm::sddd_mm() : plus_or_minus('+'), ddd(0), mm(0){};
+
+// sdd_mm_ss(std::initializer_list<sdd_mm_ss>) {};
+// CTOR to support easy initialization
+sddd_mm::sddd_mm(const double &val) {
+  double abs_val = std::abs(val);
+  ddd = abs_val;
+  mm = std::round((abs_val - ddd) * 60.0);
+
+  if (mm == 60) {
+    ddd += 1;
+    mm = 0;
+  }
+
+  plus_or_minus = '+';
+  if (val < 0) {
+    plus_or_minus = '-';
+  }
+}
+
+// -105*20#
+sddd_mm parse_sddd_mm_response(std::string_view resp) {
+  sddd_mm data;
+  scanner_t scan(resp);
+  if (!(scan.sign(data.plus_or_minus) && scan.digits(3, data.ddd) &&
+        scan.literal('*') && scan.digits(2, data.mm) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+std::vector<std::string> split_on(const std::string &string_to_split,
+                                  const std::string &separator) {
+  std::string_view remaining = string_to_split;
+  std::vector<std::string> results;
+  while (true) {
+    auto pos = remaining.find(separator);
+    results.emplace_back(remaining.substr(0, pos));
+    if (pos == std::string_view::npos)
+      break;
+    remaining.remove_prefix(pos + separator.size());
+  }
+  return results;
+}
+
+sdd_mm_sddd_mm parse_sdd_mm_and_sddd_mm_response(std::string_view resp) {
+  auto separator = resp.find('&');
+  if (separator == std::string_view::npos)
+    throw_parse_error(resp);
+
+  // The first half has no # of its own, it ends at the &
+  sdd_mm_sddd_mm data;
+  auto &first = data.sdd_mm_data;
+  scanner_t first_scan(resp.substr(0, separator));
+  if (!(first_scan.sign(first.plus_or_minus) &&
+        first_scan.digits(2, first.dd) && first_scan.literal('*') &&
+        first_scan.digits(2, first.mm) &&
+        (first_scan.at_end() || first_scan.literal('#'))))
+    throw_parse_error(resp);
+
+  auto second = resp.substr(separator + 1);
+  second = second.substr(0, second.find('&'));
+  data.sddd_mm_data = parse_sddd_mm_response(second);
+  return data;
+}
+
+double ddd_mm_ss::as_decimal() {
+  double value = ddd + (mm / 60.0) + (ss / 3600.0);
+  return value;
+}
+
+ddd_mm_ss::ddd_mm_ss(){};
+
+// CTOR to support easy initialization
+ddd_mm_ss::ddd_mm_ss(const double &val) {
+  ddd = val;
+  mm = (val - ddd) * 60.0;
+  ss = std::round((val - ddd - (mm / 60.0)) * 3600.0);
+  if (ss == 60) {
+    mm += 1;
+    ss = 0;
+  }
+
+  if (mm == 60) {
+    ddd += 1;
+    mm = 0;
+  }
+}
+
+// 105*20:30#
+ddd_mm_ss parse_ddd_mm_ss_response(std::string_view resp) {
+  ddd_mm_ss data;
+  scanner_t scan(resp);
+  if (!(scan.digits(3, data.ddd) && scan.literal('*') &&
+        scan.digits(2, data.mm) && scan.literal(':') &&
+        scan.digits(2, data.ss) && scan.literal('#')))
+    throw_parse_error(resp);
+  return data;
+}
+
+} // namespace lx200
@@ -0,0 +1,247 @@
+#ifndef LX200_CODEC_HPP
+#define LX200_CODEC_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "fmt/format.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Building LX200 commands and picking apart the replies without touching the
+// heap. The AM5 and OnStep command sets share every reply format so both
+// re-export what's in here, see zwo_responses and onstep_responses.
+namespace lx200 {
+
+// A command formatted into a fixed buffer instead of a std::string. The
+// longest thing we send is a site name at around 20 characters so 64 leaves
+// plenty of room, anything that doesn't fit is a bad value rather than a
+// truncated command going out on the wire.
+class command_t {
+public:
+  static constexpr size_t capacity = 64;
+
+  constexpr command_t() = default;
+
+  template <size_t N> constexpr command_t(const char (&literal)[N]) {
+    static_assert(N - 1 <= capacity, "LX200 command is too long");
+    for (size_t i = 0; i < N - 1; i++)
+      _data[i] = literal[i];
+    _size = N - 1;
+  }
+
+  template <typename... Args>
+  static command_t format(fmt::format_string<Args...> format_str,
+                          Args &&...args) {
+    command_t command;
+    auto result = fmt::format_to_n(command._data.data(), capacity, format_str,
+                                   std::forward<Args>(args)...);
+    if (result.size > capacity)
+      throw alpaca_exception(
+          alpaca_exception::INVALID_VALUE,
+          fmt::format("command would be {} characters, the most we send is {}",
+                      result.size, capacity));
+    command._size = result.size;
+    return command;
+  }
+
+  constexpr const char *data() const { return _data.data(); }
+  constexpr size_t size() const { return _size; }
+  constexpr std::string_view view() const { return {_data.data(), _size}; }
+
+  constexpr operator std::string_view() const { return view(); }
+  operator std::string() const { return std::string(view()); }
+
+  friend constexpr bool operator==(const command_t &lhs, const command_t &rhs) {
+    return lhs.view() == rhs.view();
+  }
+  friend constexpr bool operator==(const command_t &lhs, std::string_view rhs) {
+    return lhs.view() == rhs;
+  }
+  friend constexpr bool operator==(std::string_view lhs, const command_t &rhs) {
+    return lhs == rhs.view();
+  }
+  // Otherwise a literal could go either way, as a command_t or a string_view
+  template <size_t N>
+  friend constexpr bool operator==(const command_t &lhs, const char (&rhs)[N]) {
+    return lhs.view() == std::string_view(rhs, N - 1);
+  }
+
+private:
+  std::array<char, capacity> _data{};
+  size_t _size = 0;
+};
+
+// 1#, 0# or e+error_code+#
+int parse_standard_response(std::string_view resp);
+
+struct hh_mm_ss {
+  int hh;
+  int mm;
+  int ss;
+  double as_decimal();
+  hh_mm_ss();
+  hh_mm_ss(const double &val);
+};
+
+hh_mm_ss parse_hh_mm_ss_response(std::string_view resp);
+
+struct dd_mm_ss {
+  int dd;
+  int mm;
+  int ss;
+
+  double as_decimal();
+};
+
+dd_mm_ss parse_dd_mm_ss_response(std::string_view resp);
+
+struct sdd_mm_ss {
+  char plus_or_minus;
+  int dd;
+  int mm;
+  int ss;
+  double as_decimal();
+  sdd_mm_ss();
+  sdd_mm_ss(const double &val);
+};
+
+sdd_mm_ss parse_sdd_mm_ss_response(std::string_view resp);
+
+struct sddd_mm_ss {
+  char plus_or_minus;
+  int ddd;
+  int mm;
+  int ss;
+  double as_decimal();
+  sddd_mm_ss();
+  sddd_mm_ss(const double &val);
+};
+
+// -098*00:00#
+sddd_mm_ss parse_sddd_mm_ss_response(std::string_view resp);
+
+struct mm_dd_yy {
+  int mm;
+  int dd;
+  int yy;
+};
+
+mm_dd_yy parse_mm_dd_yy_response(std::string_view resp);
+
+struct shh_mm {
+  char plus_or_minus;
+  int hh;
+  int mm;
+};
+
+shh_mm parse_shh_mm_response(std::string_view resp);
+
+struct sdd_mm {
+  char plus_or_minus;
+  int dd;
+  int mm;
+
+  double as_decimal();
+  sdd_mm();
+  sdd_mm(const double &val);
+};
+
+sdd_mm parse_sdd_mm_response(std::string_view resp);
+
+struct sddd_mm {
+  char plus_or_minus;
+  int ddd;
+  int mm;
+
+  double as_decimal();
+  sddd_mm();
+  sddd_mm(const double &val);
+};
+
+sddd_mm parse_sddd_mm_response(std::string_view resp);
+
+std::vector<std::string> split_on(const std::string &string_to_split,
+                                  const std::string &separator);
+
+struct sdd_mm_sddd_mm {
+  sdd_mm sdd_mm_data;
+  sddd_mm sddd_mm_data;
+};
+
+// +40*30&-105*20#
+sdd_mm_sddd_mm parse_sdd_mm_and_sddd_mm_response(std::string_view resp);
+
+struct ddd_mm_ss {
+  int ddd;
+  int mm;
+  int ss;
+  double as_decimal();
+  ddd_mm_ss();
+  ddd_mm_ss(const double &val);
+};
+
+ddd_mm_ss parse_ddd_mm_ss_response(std::string_view resp);
+
+} // namespace lx200
+
+template <> struct fmt::formatter<lx200::command_t> : formatter<string_view> {
+  auto format(const lx200::command_t &c, format_context &ctx) const {
+    return formatter<string_view>::format(c.view(), ctx);
+  };
+};
+
+template <> struct fmt::formatter<lx200::hh_mm_ss> : formatter<string_view> {
+  auto format(lx200::hh_mm_ss d, format_context &ctx) const {
+    return format_to(ctx.out(), "{:#02d}:{:#02d}:{:#02d}", d.hh, d.mm, d.ss);
+  };
+};
+
+template <> struct fmt::formatter<lx200::dd_mm_ss> : formatter<string_view> {
+  auto format(lx200::dd_mm_ss d, format_context &ctx) const {
+    return format_to(ctx.out(), "{:#02d}*{:#02d}:{:#02d}", d.dd, d.mm, d.ss);
+  };
+};
+
+template <> struct fmt::formatter<lx200::sdd_mm_ss> : formatter<string_view> {
+  auto format(lx200::sdd_mm_ss d, format_context &ctx) const {
+    return format_to(ctx.out(), "{}{:#02d}*{:#02d}:{:#02d}", d.plus_or_minus,
+                     d.dd, d.mm, d.ss);
+  };
+};
+
+template <> struct fmt::formatter<lx200::mm_dd_yy> : formatter<string_view> {
+  auto format(lx200::mm_dd_yy d, format_context &ctx) const {
+    return format_to(ctx.out(), "{:#02d}/{:#02d}/{:#02d}", d.mm, d.dd, d.yy);
+  };
+};
+
+template <> struct fmt::formatter<lx200::shh_mm> : formatter<string_view> {
+  auto format(lx200::shh_mm d, format_context &ctx) const {
+    return format_to(ctx.out(), "{}{:#02d}:{:#02d}", d.plus_or_minus, d.hh,
+                     d.mm);
+  };
+};
+
+template <> struct fmt::formatter<lx200::sdd_mm> : formatter<string_view> {
+  auto format(lx200::sdd_mm d, format_context &ctx) const {
+    return format_to(ctx.out(), "{}{:#02d}:{:#02d}", d.plus_or_minus, d.dd,
+                     d.mm);
+  };
+};
+
+template <> struct fmt::formatter<lx200::sddd_mm> : formatter<string_view> {
+  auto format(lx200::sddd_mm d, format_context &ctx) const {
+    return format_to(ctx.out(), "{}{:#03d}:{:#02d}", d.plus_or_minus, d.ddd,
+                     d.mm);
+  };
+};
+
+template <> struct fmt::formatter<lx200::ddd_mm_ss> : formatter<string_view> {
+  auto format(lx200::ddd_mm_ss d, format_context &ctx) const {
+    return format_to(ctx.out(), "{:#03d}*{:#02d}:{:#02d}", d.ddd, d.mm, d.ss);
+  };
+};
+
+#endif
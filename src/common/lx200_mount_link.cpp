@@ -0,0 +1,108 @@
+#include "lx200_mount_link.hpp"
+#include "alpaca_exception.hpp"
+#include <algorithm>
+#include <exception>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <spdlog/spdlog.h>
+
+namespace lx200 {
+
+namespace {
+alpaca_hub_serial::serial_request_t make_request(const mount_link_t &link,
+                                                 std::string_view cmd) {
+  auto descriptor = link.table.find(cmd);
+  if (!descriptor)
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("No protocol descriptor for cmd: {}", cmd));
+
+  // The request keeps its own copy, that fits in std::string's small buffer
+  // for everything but the long combined set commands
+  alpaca_hub_serial::serial_request_t request{std::string(cmd),
+                                              frame_length_for(*descriptor)};
+  request.family = descriptor->family;
+  return request;
+}
+} // namespace
+
+const command_descriptor_t *
+descriptor_table_t::find(std::string_view command) const {
+  return find_descriptor(_entries, _entries + _size, command);
+}
+
+std::string send_command(const mount_link_t &link, std::string_view cmd) {
+  auto request = make_request(link, cmd);
+
+  try {
+    spdlog::trace("sending: {} ({}) to mount", cmd, request.family);
+    bool moved = moves_mount(request.family);
+    std::lock_guard lock(link.mtx);
+    auto rsp = link.serial.transact(std::move(request)).frame;
+    if (moved && link.on_mount_moved)
+      link.on_mount_moved();
+
+    spdlog::trace("mount returned: {}", rsp);
+    return rsp;
+
+  } catch (std::exception &ex) {
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("Problem sending command to mount: {}", ex.what()));
+  }
+}
+
+std::vector<std::string> send_commands(const mount_link_t &link,
+                                       const std::vector<command_t> &cmds) {
+  std::vector<alpaca_hub_serial::serial_request_t> batch;
+  batch.reserve(cmds.size());
+  for (auto &cmd : cmds)
+    batch.push_back(make_request(link, cmd));
+
+  try {
+    spdlog::trace("sending: {} commands to mount", cmds.size());
+    bool moved = std::any_of(batch.begin(), batch.end(), [](auto &request) {
+      return moves_mount(request.family);
+    });
+
+    std::vector<std::string> replies;
+    replies.reserve(cmds.size());
+    {
+      std::lock_guard lock(link.mtx);
+      for (auto &reply : link.serial.transact_batch(std::move(batch)))
+        replies.push_back(std::move(reply.frame));
+      if (moved && link.on_mount_moved)
+        link.on_mount_moved();
+    }
+
+    spdlog::trace("mount returned: {}", fmt::join(replies, " "));
+    return replies;
+
+  } catch (std::exception &ex) {
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("Problem sending commands to mount: {}", ex.what()));
+  }
+}
+
+site_reading_t read_site(const mount_link_t &link) {
+  // The standard LX200 queries, both command sets have them
+  auto resps = send_commands(link, {":Gt#", ":Gg#", ":GT#"});
+
+  site_reading_t site;
+  site.latitude = parse_sdd_mm_ss_response(resps[0]).as_decimal();
+
+  auto longitude = parse_sddd_mm_ss_response(resps[1]);
+  // This is a weird behavior from the ASCOM driver I'm mimicking
+  if (longitude.plus_or_minus == '+')
+    longitude.plus_or_minus = '-';
+  else
+    longitude.plus_or_minus = '+';
+  site.longitude = longitude.as_decimal();
+
+  site.tracking_rate =
+      static_cast<drive_rate_enum>(parse_standard_response(resps[2]));
+  return site;
+}
+
+} // namespace lx200
@@ -0,0 +1,68 @@
+#ifndef LX200_MOUNT_LINK_HPP
+#define LX200_MOUNT_LINK_HPP
+
+#include "common/lx200_codec.hpp"
+#include "common/lx200_protocol.hpp"
+#include "common/serial_reactor.hpp"
+#include "interfaces/i_alpaca_device.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sending commands to the LX200 style mounts, shared by the AM5 and OnStep
+// drivers. The only difference between the two is which descriptor table
+// the commands are looked up in.
+namespace lx200 {
+
+// One command set's descriptor table, whatever its size
+class descriptor_table_t {
+public:
+  template <size_t N>
+  constexpr descriptor_table_t(const std::array<command_descriptor_t, N> &table)
+      : _entries(table.data()), _size(N) {}
+
+  // Same as lx200::find_descriptor
+  const command_descriptor_t *find(std::string_view command) const;
+
+private:
+  const command_descriptor_t *_entries;
+  size_t _size;
+};
+
+// The serial channel a mount driver talks over, the lock that keeps its
+// exchanges from interleaving and the table its commands are looked up in.
+// Every command has to be in the table, guessing the reply shape wrong means
+// sitting out the whole timeout.
+struct mount_link_t {
+  alpaca_hub_serial::serial_channel_t &serial;
+  std::mutex &mtx;
+  descriptor_table_t table;
+  // Called with mtx held after a command that starts or stops the mount
+  // moving has gone out, so the driver can drop anything it read before
+  std::function<void()> on_mount_moved;
+};
+
+// Throw alpaca_exception DRIVER_ERROR if a command isn't in the table or the
+// exchange fails. A batch is checked before anything is sent so a bad one
+// doesn't go out half way.
+std::string send_command(const mount_link_t &link, std::string_view cmd);
+std::vector<std::string> send_commands(const mount_link_t &link,
+                                       const std::vector<command_t> &cmds);
+
+struct site_reading_t {
+  double latitude = 0;
+  double longitude = 0;
+  drive_rate_enum tracking_rate = drive_rate_enum::sidereal;
+};
+
+// Latitude, longitude and tracking rate in one batch, with the longitude's
+// sign flipped to match the ASCOM drivers
+site_reading_t read_site(const mount_link_t &link);
+
+} // namespace lx200
+
+#endif
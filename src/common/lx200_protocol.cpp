@@ -0,0 +1,30 @@
+#include "lx200_protocol.hpp"
+#include "alpaca_hub_serial.hpp"
+
+namespace lx200 {
+
+std::function<size_t(std::string_view)>
+frame_length_for(const command_descriptor_t &descriptor) {
+  switch (descriptor.shape) {
+  case reply_shape_enum::none:
+    return {};
+  case reply_shape_enum::single_char:
+    return alpaca_hub_serial::fixed_length(1);
+  case reply_shape_enum::hash_terminated:
+    return alpaca_hub_serial::ends_with_any("#");
+  case reply_shape_enum::fixed_length:
+    return alpaca_hub_serial::fixed_length(descriptor.length);
+  case reply_shape_enum::zero_or_hash_terminated:
+    return [](std::string_view pending) -> size_t {
+      if (pending.empty())
+        return 0;
+      if (pending[0] == '0')
+        return 1;
+      auto pos = pending.find('#');
+      return pos == std::string_view::npos ? 0 : pos + 1;
+    };
+  }
+  return {};
+}
+
+} // namespace lx200
@@ -0,0 +1,103 @@
+#ifndef LX200_PROTOCOL_HPP
+#define LX200_PROTOCOL_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+// Describes what the LX200 style mounts (the AM5 and OnStep) send back for
+// each command, so the transport knows when a reply is complete instead of
+// relying on every caller to say so. Each command set keeps a constexpr table
+// of these next to its cmd_* builders.
+namespace lx200 {
+
+enum class reply_shape_enum {
+  // Nothing comes back, don't wait for anything
+  none,
+  // A bare 1 / 0 with no terminator
+  single_char,
+  // Anything up to and including a '#'
+  hash_terminated,
+  // Exactly length bytes
+  fixed_length,
+  // Goto style replies, a bare 0 on success or an error message ending in a
+  // '#' otherwise
+  zero_or_hash_terminated
+};
+
+struct command_descriptor_t {
+  // The command up to where its arguments start, e.g. ":Sr" for
+  // ":Sr12:34:56#", or the whole command when it doesn't take any
+  std::string_view prefix;
+  // The cmd_* builder without the cmd_, used when logging and for keeping
+  // stats per command
+  std::string_view family;
+  reply_shape_enum shape;
+  // Only used by fixed_length
+  size_t length = 0;
+};
+
+constexpr bool starts_with(std::string_view command, std::string_view prefix) {
+  return command.size() >= prefix.size() &&
+         command.substr(0, prefix.size()) == prefix;
+}
+
+// Longest matching prefix wins so ":STa" beats ":ST" and ":Ggr#" isn't
+// mistaken for anything shorter. Returns nullptr for commands the table
+// doesn't know about.
+constexpr const command_descriptor_t *
+find_descriptor(const command_descriptor_t *begin,
+                const command_descriptor_t *end, std::string_view command) {
+  const command_descriptor_t *found = nullptr;
+  for (auto descriptor = begin; descriptor != end; descriptor++) {
+    if (starts_with(command, descriptor->prefix) &&
+        (!found || descriptor->prefix.size() > found->prefix.size()))
+      found = descriptor;
+  }
+  return found;
+}
+
+template <size_t N>
+constexpr const command_descriptor_t *
+find_descriptor(const std::array<command_descriptor_t, N> &table,
+                std::string_view command) {
+  return find_descriptor(table.data(), table.data() + N, command);
+}
+
+// For a static_assert on each table, two entries with the same prefix would
+// mean one of them can never be found
+template <size_t N>
+constexpr bool
+has_unique_prefixes(const std::array<command_descriptor_t, N> &table) {
+  for (size_t i = 0; i < N; i++) {
+    if (table[i].prefix.empty() || table[i].prefix[0] != ':')
+      return false;
+    for (size_t j = i + 1; j < N; j++)
+      if (table[i].prefix == table[j].prefix)
+        return false;
+  }
+  return true;
+}
+
+// Whether a command starts or stops the mount moving, so anything read from
+// the mount before it went out is out of date. Goes by the family names both
+// command sets share.
+constexpr bool moves_mount(std::string_view family) {
+  return starts_with(family, "move_towards_") ||
+         starts_with(family, "stop_moving") || starts_with(family, "goto") ||
+         family == "set_target_ra_and_dec_and_goto" || family == "sync" ||
+         family == "set_target_ra_and_dec_and_sync" ||
+         family == "home_position" || family == "park" ||
+         family == "restore_parked_telescope" || family == "start_tracking" ||
+         family == "stop_tracking";
+}
+
+// What serial_request_t::frame_length should be for a reply of this shape.
+// Empty for commands that don't reply.
+std::function<size_t(std::string_view)>
+frame_length_for(const command_descriptor_t &descriptor);
+
+} // namespace lx200
+
+#endif
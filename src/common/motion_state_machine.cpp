@@ -0,0 +1,231 @@
+#include "motion_state_machine.hpp"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+std::string motion_state_name(motion_state_enum state) {
+  switch (state) {
+  case motion_state_enum::idle:
+    return "idle";
+  case motion_state_enum::slewing:
+    return "slewing";
+  case motion_state_enum::settling:
+    return "settling";
+  case motion_state_enum::tracking:
+    return "tracking";
+  case motion_state_enum::parked:
+    return "parked";
+  }
+  return "unknown";
+}
+
+motion_state_machine_t::motion_state_machine_t(motion_config_t config)
+    : _config(config), _state(motion_state_enum::idle),
+      _kind(motion_kind_enum::slew), _tracking(false), _seen_moving(false),
+      _motions(0), _aborted(0), _last_motion_ms(0) {}
+
+void motion_state_machine_t::begin(motion_kind_enum kind) {
+  {
+    std::lock_guard lock(_motion_mtx);
+    _state = motion_state_enum::slewing;
+    _kind = kind;
+    _seen_moving = false;
+    _begun_at = motion_clock_t::now();
+  }
+  _motion_cv.notify_all();
+}
+
+void motion_state_machine_t::observe(motion_clock_t::time_point read_at,
+                                     bool moving) {
+  {
+    std::lock_guard lock(_motion_mtx);
+    auto now = motion_clock_t::now();
+    // The mount may not have had the command yet when this was read
+    if (read_at < _begun_at)
+      return;
+
+    switch (_state) {
+    case motion_state_enum::parked:
+      break;
+    case motion_state_enum::idle:
+    case motion_state_enum::tracking:
+      if (moving) {
+        spdlog::debug("mount is moving without being asked to");
+        _state = motion_state_enum::slewing;
+        _kind = motion_kind_enum::external;
+        _seen_moving = true;
+        _begun_at = read_at;
+      }
+      break;
+    case motion_state_enum::slewing:
+      if (moving) {
+        _seen_moving = true;
+      } else if (_seen_moving || now - _begun_at >= _config.start_grace) {
+        _state = motion_state_enum::settling;
+        _stopped_at = now;
+        _settle_until = now + _config.settle_time;
+      }
+      break;
+    case motion_state_enum::settling:
+      // Off again, e.g. the second half of a meridian flip
+      if (moving)
+        _state = motion_state_enum::slewing;
+      break;
+    }
+    advance(now);
+  }
+  _motion_cv.notify_all();
+}
+
+void motion_state_machine_t::abort() {
+  {
+    std::lock_guard lock(_motion_mtx);
+    if (moving_locked()) {
+      _aborted++;
+      _state = resting_state();
+    }
+  }
+  _motion_cv.notify_all();
+}
+
+void motion_state_machine_t::set_tracking(bool tracking) {
+  std::lock_guard lock(_motion_mtx);
+  _tracking = tracking;
+  if (_state == motion_state_enum::idle ||
+      _state == motion_state_enum::tracking)
+    _state = resting_state();
+}
+
+void motion_state_machine_t::set_parked(bool parked) {
+  {
+    std::lock_guard lock(_motion_mtx);
+    if (parked)
+      _state = motion_state_enum::parked;
+    else if (_state == motion_state_enum::parked)
+      _state = resting_state();
+  }
+  _motion_cv.notify_all();
+}
+
+void motion_state_machine_t::reset() {
+  {
+    std::lock_guard lock(_motion_mtx);
+    if (_state != motion_state_enum::parked)
+      _state = resting_state();
+    _deferred_tracking.reset();
+  }
+  _motion_cv.notify_all();
+}
+
+motion_state_enum motion_state_machine_t::state() {
+  std::lock_guard lock(_motion_mtx);
+  advance(motion_clock_t::now());
+  return _state;
+}
+
+bool motion_state_machine_t::in_motion() {
+  std::lock_guard lock(_motion_mtx);
+  advance(motion_clock_t::now());
+  return moving_locked();
+}
+
+bool motion_state_machine_t::wait_until_settled(
+    std::chrono::milliseconds timeout) {
+  std::unique_lock lock(_motion_mtx);
+  auto give_up_at = motion_clock_t::now() + timeout;
+  while (true) {
+    auto now = motion_clock_t::now();
+    advance(now);
+    if (!moving_locked())
+      return true;
+    if (now >= give_up_at)
+      return false;
+
+    // Nobody calls in when the settle time runs out, so wake up for it
+    auto wake_at = give_up_at;
+    if (_state == motion_state_enum::settling)
+      wake_at = std::min(wake_at, _settle_until);
+    _motion_cv.wait_until(lock, wake_at);
+  }
+}
+
+void motion_state_machine_t::defer_tracking(bool tracking,
+                                            std::chrono::milliseconds delay) {
+  std::lock_guard lock(_motion_mtx);
+  _deferred_tracking = tracking;
+  _deferred_until = motion_clock_t::now() + delay;
+}
+
+std::optional<bool> motion_state_machine_t::take_deferred_tracking() {
+  std::lock_guard lock(_motion_mtx);
+  auto now = motion_clock_t::now();
+  advance(now);
+  if (!_deferred_tracking || moving_locked() || now < _deferred_until)
+    return std::nullopt;
+  auto tracking = _deferred_tracking;
+  _deferred_tracking.reset();
+  return tracking;
+}
+
+std::optional<motion_state_machine_t::motion_clock_t::time_point>
+motion_state_machine_t::next_deadline() {
+  std::lock_guard lock(_motion_mtx);
+  advance(motion_clock_t::now());
+  if (_state == motion_state_enum::settling)
+    return _settle_until;
+  // A deferred tracking change has to wait for the motion to finish anyway
+  if (_deferred_tracking && !moving_locked())
+    return _deferred_until;
+  return std::nullopt;
+}
+
+void motion_state_machine_t::configure(const motion_config_t &config) {
+  {
+    std::lock_guard lock(_motion_mtx);
+    _config = config;
+    if (_state == motion_state_enum::settling)
+      _settle_until = _stopped_at + _config.settle_time;
+  }
+  // Waiters may be sleeping until the old end of the settle time
+  _motion_cv.notify_all();
+}
+
+motion_config_t motion_state_machine_t::config() {
+  std::lock_guard lock(_motion_mtx);
+  return _config;
+}
+
+std::map<std::string, double> motion_state_machine_t::summary() {
+  std::lock_guard lock(_motion_mtx);
+  std::map<std::string, double> result;
+  result["motions"] = _motions;
+  result["aborted"] = _aborted;
+  result["last_motion_ms"] = _last_motion_ms;
+  result["settle_time_ms"] = _config.settle_time.count();
+  return result;
+}
+
+void motion_state_machine_t::advance(motion_clock_t::time_point now) {
+  if (_state == motion_state_enum::settling && now >= _settle_until)
+    come_to_rest();
+}
+
+void motion_state_machine_t::come_to_rest() {
+  _motions++;
+  _last_motion_ms = std::chrono::duration<double, std::milli>(
+                        _settle_until - _begun_at)
+                        .count();
+  _state = resting_state();
+  spdlog::debug("{} finished after {:.0f}ms",
+                _kind == motion_kind_enum::home ? "homing" : "slew",
+                _last_motion_ms);
+  // Waiters wake up at _settle_until by themselves, no need to notify
+}
+
+motion_state_enum motion_state_machine_t::resting_state() const {
+  return _tracking ? motion_state_enum::tracking : motion_state_enum::idle;
+}
+
+bool motion_state_machine_t::moving_locked() const {
+  return _state == motion_state_enum::slewing ||
+         _state == motion_state_enum::settling;
+}
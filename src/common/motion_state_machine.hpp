@@ -0,0 +1,104 @@
+#ifndef MOTION_STATE_MACHINE_HPP
+#define MOTION_STATE_MACHINE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// idle -> slewing -> settling -> tracking / idle, with parked off to the side
+enum class motion_state_enum { idle, slewing, settling, tracking, parked };
+
+// What started the motion. External is the mount moving without us asking,
+// e.g. the hand controller or a meridian flip.
+enum class motion_kind_enum { slew, home, external };
+
+std::string motion_state_name(motion_state_enum state);
+
+struct motion_config_t {
+  // How long after a goto is accepted the mount has to start reporting that
+  // it's moving. A goto to where the mount already is never shows as moving
+  // at all, so after this we take it that it has arrived.
+  std::chrono::milliseconds start_grace{1500};
+  // ASCOM's SlewSettleTime, slewing stays true for this long after the mount
+  // reports it has stopped
+  std::chrono::milliseconds settle_time{0};
+};
+
+// Keeps track of what a mount is doing from what the drivers ask of it and
+// what their telemetry reads back. Nothing in here talks to the mount or
+// sleeps, the drivers' pollers call observe() and the settle time is a
+// deadline on the steady clock that waiters and pollers wake up for.
+class motion_state_machine_t {
+public:
+  using motion_clock_t = std::chrono::steady_clock;
+
+  explicit motion_state_machine_t(motion_config_t config = {});
+
+  motion_state_machine_t(const motion_state_machine_t &) = delete;
+  motion_state_machine_t &operator=(const motion_state_machine_t &) = delete;
+
+  // The mount has accepted a goto or home command
+  void begin(motion_kind_enum kind);
+  // A status read from the poller. read_at is when the read was sent, reads
+  // that went out before the last begin() don't count.
+  void observe(motion_clock_t::time_point read_at, bool moving);
+  // Stopped on purpose, there's nothing to settle
+  void abort();
+  void set_tracking(bool tracking);
+  void set_parked(bool parked);
+  // Lost the mount, anyone waiting gets woken up
+  void reset();
+
+  motion_state_enum state();
+  // Slewing or settling, what ASCOM's Slewing property means
+  bool in_motion();
+  // true if the mount came to rest before timeout
+  bool wait_until_settled(std::chrono::milliseconds timeout);
+
+  // Tracking changes the mount refused, or that were asked for while it was
+  // moving. take_deferred_tracking() hands one back once the mount is at
+  // rest and the delay has run out.
+  void defer_tracking(bool tracking, std::chrono::milliseconds delay);
+  std::optional<bool> take_deferred_tracking();
+
+  // When a poller next needs to look in even if the mount has nothing new
+  // to say, the end of the settle time or a deferred tracking change
+  std::optional<motion_clock_t::time_point> next_deadline();
+
+  void configure(const motion_config_t &config);
+  motion_config_t config();
+
+  // Flattened for details()
+  std::map<std::string, double> summary();
+
+private:
+  // Caller holds _motion_mtx for all of these
+  void advance(motion_clock_t::time_point now);
+  void come_to_rest();
+  bool moving_locked() const;
+  motion_state_enum resting_state() const;
+
+  std::mutex _motion_mtx;
+  std::condition_variable _motion_cv;
+  motion_config_t _config;
+  motion_state_enum _state;
+  motion_kind_enum _kind;
+  bool _tracking;
+  // Whether a read since begin() has shown the mount moving
+  bool _seen_moving;
+  motion_clock_t::time_point _begun_at;
+  motion_clock_t::time_point _stopped_at;
+  motion_clock_t::time_point _settle_until;
+  std::optional<bool> _deferred_tracking;
+  motion_clock_t::time_point _deferred_until;
+
+  uint64_t _motions;
+  uint64_t _aborted;
+  double _last_motion_ms;
+};
+
+#endif
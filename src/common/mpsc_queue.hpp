@@ -0,0 +1,70 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Unbounded lock-free multi producer / single consumer queue (Vyukov's
+// intrusive MPSC design). Any thread may push(), only one thread may
+// try_pop() / empty().
+//
+// A push is a single atomic exchange so producers never wait on each other
+// or on the consumer. The one catch is that between a producer's exchange and
+// its link store the consumer can briefly see the queue as empty, so
+// consumers should always pair this with some kind of wakeup signalled
+// *after* push() returns.
+template <typename T> class mpsc_queue_t {
+public:
+  mpsc_queue_t() : _head(new node_t), _tail(_head.load()) {}
+
+  ~mpsc_queue_t() {
+    while (_tail) {
+      node_t *next = _tail->next.load(std::memory_order_relaxed);
+      delete _tail;
+      _tail = next;
+    }
+  }
+
+  mpsc_queue_t(const mpsc_queue_t &) = delete;
+  mpsc_queue_t &operator=(const mpsc_queue_t &) = delete;
+
+  void push(T value) {
+    node_t *node = new node_t;
+    node->value.emplace(std::move(value));
+    node_t *prev = _head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Consumer only
+  bool try_pop(T &value) {
+    node_t *tail = _tail;
+    node_t *next = tail->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+
+    value = std::move(*next->value);
+    next->value.reset();
+    _tail = next;
+    delete tail;
+    return true;
+  }
+
+  // Consumer only
+  bool empty() const {
+    return _tail->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+private:
+  struct node_t {
+    std::atomic<node_t *> next{nullptr};
+    std::optional<T> value;
+  };
+
+  // Producers swing _head, the consumer owns _tail. Kept on separate cache
+  // lines so pushing doesn't bounce the consumer's line around.
+  alignas(64) std::atomic<node_t *> _head;
+  alignas(64) node_t *_tail;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "pulse_guide_scheduler.hpp"
+#include "alpaca_exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+double ms_between(std::chrono::steady_clock::time_point from,
+                  std::chrono::steady_clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// e and w move RA, n and s move Dec
+size_t axis_index(char direction) {
+  switch (direction) {
+  case 'e':
+  case 'w':
+    return 0;
+  case 'n':
+  case 's':
+    return 1;
+  default:
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("cardinal direction {} is not valid", direction));
+  }
+}
+} // namespace
+
+pulse_guide_scheduler_t::pulse_guide_scheduler_t(issue_fn_t issue,
+                                                 pulse_guide_config_t config)
+    : _issue(std::move(issue)), _config(config), _stopping(false) {
+  _thread = std::thread(&pulse_guide_scheduler_t::scheduler_proc, this);
+}
+
+pulse_guide_scheduler_t::~pulse_guide_scheduler_t() { shutdown(); }
+
+void pulse_guide_scheduler_t::shutdown() {
+  {
+    std::lock_guard lock(_scheduler_mtx);
+    _stopping = true;
+    for (auto &axis : _axes)
+      finish(axis);
+  }
+  _scheduler_cv.notify_all();
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void pulse_guide_scheduler_t::submit(char direction, int duration_ms) {
+  auto index = axis_index(direction);
+  auto now = guide_clock_t::now();
+
+  {
+    std::lock_guard lock(_scheduler_mtx);
+    if (_stopping)
+      return;
+
+    auto &axis = _axes[index];
+    if (axis.active) {
+      spdlog::debug("pulse guide {} replaces the one still running",
+                    direction);
+      _stats.replaced++;
+    }
+
+    axis.active = true;
+    axis.generation++;
+    axis.direction = direction;
+    axis.requested_ms = std::max(duration_ms, 0);
+    axis.planned_ms = static_cast<int>(
+        std::lround(axis.requested_ms * _config.duration_scale));
+    axis.remaining_ms = axis.planned_ms;
+    axis.submitted_at = now;
+    axis.next_at = now;
+    axis.started = false;
+  }
+  _scheduler_cv.notify_all();
+}
+
+bool pulse_guide_scheduler_t::is_guiding() {
+  std::lock_guard lock(_scheduler_mtx);
+  return std::any_of(_axes.begin(), _axes.end(),
+                     [](const axis_t &axis) { return axis.active; });
+}
+
+void pulse_guide_scheduler_t::cancel() {
+  {
+    std::lock_guard lock(_scheduler_mtx);
+    for (auto &axis : _axes)
+      finish(axis);
+  }
+  _scheduler_cv.notify_all();
+}
+
+bool pulse_guide_scheduler_t::wait_until_idle(
+    std::chrono::milliseconds timeout) {
+  std::unique_lock lock(_scheduler_mtx);
+  return _scheduler_cv.wait_for(lock, timeout, [this] {
+    return std::none_of(_axes.begin(), _axes.end(),
+                        [](const axis_t &axis) { return axis.active; });
+  });
+}
+
+void pulse_guide_scheduler_t::configure(const pulse_guide_config_t &config) {
+  std::lock_guard lock(_scheduler_mtx);
+  _config = config;
+}
+
+pulse_guide_config_t pulse_guide_scheduler_t::config() {
+  std::lock_guard lock(_scheduler_mtx);
+  return _config;
+}
+
+void pulse_guide_scheduler_t::finish(axis_t &axis) {
+  if (!axis.active)
+    return;
+  axis.active = false;
+  axis.generation++;
+}
+
+void pulse_guide_scheduler_t::record(const axis_t &axis,
+                                     guide_clock_t::time_point ended_at) {
+  double scheduled_ms = ms_between(axis.first_written_at, ended_at);
+  double sent_ms = ms_between(axis.first_sent_at, axis.last_written_at);
+  double start_latency_ms =
+      ms_between(axis.submitted_at, axis.first_written_at);
+
+  _stats.pulses++;
+  _stats.last_requested_ms = axis.requested_ms;
+  _stats.last_planned_ms = axis.planned_ms;
+  _stats.last_scheduled_ms = scheduled_ms;
+  _stats.last_sent_ms = sent_ms;
+  _stats.total_requested_ms += axis.requested_ms;
+  _stats.total_scheduled_ms += scheduled_ms;
+  _stats.total_sent_ms += sent_ms;
+  _stats.total_start_latency_ms += start_latency_ms;
+  _stats.max_start_latency_ms =
+      std::max(_stats.max_start_latency_ms, start_latency_ms);
+
+  double late_ms = ms_between(
+      axis.submitted_at + std::chrono::milliseconds(axis.planned_ms), ended_at);
+  auto &edges = pulse_guide_stats_t::lateness_edges_ms;
+  auto bucket =
+      std::upper_bound(edges.begin(), edges.end(), late_ms) - edges.begin();
+  _stats.lateness_histogram[bucket]++;
+}
+
+pulse_guide_stats_t pulse_guide_scheduler_t::stats() {
+  std::lock_guard lock(_scheduler_mtx);
+  return _stats;
+}
+
+std::map<std::string, double> pulse_guide_scheduler_t::summary() {
+  auto stats = this->stats();
+  std::map<std::string, double> result;
+  result["pulses"] = stats.pulses;
+  result["replaced"] = stats.replaced;
+  result["failed"] = stats.failed;
+  result["last_requested_ms"] = stats.last_requested_ms;
+  result["last_planned_ms"] = stats.last_planned_ms;
+  result["last_scheduled_ms"] = stats.last_scheduled_ms;
+  result["last_sent_ms"] = stats.last_sent_ms;
+  if (stats.pulses > 0) {
+    result["mean_requested_ms"] = stats.total_requested_ms / stats.pulses;
+    result["mean_scheduled_ms"] = stats.total_scheduled_ms / stats.pulses;
+    result["mean_sent_ms"] = stats.total_sent_ms / stats.pulses;
+    result["mean_start_latency_ms"] =
+        stats.total_start_latency_ms / stats.pulses;
+  }
+  result["max_start_latency_ms"] = stats.max_start_latency_ms;
+  result["max_write_ms"] = stats.max_write_ms;
+
+  auto &edges = pulse_guide_stats_t::lateness_edges_ms;
+  for (size_t i = 0; i < stats.lateness_histogram.size(); i++) {
+    std::string name;
+    if (i == 0)
+      name = fmt::format("late_ms.<{}", edges.front());
+    else if (i == edges.size())
+      name = fmt::format("late_ms.>={}", edges.back());
+    else
+      name = fmt::format("late_ms.{}..{}", edges[i - 1], edges[i]);
+    result[name] = stats.lateness_histogram[i];
+  }
+  return result;
+}
+
+void pulse_guide_scheduler_t::apply_realtime_priority() {
+#ifdef __linux__
+  sched_param param{};
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+  int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (error != 0) {
+    spdlog::debug("pulse guide scheduler staying at normal priority: {}",
+                  std::strerror(error));
+    return;
+  }
+  spdlog::debug("pulse guide scheduler running SCHED_FIFO");
+#endif
+}
+
+void pulse_guide_scheduler_t::scheduler_proc() {
+  if (config().realtime_priority)
+    apply_realtime_priority();
+
+  std::unique_lock lock(_scheduler_mtx);
+  while (!_stopping) {
+    axis_t *due = nullptr;
+    for (auto &axis : _axes)
+      if (axis.active && (!due || axis.next_at < due->next_at))
+        due = &axis;
+
+    if (!due) {
+      _scheduler_cv.wait(lock);
+      continue;
+    }
+    if (guide_clock_t::now() < due->next_at) {
+      // Woken early by a submit or cancel, go round and look again
+      _scheduler_cv.wait_until(lock, due->next_at);
+      continue;
+    }
+
+    auto &axis = *due;
+    if (axis.remaining_ms == 0) {
+      // The mount has timed out the last chunk. A pulse with nothing to
+      // send never started, it doesn't go in the stats.
+      if (axis.started)
+        record(axis, axis.next_at);
+      finish(axis);
+      _scheduler_cv.notify_all();
+      continue;
+    }
+
+    int chunk_ms =
+        std::min<int>(axis.remaining_ms, _config.max_chunk.count());
+    char direction = axis.direction;
+    uint64_t generation = axis.generation;
+
+    // The serial round trip happens without the lock so submits and
+    // is_guiding() aren't held up behind it
+    lock.unlock();
+    bool sent = true;
+    auto sending_at = guide_clock_t::now();
+    try {
+      _issue(direction, chunk_ms);
+    } catch (std::exception &ex) {
+      spdlog::warn("pulse guide {} for {}ms failed: {}", direction, chunk_ms,
+                   ex.what());
+      sent = false;
+    }
+    auto written_at = guide_clock_t::now();
+    lock.lock();
+
+    // Replaced or cancelled while we were sending
+    if (axis.generation != generation)
+      continue;
+
+    if (!sent) {
+      _stats.failed++;
+      finish(axis);
+      _scheduler_cv.notify_all();
+      continue;
+    }
+
+    _stats.max_write_ms =
+        std::max(_stats.max_write_ms, ms_between(sending_at, written_at));
+    if (!axis.started) {
+      axis.started = true;
+      axis.first_sent_at = sending_at;
+      axis.first_written_at = written_at;
+    }
+    axis.last_written_at = written_at;
+    axis.remaining_ms -= chunk_ms;
+    // The mount times the chunk from when it arrives, so the next one goes
+    // when this one runs out rather than a fixed period after the last
+    axis.next_at = written_at + std::chrono::milliseconds(chunk_ms);
+  }
+}
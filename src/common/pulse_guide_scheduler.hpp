@@ -0,0 +1,137 @@
+#ifndef PULSE_GUIDE_SCHEDULER_HPP
+#define PULSE_GUIDE_SCHEDULER_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct pulse_guide_config_t {
+  // Longest pulse the mount takes in one command, longer ones get split up
+  std::chrono::milliseconds max_chunk{3000};
+  // Requested durations are multiplied by this before they go to the mount
+  double duration_scale = 1.0;
+  // Ask for SCHED_FIFO on the scheduler thread. That needs CAP_SYS_NICE or a
+  // suitable rtprio limit, without it we carry on at normal priority.
+  bool realtime_priority = true;
+};
+
+// Planned is the requested duration after duration_scale. Scheduled runs
+// from the first command's reply to the last chunk running out on the mount,
+// which we can only work out from the chunk lengths, so it is planned plus
+// any gaps between chunks and is exactly planned for a single chunk. Sent is
+// measured, from the first command starting to go out to the reply to the
+// last one.
+struct pulse_guide_stats_t {
+  // Edges of the lateness histogram in ms, the last bucket is open ended.
+  // Lateness is how long after submitted + planned the pulse finished on the
+  // mount, so the start latency plus any gaps between chunks.
+  static constexpr std::array<double, 7> lateness_edges_ms{1,  2,  5,  10,
+                                                           20, 50, 100};
+
+  uint64_t pulses = 0;
+  // Cut short by a newer pulse on the same axis
+  uint64_t replaced = 0;
+  // Sending one of the commands threw
+  uint64_t failed = 0;
+  double last_requested_ms = 0;
+  double last_planned_ms = 0;
+  double last_scheduled_ms = 0;
+  double last_sent_ms = 0;
+  double total_requested_ms = 0;
+  double total_scheduled_ms = 0;
+  double total_sent_ms = 0;
+  // Longest single guide command round trip
+  double max_write_ms = 0;
+  // From the pulse being asked for to its first command being written
+  double total_start_latency_ms = 0;
+  double max_start_latency_ms = 0;
+  std::array<uint64_t, lateness_edges_ms.size() + 1> lateness_histogram{};
+};
+
+// Runs pulse guiding for a mount on one long lived thread instead of a
+// thread per pulse. RA and Dec each get a timer, a pulse is sent as
+// max_chunk sized commands each issued when the previous one runs out on
+// the steady clock, so chunks don't drift apart the way they do with
+// sleep_for.
+class pulse_guide_scheduler_t {
+public:
+  // Sends one guide command for duration_ms in direction, one of e, w, n or
+  // s. Called on the scheduler thread.
+  using issue_fn_t = std::function<void(char direction, int duration_ms)>;
+
+  explicit pulse_guide_scheduler_t(issue_fn_t issue,
+                                   pulse_guide_config_t config = {});
+  ~pulse_guide_scheduler_t();
+
+  pulse_guide_scheduler_t(const pulse_guide_scheduler_t &) = delete;
+  pulse_guide_scheduler_t &operator=(const pulse_guide_scheduler_t &) = delete;
+
+  // Returns straight away, is_guiding() is true from here until the pulse
+  // has run out. A pulse on an axis that is already guiding replaces the one
+  // running there.
+  void submit(char direction, int duration_ms);
+
+  bool is_guiding();
+  // Drops any pulses still running, the commands already sent still play
+  // out on the mount
+  void cancel();
+  // true if everything finished before timeout
+  bool wait_until_idle(std::chrono::milliseconds timeout);
+  // Joins the thread, after this submit() does nothing
+  void shutdown();
+
+  void configure(const pulse_guide_config_t &config);
+  pulse_guide_config_t config();
+
+  pulse_guide_stats_t stats();
+  // Flattened for details(), e.g. "mean_sent_ms" and "late_ms.2..5"
+  std::map<std::string, double> summary();
+
+private:
+  using guide_clock_t = std::chrono::steady_clock;
+
+  struct axis_t {
+    bool active = false;
+    // Changes whenever the axis gets a new pulse or is cancelled, so a chunk
+    // sent without the lock held can tell if its pulse is still current
+    uint64_t generation = 0;
+    char direction = 0;
+    double requested_ms = 0;
+    int planned_ms = 0;
+    int remaining_ms = 0;
+    guide_clock_t::time_point submitted_at;
+    // When the next chunk goes out, or when the pulse ends once
+    // remaining_ms is 0
+    guide_clock_t::time_point next_at;
+    // Before the first chunk went out and after its reply
+    guide_clock_t::time_point first_sent_at;
+    guide_clock_t::time_point first_written_at;
+    // After the reply to the latest chunk
+    guide_clock_t::time_point last_written_at;
+    bool started = false;
+  };
+
+  void scheduler_proc();
+  void apply_realtime_priority();
+  // Caller holds _scheduler_mtx
+  void finish(axis_t &axis);
+  void record(const axis_t &axis, guide_clock_t::time_point ended_at);
+
+  issue_fn_t _issue;
+  std::mutex _scheduler_mtx;
+  std::condition_variable _scheduler_cv;
+  pulse_guide_config_t _config;
+  // RA then Dec
+  std::array<axis_t, 2> _axes;
+  pulse_guide_stats_t _stats;
+  bool _stopping;
+  std::thread _thread;
+};
+
+#endif
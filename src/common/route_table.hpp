@@ -0,0 +1,151 @@
+#ifndef ROUTE_TABLE_HPP
+#define ROUTE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class route_method_enum { get, put };
+
+// Maps (method, device type, action) straight to a handler. It's for the
+// Alpaca device API where every route is /api/v1/<device_type>/<n>/<action>
+// and the path has already been split up by the time we need a handler.
+//
+// Open addressing with linear probing, kept under half full so a lookup is
+// one hash of the pieces of the path plus a compare or two. The pieces are
+// hashed where they are, nothing gets allocated per lookup. Routes are only
+// added while the server is being set up, after that find() is read only and
+// safe from any number of threads.
+//
+// Matching ignores ASCII case, same as the express router did.
+template <typename Handler_T> class route_table_t {
+public:
+  route_table_t() : _slots(64), _size(0) {}
+
+  // First one in wins like it did with the express router, adding a route
+  // that's already there returns false and leaves the table alone
+  bool add(route_method_enum method, std::string_view device_type,
+           std::string_view action, Handler_T handler) {
+    if (find(method, device_type, action))
+      return false;
+
+    if ((_size + 1) * 2 > _slots.size())
+      grow();
+
+    slot_t slot;
+    slot.used = true;
+    slot.hash = hash(method, device_type, action);
+    slot.method = method;
+    slot.device_type = lowercase(device_type);
+    slot.action = lowercase(action);
+    slot.handler = std::move(handler);
+    place(std::move(slot));
+    _size++;
+    return true;
+  }
+
+  // nullptr if there's no such route
+  const Handler_T *find(route_method_enum method, std::string_view device_type,
+                        std::string_view action) const {
+    uint64_t h = hash(method, device_type, action);
+    size_t mask = _slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+      const slot_t &slot = _slots[i];
+      if (!slot.used)
+        return nullptr;
+      if (slot.hash == h && slot.method == method &&
+          same(slot.action, action) && same(slot.device_type, device_type))
+        return &slot.handler;
+    }
+  }
+
+  size_t size() const { return _size; }
+
+  // Longest run of slots a lookup could have to walk, for the bench
+  size_t max_probe() const {
+    size_t mask = _slots.size() - 1;
+    size_t longest = 0;
+    for (size_t i = 0; i < _slots.size(); i++) {
+      if (!_slots[i].used)
+        continue;
+      size_t probes = ((i - _slots[i].hash) & mask) + 1;
+      if (probes > longest)
+        longest = probes;
+    }
+    return longest;
+  }
+
+private:
+  struct slot_t {
+    bool used = false;
+    uint64_t hash = 0;
+    route_method_enum method = route_method_enum::get;
+    // Stored lowercase
+    std::string device_type;
+    std::string action;
+    Handler_T handler;
+  };
+
+  static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+
+  static std::string lowercase(std::string_view s) {
+    std::string out(s);
+    for (auto &c : out)
+      c = lower(c);
+    return out;
+  }
+
+  static bool same(const std::string &stored, std::string_view s) {
+    if (stored.size() != s.size())
+      return false;
+    for (size_t i = 0; i < s.size(); i++)
+      if (stored[i] != lower(s[i]))
+        return false;
+    return true;
+  }
+
+  // FNV-1a over the method, the type and the action, lowercased as it goes.
+  // The separator keeps e.g. "camera"+"xsize" and "cam"+"eraxsize" apart.
+  static uint64_t hash(route_method_enum method, std::string_view device_type,
+                       std::string_view action) {
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](char c) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 1099511628211ull;
+    };
+    mix(static_cast<char>(method));
+    for (char c : device_type)
+      mix(lower(c));
+    mix('/');
+    for (char c : action)
+      mix(lower(c));
+    return h;
+  }
+
+  void place(slot_t slot) {
+    size_t mask = _slots.size() - 1;
+    size_t i = slot.hash & mask;
+    while (_slots[i].used)
+      i = (i + 1) & mask;
+    _slots[i] = std::move(slot);
+  }
+
+  void grow() {
+    std::vector<slot_t> old(_slots.size() * 2);
+    old.swap(_slots);
+    for (auto &slot : old)
+      if (slot.used)
+        place(std::move(slot));
+  }
+
+  // Always a power of two
+  std::vector<slot_t> _slots;
+  size_t _size;
+};
+
+#endif
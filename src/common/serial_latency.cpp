@@ -0,0 +1,133 @@
+#include "serial_latency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace alpaca_hub_serial {
+
+serial_latency_tracker_t::serial_latency_tracker_t(
+    adaptive_timeout_config_t config)
+    : _config(config) {}
+
+void serial_latency_tracker_t::configure(
+    const adaptive_timeout_config_t &config) {
+  std::lock_guard lock(_latency_mtx);
+  _config = config;
+  for (auto &[name, family] : _families)
+    family.stats.timeout_ms = derive_timeout(family).count();
+}
+
+adaptive_timeout_config_t serial_latency_tracker_t::config() {
+  std::lock_guard lock(_latency_mtx);
+  return _config;
+}
+
+std::chrono::milliseconds
+serial_latency_tracker_t::derive_timeout(const family_t &family) const {
+  using namespace std::chrono;
+  if (!_config.enabled)
+    return family.fallback;
+
+  auto &stats = family.stats;
+  double timeout_ms = family.fallback.count();
+  double ceiling_ms = std::max<double>(_config.ceiling.count(), timeout_ms);
+  if (stats.count >= _config.min_samples) {
+    // p99 alone lags behind a link that's just got worse, the deviation
+    // catches that sooner
+    double slow_ms =
+        std::max(stats.p99_ms, stats.ewma_ms + 4 * stats.ewma_dev_ms);
+    timeout_ms = std::max<double>(slow_ms * _config.safety_factor,
+                                  _config.floor.count());
+    ceiling_ms = _config.ceiling.count();
+  }
+
+  // A run of timeouts means the link is slower than we think, back off
+  // until a reply gets through
+  timeout_ms = std::ceil(timeout_ms) *
+               (1u << std::min<uint32_t>(stats.consecutive_timeouts, 5));
+  return milliseconds(static_cast<int64_t>(std::min(timeout_ms, ceiling_ms)));
+}
+
+std::chrono::milliseconds
+serial_latency_tracker_t::timeout_for(const std::string &family_name,
+                                      std::chrono::milliseconds fallback) {
+  std::lock_guard lock(_latency_mtx);
+  auto &family = _families[family_name];
+  family.fallback = fallback;
+  auto timeout = derive_timeout(family);
+  family.stats.timeout_ms = timeout.count();
+  return timeout;
+}
+
+void serial_latency_tracker_t::record_reply(
+    const std::string &family_name,
+    std::chrono::steady_clock::duration round_trip) {
+  double ms = std::chrono::duration<double, std::milli>(round_trip).count();
+
+  std::lock_guard lock(_latency_mtx);
+  auto &family = _families[family_name];
+  auto &stats = family.stats;
+  double alpha = _config.ewma_alpha;
+
+  if (stats.count == 0) {
+    stats.ewma_ms = ms;
+    stats.ewma_dev_ms = ms / 2;
+  } else {
+    stats.ewma_dev_ms =
+        (1 - alpha) * stats.ewma_dev_ms + alpha * std::abs(ms - stats.ewma_ms);
+    stats.ewma_ms = (1 - alpha) * stats.ewma_ms + alpha * ms;
+  }
+  stats.count++;
+  stats.last_ms = ms;
+  stats.max_ms = std::max(stats.max_ms, ms);
+  stats.consecutive_timeouts = 0;
+
+  family.recent[family.next_sample] = static_cast<float>(ms);
+  family.next_sample = (family.next_sample + 1) % recent_sample_count;
+
+  size_t n = std::min<uint64_t>(stats.count, recent_sample_count);
+  std::vector<float> sorted(family.recent.begin(), family.recent.begin() + n);
+  size_t p99_index = static_cast<size_t>(std::ceil(0.99 * n)) - 1;
+  std::nth_element(sorted.begin(), sorted.begin() + p99_index, sorted.end());
+  stats.p99_ms = sorted[p99_index];
+
+  stats.timeout_ms = derive_timeout(family).count();
+}
+
+void serial_latency_tracker_t::record_timeout(const std::string &family_name) {
+  std::lock_guard lock(_latency_mtx);
+  auto &family = _families[family_name];
+  family.stats.timeouts++;
+  family.stats.consecutive_timeouts++;
+  family.stats.timeout_ms = derive_timeout(family).count();
+}
+
+std::map<std::string, serial_latency_stats_t>
+serial_latency_tracker_t::snapshot() {
+  std::lock_guard lock(_latency_mtx);
+  std::map<std::string, serial_latency_stats_t> result;
+  for (auto &[name, family] : _families)
+    result[name] = family.stats;
+  return result;
+}
+
+std::map<std::string, double> serial_latency_tracker_t::summary() {
+  std::map<std::string, double> result;
+  for (auto &[name, stats] : snapshot()) {
+    result[name + ".count"] = stats.count;
+    result[name + ".timeouts"] = stats.timeouts;
+    result[name + ".last_ms"] = stats.last_ms;
+    result[name + ".ewma_ms"] = stats.ewma_ms;
+    result[name + ".p99_ms"] = stats.p99_ms;
+    result[name + ".max_ms"] = stats.max_ms;
+    result[name + ".timeout_ms"] = stats.timeout_ms;
+  }
+  return result;
+}
+
+std::string command_family(const std::string &command) {
+  auto end = command.find_first_of(":\r\n");
+  return command.substr(0, end);
+}
+
+} // namespace alpaca_hub_serial
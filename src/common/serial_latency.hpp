@@ -0,0 +1,97 @@
+#ifndef SERIAL_LATENCY_HPP
+#define SERIAL_LATENCY_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace alpaca_hub_serial {
+
+// How a channel turns what it has seen of a command family's round trips into
+// a timeout for the next one
+struct adaptive_timeout_config_t {
+  // When off every request just uses its own timeout
+  bool enabled = true;
+  // The timeout is this many times the slow end of what we've seen
+  double safety_factor = 2.0;
+  // Never go below this, a USB link answers in a few ms but the OS can still
+  // take a moment to schedule us
+  std::chrono::milliseconds floor{5};
+  // and never wait longer than this, however bad the link gets
+  std::chrono::milliseconds ceiling{5000};
+  // Until a family has this many replies its requests keep their own timeout
+  uint64_t min_samples = 16;
+  // Weight of the newest sample in the moving averages
+  double ewma_alpha = 0.125;
+};
+
+struct serial_latency_stats_t {
+  uint64_t count = 0;
+  uint64_t timeouts = 0;
+  // Timeouts since the last good reply, each one doubles the next timeout
+  uint32_t consecutive_timeouts = 0;
+  double last_ms = 0;
+  double ewma_ms = 0;
+  // Moving average of how far samples land from ewma_ms
+  double ewma_dev_ms = 0;
+  // Over the most recent replies, see recent_sample_count
+  double p99_ms = 0;
+  double max_ms = 0;
+  // What the next request in this family will get
+  double timeout_ms = 0;
+};
+
+// Round trip stats for each command family on one device. A family is
+// whatever groups commands with the same kind of reply, e.g. "get_current_ra"
+// on a mount or "PA" on a PPBA.
+class serial_latency_tracker_t {
+public:
+  static constexpr size_t recent_sample_count = 128;
+
+  explicit serial_latency_tracker_t(adaptive_timeout_config_t config = {});
+
+  void configure(const adaptive_timeout_config_t &config);
+  adaptive_timeout_config_t config();
+
+  // fallback is the request's own timeout, used until there's enough history
+  std::chrono::milliseconds timeout_for(const std::string &family,
+                                        std::chrono::milliseconds fallback);
+
+  void record_reply(const std::string &family,
+                    std::chrono::steady_clock::duration round_trip);
+  // We don't know how long the reply would have taken so this doesn't go
+  // into the averages, it just backs the timeout off
+  void record_timeout(const std::string &family);
+
+  std::map<std::string, serial_latency_stats_t> snapshot();
+
+  // Flattened for details(), e.g. "get_current_ra.p99_ms"
+  std::map<std::string, double> summary();
+
+private:
+  struct family_t {
+    serial_latency_stats_t stats;
+    std::array<float, recent_sample_count> recent{};
+    size_t next_sample = 0;
+    // The fallback of the last request, for families still warming up
+    std::chrono::milliseconds fallback{0};
+  };
+
+  // Caller holds _latency_mtx
+  std::chrono::milliseconds derive_timeout(const family_t &family) const;
+
+  std::mutex _latency_mtx;
+  adaptive_timeout_config_t _config;
+  std::map<std::string, family_t> _families;
+};
+
+// Best guess at a family for devices that don't describe their commands, the
+// command up to its first ':' without any line ending. "P1:1\n" is "P1".
+std::string command_family(const std::string &command);
+
+} // namespace alpaca_hub_serial
+
+#endif
@@ -0,0 +1,530 @@
+#include "serial_reactor.hpp"
+#include "asio/post.hpp"
+#include "asio/write.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <termios.h>
+
+namespace alpaca_hub_serial {
+
+serial_channel_t::serial_channel_t(serial_reactor &reactor,
+                                   bool warn_on_serial_timeout)
+    : _reactor(reactor), _strand(asio::make_strand(reactor.context())),
+      // Built on the strand so every completion handler runs on it
+      _port(_strand), _deadline(_strand),
+      _latency(reactor.adaptive_timeouts()),
+      _warn_on_serial_timeout(warn_on_serial_timeout), _open(false),
+      _busy(false), _reply_index(0), _timed_out(false), _generation(0) {}
+
+serial_channel_t::~serial_channel_t() {
+  asio::error_code ignored;
+  _port.close(ignored);
+}
+
+void serial_channel_t::run_on_strand(const std::function<void()> &fn) {
+  if (_strand.running_in_this_thread()) {
+    fn();
+    return;
+  }
+  if (_reactor.running_in_reactor_thread())
+    throw std::logic_error(
+        "blocking serial call made from a serial reactor thread");
+
+  std::promise<void> done;
+  auto finished = done.get_future();
+  asio::post(_strand, [&fn, &done]() {
+    try {
+      fn();
+      done.set_value();
+    } catch (...) {
+      done.set_exception(std::current_exception());
+    }
+  });
+  finished.get();
+}
+
+void serial_channel_t::open(const std::string &device_path,
+                            unsigned int baud_rate) {
+  run_on_strand([&]() {
+    _port.open(device_path);
+    _port.set_option(asio::serial_port_base::baud_rate(baud_rate));
+    _port.set_option(asio::serial_port_base::character_size(8));
+    _port.set_option(asio::serial_port_base::flow_control(
+        asio::serial_port_base::flow_control::none));
+    _port.set_option(
+        asio::serial_port_base::parity(asio::serial_port_base::parity::none));
+    _port.set_option(asio::serial_port_base::stop_bits(
+        asio::serial_port_base::stop_bits::one));
+    _rx.discard();
+    _late_replies.clear();
+    _open = true;
+  });
+}
+
+void serial_channel_t::close() {
+  run_on_strand([&]() {
+    // Anything in flight finishes with an error
+    _open = false;
+    if (_port.is_open())
+      _port.close();
+  });
+}
+
+void serial_channel_t::flush() {
+  run_on_strand([&]() {
+    _rx.discard();
+    if (!_port.is_open())
+      return;
+    if (::tcflush(_port.native_handle(), TCIOFLUSH) != 0)
+      throw asio::system_error(
+          asio::error_code(errno, asio::error::get_system_category()),
+          "tcflush");
+  });
+}
+
+void serial_channel_t::async_transact(serial_request_t request,
+                                      completion_t handler) {
+  std::vector<serial_request_t> requests;
+  requests.push_back(std::move(request));
+  async_transact_batch(
+      std::move(requests),
+      [handler = std::move(handler)](std::vector<serial_reply_t> replies) {
+        if (handler)
+          handler(std::move(replies.front()));
+      });
+}
+
+void serial_channel_t::async_transact_batch(
+    std::vector<serial_request_t> requests, batch_completion_t handler) {
+  asio::post(_strand, [self = shared_from_this(),
+                       pending = pending_t{std::move(requests),
+                                           std::move(handler)}]() mutable {
+    self->_queue.push_back(std::move(pending));
+    if (!self->_busy)
+      self->start_next();
+  });
+}
+
+std::future<serial_reply_t>
+serial_channel_t::transact_async(serial_request_t request) {
+  auto reply = std::make_shared<std::promise<serial_reply_t>>();
+  auto result = reply->get_future();
+  async_transact(std::move(request), [reply](serial_reply_t r) {
+    reply->set_value(std::move(r));
+  });
+  return result;
+}
+
+serial_reply_t serial_channel_t::transact(serial_request_t request) {
+  if (_reactor.running_in_reactor_thread())
+    throw std::logic_error(
+        "blocking serial call made from a serial reactor thread");
+  return transact_async(std::move(request)).get();
+}
+
+std::vector<serial_reply_t>
+serial_channel_t::transact_batch(std::vector<serial_request_t> requests) {
+  if (_reactor.running_in_reactor_thread())
+    throw std::logic_error(
+        "blocking serial call made from a serial reactor thread");
+  std::promise<std::vector<serial_reply_t>> replies;
+  auto result = replies.get_future();
+  async_transact_batch(std::move(requests),
+                       [&replies](std::vector<serial_reply_t> r) {
+                         replies.set_value(std::move(r));
+                       });
+  return result.get();
+}
+
+std::chrono::milliseconds
+serial_channel_t::timeout_for(const serial_request_t &request) {
+  if (!request.family.empty() && request.frame_length)
+    return _latency.timeout_for(request.family, request.timeout);
+  return request.timeout;
+}
+
+void serial_channel_t::arm_deadline(std::chrono::milliseconds timeout) {
+  // Anything the timer still has queued is for an earlier reply
+  _generation++;
+  _timed_out = false;
+
+  // Hitting the deadline cancels whatever is outstanding on the port, which
+  // then fails the reply from its own handler
+  _deadline.expires_after(timeout);
+  _deadline.async_wait([self = shared_from_this(), generation = _generation](
+                           const asio::error_code &error) {
+    if (error || generation != self->_generation)
+      return;
+    self->_timed_out = true;
+    asio::error_code ignored;
+    self->_port.cancel(ignored);
+  });
+}
+
+void serial_channel_t::start_next() {
+  if (_queue.empty()) {
+    _busy = false;
+    return;
+  }
+  _busy = true;
+  _current = std::move(_queue.front());
+  _queue.pop_front();
+  _replies.clear();
+  _reply_index = 0;
+
+  if (_current.requests.empty()) {
+    finish();
+    return;
+  }
+
+  if (!_port.is_open()) {
+    _late_replies.clear();
+    fail_remaining({false, "", asio::error::bad_descriptor});
+    return;
+  }
+
+  if (!_late_replies.empty()) {
+    drain_late_replies();
+    return;
+  }
+  write_current();
+}
+
+void serial_channel_t::drain_late_replies() {
+  std::string_view frame;
+  while (!_late_replies.empty() &&
+         _rx.take_frame(_late_replies.front(), frame)) {
+    spdlog::debug("dropping late reply: {}", frame);
+    _late_replies.erase(_late_replies.begin());
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (_late_replies.empty() || now >= _late_until) {
+    _late_replies.clear();
+    discard_input();
+    write_current();
+    return;
+  }
+
+  arm_deadline(std::chrono::ceil<std::chrono::milliseconds>(_late_until - now));
+  _port.async_read_some(
+      _rx.prepare(), [self = shared_from_this()](const asio::error_code &error,
+                                                  size_t bytes_transferred) {
+        self->_rx.commit(bytes_transferred);
+        // Out of time or the port's gone, either way stop waiting
+        if (error)
+          self->_late_replies.clear();
+        self->drain_late_replies();
+      });
+}
+
+void serial_channel_t::discard_input() {
+  _rx.discard();
+  if (_port.is_open() && ::tcflush(_port.native_handle(), TCIFLUSH) != 0)
+    spdlog::debug("tcflush failed: {}", std::strerror(errno));
+}
+
+void serial_channel_t::write_current() {
+  // Everything goes out back to back, the device works through it while
+  // we wait for the first reply
+  _tx.clear();
+  for (auto &request : _current.requests)
+    _tx += request.command;
+
+  _started = std::chrono::steady_clock::now();
+  arm_deadline(timeout_for(_current.requests.front()));
+
+  auto after_write = [self = shared_from_this()](const asio::error_code &error,
+                                                 size_t) {
+    if (error) {
+      self->fail_remaining(
+          {false, "", self->_timed_out ? asio::error::timed_out : error});
+      return;
+    }
+    self->read_reply();
+  };
+
+  // e.g. the filterwheel just listening for the end of a move
+  if (_tx.empty())
+    after_write({}, 0);
+  else
+    asio::async_write(_port, asio::buffer(_tx), after_write);
+}
+
+void serial_channel_t::read_reply() {
+  auto &request = _current.requests[_reply_index];
+  if (!request.frame_length) {
+    complete_reply({});
+    return;
+  }
+
+  // The reply may already be sitting in the buffer
+  std::string_view frame;
+  if (_rx.take_frame(request.frame_length, frame)) {
+    complete_reply(frame);
+    return;
+  }
+
+  _port.async_read_some(
+      _rx.prepare(), [self = shared_from_this()](const asio::error_code &error,
+                                                  size_t bytes_transferred) {
+        self->_rx.commit(bytes_transferred);
+        auto &request = self->_current.requests[self->_reply_index];
+        std::string_view frame;
+        if (self->_rx.take_frame(request.frame_length, frame)) {
+          self->complete_reply(frame);
+          return;
+        }
+        if (error || self->_timed_out) {
+          self->_rx.take(self->_rx.size(), frame);
+          bool timed_out =
+              self->_timed_out || error == asio::error::operation_aborted;
+          self->fail_remaining({false, std::string(frame),
+                                timed_out ? asio::error::timed_out : error});
+          return;
+        }
+        self->read_reply();
+      });
+}
+
+void serial_channel_t::complete_reply(std::string_view frame) {
+  auto &request = _current.requests[_reply_index];
+  // Only the first reply of a batch is a whole round trip, the rest were
+  // on their way while we waited for it
+  if (_reply_index == 0 && !request.family.empty() && request.frame_length)
+    _latency.record_reply(request.family,
+                          std::chrono::steady_clock::now() - _started);
+
+  _replies.push_back({true, std::string(frame), {}});
+  if (++_reply_index == _current.requests.size()) {
+    finish();
+    return;
+  }
+  arm_deadline(timeout_for(_current.requests[_reply_index]));
+  read_reply();
+}
+
+void serial_channel_t::fail_remaining(serial_reply_t reply) {
+  auto &request = _current.requests[_reply_index];
+  if (reply.error == asio::error::timed_out) {
+    if (!request.family.empty() && request.frame_length)
+      _latency.record_timeout(request.family);
+    log_serial_timeout(request.command, _warn_on_serial_timeout);
+  } else {
+    spdlog::warn("serial transaction failed for cmd: \"{}\": {}",
+                 request.command, reply.error.message());
+  }
+
+  // The device may still be working through what we sent, what it says
+  // next belongs to the replies we're giving up on
+  if (reply.error == asio::error::timed_out) {
+    _late_until = _started;
+    for (size_t i = _reply_index; i < _current.requests.size(); i++) {
+      auto &late = _current.requests[i];
+      if (late.frame_length)
+        _late_replies.push_back(late.frame_length);
+      // Whichever is longer of what the request asked for and what its
+      // family has learned, which may well be more after a run of timeouts
+      _late_until = std::max(
+          _late_until, _started + std::max(late.timeout, timeout_for(late)));
+    }
+  }
+
+  _replies.push_back(std::move(reply));
+  for (_reply_index++; _reply_index < _current.requests.size();
+       _reply_index++)
+    _replies.push_back({false, "", asio::error::operation_aborted});
+
+  // Whatever's left belongs to replies we've given up on
+  discard_input();
+  finish();
+}
+
+void serial_channel_t::finish() {
+  _generation++;
+  _deadline.cancel();
+
+  auto handler = std::move(_current.handler);
+  auto replies = std::move(_replies);
+  _current = pending_t{};
+  _replies.clear();
+  if (handler) {
+    try {
+      handler(std::move(replies));
+    } catch (std::exception &ex) {
+      spdlog::error("serial completion handler threw: {}", ex.what());
+    }
+  }
+  start_next();
+}
+
+polled_task_t::polled_task_t(serial_reactor &reactor, task_t task)
+    : _reactor(reactor), _task(std::move(task)),
+      _strand(asio::make_strand(reactor.context())), _timer(_strand),
+      _stopped(false), _running(false), _wake_pending(false), _armed(false),
+      _last_delay(std::chrono::milliseconds(1000)) {
+  _reactor.add_polled_task();
+}
+
+polled_task_t::~polled_task_t() { _reactor.remove_polled_task(); }
+
+void polled_task_t::arm(std::chrono::milliseconds delay) {
+  asio::post(_strand, [self = shared_from_this(), delay]() {
+    auto next = delay;
+    {
+      std::lock_guard lock(self->_task_mtx);
+      if (self->_stopped)
+        return;
+      // Someone wanted it while it was running
+      if (self->_wake_pending) {
+        self->_wake_pending = false;
+        next = std::chrono::milliseconds(0);
+      }
+    }
+    self->_timer.expires_after(next);
+    self->wait();
+  });
+}
+
+void polled_task_t::wait() {
+  _armed = true;
+  _timer.async_wait([self = shared_from_this()](const asio::error_code &error) {
+    // Cut short by wake() or stop(), whoever did it has taken over
+    if (error)
+      return;
+    self->_armed = false;
+    self->run();
+  });
+}
+
+void polled_task_t::wake() {
+  asio::post(_strand, [self = shared_from_this()]() {
+    {
+      std::lock_guard lock(self->_task_mtx);
+      if (self->_stopped)
+        return;
+      // Running, or between runs with arm() still to come, either way arm()
+      // picks this up
+      if (self->_running || !self->_armed) {
+        self->_wake_pending = true;
+        return;
+      }
+    }
+    // If nothing was cancelled the timer has already gone off and run() is
+    // on its way
+    if (self->_timer.expires_after(std::chrono::milliseconds(0)) > 0)
+      self->wait();
+  });
+}
+
+void polled_task_t::run() {
+  {
+    std::lock_guard lock(_task_mtx);
+    if (_stopped)
+      return;
+    _running = true;
+  }
+
+  _reactor.poll_pool().submit([self = shared_from_this()]() {
+    {
+      std::lock_guard lock(self->_task_mtx);
+      self->_running_on = std::this_thread::get_id();
+    }
+
+    auto next = self->_last_delay;
+    try {
+      next = self->_task();
+      self->_last_delay = next;
+    } catch (std::exception &ex) {
+      spdlog::warn("polled task failed: {}", ex.what());
+    }
+
+    bool stopped;
+    {
+      std::lock_guard lock(self->_task_mtx);
+      self->_running = false;
+      self->_running_on = std::thread::id();
+      stopped = self->_stopped;
+    }
+    self->_task_cv.notify_all();
+    if (!stopped)
+      self->arm(next);
+  });
+}
+
+void polled_task_t::stop() {
+  {
+    std::unique_lock lock(_task_mtx);
+    _stopped = true;
+    // From inside the task itself there's nothing to wait for
+    if (_running_on != std::this_thread::get_id())
+      _task_cv.wait(lock, [this]() { return !_running; });
+  }
+  asio::post(_strand, [self = shared_from_this()]() { self->_timer.cancel(); });
+}
+
+serial_reactor &serial_reactor::instance() {
+  // Leaked on purpose. Drivers can be torn down during static destruction
+  // and their channels still need the io_context then.
+  static serial_reactor *reactor = new serial_reactor();
+  return *reactor;
+}
+
+serial_reactor::serial_reactor()
+    : _work(asio::make_work_guard(_io_ctx)), _poll_pool(0),
+      _polled_tasks(0) {
+  // Handlers here only shuffle bytes around so one thread is plenty, a
+  // second keeps one slow handler from holding everyone else up
+  auto thread_count =
+      std::clamp(std::thread::hardware_concurrency(), 1u, 2u);
+  for (unsigned int i = 0; i < thread_count; i++)
+    _threads.emplace_back([this]() {
+      while (true) {
+        try {
+          _io_ctx.run();
+          return;
+        } catch (std::exception &ex) {
+          spdlog::error("serial reactor handler threw: {}", ex.what());
+        }
+      }
+    });
+}
+
+serial_channel_ptr_t serial_reactor::make_channel(bool warn_on_serial_timeout) {
+  return std::make_shared<serial_channel_t>(*this, warn_on_serial_timeout);
+}
+
+void serial_reactor::set_adaptive_timeouts(
+    const adaptive_timeout_config_t &config) {
+  std::lock_guard lock(_config_mtx);
+  _adaptive_timeouts = config;
+}
+
+adaptive_timeout_config_t serial_reactor::adaptive_timeouts() {
+  std::lock_guard lock(_config_mtx);
+  return _adaptive_timeouts;
+}
+
+void serial_reactor::add_polled_task() {
+  std::lock_guard lock(_poll_mtx);
+  _polled_tasks++;
+  // A task only ever has one run queued or running, so with a thread each
+  // none of them waits behind another's slow transact()
+  _poll_pool.grow(_polled_tasks);
+}
+
+void serial_reactor::remove_polled_task() {
+  std::lock_guard lock(_poll_mtx);
+  _polled_tasks--;
+}
+
+polled_task_ptr_t serial_reactor::schedule(polled_task_t::task_t task,
+                                           std::chrono::milliseconds first_delay) {
+  auto polled_task = std::make_shared<polled_task_t>(*this, std::move(task));
+  polled_task->arm(first_delay);
+  return polled_task;
+}
+
+} // namespace alpaca_hub_serial
@@ -0,0 +1,250 @@
+#ifndef SERIAL_REACTOR_HPP
+#define SERIAL_REACTOR_HPP
+
+#include "asio/executor_work_guard.hpp"
+#include "asio/io_context.hpp"
+#include "asio/serial_port.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/strand.hpp"
+#include "common/alpaca_hub_serial.hpp"
+#include "common/serial_latency.hpp"
+#include "common/worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace alpaca_hub_serial {
+
+class serial_reactor;
+
+// One command / reply exchange with a device
+struct serial_request_t {
+  std::string command;
+  // Leave empty for commands that don't get a reply
+  std::function<size_t(std::string_view)> frame_length;
+  // Covers writing the command and reading the whole reply
+  std::chrono::milliseconds timeout{250};
+  // Requests with a family get their timeout from how long that family's
+  // replies have been taking, timeout above is just where it starts. Leave
+  // it empty for a fixed timeout.
+  std::string family;
+};
+
+struct serial_reply_t {
+  // false on a timeout or error, frame then holds whatever partial reply
+  // arrived
+  bool complete = false;
+  std::string frame;
+  asio::error_code error;
+};
+
+// A serial port driven by the shared serial_reactor.
+//
+// Transactions are queued and run one at a time on the port's strand: write
+// the command, read until the frame is complete or the deadline passes, hand
+// the reply to the completion handler. Nothing blocks a reactor thread, so
+// one or two threads can serve every device.
+//
+// A batch writes all of its commands in one go and then splits the replies
+// up in order, so N queries cost one trip over the link instead of N. That
+// only works when every request's frame_length knows exactly where its
+// reply ends.
+class serial_channel_t : public std::enable_shared_from_this<serial_channel_t> {
+public:
+  using completion_t = std::function<void(serial_reply_t)>;
+  using batch_completion_t = std::function<void(std::vector<serial_reply_t>)>;
+
+  serial_channel_t(serial_reactor &reactor, bool warn_on_serial_timeout);
+  ~serial_channel_t();
+
+  serial_channel_t(const serial_channel_t &) = delete;
+  serial_channel_t &operator=(const serial_channel_t &) = delete;
+
+  // 8 data bits, no parity, one stop bit and no flow control, which is what
+  // all of our devices use. Throws asio::system_error like
+  // asio::serial_port::open does.
+  void open(const std::string &device_path, unsigned int baud_rate);
+  void close();
+  bool is_open() const { return _open; }
+
+  // Drops anything in the OS buffers in both directions as well as anything
+  // we've buffered
+  void flush();
+
+  // handler is called on a reactor thread so it mustn't block
+  void async_transact(serial_request_t request, completion_t handler);
+  std::future<serial_reply_t> transact_async(serial_request_t request);
+
+  // Blocking wrapper for the drivers' send_command_to_* functions. Throws
+  // std::logic_error if called on a reactor thread, it would never finish.
+  serial_reply_t transact(serial_request_t request);
+
+  // One reply per request, in the same order. Each reply gets its request's
+  // timeout from when the one before it finished. After a failed reply we
+  // can't tell where the rest start, so they all fail with
+  // asio::error::operation_aborted.
+  void async_transact_batch(std::vector<serial_request_t> requests,
+                            batch_completion_t handler);
+  std::vector<serial_reply_t>
+  transact_batch(std::vector<serial_request_t> requests);
+
+  // Round trip stats for the requests that have a family
+  serial_latency_tracker_t &latency() { return _latency; }
+
+private:
+  struct pending_t {
+    std::vector<serial_request_t> requests;
+    batch_completion_t handler;
+  };
+
+  void start_next();
+  // Arms the deadline and writes _current's commands
+  void write_current();
+  // Reads and drops the replies we gave up on before writing anything else,
+  // or they'd be taken for the replies to the next commands
+  void drain_late_replies();
+  // Drops what's in _rx and the OS's input buffer
+  void discard_input();
+  void arm_deadline(std::chrono::milliseconds timeout);
+  // Reads the reply to _current.requests[_reply_index] and then the rest
+  void read_reply();
+  void complete_reply(std::string_view frame);
+  // Fails the current reply with error and anything after it as aborted
+  void fail_remaining(serial_reply_t reply);
+  void finish();
+  std::chrono::milliseconds timeout_for(const serial_request_t &request);
+  // Runs fn on the strand and waits for it, passing on any exception
+  void run_on_strand(const std::function<void()> &fn);
+
+  serial_reactor &_reactor;
+  asio::strand<asio::io_context::executor_type> _strand;
+  asio::serial_port _port;
+  asio::steady_timer _deadline;
+  rx_buffer_t _rx;
+  serial_latency_tracker_t _latency;
+  bool _warn_on_serial_timeout;
+  std::atomic<bool> _open;
+
+  // Only touched on the strand
+  std::deque<pending_t> _queue;
+  bool _busy;
+  pending_t _current;
+  std::string _tx;
+  std::vector<serial_reply_t> _replies;
+  size_t _reply_index;
+  std::chrono::steady_clock::time_point _started;
+  bool _timed_out;
+  uint64_t _generation;
+  // After a timeout, the frame lengths of the replies that may still turn
+  // up and how long they may take to. Adaptive timeouts give up well before
+  // the device would, so this runs to the longer of the requests' own
+  // timeout and their family's.
+  std::vector<std::function<size_t(std::string_view)>> _late_replies;
+  std::chrono::steady_clock::time_point _late_until;
+};
+
+using serial_channel_ptr_t = std::shared_ptr<serial_channel_t>;
+
+// A recurring job run on the reactor's poll pool, e.g. a driver refreshing
+// its cached properties. Replaces the per-device threads that spent their
+// lives in sleep_for. The pool keeps a thread for every task, so one device
+// that stops answering can't hold up everyone else's polls.
+class polled_task_t : public std::enable_shared_from_this<polled_task_t> {
+public:
+  // task returns how long to wait before running it again
+  using task_t = std::function<std::chrono::milliseconds()>;
+
+  polled_task_t(serial_reactor &reactor, task_t task);
+  ~polled_task_t();
+
+  // Once this returns the task isn't running and won't run again. Safe to
+  // call from inside the task, it just won't be rescheduled.
+  void stop();
+
+  // Runs the task now instead of when it asked to be run next. If it's
+  // running already it goes again as soon as it's done. Doesn't block, so
+  // it's fine to call with locks held or from inside the task.
+  void wake();
+
+private:
+  friend class serial_reactor;
+  void arm(std::chrono::milliseconds delay);
+  // Caller is on the strand
+  void wait();
+  void run();
+
+  serial_reactor &_reactor;
+  task_t _task;
+  asio::strand<asio::io_context::executor_type> _strand;
+  asio::steady_timer _timer;
+  std::mutex _task_mtx;
+  std::condition_variable _task_cv;
+  bool _stopped;
+  bool _running;
+  // A wake() that came in while there was no timer to cut short
+  bool _wake_pending;
+  // Only touched on the strand, there's a timer wait outstanding
+  bool _armed;
+  std::thread::id _running_on;
+  std::chrono::milliseconds _last_delay;
+};
+
+using polled_task_ptr_t = std::shared_ptr<polled_task_t>;
+
+// The one io_context every serial device in the process runs on
+class serial_reactor {
+public:
+  static serial_reactor &instance();
+
+  serial_channel_ptr_t make_channel(bool warn_on_serial_timeout = true);
+
+  // Used by channels made after this is set, AlpacaHub's -sts and -stf
+  void set_adaptive_timeouts(const adaptive_timeout_config_t &config);
+  adaptive_timeout_config_t adaptive_timeouts();
+
+  // Runs task on the poll pool after first_delay and then again after
+  // whatever delay it returns each time, until stopped
+  polled_task_ptr_t schedule(polled_task_t::task_t task,
+                             std::chrono::milliseconds first_delay =
+                                 std::chrono::milliseconds(0));
+
+  asio::io_context &context() { return _io_ctx; }
+  worker_pool_t &poll_pool() { return _poll_pool; }
+  bool running_in_reactor_thread() {
+    return _io_ctx.get_executor().running_in_this_thread();
+  }
+
+private:
+  friend class polled_task_t;
+
+  // Never destroyed, see instance()
+  serial_reactor();
+
+  // Each polled task holds a poll pool thread for as long as it exists
+  void add_polled_task();
+  void remove_polled_task();
+
+  asio::io_context _io_ctx;
+  asio::executor_work_guard<asio::io_context::executor_type> _work;
+  std::vector<std::thread> _threads;
+  // Polls make blocking transact() calls so they can't run on the reactor
+  // threads themselves. Only ever grows, to the most tasks there have been
+  // at once.
+  worker_pool_t _poll_pool;
+  std::mutex _poll_mtx;
+  size_t _polled_tasks;
+  std::mutex _config_mtx;
+  adaptive_timeout_config_t _adaptive_timeouts;
+};
+
+} // namespace alpaca_hub_serial
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free single producer / single consumer ring. One thread may
+// try_push(), one (other) thread may try_pop().
+//
+// Nothing ever waits: a push into a full ring just fails, which is what we
+// want for live frames where a slow reader should miss frames rather than
+// hold up the camera.
+template <typename T> class spsc_ring_t {
+public:
+  // Capacity is rounded up to a power of two
+  explicit spsc_ring_t(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity)
+      size <<= 1;
+    _slots.resize(size);
+    _mask = size - 1;
+  }
+
+  spsc_ring_t(const spsc_ring_t &) = delete;
+  spsc_ring_t &operator=(const spsc_ring_t &) = delete;
+
+  // Producer only
+  bool try_push(T value) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) > _mask)
+      return false;
+    _slots[head & _mask] = std::move(value);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. The slot is moved out of so whatever it held (e.g. a
+  // frame buffer) is released right away rather than when it's overwritten.
+  bool try_pop(T &value) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire))
+      return false;
+    value = std::move(_slots[tail & _mask]);
+    _slots[tail & _mask] = T();
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Safe from either side, but only a snapshot. _tail has to be read first
+  // or a push and pop in between could make it look bigger than _head.
+  size_t size() const {
+    size_t tail = _tail.load(std::memory_order_acquire);
+    return _head.load(std::memory_order_acquire) - tail;
+  }
+  bool empty() const { return size() == 0; }
+  size_t capacity() const { return _mask + 1; }
+
+private:
+  std::vector<T> _slots;
+  size_t _mask;
+
+  // Producer owns _head, the consumer owns _tail
+  alignas(64) std::atomic<size_t> _head{0};
+  alignas(64) std::atomic<size_t> _tail{0};
+};
+
+#endif
@@ -0,0 +1,23 @@
+#include "star_field.hpp"
+#include <algorithm>
+
+void star_field_t::render(camera_frame_t &frame, double exposure_seconds,
+                          double gain, double offset, uint64_t sequence,
+                          double max_adu, double offset_x,
+                          double offset_y) const {
+  star_field_window_t window;
+  window.width = frame.width;
+  window.height = frame.height;
+  window.start_x = frame.start_x;
+  window.start_y = frame.start_y;
+  window.bin_x = frame.bin_x;
+  window.bin_y = frame.bin_y;
+
+  if (frame.bytes_per_pixel() == 1)
+    render_pixels(frame.data(), window, exposure_seconds, gain, offset,
+                  sequence, std::min(max_adu, 255.0), offset_x, offset_y);
+  else
+    render_pixels(reinterpret_cast<uint16_t *>(frame.data()), window,
+                  exposure_seconds, gain, offset, sequence,
+                  std::min(max_adu, 65535.0), offset_x, offset_y);
+}
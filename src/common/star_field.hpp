@@ -0,0 +1,22 @@
+#ifndef STAR_FIELD_HPP
+#define STAR_FIELD_HPP
+
+#include "common/camera_frame.hpp"
+#include "common/star_field_renderer.hpp"
+#include <cstdint>
+
+// Synthetic frames for the simulated camera, see star_field_renderer_t. The
+// sky is the same one the QHY SDK stub draws so anything that looks at the
+// pixels, e.g. compute_frame_stats, has something to find.
+class star_field_t : public star_field_renderer_t {
+public:
+  using star_field_renderer_t::star_field_renderer_t;
+
+  // Fills frame's pixels for the window its start / bin / width / height
+  // describe, frame.buffer has to hold at least size_bytes()
+  void render(camera_frame_t &frame, double exposure_seconds, double gain,
+              double offset, uint64_t sequence, double max_adu,
+              double offset_x = 0, double offset_y = 0) const;
+};
+
+#endif
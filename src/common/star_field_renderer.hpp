@@ -0,0 +1,144 @@
+#ifndef STAR_FIELD_RENDERER_HPP
+#define STAR_FIELD_RENDERER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Header only and standard library only, so the QHY SDK stub can draw the
+// same sky as star_field_t without linking common
+
+struct star_field_config_t {
+  // Unbinned sensor size the stars are scattered over
+  uint32_t width = 4144;
+  uint32_t height = 2822;
+  uint32_t star_count = 400;
+  // Same seed, same sky
+  uint32_t seed = 1;
+
+  // In 16 bit ADU at gain 0, scaled down for shallower frames
+  double bias = 500;
+  double sky_per_second = 40;
+  double read_noise = 20;
+  // Star profile sigmas are picked from this range, in unbinned pixels
+  double min_sigma = 1.2;
+  double max_sigma = 2.2;
+};
+
+// The part of the sensor being read out, start and size in binned pixels
+struct star_field_window_t {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t start_x = 0;
+  uint32_t start_y = 0;
+  double bin_x = 1;
+  double bin_y = 1;
+};
+
+// A bias and sky background that grow with exposure and gain, noise, and a
+// fixed field of gaussian stars (lots of faint ones and a few bright ones)
+class star_field_renderer_t {
+public:
+  struct star_t {
+    // Unbinned sensor coordinates
+    double x;
+    double y;
+    // Peak ADU per second of exposure at gain 0
+    double flux;
+    double sigma;
+  };
+
+  explicit star_field_renderer_t(const star_field_config_t &config = {})
+      : _config(config) {
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> x_dist(0, config.width);
+    std::uniform_real_distribution<double> y_dist(0, config.height);
+    std::exponential_distribution<double> flux_dist(1.0 / 2000);
+    std::uniform_real_distribution<double> sigma_dist(config.min_sigma,
+                                                      config.max_sigma);
+
+    _stars.reserve(config.star_count);
+    for (uint32_t i = 0; i < config.star_count; i++)
+      _stars.push_back(
+          {x_dist(rng), y_dist(rng), 200 + flux_dist(rng), sigma_dist(rng)});
+  }
+
+  // Fills out, row major, with window.width * window.height pixels.
+  // Sequence picks the noise so successive frames aren't identical.
+  // offset_x / offset_y shift the whole sky in unbinned pixels, e.g. for a
+  // drifting mount.
+  template <typename T>
+  void render_pixels(T *out, const star_field_window_t &window,
+                     double exposure_seconds, double gain, double offset,
+                     uint64_t sequence, double max_adu, double offset_x = 0,
+                     double offset_y = 0) const {
+    uint32_t w = window.width;
+    uint32_t h = window.height;
+    double bin_x = window.bin_x;
+    double bin_y = window.bin_y;
+    double gain_factor = std::pow(10, gain / 200);
+    double scale = max_adu / 65535;
+    double bin_area = bin_x * bin_y;
+
+    double background = (_config.bias + offset * 10 +
+                         _config.sky_per_second * exposure_seconds *
+                             gain_factor * bin_area) *
+                        scale;
+    double noise_amplitude = (_config.read_noise + 5 * gain_factor) * scale;
+
+    // xorshift is plenty for noise and much cheaper than <random> per pixel
+    uint32_t state =
+        uint32_t(_config.seed * 2654435761u + sequence * 40503u) | 1;
+    auto next = [&state]() {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state;
+    };
+
+    size_t pixels = size_t(w) * h;
+    for (size_t i = 0; i < pixels; i++)
+      out[i] = T(std::clamp(background + noise_amplitude *
+                                             ((next() & 0xffff) / 32768.0 - 1),
+                            0.0, max_adu));
+
+    for (auto &star : _stars) {
+      double sx = (star.x + offset_x) / bin_x - window.start_x;
+      double sy = (star.y + offset_y) / bin_y - window.start_y;
+      double sigma = std::max(star.sigma / std::max(bin_x, bin_y), 0.6);
+      int radius = int(std::ceil(sigma * 4));
+      if (sx < -radius || sy < -radius || sx >= w + radius || sy >= h + radius)
+        continue;
+
+      double peak =
+          star.flux * exposure_seconds * gain_factor * bin_area * scale;
+      double inv_two_sigma_sq = 1 / (2 * sigma * sigma);
+      int x0 = std::max(0, int(sx) - radius);
+      int x1 = std::min(int(w) - 1, int(sx) + radius);
+      int y0 = std::max(0, int(sy) - radius);
+      int y1 = std::min(int(h) - 1, int(sy) + radius);
+      for (int y = y0; y <= y1; y++) {
+        double dy = y - sy;
+        for (int x = x0; x <= x1; x++) {
+          double dx = x - sx;
+          T &p = out[size_t(y) * w + x];
+          p = T(std::min(
+              p + peak * std::exp(-(dx * dx + dy * dy) * inv_two_sigma_sq),
+              max_adu));
+        }
+      }
+    }
+  }
+
+  const std::vector<star_t> &stars() const { return _stars; }
+  const star_field_config_t &config() const { return _config; }
+
+private:
+  star_field_config_t _config;
+  std::vector<star_t> _stars;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "worker_pool.hpp"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <spdlog/spdlog.h>
+
+worker_pool_t::worker_pool_t(size_t thread_count) : _stopping(false) {
+  for (size_t i = 0; i < thread_count; i++)
+    _threads.emplace_back(&worker_pool_t::worker_proc, this);
+}
+
+worker_pool_t::~worker_pool_t() {
+  {
+    std::lock_guard lock(_pool_mtx);
+    _stopping = true;
+    _tasks.clear();
+  }
+  _pool_cv.notify_all();
+  for (auto &t : _threads)
+    t.join();
+}
+
+void worker_pool_t::grow(size_t thread_count) {
+  std::lock_guard lock(_pool_mtx);
+  while (_threads.size() < thread_count)
+    _threads.emplace_back(&worker_pool_t::worker_proc, this);
+}
+
+size_t worker_pool_t::concurrency() const {
+  std::lock_guard lock(_pool_mtx);
+  return _threads.size() + 1;
+}
+
+void worker_pool_t::submit(std::function<void()> task) {
+  {
+    std::lock_guard lock(_pool_mtx);
+    _tasks.push_back(std::move(task));
+  }
+  _pool_cv.notify_one();
+}
+
+void worker_pool_t::worker_proc() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(_pool_mtx);
+      _pool_cv.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+      if (_stopping)
+        return;
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+
+    try {
+      task();
+    } catch (std::exception &ex) {
+      spdlog::error("worker pool task threw: {}", ex.what());
+    }
+  }
+}
+
+void worker_pool_t::parallel_for(size_t count,
+                                 const std::function<void(size_t)> &fn) {
+  if (count == 0)
+    return;
+
+  // Helpers can get scheduled after everything is already done, so the
+  // shared state has to outlive this call. They only touch fn after
+  // claiming an index, which can't happen once we've returned.
+  struct state_t {
+    std::atomic<size_t> next{0};
+    size_t done = 0;
+    std::exception_ptr error;
+    std::mutex mtx;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<state_t>();
+
+  auto run = [state, count, &fn]() {
+    size_t finished = 0;
+    std::exception_ptr error;
+    for (size_t i = state->next++; i < count; i = state->next++) {
+      try {
+        fn(i);
+      } catch (...) {
+        if (!error)
+          error = std::current_exception();
+      }
+      finished++;
+    }
+
+    if (finished == 0)
+      return;
+    std::lock_guard lock(state->mtx);
+    if (error && !state->error)
+      state->error = error;
+    state->done += finished;
+    if (state->done == count)
+      state->cv.notify_all();
+  };
+
+  size_t helpers = std::min(concurrency() - 1, count - 1);
+  for (size_t i = 0; i < helpers; i++)
+    submit(run);
+  run();
+
+  std::unique_lock lock(state->mtx);
+  state->cv.wait(lock, [&] { return state->done == count; });
+  if (state->error)
+    std::rethrow_exception(state->error);
+}
@@ -0,0 +1,51 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads for CPU heavy work like frame statistics.
+//
+// parallel_for() is safe to call from one of the pool's own tasks: the
+// calling thread works through the indices too, so it finishes even if every
+// other thread in the pool is busy.
+class worker_pool_t {
+public:
+  explicit worker_pool_t(size_t thread_count);
+  ~worker_pool_t();
+
+  worker_pool_t(const worker_pool_t &) = delete;
+  worker_pool_t &operator=(const worker_pool_t &) = delete;
+
+  // Runs task on one of the pool threads at some point. Tasks still queued
+  // when the pool is destroyed are dropped.
+  void submit(std::function<void()> task);
+
+  // Calls fn(i) for every i in [0, count) spread across the pool and the
+  // calling thread, returns once they've all finished. If any call throws
+  // the first exception is rethrown here after the rest are done.
+  void parallel_for(size_t count, const std::function<void(size_t)> &fn);
+
+  // Adds threads until there are at least thread_count, never removes any
+  void grow(size_t thread_count);
+
+  // Number of threads that can work on a parallel_for, i.e. the pool plus
+  // the caller
+  size_t concurrency() const;
+
+private:
+  void worker_proc();
+
+  std::vector<std::thread> _threads;
+  mutable std::mutex _pool_mtx;
+  std::condition_variable _pool_cv;
+  std::deque<std::function<void()>> _tasks;
+  bool _stopping;
+};
+
+#endif
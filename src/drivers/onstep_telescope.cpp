@@ -4,12 +4,21 @@
 #include "interfaces/i_alpaca_device.hpp"
 #include "interfaces/i_alpaca_telescope.hpp"
 #include <chrono>
+#include <fmt/ranges.h>
 #include <mutex>
 #include <thread>
 
 namespace onst = onstep_commands;
 namespace onsr = onstep_responses;
 
+namespace {
+// Synchronous slews give up waiting after this
+constexpr std::chrono::minutes slew_timeout{5};
+// OnStep can turn down a tracking change just after it has stopped, it
+// takes it if asked again a moment later
+constexpr std::chrono::milliseconds tracking_retry_delay{2000};
+} // namespace
+
 std::vector<std::string> onstep_telescope::serial_devices() {
   std::vector<std::string> serial_devices{
       "/dev/serial/by-id/usb-Silicon_Labs_CP2102N_USB_to_UART_Bridge_Controller_1adcd4a73f1bef11bcb917764909ffd0-if00-port0"  
@@ -42,29 +51,21 @@ int onstep_telescope::set_connected(bool connected) {
       spdlog::debug("Setting connected to true");
       spdlog::debug("Attempting to open serial device at {0}",
                     _serial_device_path);
-      _serial_port.open(_serial_device_path);
-      _serial_port.set_option(asio::serial_port_base::baud_rate(9600));
-      _serial_port.set_option(asio::serial_port_base::character_size(8));
-      _serial_port.set_option(asio::serial_port_base::flow_control(
-          asio::serial_port_base::flow_control::none));
-      _serial_port.set_option(
-          asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-      _serial_port.set_option(asio::serial_port_base::stop_bits(
-          asio::serial_port_base::stop_bits::one));
-
-      char buf[512] = {0};
-
-      _serial_port.write_some(asio::buffer(onst::cmd_get_status()));
-      _serial_port.read_some(asio::buffer(buf));
-
-      spdlog::debug("mount returned {0}", buf);
+      _serial->open(_serial_device_path, 9600);
+
+      auto status = send_command_to_mount(onst::cmd_get_status());
+      spdlog::debug("mount returned {0}", status);
       _connected = true;
 
       _tracking_enabled = false;
       auto resp = send_command_to_mount(onst::cmd_get_tracking_status());
       if (resp == "1#")
         _tracking_enabled = true;
+      _motion.reset();
+      _motion.set_tracking(_tracking_enabled);
 
+      read_site_from_mount();
+      start_motion_poll();
       return 0;
     } catch (asio::system_error &e) {
       spdlog::error("problem opening serial connection. {0}", e.what());
@@ -77,8 +78,11 @@ int onstep_telescope::set_connected(bool connected) {
   } else {
     try {
       spdlog::debug("Setting connected to false");
-      _serial_port.close();
+      stop_motion_poll();
+      _serial->close();
       _connected = false;
+      // Anyone still waiting on a slew gets let go
+      _motion.reset();
       return 0;
     } catch (asio::system_error &e) {
       spdlog::error("problem closing serial connection {}", e.what());
@@ -95,12 +99,17 @@ int onstep_telescope::set_connected(bool connected) {
 onstep_telescope::onstep_telescope()
     : _parked(false), _connected(false), _guide_rate(.8), _site_longitude(0),
       _site_latitude(0), _site_elevation(0), _aperture_diameter(0),
-      _moving(false), _io_context(1), _serial_port(_io_context),
-      _is_pulse_guiding(false), _ra_target_set(false), _dec_target_set(false){};
+      _moving(false), _slew_settle_time(0),
+      _serial(alpaca_hub_serial::serial_reactor::instance().make_channel()),
+      _is_pulse_guiding(false), _ra_target_set(false), _dec_target_set(false),
+      _position_motion_commands(0), _motion_commands(1),
+      _tracking_rate(drive_rate_enum::sidereal),
+      _does_refraction(false){};
 
 onstep_telescope::~onstep_telescope() {
+  stop_motion_poll();
   spdlog::debug("Closing serial connection");
-  _serial_port.close();
+  _serial->close();
 };
 
 void onstep_telescope::throw_if_not_connected() {
@@ -115,40 +124,126 @@ void onstep_telescope::throw_if_parked() {
                            "Mount is parked");
 }
 
-std::string onstep_telescope::send_command_to_mount(const std::string &cmd,
-                                                     bool read_response,
-                                                     char stop_on_char) {
-  try {
-    spdlog::trace("sending: {} to mount", cmd);
-    std::lock_guard lock(_telescope_mtx);
-    char buf[512] = {0};
-    _serial_port.write_some(asio::buffer(cmd));
-
-    std::string rsp;
-
-    if (read_response) {
-      _io_context.reset();
-
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        rsp += c;
-        if (c == stop_on_char || stop_on_char == '\0' || c == '#') {
-          break;
-        }
-      }
+lx200::mount_link_t onstep_telescope::mount_link() {
+  return {*_serial, _telescope_mtx, onst::descriptors,
+          [this]() { _motion_commands++; }};
+}
+
+std::string onstep_telescope::send_command_to_mount(std::string_view cmd) {
+  return lx200::send_command(mount_link(), cmd);
+}
+
+std::vector<std::string>
+onstep_telescope::send_commands_to_mount(
+    const std::vector<lx200::command_t> &cmds) {
+  return lx200::send_commands(mount_link(), cmds);
+}
+
+void onstep_telescope::start_motion_poll() {
+  stop_motion_poll();
+  std::lock_guard lock(_motion_poll_mtx);
+  _motion_poll_task = alpaca_hub_serial::serial_reactor::instance().schedule(
+      std::bind(&onstep_telescope::motion_poll_proc, this));
+}
+
+void onstep_telescope::stop_motion_poll() {
+  alpaca_hub_serial::polled_task_ptr_t task;
+  {
+    std::lock_guard lock(_motion_poll_mtx);
+    task = std::move(_motion_poll_task);
+  }
+  if (task)
+    task->stop();
+}
+
+void onstep_telescope::wake_motion_poll() {
+  std::lock_guard lock(_motion_poll_mtx);
+  if (_motion_poll_task)
+    _motion_poll_task->wake();
+}
+
+void onstep_telescope::begin_motion(motion_kind_enum kind) {
+  _motion.begin(kind);
+  wake_motion_poll();
+}
+
+std::chrono::milliseconds onstep_telescope::motion_poll_proc() {
+  // Tracking changes that came in mid slew or that the mount turned down
+  if (auto tracking = _motion.take_deferred_tracking())
+    apply_deferred_tracking(*tracking);
+
+  if (_motion.in_motion()) {
+    try {
+      read_motion_status();
+    } catch (std::exception &ex) {
+      spdlog::warn("problem reading mount status: {}", ex.what());
     }
+    return motion_poll_interval;
+  }
 
-    spdlog::trace("mount returned: {}", rsp);
-    return rsp;
+  // Nothing to read until the state machine has a deadline or we're woken
+  auto delay = motion_poll_idle_interval;
+  if (auto deadline = _motion.next_deadline())
+    delay = std::min(delay, std::chrono::ceil<std::chrono::milliseconds>(
+                                *deadline - std::chrono::steady_clock::now()));
+  return std::max(delay, std::chrono::milliseconds(0));
+}
 
-  } catch (std::exception &ex) {
-    throw alpaca_exception(
-        alpaca_exception::DRIVER_ERROR,
-        fmt::format("Problem sending command to mount: ", ex.what()));
+// 4 is moving status, 2 is slewing to home or park
+bool onstep_telescope::read_motion_status() {
+  auto started = std::chrono::steady_clock::now();
+  auto resp = send_command_to_mount(onst::cmd_get_status());
+  bool moving = false;
+  if (resp.size() >= 2) {
+    auto last_2_chars = resp.substr(resp.size() - 2);
+    moving = last_2_chars == "4#" || last_2_chars == "2#";
+  }
+  spdlog::trace("status: {} moving: {}", resp, moving);
+  _motion.observe(started, moving);
+  return moving;
+}
+
+astrometry::equatorial_t onstep_telescope::position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_position_mtx);
+  auto now = std::chrono::steady_clock::now();
+  uint64_t motion_commands = _motion_commands;
+  if (_moving || _motion.in_motion() ||
+      _position_motion_commands != motion_commands ||
+      now - _position_read_at > position_max_age) {
+    // The ASCOM driver follows every :GR# and :GD# with these
+    auto resps = send_commands_to_mount(
+        {onst::cmd_get_current_ra(), onst::cmd_ascom_ra_followup(),
+         onst::cmd_get_current_dec(), onst::cmd_ascom_dec_followup()});
+    _position.right_ascension =
+        onsr::parse_hh_mm_ss_response(resps[0]).as_decimal();
+    _position.declination =
+        onsr::parse_sdd_mm_ss_response(resps[2]).as_decimal();
+    _position_read_at = now;
+    _position_motion_commands = motion_commands;
+    return _position;
   }
+  return astrometry::extrapolate(_position, now - _position_read_at,
+                                 _tracking_enabled, _tracking_rate);
+}
+
+astrometry::site_t onstep_telescope::site() {
+  astrometry::site_t site;
+  site.latitude = _site_latitude;
+  site.longitude = _site_longitude;
+  site.refraction = _does_refraction;
+  return site;
+}
+
+// The site only changes through set_site_latitude / set_site_longitude so it's
+// read once here rather than every time someone asks
+void onstep_telescope::read_site_from_mount() {
+  auto site = lx200::read_site(mount_link());
+  _site_latitude = site.latitude;
+  _site_longitude = site.longitude;
+  _tracking_rate = site.tracking_rate;
+  spdlog::debug("mount site is latitude: {} longitude: {}", _site_latitude,
+                _site_longitude);
 }
 
 uint32_t onstep_telescope::interface_version() { return 3; }
@@ -178,12 +273,8 @@ alignment_mode_enum onstep_telescope::alignment_mode() {
 }
 
 double onstep_telescope::altitude() {
-  throw_if_not_connected();
-
-  std::string resp = send_command_to_mount(onst::cmd_get_altitude());
-  onsr::sdd_mm_ss result = onsr::parse_sdd_mm_ss_response(resp);
-
-  return result.as_decimal();
+  auto lst = sidereal_time();
+  return astrometry::to_horizontal(position(), lst, site()).altitude;
 }
 
 double onstep_telescope::aperture_diameter() { return _aperture_diameter; }
@@ -200,20 +291,17 @@ double onstep_telescope::aperture_area() {
   return 0;
 }
 
-// I'm wondering if I need to implement a state machine
-// to store / set states around movement...
+// Includes the settle time after a goto, as ASCOM wants
 bool onstep_telescope::slewing() {
   if (_moving)
     return true;
-  auto resp = send_command_to_mount(onst::cmd_get_status());
-  auto last_2_chars = resp.substr(resp.size() - 2, resp.size());
-  // 4 is moving status
-  if (last_2_chars.find("4#") != std::string::npos ||
-      last_2_chars.find("2#") != std::string::npos)
+  if (_motion.in_motion())
     return true;
-  spdlog::trace("last_2_chars: {}", last_2_chars);
-  spdlog::trace("resp: {}", resp);
-  return false;
+  // The poll only runs once something is moving, so look for the mount
+  // having been moved without us
+  if (read_motion_status())
+    wake_motion_poll();
+  return _motion.in_motion();
 }
 
 bool onstep_telescope::at_home() {
@@ -232,11 +320,8 @@ bool onstep_telescope::at_park() {
 
 // TODO: implement
 double onstep_telescope::azimuth() {
-  throw_if_not_connected();
-  std::string resp = send_command_to_mount(onst::cmd_get_azimuth());
-  spdlog::trace("raw value returned from mount for cmd_get_azimuth(): {0}",
-                resp);
-  return onsr::parse_ddd_mm_ss_response(resp).as_decimal();
+  auto lst = sidereal_time();
+  return astrometry::to_horizontal(position(), lst, site()).azimuth;
 }
 
 // AM5 supports finding home
@@ -333,16 +418,7 @@ bool onstep_telescope::can_unpark() {
   return true;
 }
 
-double onstep_telescope::declination() {
-  throw_if_not_connected();
-  std::string resp = send_command_to_mount(onst::cmd_get_current_dec());
-  spdlog::trace("declination returned: {0}", resp);
-  auto parsed_resp = onsr::parse_sdd_mm_ss_response(resp);
-  // The ASCOM driver does this every time it calls :GD#
-  send_command_to_mount(":GFD1#");
-
-  return parsed_resp.as_decimal();
-}
+double onstep_telescope::declination() { return position().declination; }
 
 // Returning 0 because we aren't supporting setting a dec rate
 double onstep_telescope::declination_rate() {
@@ -358,15 +434,16 @@ int onstep_telescope::set_declination_rate(const double &) {
   return 0;
 }
 
+// Only affects the altitudes we work out ourselves, the mount's own
+// refraction tracking is separate
 bool onstep_telescope::does_refraction() {
   throw_if_not_connected();
-  return false;
+  return _does_refraction;
 }
 
-int onstep_telescope::set_does_refraction(bool) {
+int onstep_telescope::set_does_refraction(bool does_refraction) {
   throw_if_not_connected();
-  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
-                         "Setting refraction not supported");
+  _does_refraction = does_refraction;
   return 0;
 }
 
@@ -399,7 +476,7 @@ int onstep_telescope::set_guide_rate_declination(const double &rate) {
   throw_if_not_connected();
   spdlog::debug("set_guide_rate_declination called with {} converted to {}",
                 rate, rate / .0042);
-  send_command_to_mount(onst::cmd_set_guide_rate(rate / .0042), false);
+  send_command_to_mount(onst::cmd_set_guide_rate(rate / .0042));
   return 0;
 }
 
@@ -419,14 +496,7 @@ bool onstep_telescope::is_pulse_guiding() {
 }
 
 double onstep_telescope::right_ascension() {
-  throw_if_not_connected();
-  spdlog::trace("right_ascension() invoked");
-  std::string resp = send_command_to_mount(onst::cmd_get_current_ra());
-  spdlog::trace("ra returned: {0}", resp);
-  auto parsed_resp = onsr::parse_hh_mm_ss_response(resp);
-  // The ASCOM driver does this every time it calls :GR#
-  send_command_to_mount(":GFR1#");
-  return parsed_resp.as_decimal();
+  return position().right_ascension;
 }
 
 // I believe this is just 0 as I don't believe the AM5 supports a
@@ -444,8 +514,11 @@ int onstep_telescope::set_right_ascension_rate(const double &) {
 pier_side_enum onstep_telescope::side_of_pier() {
   throw_if_not_connected();
   spdlog::trace("side_of_pier invoked");
-  std::string resp =
-      send_command_to_mount(onst::cmd_get_current_cardinal_direction());
+  return pier_side_from(
+      send_command_to_mount(onst::cmd_get_current_cardinal_direction()));
+}
+
+pier_side_enum onstep_telescope::pier_side_from(const std::string &resp) {
   spdlog::trace("cmd_get_current_cardinal_direction() returned {0}", resp);
   if (resp.find("W"))
     return pier_side_enum::west;
@@ -462,9 +535,8 @@ int onstep_telescope::set_side_of_pier(const pier_side_enum &) {
 
 double onstep_telescope::sidereal_time() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(onst::cmd_get_sidereal_time());
-  auto sidereal_data = onsr::parse_hh_mm_ss_response(resp);
-  return sidereal_data.as_decimal();
+  return astrometry::local_sidereal_time(std::chrono::system_clock::now(),
+                                         _site_longitude);
 }
 
 double onstep_telescope::site_elevation() {
@@ -484,10 +556,7 @@ int onstep_telescope::set_site_elevation(const double &site_elevation) {
 
 double onstep_telescope::site_latitude() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(onst::cmd_get_latitude());
-  auto parsed_resp = onsr::parse_sdd_mm_ss_response(resp);
-  spdlog::debug("returning site_latitude: {}", parsed_resp.as_decimal());
-  return parsed_resp.as_decimal();
+  return _site_latitude;
 }
 
 // TODO: add some validation
@@ -502,25 +571,14 @@ int onstep_telescope::set_site_latitude(const double &site_latitude) {
   spdlog::debug(" converts to {}", latitude_s);
   auto resp = send_command_to_mount(
       onst::cmd_set_latitude(latitude_s.plus_or_minus, latitude_s.dd,
-                             latitude_s.mm, latitude_s.ss),
-      true, '\0');
+                             latitude_s.mm, latitude_s.ss));
   _site_latitude = site_latitude;
   return 0;
 }
 
 double onstep_telescope::site_longitude() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(onst::cmd_get_longitude());
-  auto parsed_resp = onsr::parse_sddd_mm_ss_response(resp);
-
-  // This is a weird behavior from the ASCOM driver I'm mimicking
-  if (parsed_resp.plus_or_minus == '+')
-    parsed_resp.plus_or_minus = '-';
-  else
-    parsed_resp.plus_or_minus = '+';
-  spdlog::debug("returning site_longitude: {}", parsed_resp.as_decimal());
-
-  return parsed_resp.as_decimal();
+  return _site_longitude;
 }
 
 // TODO: add some validation
@@ -540,8 +598,7 @@ int onstep_telescope::set_site_longitude(const double &site_longitude) {
     longitude_s.plus_or_minus = '+';
   auto resp = send_command_to_mount(
       onst::cmd_set_longitude(longitude_s.plus_or_minus, longitude_s.ddd,
-                              longitude_s.mm, longitude_s.ss),
-      true, '\0');
+                              longitude_s.mm, longitude_s.ss));
 
   _site_longitude = site_longitude;
   return 0;
@@ -559,6 +616,9 @@ int onstep_telescope::set_slew_settle_time(const int &slew_settle_time) {
     throw alpaca_exception(alpaca_exception::INVALID_VALUE,
                            "slew settle time must be a positive value");
   _slew_settle_time = slew_settle_time;
+  auto config = _motion.config();
+  config.settle_time = std::chrono::seconds(slew_settle_time);
+  _motion.configure(config);
   return 0;
 }
 
@@ -580,8 +640,7 @@ int onstep_telescope::set_target_declination(const double &dec) {
   onsr::sdd_mm_ss converted(dec);
   auto resp = send_command_to_mount(
       onst::cmd_set_target_dec(converted.plus_or_minus, converted.dd,
-                               converted.mm, converted.ss),
-      true, '\0');
+                               converted.mm, converted.ss));
   if (resp == "1") {
     _dec_target_set = true;
     return 0;
@@ -608,8 +667,7 @@ int onstep_telescope::set_target_right_ascension(const double &ra) {
   throw_if_not_connected();
   onsr::hh_mm_ss converted(ra);
   auto resp = send_command_to_mount(
-      onst::cmd_set_target_ra(converted.hh, converted.mm, converted.ss), true,
-      '\0');
+      onst::cmd_set_target_ra(converted.hh, converted.mm, converted.ss));
   if (resp == "1") {
     _ra_target_set = true;
     return 0;
@@ -637,105 +695,90 @@ bool onstep_telescope::tracking() {
   // return false;
 }
 
-int onstep_telescope::set_tracking(const bool &tracking) {
-  using namespace std::chrono_literals;
-  int val = 0;
+bool onstep_telescope::send_tracking(bool tracking) {
   std::string resp;
-  throw_if_not_connected();
-  spdlog::debug("set_tracking invoked with {}", tracking);
   if (tracking)
-    resp = send_command_to_mount(onst::cmd_start_tracking(), true, '\0');
+    resp = send_command_to_mount(onst::cmd_start_tracking());
   else
-    resp = send_command_to_mount(onst::cmd_stop_tracking(), true, '\0');
-  if (resp == "1") {
-    _tracking_enabled = tracking;
-    return 0;
-  } else {
+    resp = send_command_to_mount(onst::cmd_stop_tracking());
+  if (resp != "1") {
     auto gat_resp = send_command_to_mount(onst::cmd_get_tracking_status());
     spdlog::warn("failed to set tracking status to {}, error: {}", tracking,
                  gat_resp);
-    if (gat_resp == "1#" && tracking) {
-      spdlog::info("ignore warning, mount is tracking.");
-      _tracking_enabled = tracking;
-      return 0;
-    }
+    if (gat_resp != (tracking ? "1#" : "0#"))
+      return false;
+    spdlog::info("ignore warning, mount is {}",
+                 tracking ? "tracking." : "not tracking.");
+  }
+  _tracking_enabled = tracking;
+  _motion.set_tracking(tracking);
+  return true;
+}
 
-    if (gat_resp == "0#" && !tracking) {
-      spdlog::info("ignore warning, mount is not tracking.");
-      _tracking_enabled = tracking;
-      return 0;
-    }
+// Returns straight away. A moving mount turns tracking changes down, so
+// they wait in the motion state machine until it has settled and the motion
+// poll sends them then. The same goes for the retry when the mount refuses
+// one just after it has stopped.
+int onstep_telescope::set_tracking(const bool &tracking) {
+  throw_if_not_connected();
+  spdlog::debug("set_tracking invoked with {}", tracking);
+  bool moving = _motion.in_motion();
+  if (!moving && send_tracking(tracking))
+    return 0;
 
-    if (gat_resp == "0#" && tracking) {
-      spdlog::debug("is mount moving? {}", slewing());
-      spdlog::debug("waiting 2000ms and retrying tracking");
-      std::this_thread::sleep_for(2000ms);
-      resp = send_command_to_mount(onst::cmd_start_tracking(), true, '\0');
-      if (resp == "1") {
-        spdlog::info("ignore previous warning, tracking retry successful");
-        _tracking_enabled = tracking;
-        return 0;
-      } else {
-        gat_resp = send_command_to_mount(onst::cmd_get_tracking_status());
-        if (gat_resp == "1#") {
-          spdlog::info("ignore previous warning");
-          _tracking_enabled = tracking;
-          return 0;
-        }
-        spdlog::warn("tracking retry failed: {}", resp);
-      }
-    }
+  spdlog::debug("tracking {} will be set once the mount is at rest",
+                tracking);
+  // Reads back as asked for in the meantime, if the retry fails it gets put
+  // back
+  _tracking_enabled = tracking;
+  _motion.set_tracking(tracking);
+  _motion.defer_tracking(tracking, moving ? std::chrono::milliseconds(0)
+                                          : tracking_retry_delay);
+  wake_motion_poll();
+  return 0;
+}
 
-    if (gat_resp == "1#" && !tracking) {
-      spdlog::debug("is mount moving? {}", slewing());
-      spdlog::debug("waiting 2000ms and retrying tracking");
-      std::this_thread::sleep_for(2000ms);
-      resp = send_command_to_mount(onst::cmd_stop_tracking(), true, '\0');
-      if (resp == "1") {
-        spdlog::info("ignore previous warning, tracking retry successful");
-        _tracking_enabled = tracking;
-        return 0;
-      } else {
-        gat_resp = send_command_to_mount(onst::cmd_get_tracking_status());
-        if (gat_resp == "0#") {
-          spdlog::info("ignore previous warning");
-          _tracking_enabled = tracking;
-          return 0;
-        }
-        spdlog::warn("tracking retry failed: {}", resp);
-      }
+// Runs on the motion poll task
+void onstep_telescope::apply_deferred_tracking(bool tracking) {
+  try {
+    if (send_tracking(tracking)) {
+      spdlog::info("ignore previous warning, tracking retry successful");
+      return;
     }
-
-    throw alpaca_exception(
-        alpaca_exception::DRIVER_ERROR,
-        fmt::format("Failed to set tracking status: to {}, error: {}", tracking,
-                    gat_resp));
+    spdlog::warn("tracking retry failed, mount is still {}",
+                 tracking ? "not tracking" : "tracking");
+    _tracking_enabled = !tracking;
+    _motion.set_tracking(!tracking);
+  } catch (std::exception &ex) {
+    spdlog::warn("tracking retry failed: {}", ex.what());
   }
-  return -1;
 }
 
 drive_rate_enum onstep_telescope::tracking_rate() {
   auto resp = send_command_to_mount(onst::cmd_get_tracking_rate());
-  return static_cast<drive_rate_enum>(onsr::parse_standard_response(resp));
+  _tracking_rate =
+      static_cast<drive_rate_enum>(onsr::parse_standard_response(resp));
+  return _tracking_rate;
 }
 
 int onstep_telescope::set_tracking_rate(const drive_rate_enum &tracking_rate) {
   throw_if_not_connected();
   switch (tracking_rate) {
   case drive_rate_enum::sidereal:
-    send_command_to_mount(onst::cmd_set_tracking_rate_to_sidereal(), false);
+    send_command_to_mount(onst::cmd_set_tracking_rate_to_sidereal());
     break;
   case drive_rate_enum::solar:
-    send_command_to_mount(onst::cmd_set_tracking_rate_to_solar(), false);
+    send_command_to_mount(onst::cmd_set_tracking_rate_to_solar());
     break;
   case drive_rate_enum::lunar:
-    send_command_to_mount(onst::cmd_set_tracking_rate_to_lunar(), false);
+    send_command_to_mount(onst::cmd_set_tracking_rate_to_lunar());
     break;
   default:
     throw alpaca_exception(
         alpaca_exception::INVALID_VALUE,
         fmt::format("Unsupported tracking rate: {}", tracking_rate));
   }
+  _tracking_rate = tracking_rate;
   return 0;
 }
 
@@ -755,18 +798,23 @@ std::string onstep_telescope::utc_date() {
 //   auto raw_resp_t = send_command_to_mount(onst::cmd_get_date_and_time_and_tz());
 //   spdlog::trace("raw data from scope: {}", raw_resp_t);
 
-  auto tz_resp = send_command_to_mount(onst::cmd_get_timezone());
-  onsr::shh_mm tz_data = onsr::parse_shh_mm_response(tz_resp);
+  // One write for all three instead of three round trips
+  auto resps =
+      send_commands_to_mount({onst::cmd_get_timezone(), onst::cmd_get_date(),
+                              onst::cmd_get_time()});
+  onsr::shh_mm tz_data = onsr::parse_shh_mm_response(resps[0]);
 
 //   auto dst_resp = send_command_to_mount(onst::cmd_get_daylight_savings());
 //   int d_savings = onsr::parse_standard_response(dst_resp);
 
 //   spdlog::trace("mount believes daylight savings is: {}", d_savings);
 
-  auto date_resp = send_command_to_mount(onst::cmd_get_date());
-  onsr::mm_dd_yy date_data = onsr::parse_mm_dd_yy_response(date_resp);
+  return utc_date_from(resps[1], resps[2]);
+}
 
-  auto time_resp = send_command_to_mount(onst::cmd_get_time());
+std::string onstep_telescope::utc_date_from(const std::string &date_resp,
+                                            const std::string &time_resp) {
+  onsr::mm_dd_yy date_data = onsr::parse_mm_dd_yy_response(date_resp);
   onsr::hh_mm_ss time_data = onsr::parse_hh_mm_ss_response(time_resp);
 
   // This particular section is using the older time / date stuff
@@ -826,7 +874,7 @@ int onstep_telescope::set_utc_date(const std::string &utc_date_str) {
   }
 
   // Set DST to 0
-  send_command_to_mount(onst::cmd_set_daylight_savings(0), true, '\0');
+  send_command_to_mount(onst::cmd_set_daylight_savings(0));
 
   spdlog::debug("calculated offset: {}", offset_minutes);
 
@@ -865,19 +913,17 @@ int onstep_telescope::set_utc_date(const std::string &utc_date_str) {
     tz_mm = 30;
 
   auto resp = send_command_to_mount(
-      onst::cmd_set_timezone(plus_or_minus_tz, tz_hh), true, '\0');
+      onst::cmd_set_timezone(plus_or_minus_tz, tz_hh));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting date with driver");
 
-  resp = send_command_to_mount(onst::cmd_set_date(date_mm, date_dd, date_yy),
-                               true, '\0');
+  resp = send_command_to_mount(onst::cmd_set_date(date_mm, date_dd, date_yy));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting date with driver");
 
-  resp = send_command_to_mount(onst::cmd_set_time(time_hh, time_mm, time_ss),
-                               true, '\0');
+  resp = send_command_to_mount(onst::cmd_set_time(time_hh, time_mm, time_ss));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting time with driver");
@@ -895,7 +941,8 @@ int onstep_telescope::abort_slew() {
   throw_if_not_connected();
   throw_if_parked();
   spdlog::debug("abort_slew() invoked");
-  send_command_to_mount(onst::cmd_stop_moving(), false);
+  send_command_to_mount(onst::cmd_stop_moving());
+  _motion.abort();
   return 0;
 }
 
@@ -923,61 +970,23 @@ bool onstep_telescope::can_move_axis(const telescope_axes_enum &axis) {
   return false;
 }
 
-// TODO: perhaps consider implementing this. I think I would have to
-// make a guess based on target RA / DEC
+// A guess from the target's hour angle, the mount's meridian limits could
+// still have it track past the meridian on the other side
 pier_side_enum onstep_telescope::destination_side_of_pier(const double &ra,
                                                            const double &dec) {
   throw_if_not_connected();
-  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
-                         "This is not currently implemented");
-  return pier_side_enum::unknown;
+  return astrometry::destination_side_of_pier({ra, dec}, sidereal_time());
 }
 
-// TODO: potentially encapsulate the execution of the telescope command
-// in here
-class blocking_telescope_command {
-  asio::io_context _io_ctx;
-  asio::steady_timer _t;
-  onstep_telescope &_telescope;
-  bool _is_done_moving;
-
-public:
-  blocking_telescope_command(onstep_telescope &telescope)
-      : _t(_io_ctx), _telescope(telescope), _is_done_moving(false) {}
-
-  void check_is_slewing() {
-    using namespace std::chrono_literals;
-    _t.expires_from_now(100ms);
-    if (_telescope.slewing()) {
-      _t.expires_from_now(100ms);
-    } else {
-      _is_done_moving = true;
-      _t.cancel();
-    }
-  }
-
-  bool is_still_moving() {
-    using namespace std::chrono_literals;
-    _io_ctx.reset();
-    _t.async_wait(
-        std::bind(&blocking_telescope_command::check_is_slewing, this));
-    _t.expires_from_now(100ms);
-    _io_ctx.run();
-    return !_is_done_moving;
-  }
-
-  void run() {
-    while (is_still_moving())
-      ;
-  }
-};
-
-// block until not moving
+// Synchronous slews wait here. The motion poll reads the mount while it's
+// moving and the state machine wakes us once it has stopped and the settle
+// time is up, or the slew is aborted.
 void onstep_telescope::block_while_moving() {
-  using namespace std::chrono_literals;
   spdlog::trace("block_while_moving invoked");
-  blocking_telescope_command cmd(*this);
-  cmd.run();
+  if (!_motion.wait_until_settled(slew_timeout))
+    throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                           "timed out waiting for the mount to stop slewing");
+  throw_if_not_connected();
 }
 
 int onstep_telescope::find_home() {
@@ -985,10 +994,9 @@ int onstep_telescope::find_home() {
   throw_if_not_connected();
   throw_if_parked();
   spdlog::debug("find_home invoked");
-  send_command_to_mount(onst::cmd_home_position(), false);
-  // block_while_moving();
-  // spdlog::debug("initial timer has ended");
-  // block_while_moving();
+  send_command_to_mount(onst::cmd_home_position());
+  // Slewing and AtHome follow it from here
+  begin_motion(motion_kind_enum::home);
   return 0;
 }
 
@@ -1016,30 +1024,30 @@ int onstep_telescope::move_axis(const telescope_axes_enum &axis,
   case telescope_axes_enum::primary:
     set_is_moving(true);
     send_command_to_mount(
-        onst::cmd_set_moving_speed_precise(std::abs(rate) / .0042), false);
+        onst::cmd_set_moving_speed_precise(std::abs(rate) / .0042));
     if (rate > 0)
-      send_command_to_mount(onst::cmd_move_towards_east(), false);
+      send_command_to_mount(onst::cmd_move_towards_east());
     else if (rate < 0)
-      send_command_to_mount(onst::cmd_move_towards_west(), false);
+      send_command_to_mount(onst::cmd_move_towards_west());
     else {
       set_is_moving(false);
-      send_command_to_mount(onst::cmd_stop_moving_towards_east(), false);
-      send_command_to_mount(onst::cmd_stop_moving_towards_west(), false);
+      send_command_to_mount(onst::cmd_stop_moving_towards_east());
+      send_command_to_mount(onst::cmd_stop_moving_towards_west());
     }
     break;
   // Dec
   case telescope_axes_enum::secondary:
     set_is_moving(true);
     send_command_to_mount(
-        onst::cmd_set_moving_speed_precise(std::abs(rate) / .0042), false);
+        onst::cmd_set_moving_speed_precise(std::abs(rate) / .0042));
     if (rate > 0)
-      send_command_to_mount(onst::cmd_move_towards_north(), false);
+      send_command_to_mount(onst::cmd_move_towards_north());
     else if (rate < 0)
-      send_command_to_mount(onst::cmd_move_towards_south(), false);
+      send_command_to_mount(onst::cmd_move_towards_south());
     else {
       set_is_moving(false);
-      send_command_to_mount(onst::cmd_stop_moving_towards_south(), false);
-      send_command_to_mount(onst::cmd_stop_moving_towards_north(), false);
+      send_command_to_mount(onst::cmd_stop_moving_towards_south());
+      send_command_to_mount(onst::cmd_stop_moving_towards_north());
     }
     break;
   default:
@@ -1061,11 +1069,12 @@ int onstep_telescope::park() {
     return 0;
 
   spdlog::trace("sending cmd_park()");
-  // send_command_to_mount(zwoc::cmd_park(), false);
+  // send_command_to_mount(zwoc::cmd_park());
   spdlog::trace("waiting for mount to park");
   // std::this_thread::sleep_for(30s);  spdlog::debug("blocking while moving");
   // block_while_moving();
   _parked = true;
+  _motion.set_parked(true);
   return 0;
 }
 
@@ -1100,13 +1109,13 @@ void onstep_telescope::pulse_guide_proc(int duration_ms,
     spdlog::debug("issuing multiple guide commands");
     for (int i = 0; i < count; i++) {
       spdlog::debug("guiding {}/{}", i + 1, count);
-      send_command_to_mount(onst::cmd_guide(cardinal_direction, 3000), false);
+      send_command_to_mount(onst::cmd_guide(cardinal_direction, 3000));
       std::this_thread::sleep_for(std::chrono::milliseconds(3000));
     }
   }
 
   send_command_to_mount(
-      onst::cmd_guide(cardinal_direction, remaining_duration_ms), false);
+      onst::cmd_guide(cardinal_direction, remaining_duration_ms));
   spdlog::debug("sleeping for {}", remaining_duration_ms);
 
   std::this_thread::sleep_for(std::chrono::milliseconds(remaining_duration_ms));
@@ -1135,28 +1144,28 @@ void onstep_telescope::pulse_guide_proc_using_move(int duration_ms,
 
   auto pulse_duration_ms = std::chrono::milliseconds((duration_ms * 10) / 15);
 
-  send_command_to_mount(onst::cmd_set_0_5x_sidereal_rate(), false);
+  send_command_to_mount(onst::cmd_set_0_5x_sidereal_rate());
 
   switch (cardinal_direction) {
   case 'e':
-    send_command_to_mount(onst::cmd_move_towards_east(), false);
+    send_command_to_mount(onst::cmd_move_towards_east());
     std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(onst::cmd_stop_moving_towards_east(), false);
+    send_command_to_mount(onst::cmd_stop_moving_towards_east());
     break;
   case 'w':
-    send_command_to_mount(onst::cmd_move_towards_west(), false);
+    send_command_to_mount(onst::cmd_move_towards_west());
     std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(onst::cmd_stop_moving_towards_west(), false);
+    send_command_to_mount(onst::cmd_stop_moving_towards_west());
     break;
   case 'n':
-    send_command_to_mount(onst::cmd_move_towards_north(), false);
+    send_command_to_mount(onst::cmd_move_towards_north());
     std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(onst::cmd_stop_moving_towards_north(), false);
+    send_command_to_mount(onst::cmd_stop_moving_towards_north());
     break;
   case 's':
-    send_command_to_mount(onst::cmd_move_towards_south(), false);
+    send_command_to_mount(onst::cmd_move_towards_south());
     std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(onst::cmd_stop_moving_towards_south(), false);
+    send_command_to_mount(onst::cmd_stop_moving_towards_south());
     break;
   default:
     _is_pulse_guiding = false;
@@ -1256,10 +1265,10 @@ int onstep_telescope::slew_to_coordinates(const double &ra,
   onsr::sdd_mm_ss converted_dec(dec);
 
   auto resp = send_command_to_mount(
-      onst::cmd_goto(),
-      true, '0');
+      onst::cmd_goto());
 
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     block_while_moving();
     return 0;
   } else {
@@ -1293,10 +1302,10 @@ int onstep_telescope::slew_to_coordinates_async(const double &ra,
                            "Tracking is not enabled");
 
   auto resp = send_command_to_mount(
-      onst::cmd_goto(),
-      true, '0');
+      onst::cmd_goto());
 
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     return 0;
   } else {
     spdlog::warn("error returned from mount on slew_to_coordinates_async: {}",
@@ -1314,8 +1323,9 @@ int onstep_telescope::slew_to_target() {
     throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
                            "RA and DEC target must be set");
   spdlog::debug("slew_to_target invoked");
-  auto resp = send_command_to_mount(onst::cmd_goto(), true, '0');
+  auto resp = send_command_to_mount(onst::cmd_goto());
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     block_while_moving();
     return 0;
   } else {
@@ -1332,12 +1342,13 @@ int onstep_telescope::slew_to_target_async() {
     throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
                            "RA and DEC target must be set");
   spdlog::debug("slew_to_target_async invoked");
-  auto resp = send_command_to_mount(onst::cmd_goto(), true, '0');
-  if (resp == "0")
+  auto resp = send_command_to_mount(onst::cmd_goto());
+  if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     return 0;
-  else
-    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
-                           fmt::format("goto failed. {}", resp));
+  }
+  throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                         fmt::format("goto failed. {}", resp));
 }
 
 // TODO: Check if Onstep supports this
@@ -1361,7 +1372,7 @@ int onstep_telescope::sync_to_coordinates(const double &ra,
   _ra_target_set = true;
   _dec_target_set = true;
 
-  auto resp = send_command_to_mount(onst::cmd_sync(), true);
+  auto resp = send_command_to_mount(onst::cmd_sync());
 
   if (resp == "N/A#")
     return 0;
@@ -1379,7 +1390,7 @@ int onstep_telescope::sync_to_target() {
     throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
                            "RA and DEC target must be set");
   spdlog::debug("sync_to_target invoked");
-  auto resp = send_command_to_mount(onst::cmd_sync(), true);
+  auto resp = send_command_to_mount(onst::cmd_sync());
   // Need to interpret response
   if (resp == "N/A#")
     return 0;
@@ -1393,12 +1404,15 @@ int onstep_telescope::sync_to_target() {
 int onstep_telescope::unpark() {
   throw_if_not_connected();
   // Move scope back to home position on unpark
-  // send_command_to_mount(zwo_commands::cmd_home_position(), false);
+  // send_command_to_mount(zwo_commands::cmd_home_position());
   // block_while_moving();
-  auto resp = send_command_to_mount(onst::cmd_restore_parked_telescope(), true, '0');
+  auto resp = send_command_to_mount(onst::cmd_restore_parked_telescope());
   if (resp == "0") {
-    block_while_moving();
     _parked = false;
+    _motion.set_parked(false);
+    // Slewing follows it out of the park position rather than holding up
+    // the request
+    begin_motion(motion_kind_enum::slew);
     return 0;
   } else {
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
@@ -1420,7 +1434,7 @@ std::string onstep_telescope::get_serial_device_path() {
 
 std::string onstep_telescope::get_serial_number() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(":GMA#");
+  auto resp = send_command_to_mount(onst::cmd_get_serial_number());
   return resp.substr(0, resp.size() - 1);
 }
 
@@ -1431,22 +1445,33 @@ onstep_telescope::details() {
   detail_map["Serial Device"] = _serial_device_path;
   if (_connected) {
     // try {
-      detail_map["UTCDate"] = utc_date();
-      detail_map["RightAscension"] = right_ascension();
-      detail_map["Declination"] = declination();
-      detail_map["Azimuth"] = azimuth();
-      detail_map["Altitude"] = altitude();
+      // Alt / az and sidereal time are worked out here, the rest goes in one
+      // sweep instead of a round trip per property
+      auto resps = send_commands_to_mount(
+          {onst::cmd_get_date(), onst::cmd_get_time(),
+           onst::cmd_get_current_cardinal_direction()});
+      auto equatorial = position();
+      auto lst = sidereal_time();
+      auto horizontal = astrometry::to_horizontal(equatorial, lst, site());
+      detail_map["UTCDate"] = utc_date_from(resps[0], resps[1]);
+      detail_map["RightAscension"] = equatorial.right_ascension;
+      detail_map["Declination"] = equatorial.declination;
+      detail_map["Azimuth"] = horizontal.azimuth;
+      detail_map["Altitude"] = horizontal.altitude;
       detail_map["SiteLatitude"] = _site_latitude;
       detail_map["SiteLongitude"] = _site_longitude;
       detail_map["SiteElevation"] = _site_elevation;
-      detail_map["SiderealTime"] = sidereal_time();
-      detail_map["SideOfPier"] = side_of_pier();
+      detail_map["SiderealTime"] = lst;
+      detail_map["SideOfPier"] = pier_side_from(resps[2]);
       detail_map["Tracking"] = _tracking_enabled;
-      detail_map["Slewing"] = _moving;
+      detail_map["Slewing"] = _moving || _motion.in_motion();
+      detail_map["MotionState"] = motion_state_name(_motion.state());
     // } catch (alpaca_exception &e) {
     //   spdlog::warn("problem fetching details: ", e.what());
     // }
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
+  detail_map["Motion"] = _motion.summary();
 
   return detail_map;
 };
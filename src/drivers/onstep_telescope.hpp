@@ -6,6 +6,10 @@
 #include "asio/serial_port.hpp"
 #include "common/alpaca_exception.hpp"
 #include "common/alpaca_hub_serial.hpp"
+#include "common/astrometry.hpp"
+#include "common/lx200_mount_link.hpp"
+#include "common/motion_state_machine.hpp"
+#include "common/serial_reactor.hpp"
 #include "date/date.h"
 #include "date/tz.h"
 #include "fmt/chrono.h"
@@ -14,7 +18,9 @@
 #include "spdlog/spdlog.h"
 #include <asio/steady_timer.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <ctime>
 #include <functional>
@@ -138,27 +144,69 @@ public:
   int set_serial_device(const std::string &);
   std::string get_serial_device_path();
 
-  std::string send_command_to_mount(const std::string &cmd,
-                                    bool read_response = true,
-                                    char stop_on_char = '#');
+  std::string send_command_to_mount(std::string_view cmd);
+  // Pipelines cmds and returns one reply per command, in the same order
+  std::vector<std::string>
+  send_commands_to_mount(const std::vector<lx200::command_t> &cmds);
 
   std::string get_serial_number();
 private:
-  asio::io_context _io_ctx;
+  std::string utc_date_from(const std::string &date_resp,
+                            const std::string &time_resp);
+  pier_side_enum pier_side_from(const std::string &resp);
+
+  // Where the mount is pointing now. The last read is carried forward until
+  // it's older than position_max_age or a motion command has gone out since.
+  astrometry::equatorial_t position();
+  astrometry::site_t site();
+  void read_site_from_mount();
+  // What send_command_to_mount and friends go through
+  lx200::mount_link_t mount_link();
+
+  static constexpr std::chrono::milliseconds position_max_age{1000};
+  std::mutex _position_mtx;
+  astrometry::equatorial_t _position;
+  std::chrono::steady_clock::time_point _position_read_at;
+  // _motion_commands when _position was read, it's stale once they differ
+  uint64_t _position_motion_commands;
+  std::atomic<uint64_t> _motion_commands;
+
+  // OnStep has no telemetry loop, this reads the mount for the motion state
+  // machine while it says the mount is moving and sends deferred tracking
+  // changes. It's a polled task on the serial reactor that does nothing
+  // the rest of the time.
+  void start_motion_poll();
+  void stop_motion_poll();
+  std::chrono::milliseconds motion_poll_proc();
+  // Lets the poller know the state machine has something new for it
+  void wake_motion_poll();
+  void begin_motion(motion_kind_enum kind);
+  // Reads :GU# and tells the state machine, true if the mount is moving
+  bool read_motion_status();
+  // true if the mount ended up with tracking as asked
+  bool send_tracking(bool tracking);
+  void apply_deferred_tracking(bool tracking);
+
+  static constexpr std::chrono::milliseconds motion_poll_interval{250};
+  // Only a backstop, anything that gives the poll work wakes it
+  static constexpr std::chrono::milliseconds motion_poll_idle_interval{60000};
+  // Guards _motion_poll_task
+  std::mutex _motion_poll_mtx;
+  alpaca_hub_serial::polled_task_ptr_t _motion_poll_task;
+  motion_state_machine_t _motion;
+
   std::mutex _telescope_mtx;
   std::mutex _moving_mtx;
   std::string _serial_device_path;
   std::thread _guiding_thread;
 
-  // TODO: need to see
-  // why I have 2 io_contexts declared. It is probably just a mistake.
-  asio::io_context _io_context;
-  asio::serial_port _serial_port;
+  alpaca_hub_serial::serial_channel_ptr_t _serial;
   bool _connected;
   double _aperture_diameter;
   double _focal_length;
   void throw_if_not_connected();
   void throw_if_parked();
+  // Waits for the motion state machine, the motion poll does the reading
   void block_while_moving();
   void set_is_moving(bool);
   void pulse_guide_proc(int duration_ms, char cardinal_direction);
@@ -174,6 +222,8 @@ private:
   bool _ra_target_set;
   bool _dec_target_set;
   bool _tracking_enabled;
+  drive_rate_enum _tracking_rate;
+  bool _does_refraction;
 };
 
 #endif
@@ -29,13 +29,14 @@ std::vector<std::string> pegasus_alpaca_focuscube3::serial_devices() {
 
 pegasus_alpaca_focuscube3::pegasus_alpaca_focuscube3()
     : _connected(false), _moving(false), _position(0), _temperature(0),
-      _backlash(0), _serial_port(_io_context) {}
+      _backlash(0),
+      _serial(alpaca_hub_serial::serial_reactor::instance().make_channel()) {}
 
 pegasus_alpaca_focuscube3::~pegasus_alpaca_focuscube3() {
   if (_connected) {
     _connected = false;
-    _focuser_update_thread.join();
-    _serial_port.close();
+    _update_task->stop();
+    _serial->close();
   }
 }
 
@@ -70,15 +71,7 @@ int pegasus_alpaca_focuscube3::set_connected(bool connected) {
       spdlog::debug("Setting connected to true");
       spdlog::debug("Attempting to open serial device at {0}",
                     _serial_device_path);
-      _serial_port.open(_serial_device_path);
-      _serial_port.set_option(asio::serial_port_base::baud_rate(115200));
-      _serial_port.set_option(asio::serial_port_base::character_size(8));
-      _serial_port.set_option(asio::serial_port_base::flow_control(
-          asio::serial_port_base::flow_control::none));
-      _serial_port.set_option(
-          asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-      _serial_port.set_option(asio::serial_port_base::stop_bits(
-          asio::serial_port_base::stop_bits::one));
+      _serial->open(_serial_device_path, 115200);
 
       char buf[512] = {0};
 
@@ -87,8 +80,8 @@ int pegasus_alpaca_focuscube3::set_connected(bool connected) {
       auto resp = send_command_to_focuser("##\r\n");
       spdlog::debug("focuser returned {0}", resp);
 
-      // Start update thread to values
-      _focuser_update_thread = std::thread(
+      // Start polling for values
+      _update_task = alpaca_hub_serial::serial_reactor::instance().schedule(
           std::bind(&pegasus_alpaca_focuscube3::update_properties_proc, this));
       _connected = true;
       return 0;
@@ -105,8 +98,8 @@ int pegasus_alpaca_focuscube3::set_connected(bool connected) {
       spdlog::debug("Setting connected to false");
       if (_connected) {
         _connected = false;
-        _focuser_update_thread.join();
-        _serial_port.close();
+        _update_task->stop();
+        _serial->close();
       }
       _connected = false;
       return 0;
@@ -144,17 +137,14 @@ void pegasus_alpaca_focuscube3::update_properties() {
   _backlash = atoi(result[5].c_str());
 }
 
-void pegasus_alpaca_focuscube3::update_properties_proc() {
+std::chrono::milliseconds pegasus_alpaca_focuscube3::update_properties_proc() {
   using namespace std::chrono_literals;
-  while (_connected) {
-    try {
-      update_properties();
-    } catch (alpaca_exception &ex) {
-      spdlog::warn("problem during update_properties: {}", ex.what());
-    }
-    std::this_thread::sleep_for(500ms);
+  try {
+    update_properties();
+  } catch (alpaca_exception &ex) {
+    spdlog::warn("problem during update_properties: {}", ex.what());
   }
-  spdlog::debug("update_properties_proc ended");
+  return 500ms;
 }
 
 std::string pegasus_alpaca_focuscube3::send_command_to_focuser(
@@ -163,24 +153,19 @@ std::string pegasus_alpaca_focuscube3::send_command_to_focuser(
   try {
     spdlog::trace("sending: {} to focuser", cmd);
     std::lock_guard lock(_focuser_mtx);
-    char buf[512] = {0};
-    _serial_port.write_some(asio::buffer(cmd));
-    std::string rsp;
+    alpaca_hub_serial::serial_request_t request{cmd};
 
     if (read_response) {
-      _io_context.reset();
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        rsp += c;
-        if (c == stop_on_char || stop_on_char == '\0') {
-          break;
-        }
-      }
+      if (stop_on_char == '\0')
+        request.frame_length = alpaca_hub_serial::fixed_length(1);
+      else
+        request.frame_length =
+            alpaca_hub_serial::ends_with_any(std::string(1, stop_on_char));
+      request.family = alpaca_hub_serial::command_family(cmd);
     }
 
+    auto rsp = _serial->transact(std::move(request)).frame;
+
     spdlog::trace("focuser returned: {}", rsp);
     return rsp;
   } catch (std::exception &ex) {
@@ -288,6 +273,7 @@ pegasus_alpaca_focuscube3::details() {
     detail_map["Moving"] = _moving;
     detail_map["Backlash"] = _backlash;
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
 
   return detail_map;
 };
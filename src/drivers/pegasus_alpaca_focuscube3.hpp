@@ -4,6 +4,7 @@
 #include "interfaces/i_alpaca_focuser.hpp"
 #include "asio/io_context.hpp"
 #include "common/alpaca_hub_serial.hpp"
+#include "common/serial_reactor.hpp"
 
 class pegasus_alpaca_focuscube3 : public i_alpaca_focuser {
 public:
@@ -46,13 +47,13 @@ public:
 private:
   void throw_if_not_connected();
   void update_properties();
-  void update_properties_proc();
-  std::thread _focuser_update_thread;
+  // Run by the serial reactor, returns when to run next
+  std::chrono::milliseconds update_properties_proc();
+  alpaca_hub_serial::polled_task_ptr_t _update_task;
   std::string _serial_device_path;
   bool _connected;
   bool _moving;
-  asio::io_context _io_context;
-  asio::serial_port _serial_port;
+  alpaca_hub_serial::serial_channel_ptr_t _serial;
   std::mutex _focuser_mtx;
   uint32_t _position;
   int _backlash;
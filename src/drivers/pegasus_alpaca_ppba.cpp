@@ -27,13 +27,13 @@ pegasus_alpaca_ppba::pegasus_alpaca_ppba()
       _uptime_in_mins(0), _dew_point(0), _dew_a_pwm(0), _dew_b_pwm(0),
       _current_of_dewA(0), _current_of_dewB(0), _usb2_on_off(true),
       _autodew(true), _power_warning(false), _dew_aggressiveness(0),
-      _serial_port(_io_context) {}
+      _serial(alpaca_hub_serial::serial_reactor::instance().make_channel()) {}
 
 pegasus_alpaca_ppba::~pegasus_alpaca_ppba() {
   if (_connected) {
     _connected = false;
-    _ppba_update_thread.join();
-    _serial_port.close();
+    _update_task->stop();
+    _serial->close();
   }
 }
 
@@ -50,25 +50,28 @@ std::string pegasus_alpaca_ppba::send_command_to_switch(const std::string &cmd,
   try {
     spdlog::trace("sending: {} to switch", cmd);
     std::lock_guard lock(_ppba_mtx);
-    char buf[512] = {0};
-    _serial_port.write_some(asio::buffer(fmt::format("{}\n", cmd)));
-    std::string rsp;
+    alpaca_hub_serial::serial_request_t request{fmt::format("{}\n", cmd)};
 
     if (read_response) {
-      _io_context.reset();
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        if (c == stop_on_char || stop_on_char == '\0') {
-          break;
-        }
-        if(c != '\r')
-          rsp += c;
-      }
+      if (stop_on_char == '\0')
+        request.frame_length = alpaca_hub_serial::fixed_length(1);
+      else
+        request.frame_length =
+            alpaca_hub_serial::ends_with_any(std::string(1, stop_on_char));
+      request.family = alpaca_hub_serial::command_family(cmd);
     }
 
+    auto reply = _serial->transact(std::move(request));
+    std::string_view frame = reply.frame;
+
+    // The PPBA's replies don't want the terminator or any '\r's
+    if (reply.complete && !frame.empty())
+      frame.remove_suffix(1);
+    std::string rsp;
+    for (char c : frame)
+      if (c != '\r')
+        rsp += c;
+
     spdlog::trace("switch returned: {}", rsp);
     return rsp;
   } catch (std::exception &ex) {
@@ -173,17 +176,14 @@ void pegasus_alpaca_ppba::update_properties() {
   _dew_aggressiveness = std::atoi(result[1].c_str());
 }
 
-void pegasus_alpaca_ppba::update_properties_proc() {
+std::chrono::milliseconds pegasus_alpaca_ppba::update_properties_proc() {
   using namespace std::chrono_literals;
-  while (_connected) {
-    try {
-      update_properties();
-    } catch (alpaca_exception &ex) {
-      spdlog::warn("problem during update_properties: {}", ex.what());
-    }
-    std::this_thread::sleep_for(500ms);
+  try {
+    update_properties();
+  } catch (alpaca_exception &ex) {
+    spdlog::warn("problem during update_properties: {}", ex.what());
   }
-  spdlog::debug("update_properties_proc ended");
+  return 500ms;
 }
 
 bool pegasus_alpaca_ppba::connected() { return _connected; }
@@ -202,15 +202,7 @@ int pegasus_alpaca_ppba::set_connected(bool connected) {
       spdlog::debug("Setting connected to true");
       spdlog::debug("Attempting to open serial device at {0}",
                     _serial_device_path);
-      _serial_port.open(_serial_device_path);
-      _serial_port.set_option(asio::serial_port_base::baud_rate(9600));
-      _serial_port.set_option(asio::serial_port_base::character_size(8));
-      _serial_port.set_option(asio::serial_port_base::flow_control(
-          asio::serial_port_base::flow_control::none));
-      _serial_port.set_option(
-          asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-      _serial_port.set_option(asio::serial_port_base::stop_bits(
-          asio::serial_port_base::stop_bits::one));
+      _serial->open(_serial_device_path, 9600);
 
       char buf[512] = {0};
 
@@ -220,8 +212,8 @@ int pegasus_alpaca_ppba::set_connected(bool connected) {
       auto resp = send_command_to_switch("P#");
       spdlog::debug("ppba returned {0}", resp);
 
-      // Start update thread to values
-      _ppba_update_thread = std::thread(
+      // Start polling for values
+      _update_task = alpaca_hub_serial::serial_reactor::instance().schedule(
           std::bind(&pegasus_alpaca_ppba::update_properties_proc, this));
       _connected = true;
       return 0;
@@ -238,8 +230,8 @@ int pegasus_alpaca_ppba::set_connected(bool connected) {
       spdlog::debug("Setting connected to false");
       if (_connected) {
         _connected = false;
-        _ppba_update_thread.join();
-        _serial_port.close();
+        _update_task->stop();
+        _serial->close();
       }
       _connected = false;
       return 0;
@@ -961,6 +953,7 @@ std::map<std::string, device_variant_t> pegasus_alpaca_ppba::details() {
     detail_map["Adj Output Voltage"] = _adj_power_voltage;
     detail_map["USB2 Ports On"] = _usb2_on_off;
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
 
   return detail_map;
 }
@@ -1,5 +1,6 @@
 #include "asio/io_context.hpp"
 #include "common/alpaca_hub_serial.hpp"
+#include "common/serial_reactor.hpp"
 #include "interfaces/i_alpaca_switch.hpp"
 
 enum ppba_switches {
@@ -84,12 +85,12 @@ private:
                                      bool read_response = true,
                                      char stop_on_char = '\n');
   void update_properties();
-  void update_properties_proc();
-  std::thread _ppba_update_thread;
+  // Run by the serial reactor, returns when to run next
+  std::chrono::milliseconds update_properties_proc();
+  alpaca_hub_serial::polled_task_ptr_t _update_task;
   std::string _serial_device_path;
   bool _connected;
-  asio::io_context _io_context;
-  asio::serial_port _serial_port;
+  alpaca_hub_serial::serial_channel_ptr_t _serial;
   std::mutex _ppba_mtx;
 
   double _voltage;
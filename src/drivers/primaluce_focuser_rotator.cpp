@@ -394,25 +394,18 @@ std::vector<std::string> esatto_focuser::serial_devices() {
 esatto_focuser::esatto_focuser(const std::string &serial_device_path)
     : _serial_device_path(serial_device_path), _connected(false),
       _is_moving(false), _position(0), _temperature(0), _backlash(0),
-      _serial_port(_io_context), _arco_present(false), _step_size(1) {
+      _serial(alpaca_hub_serial::serial_reactor::instance().make_channel()),
+      _arco_present(false), _step_size(1) {
   spdlog::debug("Setting connected to true");
   spdlog::debug("Attempting to open serial device at {0}", _serial_device_path);
-  _serial_port.open(_serial_device_path);
-  _serial_port.set_option(asio::serial_port_base::baud_rate(115200));
-  _serial_port.set_option(asio::serial_port_base::character_size(8));
-  _serial_port.set_option(asio::serial_port_base::flow_control(
-      asio::serial_port_base::flow_control::none));
-  _serial_port.set_option(
-      asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-  _serial_port.set_option(asio::serial_port_base::stop_bits(
-      asio::serial_port_base::stop_bits::one));
+  _serial->open(_serial_device_path, 115200);
 };
 
 esatto_focuser::~esatto_focuser() {
   if (_connected) {
     _connected = false;
-    _focuser_update_thread.join();
-    _serial_port.close();
+    _update_task->stop();
+    _serial->close();
   }
 };
 
@@ -512,17 +505,14 @@ void esatto_focuser::update_properties() {
   }
 }
 
-void esatto_focuser::update_properties_proc() {
+std::chrono::milliseconds esatto_focuser::update_properties_proc() {
   using namespace std::chrono_literals;
-  while (_connected) {
-    try {
-      update_properties();
-    } catch (alpaca_exception &ex) {
-      spdlog::warn("problem during update_properties: {}", ex.what());
-    }
-    std::this_thread::sleep_for(1000ms);
+  try {
+    update_properties();
+  } catch (alpaca_exception &ex) {
+    spdlog::warn("problem during update_properties: {}", ex.what());
   }
-  spdlog::debug("update_properties_proc ended");
+  return 1000ms;
 };
 
 // std::string build_command(const std::string &cmd_type, const std::)
@@ -552,9 +542,9 @@ int esatto_focuser::set_connected(bool connected) {
             fmt::format("Problem getting model name. Focuser returned {}",
                         resp));
 
-      // Start update thread to values
-      _focuser_update_thread =
-          std::thread(std::bind(&esatto_focuser::update_properties_proc, this));
+      // Start polling for values
+      _update_task = alpaca_hub_serial::serial_reactor::instance().schedule(
+          std::bind(&esatto_focuser::update_properties_proc, this));
       _connected = true;
       return 0;
     } catch (asio::system_error &e) {
@@ -571,8 +561,8 @@ int esatto_focuser::set_connected(bool connected) {
       if (_connected) {
         _rotator->set_connected(false);
         _connected = false;
-        _focuser_update_thread.join();
-        // _serial_port.close();
+        _update_task->stop();
+        // _serial->close();
       }
       _connected = false;
       return 0;
@@ -697,11 +687,28 @@ std::map<std::string, device_variant_t> esatto_focuser::details() {
     detail_map["Backlash"] = _backlash;
     detail_map["Moving"] = _is_moving;
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
 
   return detail_map;
 };
 
 // This will be used for the arco unit as well
+// Requests look like {"req":{"get":{"MOT1":{...}}}}, which makes this one
+// "get.MOT1". Good enough to tell the quick gets from the slower commands.
+static std::string esatto_command_family(const std::string &cmd) {
+  try {
+    auto req = nlohmann::json::parse(cmd).at("req");
+    if (!req.is_object() || req.empty())
+      return "req";
+    auto verb = req.begin();
+    if (verb->is_object() && !verb->empty())
+      return fmt::format("{}.{}", verb.key(), verb->begin().key());
+    return verb.key();
+  } catch (std::exception &) {
+    return "other";
+  }
+}
+
 std::string esatto_focuser::send_command_to_focuser(const std::string &cmd,
                                                     bool read_response,
                                                     char stop_on_char) {
@@ -711,23 +718,20 @@ std::string esatto_focuser::send_command_to_focuser(const std::string &cmd,
 
     spdlog::trace("sending: {} to focuser", cmd);
     std::lock_guard lock(_focuser_mtx);
-    char buf[8192] = {0};
-    _serial_port.write_some(asio::buffer(cmd));
-    std::string rsp;
+    alpaca_hub_serial::serial_request_t request{cmd};
 
     if (read_response) {
-      _io_context.reset();
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 500,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        rsp += c;
-        if (c == stop_on_char || stop_on_char == '\0') {
-          break;
-        }
-      }
+      if (stop_on_char == '\0')
+        request.frame_length = alpaca_hub_serial::fixed_length(1);
+      else
+        request.frame_length =
+            alpaca_hub_serial::ends_with_any(std::string(1, stop_on_char));
+      request.timeout = std::chrono::milliseconds(500);
+      request.family = esatto_command_family(cmd);
     }
 
+    auto rsp = _serial->transact(std::move(request)).frame;
+
     spdlog::trace("focuser returned: {}", rsp);
     return rsp;
   } catch (std::exception &ex) {
@@ -308,7 +308,9 @@ void qhy_alpaca_camera::initialize()
 
   uint32_t qhy_res = QHYCCD_ERROR;
   spdlog::debug("Calling SetQHYCCDReadMode with {}", _readout_mode);
-  qhy_res = SetQHYCCDReadMode(_cam_handle, _readout_mode);
+  qhy_res = timed_sdk_call("SetQHYCCDReadMode", [this]() {
+    return SetQHYCCDReadMode(_cam_handle, _readout_mode);
+  });
   if (qhy_res != QHYCCD_SUCCESS)
   {
     spdlog::error("SetQHYCCDReadMode failed with return code: {}", qhy_res);
@@ -320,7 +322,8 @@ void qhy_alpaca_camera::initialize()
   std::this_thread::sleep_for(200ms);
   // This gets the effective area if there is overscan
   qhy_res = QHYCCD_ERROR;
-  qhy_res = SetQHYCCDStreamMode(_cam_handle, 0);
+  // The stream mode only takes effect with the InitQHYCCD below
+  qhy_res = SetQHYCCDStreamMode(_cam_handle, _live_mode ? 1 : 0);
   if (qhy_res != QHYCCD_SUCCESS)
     spdlog::error("Failed to set QHYCCD stream mode: {}", qhy_res);
 
@@ -329,7 +332,8 @@ void qhy_alpaca_camera::initialize()
   // a failed initialization of camera?
   qhy_res = QHYCCD_ERROR;
 
-  qhy_res = InitQHYCCD(_cam_handle);
+  qhy_res = timed_sdk_call("InitQHYCCD",
+                           [this]() { return InitQHYCCD(_cam_handle); });
   if (qhy_res == QHYCCD_SUCCESS)
   {
     spdlog::debug("InitQHYCCD successful");
@@ -349,12 +353,11 @@ void qhy_alpaca_camera::initialize()
     spdlog::warn("Failed to set bin mode via SDK");
 
   _bin_changed = false;
+  uint32_t bin_res = qhy_res;
   SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_TRANSFERBIT, _bpp);
 
   chip_info();
   _read_mode_changed = false;
-  set_gain(_gain);
-  set_offset(_offset);
   // chip_info();
 
   if (IsQHYCCDControlAvailable(_cam_handle, CONTROL_ID::CONTROL_USBTRAFFIC) ==
@@ -368,16 +371,73 @@ void qhy_alpaca_camera::initialize()
                              &u_min, &u_max, &u_step);
     spdlog::debug("USB Traffic Settings - min: {}, max: {}, step: {}", u_min, u_max,
                   u_step);
-    SetQHYCCDParam(_cam_handle, CONTROL_USBTRAFFIC, _usb_traffic);
   }
   else
   {
     spdlog::trace("CONTROL_USBTRAFFIC is not available");
   }
 
+  // Allocate the frame buffers up front so the first exposure doesn't pay
+  // for it
+  ensure_frame_pool(GetQHYCCDMemLength(_cam_handle));
+
+  // InitQHYCCD resets the camera, so apart from the read mode and bin we
+  // just set everything has to be sent again. Gain, offset, ROI etc. go out
+  // with the next exposure.
+  _applied_config.invalidate();
+  uint32_t applied = CONFIG_READOUT_MODE;
+  if (bin_res == QHYCCD_SUCCESS)
+    applied |= CONFIG_BIN;
+  _applied_config.mark_applied(desired_config(0), applied);
+
   _read_mode_changed = false;
 }
 
+camera_config_t qhy_alpaca_camera::desired_config(double exposure_seconds)
+{
+  std::lock_guard lock(_cam_mutex);
+  camera_config_t config;
+  config.readout_mode = _readout_mode;
+  config.bin = _bin_x;
+  config.start_x = _start_x;
+  config.start_y = _start_y;
+  config.num_x = _num_x;
+  config.num_y = _num_y;
+  config.gain = sdk_gain_value(_gain);
+  config.offset = _offset;
+  config.usb_traffic = _usb_traffic;
+  config.exposure_us = exposure_seconds * 1000000;
+  return config;
+}
+
+// Kinda janky - some of the qhy cameras have 0 as a gain option which means
+// the "index" of the gains matches the gain value. In the case where the
+// gain starts with 1 we must add 1 so that this fixes the off by one issue.
+// This probably needs to be rewritten to not obfuscate the behavior as I
+// this this does now.
+double qhy_alpaca_camera::sdk_gain_value(uint32_t gain)
+{
+  if (!_gains.empty() && _gains[0] == "1" &&
+      _gains_mode == "gains_index_mode")
+    return gain + 1;
+  return gain;
+}
+
+void qhy_alpaca_camera::ensure_frame_pool(size_t buffer_size)
+{
+  // GetQHYCCDMemLength is sized for the full sensor so this should only
+  // happen the first time through unless the read mode changes it
+  if (_frame_pool && _frame_pool->buffer_size() >= buffer_size)
+    return;
+
+  spdlog::debug("Allocating frame buffer pool with {} byte buffers",
+                buffer_size);
+  // Sensor sized buffers, so slow downloads get to hold up to two more
+  // before exposures start failing
+  _frame_pool = frame_buffer_pool_t::create(2, buffer_size, true,
+                                            _huge_page_frame_buffers, 4);
+}
+
 void qhy_alpaca_camera::initialize_camera_by_camera_id(std::string &camera_id)
 {
   uint32_t qhy_res = QHYCCD_ERROR;
@@ -617,23 +677,56 @@ qhy_alpaca_camera::qhy_alpaca_camera(std::string &camera_id)
       _effective_num_x(0), _effective_num_y(0), _effective_start_x(0),
       _effective_start_y(0), _include_overscan(false), _max_num_x(0),
       _max_num_y(0), _percent_complete(100), _set_cooler_power(0),
-      _can_control_ccd_temp(false), _run_cooler_thread(false),
+      _can_control_ccd_temp(false), _cooler_on(false),
       _has_filter_wheel(false), _last_camera_temp(0), _last_cooler_power(0),
-      _usb_traffic(20), _bpp(16), __t(_io), _read_mode_changed(true),
+      _usb_traffic(20), _bpp(16), _read_mode_changed(true),
       _bin_changed(true), _gains_mode("gains_index_mode"),
-      _offsets_mode("offsets_index_mode")
-{
-  initialize_camera_by_camera_id(camera_id);
+      _offsets_mode("offsets_index_mode"), _huge_page_frame_buffers(false),
+      _worker_wakeup(false), _worker_stopping(false), _readout_pending(false),
+      _stream_mode_changed(false), _live_mode(false),
+      _live_frames(live_max_queued_frames),
+      _live_poll_interval(std::chrono::milliseconds(1)), _live_frame_count(0)
+{
+  _next_housekeeping = std::chrono::steady_clock::now();
+  // Leave a core for the SDK worker and the web server, but always have at
+  // least one thread or nothing would ever run the stats
+  _stats_pool = std::make_shared<worker_pool_t>(
+      std::max(2u, std::thread::hardware_concurrency()) - 1);
+  _worker_thread =
+      std::thread(std::bind(&qhy_alpaca_camera::camera_worker_proc, this));
+
+  try
+  {
+    run_on_worker("OpenQHYCCD", [this, &camera_id]() {
+      initialize_camera_by_camera_id(camera_id);
+      return 0;
+    });
+  }
+  catch (...)
+  {
+    // The destructor won't run, so we need to clean up the worker here
+    stop_worker();
+    throw;
+  }
 };
 
 qhy_alpaca_camera::~qhy_alpaca_camera()
 {
   spdlog::trace("Closing Camera");
-  if (_cooler_thread.joinable())
-    _cooler_thread.join();
-  if (_start_exposure_thread.joinable())
-    _start_exposure_thread.join();
-  uint32_t r = CloseQHYCCD(_cam_handle);
+  uint32_t r = QHYCCD_ERROR;
+  try
+  {
+    r = run_on_worker("CloseQHYCCD", [this]() {
+      end_live();
+      return (int)CloseQHYCCD(_cam_handle);
+    });
+  }
+  catch (std::exception &ex)
+  {
+    spdlog::error("Exception while closing camera: {}", ex.what());
+  }
+  stop_worker();
+
   if (r == QHYCCD_SUCCESS)
   {
     spdlog::trace("Successfully Closed Camera");
@@ -644,6 +737,219 @@ qhy_alpaca_camera::~qhy_alpaca_camera()
   }
 }
 
+// This is the only thread that talks to the SDK for this camera. It sleeps
+// until either a command is posted, the current exposure is due to be read
+// out or it's time for housekeeping (cooler regulation and telemetry).
+void qhy_alpaca_camera::camera_worker_proc()
+{
+  spdlog::debug("Camera worker running");
+  using namespace std::chrono_literals;
+
+  while (true)
+  {
+    camera_command_t cmd;
+    while (_commands.try_pop(cmd))
+    {
+      if (cmd.type == camera_command_t::type_t::SHUTDOWN)
+      {
+        // post_command() turns everything away once SHUTDOWN is queued so
+        // this should be empty, but anybody still waiting on a command gets
+        // an error rather than hanging forever
+        while (_commands.try_pop(cmd))
+          if (cmd.result)
+            cmd.result->set_exception(std::make_exception_ptr(
+                alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                                 "Camera is shutting down")));
+        spdlog::debug("Camera worker exited");
+        return;
+      }
+      handle_command(cmd);
+    }
+
+    // Keep pulling live frames for as long as the camera has them
+    if (_live_mode)
+    {
+      bool got_frame = false;
+      try
+      {
+        got_frame = read_live_frame();
+      }
+      catch (std::exception &ex)
+      {
+        spdlog::error("Problem reading live frame, stopping live mode: {}",
+                      ex.what());
+        end_live();
+      }
+      if (got_frame)
+        continue;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (_readout_pending && now >= _readout_deadline)
+    {
+      _readout_pending = false;
+      try
+      {
+        read_image_from_camera();
+      }
+      catch (std::exception &ex)
+      {
+        spdlog::error("Problem reading image from camera: {}", ex.what());
+        std::lock_guard lock(_cam_mutex);
+        _camera_state = camera_state_enum::CAMERA_ERROR;
+      }
+      // Check for commands that came in during the readout before sleeping
+      continue;
+    }
+
+    if (now >= _next_housekeeping)
+    {
+      try
+      {
+        housekeeping();
+      }
+      catch (std::exception &ex)
+      {
+        spdlog::error("Camera housekeeping failed: {}", ex.what());
+      }
+      _next_housekeeping = now + 1s;
+    }
+
+    auto wake_at = _next_housekeeping;
+    if (_readout_pending && _readout_deadline < wake_at)
+      wake_at = _readout_deadline;
+    // The SDK has no way to tell us a live frame is ready so we poll
+    if (_live_mode && now + _live_poll_interval < wake_at)
+      wake_at = now + _live_poll_interval;
+
+    std::unique_lock lock(_worker_mtx);
+    _worker_cv.wait_until(lock, wake_at, [this] { return _worker_wakeup; });
+    _worker_wakeup = false;
+  }
+}
+
+void qhy_alpaca_camera::post_command(camera_command_t cmd)
+{
+  cmd.posted_at = std::chrono::steady_clock::now();
+
+  // The queue itself is lock free, the mutex is here so the worker can't
+  // miss the wakeup between draining the queue and going to sleep, and so
+  // nothing can land in the queue behind SHUTDOWN where it would never run
+  {
+    std::lock_guard lock(_worker_mtx);
+    if (_worker_stopping)
+      throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                             "Camera is shutting down");
+    if (cmd.type == camera_command_t::type_t::SHUTDOWN)
+      _worker_stopping = true;
+    _commands.push(std::move(cmd));
+    _worker_wakeup = true;
+  }
+  _worker_cv.notify_one();
+}
+
+int qhy_alpaca_camera::run_on_worker(camera_command_t cmd)
+{
+  // Commands issued from the worker itself (e.g. set_gain() during
+  // initialize()) just run inline, otherwise we'd deadlock waiting on
+  // ourselves
+  if (std::this_thread::get_id() == _worker_thread.get_id())
+    return execute_command(cmd);
+
+  auto result = std::make_shared<std::promise<int>>();
+  auto future = result->get_future();
+  cmd.result = result;
+  post_command(std::move(cmd));
+  return future.get();
+}
+
+int qhy_alpaca_camera::run_on_worker(const std::string &name,
+                                     std::function<int()> call)
+{
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::CALL;
+  cmd.name = name;
+  cmd.call = std::move(call);
+  return run_on_worker(std::move(cmd));
+}
+
+void qhy_alpaca_camera::handle_command(camera_command_t &cmd)
+{
+  _sdk_timings.record("command_queue_wait",
+                      std::chrono::steady_clock::now() - cmd.posted_at);
+  try
+  {
+    int r = execute_command(cmd);
+    if (cmd.result)
+      cmd.result->set_value(r);
+  }
+  catch (...)
+  {
+    if (cmd.result)
+      cmd.result->set_exception(std::current_exception());
+    else
+      spdlog::error("Camera command {} failed", cmd.name);
+  }
+}
+
+int qhy_alpaca_camera::execute_command(camera_command_t &cmd)
+{
+  return _sdk_timings.time(cmd.name, [this, &cmd]() {
+    switch (cmd.type)
+    {
+    case camera_command_t::type_t::START_EXPOSURE:
+      if (cmd.result)
+        _exposure_start_timings.record(
+            "queue_wait", std::chrono::steady_clock::now() - cmd.posted_at);
+      return begin_exposure(cmd.value);
+    case camera_command_t::type_t::ABORT_EXPOSURE:
+      return cancel_exposure(true);
+    case camera_command_t::type_t::STOP_EXPOSURE:
+      return cancel_exposure(false);
+    case camera_command_t::type_t::SET_COOLER:
+      if (_cooler_on && cmd.value != 0)
+      {
+        spdlog::warn("Cooler is already on. This is a no-op");
+        return 0;
+      }
+
+      if (cmd.value != 0)
+      {
+        spdlog::debug("Starting turning cooler on with set temp of {}",
+                      _current_set_temp);
+        _cooler_on = true;
+        // Regulate right away rather than waiting for the next tick
+        _next_housekeeping = std::chrono::steady_clock::now();
+        return 0;
+      }
+
+      _cooler_on = false;
+      spdlog::debug("Cooler control has been turned off");
+      if (timed_sdk_call("SetQHYCCDParam(MANULPWM)", [this]() {
+            return SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_MANULPWM, 0);
+          }) == QHYCCD_SUCCESS)
+        return 0;
+      return -1;
+    case camera_command_t::type_t::CALL:
+      return cmd.call();
+    case camera_command_t::type_t::SHUTDOWN:
+      break;
+    }
+    return -1;
+  });
+}
+
+void qhy_alpaca_camera::stop_worker()
+{
+  if (!_worker_thread.joinable())
+    return;
+
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::SHUTDOWN;
+  post_command(std::move(cmd));
+  _worker_thread.join();
+}
+
 uint32_t qhy_alpaca_camera::interface_version() { return 3; }
 
 std::string qhy_alpaca_camera::driver_version() { return "v0.1"; }
@@ -653,17 +959,25 @@ bool qhy_alpaca_camera::connected() { return this->_connected; };
 int qhy_alpaca_camera::set_connected(bool connected)
 {
   spdlog::debug("set_connected invoked with: {}", connected);
-  if (!_connected && connected)
-  {
-    _last_exposure_duration = 0;
-    _num_x = 0;
-    _readout_mode = 0;
-    _read_mode_changed = true;
-  }
-  _connected = connected;
-  if (_connected)
-    initialize();
-  return 0;
+  return run_on_worker("set_connected", [this, connected]() {
+    if (!_connected && connected)
+    {
+      _last_exposure_duration = 0;
+      _num_x = 0;
+      _readout_mode = 0;
+      _read_mode_changed = true;
+    }
+    if (!connected)
+      end_live();
+    _connected = connected;
+    if (_connected)
+    {
+      initialize();
+      // Make sure temperature etc. are populated before anybody asks
+      housekeeping();
+    }
+    return 0;
+  });
 }
 
 short qhy_alpaca_camera::bin_x()
@@ -781,21 +1095,9 @@ double qhy_alpaca_camera::ccd_temperature()
   throw_if_not_connected();
   // spdlog::trace("ccd_temperature() invoked");
 
-  // Let's not try to read the temp while downloading
-  if (_camera_state != camera_state_enum::CAMERA_READING)
-  {
-    // Need to figure out if I should actually get a lock here or
-    // just check if the program is reading...
-    std::lock_guard lock(_cam_mutex);
-    _last_camera_temp =
-        GetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_CURTEMP);
-  }
-  else
-  {
-    spdlog::trace(
-        "skipping get temp since camera we are downloading from camera");
-  }
-
+  // This is refreshed every second by the camera worker (which also means
+  // it's never read while downloading)
+  std::lock_guard lock(_cam_mutex);
   return _last_camera_temp;
 };
 
@@ -810,41 +1112,47 @@ bool qhy_alpaca_camera::cooler_on()
         "CCD Cooler Control is Not supported on this camera");
   }
 
-  return _run_cooler_thread;
+  return _cooler_on;
 }
 
-bool qhy_alpaca_camera::should_run_cooler_proc()
+// Runs on the worker about once a second. According to QHY docs we should
+// not run the temp loop during download, since readout happens on the same
+// thread that can't happen anymore.
+void qhy_alpaca_camera::housekeeping()
 {
-  std::lock_guard lock(_cam_mutex);
-  return _run_cooler_thread;
-}
+  if (!_connected || !_cam_handle)
+    return;
 
-void qhy_alpaca_camera::ensure_temp_is_set()
-{
-  std::lock_guard lock(_cam_mutex);
-  spdlog::trace("Ensuring temp is set");
-  // According to QHY docs we should not run temp loop during download
-  if (_camera_state != camera_state_enum::CAMERA_READING)
+  double set_temp = 0;
   {
-    SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_COOLER, _current_set_temp);
-    spdlog::trace("Current temp is {}",
-                  GetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_CURTEMP));
+    std::lock_guard lock(_cam_mutex);
+    set_temp = _current_set_temp;
   }
-}
-
-void qhy_alpaca_camera::cooler_proc()
-{
-  spdlog::debug("Cooler thread running");
 
-  using namespace std::chrono_literals;
-  while (should_run_cooler_proc())
+  if (_cooler_on)
   {
-    // if(_not_reading_image)
-    ensure_temp_is_set();
-    std::this_thread::sleep_for(1000ms);
+    spdlog::trace("Ensuring temp is set");
+    timed_sdk_call("SetQHYCCDParam(COOLER)", [this, set_temp]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_COOLER, set_temp);
+    });
   }
-  spdlog::debug("Cooler thread exited");
-};
+
+  double temp = timed_sdk_call("GetQHYCCDParam(CURTEMP)", [this]() {
+    return GetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_CURTEMP);
+  });
+
+  double power = 0;
+  if (_can_control_cooler_power)
+    power = timed_sdk_call("GetQHYCCDParam(CURPWM)", [this]() {
+              return GetQHYCCDParam(_cam_handle, CONTROL_CURPWM);
+            }) /
+            255.0 * 100.0;
+
+  std::lock_guard lock(_cam_mutex);
+  _last_camera_temp = temp;
+  _last_cooler_power = power;
+  spdlog::trace("Current temp is {}, cooler power {}%", temp, power);
+}
 
 int qhy_alpaca_camera::set_cooler_on(bool cooler_on)
 {
@@ -854,33 +1162,11 @@ int qhy_alpaca_camera::set_cooler_on(bool cooler_on)
                            "Cooler Power Setting not available on this camera");
   spdlog::debug("Setting cooler on to {}", cooler_on);
 
-  std::lock_guard lock(_cam_mutex);
-
-  if (_run_cooler_thread == true && cooler_on)
-  {
-    spdlog::warn("Cooler is already on. This is a no-op");
-    return 0;
-  }
-
-  if (cooler_on)
-  {
-    _run_cooler_thread = true;
-    spdlog::debug("Starting turning cooler on with set temp of {}",
-                  _current_set_temp);
-    _cooler_thread =
-        std::thread(std::bind(&qhy_alpaca_camera::cooler_proc, this));
-    _cooler_thread.detach();
-    return 0;
-  }
-  else
-  {
-    _run_cooler_thread = false;
-    spdlog::debug("Cooler control thread has been requested to shutdown");
-    if (SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_MANULPWM, 0) ==
-        QHYCCD_SUCCESS)
-      return 0;
-  }
-  return -1;
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::SET_COOLER;
+  cmd.name = "set_cooler_on";
+  cmd.value = cooler_on;
+  return run_on_worker(std::move(cmd));
 };
 
 double qhy_alpaca_camera::cooler_power()
@@ -890,15 +1176,9 @@ double qhy_alpaca_camera::cooler_power()
     throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
                            "Cooler Power Setting not available on this camera");
 
-  if (_camera_state != camera_state_enum::CAMERA_READING)
-  {
-    std::lock_guard lock(_cam_mutex);
-    _last_cooler_power =
-        GetQHYCCDParam(_cam_handle, CONTROL_CURPWM) / 255.0 * 100.0;
-    spdlog::trace("Cooler_power() invoked and returning {}%",
-                  _last_cooler_power);
-  }
-
+  // Refreshed by the camera worker's housekeeping
+  std::lock_guard lock(_cam_mutex);
+  spdlog::trace("Cooler_power() invoked and returning {}%", _last_cooler_power);
   return _last_cooler_power;
 };
 
@@ -936,79 +1216,30 @@ double qhy_alpaca_camera::heat_sink_temperature()
   if (!_can_control_cooler_power)
     throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
                            "Cooler Power Setting not available on this camera");
-  // I'm going to eliminate read locks moving forward for values don't need
-  // guaranteed accuracy
-  // std::lock_guard lock(_cam_mutex);
-  return GetQHYCCDParam(_cam_handle, CONTROL_CURTEMP);
+  // Same sensor reading as ccd_temperature(), refreshed by the worker
+  std::lock_guard lock(_cam_mutex);
+  return _last_camera_temp;
 }
 
 // TODO: I'm not sure this needs to be a public method on the
 // camera interface.
 int qhy_alpaca_camera::image_array(std::vector<uint8_t> &theImage)
 {
-  std::lock_guard lock(_cam_mutex);
-  theImage = _img_data;
-  return 0;
-}
-
-// TODO: consider refactoring the image_2d code into a separate helper
-// class that can implement templates accordingly
-std::vector<std::vector<uint32_t>> qhy_alpaca_camera::image_2d_8bpp()
-{
-  std::vector<uint8_t> data_ptr =
-      reinterpret_cast<std::vector<uint8_t> &>(_img_data);
-
-  std::vector<std::vector<uint32_t>> image_2d_data(
-      _image_w, std::vector<uint32_t>(_image_h, 0));
-
-  for (int row_idx = 0; row_idx < _image_w; row_idx++)
+  auto frame = last_frame();
+  if (!frame)
   {
-    for (int col_idx = 0; col_idx < _image_h; col_idx++)
-    {
-      image_2d_data[row_idx][col_idx] =
-          data_ptr[row_idx + (col_idx * _image_w)];
-    }
-  }
-
-  spdlog::trace("image_2d_data is {} x {}", image_2d_data.size(),
-                image_2d_data[0].size());
-  return image_2d_data;
-}
-
-std::vector<std::vector<uint32_t>> qhy_alpaca_camera::image_2d_16bpp()
-{
-  if (_img_data.size() == 0)
-  {
-    return std::vector<std::vector<uint32_t>>(0);
+    theImage.clear();
+    return 0;
   }
 
-  std::vector<uint16_t> data_ptr =
-      reinterpret_cast<std::vector<uint16_t> &>(_img_data);
-
-  std::vector<std::vector<uint32_t>> image_2d_data(
-      _image_w, std::vector<uint32_t>(_image_h, 0));
-
-  for (int row_idx = 0; row_idx < _image_w; row_idx++)
-  {
-    for (int col_idx = 0; col_idx < _image_h; col_idx++)
-    {
-      image_2d_data[row_idx][col_idx] =
-          data_ptr[row_idx + (col_idx * _image_w)];
-    }
-  }
-  spdlog::trace("image_2d_data is {} x {}", image_2d_data.size(),
-                image_2d_data[0].size());
-  return image_2d_data;
+  theImage.assign(frame->data(), frame->data() + frame->data_size());
+  return 0;
 }
 
-std::vector<std::vector<uint32_t>> qhy_alpaca_camera::image_2d()
+camera_frame_ptr_t qhy_alpaca_camera::last_frame()
 {
-  if (_bpp == 8)
-  {
-    return image_2d_8bpp();
-  }
-
-  return image_2d_16bpp();
+  std::lock_guard lock(_cam_mutex);
+  return _last_frame;
 }
 
 void qhy_alpaca_camera::set_reading_state()
@@ -1019,6 +1250,31 @@ void qhy_alpaca_camera::set_reading_state()
   spdlog::debug("Camera state set to reading");
 }
 
+void qhy_alpaca_camera::compute_last_frame_stats(camera_frame_ptr_t frame)
+{
+  auto promise = std::make_shared<std::promise<frame_stats_t>>();
+  {
+    std::lock_guard lock(_cam_mutex);
+    _last_frame_stats = promise->get_future().share();
+  }
+
+  // The pool outlives anything queued on it, so a plain pointer is fine here
+  worker_pool_t *pool = _stats_pool.get();
+  pool->submit([pool, promise, frame]() {
+    try
+    {
+      auto stats = compute_frame_stats(*frame, *pool);
+      spdlog::debug("frame stats took {:.1f}ms, {} stars, median HFR {:.2f}",
+                    stats.compute_ms, stats.star_count, stats.median_hfr);
+      promise->set_value(std::move(stats));
+    }
+    catch (...)
+    {
+      promise->set_exception(std::current_exception());
+    }
+  });
+}
+
 void qhy_alpaca_camera::read_image_from_camera()
 {
   set_reading_state();
@@ -1030,17 +1286,26 @@ void qhy_alpaca_camera::read_image_from_camera()
   uint32_t bpp = 0;
   uint32_t channels = 0;
   uint32_t img_size = 0;
-  img_size = GetQHYCCDMemLength(_cam_handle);
+  img_size = timed_sdk_call("GetQHYCCDMemLength",
+                            [this]() { return GetQHYCCDMemLength(_cam_handle); });
   spdlog::trace("Image size: {}", img_size);
-  _img_data.resize(img_size);
+
+  // Every exposure gets its own buffer from the pool since clients may still
+  // be downloading the last frame. The previous buffer goes back to the pool
+  // once the last download lets go of it.
+  ensure_frame_pool(img_size);
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->buffer = _frame_pool->acquire(img_size);
 
   // Adding this per the SDK spec so that nothing else should happen while
   // reading from the camera
   spdlog::debug("Getting lock...");
   // std::lock_guard lock(_cam_mutex);
   spdlog::debug("Calling GetQHYCCDSingleFrame and fetching img_data", img_size);
-  uint32_t r =
-      GetQHYCCDSingleFrame(_cam_handle, &w, &h, &bpp, &channels, &_img_data[0]);
+  uint32_t r = timed_sdk_call("GetQHYCCDSingleFrame", [&]() {
+    return GetQHYCCDSingleFrame(_cam_handle, &w, &h, &bpp, &channels,
+                                frame->data());
+  });
 
   _image_w = w;
   _image_h = h;
@@ -1050,20 +1315,46 @@ void qhy_alpaca_camera::read_image_from_camera()
   {
     spdlog::trace("Successfully executed GetQHYCCDSingleFrame with {} size",
                   img_size);
-    spdlog::trace("Setting camera state to idle");
+
+    frame->pixel_type = (bpp == 8) ? image_array_element_types::BYTE
+                                   : image_array_element_types::UINT16;
+    frame->width = w;
+    frame->height = h;
+    frame->bayer_offset_x = _bayer_offset_x;
+    frame->bayer_offset_y = _bayer_offset_y;
+    frame->bin_x = _bin_x;
+    frame->bin_y = _bin_y;
+    frame->start_x = _start_x;
+    frame->start_y = _start_y;
+    frame->exposure_duration = _last_exposure_duration;
+    frame->exposure_start_time = _last_exposure_start_time_fits;
+    frame->gain = _gain;
+    frame->offset = _offset;
+    // The SDK asks for more memory than the frame actually needs
+    if (frame->data_size() > frame->size_bytes())
+      frame->buffer->resize(frame->size_bytes());
+
+    camera_frame_ptr_t last_frame = std::move(frame);
+    compute_last_frame_stats(last_frame);
+    std::lock_guard lock(_cam_mutex);
+    _last_frame = std::move(last_frame);
+    spdlog::debug("read_image_from_camera complete setting idle state");
+    _camera_state = camera_state_enum::CAMERA_IDLE;
   }
   else
   {
-    spdlog::error("Problem calling GetQHYCCDSingleFrame");
+    // _last_frame is still the previous exposure, image_ready() mustn't
+    // pass it off as this one
+    spdlog::error("Problem calling GetQHYCCDSingleFrame: {}", r);
+    std::lock_guard lock(_cam_mutex);
+    _camera_state = camera_state_enum::CAMERA_ERROR;
   }
-
-  spdlog::debug("read_image_from_camera complete setting idle state");
-  _camera_state = camera_state_enum::CAMERA_IDLE;
 }
 
 bool qhy_alpaca_camera::image_ready()
 {
   throw_if_not_connected();
+  std::lock_guard lock(_cam_mutex);
   if (_camera_state == camera_state_enum::CAMERA_IDLE &&
       _last_exposure_duration > 0)
   {
@@ -1223,17 +1514,48 @@ int qhy_alpaca_camera::set_start_y(long start_y)
 int qhy_alpaca_camera::abort_exposure()
 {
   throw_if_not_connected();
-  std::lock_guard lock(_cam_mutex);
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::ABORT_EXPOSURE;
+  cmd.name = "abort_exposure";
+  return run_on_worker(std::move(cmd));
+}
+
+// Runs on the worker. Aborting throws the image away, stopping still reads
+// it out (the SDK expects the image to be read right after
+// CancelQHYCCDExposing).
+int qhy_alpaca_camera::cancel_exposure(bool discard_image)
+{
   uint32_t r = QHYCCD_ERROR;
-  r = CancelQHYCCDExposingAndReadout(_cam_handle);
-  if (r == QHYCCD_SUCCESS)
+  if (discard_image)
   {
+    r = timed_sdk_call("CancelQHYCCDExposingAndReadout", [this]() {
+      return CancelQHYCCDExposingAndReadout(_cam_handle);
+    });
+    _readout_pending = false;
+    std::lock_guard lock(_cam_mutex);
     _camera_state = camera_state_enum::CAMERA_IDLE;
-    spdlog::debug(
-        "Successfully stopped exposure. Image data can not be read now");
+  }
+  else
+  {
+    r = timed_sdk_call("CancelQHYCCDExposing",
+                       [this]() { return CancelQHYCCDExposing(_cam_handle); });
+    if (_readout_pending)
+    {
+      _readout_deadline = std::chrono::steady_clock::now();
+    }
+    else
+    {
+      std::lock_guard lock(_cam_mutex);
+      _camera_state = camera_state_enum::CAMERA_IDLE;
+    }
+  }
+
+  if (r == QHYCCD_SUCCESS)
+  {
+    spdlog::debug("Successfully stopped exposure. Image data {}",
+                  discard_image ? "can not be read now" : "will be read now");
     return 0;
   }
-  _camera_state = camera_state_enum::CAMERA_IDLE;
 
   spdlog::error("Problem stopping exposure: {}", r);
   return -1;
@@ -1247,15 +1569,165 @@ int qhy_alpaca_camera::pulse_guide(qhy_alpaca_camera::guide_direction,
                          "Pulse guiding not supported");
 };
 
-int qhy_alpaca_camera::start_exposure_proc()
+// Runs on the worker. Sends whatever differs between desired and what the
+// camera already has apart from the exposure time, returns the fields sent.
+uint32_t qhy_alpaca_camera::send_changed_config(
+    camera_config_t &desired, double duration_seconds,
+    const std::function<void(const char *)> &end_phase)
 {
-  _io.reset();
-  uint32_t r = 0;
-  spdlog::trace("start_exposure_proc() invoked");
-  spdlog::debug("Invoking ExpQHYCCDSingleFrame");
+  // Only the settings that differ from what the camera already has get sent,
+  // each of these costs a USB round trip or more
+  uint32_t changed = _applied_config.diff(desired);
+  uint32_t sent = changed;
+
+  // Read mode and bin changes need a full re-init which also works out the
+  // new ROI, so get the desired state again afterwards. Switching in and out
+  // of live mode needs one too but there's no reason to lose the ROI.
+  if (_read_mode_changed || _stream_mode_changed ||
+      (changed & CONFIG_READOUT_MODE))
+  {
+    bool keep_roi = !_read_mode_changed && !(changed & CONFIG_READOUT_MODE);
+    _read_mode_changed = true;
+    _stream_mode_changed = false;
+    initialize();
+    if (keep_roi)
+    {
+      std::lock_guard lock(_cam_mutex);
+      _start_x = desired.start_x;
+      _start_y = desired.start_y;
+      _num_x = desired.num_x;
+      _num_y = desired.num_y;
+    }
+    desired = desired_config(duration_seconds);
+    changed = _applied_config.diff(desired);
+    sent |= changed | CONFIG_READOUT_MODE;
+    end_phase("initialize");
+  }
+
+  uint32_t qhy_res = QHYCCD_ERROR;
+  if (changed & CONFIG_BIN)
+  {
+    qhy_res = timed_sdk_call("SetQHYCCDBinMode", [this, &desired]() {
+      return SetQHYCCDBinMode(_cam_handle, desired.bin, desired.bin);
+    });
+    if (qhy_res == QHYCCD_SUCCESS)
+      _applied_config.mark_applied(desired, CONFIG_BIN);
+    else
+      spdlog::warn("failed to set bin mode");
+    end_phase("bin");
+  }
+
+  // The SDK wants the resolution again after the bin mode changes
+  if (changed & (CONFIG_ROI | CONFIG_BIN))
+  {
+    set_resolution(desired.start_x, desired.start_y, desired.num_x,
+                   desired.num_y);
+    _applied_config.mark_applied(desired, CONFIG_ROI);
+    end_phase("roi");
+  }
 
-  _last_exposure_start_time = std::chrono::system_clock::now();
-  _last_exposure_start_time_fits = fmt::format("{:%FT%T}", _last_exposure_start_time);
+  if (changed & CONFIG_GAIN)
+  {
+    qhy_res = timed_sdk_call("SetQHYCCDParam(GAIN)", [this, &desired]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_GAIN,
+                            desired.gain);
+    });
+    if (qhy_res == QHYCCD_SUCCESS)
+      _applied_config.mark_applied(desired, CONFIG_GAIN);
+    else
+      spdlog::warn("failed to set gain to {}", desired.gain);
+    end_phase("gain");
+  }
+
+  if (changed & CONFIG_OFFSET)
+  {
+    qhy_res = timed_sdk_call("SetQHYCCDParam(OFFSET)", [this, &desired]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_OFFSET, desired.offset);
+    });
+    if (qhy_res == QHYCCD_SUCCESS)
+      _applied_config.mark_applied(desired, CONFIG_OFFSET);
+    else
+      spdlog::warn("failed to set offset to {}", desired.offset);
+    end_phase("offset");
+  }
+
+  if (changed & CONFIG_USB_TRAFFIC)
+  {
+    qhy_res = timed_sdk_call("SetQHYCCDParam(USBTRAFFIC)", [this, &desired]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_USBTRAFFIC,
+                            desired.usb_traffic);
+    });
+    // Not every camera has this control, there's no point retrying it on
+    // every frame if it isn't there
+    if (qhy_res != QHYCCD_SUCCESS)
+      spdlog::debug("failed to set usb traffic to {}", desired.usb_traffic);
+    _applied_config.mark_applied(desired, CONFIG_USB_TRAFFIC);
+    end_phase("usb_traffic");
+  }
+
+  return sent;
+}
+
+// Runs on the worker. Everything up to the SDK starting the exposure happens
+// here, the readout is scheduled for when the exposure should be done and
+// picked up by camera_worker_proc().
+int qhy_alpaca_camera::begin_exposure(double duration_seconds)
+{
+  if (_readout_pending)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "An exposure is already in progress");
+  if (_live_mode)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Live mode is running, stop it first");
+
+  auto phase_start = std::chrono::steady_clock::now();
+  auto exposure_start = phase_start;
+  auto end_phase = [&](const char *phase) {
+    auto now = std::chrono::steady_clock::now();
+    _exposure_start_timings.record(phase, now - phase_start);
+    phase_start = now;
+  };
+
+  auto desired = desired_config(duration_seconds);
+  uint32_t sent = send_changed_config(desired, duration_seconds, end_phase);
+  uint32_t changed = _applied_config.diff(desired);
+
+  {
+    std::lock_guard lock(_cam_mutex);
+    _camera_state = camera_state_enum::CAMERA_EXPOSING;
+    _last_exposure_duration = duration_seconds;
+    _last_applied_settings = camera_config_fields_to_string(sent);
+  }
+  spdlog::debug("Setting exposure to: {} seconds", duration_seconds);
+  spdlog::debug("Camera settings sent for this exposure: {}",
+                camera_config_fields_to_string(sent));
+
+  if (changed & CONFIG_EXPOSURE)
+  {
+    spdlog::trace("Exposure time in uSeconds: {}", desired.exposure_us);
+    uint32_t r = timed_sdk_call("SetQHYCCDParam(EXPOSURE)", [this, &desired]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_EXPOSURE,
+                            desired.exposure_us);
+    });
+    end_phase("exposure");
+
+    if (r != QHYCCD_SUCCESS)
+    {
+      spdlog::error("Failed to set exposure duration: {}", r);
+      std::lock_guard lock(_cam_mutex);
+      _camera_state = camera_state_enum::CAMERA_IDLE;
+      return -1;
+    }
+    _applied_config.mark_applied(desired, CONFIG_EXPOSURE);
+  }
+
+  spdlog::debug("Invoking ExpQHYCCDSingleFrame");
+  {
+    std::lock_guard lock(_cam_mutex);
+    _last_exposure_start_time = std::chrono::system_clock::now();
+    _last_exposure_start_time_fits =
+        fmt::format("{:%FT%T}", _last_exposure_start_time);
+  }
 
   spdlog::trace("Start time of exposure: {}", _last_exposure_start_time_fits);
 
@@ -1268,100 +1740,276 @@ int qhy_alpaca_camera::start_exposure_proc()
   spdlog::debug("  gain: {}", _gain);
   spdlog::debug("  exposure_duration: {}", _last_exposure_duration);
 
-  r = ExpQHYCCDSingleFrame(_cam_handle);
-  double remaining = GetQHYCCDExposureRemaining(_cam_handle);
-  spdlog::debug("Remaining exposure time: {} returned from GetQHYCCDExposureRemaining", remaining);
-  long wait_time = 0;
-  if (remaining > 0)
-    wait_time = _last_exposure_duration;
+  uint32_t r = timed_sdk_call("ExpQHYCCDSingleFrame", [this]() {
+    return ExpQHYCCDSingleFrame(_cam_handle);
+  });
+  end_phase("ExpQHYCCDSingleFrame");
+  _exposure_start_timings.record(
+      "total", std::chrono::steady_clock::now() - exposure_start);
 
-  spdlog::debug("ExpQHYCCDSingleFrame returned and {}s remaining", wait_time);
   if (r == QHYCCD_SUCCESS || r == QHYCCD_READ_DIRECTLY)
   {
-    __t.expires_after(asio::chrono::seconds(wait_time));
-    // This is a non blocking call that will call the read_image_from_camera after the timer expires
-    __t.async_wait(std::bind(&qhy_alpaca_camera::read_image_from_camera, this));
-    _io.run();
-    spdlog::debug("start_exposure_proc ended");
+    double remaining = GetQHYCCDExposureRemaining(_cam_handle);
+    spdlog::debug("Remaining exposure time: {} returned from GetQHYCCDExposureRemaining", remaining);
+    double wait_time = 0;
+    if (remaining > 0)
+      wait_time = duration_seconds;
+
+    spdlog::debug("ExpQHYCCDSingleFrame returned and {}s remaining", wait_time);
+    _readout_deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(wait_time));
+    _readout_pending = true;
     return 0;
   }
 
   spdlog::error("Failed to start exposing frame: {}", r);
-  uint8_t cam_status_buf[4] = {};
-
+  std::lock_guard lock(_cam_mutex);
+  _camera_state = camera_state_enum::CAMERA_IDLE;
   return -1;
 }
 
-// TODO: need to clean up the implementation
-// The threading code is a little kludgy at the moment
-int qhy_alpaca_camera::start_exposure(double duration_seconds, bool is_light)
+// Runs on the worker. The SDK only switches between single frame and live
+// mode on InitQHYCCD, so this goes through a full re-init and every setting
+// gets sent again.
+int qhy_alpaca_camera::begin_live(double exposure_seconds)
 {
-  throw_if_not_connected();
-  if (duration_seconds < exposure_min() || duration_seconds > exposure_max())
-    throw alpaca_exception(
-        alpaca_exception::INVALID_VALUE,
-        fmt::format("Exposure duration of {} is not within {} - {} seconds",
-                    duration_seconds, exposure_min(), exposure_max()));
-  spdlog::debug("Start_exposure invoked with duration: {}, is_light: {}",
-                duration_seconds, is_light);
+  if (_live_mode)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Live mode is already running");
+  if (_readout_pending)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "An exposure is in progress");
+
+  // Live frames are only the ROI, but GetQHYCCDLiveFrame gets no buffer
+  // size and may write more than that, same as a single frame. So the
+  // buffers are sized like single frame ones and resized to the frame once
+  // it's read. The hub's limit is set before anyone can subscribe to this
+  // session.
+  auto desired = desired_config(exposure_seconds);
+  size_t frame_bytes =
+      size_t(desired.num_x) * desired.num_y * ((_bpp + 7) / 8);
+  uint32_t mem_length = timed_sdk_call(
+      "GetQHYCCDMemLength", [this]() { return GetQHYCCDMemLength(_cam_handle); });
+  size_t buffer_bytes = std::max<size_t>(mem_length, frame_bytes);
+  size_t max_buffers = std::clamp<size_t>(
+      live_pool_budget_bytes / std::max<size_t>(buffer_bytes, 1), 4,
+      2 * live_max_queued_frames);
+  _live_frames.set_max_queued(max_buffers / 2);
+
+  _live_mode = true;
+  try
+  {
+    _stream_mode_changed = true;
+    uint32_t sent =
+        send_changed_config(desired, exposure_seconds, [](const char *) {});
+
+    uint32_t r = timed_sdk_call("SetQHYCCDParam(EXPOSURE)", [this, &desired]() {
+      return SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_EXPOSURE,
+                            desired.exposure_us);
+    });
+    if (r != QHYCCD_SUCCESS)
+      throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                             "Failed to set live exposure duration");
+    _applied_config.mark_applied(desired, CONFIG_EXPOSURE);
+
+    // A few buffers is plenty, the pool grows if readers hang on to more
+    _live_frame_pool = frame_buffer_pool_t::create(
+        4, buffer_bytes, true, _huge_page_frame_buffers, max_buffers);
+    _live_spare_buffer.reset();
+
+    r = timed_sdk_call("BeginQHYCCDLive",
+                       [this]() { return BeginQHYCCDLive(_cam_handle); });
+    if (r != QHYCCD_SUCCESS)
+      throw alpaca_exception(
+          alpaca_exception::DRIVER_ERROR,
+          fmt::format("BeginQHYCCDLive failed, err code: {}", r));
 
-  initialize();
+    // A few polls per frame, but not so often the worker just spins
+    _live_poll_interval = std::clamp<std::chrono::steady_clock::duration>(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(exposure_seconds / 4)),
+        std::chrono::microseconds(100), std::chrono::milliseconds(10));
+    _live_frame_count = 0;
 
-  int qhy_res = QHYCCD_ERROR;
-  if (_bin_changed)
+    std::lock_guard lock(_cam_mutex);
+    _last_exposure_duration = exposure_seconds;
+    _last_applied_settings = camera_config_fields_to_string(sent);
+  }
+  catch (...)
   {
-    qhy_res = SetQHYCCDBinMode(_cam_handle, _bin_x, _bin_x);
-    if (qhy_res == QHYCCD_ERROR)
-      spdlog::warn("failed to set bin mode");
-    _bin_changed = false;
+    _live_mode = false;
+    _stream_mode_changed = true;
+    _live_frame_pool.reset();
+    throw;
   }
 
-  set_resolution(_start_x, _start_y, _num_x, _num_y);
-
-  std::lock_guard lock(_cam_mutex);
-  _camera_state = camera_state_enum::CAMERA_EXPOSING;
-  spdlog::debug("Setting exposure to: {} seconds", duration_seconds);
+  spdlog::info("Live mode started: {}x{} bin {}, {}s exposure", _num_x, _num_y,
+               _bin_x, exposure_seconds);
+  return 0;
+}
 
-  _last_exposure_duration = duration_seconds;
+// Runs on the worker
+int qhy_alpaca_camera::end_live()
+{
+  if (!_live_mode)
+    return 0;
 
-  double u_seconds = duration_seconds * 1000000;
-  spdlog::trace("Exposure time in uSeconds: {}", u_seconds);
-  uint32_t r = 0;
+  uint32_t r = timed_sdk_call("StopQHYCCDLive",
+                              [this]() { return StopQHYCCDLive(_cam_handle); });
+  if (r != QHYCCD_SUCCESS)
+    spdlog::warn("StopQHYCCDLive failed, err code: {}", r);
 
-  r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_EXPOSURE, u_seconds);
+  _live_mode = false;
+  // Back to single frame mode with the next exposure
+  _stream_mode_changed = true;
+  _live_frames.close_all();
+  _live_spare_buffer.reset();
+  _live_frame_pool.reset();
+  spdlog::info("Live mode stopped after {} frames", _live_frame_count.load());
+  return r == QHYCCD_SUCCESS ? 0 : -1;
+}
 
-  if (r == QHYCCD_SUCCESS)
+// Runs on the worker. Returns false straight away if the camera doesn't have
+// a new frame yet.
+bool qhy_alpaca_camera::read_live_frame()
+{
+  if (!_live_spare_buffer)
   {
-    // Thread
-    // TODO: I think this thread is getting orphaned potentially which
-    // probably creates the memory leak / memory violation I'm seeing in
-    // valgrind
-    spdlog::debug("Creating start exposure thread");
-    _start_exposure_thread = std::thread(std::bind(&qhy_alpaca_camera::start_exposure_proc, this));
-    spdlog::debug("Start exposure thread created");
-    _start_exposure_thread.detach();
-    spdlog::debug("Start exposure thread detached");
-    return 0;
+    try
+    {
+      _live_spare_buffer =
+          _live_frame_pool->acquire(_live_frame_pool->buffer_size());
+    }
+    catch (alpaca_exception &ex)
+    {
+      // Every buffer is held by a slow reader. Leave the frame with the
+      // camera and try again next poll rather than ending live mode.
+      spdlog::debug("No buffer for live frame: {}", ex.what());
+      return false;
+    }
   }
-  spdlog::error("Failed to set exposure duration: {}", r);
-  _camera_state = camera_state_enum::CAMERA_IDLE;
-  return -1;
+
+  uint32_t w = 0;
+  uint32_t h = 0;
+  uint32_t bpp = 0;
+  uint32_t channels = 0;
+  // Not timed, nearly all of the calls are polls that come back empty
+  uint32_t r = GetQHYCCDLiveFrame(_cam_handle, &w, &h, &bpp, &channels,
+                                  _live_spare_buffer->data());
+  if (r != QHYCCD_SUCCESS)
+    return false;
+
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->buffer = std::move(_live_spare_buffer);
+  frame->pixel_type = (bpp == 8) ? image_array_element_types::BYTE
+                                 : image_array_element_types::UINT16;
+  frame->width = w;
+  frame->height = h;
+  frame->bayer_offset_x = _bayer_offset_x;
+  frame->bayer_offset_y = _bayer_offset_y;
+  frame->bin_x = _bin_x;
+  frame->bin_y = _bin_y;
+  frame->start_x = _start_x;
+  frame->start_y = _start_y;
+  frame->exposure_duration = _last_exposure_duration;
+  frame->gain = _gain;
+  frame->offset = _offset;
+  // The buffer is GetQHYCCDMemLength sized so the SDK can't have overrun
+  // it, this only catches it reporting a frame bigger than the sensor
+  if (frame->size_bytes() > frame->buffer->capacity())
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("live frame of {}x{} doesn't fit the {} byte buffer", w,
+                    h, frame->buffer->capacity()));
+  frame->buffer->resize(frame->size_bytes());
+
+  _live_frame_count++;
+  _live_frames.publish(frame);
+  return true;
 }
 
-// TODO: need to interrupt the exposing thread...
-int qhy_alpaca_camera::stop_exposure()
+int qhy_alpaca_camera::start_live(double exposure_seconds)
 {
   throw_if_not_connected();
-  uint32_t r = CancelQHYCCDExposing(_cam_handle);
-  _camera_state = camera_state_enum::CAMERA_IDLE;
-  if (r == QHYCCD_SUCCESS)
-  {
-    spdlog::debug(
-        "Successfully stopped exposure. Image data must be read now");
-    return 0;
+  if (exposure_seconds < exposure_min() || exposure_seconds > exposure_max())
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Exposure duration of {} is not within {} - {} seconds",
+                    exposure_seconds, exposure_min(), exposure_max()));
+  return run_on_worker("start_live", [this, exposure_seconds]() {
+    return begin_live(exposure_seconds);
+  });
+}
+
+int qhy_alpaca_camera::stop_live()
+{
+  throw_if_not_connected();
+  return run_on_worker("stop_live", [this]() { return end_live(); });
+}
+
+bool qhy_alpaca_camera::live() { return _live_mode; }
+
+live_subscription_ptr_t
+qhy_alpaca_camera::subscribe_live(size_t depth, std::function<void()> notify)
+{
+  throw_if_not_connected();
+  auto subscription = _live_frames.subscribe(depth, std::move(notify));
+  if (!subscription)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_OPERATION,
+        fmt::format("Live readers already queue {} frames between them",
+                    _live_frames.max_queued()));
+  // Checked after subscribing, otherwise live mode could stop in between and
+  // the subscription would never be closed
+  if (!_live_mode)
+  {
+    _live_frames.unsubscribe(subscription);
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Live mode is not running");
   }
-  spdlog::error("Problem stopping exposure: {}", r);
-  return -1;
+  return subscription;
+}
+
+size_t qhy_alpaca_camera::live_max_queued()
+{
+  return _live_frames.max_queued();
+}
+
+void qhy_alpaca_camera::unsubscribe_live(
+    const live_subscription_ptr_t &subscription)
+{
+  _live_frames.unsubscribe(subscription);
+}
+
+int qhy_alpaca_camera::start_exposure(double duration_seconds, bool is_light)
+{
+  throw_if_not_connected();
+  if (duration_seconds < exposure_min() || duration_seconds > exposure_max())
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Exposure duration of {} is not within {} - {} seconds",
+                    duration_seconds, exposure_min(), exposure_max()));
+  spdlog::debug("Start_exposure invoked with duration: {}, is_light: {}",
+                duration_seconds, is_light);
+
+  // This returns as soon as the SDK has started the exposure, the worker
+  // takes care of reading it out
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::START_EXPOSURE;
+  cmd.name = "start_exposure";
+  cmd.value = duration_seconds;
+  return run_on_worker(std::move(cmd));
+}
+
+int qhy_alpaca_camera::stop_exposure()
+{
+  throw_if_not_connected();
+  camera_command_t cmd;
+  cmd.type = camera_command_t::type_t::STOP_EXPOSURE;
+  cmd.name = "stop_exposure";
+  return run_on_worker(std::move(cmd));
 };
 
 // TODO: implement color specifics
@@ -1438,7 +2086,9 @@ int qhy_alpaca_camera::set_resolution(const uint32_t start_x,
                                        start_y, _effective_num_y));
   }
 
-  set_result = SetQHYCCDResolution(_cam_handle, start_x, start_y, num_x, num_y);
+  set_result = timed_sdk_call("SetQHYCCDResolution", [&]() {
+    return SetQHYCCDResolution(_cam_handle, start_x, start_y, num_x, num_y);
+  });
   if (set_result == QHYCCD_SUCCESS)
   {
     spdlog::trace("Successfully set QHYCCD Resolution {} x {}", num_x, num_y);
@@ -1502,18 +2152,22 @@ double qhy_alpaca_camera::subexposure_duration()
 int qhy_alpaca_camera::set_subexposure_duration(double duration_seconds)
 {
   throw_if_not_connected();
-  std::lock_guard lock(_cam_mutex);
-  double u_seconds = duration_seconds * 1000000;
-  spdlog::trace("Exposure time in uSeconds: {}", u_seconds);
-  uint32_t r = QHYCCD_ERROR;
+  return run_on_worker("set_subexposure_duration", [this, duration_seconds]() {
+    std::lock_guard lock(_cam_mutex);
+    double u_seconds = duration_seconds * 1000000;
+    spdlog::trace("Exposure time in uSeconds: {}", u_seconds);
+    uint32_t r = QHYCCD_ERROR;
 
-  r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_EXPOSURE, u_seconds);
-  if (r == QHYCCD_SUCCESS)
-  {
+    r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_EXPOSURE, u_seconds);
+    // The exposure time the diff tracker thinks the camera has is stale now
+    _applied_config.invalidate(CONFIG_EXPOSURE);
+    if (r == QHYCCD_SUCCESS)
+    {
 
-    return 0;
-  }
-  return -1;
+      return 0;
+    }
+    return -1;
+  });
 }
 
 bool qhy_alpaca_camera::can_fast_readout()
@@ -1580,35 +2234,17 @@ int qhy_alpaca_camera::set_gain(uint32_t gain)
 {
   throw_if_not_connected();
   std::lock_guard lock(_cam_mutex);
-  uint32_t r = QHYCCD_ERROR;
-
-  // Kinda janky - some of the qhy cameras have 0 as a gain option which means
-  // the "index" of the gains matches the gain value. In the case where the
-  // gain starts with 1 we must add 1 so that this fixes the off by one issue.
-  // This probably needs to be rewritten to not obfuscate the behavior as I
-  // this this does now.
-  int gain_val = gain;
-  if (_gains[0] == "1" && _gains_mode == "gains_index_mode")
-  {
-    gain_val = gain + 1;
-  }
 
-  if (gain_val >= _gain_min && gain_val <= _gain_max)
-  {
-    r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_GAIN, gain_val);
-    if (r == QHYCCD_SUCCESS)
-    {
-      _gain = gain;
-      return 0;
-    }
-  }
-  else
-  {
+  double gain_val = sdk_gain_value(gain);
+  if (gain_val < _gain_min || gain_val > _gain_max)
     throw alpaca_exception(
         alpaca_exception::INVALID_VALUE,
         fmt::format("Attempted to set gain out of range with {}", gain_val));
-  }
-  return -1;
+
+  // This only records the gain, it's sent to the camera at the start of the
+  // next exposure if it differs from what the camera already has
+  _gain = gain;
+  return 0;
 }
 
 int qhy_alpaca_camera::set_offset(int offset_v)
@@ -1619,13 +2255,10 @@ int qhy_alpaca_camera::set_offset(int offset_v)
     throw alpaca_exception(
         alpaca_exception::INVALID_VALUE,
         fmt::format("Offset {} provided is out of range", offset_v));
-  uint32_t r = SetQHYCCDParam(_cam_handle, CONTROL_OFFSET, offset_v);
-  if (r == QHYCCD_SUCCESS)
-  {
-    _offset = offset_v;
-    return 0;
-  }
-  return -1;
+
+  // Like gain, this goes out with the next exposure
+  _offset = offset_v;
+  return 0;
 }
 
 int qhy_alpaca_camera::offset()
@@ -1673,27 +2306,29 @@ int qhy_alpaca_camera::readout_mode()
 int qhy_alpaca_camera::set_readout_mode(int idx)
 {
   throw_if_not_connected();
-  // std::lock_guard lock(_cam_mutex);
-  spdlog::debug("set_readout_mode called with {}", idx);
-  if (idx < _read_mode_names.size())
-  {
-    if (idx != _readout_mode)
+  return run_on_worker("set_readout_mode", [&]() {
+    // std::lock_guard lock(_cam_mutex);
+    spdlog::debug("set_readout_mode called with {}", idx);
+    if (idx < _read_mode_names.size())
     {
-      _read_mode_changed = true;
-      _num_x = 0;
+      if (idx != _readout_mode)
+      {
+        _read_mode_changed = true;
+        _num_x = 0;
+      }
+      else
+        spdlog::debug("skipping initialization as read mode is not changed");
+
+      _readout_mode = idx;
+      initialize();
     }
     else
-      spdlog::debug("skipping initialization as read mode is not changed");
-
-    _readout_mode = idx;
-    initialize();
-  }
-  else
-  {
-    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
-                           "Readout mode not valid");
-  }
-  return 0;
+    {
+      throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                             "Readout mode not valid");
+    }
+    return 0;
+  });
 }
 
 std::vector<std::string> qhy_alpaca_camera::readout_modes()
@@ -1737,6 +2372,9 @@ std::vector<std::string> qhy_alpaca_camera::supported_actions()
   std::vector<std::string> supported_actions;
   supported_actions.push_back("setusbtraffic");
   supported_actions.push_back("getusbtraffic");
+  supported_actions.push_back("FrameStats");
+  supported_actions.push_back("StartLive");
+  supported_actions.push_back("StopLive");
   return supported_actions;
 }
 
@@ -1744,23 +2382,25 @@ std::vector<std::string> qhy_alpaca_camera::supported_actions()
 int qhy_alpaca_camera::set_cooler_power(double cooler_power)
 {
   throw_if_not_connected();
-  std::lock_guard lock(_cam_mutex);
-  double qhy_cooler_power = cooler_power / 100.0 * 255.0;
-  uint32_t r = QHYCCD_ERROR;
-  spdlog::debug("set_cooler_power invoked with {}", cooler_power);
-  r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_MANULPWM,
-                     qhy_cooler_power);
-  if (r == QHYCCD_SUCCESS)
-  {
-    _set_cooler_power = cooler_power;
-    return 0;
-  }
-  else
-  {
-    throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
-                           "Problem setting cooler power with SDK");
-  }
-  return -1;
+  return run_on_worker("set_cooler_power", [&]() {
+    std::lock_guard lock(_cam_mutex);
+    double qhy_cooler_power = cooler_power / 100.0 * 255.0;
+    uint32_t r = QHYCCD_ERROR;
+    spdlog::debug("set_cooler_power invoked with {}", cooler_power);
+    r = SetQHYCCDParam(_cam_handle, CONTROL_ID::CONTROL_MANULPWM,
+                       qhy_cooler_power);
+    if (r == QHYCCD_SUCCESS)
+    {
+      _set_cooler_power = cooler_power;
+      return 0;
+    }
+    else
+    {
+      throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                             "Problem setting cooler power with SDK");
+    }
+    return -1;
+  });
 }
 
 bool qhy_alpaca_camera::has_filter_wheel() { return _has_filter_wheel; }
@@ -1792,12 +2432,85 @@ int qhy_alpaca_camera::enable_offsets_value_mode()
   return 0;
 }
 
+int qhy_alpaca_camera::enable_huge_page_frame_buffers()
+{
+  _huge_page_frame_buffers = true;
+  return 0;
+}
+
+std::string qhy_alpaca_camera::frame_stats_action(
+    const std::map<std::string, std::string> &action_params)
+{
+  size_t histogram_bins = frame_stats_histogram_bins(action_params);
+
+  std::shared_future<frame_stats_t> stats;
+  {
+    std::lock_guard lock(_cam_mutex);
+    stats = _last_frame_stats;
+  }
+  if (!stats.valid())
+  {
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "No image has been taken");
+  }
+
+  if (stats.wait_for(std::chrono::seconds(30)) != std::future_status::ready)
+  {
+    throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                           "Timed out waiting for frame statistics");
+  }
+
+  try
+  {
+    return frame_stats_to_json(stats.get(), histogram_bins);
+  }
+  catch (std::exception &ex)
+  {
+    throw alpaca_exception(
+        alpaca_exception::DRIVER_ERROR,
+        fmt::format("Problem computing frame statistics: {}", ex.what()));
+  }
+}
+
 std::string qhy_alpaca_camera::invoke_action(
     const std::string &action_name,
     const std::map<std::string, std::string> &action_params)
 {
 
-  if (action_name == "getusbtraffic")
+  if (action_name == "FrameStats" || action_name == "framestats")
+  {
+    throw_if_not_connected();
+    return frame_stats_action(action_params);
+  }
+  else if (action_name == "StartLive" || action_name == "startlive")
+  {
+    // Parameters is the exposure for each frame in seconds
+    auto parameters = action_params.find("Parameters");
+    if (parameters == action_params.end() || parameters->second.empty())
+      throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                             "StartLive needs the exposure in Parameters");
+    double exposure_seconds = 0;
+    try
+    {
+      exposure_seconds = std::stod(parameters->second);
+    }
+    catch (std::exception &ex)
+    {
+      throw alpaca_exception(
+          alpaca_exception::INVALID_VALUE,
+          fmt::format("StartLive Parameters should be the exposure in "
+                      "seconds, got: {}",
+                      parameters->second));
+    }
+    start_live(exposure_seconds);
+    return "";
+  }
+  else if (action_name == "StopLive" || action_name == "stoplive")
+  {
+    stop_live();
+    return "";
+  }
+  else if (action_name == "getusbtraffic")
   {
     return std::to_string(_usb_traffic);
   }
@@ -1806,10 +2519,8 @@ std::string qhy_alpaca_camera::invoke_action(
     try
     {
       auto usb_traffic = atoi(action_params.at("Value").c_str());
-      auto res = SetQHYCCDParam(_cam_handle, CONTROL_USBTRAFFIC, usb_traffic);
-      if (res != QHYCCD_SUCCESS)
-        throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
-                               "Problem setting usb traffic");
+      // Sent to the camera with the next exposure
+      std::lock_guard lock(_cam_mutex);
       _usb_traffic = usb_traffic;
       return action_params.at("Value");
     }
@@ -1823,7 +2534,8 @@ std::string qhy_alpaca_camera::invoke_action(
               ex.what()));
     }
   }
-  return fmt::format("custom action {} invoked", action_name);
+  throw alpaca_exception(alpaca_exception::ACTION_NOT_IMPLEMENTED,
+                         fmt::format("Unknown action: {}", action_name));
 }
 
 std::map<std::string, device_variant_t> qhy_alpaca_camera::details()
@@ -1856,7 +2568,10 @@ std::map<std::string, device_variant_t> qhy_alpaca_camera::details()
     detail_map["OffsetMax"] = _offset_max;
     detail_map["OffsetMin"] = _offset_min;
   }
-  detail_map["Status"] = _camera_state;
+  {
+    std::lock_guard lock(_cam_mutex);
+    detail_map["Status"] = _camera_state;
+  }
   if (_can_control_cooler_power && _connected)
   {
     detail_map["CoolerPower"] = cooler_power();
@@ -1876,5 +2591,19 @@ std::map<std::string, device_variant_t> qhy_alpaca_camera::details()
   detail_map["StartY"] = _start_y;
   detail_map["ExposureMax"] = _exposure_max / 1000000;
   detail_map["ExposureMin"] = _exposure_min / 1000000;
+  detail_map["SDKTimings"] = _sdk_timings.summary();
+  // Where the time goes between StartExposure arriving and the SDK starting
+  // the exposure, broken down by the settings that had to be sent
+  detail_map["ExposureStartTimings"] = _exposure_start_timings.summary();
+  {
+    std::lock_guard lock(_cam_mutex);
+    detail_map["LastAppliedSettings"] = _last_applied_settings;
+  }
+  detail_map["Live"] = _live_mode.load();
+  if (_live_mode)
+  {
+    detail_map["LiveFrames"] = uint64_t(_live_frame_count);
+    detail_map["LiveSubscribers"] = _live_frames.subscriber_count();
+  }
   return detail_map;
 };
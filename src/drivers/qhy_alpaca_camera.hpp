@@ -2,19 +2,28 @@
 #define QHY_ALPACA_CAMERA_HPP
 
 #include "common/alpaca_exception.hpp"
+#include "common/call_timings.hpp"
+#include "common/camera_config.hpp"
+#include "common/camera_frame.hpp"
+#include "common/frame_stats.hpp"
+#include "common/live_frame_hub.hpp"
+#include "common/mpsc_queue.hpp"
+#include "common/worker_pool.hpp"
 #include "fmt/format.h"
 #include "interfaces/i_alpaca_camera.hpp"
 #include "qhy_alpaca_filterwheel.hpp"
 #include "spdlog/spdlog.h"
-#include <asio/io_context.hpp>
-#include <asio/steady_timer.hpp>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -77,10 +86,7 @@ public:
   double heat_sink_temperature();
 
   int image_array(std::vector<uint8_t> &theImage);
-
-  std::vector<std::vector<uint32_t>> image_2d();
-  std::vector<std::vector<uint32_t>> image_2d_8bpp();
-  std::vector<std::vector<uint32_t>> image_2d_16bpp();
+  camera_frame_ptr_t last_frame();
 
   bool image_ready();
   bool is_pulse_guiding();
@@ -165,11 +171,29 @@ public:
 
   int enable_gains_value_mode();
   int enable_offsets_value_mode();
+  int enable_huge_page_frame_buffers();
 
   std::string
   invoke_action(const std::string &action_name,
                 const std::map<std::string, std::string> &action_params);
 
+  // Live (video) mode. Frames come off the SDK's live API as fast as the
+  // camera produces them and go to subscribers rather than image_array. The
+  // bin / ROI / gain etc. in effect when live mode starts are used until it
+  // is stopped.
+  int start_live(double exposure_seconds);
+  int stop_live();
+  bool live();
+  // Slow subscribers lose frames, they never hold up the camera. The
+  // subscription is closed when live mode stops. depth is cut down so all
+  // the subscribers together queue at most live_max_queued() frames.
+  live_subscription_ptr_t subscribe_live(size_t depth,
+                                         std::function<void()> notify);
+  // How many frames the live readers may queue between them, which depends
+  // on the size of the frames in the current live session
+  size_t live_max_queued();
+  void unsubscribe_live(const live_subscription_ptr_t &subscription);
+
 private:
   void initialize_camera_by_camera_id(std::string &camera_id);
   void initialize();
@@ -217,18 +241,110 @@ private:
 
   double _last_exposure_duration;
   std::chrono::system_clock::time_point _last_exposure_start_time;
-  std::vector<uint8_t> _img_data;
-  std::thread _img_read_thread;
-  std::thread _start_exposure_thread;
-  std::thread _cooler_thread;
-  bool _run_cooler_thread;
-  void cooler_proc();
-  bool should_run_cooler_proc();
-  void ensure_temp_is_set();
+  camera_frame_ptr_t _last_frame;
+
+  // Stats for _last_frame are worked out in the background right after
+  // readout so the FrameStats action usually doesn't have to wait
+  std::shared_ptr<worker_pool_t> _stats_pool;
+  std::shared_future<frame_stats_t> _last_frame_stats;
+  void compute_last_frame_stats(camera_frame_ptr_t frame);
+  std::string
+  frame_stats_action(const std::map<std::string, std::string> &action_params);
+
+  // Two buffers so the next exposure can be read out while the last frame is
+  // still being downloaded
+  std::shared_ptr<frame_buffer_pool_t> _frame_pool;
+  bool _huge_page_frame_buffers;
+  void ensure_frame_pool(size_t buffer_size);
+
+  // All SDK calls happen on a single long lived worker thread. Requests from
+  // the web server threads are posted to it as commands, anything that needs
+  // an answer waits on the command's promise.
+  struct camera_command_t {
+    enum class type_t {
+      START_EXPOSURE,
+      ABORT_EXPOSURE,
+      STOP_EXPOSURE,
+      SET_COOLER,
+      CALL,
+      SHUTDOWN
+    };
+
+    type_t type = type_t::CALL;
+    // Exposure duration for START_EXPOSURE, on / off for SET_COOLER
+    double value = 0;
+    // Name used for timings and logging of CALL commands
+    std::string name;
+    std::function<int()> call;
+    std::shared_ptr<std::promise<int>> result;
+    std::chrono::steady_clock::time_point posted_at;
+  };
+
+  std::thread _worker_thread;
+  mpsc_queue_t<camera_command_t> _commands;
+  std::mutex _worker_mtx;
+  std::condition_variable _worker_cv;
+  bool _worker_wakeup;
+  // Set once SHUTDOWN is queued, post_command() throws NOT_CONNECTED after
+  bool _worker_stopping;
+  void camera_worker_proc();
+  void post_command(camera_command_t cmd);
+  int run_on_worker(camera_command_t cmd);
+  int run_on_worker(const std::string &name, std::function<int()> call);
+  void handle_command(camera_command_t &cmd);
+  int execute_command(camera_command_t &cmd);
+
+  // Only touched on the worker thread
+  bool _readout_pending;
+  std::chrono::steady_clock::time_point _readout_deadline;
+  std::chrono::steady_clock::time_point _next_housekeeping;
+
+  call_timings_t _sdk_timings;
+  template <typename F> auto timed_sdk_call(const char *name, F &&fn) {
+    return _sdk_timings.time(name, std::forward<F>(fn));
+  }
+
+  std::atomic<bool> _cooler_on;
+  void housekeeping();
+  void stop_worker();
   void read_image_from_camera();
-  int start_exposure_proc();
-  asio::io_context _io;
-  asio::steady_timer __t;
+  int begin_exposure(double duration_seconds);
+  uint32_t
+  send_changed_config(camera_config_t &desired, double duration_seconds,
+                      const std::function<void(const char *)> &end_phase);
+
+  // Live mode state, apart from the hub and _live_mode this is only touched
+  // on the worker
+  //
+  // The live pool holds twice what the subscribers can queue, which leaves
+  // a buffer for each of them to be sending one frame from and plenty over
+  // for the camera to read the next into. A stalled reader then only loses
+  // its own frames.
+  //
+  // How many that is comes from a byte budget rather than a frame count, a
+  // full frame from a big sensor can be over 100MB and the hub may be on a
+  // Pi with 4GB. Small ROIs still stop at live_max_queued_frames.
+  static constexpr size_t live_pool_budget_bytes = size_t(512) << 20;
+  static constexpr size_t live_max_queued_frames = 64;
+  bool _stream_mode_changed;
+  std::atomic<bool> _live_mode;
+  live_frame_hub_t _live_frames;
+  std::shared_ptr<frame_buffer_pool_t> _live_frame_pool;
+  frame_buffer_ptr_t _live_spare_buffer;
+  std::chrono::steady_clock::duration _live_poll_interval;
+  std::atomic<uint64_t> _live_frame_count;
+  int begin_live(double exposure_seconds);
+  int end_live();
+  bool read_live_frame();
+
+  // What the camera was last told, only touched on the worker. The desired
+  // side is just the member variables that the setters update.
+  camera_config_tracker_t _applied_config;
+  camera_config_t desired_config(double exposure_seconds);
+  double sdk_gain_value(uint32_t gain);
+  call_timings_t _exposure_start_timings;
+  std::string _last_applied_settings;
+  int cancel_exposure(bool discard_image);
   void set_reading_state();
   std::string _qhy_model_name;
   double _current_set_temp;
@@ -30,8 +30,12 @@ qhy_alpaca_filterwheel::qhy_alpaca_filterwheel(
     : _camera(camera), _connected(false), _driver_version("v0.1"),
       _description("QHY Filterwheel"), _name("QHYCFW3") {
 
+  // All SDK calls go through the camera's worker thread
   int num_of_filters =
-      (int)GetQHYCCDParam(_camera._cam_handle, CONTROL_ID::CONTROL_CFWSLOTSNUM);
+      _camera.run_on_worker("GetQHYCCDParam(CFWSLOTSNUM)", [this]() {
+        return (int)GetQHYCCDParam(_camera._cam_handle,
+                                   CONTROL_ID::CONTROL_CFWSLOTSNUM);
+      });
 
   // TODO: This should be driven off of what the filterwheel indicates is
   // actually there
@@ -53,7 +57,9 @@ qhy_alpaca_filterwheel::~qhy_alpaca_filterwheel() {
 int qhy_alpaca_filterwheel::position() {
   char fw_status = 0;
   uint32_t fw_res = QHYCCD_ERROR;
-  fw_res = GetQHYCCDCFWStatus(_camera._cam_handle, &fw_status);
+  fw_res = _camera.run_on_worker("GetQHYCCDCFWStatus", [this, &fw_status]() {
+    return (int)GetQHYCCDCFWStatus(_camera._cam_handle, &fw_status);
+  });
 
   if (fw_res == QHYCCD_SUCCESS)
     return fw_status - '0';
@@ -73,7 +79,9 @@ int qhy_alpaca_filterwheel::set_names(std::vector<std::string> names) {
 int qhy_alpaca_filterwheel::set_position(uint32_t position) {
   char pos = position + '0';
   uint32_t r = QHYCCD_ERROR;
-  r = SendOrder2QHYCCDCFW(_camera._cam_handle, &pos, 1);
+  r = _camera.run_on_worker("SendOrder2QHYCCDCFW", [this, &pos]() {
+    return (int)SendOrder2QHYCCDCFW(_camera._cam_handle, &pos, 1);
+  });
   return r;
 }
 
@@ -18,20 +18,18 @@ int qhy_alpaca_filterwheel_standalone::set_connected(bool connected) {
       spdlog::debug("Setting connected to true");
       spdlog::debug("Attempting to open serial device at {0}",
                     _serial_device_path);
-      _serial_port.open(_serial_device_path);
-      _serial_port.set_option(asio::serial_port_base::baud_rate(9600));
-      _serial_port.set_option(asio::serial_port_base::character_size(8));
-      _serial_port.set_option(asio::serial_port_base::flow_control(
-          asio::serial_port_base::flow_control::none));
-      _serial_port.set_option(
-          asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-      _serial_port.set_option(asio::serial_port_base::stop_bits(
-          asio::serial_port_base::stop_bits::one));
+      _serial->open(_serial_device_path, 9600);
 
       _connected = true;
 
-      _filterwheel_update_thread = std::thread(std::bind(
-          &qhy_alpaca_filterwheel_standalone::update_properties_proc, this));
+      // The filterwheel needs a while after the port opens before it
+      // answers, initialize() happens on the first poll
+      using namespace std::chrono_literals;
+      _initialized = false;
+      _update_task = alpaca_hub_serial::serial_reactor::instance().schedule(
+          std::bind(&qhy_alpaca_filterwheel_standalone::update_properties_proc,
+                    this),
+          30s);
 
       return 0;
     } catch (asio::system_error &e) {
@@ -47,8 +45,8 @@ int qhy_alpaca_filterwheel_standalone::set_connected(bool connected) {
       spdlog::debug("Setting connected to false");
       if (_connected) {
         _connected = false;
-        _filterwheel_update_thread.join();
-        _serial_port.close();
+        _update_task->stop();
+        _serial->close();
       }
       _connected = false;
       return 0;
@@ -100,27 +98,16 @@ std::string qhy_alpaca_filterwheel_standalone::send_command_to_filterwheel(
   try {
     spdlog::trace("sending: {} to filterwheel", cmd);
     std::lock_guard lock(_filterwheel_mtx);
-    char buf[512] = {0};
-    if (cmd.length() > 0)
-      _serial_port.write_some(asio::buffer(cmd));
-    std::string rsp;
-
-    if (n_chars_to_read > 0) {
-      _io_context.reset();
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context, false);
-      char c;
-      int n_chars_read = 0;
-      while (reader.read_char(c)) {
-        n_chars_read++;
-        // spdlog::trace("char read: {}", c);
-        rsp += c;
-        if (n_chars_read == n_chars_to_read) {
-          break;
-        }
-      }
-    }
+    alpaca_hub_serial::serial_request_t request{cmd};
+
+    if (n_chars_to_read > 0)
+      request.frame_length = alpaca_hub_serial::fixed_length(n_chars_to_read);
+    // A move only answers once the wheel stops so its reply time says
+    // nothing about the link, everything else gets an adaptive timeout
+    if (cmd.size() > 1)
+      request.family = alpaca_hub_serial::command_family(cmd);
+
+    auto rsp = _serial->transact(std::move(request)).frame;
 
     spdlog::trace("filterwheel returned: {}", rsp);
     return rsp;
@@ -133,17 +120,12 @@ std::string qhy_alpaca_filterwheel_standalone::send_command_to_filterwheel(
 
 void qhy_alpaca_filterwheel_standalone::initialize() {
   spdlog::debug("Initializing filterwheel");
-  using namespace std::chrono_literals;
-  std::this_thread::sleep_for(30s);
   spdlog::debug("Flushing serial receive and transmit buffer");
-  auto res = ::tcflush(_serial_port.lowest_layer().native_handle(), TCIOFLUSH);
-
-  if (res != 0) {
-    asio::system_error serial_error;
-    serial_error = asio::error_code(errno, asio::error::get_system_category());
-    spdlog::error("problem flushing serial port: {}", serial_error.what());
-  } else {
+  try {
+    _serial->flush();
     spdlog::debug("successfully flushed serial port");
+  } catch (asio::system_error &serial_error) {
+    spdlog::error("problem flushing serial port: {}", serial_error.what());
   }
 
   auto resp = send_command_to_filterwheel("VRS", 8);
@@ -166,50 +148,43 @@ void qhy_alpaca_filterwheel_standalone::initialize() {
   }
 }
 
-void qhy_alpaca_filterwheel_standalone::update_properties_proc() {
+std::chrono::milliseconds
+qhy_alpaca_filterwheel_standalone::update_properties_proc() {
   using namespace std::chrono_literals;
 
-  initialize();
-  std::string resp;
-  while (_connected) {
-    if (!_busy) {
-      resp = send_command_to_filterwheel("NOW", 1);
-      _position = std::atoi(resp.data());
-      std::this_thread::sleep_for(1000ms);
-    } else {
-      // TODO: the mechanics of this are a little janky...needs some
-      // rework
-      spdlog::trace("Filterwheel is busy...waiting for idle");
-
-      std::string rsp;
-
-      _io_context.reset();
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader("CHECKING RECV", _serial_port,
-                                                100, _io_context, false);
-      char c;
-      int n_chars_to_read = 1;
-      int n_chars_read = 0;
-      while (reader.read_char(c)) {
-        n_chars_read++;
-        // spdlog::trace("char read: {}", c);
-        rsp += c;
-        if (n_chars_read == n_chars_to_read) {
-          break;
-        }
-      }
+  if (!_initialized) {
+    initialize();
+    _initialized = true;
+  }
 
-      if (rsp.length() > 0)
-        _busy = false;
-    }
+  if (!_busy) {
+    auto resp = send_command_to_filterwheel("NOW", 1);
+    _position = std::atoi(resp.data());
+    return 1000ms;
   }
+
+  // TODO: the mechanics of this are a little janky...needs some
+  // rework
+  spdlog::trace("Filterwheel is busy...waiting for idle");
+
+  // Nothing to send, just listening for the move to finish
+  auto rsp = _serial->transact(
+      {"", alpaca_hub_serial::fixed_length(1), std::chrono::milliseconds(100)});
+
+  if (rsp.frame.length() > 0)
+    _busy = false;
+  // Straight back to listening if it's still moving
+  return 0ms;
 }
 
 qhy_alpaca_filterwheel_standalone::qhy_alpaca_filterwheel_standalone(
     const std::string &device_path)
     : _serial_device_path(device_path), _connected(false),
       _driver_version("v0.1"), _description("QHY Filterwheel Standalone"),
-      _name("QHYFW"), _serial_port(_io_context), _busy(false) {
+      _name("QHYFW"),
+      _serial(
+          alpaca_hub_serial::serial_reactor::instance().make_channel(false)),
+      _busy(false), _initialized(false) {
 
   // TODO: This should be driven off of what the filterwheel indicates is
   // actually there
@@ -222,7 +197,6 @@ qhy_alpaca_filterwheel_standalone::~qhy_alpaca_filterwheel_standalone() {
   try {
     if (_connected) {
       set_connected(false);
-      // _filterwheel_update_thread.join();
     }
   } catch (std::exception &ex) {
     spdlog::error("Problem: {}", ex.what());
@@ -278,5 +252,6 @@ qhy_alpaca_filterwheel_standalone::details() {
     detail_map["Names"] = names();
     detail_map["FocusOffsets"] = focus_offsets();
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
   return detail_map;
 };
@@ -4,6 +4,7 @@
 #include "asio/io_context.hpp"
 #include "common/alpaca_exception.hpp"
 #include "common/alpaca_hub_serial.hpp"
+#include "common/serial_reactor.hpp"
 #include "interfaces/i_alpaca_filterwheel.hpp"
 #include <vector>
 
@@ -33,7 +34,8 @@ public:
 
 private:
   void initialize();
-  void update_properties_proc();
+  // Run by the serial reactor, returns when to run next
+  std::chrono::milliseconds update_properties_proc();
   std::string send_command_to_filterwheel(
     const std::string &cmd, int n_chars_to_read);
   bool _connected;
@@ -46,12 +48,12 @@ private:
   std::string _unique_id;
   std::vector<int> _focus_offsets;
   std::vector<std::string> _names;
-  asio::io_context _io_context;
-  asio::serial_port _serial_port;
+  alpaca_hub_serial::serial_channel_ptr_t _serial;
   std::mutex _filterwheel_mtx;
   int _position;
   bool _busy;
-  std::thread _filterwheel_update_thread;
+  bool _initialized;
+  alpaca_hub_serial::polled_task_ptr_t _update_task;
 };
 
 #endif
@@ -0,0 +1,100 @@
+#include "simulated_axis.hpp"
+#include <algorithm>
+#include <cmath>
+
+simulated_axis_t::simulated_axis_t(double max_velocity, double acceleration,
+                                   double position)
+    : _max_velocity(max_velocity), _acceleration(acceleration),
+      _from(position), _to(position), _ramp_time(0), _cruise_time(0),
+      _peak_velocity(0), _run_velocity(0), _started(sim_clock_t::now()) {}
+
+double simulated_axis_t::travelled(double t) const {
+  if (t <= 0)
+    return 0;
+  if (t < _ramp_time)
+    return 0.5 * _acceleration * t * t;
+
+  double ramp_distance = 0.5 * _peak_velocity * _ramp_time;
+  t -= _ramp_time;
+  if (t < _cruise_time)
+    return ramp_distance + _peak_velocity * t;
+
+  t = std::min(t - _cruise_time, _ramp_time);
+  return ramp_distance + _peak_velocity * _cruise_time + _peak_velocity * t -
+         0.5 * _acceleration * t * t;
+}
+
+double simulated_axis_t::position(sim_clock_t::time_point now) const {
+  double t = std::chrono::duration<double>(now - _started).count();
+  if (_run_velocity != 0)
+    return _from + _run_velocity * std::max(t, 0.0);
+
+  // Checking the time rather than the distance so rounding can't leave it
+  // a hair short of the target for good
+  if (t >= 2 * _ramp_time + _cruise_time)
+    return _to;
+  double done = std::min(travelled(t), std::abs(_to - _from));
+  return _to > _from ? _from + done : _from - done;
+}
+
+double simulated_axis_t::target(sim_clock_t::time_point now) const {
+  return _run_velocity != 0 ? position(now) : _to;
+}
+
+bool simulated_axis_t::moving(sim_clock_t::time_point now) const {
+  return _run_velocity != 0 || position(now) != _to;
+}
+
+std::chrono::duration<double>
+simulated_axis_t::move_to(double target, sim_clock_t::time_point now) {
+  // Starting off from standstill even if it was moving, close enough
+  _from = position(now);
+  _to = target;
+  _run_velocity = 0;
+  _started = now;
+
+  // Trapezoidal if there's room to get up to speed, triangular if not
+  double distance = std::abs(_to - _from);
+  double ramp_time = _max_velocity / _acceleration;
+  double ramp_distance = 0.5 * _max_velocity * ramp_time;
+  if (distance >= 2 * ramp_distance) {
+    _ramp_time = ramp_time;
+    _peak_velocity = _max_velocity;
+    _cruise_time = (distance - 2 * ramp_distance) / _max_velocity;
+  } else {
+    _ramp_time = std::sqrt(distance / _acceleration);
+    _peak_velocity = _acceleration * _ramp_time;
+    _cruise_time = 0;
+  }
+  return std::chrono::duration<double>(2 * _ramp_time + _cruise_time);
+}
+
+void simulated_axis_t::run(double velocity, sim_clock_t::time_point now) {
+  _from = _to = position(now);
+  _run_velocity = velocity;
+  _started = now;
+}
+
+void simulated_axis_t::stop(sim_clock_t::time_point now) {
+  _from = _to = position(now);
+  _run_velocity = 0;
+  _started = now;
+}
+
+void simulated_axis_t::set_position(double position) {
+  _from = _to = position;
+  _run_velocity = 0;
+  _started = sim_clock_t::now();
+}
+
+void simulated_axis_t::set_limits(double max_velocity, double acceleration) {
+  // A move that's under way carries on from where it has got to at the new
+  // speed
+  auto now = sim_clock_t::now();
+  double to = _to;
+  bool was_moving = _run_velocity == 0 && moving(now);
+  _max_velocity = max_velocity;
+  _acceleration = acceleration;
+  if (was_moving)
+    move_to(to, now);
+}
@@ -0,0 +1,57 @@
+#ifndef SIMULATED_AXIS_HPP
+#define SIMULATED_AXIS_HPP
+
+#include <chrono>
+
+// One motor for the simulated devices. Moves speed up at acceleration to
+// max_velocity, cruise and slow down again so they take as long as the real
+// thing would, and the position anywhere along the way is worked out from
+// the clock when asked for rather than by a thread stepping it along.
+//
+// The units are whatever the owner uses (steps, degrees, hours of RA). Not
+// thread safe, the owning device locks around it.
+class simulated_axis_t {
+public:
+  using sim_clock_t = std::chrono::steady_clock;
+
+  simulated_axis_t(double max_velocity, double acceleration,
+                   double position = 0);
+
+  double position(sim_clock_t::time_point now = sim_clock_t::now()) const;
+  // Where the current move ends, or position() if it isn't moving
+  double target(sim_clock_t::time_point now = sim_clock_t::now()) const;
+  bool moving(sim_clock_t::time_point now = sim_clock_t::now()) const;
+
+  // Returns how long the move will take
+  std::chrono::duration<double>
+  move_to(double target, sim_clock_t::time_point now = sim_clock_t::now());
+  // Runs at velocity until stopped, like MoveAxis. Skips the acceleration
+  // since the rates asked for are small.
+  void run(double velocity, sim_clock_t::time_point now = sim_clock_t::now());
+  // Stops dead where it is
+  void stop(sim_clock_t::time_point now = sim_clock_t::now());
+  // Stops and calls wherever it is position, e.g. for a sync
+  void set_position(double position);
+
+  void set_limits(double max_velocity, double acceleration);
+  double max_velocity() const { return _max_velocity; }
+
+private:
+  // Distance covered t seconds into the current move
+  double travelled(double t) const;
+
+  double _max_velocity;
+  double _acceleration;
+
+  double _from;
+  double _to;
+  // Seconds spent speeding up (and slowing down), and cruising
+  double _ramp_time;
+  double _cruise_time;
+  double _peak_velocity;
+  // Non zero while run()ing
+  double _run_velocity;
+  sim_clock_t::time_point _started;
+};
+
+#endif
@@ -0,0 +1,749 @@
+#include "simulated_camera.hpp"
+#include "common/frame_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+constexpr double ambient_temperature = 20;
+// Deepest a TEC gets below ambient
+constexpr double max_cooling = 35;
+constexpr uint32_t simulated_gain_max = 300;
+constexpr int simulated_offset_max = 255;
+} // namespace
+
+simulated_camera::simulated_camera(simulated_camera_config_t config)
+    : _config(config), _star_field([&config]() {
+        star_field_config_t field;
+        field.width = config.width;
+        field.height = config.height;
+        field.star_count = config.star_count;
+        field.seed = config.seed;
+        return field;
+      }()),
+      _shutdown(false), _connected(false), _bin(1), _num_x(config.width),
+      _num_y(config.height), _start_x(0), _start_y(0), _gain(0), _offset(0),
+      _subexposure_duration(0), _camera_state(CAMERA_IDLE),
+      _exposure_requested(false), _cancel(cancel_enum::none),
+      _image_ready(false), _exposure_duration(0), _last_exposure_duration(0),
+      _frame_count(0), _cooler_on(false), _set_temperature(0),
+      _temperature(ambient_temperature),
+      _temperature_updated(sim_clock_t::now()) {
+  // Two buffers like the QHY driver so a frame can still be downloading
+  // while the next one is read out, and the same limit of four. Nothing to
+  // DMA into so no page locking.
+  _frame_pool = frame_buffer_pool_t::create(
+      2, size_t(config.width) * config.height * (config.bpp > 8 ? 2 : 1),
+      false, false, 4);
+  _camera_thread = std::thread(&simulated_camera::camera_proc, this);
+}
+
+simulated_camera::~simulated_camera() {
+  {
+    std::lock_guard lock(_camera_mtx);
+    _shutdown = true;
+  }
+  _camera_cv.notify_all();
+  _camera_thread.join();
+}
+
+void simulated_camera::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Camera not connected");
+}
+
+// Caller holds _camera_mtx
+void simulated_camera::update_temperature(sim_clock_t::time_point now) {
+  double elapsed =
+      std::chrono::duration<double>(now - _temperature_updated).count();
+  _temperature_updated = now;
+
+  double target = ambient_temperature;
+  if (_cooler_on)
+    target = std::max(_set_temperature, ambient_temperature - max_cooling);
+
+  // Half a degree a second is roughly what a real TEC manages
+  double step = 0.5 * elapsed;
+  if (std::abs(target - _temperature) <= step)
+    _temperature = target;
+  else
+    _temperature += (target > _temperature) ? step : -step;
+}
+
+void simulated_camera::camera_proc() {
+  std::unique_lock lock(_camera_mtx);
+  while (true) {
+    _camera_cv.wait(lock,
+                    [this]() { return _shutdown || _exposure_requested; });
+    if (_shutdown)
+      return;
+    _exposure_requested = false;
+
+    _camera_cv.wait_until(lock, _exposure_end, [this]() {
+      return _shutdown || _cancel != cancel_enum::none;
+    });
+    if (_shutdown)
+      return;
+    if (_cancel == cancel_enum::abort) {
+      _cancel = cancel_enum::none;
+      _camera_state = CAMERA_IDLE;
+      continue;
+    }
+
+    auto now = sim_clock_t::now();
+    double exposed = _exposure_duration;
+    if (_cancel == cancel_enum::stop)
+      exposed = std::chrono::duration<double>(now - _exposure_start).count();
+    _cancel = cancel_enum::none;
+    _camera_state = CAMERA_READING;
+
+    auto frame = std::make_shared<camera_frame_t>();
+    frame->pixel_type = _config.bpp > 8 ? image_array_element_types::UINT16
+                                        : image_array_element_types::BYTE;
+    frame->width = _num_x;
+    frame->height = _num_y;
+    frame->bin_x = frame->bin_y = _bin;
+    frame->start_x = _start_x;
+    frame->start_y = _start_y;
+    frame->exposure_duration = exposed;
+    frame->exposure_start_time = _last_exposure_start_time;
+    frame->gain = _gain;
+    frame->offset = _offset;
+    uint64_t sequence = _frame_count;
+
+    // Readout scales with the pixels actually read
+    double fraction = double(frame->num_pixels()) * _bin * _bin /
+                      (double(_config.width) * _config.height);
+    auto readout_end =
+        now + std::chrono::duration_cast<sim_clock_t::duration>(
+                  _config.readout_time * fraction);
+
+    // Rendering counts towards the readout time, it's done without the lock
+    // so the getters don't stall on it
+    lock.unlock();
+    try {
+      frame->buffer = _frame_pool->acquire(frame->size_bytes());
+    } catch (alpaca_exception &ex) {
+      // Same as the QHY driver when the readout fails
+      spdlog::error("Problem reading image from camera: {}", ex.what());
+      lock.lock();
+      _camera_state = CAMERA_ERROR;
+      continue;
+    }
+    frame->buffer->resize(frame->size_bytes());
+    _star_field.render(*frame, exposed, frame->gain, frame->offset, sequence,
+                       std::pow(2, _config.bpp) - 1);
+    lock.lock();
+
+    _camera_cv.wait_until(lock, readout_end, [this]() {
+      return _shutdown || _cancel == cancel_enum::abort;
+    });
+    if (_shutdown)
+      return;
+    if (_cancel == cancel_enum::abort) {
+      _cancel = cancel_enum::none;
+      _camera_state = CAMERA_IDLE;
+      continue;
+    }
+
+    _last_frame = std::move(frame);
+    _last_exposure_duration = exposed;
+    _image_ready = true;
+    _frame_count++;
+    _camera_state = CAMERA_IDLE;
+  }
+}
+
+std::map<std::string, device_variant_t> simulated_camera::details() {
+  std::lock_guard lock(_camera_mtx);
+  update_temperature(sim_clock_t::now());
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  detail_map["Status"] = int(_camera_state);
+  detail_map["BinX"] = _bin;
+  detail_map["BinY"] = _bin;
+  detail_map["NumX"] = _num_x;
+  detail_map["NumY"] = _num_y;
+  detail_map["StartX"] = _start_x;
+  detail_map["StartY"] = _start_y;
+  detail_map["Gain"] = _gain;
+  detail_map["Offset"] = _offset;
+  detail_map["CoolerOn"] = _cooler_on;
+  detail_map["SetTemp"] = _set_temperature;
+  detail_map["CCDTemperature"] = _temperature;
+  detail_map["Frames"] = _frame_count;
+  detail_map["Stars"] = uint32_t(_star_field.stars().size());
+  detail_map["FreeFrameBuffers"] = _frame_pool->free_count();
+  return detail_map;
+}
+
+bool simulated_camera::connected() { return _connected; }
+
+int simulated_camera::set_connected(bool connected) {
+  std::lock_guard lock(_camera_mtx);
+  _connected = connected;
+  return 0;
+}
+
+std::string simulated_camera::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_camera::interface_version() { return 3; }
+
+std::string simulated_camera::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_camera::supported_actions() {
+  return {"FrameStats"};
+}
+
+std::string simulated_camera::description() {
+  return fmt::format("Simulated {}x{} camera", _config.width,
+                     _config.height);
+}
+
+std::string simulated_camera::driverinfo() {
+  return "AlpacaHub Camera Simulator";
+}
+
+std::string simulated_camera::name() { return _config.name; }
+
+short simulated_camera::bin_x() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _bin;
+}
+
+short simulated_camera::bin_y() { return bin_x(); }
+
+// Symmetric binning only, same as the QHY cameras
+int simulated_camera::set_bin_x(short bin) {
+  throw_if_not_connected();
+  if (bin < 1 || bin > _config.max_bin)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("Bin of {} is not within 1 - {}", bin,
+                                       _config.max_bin));
+  std::lock_guard lock(_camera_mtx);
+  _bin = bin;
+  return 0;
+}
+
+int simulated_camera::set_bin_y(short bin) { return set_bin_x(bin); }
+
+i_alpaca_camera::camera_state_enum simulated_camera::camera_state() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _camera_state;
+}
+
+long simulated_camera::camera_x_size() {
+  throw_if_not_connected();
+  return _config.width;
+}
+
+long simulated_camera::camera_y_size() {
+  throw_if_not_connected();
+  return _config.height;
+}
+
+bool simulated_camera::can_abort_exposure() {
+  throw_if_not_connected();
+  return true;
+}
+
+bool simulated_camera::can_asymmetric_bin() {
+  throw_if_not_connected();
+  return false;
+}
+
+bool simulated_camera::can_get_cooler_power() {
+  throw_if_not_connected();
+  return true;
+}
+
+bool simulated_camera::can_pulse_guide() { return false; }
+
+bool simulated_camera::can_set_ccd_temperature() {
+  throw_if_not_connected();
+  return true;
+}
+
+bool simulated_camera::can_stop_exposure() {
+  throw_if_not_connected();
+  return true;
+}
+
+double simulated_camera::ccd_temperature() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  update_temperature(sim_clock_t::now());
+  return _temperature;
+}
+
+bool simulated_camera::cooler_on() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _cooler_on;
+}
+
+int simulated_camera::set_cooler_on(bool cooler_on) {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  update_temperature(sim_clock_t::now());
+  _cooler_on = cooler_on;
+  return 0;
+}
+
+int simulated_camera::set_cooler_power(double) {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Cooler power follows the set point");
+}
+
+// What it takes to hold the sensor this far below ambient
+double simulated_camera::cooler_power() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  update_temperature(sim_clock_t::now());
+  if (!_cooler_on)
+    return 0;
+  return std::clamp((ambient_temperature - _temperature) / max_cooling * 100,
+                    0.0, 100.0);
+}
+
+double simulated_camera::electrons_per_adu() {
+  throw_if_not_connected();
+  return 1.0;
+}
+
+double simulated_camera::full_well_capacity() {
+  throw_if_not_connected();
+  return 63700;
+}
+
+bool simulated_camera::has_shutter() { return false; }
+
+double simulated_camera::heat_sink_temperature() {
+  throw_if_not_connected();
+  return ambient_temperature;
+}
+
+int simulated_camera::image_array(std::vector<uint8_t> &theImage) {
+  auto frame = last_frame();
+  if (!frame) {
+    theImage.clear();
+    return 0;
+  }
+  theImage.assign(frame->data(), frame->data() + frame->data_size());
+  return 0;
+}
+
+camera_frame_ptr_t simulated_camera::last_frame() {
+  std::lock_guard lock(_camera_mtx);
+  return _last_frame;
+}
+
+bool simulated_camera::image_ready() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _image_ready;
+}
+
+bool simulated_camera::is_pulse_guiding() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Pulse guiding is not supported");
+}
+
+std::string simulated_camera::last_error() { return ""; }
+
+double simulated_camera::last_exposure_duration() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  if (!_last_frame)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "No image has been taken");
+  return _last_exposure_duration;
+}
+
+std::string simulated_camera::last_exposure_start_time() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  if (!_last_frame)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "No image has been taken");
+  return _last_frame->exposure_start_time;
+}
+
+long simulated_camera::max_adu() {
+  throw_if_not_connected();
+  return std::pow(2, _config.bpp) - 1;
+}
+
+short simulated_camera::max_bin_x() {
+  throw_if_not_connected();
+  return _config.max_bin;
+}
+
+short simulated_camera::max_bin_y() { return max_bin_x(); }
+
+long simulated_camera::num_x() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _num_x;
+}
+
+long simulated_camera::num_y() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _num_y;
+}
+
+// The window is checked against the sensor when the exposure starts, as
+// Alpaca has the bin and window set in any order
+int simulated_camera::set_num_x(long num_x) {
+  throw_if_not_connected();
+  if (num_x < 1)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "NumX must be greater than 0");
+  std::lock_guard lock(_camera_mtx);
+  _num_x = num_x;
+  return 0;
+}
+
+int simulated_camera::set_num_y(long num_y) {
+  throw_if_not_connected();
+  if (num_y < 1)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "NumY must be greater than 0");
+  std::lock_guard lock(_camera_mtx);
+  _num_y = num_y;
+  return 0;
+}
+
+double simulated_camera::pixel_size_x() {
+  throw_if_not_connected();
+  return _config.pixel_size;
+}
+
+double simulated_camera::pixel_size_y() { return pixel_size_x(); }
+
+int simulated_camera::set_ccd_temperature(double temperature) {
+  throw_if_not_connected();
+  if (temperature < -50 || temperature > 50)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Set point of {} is not within -50 - 50", temperature));
+  std::lock_guard lock(_camera_mtx);
+  update_temperature(sim_clock_t::now());
+  _set_temperature = temperature;
+  return 0;
+}
+
+double simulated_camera::get_set_ccd_temperature() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _set_temperature;
+}
+
+long simulated_camera::start_x() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _start_x;
+}
+
+int simulated_camera::set_start_x(long start_x) {
+  throw_if_not_connected();
+  if (start_x < 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "StartX can't be negative");
+  std::lock_guard lock(_camera_mtx);
+  _start_x = start_x;
+  return 0;
+}
+
+long simulated_camera::start_y() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _start_y;
+}
+
+int simulated_camera::set_start_y(long start_y) {
+  throw_if_not_connected();
+  if (start_y < 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "StartY can't be negative");
+  std::lock_guard lock(_camera_mtx);
+  _start_y = start_y;
+  return 0;
+}
+
+int simulated_camera::abort_exposure() {
+  throw_if_not_connected();
+  {
+    std::lock_guard lock(_camera_mtx);
+    if (_camera_state == CAMERA_EXPOSING || _camera_state == CAMERA_READING)
+      _cancel = cancel_enum::abort;
+  }
+  _camera_cv.notify_all();
+  return 0;
+}
+
+int simulated_camera::pulse_guide(guide_direction, long) {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Pulse guiding not supported");
+}
+
+int simulated_camera::start_exposure(double duration_seconds, bool) {
+  throw_if_not_connected();
+  if (duration_seconds < exposure_min() || duration_seconds > exposure_max())
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Exposure duration of {} is not within {} - {} seconds",
+                    duration_seconds, exposure_min(), exposure_max()));
+
+  {
+    std::lock_guard lock(_camera_mtx);
+    // A failed readout leaves it in CAMERA_ERROR, that shouldn't stop the
+    // next exposure
+    if (_camera_state != CAMERA_IDLE && _camera_state != CAMERA_ERROR)
+      throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                             "Camera is busy with another exposure");
+    if (_start_x + _num_x > _config.width / _bin ||
+        _start_y + _num_y > _config.height / _bin)
+      throw alpaca_exception(
+          alpaca_exception::INVALID_VALUE,
+          fmt::format("Window of {}x{} at {},{} doesn't fit the sensor at "
+                      "bin {}",
+                      _num_x, _num_y, _start_x, _start_y, _bin));
+
+    _exposure_duration = duration_seconds;
+    _exposure_start = sim_clock_t::now();
+    _exposure_end =
+        _exposure_start + std::chrono::duration_cast<sim_clock_t::duration>(
+                              std::chrono::duration<double>(duration_seconds));
+    _last_exposure_start_time =
+        fmt::format("{:%FT%T}", std::chrono::system_clock::now());
+    _image_ready = false;
+    _cancel = cancel_enum::none;
+    _camera_state = CAMERA_EXPOSING;
+    _exposure_requested = true;
+  }
+  _camera_cv.notify_all();
+  return 0;
+}
+
+int simulated_camera::stop_exposure() {
+  throw_if_not_connected();
+  {
+    std::lock_guard lock(_camera_mtx);
+    if (_camera_state == CAMERA_EXPOSING)
+      _cancel = cancel_enum::stop;
+  }
+  _camera_cv.notify_all();
+  return 0;
+}
+
+double simulated_camera::exposure_max() { return 3600; }
+
+double simulated_camera::exposure_min() { return 0.0001; }
+
+double simulated_camera::exposure_resolution() { return 0.000001; }
+
+double simulated_camera::subexposure_duration() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _subexposure_duration;
+}
+
+int simulated_camera::set_subexposure_duration(double duration_seconds) {
+  throw_if_not_connected();
+  if (duration_seconds < 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "SubExposureDuration can't be negative");
+  std::lock_guard lock(_camera_mtx);
+  _subexposure_duration = duration_seconds;
+  return 0;
+}
+
+bool simulated_camera::can_fast_readout() {
+  throw_if_not_connected();
+  return false;
+}
+
+bool simulated_camera::fast_readout() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Fast readout not implemented");
+}
+
+int simulated_camera::readout_mode() {
+  throw_if_not_connected();
+  return 0;
+}
+
+int simulated_camera::set_fast_readout(bool) {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Fast readout not implemented");
+}
+
+int simulated_camera::set_readout_mode(int mode) {
+  throw_if_not_connected();
+  if (mode != 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "Readout mode not valid");
+  return 0;
+}
+
+std::vector<std::string> simulated_camera::readout_modes() {
+  throw_if_not_connected();
+  return {"Standard"};
+}
+
+uint32_t simulated_camera::gain() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _gain;
+}
+
+uint32_t simulated_camera::gain_max() {
+  throw_if_not_connected();
+  return simulated_gain_max;
+}
+
+uint32_t simulated_camera::gain_min() {
+  throw_if_not_connected();
+  return 0;
+}
+
+// Gain value mode only
+std::vector<std::string> simulated_camera::gains() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Camera is in gain value mode");
+}
+
+int simulated_camera::set_gain(uint32_t gain) {
+  throw_if_not_connected();
+  if (gain > simulated_gain_max)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Attempted to set gain out of range with {}", gain));
+  std::lock_guard lock(_camera_mtx);
+  _gain = gain;
+  return 0;
+}
+
+int simulated_camera::sensor_type() {
+  throw_if_not_connected();
+  return 0;
+}
+
+std::string simulated_camera::sensor_name() {
+  throw_if_not_connected();
+  return "Simulated";
+}
+
+int simulated_camera::set_offset(int offset) {
+  throw_if_not_connected();
+  if (offset < 0 || offset > simulated_offset_max)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Offset {} provided is out of range", offset));
+  std::lock_guard lock(_camera_mtx);
+  _offset = offset;
+  return 0;
+}
+
+int simulated_camera::offset() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  return _offset;
+}
+
+int simulated_camera::offset_max() {
+  throw_if_not_connected();
+  return simulated_offset_max;
+}
+
+int simulated_camera::offset_min() {
+  throw_if_not_connected();
+  return 0;
+}
+
+std::vector<std::string> simulated_camera::offsets() {
+  throw_if_not_connected();
+  throw alpaca_exception(
+      alpaca_exception::NOT_IMPLEMENTED,
+      "Camera is in offset value mode. Use offset min and max");
+}
+
+std::string simulated_camera::get_camera_model_name() { return _config.name; }
+
+uint8_t simulated_camera::bpp() { return _config.bpp; }
+
+int simulated_camera::percent_complete() {
+  throw_if_not_connected();
+  std::lock_guard lock(_camera_mtx);
+  if (_camera_state == CAMERA_EXPOSING) {
+    double elapsed = std::chrono::duration<double>(sim_clock_t::now() -
+                                                   _exposure_start)
+                         .count();
+    return std::clamp(int(100 * elapsed / _exposure_duration), 0, 100);
+  }
+  return _camera_state == CAMERA_READING || _image_ready ? 100 : 0;
+}
+
+int simulated_camera::bayer_offset_x() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "This is a monochrome camera");
+}
+
+int simulated_camera::bayer_offset_y() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "This is a monochrome camera");
+}
+
+// Worked out when asked for rather than after every readout, the simulator
+// is usually there to load the server not to look at its frames
+std::string simulated_camera::frame_stats_action(
+    const std::map<std::string, std::string> &action_params) {
+  size_t histogram_bins = frame_stats_histogram_bins(action_params);
+
+  auto frame = last_frame();
+  if (!frame)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "No image has been taken");
+
+  std::shared_ptr<worker_pool_t> pool;
+  {
+    std::lock_guard lock(_camera_mtx);
+    if (!_stats_pool)
+      _stats_pool = std::make_shared<worker_pool_t>(
+          std::max(2u, std::thread::hardware_concurrency()) - 1);
+    pool = _stats_pool;
+  }
+  return frame_stats_to_json(compute_frame_stats(*frame, *pool),
+                             histogram_bins);
+}
+
+std::string simulated_camera::invoke_action(
+    const std::string &action_name,
+    const std::map<std::string, std::string> &action_params) {
+  if (action_name == "FrameStats" || action_name == "framestats") {
+    throw_if_not_connected();
+    return frame_stats_action(action_params);
+  }
+  throw alpaca_exception(alpaca_exception::ACTION_NOT_IMPLEMENTED,
+                         fmt::format("Unknown action: {}", action_name));
+}
+
+uint64_t simulated_camera::frame_count() {
+  std::lock_guard lock(_camera_mtx);
+  return _frame_count;
+}
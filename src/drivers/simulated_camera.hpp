@@ -0,0 +1,201 @@
+#ifndef SIMULATED_CAMERA_HPP
+#define SIMULATED_CAMERA_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "common/camera_frame.hpp"
+#include "common/frame_buffer_pool.hpp"
+#include "common/star_field.hpp"
+#include "common/worker_pool.hpp"
+#include "interfaces/i_alpaca_camera.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct simulated_camera_config_t {
+  std::string name = "Simulated Camera";
+  std::string unique_id = "simulated-camera-0";
+  // Unbinned, roughly an IMX294
+  uint32_t width = 4144;
+  uint32_t height = 2822;
+  double pixel_size = 4.63;
+  uint8_t bpp = 16;
+  short max_bin = 4;
+  // For a full frame, smaller windows and higher bins read out quicker
+  std::chrono::milliseconds readout_time{250};
+  uint32_t star_count = 400;
+  uint32_t seed = 1;
+};
+
+// A camera that exposes and reads out on the clock without any hardware.
+// Exposures run on the camera's own thread, frames are rendered from a
+// star_field_t into buffers from a frame_buffer_pool_t the same way the QHY
+// driver hands them out, and the cooler heads for its set point at about
+// the rate a real TEC does.
+class simulated_camera : public i_alpaca_camera {
+public:
+  explicit simulated_camera(simulated_camera_config_t config = {});
+  ~simulated_camera();
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  short bin_x();
+  short bin_y();
+  int set_bin_x(short);
+  int set_bin_y(short);
+  camera_state_enum camera_state();
+  long camera_x_size();
+  long camera_y_size();
+  bool can_abort_exposure();
+  bool can_asymmetric_bin();
+  bool can_get_cooler_power();
+  bool can_pulse_guide();
+  bool can_set_ccd_temperature();
+  bool can_stop_exposure();
+  double ccd_temperature();
+  bool cooler_on();
+  int set_cooler_on(bool);
+  int set_cooler_power(double);
+  double cooler_power();
+
+  double electrons_per_adu();
+  double full_well_capacity();
+  bool has_shutter();
+  double heat_sink_temperature();
+
+  int image_array(std::vector<uint8_t> &theImage);
+  camera_frame_ptr_t last_frame();
+  bool image_ready();
+  bool is_pulse_guiding();
+  std::string last_error();
+  double last_exposure_duration();
+  std::string last_exposure_start_time();
+  long max_adu();
+  short max_bin_x();
+  short max_bin_y();
+  long num_x();
+  long num_y();
+  int set_num_x(long);
+  int set_num_y(long);
+  double pixel_size_x();
+  double pixel_size_y();
+  int set_ccd_temperature(double);
+  double get_set_ccd_temperature();
+  long start_x();
+  int set_start_x(long);
+  long start_y();
+  int set_start_y(long);
+
+  int abort_exposure();
+  int pulse_guide(guide_direction, long duration);
+  int start_exposure(double, bool light_frame = true);
+  int stop_exposure();
+
+  double exposure_max();
+  double exposure_min();
+  double exposure_resolution();
+  double subexposure_duration();
+  int set_subexposure_duration(double);
+
+  bool can_fast_readout();
+  bool fast_readout();
+  int readout_mode();
+  int set_fast_readout(bool);
+  int set_readout_mode(int);
+  std::vector<std::string> readout_modes();
+
+  uint32_t gain();
+  uint32_t gain_max();
+  uint32_t gain_min();
+  std::vector<std::string> gains();
+  int set_gain(uint32_t);
+  int sensor_type();
+  std::string sensor_name();
+
+  int set_offset(int);
+  int offset();
+  int offset_max();
+  int offset_min();
+  std::vector<std::string> offsets();
+  std::string get_camera_model_name();
+  uint8_t bpp();
+
+  int percent_complete();
+  int bayer_offset_x();
+  int bayer_offset_y();
+
+  std::string
+  invoke_action(const std::string &action_name,
+                const std::map<std::string, std::string> &action_params);
+
+  // Frames read out since construction, for tests and benches
+  uint64_t frame_count();
+
+private:
+  using sim_clock_t = std::chrono::steady_clock;
+
+  // What stops an exposure early. Stopping still reads the frame out,
+  // aborting throws it away.
+  enum class cancel_enum { none, stop, abort };
+
+  void throw_if_not_connected();
+  void camera_proc();
+  // Caller holds _camera_mtx
+  void update_temperature(sim_clock_t::time_point now);
+  std::string frame_stats_action(
+      const std::map<std::string, std::string> &action_params);
+
+  simulated_camera_config_t _config;
+  star_field_t _star_field;
+  std::shared_ptr<frame_buffer_pool_t> _frame_pool;
+  std::shared_ptr<worker_pool_t> _stats_pool;
+
+  std::mutex _camera_mtx;
+  std::condition_variable _camera_cv;
+  std::thread _camera_thread;
+  bool _shutdown;
+
+  bool _connected;
+  short _bin;
+  // Binned pixels like Alpaca
+  uint32_t _num_x;
+  uint32_t _num_y;
+  uint32_t _start_x;
+  uint32_t _start_y;
+  uint32_t _gain;
+  int _offset;
+  double _subexposure_duration;
+
+  camera_state_enum _camera_state;
+  bool _exposure_requested;
+  cancel_enum _cancel;
+  bool _image_ready;
+  double _exposure_duration;
+  sim_clock_t::time_point _exposure_start;
+  sim_clock_t::time_point _exposure_end;
+  double _last_exposure_duration;
+  std::string _last_exposure_start_time;
+  camera_frame_ptr_t _last_frame;
+  uint64_t _frame_count;
+
+  bool _cooler_on;
+  double _set_temperature;
+  double _temperature;
+  sim_clock_t::time_point _temperature_updated;
+};
+
+#endif
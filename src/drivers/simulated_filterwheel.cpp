@@ -0,0 +1,106 @@
+#include "simulated_filterwheel.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+
+simulated_filterwheel::simulated_filterwheel(
+    simulated_filterwheel_config_t config)
+    : _config(config), _connected(false), _position(0),
+      _arrives_at(sim_clock_t::now()) {}
+
+void simulated_filterwheel::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Filter wheel not connected");
+}
+
+std::map<std::string, device_variant_t> simulated_filterwheel::details() {
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  if (_connected) {
+    detail_map["Position"] = position();
+    detail_map["Names"] = names();
+    detail_map["FocusOffsets"] = focus_offsets();
+  }
+  return detail_map;
+}
+
+bool simulated_filterwheel::connected() { return _connected; }
+
+int simulated_filterwheel::set_connected(bool connected) {
+  _connected = connected;
+  return 0;
+}
+
+std::string simulated_filterwheel::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_filterwheel::interface_version() { return 3; }
+
+std::string simulated_filterwheel::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_filterwheel::supported_actions() {
+  return {};
+}
+
+std::string simulated_filterwheel::description() {
+  return fmt::format("Simulated {} slot filter wheel",
+                     _config.names.size());
+}
+
+std::string simulated_filterwheel::driverinfo() {
+  return "AlpacaHub Filter Wheel Simulator";
+}
+
+std::string simulated_filterwheel::name() { return _config.name; }
+
+int simulated_filterwheel::position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_filterwheel_mtx);
+  if (sim_clock_t::now() < _arrives_at)
+    return -1;
+  return _position;
+}
+
+std::vector<std::string> simulated_filterwheel::names() {
+  throw_if_not_connected();
+  std::lock_guard lock(_filterwheel_mtx);
+  return _config.names;
+}
+
+int simulated_filterwheel::set_names(std::vector<std::string> names) {
+  throw_if_not_connected();
+  if (names.size() != _config.names.size())
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Need {} names, got {}", _config.names.size(),
+                    names.size()));
+  std::lock_guard lock(_filterwheel_mtx);
+  _config.names = std::move(names);
+  return 0;
+}
+
+// Returns straight away, position() says -1 until the wheel gets there
+int simulated_filterwheel::set_position(uint32_t position) {
+  throw_if_not_connected();
+  uint32_t slots = _config.names.size();
+  if (position >= slots)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Position {} is not within 0 - {}", position, slots - 1));
+
+  std::lock_guard lock(_filterwheel_mtx);
+  auto now = sim_clock_t::now();
+  // A new position while it's still turning starts from where it was
+  // headed, close enough
+  auto from = std::max(now, _arrives_at);
+  uint32_t distance = position > _position ? position - _position
+                                           : _position - position;
+  distance = std::min(distance, slots - distance);
+  _position = position;
+  _arrives_at = from + _config.slot_time * distance;
+  return 0;
+}
+
+std::vector<int> simulated_filterwheel::focus_offsets() {
+  throw_if_not_connected();
+  return _config.focus_offsets;
+}
@@ -0,0 +1,56 @@
+#ifndef SIMULATED_FILTERWHEEL_HPP
+#define SIMULATED_FILTERWHEEL_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "interfaces/i_alpaca_filterwheel.hpp"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct simulated_filterwheel_config_t {
+  std::string name = "Simulated Filter Wheel";
+  std::string unique_id = "simulated-filterwheel-0";
+  std::vector<std::string> names{"L", "R", "G", "B", "Ha", "OIII", "SII"};
+  std::vector<int> focus_offsets{0, 12, 8, 20, -15, -10, -18};
+  // How long it takes to turn by one slot, it always goes the short way
+  std::chrono::milliseconds slot_time{400};
+};
+
+// A filter wheel that reports -1 while it's turning like the QHY CFW does,
+// for as long as a wheel of that many slots would take.
+class simulated_filterwheel : public i_alpaca_filterwheel {
+public:
+  explicit simulated_filterwheel(simulated_filterwheel_config_t config = {});
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  int position();
+  std::vector<std::string> names();
+  int set_names(std::vector<std::string>);
+  int set_position(uint32_t);
+  std::vector<int> focus_offsets();
+
+private:
+  using sim_clock_t = std::chrono::steady_clock;
+
+  void throw_if_not_connected();
+
+  simulated_filterwheel_config_t _config;
+  std::mutex _filterwheel_mtx;
+  bool _connected;
+  uint32_t _position;
+  sim_clock_t::time_point _arrives_at;
+};
+
+#endif
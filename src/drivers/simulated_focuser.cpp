@@ -0,0 +1,129 @@
+#include "simulated_focuser.hpp"
+#include <cmath>
+#include <fmt/format.h>
+
+simulated_focuser::simulated_focuser(simulated_focuser_config_t config)
+    : _config(config), _connected(false),
+      _axis(config.speed, config.acceleration, config.start_position) {}
+
+void simulated_focuser::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Focuser not connected");
+}
+
+std::map<std::string, device_variant_t> simulated_focuser::details() {
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  if (_connected) {
+    detail_map["Position"] = position();
+    detail_map["IsMoving"] = is_moving();
+    detail_map["Temperature"] = temperature();
+  }
+  return detail_map;
+}
+
+bool simulated_focuser::connected() { return _connected; }
+
+int simulated_focuser::set_connected(bool connected) {
+  _connected = connected;
+  return 0;
+}
+
+std::string simulated_focuser::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_focuser::interface_version() { return 3; }
+
+std::string simulated_focuser::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_focuser::supported_actions() {
+  return {};
+}
+
+std::string simulated_focuser::description() {
+  return "Simulated absolute focuser";
+}
+
+std::string simulated_focuser::driverinfo() {
+  return "AlpacaHub Focuser Simulator";
+}
+
+std::string simulated_focuser::name() { return _config.name; }
+
+bool simulated_focuser::absolute() {
+  throw_if_not_connected();
+  return true;
+}
+
+bool simulated_focuser::is_moving() {
+  throw_if_not_connected();
+  std::lock_guard lock(_focuser_mtx);
+  return _axis.moving();
+}
+
+uint32_t simulated_focuser::max_increment() {
+  throw_if_not_connected();
+  return _config.max_step;
+}
+
+uint32_t simulated_focuser::max_step() {
+  throw_if_not_connected();
+  return _config.max_step;
+}
+
+uint32_t simulated_focuser::position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_focuser_mtx);
+  return uint32_t(std::lround(_axis.position()));
+}
+
+uint32_t simulated_focuser::step_size() {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Step size is not available");
+}
+
+bool simulated_focuser::temp_comp() {
+  throw_if_not_connected();
+  return false;
+}
+
+int simulated_focuser::set_temp_comp(bool) {
+  throw_if_not_connected();
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Temperature compensation is not available");
+}
+
+bool simulated_focuser::temp_comp_available() {
+  throw_if_not_connected();
+  return false;
+}
+
+// A slow swing of a couple of degrees every half hour or so
+double simulated_focuser::temperature() {
+  throw_if_not_connected();
+  double minutes =
+      std::chrono::duration<double, std::ratio<60>>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  return 15 + std::sin(minutes / 5) * 1.5;
+}
+
+int simulated_focuser::halt() {
+  throw_if_not_connected();
+  std::lock_guard lock(_focuser_mtx);
+  // Stop where it is, on a whole step
+  _axis.set_position(std::round(_axis.position()));
+  return 0;
+}
+
+int simulated_focuser::move(const int &pos) {
+  throw_if_not_connected();
+  if (pos < 0 || uint32_t(pos) > _config.max_step)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("Position {} is not within 0 - {}",
+                                       pos, _config.max_step));
+  std::lock_guard lock(_focuser_mtx);
+  _axis.move_to(pos);
+  return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef SIMULATED_FOCUSER_HPP
+#define SIMULATED_FOCUSER_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "interfaces/i_alpaca_focuser.hpp"
+#include "simulated_axis.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct simulated_focuser_config_t {
+  std::string name = "Simulated Focuser";
+  std::string unique_id = "simulated-focuser-0";
+  uint32_t max_step = 100000;
+  uint32_t start_position = 50000;
+  // Steps per second, and per second squared
+  double speed = 1000;
+  double acceleration = 4000;
+};
+
+// An absolute focuser that takes as long to get somewhere as the distance
+// and its speed say. The temperature wanders a little around 15C so there's
+// something to log.
+class simulated_focuser : public i_alpaca_focuser {
+public:
+  explicit simulated_focuser(simulated_focuser_config_t config = {});
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  bool absolute();
+  bool is_moving();
+  uint32_t max_increment();
+  uint32_t max_step();
+  uint32_t position();
+  uint32_t step_size();
+  bool temp_comp();
+  int set_temp_comp(bool);
+  bool temp_comp_available();
+  double temperature();
+  int halt();
+  int move(const int &pos);
+
+private:
+  void throw_if_not_connected();
+
+  simulated_focuser_config_t _config;
+  std::mutex _focuser_mtx;
+  bool _connected;
+  simulated_axis_t _axis;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "simulated_rotator.hpp"
+#include <cmath>
+#include <fmt/format.h>
+
+namespace {
+double wrap_degrees(double degrees) {
+  degrees = std::fmod(degrees, 360.0);
+  return degrees < 0 ? degrees + 360 : degrees;
+}
+
+void throw_if_out_of_range(double degrees) {
+  if (degrees < 0 || degrees >= 360)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Position {} is not within 0 - 360", degrees));
+}
+} // namespace
+
+simulated_rotator::simulated_rotator(simulated_rotator_config_t config)
+    : _config(config), _connected(false),
+      _axis(config.speed, config.acceleration), _sync_offset(0),
+      _reverse(false) {}
+
+void simulated_rotator::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Rotator not connected");
+}
+
+double simulated_rotator::sky_from_mechanical(double mechanical) {
+  return wrap_degrees(_sync_offset + (_reverse ? -mechanical : mechanical));
+}
+
+double simulated_rotator::mechanical_from_sky(double sky) {
+  double mechanical = sky - _sync_offset;
+  return wrap_degrees(_reverse ? -mechanical : mechanical);
+}
+
+void simulated_rotator::turn_to(double mechanical) {
+  double from = _axis.position();
+  _axis.move_to(from + std::remainder(mechanical - from, 360.0));
+}
+
+std::map<std::string, device_variant_t> simulated_rotator::details() {
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  if (_connected) {
+    detail_map["Position"] = position();
+    detail_map["MechanicalPosition"] = mechanical_position();
+    detail_map["TargetPosition"] = target_position();
+    detail_map["IsMoving"] = is_moving();
+    detail_map["Reverse"] = _reverse;
+  }
+  return detail_map;
+}
+
+bool simulated_rotator::connected() { return _connected; }
+
+int simulated_rotator::set_connected(bool connected) {
+  _connected = connected;
+  return 0;
+}
+
+std::string simulated_rotator::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_rotator::interface_version() { return 3; }
+
+std::string simulated_rotator::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_rotator::supported_actions() {
+  return {};
+}
+
+std::string simulated_rotator::description() { return "Simulated rotator"; }
+
+std::string simulated_rotator::driverinfo() {
+  return "AlpacaHub Rotator Simulator";
+}
+
+std::string simulated_rotator::name() { return _config.name; }
+
+bool simulated_rotator::can_reverse() {
+  throw_if_not_connected();
+  return true;
+}
+
+bool simulated_rotator::is_moving() {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  return _axis.moving();
+}
+
+double simulated_rotator::position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  return sky_from_mechanical(_axis.position());
+}
+
+double simulated_rotator::mechanical_position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  return wrap_degrees(_axis.position());
+}
+
+bool simulated_rotator::reverse() {
+  throw_if_not_connected();
+  return _reverse;
+}
+
+// Keeps the sky position where it was, only the way it counts changes
+int simulated_rotator::set_reverse(bool reverse) {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  double sky = sky_from_mechanical(_axis.position());
+  _reverse = reverse;
+  double mechanical = _axis.position();
+  _sync_offset = wrap_degrees(sky - (_reverse ? -mechanical : mechanical));
+  return 0;
+}
+
+double simulated_rotator::step_size() {
+  throw_if_not_connected();
+  return 0.1;
+}
+
+double simulated_rotator::target_position() {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  return sky_from_mechanical(_axis.target());
+}
+
+int simulated_rotator::halt() {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  _axis.stop();
+  return 0;
+}
+
+int simulated_rotator::move(const double &position) {
+  throw_if_not_connected();
+  std::lock_guard lock(_rotator_mtx);
+  // Relative, so it goes the long way round if asked to
+  _axis.move_to(_axis.target() + (_reverse ? -position : position));
+  return 0;
+}
+
+int simulated_rotator::moveabsolute(const double &absolute_position) {
+  throw_if_not_connected();
+  throw_if_out_of_range(absolute_position);
+  std::lock_guard lock(_rotator_mtx);
+  turn_to(mechanical_from_sky(absolute_position));
+  return 0;
+}
+
+int simulated_rotator::movemechanical(const double &mechanical_position) {
+  throw_if_not_connected();
+  throw_if_out_of_range(mechanical_position);
+  std::lock_guard lock(_rotator_mtx);
+  turn_to(mechanical_position);
+  return 0;
+}
+
+int simulated_rotator::sync(const double &sync_position) {
+  throw_if_not_connected();
+  throw_if_out_of_range(sync_position);
+  std::lock_guard lock(_rotator_mtx);
+  double mechanical = _axis.position();
+  _sync_offset =
+      wrap_degrees(sync_position - (_reverse ? -mechanical : mechanical));
+  return 0;
+}
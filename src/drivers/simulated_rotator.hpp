@@ -0,0 +1,70 @@
+#ifndef SIMULATED_ROTATOR_HPP
+#define SIMULATED_ROTATOR_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "interfaces/i_alpaca_rotator.hpp"
+#include "simulated_axis.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct simulated_rotator_config_t {
+  std::string name = "Simulated Rotator";
+  std::string unique_id = "simulated-rotator-0";
+  // Degrees per second, and per second squared
+  double speed = 10;
+  double acceleration = 20;
+};
+
+// A rotator that turns on the clock like the focuser does. The mechanical
+// angle is what the motor knows about, sync and reverse only change how
+// that's turned into the sky position angle.
+class simulated_rotator : public i_alpaca_rotator {
+public:
+  explicit simulated_rotator(simulated_rotator_config_t config = {});
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  bool can_reverse();
+  bool is_moving();
+  double position();
+  double mechanical_position();
+  bool reverse();
+  int set_reverse(bool reverse);
+  double step_size();
+  double target_position();
+  int halt();
+  int move(const double &position);
+  int moveabsolute(const double &absolute_position);
+  int movemechanical(const double &mechanical_position);
+  int sync(const double &sync_position);
+
+private:
+  void throw_if_not_connected();
+  // Caller holds _rotator_mtx for these
+  double sky_from_mechanical(double mechanical);
+  double mechanical_from_sky(double sky);
+  // Turns to mechanical the short way round
+  void turn_to(double mechanical);
+
+  simulated_rotator_config_t _config;
+  std::mutex _rotator_mtx;
+  bool _connected;
+  // Unwrapped degrees, reported 0 - 360
+  simulated_axis_t _axis;
+  // Sky position angle of mechanical 0
+  double _sync_offset;
+  bool _reverse;
+};
+
+#endif
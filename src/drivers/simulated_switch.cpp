@@ -0,0 +1,197 @@
+#include "simulated_switch.hpp"
+#include <cmath>
+#include <fmt/format.h>
+
+namespace {
+enum simulated_switches {
+  VOLTAGE = 0,
+  CURRENT,
+  TEMPERATURE,
+  HUMIDITY,
+  QUAD12V_ON_OFF,
+  ADJPOW_ON_OFF,
+  DEWA_PWM,
+  DEWB_PWM,
+  USB2_ON_OFF
+};
+} // namespace
+
+simulated_switch::simulated_switch(simulated_switch_config_t config)
+    : _config(config), _connected(false),
+      _switches{
+          {"Voltage", "Input Voltage", 0, 15, 0.1, false, 12.4},
+          {"Total Current", "Current in Amps", 0, 20, 0.01, false, 0},
+          {"Temperature", "Temperature in Celsius", -40, 60, 0.1, false, 12},
+          {"Humidity", "Humidity %", 0, 100, 1, false, 60},
+          {"Quad 12V", "Quad 12V Output On/Off", 0, 1, 1, true, 1},
+          {"Adjustable Output", "Adjustable Power Output On/Off", 0, 1, 1,
+           true, 0},
+          {"Dew Heater A", "Dew Heater A PWM Set Point (0-255)", 0, 255, 1,
+           true, 0},
+          {"Dew Heater B", "Dew Heater B PWM Set Point (0-255)", 0, 255, 1,
+           true, 0},
+          {"USB2", "USB2 Ports On/Off", 0, 1, 1, true, 1}} {
+  update_readings();
+}
+
+void simulated_switch::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Switch not connected");
+}
+
+simulated_switch::switch_t &simulated_switch::switch_at(uint32_t switch_idx) {
+  if (switch_idx >= _switches.size())
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("{} is not a valid switch index", switch_idx));
+  return _switches[switch_idx];
+}
+
+// Roughly what a small imaging rig draws, the dew heaters are a couple of
+// amps each flat out
+void simulated_switch::update_readings() {
+  double current = 0.1;
+  if (_switches[QUAD12V_ON_OFF].value != 0)
+    current += 1.5;
+  if (_switches[ADJPOW_ON_OFF].value != 0)
+    current += 0.5;
+  current += _switches[DEWA_PWM].value / 255 * 2;
+  current += _switches[DEWB_PWM].value / 255 * 2;
+  _switches[CURRENT].value = std::round(current * 100) / 100;
+  // Sags a little under load
+  _switches[VOLTAGE].value = std::round((12.4 - current * 0.05) * 10) / 10;
+}
+
+std::string simulated_switch::send_command_to_switch(const std::string &,
+                                                     bool, char) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "The simulated switch doesn't take commands");
+}
+
+std::map<std::string, device_variant_t> simulated_switch::details() {
+  std::lock_guard lock(_switch_mtx);
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  for (auto &s : _switches)
+    detail_map[s.name] = s.value;
+  return detail_map;
+}
+
+bool simulated_switch::connected() { return _connected; }
+
+int simulated_switch::set_connected(bool connected) {
+  _connected = connected;
+  return 0;
+}
+
+std::string simulated_switch::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_switch::interface_version() { return 3; }
+
+std::string simulated_switch::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_switch::supported_actions() { return {}; }
+
+std::string simulated_switch::description() {
+  return "Simulated power box";
+}
+
+std::string simulated_switch::driverinfo() {
+  return "AlpacaHub Switch Simulator";
+}
+
+std::string simulated_switch::name() { return _config.name; }
+
+uint32_t simulated_switch::max_switch() {
+  throw_if_not_connected();
+  return _switches.size();
+}
+
+bool simulated_switch::can_write(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).writable;
+}
+
+bool simulated_switch::get_switch(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  auto &s = switch_at(switch_idx);
+  return s.value > s.min;
+}
+
+std::string
+simulated_switch::get_switch_description(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).description;
+}
+
+std::string simulated_switch::get_switch_name(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).name;
+}
+
+double simulated_switch::get_switch_value(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).value;
+}
+
+double simulated_switch::min_switch_value(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).min;
+}
+
+double simulated_switch::max_switch_value(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).max;
+}
+
+int simulated_switch::set_switch(const uint32_t &switch_idx,
+                                 const bool &switch_state) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  auto &s = switch_at(switch_idx);
+  if (!s.writable)
+    throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                           fmt::format("{} is read only", s.name));
+  s.value = switch_state ? s.max : s.min;
+  update_readings();
+  return 0;
+}
+
+int simulated_switch::set_switch_name(const uint32_t &switch_idx,
+                                      const std::string &switch_name) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  switch_at(switch_idx).name = switch_name;
+  return 0;
+}
+
+int simulated_switch::set_switch_value(const uint32_t &switch_idx,
+                                       const double &switch_value) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  auto &s = switch_at(switch_idx);
+  if (!s.writable)
+    throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                           fmt::format("{} is read only", s.name));
+  if (switch_value < s.min || switch_value > s.max)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("{} is not within {} - {}",
+                                       switch_value, s.min, s.max));
+  s.value = s.min + std::round((switch_value - s.min) / s.step) * s.step;
+  update_readings();
+  return 0;
+}
+
+double simulated_switch::switch_step(const uint32_t &switch_idx) {
+  throw_if_not_connected();
+  std::lock_guard lock(_switch_mtx);
+  return switch_at(switch_idx).step;
+}
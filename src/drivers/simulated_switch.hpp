@@ -0,0 +1,73 @@
+#ifndef SIMULATED_SWITCH_HPP
+#define SIMULATED_SWITCH_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "interfaces/i_alpaca_switch.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct simulated_switch_config_t {
+  std::string name = "Simulated Power Box";
+  std::string unique_id = "simulated-switch-0";
+};
+
+// A power box along the lines of the PPBA: a few outputs that can be turned
+// on and off, two dew heaters and some readings that can't be written. The
+// current drawn follows what's switched on.
+class simulated_switch : public i_alpaca_switch {
+public:
+  explicit simulated_switch(simulated_switch_config_t config = {});
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  uint32_t max_switch();
+  bool can_write(const uint32_t &switch_idx);
+  bool get_switch(const uint32_t &switch_idx);
+  std::string get_switch_description(const uint32_t &switch_idx);
+  std::string get_switch_name(const uint32_t &switch_idx);
+  double get_switch_value(const uint32_t &switch_idx);
+  double min_switch_value(const uint32_t &switch_idx);
+  double max_switch_value(const uint32_t &switch_idx);
+  int set_switch(const uint32_t &switch_idx, const bool &switch_state);
+  int set_switch_name(const uint32_t &switch_idx,
+                      const std::string &switch_name);
+  int set_switch_value(const uint32_t &switch_idx, const double &switch_value);
+  double switch_step(const uint32_t &switch_idx);
+
+private:
+  struct switch_t {
+    std::string name;
+    std::string description;
+    double min;
+    double max;
+    double step;
+    bool writable;
+    double value;
+  };
+
+  void throw_if_not_connected();
+  // Throws if switch_idx is out of range, caller holds _switch_mtx
+  switch_t &switch_at(uint32_t switch_idx);
+  // Works out the readings that depend on the outputs
+  void update_readings();
+  // Nothing to send commands to
+  std::string send_command_to_switch(const std::string &, bool, char);
+
+  simulated_switch_config_t _config;
+  std::mutex _switch_mtx;
+  bool _connected;
+  std::vector<switch_t> _switches;
+};
+
+#endif
@@ -0,0 +1,838 @@
+#include "simulated_telescope.hpp"
+#include <cmath>
+#include <date/date.h>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <thread>
+
+namespace {
+// Half sidereal in degrees per second, what most mounts default to
+constexpr double default_guide_rate = 0.5 * 15.041 / 3600;
+// Synchronous slews give up waiting after this
+constexpr std::chrono::minutes slew_timeout{5};
+constexpr std::chrono::milliseconds slew_poll_interval{50};
+
+// Puts a onto the same turn as near, e.g. so a goto from 23h to 1h goes
+// the short way through 0h
+double nearest_wrap(double a, double near, double period) {
+  return near + std::remainder(a - near, period);
+}
+
+double wrap_hours(double hours) {
+  hours = std::fmod(hours, 24.0);
+  return hours < 0 ? hours + 24 : hours;
+}
+} // namespace
+
+double simulated_telescope::guide_pulse_t::offset(
+    sim_clock_t::time_point now) const {
+  double elapsed = std::chrono::duration<double>(now - started).count();
+  return rate * std::clamp(elapsed, 0.0, seconds);
+}
+
+bool simulated_telescope::guide_pulse_t::running(
+    sim_clock_t::time_point now) const {
+  return now < started + std::chrono::duration_cast<sim_clock_t::duration>(
+                             std::chrono::duration<double>(seconds));
+}
+
+simulated_telescope::simulated_telescope(simulated_telescope_config_t config)
+    : _config(config), _connected(false),
+      // The RA axis works in hours so its limits are a fifteenth of Dec's
+      _ra_axis(config.slew_rate / 15, config.acceleration / 15),
+      _dec_axis(config.slew_rate, config.acceleration), _ra_offset(0),
+      _drift_from(sim_clock_t::now()),
+      _motion(motion_config_t{std::chrono::milliseconds(0),
+                              std::chrono::milliseconds(0)}),
+      _goto_kind(goto_kind_enum::none), _tracking(false),
+      _tracking_rate(drive_rate_enum::sidereal), _parked(false),
+      _at_home(true), _pier_side(pier_side_enum::east),
+      _park_hour_angle(-6), _park_declination(90), _home_hour_angle(-6),
+      _target_ra(0), _target_dec(0), _target_ra_set(false),
+      _target_dec_set(false), _latitude(config.latitude),
+      _longitude(config.longitude), _elevation(config.elevation),
+      _refraction(false), _aperture_diameter(0.1),
+      _guide_rate_ascension(default_guide_rate),
+      _guide_rate_declination(default_guide_rate), _slew_settle_time(0),
+      _clock_offset(0) {
+  // Starts off at home, counterweight down pointing at the pole
+  _ra_offset = local_sidereal_time() - _home_hour_angle;
+  _dec_axis.set_position(90);
+}
+
+void simulated_telescope::throw_if_not_connected() {
+  if (!_connected)
+    throw alpaca_exception(alpaca_exception::NOT_CONNECTED,
+                           "Mount not connected");
+}
+
+void simulated_telescope::throw_if_parked() {
+  if (_parked)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Mount is parked");
+}
+
+astrometry::site_t simulated_telescope::site() {
+  astrometry::site_t site;
+  site.latitude = _latitude;
+  site.longitude = _longitude;
+  site.refraction = _refraction;
+  return site;
+}
+
+double simulated_telescope::local_sidereal_time() {
+  return astrometry::local_sidereal_time(
+      std::chrono::system_clock::now() + _clock_offset, _longitude);
+}
+
+double simulated_telescope::drift(sim_clock_t::time_point now) {
+  return astrometry::extrapolate({12, 0}, now - _drift_from, _tracking,
+                                 _tracking_rate)
+             .right_ascension -
+         12;
+}
+
+void simulated_telescope::settle_drift(sim_clock_t::time_point now) {
+  _ra_offset += drift(now);
+  _drift_from = now;
+}
+
+astrometry::equatorial_t
+simulated_telescope::position(sim_clock_t::time_point now) {
+  astrometry::equatorial_t result;
+  result.right_ascension =
+      wrap_hours(_ra_axis.position(now) + _ra_offset + drift(now) +
+                 _guide_pulses[0].offset(now));
+  result.declination = std::clamp(
+      _dec_axis.position(now) + _guide_pulses[1].offset(now), -90.0, 90.0);
+  return result;
+}
+
+void simulated_telescope::update(sim_clock_t::time_point now) {
+  bool moving = _ra_axis.moving(now) || _dec_axis.moving(now);
+  _motion.observe(now, moving);
+  if (moving || _goto_kind == goto_kind_enum::none)
+    return;
+
+  if (_goto_kind == goto_kind_enum::home) {
+    _at_home = true;
+  } else if (_goto_kind == goto_kind_enum::park) {
+    _parked = true;
+    _motion.set_parked(true);
+  }
+  _goto_kind = goto_kind_enum::none;
+}
+
+void simulated_telescope::validate_coordinates(double ra, double dec) {
+  if (ra < 0 || ra > 24)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("RA of {} is not within 0 - 24", ra));
+  if (dec < -90 || dec > 90)
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Dec of {} is not within -90 - 90", dec));
+}
+
+void simulated_telescope::begin_goto(double ra, double dec,
+                                     goto_kind_enum kind) {
+  auto now = sim_clock_t::now();
+  settle_drift(now);
+
+  // Whatever the guide pulses have done so far stays done
+  auto from = position(now);
+  _ra_axis.set_position(from.right_ascension - _ra_offset);
+  _dec_axis.set_position(from.declination);
+  _guide_pulses = {};
+
+  _pier_side = astrometry::destination_side_of_pier(
+      {ra, dec}, local_sidereal_time());
+  double ra_target =
+      nearest_wrap(ra - _ra_offset, _ra_axis.position(now), 24.0);
+  auto ra_time = _ra_axis.move_to(ra_target, now);
+  auto dec_time = _dec_axis.move_to(dec, now);
+  spdlog::debug("simulated goto to {:.4f} {:.4f} takes {:.1f}s", ra, dec,
+                std::max(ra_time, dec_time).count());
+
+  _at_home = false;
+  _goto_kind = kind;
+  _motion.begin(kind == goto_kind_enum::home ? motion_kind_enum::home
+                                             : motion_kind_enum::slew);
+}
+
+void simulated_telescope::block_while_moving() {
+  auto give_up_at = sim_clock_t::now() + slew_timeout;
+  while (true) {
+    {
+      std::lock_guard lock(_telescope_mtx);
+      auto now = sim_clock_t::now();
+      update(now);
+      if (!_ra_axis.moving(now) && !_dec_axis.moving(now))
+        break;
+      if (now >= give_up_at)
+        throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                               "Timed out waiting for the slew to finish");
+    }
+    std::this_thread::sleep_for(slew_poll_interval);
+  }
+  // SlewSettleTime is in seconds
+  _motion.wait_until_settled(std::chrono::seconds(_slew_settle_time + 1));
+}
+
+std::map<std::string, device_variant_t> simulated_telescope::details() {
+  std::lock_guard lock(_telescope_mtx);
+  auto now = sim_clock_t::now();
+  update(now);
+  std::map<std::string, device_variant_t> detail_map;
+  detail_map["Connected"] = _connected;
+  auto equatorial = position(now);
+  auto lst = local_sidereal_time();
+  auto horizontal = astrometry::to_horizontal(equatorial, lst, site());
+  detail_map["RightAscension"] = equatorial.right_ascension;
+  detail_map["Declination"] = equatorial.declination;
+  detail_map["Azimuth"] = horizontal.azimuth;
+  detail_map["Altitude"] = horizontal.altitude;
+  detail_map["SiteLatitude"] = _latitude;
+  detail_map["SiteLongitude"] = _longitude;
+  detail_map["SiteElevation"] = _elevation;
+  detail_map["SiderealTime"] = lst;
+  detail_map["SideOfPier"] = _pier_side;
+  detail_map["Tracking"] = _tracking;
+  detail_map["AtPark"] = _parked;
+  detail_map["AtHome"] = _at_home;
+  detail_map["Slewing"] = _motion.in_motion();
+  detail_map["MotionState"] = motion_state_name(_motion.state());
+  detail_map["Motion"] = _motion.summary();
+  return detail_map;
+}
+
+bool simulated_telescope::connected() { return _connected; }
+
+int simulated_telescope::set_connected(bool connected) {
+  std::lock_guard lock(_telescope_mtx);
+  _connected = connected;
+  _target_ra_set = false;
+  _target_dec_set = false;
+  return 0;
+}
+
+std::string simulated_telescope::unique_id() { return _config.unique_id; }
+
+uint32_t simulated_telescope::interface_version() { return 3; }
+
+std::string simulated_telescope::driver_version() { return "v0.1"; }
+
+std::vector<std::string> simulated_telescope::supported_actions() {
+  return {};
+}
+
+std::string simulated_telescope::description() {
+  return "Simulated German equatorial mount";
+}
+
+std::string simulated_telescope::driverinfo() {
+  return "AlpacaHub Telescope Simulator";
+}
+
+std::string simulated_telescope::name() { return _config.name; }
+
+alignment_mode_enum simulated_telescope::alignment_mode() {
+  throw_if_not_connected();
+  return alignment_mode_enum::german_polar;
+}
+
+double simulated_telescope::altitude() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  return astrometry::to_horizontal(position(sim_clock_t::now()),
+                                   local_sidereal_time(), site())
+      .altitude;
+}
+
+double simulated_telescope::azimuth() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  return astrometry::to_horizontal(position(sim_clock_t::now()),
+                                   local_sidereal_time(), site())
+      .azimuth;
+}
+
+double simulated_telescope::aperture_diameter() {
+  throw_if_not_connected();
+  return _aperture_diameter;
+}
+
+double simulated_telescope::aperture_area() {
+  throw_if_not_connected();
+  return M_PI * _aperture_diameter * _aperture_diameter / 4;
+}
+
+int simulated_telescope::set_aperture_diameter(const double &diameter) {
+  throw_if_not_connected();
+  if (diameter <= 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "Aperture diameter must be positive");
+  _aperture_diameter = diameter;
+  return 0;
+}
+
+bool simulated_telescope::at_home() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  update(sim_clock_t::now());
+  return _at_home;
+}
+
+bool simulated_telescope::at_park() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  update(sim_clock_t::now());
+  return _parked;
+}
+
+bool simulated_telescope::can_find_home() { return true; }
+bool simulated_telescope::can_park() { return true; }
+bool simulated_telescope::can_pulse_guide() { return true; }
+bool simulated_telescope::can_set_declination_rate() { return false; }
+bool simulated_telescope::can_set_guide_rates() { return true; }
+bool simulated_telescope::can_set_park() { return true; }
+bool simulated_telescope::can_set_pier_side() { return false; }
+bool simulated_telescope::can_set_right_ascension_rate() { return false; }
+bool simulated_telescope::can_set_tracking() { return true; }
+bool simulated_telescope::can_slew() { return true; }
+bool simulated_telescope::can_slew_async() { return true; }
+bool simulated_telescope::can_slew_alt_az() { return false; }
+bool simulated_telescope::can_slew_alt_az_async() { return false; }
+bool simulated_telescope::can_sync() { return true; }
+bool simulated_telescope::can_sync_alt_az() { return false; }
+bool simulated_telescope::can_unpark() { return true; }
+
+double simulated_telescope::declination() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  return position(sim_clock_t::now()).declination;
+}
+
+double simulated_telescope::right_ascension() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  return position(sim_clock_t::now()).right_ascension;
+}
+
+double simulated_telescope::declination_rate() {
+  throw_if_not_connected();
+  return 0;
+}
+
+int simulated_telescope::set_declination_rate(const double &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Cannot set declination rate");
+}
+
+double simulated_telescope::right_ascension_rate() {
+  throw_if_not_connected();
+  return 0;
+}
+
+int simulated_telescope::set_right_ascension_rate(const double &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Setting a RA rate is not supported on this mount");
+}
+
+bool simulated_telescope::does_refraction() {
+  throw_if_not_connected();
+  return _refraction;
+}
+
+int simulated_telescope::set_does_refraction(bool refraction) {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  _refraction = refraction;
+  return 0;
+}
+
+equatorial_system_enum simulated_telescope::equatorial_system() {
+  throw_if_not_connected();
+  return equatorial_system_enum::topocentric;
+}
+
+double simulated_telescope::focal_length() {
+  throw_if_not_connected();
+  return 0.5;
+}
+
+double simulated_telescope::guide_rate_declination() {
+  throw_if_not_connected();
+  return _guide_rate_declination;
+}
+
+int simulated_telescope::set_guide_rate_declination(const double &rate) {
+  throw_if_not_connected();
+  // Somewhere between a tenth and all of sidereal
+  if (rate < 0.1 * 15.041 / 3600 || rate > 15.041 / 3600)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("Guide rate {} is out of range", rate));
+  _guide_rate_declination = rate;
+  return 0;
+}
+
+double simulated_telescope::guide_rate_ascension() {
+  throw_if_not_connected();
+  return _guide_rate_ascension;
+}
+
+int simulated_telescope::set_guide_rate_ascension(const double &rate) {
+  throw_if_not_connected();
+  if (rate < 0.1 * 15.041 / 3600 || rate > 15.041 / 3600)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("Guide rate {} is out of range", rate));
+  _guide_rate_ascension = rate;
+  return 0;
+}
+
+bool simulated_telescope::is_pulse_guiding() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  auto now = sim_clock_t::now();
+  return _guide_pulses[0].running(now) || _guide_pulses[1].running(now);
+}
+
+pier_side_enum simulated_telescope::side_of_pier() {
+  throw_if_not_connected();
+  return _pier_side;
+}
+
+int simulated_telescope::set_side_of_pier(const pier_side_enum &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Setting side of pier not supported on this mount");
+}
+
+double simulated_telescope::sidereal_time() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  return local_sidereal_time();
+}
+
+double simulated_telescope::site_elevation() {
+  throw_if_not_connected();
+  return _elevation;
+}
+
+int simulated_telescope::set_site_elevation(const double &elevation) {
+  throw_if_not_connected();
+  if (elevation < -300 || elevation > 10000)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "Elevation must be between -300m and 10,000m");
+  _elevation = elevation;
+  return 0;
+}
+
+double simulated_telescope::site_latitude() {
+  throw_if_not_connected();
+  return _latitude;
+}
+
+int simulated_telescope::set_site_latitude(const double &latitude) {
+  throw_if_not_connected();
+  if (latitude < -90 || latitude > 90)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE, "Latitude invalid");
+  std::lock_guard lock(_telescope_mtx);
+  _latitude = latitude;
+  return 0;
+}
+
+double simulated_telescope::site_longitude() {
+  throw_if_not_connected();
+  return _longitude;
+}
+
+int simulated_telescope::set_site_longitude(const double &longitude) {
+  throw_if_not_connected();
+  if (longitude < -180 || longitude > 180)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "Longitude invalid");
+  std::lock_guard lock(_telescope_mtx);
+  _longitude = longitude;
+  return 0;
+}
+
+bool simulated_telescope::slewing() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  update(sim_clock_t::now());
+  return _motion.in_motion();
+}
+
+int simulated_telescope::slew_settle_time() {
+  throw_if_not_connected();
+  return _slew_settle_time;
+}
+
+int simulated_telescope::set_slew_settle_time(const int &slew_settle_time) {
+  throw_if_not_connected();
+  if (slew_settle_time < 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "slew settle time must be a positive value");
+  _slew_settle_time = slew_settle_time;
+  _motion.configure(
+      motion_config_t{std::chrono::milliseconds(0),
+                      std::chrono::milliseconds(slew_settle_time * 1000)});
+  return 0;
+}
+
+double simulated_telescope::target_declination() {
+  throw_if_not_connected();
+  if (!_target_dec_set)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Must set DEC target before reading");
+  return _target_dec;
+}
+
+int simulated_telescope::set_target_declination(const double &dec) {
+  throw_if_not_connected();
+  validate_coordinates(0, dec);
+  _target_dec = dec;
+  _target_dec_set = true;
+  return 0;
+}
+
+double simulated_telescope::target_right_ascension() {
+  throw_if_not_connected();
+  if (!_target_ra_set)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Must set RA target before reading");
+  return _target_ra;
+}
+
+int simulated_telescope::set_target_right_ascension(const double &ra) {
+  throw_if_not_connected();
+  validate_coordinates(ra, 0);
+  _target_ra = ra;
+  _target_ra_set = true;
+  return 0;
+}
+
+bool simulated_telescope::tracking() {
+  throw_if_not_connected();
+  return _tracking;
+}
+
+int simulated_telescope::set_tracking(const bool &tracking) {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  settle_drift(sim_clock_t::now());
+  _tracking = tracking;
+  _motion.set_tracking(tracking);
+  return 0;
+}
+
+drive_rate_enum simulated_telescope::tracking_rate() {
+  throw_if_not_connected();
+  return _tracking_rate;
+}
+
+int simulated_telescope::set_tracking_rate(
+    const drive_rate_enum &tracking_rate) {
+  throw_if_not_connected();
+  switch (tracking_rate) {
+  case drive_rate_enum::sidereal:
+  case drive_rate_enum::lunar:
+  case drive_rate_enum::solar:
+  case drive_rate_enum::king:
+    break;
+  default:
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Unsupported tracking rate: {}", int(tracking_rate)));
+  }
+  std::lock_guard lock(_telescope_mtx);
+  settle_drift(sim_clock_t::now());
+  _tracking_rate = tracking_rate;
+  return 0;
+}
+
+std::vector<drive_rate_enum> simulated_telescope::tracking_rates() {
+  throw_if_not_connected();
+  return {drive_rate_enum::sidereal, drive_rate_enum::lunar,
+          drive_rate_enum::solar, drive_rate_enum::king};
+}
+
+std::string simulated_telescope::utc_date() {
+  throw_if_not_connected();
+  auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now() + _clock_offset);
+  return fmt::format("{:%FT%T}Z", now);
+}
+
+// The simulator's clock is the host's, this just remembers how far off the
+// client wants it to be
+int simulated_telescope::set_utc_date(const std::string &utc_date) {
+  throw_if_not_connected();
+  std::istringstream in(utc_date);
+  date::sys_time<std::chrono::milliseconds> t;
+  in >> date::parse("%FT%T", t);
+  if (in.fail())
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("Could not parse {}", utc_date));
+  std::lock_guard lock(_telescope_mtx);
+  _clock_offset = t - std::chrono::system_clock::now();
+  return 0;
+}
+
+int simulated_telescope::abort_slew() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  auto now = sim_clock_t::now();
+  _ra_axis.stop(now);
+  _dec_axis.stop(now);
+  _goto_kind = goto_kind_enum::none;
+  _motion.abort();
+  return 0;
+}
+
+std::vector<axis_rate>
+simulated_telescope::axis_rates(const telescope_axes_enum &axis) {
+  throw_if_not_connected();
+  if (axis == telescope_axes_enum::tertiary)
+    return {};
+  // Same spread as the AM5, a quarter of sidereal up to the slew rate
+  return {axis_rate(_config.slew_rate, 0.0042 * .25)};
+}
+
+bool simulated_telescope::can_move_axis(const telescope_axes_enum &axis) {
+  throw_if_not_connected();
+  return axis != telescope_axes_enum::tertiary;
+}
+
+pier_side_enum
+simulated_telescope::destination_side_of_pier(const double &ra,
+                                              const double &dec) {
+  throw_if_not_connected();
+  validate_coordinates(ra, dec);
+  std::lock_guard lock(_telescope_mtx);
+  return astrometry::destination_side_of_pier({ra, dec},
+                                              local_sidereal_time());
+}
+
+int simulated_telescope::find_home() {
+  throw_if_not_connected();
+  {
+    std::lock_guard lock(_telescope_mtx);
+    throw_if_parked();
+    settle_drift(sim_clock_t::now());
+    _tracking = false;
+    _motion.set_tracking(false);
+    begin_goto(wrap_hours(local_sidereal_time() - _home_hour_angle), 90,
+               goto_kind_enum::home);
+  }
+  block_while_moving();
+  return 0;
+}
+
+int simulated_telescope::move_axis(const telescope_axes_enum &axis,
+                                   const double &rate) {
+  throw_if_not_connected();
+  if (axis == telescope_axes_enum::tertiary)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("{} is not a valid axis", int(axis)));
+  if (rate != 0 && (std::abs(rate) > _config.slew_rate ||
+                    std::abs(rate) < 0.0042 * .25))
+    throw alpaca_exception(
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("Rate: {} is not within acceptable range", rate));
+
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  auto now = sim_clock_t::now();
+  auto &moving_axis =
+      axis == telescope_axes_enum::primary ? _ra_axis : _dec_axis;
+  // Degrees per second on the sky, the RA axis counts in hours
+  double velocity = axis == telescope_axes_enum::primary ? rate / 15 : rate;
+  if (velocity == 0)
+    moving_axis.stop(now);
+  else
+    moving_axis.run(velocity, now);
+
+  _at_home = false;
+  _goto_kind = goto_kind_enum::none;
+  if (_ra_axis.moving(now) || _dec_axis.moving(now))
+    _motion.begin(motion_kind_enum::slew);
+  else
+    _motion.abort();
+  return 0;
+}
+
+int simulated_telescope::park() {
+  throw_if_not_connected();
+  {
+    std::lock_guard lock(_telescope_mtx);
+    if (_parked)
+      return 0;
+    settle_drift(sim_clock_t::now());
+    _tracking = false;
+    _motion.set_tracking(false);
+    begin_goto(wrap_hours(local_sidereal_time() - _park_hour_angle),
+               _park_declination, goto_kind_enum::park);
+  }
+  block_while_moving();
+  return 0;
+}
+
+int simulated_telescope::pulse_guide(const guide_direction_enum &direction,
+                                     const int32_t &duration_ms) {
+  throw_if_not_connected();
+  if (duration_ms < 0)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "Pulse guide duration must not be negative");
+
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  auto now = sim_clock_t::now();
+  update(now);
+  if (_motion.in_motion())
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Can't pulse guide while slewing");
+
+  size_t index;
+  double rate;
+  switch (direction) {
+  case guide_direction_enum::guide_east:
+    index = 0;
+    rate = _guide_rate_ascension / 15;
+    break;
+  case guide_direction_enum::guide_west:
+    index = 0;
+    rate = -_guide_rate_ascension / 15;
+    break;
+  case guide_direction_enum::guide_north:
+    index = 1;
+    rate = _guide_rate_declination;
+    break;
+  case guide_direction_enum::guide_south:
+    index = 1;
+    rate = -_guide_rate_declination;
+    break;
+  default:
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           "invalid guide direction");
+  }
+
+  // A new pulse on an axis replaces one that's still going, whatever it
+  // has done so far stays done
+  auto &pulse = _guide_pulses[index];
+  if (index == 0)
+    _ra_offset += pulse.offset(now);
+  else
+    _dec_axis.set_position(_dec_axis.position(now) + pulse.offset(now));
+  pulse.started = now;
+  pulse.seconds = duration_ms / 1000.0;
+  pulse.rate = rate;
+  return 0;
+}
+
+int simulated_telescope::set_park() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  auto here = position(sim_clock_t::now());
+  _park_hour_angle =
+      astrometry::hour_angle(local_sidereal_time(), here.right_ascension);
+  _park_declination = here.declination;
+  return 0;
+}
+
+int simulated_telescope::slew_to_alt_az(const double &, const double &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Alt Az slews are not supported by the simulator");
+}
+
+int simulated_telescope::slew_to_alt_az_async(const double &,
+                                              const double &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Alt Az slews are not supported by the simulator");
+}
+
+int simulated_telescope::slew_to_coordinates(const double &ra,
+                                             const double &dec) {
+  slew_to_coordinates_async(ra, dec);
+  block_while_moving();
+  return 0;
+}
+
+int simulated_telescope::slew_to_coordinates_async(const double &ra,
+                                                   const double &dec) {
+  throw_if_not_connected();
+  validate_coordinates(ra, dec);
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  if (!_tracking)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Tracking is not enabled");
+  _target_ra = ra;
+  _target_dec = dec;
+  _target_ra_set = true;
+  _target_dec_set = true;
+  begin_goto(ra, dec, goto_kind_enum::slew);
+  return 0;
+}
+
+int simulated_telescope::slew_to_target() {
+  slew_to_target_async();
+  block_while_moving();
+  return 0;
+}
+
+int simulated_telescope::slew_to_target_async() {
+  throw_if_not_connected();
+  if (!_target_ra_set || !_target_dec_set)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "RA and DEC target must be set");
+  return slew_to_coordinates_async(_target_ra, _target_dec);
+}
+
+int simulated_telescope::sync_to_alt_az(const double &, const double &) {
+  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
+                         "Alt Az syncs are not supported by the simulator");
+}
+
+int simulated_telescope::sync_to_coordinates(const double &ra,
+                                             const double &dec) {
+  throw_if_not_connected();
+  validate_coordinates(ra, dec);
+  std::lock_guard lock(_telescope_mtx);
+  throw_if_parked();
+  auto now = sim_clock_t::now();
+  update(now);
+  if (_motion.in_motion())
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "Can't sync while slewing");
+
+  // A sync just moves where the mount thinks it is, nothing turns
+  settle_drift(now);
+  _guide_pulses = {};
+  _ra_offset = ra - _ra_axis.position(now);
+  _dec_axis.set_position(dec);
+  _target_ra = ra;
+  _target_dec = dec;
+  _target_ra_set = true;
+  _target_dec_set = true;
+  return 0;
+}
+
+int simulated_telescope::sync_to_target() {
+  throw_if_not_connected();
+  if (!_target_ra_set || !_target_dec_set)
+    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                           "RA and DEC target must be set");
+  return sync_to_coordinates(_target_ra, _target_dec);
+}
+
+int simulated_telescope::unpark() {
+  throw_if_not_connected();
+  std::lock_guard lock(_telescope_mtx);
+  _parked = false;
+  _motion.set_parked(false);
+  return 0;
+}
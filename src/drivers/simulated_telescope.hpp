@@ -0,0 +1,213 @@
+#ifndef SIMULATED_TELESCOPE_HPP
+#define SIMULATED_TELESCOPE_HPP
+
+#include "common/alpaca_exception.hpp"
+#include "common/astrometry.hpp"
+#include "common/motion_state_machine.hpp"
+#include "interfaces/i_alpaca_telescope.hpp"
+#include "simulated_axis.hpp"
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct simulated_telescope_config_t {
+  std::string name = "Simulated Mount";
+  std::string unique_id = "simulated-telescope-0";
+  // Degrees per second, about what an AM5 does at 1440x
+  double slew_rate = 6;
+  double acceleration = 3;
+  double latitude = 40;
+  // East positive like ASCOM
+  double longitude = -74;
+  double elevation = 0;
+};
+
+// A German equatorial mount that slews and tracks on the clock. The axes
+// are simulated_axis_t's so gotos take as long as the distance, slew rate
+// and acceleration say, and where the mount points in between is worked
+// out when somebody asks. Not tracking, or tracking at anything other than
+// sidereal, lets the sky drift past. Slewing, settling and parking go
+// through the same motion_state_machine_t the AM5 driver uses.
+class simulated_telescope : public i_alpaca_telescope {
+public:
+  explicit simulated_telescope(simulated_telescope_config_t config = {});
+
+  std::map<std::string, device_variant_t> details();
+  bool connected();
+  int set_connected(bool);
+  std::string unique_id();
+  uint32_t interface_version();
+  std::string driver_version();
+  std::vector<std::string> supported_actions();
+  std::string description();
+  std::string driverinfo();
+  std::string name();
+
+  alignment_mode_enum alignment_mode();
+  double altitude();
+  double aperture_diameter();
+  double aperture_area();
+  int set_aperture_diameter(const double &);
+  bool at_home();
+  bool at_park();
+  double azimuth();
+  bool can_find_home();
+  bool can_park();
+  bool can_pulse_guide();
+  bool can_set_declination_rate();
+  bool can_set_guide_rates();
+  bool can_set_park();
+  bool can_set_pier_side();
+  bool can_set_right_ascension_rate();
+  bool can_set_tracking();
+  bool can_slew();
+  bool can_slew_async();
+  bool can_slew_alt_az();
+  bool can_slew_alt_az_async();
+  bool can_sync();
+  bool can_sync_alt_az();
+  bool can_unpark();
+  double declination();
+  double declination_rate();
+  int set_declination_rate(const double &);
+  bool does_refraction();
+  int set_does_refraction(bool);
+  equatorial_system_enum equatorial_system();
+  double focal_length();
+  double guide_rate_declination();
+  int set_guide_rate_declination(const double &);
+  double guide_rate_ascension();
+  int set_guide_rate_ascension(const double &);
+  bool is_pulse_guiding();
+  double right_ascension();
+  double right_ascension_rate();
+  int set_right_ascension_rate(const double &);
+  pier_side_enum side_of_pier();
+  int set_side_of_pier(const pier_side_enum &);
+  double sidereal_time();
+  double site_elevation();
+  int set_site_elevation(const double &);
+  double site_latitude();
+  int set_site_latitude(const double &);
+  double site_longitude();
+  int set_site_longitude(const double &);
+  bool slewing();
+  int slew_settle_time();
+  int set_slew_settle_time(const int &);
+  double target_declination();
+  int set_target_declination(const double &);
+  double target_right_ascension();
+  int set_target_right_ascension(const double &);
+
+  bool tracking();
+  int set_tracking(const bool &);
+  drive_rate_enum tracking_rate();
+  int set_tracking_rate(const drive_rate_enum &);
+  std::vector<drive_rate_enum> tracking_rates();
+  std::string utc_date();
+  int set_utc_date(const std::string &);
+  int abort_slew();
+  std::vector<axis_rate> axis_rates(const telescope_axes_enum &);
+  bool can_move_axis(const telescope_axes_enum &);
+  pier_side_enum destination_side_of_pier(const double &ra,
+                                          const double &dec);
+  int find_home();
+  int move_axis(const telescope_axes_enum &, const double &);
+  int park();
+  int pulse_guide(const guide_direction_enum &direction,
+                  const int32_t &duration_ms);
+  int set_park();
+  int slew_to_alt_az(const double &alt, const double &az);
+  int slew_to_alt_az_async(const double &alt, const double &az);
+  int slew_to_coordinates(const double &ra, const double &dec);
+  int slew_to_coordinates_async(const double &ra, const double &dec);
+  int slew_to_target();
+  int slew_to_target_async();
+  int sync_to_alt_az(const double &alt, const double &az);
+  int sync_to_coordinates(const double &ra, const double &dec);
+  int sync_to_target();
+  int unpark();
+
+private:
+  using sim_clock_t = simulated_axis_t::sim_clock_t;
+
+  // What the current goto is for, so AtHome / AtPark can be set once it
+  // gets there
+  enum class goto_kind_enum { none, slew, home, park };
+
+  // One guide pulse per axis, its effect grows until it runs out
+  struct guide_pulse_t {
+    sim_clock_t::time_point started;
+    double seconds = 0;
+    // Hours of RA or degrees of Dec per second, signed
+    double rate = 0;
+
+    double offset(sim_clock_t::time_point now) const;
+    bool running(sim_clock_t::time_point now) const;
+  };
+
+  void throw_if_not_connected();
+  void throw_if_parked();
+
+  // Everything below here expects _telescope_mtx to be held
+  astrometry::equatorial_t position(sim_clock_t::time_point now);
+  astrometry::site_t site();
+  double local_sidereal_time();
+  // Hours of RA the sky has drifted by since _drift_from
+  double drift(sim_clock_t::time_point now);
+  // Folds the drift so far into _ra_offset, before anything changes it
+  void settle_drift(sim_clock_t::time_point now);
+  // Tells the state machine whether the axes are moving and notices a goto
+  // to home or park getting there
+  void update(sim_clock_t::time_point now);
+  void begin_goto(double ra, double dec, goto_kind_enum kind);
+  void validate_coordinates(double ra, double dec);
+
+  // For the synchronous slews, doesn't hold the lock while it waits
+  void block_while_moving();
+
+  simulated_telescope_config_t _config;
+  std::mutex _telescope_mtx;
+  bool _connected;
+
+  // Hours of RA and degrees of Dec. The RA axis position plus _ra_offset
+  // plus the drift since _drift_from is where it's pointing.
+  simulated_axis_t _ra_axis;
+  simulated_axis_t _dec_axis;
+  double _ra_offset;
+  sim_clock_t::time_point _drift_from;
+  std::array<guide_pulse_t, 2> _guide_pulses;
+
+  motion_state_machine_t _motion;
+  goto_kind_enum _goto_kind;
+  bool _tracking;
+  drive_rate_enum _tracking_rate;
+  bool _parked;
+  bool _at_home;
+  pier_side_enum _pier_side;
+  // Hour angle and Dec it parks and homes at
+  double _park_hour_angle;
+  double _park_declination;
+  double _home_hour_angle;
+
+  double _target_ra;
+  double _target_dec;
+  bool _target_ra_set;
+  bool _target_dec_set;
+
+  double _latitude;
+  double _longitude;
+  double _elevation;
+  bool _refraction;
+  double _aperture_diameter;
+  double _guide_rate_ascension;
+  double _guide_rate_declination;
+  int _slew_settle_time;
+  // UTCDate can be set, this is how far it's been moved from the host clock
+  std::chrono::system_clock::duration _clock_offset;
+};
+
+#endif
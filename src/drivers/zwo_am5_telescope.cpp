@@ -4,12 +4,44 @@
 #include "interfaces/i_alpaca_device.hpp"
 #include "interfaces/i_alpaca_telescope.hpp"
 #include <chrono>
+#include <fmt/ranges.h>
 #include <mutex>
 #include <thread>
 
 namespace zwoc = zwo_commands;
 namespace zwor = zwo_responses;
 
+namespace {
+// a 10 arc second movement is 10 / 15 seconds of time (ignoring sidereal
+// adjustment) i.e. 0.667 seconds. Also approx 15.042 arcseconds per second
+// of real time.
+//
+// 2000ms in equatorial movement should translate to 2 arc-seconds of movement
+// using the aforementioned conversion, assuming the guide rate is 1x sidereal
+// rate (which won't necessarily be the case), which means we can divide
+// 2000/15.042 which will give us our pulse duration. We should then divide
+// that by our guide rate.
+//
+// We used to send 70% of the requested duration because that guided better,
+// but the guiding software's calibration already takes care of the mount
+// moving more or less than it expects. Pulses now go out as asked, the
+// requested, scheduled and sent stats in details() show what the mount is
+// actually given and -pgs can scale them if it really is needed. The mount won't
+// take more than 3000ms in one :Mg.
+pulse_guide_config_t am5_pulse_guide_config() {
+  pulse_guide_config_t config;
+  config.max_chunk = std::chrono::milliseconds(3000);
+  return config;
+}
+
+// Synchronous slews give up waiting after this, a goto from one side of the
+// sky to the other is well under a couple of minutes
+constexpr std::chrono::minutes slew_timeout{5};
+// The mount sometimes turns down a tracking change just after it has
+// stopped, it takes it if asked again a moment later
+constexpr std::chrono::milliseconds tracking_retry_delay{2000};
+} // namespace
+
 std::vector<std::string> zwo_am5_telescope::serial_devices() {
   std::vector<std::string> serial_devices{
       "/dev/serial/by-id/usb-ZWO_Systems_ZWO_Device_123456-if00"};
@@ -41,29 +73,21 @@ int zwo_am5_telescope::set_connected(bool connected) {
       spdlog::debug("Setting connected to true");
       spdlog::debug("Attempting to open serial device at {0}",
                     _serial_device_path);
-      _serial_port.open(_serial_device_path);
-      _serial_port.set_option(asio::serial_port_base::baud_rate(9600));
-      _serial_port.set_option(asio::serial_port_base::character_size(8));
-      _serial_port.set_option(asio::serial_port_base::flow_control(
-          asio::serial_port_base::flow_control::none));
-      _serial_port.set_option(
-          asio::serial_port_base::parity(asio::serial_port_base::parity::none));
-      _serial_port.set_option(asio::serial_port_base::stop_bits(
-          asio::serial_port_base::stop_bits::one));
-
-      char buf[512] = {0};
-
-      _serial_port.write_some(asio::buffer(zwoc::cmd_get_status()));
-      _serial_port.read_some(asio::buffer(buf));
-
-      spdlog::debug("mount returned {0}", buf);
+      _serial->open(_serial_device_path, 9600);
+
+      auto status = send_command_to_mount(zwoc::cmd_get_status());
+      spdlog::debug("mount returned {0}", status);
       _connected = true;
 
       _tracking_enabled = false;
       auto resp = send_command_to_mount(zwoc::cmd_get_tracking_status());
       if (resp == "1#")
         _tracking_enabled = true;
+      _motion.reset();
+      _motion.set_tracking(_tracking_enabled);
 
+      read_site_from_mount();
+      start_telemetry();
       return 0;
     } catch (asio::system_error &e) {
       spdlog::error("problem opening serial connection. {0}", e.what());
@@ -76,8 +100,12 @@ int zwo_am5_telescope::set_connected(bool connected) {
   } else {
     try {
       spdlog::debug("Setting connected to false");
-      _serial_port.close();
+      _guide_scheduler.cancel();
+      stop_telemetry();
+      _serial->close();
       _connected = false;
+      // Anyone still waiting on a slew gets let go
+      _motion.reset();
       return 0;
     } catch (asio::system_error &e) {
       spdlog::error("problem closing serial connection {}", e.what());
@@ -94,12 +122,22 @@ int zwo_am5_telescope::set_connected(bool connected) {
 zwo_am5_telescope::zwo_am5_telescope()
     : _parked(false), _connected(false), _guide_rate(.8), _site_longitude(0),
       _site_latitude(0), _site_elevation(0), _aperture_diameter(0),
-      _moving(false), _io_context(1), _serial_port(_io_context),
-      _is_pulse_guiding(false), _ra_target_set(false), _dec_target_set(false){};
+      _moving(false), _slew_settle_time(0),
+      _serial(alpaca_hub_serial::serial_reactor::instance().make_channel()),
+      _ra_target_set(false), _dec_target_set(false),
+      _tracking_rate(drive_rate_enum::sidereal),
+      _does_refraction(false),
+      _guide_scheduler(
+          [this](char direction, int duration_ms) {
+            send_command_to_mount(zwoc::cmd_guide(direction, duration_ms));
+          },
+          am5_pulse_guide_config()){};
 
 zwo_am5_telescope::~zwo_am5_telescope() {
+  _guide_scheduler.shutdown();
+  stop_telemetry();
   spdlog::debug("Closing serial connection");
-  _serial_port.close();
+  _serial->close();
 };
 
 void zwo_am5_telescope::throw_if_not_connected() {
@@ -114,40 +152,237 @@ void zwo_am5_telescope::throw_if_parked() {
                            "Mount is parked");
 }
 
-std::string zwo_am5_telescope::send_command_to_mount(const std::string &cmd,
-                                                     bool read_response,
-                                                     char stop_on_char) {
-  try {
-    spdlog::trace("sending: {} to mount", cmd);
-    std::lock_guard lock(_telescope_mtx);
-    char buf[512] = {0};
-    _serial_port.write_some(asio::buffer(cmd));
-
-    std::string rsp;
-
-    if (read_response) {
-      _io_context.reset();
-
-      // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        rsp += c;
-        if (c == stop_on_char || stop_on_char == '\0' || c == '#') {
-          break;
-        }
-      }
+lx200::mount_link_t zwo_am5_telescope::mount_link() {
+  return {*_serial, _telescope_mtx, zwoc::descriptors,
+          [this]() { expire_telemetry(); }};
+}
+
+std::string zwo_am5_telescope::send_command_to_mount(std::string_view cmd) {
+  return lx200::send_command(mount_link(), cmd);
+}
+
+std::vector<std::string>
+zwo_am5_telescope::send_commands_to_mount(
+    const std::vector<lx200::command_t> &cmds) {
+  return lx200::send_commands(mount_link(), cmds);
+}
+
+// 4 is moving status, 2 is slewing to home or park
+bool zwo_am5_telescope::status_is_slewing(const std::string &status) {
+  if (status.size() < 2)
+    return false;
+  auto last_2_chars = status.substr(status.size() - 2);
+  return last_2_chars == "4#" || last_2_chars == "2#";
+}
+
+void zwo_am5_telescope::start_telemetry() {
+  stop_telemetry();
+  std::lock_guard lock(_telemetry_mtx);
+  _telemetry.reset();
+  _telemetry_task = alpaca_hub_serial::serial_reactor::instance().schedule(
+      std::bind(&zwo_am5_telescope::telemetry_proc, this));
+}
+
+void zwo_am5_telescope::stop_telemetry() {
+  alpaca_hub_serial::polled_task_ptr_t task;
+  {
+    std::lock_guard lock(_telemetry_mtx);
+    task = std::move(_telemetry_task);
+  }
+  // Not under the lock, stop() waits for a read that may need it
+  if (task)
+    task->stop();
+}
+
+void zwo_am5_telescope::wake_telemetry() {
+  std::lock_guard lock(_telemetry_mtx);
+  if (_telemetry_task)
+    _telemetry_task->wake();
+}
+
+// The read the move command triggered may have finished before this, the
+// task needs to know it's at the slewing rate now
+void zwo_am5_telescope::begin_motion(motion_kind_enum kind) {
+  _motion.begin(kind);
+  wake_telemetry();
+}
+
+// Reads the mount at a rate that suits what it's doing, quickly while it's
+// slewing so the motion state machine notices the end of a goto, slowly
+// otherwise since position() can work out where it has got to in between
+std::chrono::milliseconds zwo_am5_telescope::telemetry_proc() {
+  // Tracking changes that came in mid slew or that the mount turned down
+  if (auto tracking = _motion.take_deferred_tracking())
+    apply_deferred_tracking(*tracking);
+
+  auto interval_for_state = [this]() {
+    if (_moving || _motion.in_motion())
+      return _telemetry_config.slewing_interval;
+    if (_tracking_enabled)
+      return _telemetry_config.tracking_interval;
+    return _telemetry_config.idle_interval;
+  };
+
+  std::unique_lock lock(_telemetry_mtx);
+  if (!telemetry_is_fresh(interval_for_state())) {
+    lock.unlock();
+    try {
+      std::lock_guard refresh_lock(_telemetry_refresh_mtx);
+      // A getter may have read the mount while we were waiting
+      lock.lock();
+      bool fresh = telemetry_is_fresh(interval_for_state());
+      lock.unlock();
+      if (!fresh)
+        refresh_telemetry();
+    } catch (std::exception &ex) {
+      // Don't hammer a mount that isn't answering, the getters will still
+      // try for themselves and report the error
+      spdlog::warn("problem reading mount telemetry: {}", ex.what());
+      lock.lock();
+      return _telemetry_config.idle_interval;
     }
+    lock.lock();
+  }
 
-    spdlog::trace("mount returned: {}", rsp);
-    return rsp;
+  // The read may have shown the mount starting or stopping
+  auto wake_at = _telemetry->timestamp + interval_for_state();
+  // The end of the settle time or a deferred tracking change may come
+  // before the next read is due
+  if (auto deadline = _motion.next_deadline())
+    wake_at = std::min(wake_at, *deadline);
+  auto delay = std::chrono::ceil<std::chrono::milliseconds>(
+      wake_at - std::chrono::steady_clock::now());
+  return std::max(delay, std::chrono::milliseconds(0));
+}
 
-  } catch (std::exception &ex) {
+std::shared_ptr<const am5_telemetry_t> zwo_am5_telescope::refresh_telemetry() {
+  auto started = std::chrono::steady_clock::now();
+  auto resps = send_commands_to_mount(
+      {zwoc::cmd_get_current_ra_and_dec(), zwoc::cmd_get_status()});
+
+  auto snapshot = std::make_shared<am5_telemetry_t>();
+  snapshot->timestamp = started;
+
+  // HH:MM:SS&sDD*MM:SS#
+  auto ra_and_dec = zwor::split_on(resps[0], "&");
+  if (ra_and_dec.size() != 2)
     throw alpaca_exception(
-        alpaca_exception::DRIVER_ERROR,
-        fmt::format("Problem sending command to mount: ", ex.what()));
+        alpaca_exception::INVALID_VALUE,
+        fmt::format("problem parsing response {0}", resps[0]));
+  snapshot->right_ascension =
+      zwor::parse_hh_mm_ss_response(ra_and_dec[0] + "#").as_decimal();
+  snapshot->declination =
+      zwor::parse_sdd_mm_ss_response(ra_and_dec[1]).as_decimal();
+
+  snapshot->slewing = status_is_slewing(resps[1]);
+  snapshot->at_home = resps[1].find('H') != std::string::npos;
+  _motion.observe(started, snapshot->slewing);
+
+  std::lock_guard lock(_telemetry_mtx);
+  // A getter may have got in with a newer read while we were parsing
+  if (!_telemetry || _telemetry->timestamp < started)
+    _telemetry = std::move(snapshot);
+  return _telemetry;
+}
+
+bool zwo_am5_telescope::telemetry_is_fresh(
+    std::chrono::milliseconds max_staleness) {
+  return _telemetry && _telemetry->timestamp >= _telemetry_expired_at &&
+         std::chrono::steady_clock::now() - _telemetry->timestamp <=
+             max_staleness;
+}
+
+void zwo_am5_telescope::expire_telemetry() {
+  {
+    std::lock_guard lock(_telemetry_mtx);
+    _telemetry_expired_at = std::chrono::steady_clock::now();
+  }
+  // So it reads the mount now and at the slewing rate
+  wake_telemetry();
+}
+
+std::shared_ptr<const am5_telemetry_t>
+zwo_am5_telescope::telemetry(std::chrono::milliseconds max_staleness) {
+  throw_if_not_connected();
+  {
+    std::lock_guard lock(_telemetry_mtx);
+    if (telemetry_is_fresh(max_staleness))
+      return _telemetry;
+  }
+
+  std::lock_guard refresh_lock(_telemetry_refresh_mtx);
+  {
+    // Someone else may have read the mount while we were waiting
+    std::lock_guard lock(_telemetry_mtx);
+    if (telemetry_is_fresh(max_staleness))
+      return _telemetry;
   }
+  spdlog::trace("telemetry is stale, reading the mount");
+  return refresh_telemetry();
+}
+
+std::shared_ptr<const am5_telemetry_t> zwo_am5_telescope::telemetry() {
+  std::chrono::milliseconds max_staleness;
+  {
+    std::lock_guard lock(_telemetry_mtx);
+    max_staleness = _telemetry_config.max_staleness;
+  }
+  return telemetry(max_staleness);
+}
+
+void zwo_am5_telescope::set_telemetry_config(
+    const am5_telemetry_config_t &config) {
+  {
+    std::lock_guard lock(_telemetry_mtx);
+    _telemetry_config = config;
+  }
+  wake_telemetry();
+}
+
+am5_telemetry_config_t zwo_am5_telescope::telemetry_config() {
+  std::lock_guard lock(_telemetry_mtx);
+  return _telemetry_config;
+}
+
+void zwo_am5_telescope::set_pulse_guide_config(
+    const pulse_guide_config_t &config) {
+  _guide_scheduler.configure(config);
+}
+
+pulse_guide_config_t zwo_am5_telescope::pulse_guide_config() {
+  return _guide_scheduler.config();
+}
+
+astrometry::equatorial_t zwo_am5_telescope::position() {
+  auto snapshot = telemetry();
+  astrometry::equatorial_t read{snapshot->right_ascension,
+                                snapshot->declination};
+  // There's no knowing where a slew has got to, the loop is reading fast
+  // enough then anyway
+  if (snapshot->slewing || _moving)
+    return read;
+  return astrometry::extrapolate(
+      read, std::chrono::steady_clock::now() - snapshot->timestamp,
+      _tracking_enabled, _tracking_rate);
+}
+
+astrometry::site_t zwo_am5_telescope::site() {
+  astrometry::site_t site;
+  site.latitude = _site_latitude;
+  site.longitude = _site_longitude;
+  site.refraction = _does_refraction;
+  return site;
+}
+
+// The site only changes through set_site_latitude / set_site_longitude so it's
+// read once here rather than every time someone asks
+void zwo_am5_telescope::read_site_from_mount() {
+  auto site = lx200::read_site(mount_link());
+  _site_latitude = site.latitude;
+  _site_longitude = site.longitude;
+  _tracking_rate = site.tracking_rate;
+  spdlog::debug("mount site is latitude: {} longitude: {}", _site_latitude,
+                _site_longitude);
 }
 
 uint32_t zwo_am5_telescope::interface_version() { return 3; }
@@ -177,12 +412,8 @@ alignment_mode_enum zwo_am5_telescope::alignment_mode() {
 }
 
 double zwo_am5_telescope::altitude() {
-  throw_if_not_connected();
-
-  std::string resp = send_command_to_mount(zwoc::cmd_get_altitude());
-  zwor::sdd_mm_ss result = zwor::parse_sdd_mm_ss_response(resp);
-
-  return result.as_decimal();
+  auto lst = sidereal_time();
+  return astrometry::to_horizontal(position(), lst, site()).altitude;
 }
 
 double zwo_am5_telescope::aperture_diameter() { return _aperture_diameter; }
@@ -199,29 +430,17 @@ double zwo_am5_telescope::aperture_area() {
   return 0;
 }
 
-// I'm wondering if I need to implement a state machine
-// to store / set states around movement...
+// Includes the settle time after a goto, as ASCOM wants
 bool zwo_am5_telescope::slewing() {
   if (_moving)
     return true;
-  auto resp = send_command_to_mount(zwoc::cmd_get_status());
-  auto last_2_chars = resp.substr(resp.size() - 2, resp.size());
-  // 4 is moving status
-  if (last_2_chars.find("4#") != std::string::npos ||
-      last_2_chars.find("2#") != std::string::npos)
-    return true;
-  spdlog::trace("last_2_chars: {}", last_2_chars);
-  spdlog::trace("resp: {}", resp);
-  return false;
+  // Reading the telemetry keeps the state machine up to date if the loop
+  // hasn't got to it
+  telemetry();
+  return _motion.in_motion();
 }
 
-bool zwo_am5_telescope::at_home() {
-  throw_if_not_connected();
-  std::string resp = send_command_to_mount(zwoc::cmd_get_status());
-  if (resp.find('H') != std::string::npos)
-    return true;
-  return false;
-}
+bool zwo_am5_telescope::at_home() { return telemetry()->at_home; }
 
 // TODO: implement
 bool zwo_am5_telescope::at_park() {
@@ -229,13 +448,9 @@ bool zwo_am5_telescope::at_park() {
   return _parked;
 }
 
-// TODO: implement
 double zwo_am5_telescope::azimuth() {
-  throw_if_not_connected();
-  std::string resp = send_command_to_mount(zwoc::cmd_get_azimuth());
-  spdlog::trace("raw value returned from mount for cmd_get_azimuth(): {0}",
-                resp);
-  return zwor::parse_ddd_mm_ss_response(resp).as_decimal();
+  auto lst = sidereal_time();
+  return astrometry::to_horizontal(position(), lst, site()).azimuth;
 }
 
 // AM5 supports finding home
@@ -332,16 +547,7 @@ bool zwo_am5_telescope::can_unpark() {
   return true;
 }
 
-double zwo_am5_telescope::declination() {
-  throw_if_not_connected();
-  std::string resp = send_command_to_mount(zwoc::cmd_get_current_dec());
-  spdlog::trace("declination returned: {0}", resp);
-  auto parsed_resp = zwor::parse_sdd_mm_ss_response(resp);
-  // The ASCOM driver does this every time it calls :GD#
-  send_command_to_mount(":GFD1#");
-
-  return parsed_resp.as_decimal();
-}
+double zwo_am5_telescope::declination() { return position().declination; }
 
 // Returning 0 because we aren't supporting setting a dec rate
 double zwo_am5_telescope::declination_rate() {
@@ -357,15 +563,16 @@ int zwo_am5_telescope::set_declination_rate(const double &) {
   return 0;
 }
 
+// Only affects the altitudes we work out ourselves, the mount doesn't
+// correct for refraction
 bool zwo_am5_telescope::does_refraction() {
   throw_if_not_connected();
-  return false;
+  return _does_refraction;
 }
 
-int zwo_am5_telescope::set_does_refraction(bool) {
+int zwo_am5_telescope::set_does_refraction(bool does_refraction) {
   throw_if_not_connected();
-  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
-                         "Setting refraction not supported");
+  _does_refraction = does_refraction;
   return 0;
 }
 
@@ -398,7 +605,7 @@ int zwo_am5_telescope::set_guide_rate_declination(const double &rate) {
   throw_if_not_connected();
   spdlog::debug("set_guide_rate_declination called with {} converted to {}",
                 rate, rate / .0042);
-  send_command_to_mount(zwoc::cmd_set_guide_rate(rate / .0042), false);
+  send_command_to_mount(zwoc::cmd_set_guide_rate(rate / .0042));
   return 0;
 }
 
@@ -414,18 +621,11 @@ int zwo_am5_telescope::set_guide_rate_ascension(const double &rate) {
 
 bool zwo_am5_telescope::is_pulse_guiding() {
   spdlog::trace("is_pulse_guiding() invoked");
-  return _is_pulse_guiding;
+  return _guide_scheduler.is_guiding();
 }
 
 double zwo_am5_telescope::right_ascension() {
-  throw_if_not_connected();
-  spdlog::trace("right_ascension() invoked");
-  std::string resp = send_command_to_mount(zwoc::cmd_get_current_ra());
-  spdlog::trace("ra returned: {0}", resp);
-  auto parsed_resp = zwor::parse_hh_mm_ss_response(resp);
-  // The ASCOM driver does this every time it calls :GR#
-  send_command_to_mount(":GFR1#");
-  return parsed_resp.as_decimal();
+  return position().right_ascension;
 }
 
 // I believe this is just 0 as I don't believe the AM5 supports a
@@ -443,8 +643,11 @@ int zwo_am5_telescope::set_right_ascension_rate(const double &) {
 pier_side_enum zwo_am5_telescope::side_of_pier() {
   throw_if_not_connected();
   spdlog::trace("side_of_pier invoked");
-  std::string resp =
-      send_command_to_mount(zwoc::cmd_get_current_cardinal_direction());
+  return pier_side_from(
+      send_command_to_mount(zwoc::cmd_get_current_cardinal_direction()));
+}
+
+pier_side_enum zwo_am5_telescope::pier_side_from(const std::string &resp) {
   spdlog::trace("cmd_get_current_cardinal_direction() returned {0}", resp);
   if (resp.find("W"))
     return pier_side_enum::west;
@@ -461,9 +664,8 @@ int zwo_am5_telescope::set_side_of_pier(const pier_side_enum &) {
 
 double zwo_am5_telescope::sidereal_time() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(zwoc::cmd_get_sidereal_time());
-  auto sidereal_data = zwor::parse_hh_mm_ss_response(resp);
-  return sidereal_data.as_decimal();
+  return astrometry::local_sidereal_time(std::chrono::system_clock::now(),
+                                         _site_longitude);
 }
 
 double zwo_am5_telescope::site_elevation() {
@@ -483,10 +685,7 @@ int zwo_am5_telescope::set_site_elevation(const double &site_elevation) {
 
 double zwo_am5_telescope::site_latitude() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(zwoc::cmd_get_latitude());
-  auto parsed_resp = zwor::parse_sdd_mm_ss_response(resp);
-  spdlog::debug("returning site_latitude: {}", parsed_resp.as_decimal());
-  return parsed_resp.as_decimal();
+  return _site_latitude;
 }
 
 // TODO: add some validation
@@ -501,25 +700,14 @@ int zwo_am5_telescope::set_site_latitude(const double &site_latitude) {
   spdlog::debug(" converts to {}", latitude_s);
   auto resp = send_command_to_mount(
       zwoc::cmd_set_latitude(latitude_s.plus_or_minus, latitude_s.dd,
-                             latitude_s.mm, latitude_s.ss),
-      true, '\0');
+                             latitude_s.mm, latitude_s.ss));
   _site_latitude = site_latitude;
   return 0;
 }
 
 double zwo_am5_telescope::site_longitude() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(zwoc::cmd_get_longitude());
-  auto parsed_resp = zwor::parse_sddd_mm_ss_response(resp);
-
-  // This is a weird behavior from the ASCOM driver I'm mimicking
-  if (parsed_resp.plus_or_minus == '+')
-    parsed_resp.plus_or_minus = '-';
-  else
-    parsed_resp.plus_or_minus = '+';
-  spdlog::debug("returning site_longitude: {}", parsed_resp.as_decimal());
-
-  return parsed_resp.as_decimal();
+  return _site_longitude;
 }
 
 // TODO: add some validation
@@ -539,8 +727,7 @@ int zwo_am5_telescope::set_site_longitude(const double &site_longitude) {
     longitude_s.plus_or_minus = '+';
   auto resp = send_command_to_mount(
       zwoc::cmd_set_longitude(longitude_s.plus_or_minus, longitude_s.ddd,
-                              longitude_s.mm, longitude_s.ss),
-      true, '\0');
+                              longitude_s.mm, longitude_s.ss));
 
   _site_longitude = site_longitude;
   return 0;
@@ -558,6 +745,9 @@ int zwo_am5_telescope::set_slew_settle_time(const int &slew_settle_time) {
     throw alpaca_exception(alpaca_exception::INVALID_VALUE,
                            "slew settle time must be a positive value");
   _slew_settle_time = slew_settle_time;
+  auto config = _motion.config();
+  config.settle_time = std::chrono::seconds(slew_settle_time);
+  _motion.configure(config);
   return 0;
 }
 
@@ -579,8 +769,7 @@ int zwo_am5_telescope::set_target_declination(const double &dec) {
   zwor::sdd_mm_ss converted(dec);
   auto resp = send_command_to_mount(
       zwoc::cmd_set_target_dec(converted.plus_or_minus, converted.dd,
-                               converted.mm, converted.ss),
-      true, '\0');
+                               converted.mm, converted.ss));
   if (resp == "1") {
     _dec_target_set = true;
     return 0;
@@ -607,8 +796,7 @@ int zwo_am5_telescope::set_target_right_ascension(const double &ra) {
   throw_if_not_connected();
   zwor::hh_mm_ss converted(ra);
   auto resp = send_command_to_mount(
-      zwoc::cmd_set_target_ra(converted.hh, converted.mm, converted.ss), true,
-      '\0');
+      zwoc::cmd_set_target_ra(converted.hh, converted.mm, converted.ss));
   if (resp == "1") {
     _ra_target_set = true;
     return 0;
@@ -636,105 +824,91 @@ bool zwo_am5_telescope::tracking() {
   // return false;
 }
 
-int zwo_am5_telescope::set_tracking(const bool &tracking) {
-  using namespace std::chrono_literals;
-  int val = 0;
+bool zwo_am5_telescope::send_tracking(bool tracking) {
   std::string resp;
-  throw_if_not_connected();
-  spdlog::debug("set_tracking invoked with {}", tracking);
   if (tracking)
-    resp = send_command_to_mount(zwoc::cmd_start_tracking(), true, '\0');
+    resp = send_command_to_mount(zwoc::cmd_start_tracking());
   else
-    resp = send_command_to_mount(zwoc::cmd_stop_tracking(), true, '\0');
-  if (resp == "1") {
-    _tracking_enabled = tracking;
-    return 0;
-  } else {
+    resp = send_command_to_mount(zwoc::cmd_stop_tracking());
+  if (resp != "1") {
     auto gat_resp = send_command_to_mount(zwoc::cmd_get_tracking_status());
     spdlog::warn("failed to set tracking status to {}, error: {}", tracking,
                  gat_resp);
-    if (gat_resp == "1#" && tracking) {
-      spdlog::info("ignore warning, mount is tracking.");
-      _tracking_enabled = tracking;
-      return 0;
-    }
+    if (gat_resp != (tracking ? "1#" : "0#"))
+      return false;
+    spdlog::info("ignore warning, mount is {}",
+                 tracking ? "tracking." : "not tracking.");
+  }
+  _tracking_enabled = tracking;
+  _motion.set_tracking(tracking);
+  return true;
+}
 
-    if (gat_resp == "0#" && !tracking) {
-      spdlog::info("ignore warning, mount is not tracking.");
-      _tracking_enabled = tracking;
-      return 0;
-    }
+// Returns straight away. A moving mount turns tracking changes down, so
+// they wait in the motion state machine until it has settled and the
+// telemetry task sends them then. The same goes for the retry when the
+// mount refuses one just after it has stopped.
+int zwo_am5_telescope::set_tracking(const bool &tracking) {
+  throw_if_not_connected();
+  spdlog::debug("set_tracking invoked with {}", tracking);
+  bool moving = _motion.in_motion();
+  if (!moving && send_tracking(tracking))
+    return 0;
 
-    if (gat_resp == "0#" && tracking) {
-      spdlog::debug("is mount moving? {}", slewing());
-      spdlog::debug("waiting 2000ms and retrying tracking");
-      std::this_thread::sleep_for(2000ms);
-      resp = send_command_to_mount(zwoc::cmd_start_tracking(), true, '\0');
-      if (resp == "1") {
-        spdlog::info("ignore previous warning, tracking retry successful");
-        _tracking_enabled = tracking;
-        return 0;
-      } else {
-        gat_resp = send_command_to_mount(zwoc::cmd_get_tracking_status());
-        if (gat_resp == "1#") {
-          spdlog::info("ignore previous warning");
-          _tracking_enabled = tracking;
-          return 0;
-        }
-        spdlog::warn("tracking retry failed: {}", resp);
-      }
-    }
+  spdlog::debug("tracking {} will be set once the mount is at rest",
+                tracking);
+  // Reads back as asked for in the meantime, if the retry fails it gets put
+  // back
+  _tracking_enabled = tracking;
+  _motion.set_tracking(tracking);
+  _motion.defer_tracking(tracking, moving ? std::chrono::milliseconds(0)
+                                          : tracking_retry_delay);
+  // Picks up the new deadline
+  wake_telemetry();
+  return 0;
+}
 
-    if (gat_resp == "1#" && !tracking) {
-      spdlog::debug("is mount moving? {}", slewing());
-      spdlog::debug("waiting 2000ms and retrying tracking");
-      std::this_thread::sleep_for(2000ms);
-      resp = send_command_to_mount(zwoc::cmd_stop_tracking(), true, '\0');
-      if (resp == "1") {
-        spdlog::info("ignore previous warning, tracking retry successful");
-        _tracking_enabled = tracking;
-        return 0;
-      } else {
-        gat_resp = send_command_to_mount(zwoc::cmd_get_tracking_status());
-        if (gat_resp == "0#") {
-          spdlog::info("ignore previous warning");
-          _tracking_enabled = tracking;
-          return 0;
-        }
-        spdlog::warn("tracking retry failed: {}", resp);
-      }
+// Runs on the telemetry task
+void zwo_am5_telescope::apply_deferred_tracking(bool tracking) {
+  try {
+    if (send_tracking(tracking)) {
+      spdlog::info("ignore previous warning, tracking retry successful");
+      return;
     }
-
-    throw alpaca_exception(
-        alpaca_exception::DRIVER_ERROR,
-        fmt::format("Failed to set tracking status: to {}, error: {}", tracking,
-                    gat_resp));
+    spdlog::warn("tracking retry failed, mount is still {}",
+                 tracking ? "not tracking" : "tracking");
+    _tracking_enabled = !tracking;
+    _motion.set_tracking(!tracking);
+  } catch (std::exception &ex) {
+    spdlog::warn("tracking retry failed: {}", ex.what());
   }
-  return -1;
 }
 
 drive_rate_enum zwo_am5_telescope::tracking_rate() {
   auto resp = send_command_to_mount(zwoc::cmd_get_tracking_rate());
-  return static_cast<drive_rate_enum>(zwor::parse_standard_response(resp));
+  _tracking_rate =
+      static_cast<drive_rate_enum>(zwor::parse_standard_response(resp));
+  return _tracking_rate;
 }
 
 int zwo_am5_telescope::set_tracking_rate(const drive_rate_enum &tracking_rate) {
   throw_if_not_connected();
   switch (tracking_rate) {
   case drive_rate_enum::sidereal:
-    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_sidereal(), false);
+    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_sidereal());
     break;
   case drive_rate_enum::solar:
-    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_solar(), false);
+    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_solar());
     break;
   case drive_rate_enum::lunar:
-    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_lunar(), false);
+    send_command_to_mount(zwoc::cmd_set_tracking_rate_to_lunar());
     break;
   default:
     throw alpaca_exception(
         alpaca_exception::INVALID_VALUE,
         fmt::format("Unsupported tracking rate: {}", tracking_rate));
   }
+  _tracking_rate = tracking_rate;
   return 0;
 }
 
@@ -748,13 +922,14 @@ std::vector<drive_rate_enum> zwo_am5_telescope::tracking_rates() {
 std::string zwo_am5_telescope::utc_date() {
   throw_if_not_connected();
 
-  using namespace std::chrono_literals;
-
-  auto raw_resp_t = send_command_to_mount(zwoc::cmd_get_date_and_time_and_tz());
-  spdlog::trace("raw data from scope: {}", raw_resp_t);
+  // All five replies come back from one write instead of five round trips
+  auto resps = send_commands_to_mount(
+      {zwoc::cmd_get_date_and_time_and_tz(), zwoc::cmd_get_timezone(),
+       zwoc::cmd_get_daylight_savings(), zwoc::cmd_get_date(),
+       zwoc::cmd_get_time()});
+  spdlog::trace("raw data from scope: {}", resps[0]);
 
-  auto tz_resp = send_command_to_mount(zwoc::cmd_get_timezone());
-  zwor::shh_mm tz_data = zwor::parse_shh_mm_response(tz_resp);
+  zwor::shh_mm tz_data = zwor::parse_shh_mm_response(resps[1]);
 
   // This is recreating a strange behavior that the ASCOM driver does
   if (tz_data.plus_or_minus == '+')
@@ -762,14 +937,15 @@ std::string zwo_am5_telescope::utc_date() {
   else
     tz_data.plus_or_minus = '+';
 
-  auto dst_resp = send_command_to_mount(zwoc::cmd_get_daylight_savings());
-  int d_savings = zwor::parse_standard_response(dst_resp);
-
+  int d_savings = zwor::parse_standard_response(resps[2]);
   spdlog::trace("mount believes daylight savings is: {}", d_savings);
-  auto date_resp = send_command_to_mount(zwoc::cmd_get_date());
-  zwor::mm_dd_yy date_data = zwor::parse_mm_dd_yy_response(date_resp);
 
-  auto time_resp = send_command_to_mount(zwoc::cmd_get_time());
+  return utc_date_from(resps[3], resps[4]);
+}
+
+std::string zwo_am5_telescope::utc_date_from(const std::string &date_resp,
+                                             const std::string &time_resp) {
+  zwor::mm_dd_yy date_data = zwor::parse_mm_dd_yy_response(date_resp);
   zwor::hh_mm_ss time_data = zwor::parse_hh_mm_ss_response(time_resp);
 
   // This particular section is using the older time / date stuff
@@ -829,7 +1005,7 @@ int zwo_am5_telescope::set_utc_date(const std::string &utc_date_str) {
   }
 
   // Set DST to 0
-  send_command_to_mount(zwoc::cmd_set_daylight_savings(0), true, '\0');
+  send_command_to_mount(zwoc::cmd_set_daylight_savings(0));
 
   spdlog::debug("calculated offset: {}", offset_minutes);
 
@@ -868,19 +1044,17 @@ int zwo_am5_telescope::set_utc_date(const std::string &utc_date_str) {
     tz_mm = 30;
 
   auto resp = send_command_to_mount(
-      zwoc::cmd_set_timezone(plus_or_minus_tz, tz_hh), true, '\0');
+      zwoc::cmd_set_timezone(plus_or_minus_tz, tz_hh));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting date with driver");
 
-  resp = send_command_to_mount(zwoc::cmd_set_date(date_mm, date_dd, date_yy),
-                               true, '\0');
+  resp = send_command_to_mount(zwoc::cmd_set_date(date_mm, date_dd, date_yy));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting date with driver");
 
-  resp = send_command_to_mount(zwoc::cmd_set_time(time_hh, time_mm, time_ss),
-                               true, '\0');
+  resp = send_command_to_mount(zwoc::cmd_set_time(time_hh, time_mm, time_ss));
   if (resp != "1")
     throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
                            "Problem setting time with driver");
@@ -898,7 +1072,8 @@ int zwo_am5_telescope::abort_slew() {
   throw_if_not_connected();
   throw_if_parked();
   spdlog::debug("abort_slew() invoked");
-  send_command_to_mount(zwoc::cmd_stop_moving(), false);
+  send_command_to_mount(zwoc::cmd_stop_moving());
+  _motion.abort();
   return 0;
 }
 
@@ -926,61 +1101,23 @@ bool zwo_am5_telescope::can_move_axis(const telescope_axes_enum &axis) {
   return false;
 }
 
-// TODO: perhaps consider implementing this. I think I would have to
-// make a guess based on target RA / DEC
+// A guess from the target's hour angle, the mount's meridian settings could
+// still have it track past the meridian on the other side
 pier_side_enum zwo_am5_telescope::destination_side_of_pier(const double &ra,
                                                            const double &dec) {
   throw_if_not_connected();
-  throw alpaca_exception(alpaca_exception::NOT_IMPLEMENTED,
-                         "This is not currently implemented");
-  return pier_side_enum::unknown;
+  return astrometry::destination_side_of_pier({ra, dec}, sidereal_time());
 }
 
-// TODO: potentially encapsulate the execution of the telescope command
-// in here
-class blocking_telescope_command {
-  asio::io_context _io_ctx;
-  asio::steady_timer _t;
-  zwo_am5_telescope &_telescope;
-  bool _is_done_moving;
-
-public:
-  blocking_telescope_command(zwo_am5_telescope &telescope)
-      : _t(_io_ctx), _telescope(telescope), _is_done_moving(false) {}
-
-  void check_is_slewing() {
-    using namespace std::chrono_literals;
-    _t.expires_from_now(100ms);
-    if (_telescope.slewing()) {
-      _t.expires_from_now(100ms);
-    } else {
-      _is_done_moving = true;
-      _t.cancel();
-    }
-  }
-
-  bool is_still_moving() {
-    using namespace std::chrono_literals;
-    _io_ctx.reset();
-    _t.async_wait(
-        std::bind(&blocking_telescope_command::check_is_slewing, this));
-    _t.expires_from_now(100ms);
-    _io_ctx.run();
-    return !_is_done_moving;
-  }
-
-  void run() {
-    while (is_still_moving())
-      ;
-  }
-};
-
-// block until not moving
+// Synchronous slews wait here. The telemetry task reads the mount quickly
+// while it's moving and the state machine wakes us once it has stopped and
+// the settle time is up, or the slew is aborted.
 void zwo_am5_telescope::block_while_moving() {
-  using namespace std::chrono_literals;
   spdlog::trace("block_while_moving invoked");
-  blocking_telescope_command cmd(*this);
-  cmd.run();
+  if (!_motion.wait_until_settled(slew_timeout))
+    throw alpaca_exception(alpaca_exception::DRIVER_ERROR,
+                           "timed out waiting for the mount to stop slewing");
+  throw_if_not_connected();
 }
 
 int zwo_am5_telescope::find_home() {
@@ -988,10 +1125,9 @@ int zwo_am5_telescope::find_home() {
   throw_if_not_connected();
   throw_if_parked();
   spdlog::debug("find_home invoked");
-  send_command_to_mount(zwo_commands::cmd_home_position(), false);
-  // block_while_moving();
-  // spdlog::debug("initial timer has ended");
-  // block_while_moving();
+  send_command_to_mount(zwo_commands::cmd_home_position());
+  // Slewing and AtHome follow it from here
+  begin_motion(motion_kind_enum::home);
   return 0;
 }
 
@@ -1019,30 +1155,30 @@ int zwo_am5_telescope::move_axis(const telescope_axes_enum &axis,
   case telescope_axes_enum::primary:
     set_is_moving(true);
     send_command_to_mount(
-        zwoc::cmd_set_moving_speed_precise(std::abs(rate) / .0042), false);
+        zwoc::cmd_set_moving_speed_precise(std::abs(rate) / .0042));
     if (rate > 0)
-      send_command_to_mount(zwoc::cmd_move_towards_east(), false);
+      send_command_to_mount(zwoc::cmd_move_towards_east());
     else if (rate < 0)
-      send_command_to_mount(zwoc::cmd_move_towards_west(), false);
+      send_command_to_mount(zwoc::cmd_move_towards_west());
     else {
       set_is_moving(false);
-      send_command_to_mount(zwoc::cmd_stop_moving_towards_east(), false);
-      send_command_to_mount(zwoc::cmd_stop_moving_towards_west(), false);
+      send_command_to_mount(zwoc::cmd_stop_moving_towards_east());
+      send_command_to_mount(zwoc::cmd_stop_moving_towards_west());
     }
     break;
   // Dec
   case telescope_axes_enum::secondary:
     set_is_moving(true);
     send_command_to_mount(
-        zwoc::cmd_set_moving_speed_precise(std::abs(rate) / .0042), false);
+        zwoc::cmd_set_moving_speed_precise(std::abs(rate) / .0042));
     if (rate > 0)
-      send_command_to_mount(zwoc::cmd_move_towards_north(), false);
+      send_command_to_mount(zwoc::cmd_move_towards_north());
     else if (rate < 0)
-      send_command_to_mount(zwoc::cmd_move_towards_south(), false);
+      send_command_to_mount(zwoc::cmd_move_towards_south());
     else {
       set_is_moving(false);
-      send_command_to_mount(zwoc::cmd_stop_moving_towards_south(), false);
-      send_command_to_mount(zwoc::cmd_stop_moving_towards_north(), false);
+      send_command_to_mount(zwoc::cmd_stop_moving_towards_south());
+      send_command_to_mount(zwoc::cmd_stop_moving_towards_north());
     }
     break;
   default:
@@ -1064,114 +1200,15 @@ int zwo_am5_telescope::park() {
     return 0;
 
   spdlog::trace("sending cmd_park()");
-  // send_command_to_mount(zwoc::cmd_park(), false);
+  // send_command_to_mount(zwoc::cmd_park());
   spdlog::trace("waiting for mount to park");
   // std::this_thread::sleep_for(30s);  spdlog::debug("blocking while moving");
   // block_while_moving();
   _parked = true;
+  _motion.set_parked(true);
   return 0;
 }
 
-void zwo_am5_telescope::pulse_guide_proc(int duration_ms,
-                                         char cardinal_direction) {
-  using namespace std::chrono_literals;
-  auto guide_rate = guide_rate_ascension();
-
-  spdlog::debug("running guide thread");
-  _is_pulse_guiding = true;
-
-  // a 10 arc second movement is 10 / 15 seconds of time (ignoring sidereal
-  // adjustment) i.e. 0.667 seconds. Also approx 15.042 arcseconds per second
-  // of real time.
-  //
-  // 2000ms in equatorial movement should translate to 2 arc-seconds of movement
-  // using the aforementioned conversion, assuming the guide rate is 1x sidereal
-  // rate (which won't necessarily be the case), which means we can divide
-  // 2000/15.042 which will give us our pulse duration. We should then divide
-  // that by our guide rate.
-  //
-  // However, this doesn't seem to work as expected. I suspect the AM5 driver
-  //
-
-  int remaining_duration_ms = duration_ms * .7;
-
-  // We will do multiple guide commands if needed
-  if (remaining_duration_ms > 3000) {
-    int count = remaining_duration_ms / 3000;
-    remaining_duration_ms = remaining_duration_ms % 3000;
-
-    spdlog::debug("issuing multiple guide commands");
-    for (int i = 0; i < count; i++) {
-      spdlog::debug("guiding {}/{}", i + 1, count);
-      send_command_to_mount(zwoc::cmd_guide(cardinal_direction, 3000), false);
-      std::this_thread::sleep_for(std::chrono::milliseconds(3000));
-    }
-  }
-
-  send_command_to_mount(
-      zwoc::cmd_guide(cardinal_direction, remaining_duration_ms), false);
-  spdlog::debug("sleeping for {}", remaining_duration_ms);
-
-  std::this_thread::sleep_for(std::chrono::milliseconds(remaining_duration_ms));
-
-  _is_pulse_guiding = false;
-  spdlog::debug("pulse guide thread finished");
-}
-
-// The big problem with this I think is that the scope stops tracking when
-// a move command is issued. Therefore when a Dec guide is issued, it
-// will drift in RA.
-void zwo_am5_telescope::pulse_guide_proc_using_move(int duration_ms,
-                                                    char cardinal_direction) {
-  spdlog::debug("running guide thread with move instead of guide");
-  // _is_pulse_guiding = true;
-
-  using namespace std::chrono_literals;
-
-  // auto axis = telescope_axes_enum::primary;
-  // int rate_direction = 1;
-
-  // if (cardinal_direction == 'n' || cardinal_direction == 's')
-  //   axis = telescope_axes_enum::secondary;
-
-  auto side = side_of_pier();
-
-  auto pulse_duration_ms = std::chrono::milliseconds((duration_ms * 10) / 15);
-
-  send_command_to_mount(zwoc::cmd_set_0_5x_sidereal_rate(), false);
-
-  switch (cardinal_direction) {
-  case 'e':
-    send_command_to_mount(zwoc::cmd_move_towards_east(), false);
-    std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(zwoc::cmd_stop_moving_towards_east(), false);
-    break;
-  case 'w':
-    send_command_to_mount(zwoc::cmd_move_towards_west(), false);
-    std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(zwoc::cmd_stop_moving_towards_west(), false);
-    break;
-  case 'n':
-    send_command_to_mount(zwoc::cmd_move_towards_north(), false);
-    std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(zwoc::cmd_stop_moving_towards_north(), false);
-    break;
-  case 's':
-    send_command_to_mount(zwoc::cmd_move_towards_south(), false);
-    std::this_thread::sleep_for(pulse_duration_ms);
-    send_command_to_mount(zwoc::cmd_stop_moving_towards_south(), false);
-    break;
-  default:
-    _is_pulse_guiding = false;
-    throw alpaca_exception(
-        alpaca_exception::INVALID_VALUE,
-        fmt::format("cardinal direction {} is not valid", cardinal_direction));
-  }
-
-  _is_pulse_guiding = false;
-  spdlog::debug("pulse guide thread using move finished");
-}
-
 //  Duration parameter specifies the amount (in equatorial coordinates)
 //  so 3000ms would be 3 arc-seconds I believe
 //  I'm wondering if I need to take this and rationalize it into a movement that
@@ -1181,11 +1218,8 @@ int zwo_am5_telescope::pulse_guide(const guide_direction_enum &direction,
   throw_if_not_connected();
   throw_if_parked();
   char cardinal_direction = 0;
-  int remaining_duration_ms = duration_ms;
-  auto guide_rate = guide_rate_ascension();
-  spdlog::debug(
-      "pulse_guide() invoked with direction: {}, duration: {}ms with rate:{}",
-      direction, duration_ms, guide_rate);
+  spdlog::debug("pulse_guide() invoked with direction: {}, duration: {}ms",
+                direction, duration_ms);
   switch (direction) {
   case guide_direction_enum::guide_east:
     cardinal_direction = 'e';
@@ -1204,16 +1238,8 @@ int zwo_am5_telescope::pulse_guide(const guide_direction_enum &direction,
                            "invalid guide direction");
   }
 
-  _is_pulse_guiding = true;
-
-  spdlog::debug("creating guiding thread");
-  _guiding_thread =
-      std::thread(std::bind(&zwo_am5_telescope::pulse_guide_proc, this,
-                            duration_ms, cardinal_direction));
-
-  _guiding_thread.detach();
-  spdlog::debug("guiding thread detached");
-
+  // The scheduler thread sends it, we only wait for it to be queued
+  _guide_scheduler.submit(cardinal_direction, duration_ms);
   return 0;
 }
 
@@ -1262,10 +1288,10 @@ int zwo_am5_telescope::slew_to_coordinates(const double &ra,
       zwoc::cmd_set_target_ra_and_dec_and_goto(
           converted_ra.hh, converted_ra.mm, converted_ra.ss,
           converted_dec.plus_or_minus, converted_dec.dd, converted_dec.mm,
-          converted_dec.ss),
-      true, '0');
+          converted_dec.ss));
 
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     block_while_moving();
     return 0;
   } else {
@@ -1302,10 +1328,10 @@ int zwo_am5_telescope::slew_to_coordinates_async(const double &ra,
       zwoc::cmd_set_target_ra_and_dec_and_goto(
           converted_ra.hh, converted_ra.mm, converted_ra.ss,
           converted_dec.plus_or_minus, converted_dec.dd, converted_dec.mm,
-          converted_dec.ss),
-      true, '0');
+          converted_dec.ss));
 
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     return 0;
   } else {
     spdlog::warn("error returned from mount on slew_to_coordinates_async: {}",
@@ -1323,8 +1349,9 @@ int zwo_am5_telescope::slew_to_target() {
     throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
                            "RA and DEC target must be set");
   spdlog::debug("slew_to_target invoked");
-  auto resp = send_command_to_mount(zwoc::cmd_goto(), true, '0');
+  auto resp = send_command_to_mount(zwoc::cmd_goto());
   if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     block_while_moving();
     return 0;
   } else {
@@ -1341,12 +1368,13 @@ int zwo_am5_telescope::slew_to_target_async() {
     throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
                            "RA and DEC target must be set");
   spdlog::debug("slew_to_target_async invoked");
-  auto resp = send_command_to_mount(zwoc::cmd_goto(), true, '0');
-  if (resp == "0")
+  auto resp = send_command_to_mount(zwoc::cmd_goto());
+  if (resp == "0") {
+    begin_motion(motion_kind_enum::slew);
     return 0;
-  else
-    throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
-                           fmt::format("goto failed. {}", resp));
+  }
+  throw alpaca_exception(alpaca_exception::INVALID_OPERATION,
+                         fmt::format("goto failed. {}", resp));
 }
 
 int zwo_am5_telescope::sync_to_alt_az(const double &alt, const double &az) {
@@ -1399,9 +1427,10 @@ int zwo_am5_telescope::sync_to_target() {
 int zwo_am5_telescope::unpark() {
   throw_if_not_connected();
   // Move scope back to home position on unpark
-  // send_command_to_mount(zwo_commands::cmd_home_position(), false);
+  // send_command_to_mount(zwo_commands::cmd_home_position());
   // block_while_moving();
   _parked = false;
+  _motion.set_parked(false);
   return 0;
 }
 
@@ -1419,7 +1448,7 @@ std::string zwo_am5_telescope::get_serial_device_path() {
 
 std::string zwo_am5_telescope::get_serial_number() {
   throw_if_not_connected();
-  auto resp = send_command_to_mount(":GMA#");
+  auto resp = send_command_to_mount(zwoc::cmd_get_serial_number());
   return resp.substr(0, resp.size() - 1);
 }
 
@@ -1430,22 +1459,40 @@ zwo_am5_telescope::details() {
   detail_map["Serial Device"] = _serial_device_path;
   if (_connected) {
     // try {
-      detail_map["UTCDate"] = utc_date();
-      detail_map["RightAscension"] = right_ascension();
-      detail_map["Declination"] = declination();
-      detail_map["Azimuth"] = azimuth();
-      detail_map["Altitude"] = altitude();
+      // Positions come from the telemetry, the rest in one sweep instead of
+      // a round trip per property. The date / time trace commands utc_date()
+      // sends are left out.
+      auto snapshot = telemetry();
+      auto resps = send_commands_to_mount(
+          {zwoc::cmd_get_date(), zwoc::cmd_get_time(),
+           zwoc::cmd_get_current_cardinal_direction()});
+      auto equatorial = position();
+      auto lst = sidereal_time();
+      auto horizontal = astrometry::to_horizontal(equatorial, lst, site());
+      detail_map["UTCDate"] = utc_date_from(resps[0], resps[1]);
+      detail_map["RightAscension"] = equatorial.right_ascension;
+      detail_map["Declination"] = equatorial.declination;
+      detail_map["Azimuth"] = horizontal.azimuth;
+      detail_map["Altitude"] = horizontal.altitude;
       detail_map["SiteLatitude"] = _site_latitude;
       detail_map["SiteLongitude"] = _site_longitude;
       detail_map["SiteElevation"] = _site_elevation;
-      detail_map["SiderealTime"] = sidereal_time();
-      detail_map["SideOfPier"] = side_of_pier();
+      detail_map["SiderealTime"] = lst;
+      detail_map["SideOfPier"] = pier_side_from(resps[2]);
+      detail_map["TelemetryAge_ms"] =
+          std::chrono::duration<double, std::milli>(
+              std::chrono::steady_clock::now() - snapshot->timestamp)
+              .count();
       detail_map["Tracking"] = _tracking_enabled;
-      detail_map["Slewing"] = _moving;
+      detail_map["Slewing"] = _moving || _motion.in_motion();
+      detail_map["MotionState"] = motion_state_name(_motion.state());
     // } catch (alpaca_exception &e) {
     //   spdlog::warn("problem fetching details: ", e.what());
     // }
   }
+  detail_map["SerialLatency"] = _serial->latency().summary();
+  detail_map["PulseGuide"] = _guide_scheduler.summary();
+  detail_map["Motion"] = _motion.summary();
 
   return detail_map;
 };
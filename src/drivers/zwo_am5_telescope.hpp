@@ -6,6 +6,11 @@
 #include "asio/serial_port.hpp"
 #include "common/alpaca_exception.hpp"
 #include "common/alpaca_hub_serial.hpp"
+#include "common/astrometry.hpp"
+#include "common/lx200_mount_link.hpp"
+#include "common/motion_state_machine.hpp"
+#include "common/pulse_guide_scheduler.hpp"
+#include "common/serial_reactor.hpp"
 #include "date/date.h"
 #include "date/tz.h"
 #include "fmt/chrono.h"
@@ -15,6 +20,7 @@
 #include <asio/steady_timer.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <ctime>
 #include <functional>
@@ -37,6 +43,30 @@ inline auto format_as(drive_rate_enum s) { return fmt::underlying(s); }
 inline auto format_as(telescope_axes_enum s) { return fmt::underlying(s); }
 inline auto format_as(guide_direction_enum s) { return fmt::underlying(s); }
 
+// What the telemetry task last read off the mount. Each read makes a new one
+// and nothing changes it afterwards, so the getters can hand out the
+// shared_ptr without holding a lock while they use it. Alt / az and sidereal
+// time aren't read, they're worked out from this and the site.
+struct am5_telemetry_t {
+  // When the read started, anything sent to the mount after this may not be
+  // reflected in it
+  std::chrono::steady_clock::time_point timestamp;
+  double right_ascension = 0;
+  double declination = 0;
+  bool slewing = false;
+  bool at_home = false;
+};
+
+struct am5_telemetry_config_t {
+  // How often the telemetry task reads the mount in each state
+  std::chrono::milliseconds slewing_interval{250};
+  // Between reads the position is extrapolated so these can be slow
+  std::chrono::milliseconds tracking_interval{2000};
+  std::chrono::milliseconds idle_interval{2000};
+  // Getters read the mount themselves rather than return anything older
+  std::chrono::milliseconds max_staleness{3000};
+};
+
 class zwo_am5_telescope : public i_alpaca_telescope {
 public:
   static std::vector<std::string> serial_devices();
@@ -143,31 +173,77 @@ public:
   int set_serial_device(const std::string &);
   std::string get_serial_device_path();
 
-  std::string send_command_to_mount(const std::string &cmd,
-                                    bool read_response = true,
-                                    char stop_on_char = '#');
+  std::string send_command_to_mount(std::string_view cmd);
+  // Pipelines cmds and returns one reply per command, in the same order
+  std::vector<std::string>
+  send_commands_to_mount(const std::vector<lx200::command_t> &cmds);
 
   std::string get_serial_number();
+
+  // The latest telemetry, read fresh first if it's older than max_staleness
+  // or predates a command that moved the mount
+  std::shared_ptr<const am5_telemetry_t>
+  telemetry(std::chrono::milliseconds max_staleness);
+  std::shared_ptr<const am5_telemetry_t> telemetry();
+  void set_telemetry_config(const am5_telemetry_config_t &config);
+  am5_telemetry_config_t telemetry_config();
+
+  void set_pulse_guide_config(const pulse_guide_config_t &config);
+  pulse_guide_config_t pulse_guide_config();
+
 private:
-  asio::io_context _io_ctx;
+  std::string utc_date_from(const std::string &date_resp,
+                            const std::string &time_resp);
+  pier_side_enum pier_side_from(const std::string &resp);
+  static bool status_is_slewing(const std::string &status);
+
+  // Where the mount is pointing now, the telemetry carried forward by
+  // however long ago it was read
+  astrometry::equatorial_t position();
+  astrometry::site_t site();
+  void read_site_from_mount();
+  // What send_command_to_mount and friends go through
+  lx200::mount_link_t mount_link();
+
+  void start_telemetry();
+  void stop_telemetry();
+  // Runs on the reactor's poll pool, returns when it wants to run next
+  std::chrono::milliseconds telemetry_proc();
+  // Gets the telemetry task to read the mount now instead of when it's due
+  void wake_telemetry();
+  void begin_motion(motion_kind_enum kind);
+  // Caller holds _telemetry_refresh_mtx
+  std::shared_ptr<const am5_telemetry_t> refresh_telemetry();
+  // Caller holds _telemetry_mtx
+  bool telemetry_is_fresh(std::chrono::milliseconds max_staleness);
+  void expire_telemetry();
+
+  // Guards _telemetry, _telemetry_config, _telemetry_expired_at and
+  // _telemetry_task
+  std::mutex _telemetry_mtx;
+  // Held for a whole read so two stale getters don't both go to the mount
+  std::mutex _telemetry_refresh_mtx;
+  alpaca_hub_serial::polled_task_ptr_t _telemetry_task;
+  std::shared_ptr<const am5_telemetry_t> _telemetry;
+  am5_telemetry_config_t _telemetry_config;
+  std::chrono::steady_clock::time_point _telemetry_expired_at;
+
   std::mutex _telescope_mtx;
   std::mutex _moving_mtx;
   std::string _serial_device_path;
-  std::thread _guiding_thread;
 
-  // TODO: need to see
-  // why I have 2 io_contexts declared. It is probably just a mistake.
-  asio::io_context _io_context;
-  asio::serial_port _serial_port;
+  alpaca_hub_serial::serial_channel_ptr_t _serial;
   bool _connected;
   double _aperture_diameter;
   double _focal_length;
   void throw_if_not_connected();
   void throw_if_parked();
+  // Waits for the motion state machine, the telemetry task does the polling
   void block_while_moving();
   void set_is_moving(bool);
-  void pulse_guide_proc(int duration_ms, char cardinal_direction);
-  void pulse_guide_proc_using_move(int duration_ms, char cardinal_direction);
+  // true if the mount ended up with tracking as asked
+  bool send_tracking(bool tracking);
+  void apply_deferred_tracking(bool tracking);
   double _site_elevation;
   double _site_latitude;
   double _site_longitude;
@@ -175,10 +251,16 @@ private:
   double _slew_settle_time;
   bool _parked;
   bool _moving;
-  bool _is_pulse_guiding;
   bool _ra_target_set;
   bool _dec_target_set;
   bool _tracking_enabled;
+  drive_rate_enum _tracking_rate;
+  bool _does_refraction;
+  // Fed by the telemetry task
+  motion_state_machine_t _motion;
+
+  // Last so it's gone before anything it sends commands through
+  pulse_guide_scheduler_t _guide_scheduler;
 };
 
 #endif
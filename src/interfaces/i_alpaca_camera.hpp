@@ -1,6 +1,7 @@
 #ifndef I_ALPACA_CAMERA_HPP
 #define I_ALPACA_CAMERA_HPP
 
+#include "common/camera_frame.hpp"
 #include "i_alpaca_device.hpp"
 #include <cstdint>
 
@@ -47,9 +48,11 @@ public:
   virtual double heat_sink_temperature() = 0;
 
   virtual int image_array(std::vector<uint8_t> &theImage) = 0;
-  // template <typename T> std::vector<std::vector<T>> image_2d();
-  // template <> std::vector<std::vector<uint8_t>> image_2d();
-  virtual std::vector<std::vector<uint32_t>> image_2d() = 0;
+  // Returns the most recent frame. The frame is immutable and shared, so
+  // callers can hold on to it for as long as a download takes even if
+  // another exposure completes in the meantime. Returns nullptr if there is
+  // no frame yet.
+  virtual camera_frame_ptr_t last_frame() = 0;
   virtual bool image_ready() = 0;
   virtual bool is_pulse_guiding() = 0;
   virtual std::string last_error() = 0;
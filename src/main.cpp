@@ -2,8 +2,15 @@
 #include "drivers/pegasus_alpaca_ppba.hpp"
 #include "drivers/primaluce_focuser_rotator.hpp"
 #include "drivers/qhy_alpaca_filterwheel_standalone.hpp"
+#include "drivers/simulated_camera.hpp"
+#include "drivers/simulated_filterwheel.hpp"
+#include "drivers/simulated_focuser.hpp"
+#include "drivers/simulated_rotator.hpp"
+#include "drivers/simulated_switch.hpp"
+#include "drivers/simulated_telescope.hpp"
 #include "drivers/zwo_am5_telescope.hpp"
 #include "server/alpaca_hub_server.hpp"
+#include <optional>
 #include <ostream>
 
 static asio::io_context io_ctx(1);
@@ -78,6 +85,25 @@ void discovery_thread_proc() {
   spdlog::debug("exiting discovery_thread_proc");
 }
 
+// One of each kind of device with nothing behind it, for trying out clients
+// and the server without any hardware plugged in
+static void add_simulated_devices(bool auto_connect_devices) {
+  std::vector<std::pair<std::string, std::shared_ptr<i_alpaca_device>>>
+      devices{{"camera", std::make_shared<simulated_camera>()},
+              {"filterwheel", std::make_shared<simulated_filterwheel>()},
+              {"telescope", std::make_shared<simulated_telescope>()},
+              {"focuser", std::make_shared<simulated_focuser>()},
+              {"rotator", std::make_shared<simulated_rotator>()},
+              {"switch", std::make_shared<simulated_switch>()}};
+
+  for (auto &[device_type, device_ptr] : devices) {
+    spdlog::info("Adding simulated {}: {}", device_type, device_ptr->name());
+    alpaca_hub_server::device_map[device_type].push_back(device_ptr);
+    if (auto_connect_devices)
+      device_ptr->set_connected(true);
+  }
+}
+
 int main(int argc, char **argv) {
   spdlog::set_default_logger(core_logger);
 
@@ -99,6 +125,8 @@ int main(int argc, char **argv) {
   bool auto_connect_devices = false;
   bool gains_value_mode = false;
   bool offsets_value_mode = false;
+  bool huge_page_frame_buffers = false;
+  bool simulate_devices = false;
 
   for (int i = 1; i < argc; i++) {
     if (std::string(argv[i]) == "-cw") {
@@ -117,6 +145,15 @@ int main(int argc, char **argv) {
       gains_value_mode = true;
     }
 
+    if (std::string(argv[i]) == "-hp") {
+      huge_page_frame_buffers = true;
+    }
+
+    if (std::string(argv[i]) == "-sim" ||
+        std::string(argv[i]) == "--simulate") {
+      simulate_devices = true;
+    }
+
     else if (i + 1 < argc) {
       std::string arg = argv[i];
       std::string arg_v = argv[i + 1];
@@ -162,6 +199,39 @@ int main(int argc, char **argv) {
         << std::endl
         << std::endl
         << "  -gv                    Force camera gain value mode " << std::endl
+        << std::endl
+        << "  -hp                    Use huge pages for camera frame buffers "
+        << std::endl
+        << std::endl
+        << "  -sim, --simulate       Serve a simulated camera, filter wheel, "
+        << std::endl
+        << "                         mount, focuser, rotator and switch "
+           "instead"
+        << std::endl
+        << "                         of looking for hardware" << std::endl
+        << std::endl
+        << "  -sts FACTOR            Serial timeouts are FACTOR times the "
+           "slowest"
+        << std::endl
+        << "                         recent reply. Default is 2, 0 turns "
+           "adaptive"
+        << std::endl
+        << "                         serial timeouts off" << std::endl
+        << std::endl
+        << "  -stf MS                Adaptive serial timeouts never go "
+           "below MS"
+        << std::endl
+        << "                         milliseconds. Default is 5" << std::endl
+        << std::endl
+        << "  -mts MS                Mount positions are never more than MS"
+        << std::endl
+        << "                         milliseconds old. Default is 3000"
+        << std::endl
+        << std::endl
+        << "  -pgs FACTOR            AM5 pulse guide durations are multiplied "
+           "by"
+        << std::endl
+        << "                         FACTOR. Default is 1" << std::endl
         << std::endl;
 
     return 0;
@@ -210,6 +280,34 @@ int main(int argc, char **argv) {
     run_discovery = false;
   }
 
+  auto serial_timeouts =
+      alpaca_hub_serial::serial_reactor::instance().adaptive_timeouts();
+
+  cli_map_iter = cli_args.find("-sts");
+  if (cli_map_iter != cli_args.end()) {
+    serial_timeouts.safety_factor = std::stod(cli_map_iter->second);
+    serial_timeouts.enabled = serial_timeouts.safety_factor > 0;
+  }
+
+  cli_map_iter = cli_args.find("-stf");
+  if (cli_map_iter != cli_args.end())
+    serial_timeouts.floor =
+        std::chrono::milliseconds(std::stoi(cli_map_iter->second));
+
+  alpaca_hub_serial::serial_reactor::instance().set_adaptive_timeouts(
+      serial_timeouts);
+
+  am5_telemetry_config_t mount_telemetry;
+  cli_map_iter = cli_args.find("-mts");
+  if (cli_map_iter != cli_args.end())
+    mount_telemetry.max_staleness =
+        std::chrono::milliseconds(std::stoi(cli_map_iter->second));
+
+  std::optional<double> pulse_guide_scale;
+  cli_map_iter = cli_args.find("-pgs");
+  if (cli_map_iter != cli_args.end())
+    pulse_guide_scale = std::stod(cli_map_iter->second);
+
   spdlog::info("Starting AlpacaHub");
   alpaca_hub_server::device_map["camera"] =
       std::vector<std::shared_ptr<i_alpaca_device>>();
@@ -221,102 +319,114 @@ int main(int argc, char **argv) {
       std::vector<std::shared_ptr<i_alpaca_device>>();
   alpaca_hub_server::device_map["rotator"] =
       std::vector<std::shared_ptr<i_alpaca_device>>();
+  alpaca_hub_server::device_map["switch"] =
+      std::vector<std::shared_ptr<i_alpaca_device>>();
 
   // BEGIN Implementation specific initialization of various device types:
   // TODO: figure out how to setup the implementation specific pieces in a
   // different part of the project to make it more extensible and clean.
 
-  for (auto iter : zwo_am5_telescope::serial_devices()) {
-    auto telescope_ptr = std::make_shared<zwo_am5_telescope>();
-    telescope_ptr->set_serial_device(iter);
-    spdlog::info("Adding ZWO mount at {}", iter);
-    alpaca_hub_server::device_map["telescope"].push_back(telescope_ptr);
+  if (simulate_devices) {
+    add_simulated_devices(auto_connect_devices);
+  } else {
+    for (auto iter : zwo_am5_telescope::serial_devices()) {
+      auto telescope_ptr = std::make_shared<zwo_am5_telescope>();
+      telescope_ptr->set_serial_device(iter);
+      telescope_ptr->set_telemetry_config(mount_telemetry);
+      if (pulse_guide_scale) {
+        auto guide_config = telescope_ptr->pulse_guide_config();
+        guide_config.duration_scale = *pulse_guide_scale;
+        telescope_ptr->set_pulse_guide_config(guide_config);
+      }
+      spdlog::info("Adding ZWO mount at {}", iter);
+      alpaca_hub_server::device_map["telescope"].push_back(telescope_ptr);
 
-    if (auto_connect_devices) {
-      spdlog::info("Attempting to autoconnect: {}", iter);
-      try {
-        telescope_ptr->set_connected(true);
-      } catch (std::exception &ex) {
-        spdlog::error("Failed to autoconnect device: {}", iter);
+      if (auto_connect_devices) {
+        spdlog::info("Attempting to autoconnect: {}", iter);
+        try {
+          telescope_ptr->set_connected(true);
+        } catch (std::exception &ex) {
+          spdlog::error("Failed to autoconnect device: {}", iter);
+        }
       }
     }
-  }
-
-  try {
-    auto focuser_ptr = std::make_shared<esatto_focuser>(
-        "/dev/serial/by-id/"
-        "usb-Silicon_Labs_CP2102N_USB_to_UART_Bridge_Controller_"
-        "b2f14184e185eb11ad7b8b1ab7d59897-if00-port0");
-    alpaca_hub_server::device_map["focuser"].push_back(focuser_ptr);
 
     try {
-      focuser_ptr->init_rotator();
-    } catch (std::exception &ex) {
-      spdlog::error("Failed to init arco device: {}", ex.what());
-    }
-
-    spdlog::debug("added focuser esatto focuser at {}",
-                  focuser_ptr->get_serial_device_path());
+      auto focuser_ptr = std::make_shared<esatto_focuser>(
+          "/dev/serial/by-id/"
+          "usb-Silicon_Labs_CP2102N_USB_to_UART_Bridge_Controller_"
+          "b2f14184e185eb11ad7b8b1ab7d59897-if00-port0");
+      alpaca_hub_server::device_map["focuser"].push_back(focuser_ptr);
 
-    if (auto_connect_devices) {
-      spdlog::info("Attempting to autoconnect Focuser at: {}",
-                   focuser_ptr->get_serial_device_path());
       try {
-        focuser_ptr->set_connected(true);
+        focuser_ptr->init_rotator();
       } catch (std::exception &ex) {
-        spdlog::error("Failed to autoconnect device: {}",
-                      focuser_ptr->get_serial_device_path());
+        spdlog::error("Failed to init arco device: {}", ex.what());
       }
-    }
 
-    if (focuser_ptr->arco_present()) {
-      focuser_ptr->init_rotator();
-      auto rotator_ptr = focuser_ptr->rotator();
-      alpaca_hub_server::device_map["rotator"].push_back(rotator_ptr);
+      spdlog::debug("added focuser esatto focuser at {}",
+                    focuser_ptr->get_serial_device_path());
 
       if (auto_connect_devices) {
-        spdlog::info("Attempting to autoconnect attached rotator");
+        spdlog::info("Attempting to autoconnect Focuser at: {}",
+                     focuser_ptr->get_serial_device_path());
         try {
-          rotator_ptr->set_connected(true);
+          focuser_ptr->set_connected(true);
         } catch (std::exception &ex) {
-          spdlog::error("Failed to autoconnect rotator: {}");
+          spdlog::error("Failed to autoconnect device: {}",
+                        focuser_ptr->get_serial_device_path());
+        }
+      }
+
+      if (focuser_ptr->arco_present()) {
+        focuser_ptr->init_rotator();
+        auto rotator_ptr = focuser_ptr->rotator();
+        alpaca_hub_server::device_map["rotator"].push_back(rotator_ptr);
+
+        if (auto_connect_devices) {
+          spdlog::info("Attempting to autoconnect attached rotator");
+          try {
+            rotator_ptr->set_connected(true);
+          } catch (std::exception &ex) {
+            spdlog::error("Failed to autoconnect rotator: {}");
+          }
         }
       }
+
+    } catch(std::exception &ex) {
+      spdlog::error("failed to add esatto: {}", ex.what());
     }
 
-  } catch(std::exception &ex) {
-    spdlog::error("failed to add esatto: {}", ex.what());
-  }
 
+    // for (auto iter : pegasus_alpaca_focuscube3::serial_devices()) {
+    //   auto focuser_ptr = std::make_shared<pegasus_alpaca_focuscube3>();
+    //   focuser_ptr->set_serial_device(iter);
+    //   spdlog::info("Adding Pegasus Focuser at {}", iter);
+    //   alpaca_hub_server::device_map["focuser"].push_back(focuser_ptr);
+
+    //   if (auto_connect_devices) {
+    //     spdlog::info("Attempting to autoconnect: {}", iter);
+    //     try {
+    //       focuser_ptr->set_connected(true);
+    //     } catch (std::exception &ex) {
+    //       spdlog::error("Failed to autoconnect device: {}", iter);
+    //     }
+    //   }
+    // }
+
+    for (auto iter : pegasus_alpaca_ppba::serial_devices()) {
+      auto switch_ptr = std::make_shared<pegasus_alpaca_ppba>();
+      switch_ptr->set_serial_device(iter);
+      spdlog::info("Adding Pegasus Pocket Powerbox Advanced at {}", iter);
+      alpaca_hub_server::device_map["switch"].push_back(switch_ptr);
 
-  // for (auto iter : pegasus_alpaca_focuscube3::serial_devices()) {
-  //   auto focuser_ptr = std::make_shared<pegasus_alpaca_focuscube3>();
-  //   focuser_ptr->set_serial_device(iter);
-  //   spdlog::info("Adding Pegasus Focuser at {}", iter);
-  //   alpaca_hub_server::device_map["focuser"].push_back(focuser_ptr);
-
-  //   if (auto_connect_devices) {
-  //     spdlog::info("Attempting to autoconnect: {}", iter);
-  //     try {
-  //       focuser_ptr->set_connected(true);
-  //     } catch (std::exception &ex) {
-  //       spdlog::error("Failed to autoconnect device: {}", iter);
-  //     }
-  //   }
-  // }
-
-  for (auto iter : pegasus_alpaca_ppba::serial_devices()) {
-    auto switch_ptr = std::make_shared<pegasus_alpaca_ppba>();
-    switch_ptr->set_serial_device(iter);
-    spdlog::info("Adding Pegasus Pocket Powerbox Advanced at {}", iter);
-    alpaca_hub_server::device_map["switch"].push_back(switch_ptr);
-
-    if (auto_connect_devices) {
-      spdlog::info("Attempting to autoconnect: {}", iter);
-      try {
-        switch_ptr->set_connected(true);
-      } catch (std::exception &ex) {
-        spdlog::error("Failed to autoconnect device: {}", iter);
+      if (auto_connect_devices) {
+        spdlog::info("Attempting to autoconnect: {}", iter);
+        try {
+          switch_ptr->set_connected(true);
+        } catch (std::exception &ex) {
+          spdlog::error("Failed to autoconnect device: {}", iter);
+        }
       }
     }
   }
@@ -324,75 +434,82 @@ int main(int argc, char **argv) {
   try {
     using namespace std::chrono;
 
-    spdlog::debug("Initializing QHY SDK");
+    if (!simulate_devices) {
+      spdlog::debug("Initializing QHY SDK");
 
-    // TODO: need to actually check result
-    auto init_result = qhy_alpaca_camera::InitializeQHYSDK();
-    spdlog::debug("  result: {0}", init_result);
-    spdlog::info("Number of QHY cameras connected {0}",
-                 qhy_alpaca_camera::camera_count());
+      // TODO: need to actually check result
+      auto init_result = qhy_alpaca_camera::InitializeQHYSDK();
+      spdlog::debug("  result: {0}", init_result);
+      spdlog::info("Number of QHY cameras connected {0}",
+                   qhy_alpaca_camera::camera_count());
 
-    auto camera_list = qhy_alpaca_camera::get_connected_cameras();
+      auto camera_list = qhy_alpaca_camera::get_connected_cameras();
 
-    spdlog::info("List of QHY Cameras Found: ");
-    for (auto &camera_item : camera_list) {
-      auto cam_ptr = std::make_shared<qhy_alpaca_camera>(camera_item);
-
-      if (gains_value_mode) {
-        spdlog::info("Enabling gain value mode for: {}", camera_item);
-        cam_ptr->enable_gains_value_mode();
-      }
+      spdlog::info("List of QHY Cameras Found: ");
+      for (auto &camera_item : camera_list) {
+        auto cam_ptr = std::make_shared<qhy_alpaca_camera>(camera_item);
 
-      if (offsets_value_mode) {
-        spdlog::info("Enabling offset value mode for: {}", camera_item);
-        cam_ptr->enable_offsets_value_mode();
-      }
+        if (gains_value_mode) {
+          spdlog::info("Enabling gain value mode for: {}", camera_item);
+          cam_ptr->enable_gains_value_mode();
+        }
 
-      alpaca_hub_server::device_map["camera"].push_back(cam_ptr);
-      spdlog::info("  camera: [{0}] added", camera_item);
+        if (offsets_value_mode) {
+          spdlog::info("Enabling offset value mode for: {}", camera_item);
+          cam_ptr->enable_offsets_value_mode();
+        }
 
-      if (auto_connect_devices) {
-        spdlog::info("Attempting to autoconnect: {}", camera_item);
-        try {
-          cam_ptr->set_connected(true);
-        } catch (std::exception &ex) {
-          spdlog::error("Failed to autoconnect device: {}", camera_item);
+        if (huge_page_frame_buffers) {
+          spdlog::info("Enabling huge page frame buffers for: {}", camera_item);
+          cam_ptr->enable_huge_page_frame_buffers();
         }
-      }
 
-      // This is for QHY camera attached filter wheels
-      if (cam_ptr->has_filter_wheel()) {
-        auto fw_ptr = cam_ptr->filter_wheel();
-        spdlog::info("filterwheel added");
-        alpaca_hub_server::device_map["filterwheel"].push_back(fw_ptr);
-        spdlog::debug("attempting to invoke connected...");
-        spdlog::debug(
-            "                     connected:{0}",
-            alpaca_hub_server::device_map["filterwheel"][0]->connected());
+        alpaca_hub_server::device_map["camera"].push_back(cam_ptr);
+        spdlog::info("  camera: [{0}] added", camera_item);
+
         if (auto_connect_devices) {
-          spdlog::info("Attempting to autoconnect attached filterwheel");
+          spdlog::info("Attempting to autoconnect: {}", camera_item);
           try {
-            cam_ptr->filter_wheel()->set_connected(true);
+            cam_ptr->set_connected(true);
           } catch (std::exception &ex) {
-            spdlog::error("Failed to autoconnect attached filterwheel");
+            spdlog::error("Failed to autoconnect device: {}", camera_item);
+          }
+        }
+
+        // This is for QHY camera attached filter wheels
+        if (cam_ptr->has_filter_wheel()) {
+          auto fw_ptr = cam_ptr->filter_wheel();
+          spdlog::info("filterwheel added");
+          alpaca_hub_server::device_map["filterwheel"].push_back(fw_ptr);
+          spdlog::debug("attempting to invoke connected...");
+          spdlog::debug(
+              "                     connected:{0}",
+              alpaca_hub_server::device_map["filterwheel"][0]->connected());
+          if (auto_connect_devices) {
+            spdlog::info("Attempting to autoconnect attached filterwheel");
+            try {
+              cam_ptr->filter_wheel()->set_connected(true);
+            } catch (std::exception &ex) {
+              spdlog::error("Failed to autoconnect attached filterwheel");
+            }
           }
         }
       }
-    }
 
-    // TODO: Add standalone filter wheels here
-    auto filterwheel_list =
-        qhy_alpaca_filterwheel_standalone::get_connected_filterwheels();
-    for (auto &fw_item : filterwheel_list) {
-      auto fw_ptr =
-          std::make_shared<qhy_alpaca_filterwheel_standalone>(fw_item);
-      alpaca_hub_server::device_map["filterwheel"].push_back(fw_ptr);
-      spdlog::info("filterwheel added at {}", fw_item);
-      if (auto_connect_devices) {
-        try {
-          fw_ptr->set_connected(true);
-        } catch (std::exception &ex) {
-          spdlog::warn("Failed to autoconnect QHY filterwheel");
+      // TODO: Add standalone filter wheels here
+      auto filterwheel_list =
+          qhy_alpaca_filterwheel_standalone::get_connected_filterwheels();
+      for (auto &fw_item : filterwheel_list) {
+        auto fw_ptr =
+            std::make_shared<qhy_alpaca_filterwheel_standalone>(fw_item);
+        alpaca_hub_server::device_map["filterwheel"].push_back(fw_ptr);
+        spdlog::info("filterwheel added at {}", fw_item);
+        if (auto_connect_devices) {
+          try {
+            fw_ptr->set_connected(true);
+          } catch (std::exception &ex) {
+            spdlog::warn("Failed to autoconnect QHY filterwheel");
+          }
         }
       }
     }
@@ -444,7 +561,8 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  spdlog::trace("Release QHY SDK: {0}", qhy_alpaca_camera::ReleaseQHYSDK());
+  if (!simulate_devices)
+    spdlog::trace("Release QHY SDK: {0}", qhy_alpaca_camera::ReleaseQHYSDK());
   spdlog::info("AlpacaHub Exiting");
   return 0;
 }
@@ -6,6 +6,8 @@
 #include "restinio/cast_to.hpp"
 #include "restinio/request_handler.hpp"
 #include "restinio/router/express.hpp"
+#include <stdexcept>
+#include <string_view>
 
 // This is one way I can do logs over the web interface...
 // I am thinking about maybe keeping 10mb or so of logs in a fifo type
@@ -18,12 +20,6 @@
 //       // msg.
 //     });
 
-namespace nlohmann {
-void to_json(nlohmann::json &j, const axis_rate &p) {
-  j = nlohmann::json{{"Maximum", p.Max}, {"Minimum", p.Min}};
-};
-} // namespace nlohmann
-
 namespace alpaca_hub_server {
 
 bool _show_client_id_warnings = false;
@@ -65,6 +61,123 @@ template <typename RESP> RESP init_resp_html(RESP resp) {
   return resp;
 }
 
+void append_image_chunk(chunked_response_t &resp, std::string chunk) {
+  resp.append_chunk(std::move(chunk));
+}
+
+void append_image_chunk(user_controlled_response_t &resp, std::string chunk) {
+  resp.append_body(std::move(chunk));
+}
+
+// Writes an image response a chunk at a time and only renders the next
+// chunk once the previous one has gone out on the socket, so memory use
+// stays bounded regardless of how large the frame is
+template <typename RESP, typename WRITER>
+void write_next_image_chunk(std::shared_ptr<RESP> resp,
+                            std::shared_ptr<WRITER> writer) {
+  std::string chunk;
+  if (!writer->next_chunk(chunk)) {
+    resp->done();
+    return;
+  }
+
+  append_image_chunk(*resp, std::move(chunk));
+  if (writer->finished()) {
+    resp->done();
+    return;
+  }
+
+  resp->flush([resp, writer](const asio::error_code &ec) {
+    if (ec) {
+      spdlog::warn("problem writing image chunk: {}", ec.message());
+      return;
+    }
+    write_next_image_chunk(resp, writer);
+  });
+}
+
+// Live frames go out as the parts of a multipart/x-mixed-replace response.
+// Each part is the raw pixels (little endian for 16 bit) with the frame
+// geometry in X- headers.
+constexpr const char *live_stream_boundary = "alpacahub-live-frame";
+
+template <typename RESP> RESP init_resp_live_stream(RESP resp) {
+  resp.append_header("Server", "AlpacaHub /v.0.1");
+  resp.append_header_date_field()
+      .append_header("Content-Type",
+                     fmt::format("multipart/x-mixed-replace; boundary={}",
+                                 live_stream_boundary))
+      .append_header("Cache-Control", "no-cache");
+  return resp;
+}
+
+// One /livestream client. At most one part is being written at a time,
+// frames that arrive meanwhile wait in the subscription's ring or get
+// dropped once it's full, so a slow client never holds up the camera.
+struct live_stream_client_t {
+  std::shared_ptr<chunked_response_t> resp;
+  std::shared_ptr<qhy_alpaca_camera> camera;
+  live_subscription_ptr_t subscription;
+  // Whoever sets this owns resp and the subscription's read side. It stays
+  // set for good once the stream has ended.
+  std::atomic<bool> writing{true};
+  uint64_t sequence = 0;
+};
+
+void end_live_stream(std::shared_ptr<live_stream_client_t> client) {
+  client->camera->unsubscribe_live(client->subscription);
+  // The subscription's notify holds on to the client, this breaks the cycle
+  client->subscription.reset();
+}
+
+// Called on the camera worker when a frame is queued and on an asio thread
+// when the previous part has been written
+void pump_live_stream(std::shared_ptr<live_stream_client_t> client) {
+  while (!client->writing.exchange(true)) {
+    auto &subscription = client->subscription;
+    camera_frame_ptr_t frame;
+    if (subscription->try_pop(frame)) {
+      client->resp->append_chunk(fmt::format(
+          "--{}\r\nContent-Type: application/octet-stream\r\n"
+          "Content-Length: {}\r\nX-Frame-Sequence: {}\r\nX-Width: {}\r\n"
+          "X-Height: {}\r\nX-Bits-Per-Pixel: {}\r\nX-Bin: {}\r\n"
+          "X-Dropped-Frames: {}\r\n\r\n",
+          live_stream_boundary, frame->size_bytes(), client->sequence++,
+          frame->width, frame->height, frame->bytes_per_pixel() * 8,
+          frame->bin_x, subscription->dropped()));
+      // Straight out of the frame buffer, the callback keeps it alive until
+      // the write is done
+      client->resp->append_chunk(
+          restinio::const_buffer(frame->data(), frame->size_bytes()));
+      client->resp->append_chunk(std::string("\r\n"));
+      client->resp->flush([client, frame](const asio::error_code &ec) {
+        if (ec) {
+          spdlog::debug("live stream client went away: {}", ec.message());
+          end_live_stream(client);
+          return;
+        }
+        client->writing = false;
+        pump_live_stream(client);
+      });
+      return;
+    }
+
+    if (subscription->closed()) {
+      client->resp->append_chunk(
+          fmt::format("--{}--\r\n", live_stream_boundary));
+      client->resp->done();
+      end_live_stream(client);
+      return;
+    }
+
+    // A frame queued after try_pop would have found writing set and left it
+    // to us, so look again after letting go
+    client->writing = false;
+    if (subscription->empty() && !subscription->closed())
+      return;
+  }
+}
+
 template <typename T>
 std::basic_string<T> lowercase(const std::basic_string<T> &s) {
   std::basic_string<T> s2 = s;
@@ -288,7 +401,7 @@ api_v1_handler::device_get_handler(const device_request_handle_t &req,
   }
 
   return init_resp(req->create_response())
-      .set_body(nlohmann::json(req->extra_data().response_map).dump())
+      .set_body(req->extra_data().response_map.dump())
       .done();
 };
 
@@ -316,7 +429,7 @@ api_v1_handler::device_put_handler(std::string parameter_key,
           response_map["ErrorMessage"] = fmt::format(
               "Invalid Value for {0} of {1} passed", parameter_key, raw_value);
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
       } catch (std::exception &ex) {
@@ -324,7 +437,7 @@ api_v1_handler::device_put_handler(std::string parameter_key,
         response_map["ErrorMessage"] =
             fmt::format("Problem with parameters: {0}", ex.what());
         return init_resp(req->create_response(restinio::status_bad_request()))
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
 
@@ -364,12 +477,12 @@ api_v1_handler::device_put_handler(std::string parameter_key,
             fmt::format("Invalid Value for {0} passed", parameter_key);
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
 
         // return
         // init_resp(req->create_response(restinio::status_bad_request()))
-        //     .set_body(nlohmann::json(response_map).dump())
+        //     .set_body(response_map.dump())
         //     .done();
       }
     }
@@ -383,21 +496,21 @@ api_v1_handler::device_put_handler(std::string parameter_key,
 
         if (f() == 0) {
           return init_resp(req->create_response())
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         } else {
           response_map["ErrorNumber"] = -1;
           response_map["ErrorMessage"] =
               fmt::format("Failed to set device parameter {0}", parameter_key);
           return init_resp(req->create_response())
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
       } catch (alpaca_exception &ex) {
         response_map["ErrorNumber"] = ex.error_code();
         response_map["ErrorMessage"] = ex.what();
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } else {
@@ -407,21 +520,21 @@ api_v1_handler::device_put_handler(std::string parameter_key,
       try {
         if (f(input_value) == 0) {
           return init_resp(req->create_response())
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         } else {
           response_map["ErrorNumber"] = -1;
           response_map["ErrorMessage"] =
               fmt::format("Failed to set device parameter {0}", parameter_key);
           return init_resp(req->create_response())
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
       } catch (alpaca_exception &ex) {
         response_map["ErrorNumber"] = ex.error_code();
         response_map["ErrorMessage"] = ex.what();
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     }
@@ -430,50 +543,105 @@ api_v1_handler::device_put_handler(std::string parameter_key,
 
 template <typename T, auto F>
 void api_v1_handler::add_route_to_router(
-    const std::shared_ptr<device_router_t> &router,
+    const std::shared_ptr<device_routes_t> &routes,
     const std::string &route_action) {
 
-  std::string device_type_regex;
+  std::string device_type;
 
   // Restrict the paths
   if (std::is_same<T, i_alpaca_camera>::value) {
-    device_type_regex = "camera";
+    device_type = "camera";
   }
 
   if (std::is_same<T, i_alpaca_filterwheel>::value) {
-    device_type_regex = "filterwheel";
+    device_type = "filterwheel";
   }
 
   if (std::is_same<T, i_alpaca_telescope>::value) {
-    device_type_regex = "telescope";
+    device_type = "telescope";
   }
 
   if (std::is_same<T, i_alpaca_focuser>::value) {
-    device_type_regex = "focuser";
+    device_type = "focuser";
   }
 
   if (std::is_same<T, i_alpaca_switch>::value) {
-    device_type_regex = "switch";
+    device_type = "switch";
   }
 
   if (std::is_same<T, i_alpaca_rotator>::value) {
-    device_type_regex = "rotator";
+    device_type = "rotator";
   }
 
-  // I think this is a bug...when I do the format, I don't believe it correctly
-  // generates a valid regex.
+  // Common to all devices
   if (std::is_same<T, i_alpaca_device>::value) {
-    device_type_regex = "telescope|camera|focuser|filterwheel|switch|rotator";
+    device_type = ":device_type";
   }
 
-  std::string base_route_path = fmt::format(
-      "/api/v1/:device_type({0})/:device_number/", device_type_regex);
-  std::string route_path = base_route_path;
-  route_path.append(route_action);
+  std::string route_path = fmt::format("/api/v1/{0}/:device_number/{1}",
+                                       device_type, route_action);
 
-  router->http_get(route_path, this->create_handler<T, F>(route_action));
+  routes->http_get(route_path, this->create_handler<T, F>(route_action));
 };
 
+static constexpr std::string_view alpaca_device_types[] = {
+    "camera", "filterwheel", "focuser", "rotator", "switch", "telescope"};
+
+void device_routes_t::http_get(std::string_view path,
+                               device_request_handler_t handler) {
+  add(route_method_enum::get, path, std::move(handler));
+}
+
+void device_routes_t::http_put(std::string_view path,
+                               device_request_handler_t handler) {
+  add(route_method_enum::put, path, std::move(handler));
+}
+
+void device_routes_t::add(route_method_enum method, std::string_view path,
+                          device_request_handler_t handler) {
+  constexpr std::string_view prefix = "/api/v1/";
+  constexpr std::string_view device_number = "/:device_number/";
+
+  auto type_end = path.find(device_number);
+  if (path.substr(0, prefix.size()) != prefix ||
+      type_end == std::string_view::npos || type_end <= prefix.size())
+    throw std::logic_error(
+        fmt::format("{} isn't a device route, expected "
+                    "/api/v1/<device_type>/:device_number/<action>",
+                    path));
+
+  auto device_type = path.substr(prefix.size(), type_end - prefix.size());
+  auto action = path.substr(type_end + device_number.size());
+
+  auto add_one = [&](std::string_view type) {
+    if (!_table.add(method, type, action, handler))
+      spdlog::warn("{} {}/{} was added twice, keeping the first one",
+                   method == route_method_enum::get ? "GET" : "PUT", type,
+                   action);
+  };
+
+  if (device_type == ":device_type") {
+    for (auto type : alpaca_device_types)
+      add_one(type);
+  } else {
+    add_one(device_type);
+  }
+}
+
+restinio::request_handling_status_t
+device_routes_t::dispatch(route_method_enum method,
+                          const device_request_handle_t &req,
+                          std::string_view device_type,
+                          std::string_view action) const {
+  auto handler = _table.find(method, device_type, action);
+  if (!handler)
+    return restinio::request_not_handled();
+
+  // None of the device handlers look at the route params, everything they
+  // need is in extra_data() already
+  return (*handler)(req, restinio::router::route_params_t{});
+}
+
 // Handler for all GETs that require a switch ID
 template <auto F> device_request_handler_t switch_by_id_get_handler() {
   return [=](auto req, auto) {
@@ -507,7 +675,7 @@ template <auto F> device_request_handler_t switch_by_id_get_handler() {
     }
 
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   };
 }
@@ -528,18 +696,32 @@ create_device_api_handler() {
       epr::path_to_params("/api/v1/", device_type_p, "/", device_num_p, "/",
                           epr::path_fragment_p());
 
-  router->http_get(base_path, [handler](const device_request_handle_t &req,
-                                        auto device_num, auto device_type,
-                                        auto rest_of_path) {
-    return handler->on_get_device_common(req, device_num, device_type,
-                                         rest_of_path);
+  // Built once here, the handlers below only ever read it
+  std::shared_ptr<const device_routes_t> routes = create_device_routes();
+  spdlog::debug("{} device routes in the dispatch table", routes->size());
+
+  router->http_get(base_path, [handler, routes](
+                                  const device_request_handle_t &req,
+                                  auto device_type, auto device_num,
+                                  auto rest_of_path) {
+    auto status = handler->on_get_device_common(req, device_type, device_num,
+                                                rest_of_path);
+    if (status != restinio::request_not_handled())
+      return status;
+    return routes->dispatch(route_method_enum::get, req, device_type,
+                            rest_of_path);
   });
 
-  router->http_put(base_path, [handler](const device_request_handle_t &req,
-                                        auto device_num, auto device_type,
-                                        auto rest_of_path) {
-    return handler->on_put_device_common(req, device_num, device_type,
-                                         rest_of_path);
+  router->http_put(base_path, [handler, routes](
+                                  const device_request_handle_t &req,
+                                  auto device_type, auto device_num,
+                                  auto rest_of_path) {
+    auto status = handler->on_put_device_common(req, device_type, device_num,
+                                                rest_of_path);
+    if (status != restinio::request_not_handled())
+      return status;
+    return routes->dispatch(route_method_enum::put, req, device_type,
+                            rest_of_path);
   });
 
   return [_handler = std::move(router)](const device_request_handle_t &req) {
@@ -549,8 +731,6 @@ create_device_api_handler() {
 
 std::function<restinio::request_handling_status_t(device_request_handle_t)>
 server_handler() {
-  auto api_handler = std::make_shared<api_v1_handler>();
-
   auto router = std::make_shared<device_router_t>();
 
   // GET request to homepage.
@@ -702,7 +882,7 @@ server_handler() {
     }
 
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
@@ -735,7 +915,7 @@ server_handler() {
     }
 
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
@@ -783,35 +963,12 @@ server_handler() {
 
     return init_resp(req->create_response())
 
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
-  // Begin unsupported endpoints
-  //
-  // PUT method for device action, commandbool and commandblind
-  // We aren't supporting these custom things at this time
-  auto unsupported_response = [](auto req, auto params) {
-    std::string err_msg = "Not supported at this time";
-    auto &response_map = req->extra_data().response_map;
-    response_map["ErrorNumber"] = alpaca_exception::NOT_IMPLEMENTED;
-    response_map["ErrorMessage"] = err_msg;
-    return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
-        .done();
-  };
-
-  router->http_put("/api/v1/:device_type/:device_number/action",
-                   unsupported_response);
-  router->http_put("/api/v1/:device_type/:device_number/commandblind",
-                   unsupported_response);
-  router->http_put("/api/v1/:device_type/:device_number/commandbool",
-                   unsupported_response);
-  router->http_put("/api/v1/:device_type/:device_number/commandstring",
-                   unsupported_response);
-  // End unsupported endpoints
-
-  // TODO: I need to see if I can just get rid of this by restricting the good
-  // routes with a regex
+  // Anything with a real device number has been dealt with by
+  // create_device_api_handler by now, this catches the numbers its parser
+  // turned away
   std::string bad_device_num_path =
       R"(/api/v1/:device_type/:device_number(-\d+|[a-zA-Z][:alpha:]*)/:anything)";
   router->http_get(bad_device_num_path, [](auto req, auto params) {
@@ -848,7 +1005,7 @@ server_handler() {
     response_map["ErrorMessage"] =
         fmt::format("Invalid device number: {0}", params["device_number"]);
     return init_resp(req->create_response(restinio::status_bad_request()))
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
@@ -885,10 +1042,82 @@ server_handler() {
     response_map["ErrorMessage"] =
         fmt::format("Invalid device number: {0}", params["device_number"]);
     return init_resp(req->create_response(restinio::status_bad_request()))
-        .set_body(nlohmann::json(req->extra_data().response_map).dump())
+        .set_body(req->extra_data().response_map.dump())
         .done();
   });
 
+  router->non_matched_request_handler([](auto req) {
+    return req->create_response(restinio::status_not_found())
+        .append_header_date_field()
+        .connection_close()
+        .done();
+  });
+
+  // return router;
+  return
+      [_handler = std::move(router)](
+          const restinio::generic_request_handle_t<device_data_factory::data_t>
+              &req) { return (*_handler)(req); };
+}
+
+std::shared_ptr<device_routes_t> create_device_routes() {
+  auto api_handler = std::make_shared<api_v1_handler>();
+  auto routes = std::make_shared<device_routes_t>();
+
+  // Begin unsupported endpoints
+  //
+  // PUT method for device action (except cameras), commandbool and
+  // commandblind
+  // We aren't supporting these custom things at this time
+  auto unsupported_response = [](auto req, auto params) {
+    std::string err_msg = "Not supported at this time";
+    auto &response_map = req->extra_data().response_map;
+    response_map["ErrorNumber"] = alpaca_exception::NOT_IMPLEMENTED;
+    response_map["ErrorMessage"] = err_msg;
+    return init_resp(req->create_response())
+        .set_body(response_map.dump())
+        .done();
+  };
+
+  // Cameras get their custom actions (e.g. FrameStats) passed through to
+  // invoke_action, everything else is still unsupported
+  routes->http_put(
+      "/api/v1/:device_type/:device_number/action",
+      [unsupported_response](auto req, auto params) {
+        std::shared_ptr<i_alpaca_camera> the_camera =
+            std::dynamic_pointer_cast<i_alpaca_camera>(
+                req->extra_data().device);
+        if (!the_camera)
+          return unsupported_response(req, std::move(params));
+
+        const auto parsed_qp = restinio::parse_query(req->body());
+        std::map<std::string, std::string> qp;
+        for (auto &query_param : parsed_qp)
+          qp[std::string(query_param.first)] = query_param.second;
+
+        auto &response_map = req->extra_data().response_map;
+        try {
+          if (!qp.count("Action"))
+            throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                                   "Action parameter is required");
+          response_map["Value"] = the_camera->invoke_action(qp["Action"], qp);
+        } catch (alpaca_exception &ex) {
+          response_map["ErrorNumber"] = ex.error_code();
+          response_map["ErrorMessage"] = ex.what();
+        }
+
+        return init_resp(req->create_response())
+            .set_body(response_map.dump())
+            .done();
+      });
+  routes->http_put("/api/v1/:device_type/:device_number/commandblind",
+                   unsupported_response);
+  routes->http_put("/api/v1/:device_type/:device_number/commandbool",
+                   unsupported_response);
+  routes->http_put("/api/v1/:device_type/:device_number/commandstring",
+                   unsupported_response);
+  // End unsupported endpoints
+
   // GET details
   // This isn't an official alpaca api, but I wanted a streamlined call
   // so that my web editor can avoid making a dozen calls every time
@@ -896,9 +1125,9 @@ server_handler() {
 
   // api_handler->add_route_to_router<i_alpaca_device,
   // &i_alpaca_device::details>(
-  //     router, "details");
+  //     routes, "details");
 
-  router->http_get(
+  routes->http_get(
       "/api/v1/:device_type/:device_number/details", [](auto req, auto params) {
         std::shared_ptr<i_alpaca_device> the_device = req->extra_data().device;
 
@@ -944,12 +1173,12 @@ server_handler() {
         }
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // GET devicestate (TODO: need to look up official implementation standard on this one)
-  router->http_get(
+  routes->http_get(
       "/api/v1/:device_type/:device_number/devicestate", [](auto req, auto params) {
         std::shared_ptr<i_alpaca_device> the_device = req->extra_data().device;
 
@@ -995,43 +1224,43 @@ server_handler() {
         }
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // GET connected
   api_handler
       ->add_route_to_router<i_alpaca_device, &i_alpaca_device::connected>(
-          router, "connected");
+          routes, "connected");
 
   // GET description
   api_handler
       ->add_route_to_router<i_alpaca_device, &i_alpaca_device::description>(
-          router, "description");
+          routes, "description");
 
   // GET driverinfo
   api_handler
       ->add_route_to_router<i_alpaca_device, &i_alpaca_device::driverinfo>(
-          router, "driverinfo");
+          routes, "driverinfo");
 
   // GET driverversion
   api_handler
       ->add_route_to_router<i_alpaca_device, &i_alpaca_device::driver_version>(
-          router, "driverversion");
+          routes, "driverversion");
 
   // GET interfaceversion
   api_handler->add_route_to_router<i_alpaca_device,
                                    &i_alpaca_device::interface_version>(
-      router, "interfaceversion");
+      routes, "interfaceversion");
 
   // GET name
   api_handler->add_route_to_router<i_alpaca_device, &i_alpaca_device::name>(
-      router, "name");
+      routes, "name");
 
   // GET supportedactions
   api_handler->add_route_to_router<i_alpaca_device,
                                    &i_alpaca_device::supported_actions>(
-      router, "supportedactions");
+      routes, "supportedactions");
 
   //
   // Camera specific routes:
@@ -1040,141 +1269,141 @@ server_handler() {
   // GET bayeroffsetx
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::bayer_offset_x>(
-          router, "bayeroffsetx");
+          routes, "bayeroffsetx");
 
   // GET bayeroffsety
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::bayer_offset_y>(
-          router, "bayeroffsety");
+          routes, "bayeroffsety");
 
   // GET binx
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::bin_x>(
-      router, "binx");
+      routes, "binx");
 
   // GET biny
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::bin_y>(
-      router, "biny");
+      routes, "biny");
 
   // GET camerastate
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::camera_state>(
-          router, "camerastate");
+          routes, "camerastate");
 
   // GET cameraxsize
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::camera_x_size>(
-          router, "cameraxsize");
+          routes, "cameraxsize");
 
   // GET cameraysize
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::camera_y_size>(
-          router, "cameraysize");
+          routes, "cameraysize");
 
   // GET canabortexposure
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_abort_exposure>(
-      router, "canabortexposure");
+      routes, "canabortexposure");
 
   // GET canasymmetricbin
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_asymmetric_bin>(
-      router, "canasymmetricbin");
+      routes, "canasymmetricbin");
 
   // GET canfastreadout
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_fast_readout>(
-      router, "canfastreadout");
+      routes, "canfastreadout");
 
   // GET cangetcoolerpower
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_get_cooler_power>(
-      router, "cangetcoolerpower");
+      routes, "cangetcoolerpower");
 
   // GET canpulseguide
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::can_pulse_guide>(
-          router, "canpulseguide");
+          routes, "canpulseguide");
 
   // GET cansetccdtemperature
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_set_ccd_temperature>(
-      router, "cansetccdtemperature");
+      routes, "cansetccdtemperature");
 
   // GET canstopexposure
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::can_stop_exposure>(
-      router, "canstopexposure");
+      routes, "canstopexposure");
 
   // GET ccdtemperature
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::ccd_temperature>(
-          router, "ccdtemperature");
+          routes, "ccdtemperature");
 
   // GET cooleron
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::cooler_on>(
-          router, "cooleron");
+          routes, "cooleron");
 
   // GET coolerpower
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::cooler_power>(
-          router, "coolerpower");
+          routes, "coolerpower");
 
   // GET electronsperadu
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::electrons_per_adu>(
-      router, "electronsperadu");
+      routes, "electronsperadu");
 
   // GET exposuremax
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::exposure_max>(
-          router, "exposuremax");
+          routes, "exposuremax");
 
   // GET exposuremin
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::exposure_min>(
-          router, "exposuremin");
+          routes, "exposuremin");
 
   // GET exposureresolution
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::exposure_resolution>(
-      router, "exposureresolution");
+      routes, "exposureresolution");
 
   // GET fastreadout
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::fast_readout>(
-          router, "fastreadout");
+          routes, "fastreadout");
 
   // GET fullwellcapacity
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::full_well_capacity>(
-      router, "fullwellcapacity");
+      routes, "fullwellcapacity");
 
   // GET gain
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::gain>(
-      router, "gain");
+      routes, "gain");
 
   // GET gainmax
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::gain_max>(
-      router, "gainmax");
+      routes, "gainmax");
 
   // GET gainmin
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::gain_min>(
-      router, "gainmin");
+      routes, "gainmin");
 
   // GET gains
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::gains>(
-      router, "gains");
+      routes, "gains");
 
   // GET hasshutter
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::has_shutter>(
-          router, "hasshutter");
+          routes, "hasshutter");
 
   // GET heatsinktemperature
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::heat_sink_temperature>(
-      router, "heatsinktemperature");
+      routes, "heatsinktemperature");
 
   // Handler for imagearray and imagearrayvariant
   auto image_array_handler = [](auto req, auto) {
@@ -1197,158 +1426,172 @@ server_handler() {
       response_map["ErrorNumber"] = alpaca_exception::INVALID_OPERATION;
       response_map["ErrorMessage"] = "Image is not ready";
       return init_resp(req->create_response())
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
-    auto i2d = the_cam->image_2d();
+    auto frame = the_cam->last_frame();
+    if (!frame) {
+      spdlog::error("image_ready is true but the camera has no frame");
+      response_map["ErrorNumber"] = alpaca_exception::INVALID_OPERATION;
+      response_map["ErrorMessage"] = "No image data available";
+      return init_resp(req->create_response())
+          .set_body(response_map.dump())
+          .done();
+    }
 
     if (cmp_res > -1) {
       spdlog::debug("Client requested imagebytes");
-      std::stringstream stream;
-
-      if (the_cam->bpp() == 8) {
-        spdlog::debug("8bpp for imagebytes");
-        // Different
-        image_bytes_t<uint8_t> image_bytes;
-        try {
-          image_bytes.client_transaction_number =
-              std::get<uint32_t>(response_map["ClientTransactionID"]);
-        } catch (std::exception &ex) {
-          if (_show_client_id_warnings)
-            spdlog::warn("problem getting ClientTransactionID");
-          image_bytes.client_transaction_number = 99999;
-        }
-
-        image_bytes.server_transaction_number =
-            std::get<uint32_t>(response_map["ServerTransactionID"]);
-
-        image_bytes.image_element_type = 2;
-        // Different
-        image_bytes.transmission_element_type = 6;
-
-        image_bytes.dimension1 = i2d.size();
-        image_bytes.dimension2 = i2d[0].size();
-
-        size_t size_1d = i2d.size() * i2d[0].size();
-        // Different
-
-        std::vector<uint8_t> img_1d(size_1d);
-
-        // Different
-        uint8_t *p = &img_1d[0];
-
-        for (const auto &row : i2d) {
-          for (auto x : row)
-            *p++ = x;
-        }
-
-        image_bytes.image_data_1d = img_1d;
-        image_bytes.serialize(stream);
-
-      } else {
-        spdlog::debug("16bpp for imagebytes");
-        image_bytes_t<int16_t> image_bytes;
-        try {
-          image_bytes.client_transaction_number =
-              std::get<uint32_t>(response_map["ClientTransactionID"]);
-        } catch (std::exception &ex) {
-          if (_show_client_id_warnings)
-            spdlog::warn("problem getting ClientTransactionID");
-          image_bytes.client_transaction_number = 99999;
-        }
-        image_bytes.server_transaction_number =
-            std::get<uint32_t>(response_map["ServerTransactionID"]);
-        image_bytes.image_element_type = 1;
-        image_bytes.transmission_element_type = 1;
 
-        image_bytes.dimension1 = i2d.size();
-        image_bytes.dimension2 = i2d[0].size();
-
-        size_t size_1d = i2d.size() * i2d[0].size();
-
-        std::vector<int16_t> img_1d(size_1d);
-
-        int16_t *p = &img_1d[0];
-
-        for (const auto &row : i2d) {
-          for (auto x : row)
-            *p++ = x;
-        }
-
-        image_bytes.image_data_1d = img_1d;
-        image_bytes.serialize(stream);
+      image_bytes_header_t header;
+      try {
+        header.client_transaction_number =
+            std::get<uint32_t>(response_map["ClientTransactionID"]);
+      } catch (std::exception &ex) {
+        if (_show_client_id_warnings)
+          spdlog::warn("problem getting ClientTransactionID");
+        header.client_transaction_number = 99999;
       }
-
-      spdlog::debug("Image bytes size: {0}", stream.str().size());
-      return init_resp_imagebytes(req->create_response())
-          .set_body(stream.str())
-          .done();
+      header.server_transaction_number =
+          std::get<uint32_t>(response_map["ServerTransactionID"]);
+
+      // Clients are expected to hand back Int32 arrays, the transmission type
+      // is whatever the frame natively holds (Byte or UInt16)
+      header.image_element_type = image_array_element_types::INT32;
+
+      auto writer = std::make_shared<image_bytes_writer_t>(header, frame);
+      spdlog::debug("Image bytes size: {0}", writer->content_length());
+
+      // We know the exact size up front so there is no need for chunked
+      // encoding here, we just write the body out a band at a time
+      auto resp = std::make_shared<user_controlled_response_t>(
+          init_resp_imagebytes(
+              req->create_response<restinio::user_controlled_output_t>()));
+      resp->set_content_length(writer->content_length());
+      write_next_image_chunk(resp, writer);
     } else {
-      response_map["Value"] = i2d;
-      response_map["Type"] = 1;
+      spdlog::debug("Client requested JSON image array");
+      // The values are unsigned 16 bit at most so they need Int32 (2)
+      response_map["Type"] = 2;
       response_map["Rank"] = 2;
+
+      auto writer = std::make_shared<image_array_json_writer_t>(
+          response_map.dump(), frame);
+      auto resp = std::make_shared<chunked_response_t>(
+          init_resp(req->create_response<restinio::chunked_output_t>()));
+      write_next_image_chunk(resp, writer);
     }
 
     spdlog::debug("Image Array Handler ended");
-    return init_resp(req->create_response())
-        .set_body(nlohmann::json(req->extra_data().response_map).dump())
-        .done();
+    return restinio::request_accepted();
   };
 
   // GET imagearray
-  router->http_get("/api/v1/camera/:device_number/imagearray",
+  routes->http_get("/api/v1/camera/:device_number/imagearray",
                    image_array_handler);
 
   // GET imagearrayvariant
   // not sure if I'm gonna have to implement this or not
-  router->http_get("/api/v1/camera/:device_number/imagearrayvariant",
+  routes->http_get("/api/v1/camera/:device_number/imagearrayvariant",
                    image_array_handler);
 
+  // GET livestream
+  // Not part of Alpaca. Streams frames while the camera is in live mode
+  // (Action=StartLive), optional depth query param is how many frames may
+  // queue up for this client before they're dropped. The camera may give it
+  // fewer if other clients already have most of its live buffers.
+  routes->http_get(
+      "/api/v1/camera/:device_number/livestream", [](auto req, auto) {
+        auto &response_map = req->extra_data().response_map;
+        auto camera = std::dynamic_pointer_cast<qhy_alpaca_camera>(
+            req->extra_data().device);
+        if (!camera) {
+          response_map["ErrorNumber"] = alpaca_exception::NOT_IMPLEMENTED;
+          response_map["ErrorMessage"] =
+              "This camera doesn't support live mode";
+          return init_resp(req->create_response())
+              .set_body(response_map.dump())
+              .done();
+        }
+
+        size_t depth = 2;
+        const auto qp = restinio::parse_query(req->header().query());
+        if (qp.has("depth")) {
+          try {
+            depth = std::clamp<size_t>(restinio::cast_to<size_t>(qp["depth"]),
+                                       1, camera->live_max_queued());
+          } catch (std::exception &ex) {
+            spdlog::warn("ignoring bad livestream depth: {}", ex.what());
+          }
+        }
+
+        auto client = std::make_shared<live_stream_client_t>();
+        client->camera = camera;
+        try {
+          client->subscription = camera->subscribe_live(
+              depth, [client]() { pump_live_stream(client); });
+        } catch (alpaca_exception &ex) {
+          response_map["ErrorNumber"] = ex.error_code();
+          response_map["ErrorMessage"] = ex.what();
+          return init_resp(req->create_response())
+              .set_body(response_map.dump())
+              .done();
+        }
+
+        spdlog::debug("live stream client subscribed with depth {}",
+                      client->subscription->depth());
+        client->resp = std::make_shared<chunked_response_t>(
+            init_resp_live_stream(
+                req->create_response<restinio::chunked_output_t>()));
+        client->writing = false;
+        pump_live_stream(client);
+        return restinio::request_accepted();
+      });
+
   // GET imageready
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::image_ready>(
-          router, "imageready");
+          routes, "imageready");
 
   // GET ispulseguiding
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::is_pulse_guiding>(
-      router, "ispulseguiding");
+      routes, "ispulseguiding");
 
   // GET lastexposureduration
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::last_exposure_duration>(
-      router, "lastexposureduration");
+      routes, "lastexposureduration");
 
   // GET lastexposurestarttime
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::last_exposure_start_time>(
-      router, "lastexposurestarttime");
+      routes, "lastexposurestarttime");
 
   // GET maxadu
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::max_adu>(
-      router, "maxadu");
+      routes, "maxadu");
 
   // GET maxbinx
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::max_bin_x>(
-          router, "maxbinx");
+          routes, "maxbinx");
 
   // GET maxbiny
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::max_bin_y>(
-          router, "maxbiny");
+          routes, "maxbiny");
 
   // GET numx
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::num_x>(
-      router, "numx");
+      routes, "numx");
 
   // GET numy
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::num_y>(
-      router, "numy");
+      routes, "numy");
 
   // GET offset
-  router->http_get(
+  routes->http_get(
       "/api/v1/camera/:device_number/offset",
       api_handler->create_handler<i_alpaca_camera, &i_alpaca_camera::offset>(
           "offset"));
@@ -1356,173 +1599,173 @@ server_handler() {
   // GET offsetmax
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::offset_max>(
-          router, "offsetmax");
+          routes, "offsetmax");
 
   // GET offsetmin
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::offset_min>(
-          router, "offsetmin");
+          routes, "offsetmin");
 
   // GET offsets
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::offsets>(
-      router, "offsets");
+      routes, "offsets");
 
   // GET percentcompleted
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::percent_complete>(
-      router, "percentcompleted");
+      routes, "percentcompleted");
 
   // GET pixelsizex
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::pixel_size_x>(
-          router, "pixelsizex");
+          routes, "pixelsizex");
 
   // GET pixelsizey
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::pixel_size_y>(
-          router, "pixelsizey");
+          routes, "pixelsizey");
 
   // GET readoutmode
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::readout_mode>(
-          router, "readoutmode");
+          routes, "readoutmode");
 
   // GET readoutmodes
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::readout_modes>(
-          router, "readoutmodes");
+          routes, "readoutmodes");
 
   // GET sensorname
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::sensor_name>(
-          router, "sensorname");
+          routes, "sensorname");
 
   // GET sensortype
   api_handler
       ->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::sensor_type>(
-          router, "sensortype");
+          routes, "sensortype");
 
   // GET setccdtemperature
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::get_set_ccd_temperature>(
-      router, "setccdtemperature");
+      routes, "setccdtemperature");
 
   // GET startx
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::start_x>(
-      router, "startx");
+      routes, "startx");
 
   // GET starty
   api_handler->add_route_to_router<i_alpaca_camera, &i_alpaca_camera::start_y>(
-      router, "starty");
+      routes, "starty");
 
   // GET subexposureduration
   api_handler->add_route_to_router<i_alpaca_camera,
                                    &i_alpaca_camera::subexposure_duration>(
-      router, "subexposureduration");
+      routes, "subexposureduration");
 
   // PUT abortexposure
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/abortexposure",
       api_handler->device_put_handler<void, i_alpaca_camera,
                                       &i_alpaca_camera::abort_exposure>());
 
   // PUT binx
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/binx",
       api_handler->device_put_handler<int, i_alpaca_camera,
                                       &i_alpaca_camera::set_bin_x>("BinX"));
 
   // PUT biny
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/biny",
       api_handler->device_put_handler<int, i_alpaca_camera,
                                       &i_alpaca_camera::set_bin_y>("BinY"));
 
   // PUT connected
-  router->http_put(
+  routes->http_put(
       "/api/v1/:device_type/:device_number/connected",
       api_handler->device_put_handler<bool, i_alpaca_device,
                                       &i_alpaca_device::set_connected>(
           "Connected", true));
 
   // PUT cooleron
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/cooleron",
       api_handler->device_put_handler<bool, i_alpaca_camera,
                                       &i_alpaca_camera::set_cooler_on>(
           "CoolerOn", true));
 
   // PUT fastreadout
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/fastreadout",
       api_handler->device_put_handler<bool, i_alpaca_camera,
                                       &i_alpaca_camera::set_fast_readout>(
           "FastReadout", true));
 
   // PUT gain
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/gain",
       api_handler->device_put_handler<int, i_alpaca_camera,
                                       &i_alpaca_camera::set_gain>("Gain"));
   // PUT numx
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/numx",
       api_handler->device_put_handler<uint32_t, i_alpaca_camera,
                                       &i_alpaca_camera::set_num_x>("NumX"));
 
   // PUT numy
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/numy",
       api_handler->device_put_handler<uint32_t, i_alpaca_camera,
                                       &i_alpaca_camera::set_num_y>("NumY"));
 
   // PUT offset
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/offset",
       api_handler->device_put_handler<uint32_t, i_alpaca_camera,
                                       &i_alpaca_camera::set_offset>("Offset"));
 
   // PUT pulseguide
   // Unsupported at this time
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/pulseguide", [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
 
         response_map["ErrorNumber"] = alpaca_exception::NOT_IMPLEMENTED;
         response_map["ErrorMessage"] = "Pulse guiding not implemented";
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT readoutmode
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/readoutmode",
       api_handler->device_put_handler<int, i_alpaca_camera,
                                       &i_alpaca_camera::set_readout_mode>(
           "ReadoutMode"));
 
   // PUT setccdtemperature
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/setccdtemperature",
       api_handler->device_put_handler<double, i_alpaca_camera,
                                       &i_alpaca_camera::set_ccd_temperature>(
           "SetCCDTemperature"));
 
   // PUT startx
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/startx",
       api_handler->device_put_handler<uint32_t, i_alpaca_camera,
                                       &i_alpaca_camera::set_start_x>("StartX"));
 
   // PUT starty
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/starty",
       api_handler->device_put_handler<uint32_t, i_alpaca_camera,
                                       &i_alpaca_camera::set_start_y>("StartY"));
 
   // PUT subexposureduration
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/subexposureduration",
       api_handler->device_put_handler<
           double, i_alpaca_camera, &i_alpaca_camera::set_subexposure_duration>(
@@ -1531,7 +1774,7 @@ server_handler() {
   // TODO - figure out how to have this use the common handler creation
   // so that it handles the multiple values
   // PUT startexposure
-  router->http_put("/api/v1/camera/:device_number/startexposure", [](auto req,
+  routes->http_put("/api/v1/camera/:device_number/startexposure", [](auto req,
                                                                      auto) {
     auto &response_map = req->extra_data().response_map;
     const auto qp = restinio::parse_query(req->body());
@@ -1545,7 +1788,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for duration");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -1559,7 +1802,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Value of Light is invalid: {0}", ex.what());
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -1572,7 +1815,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Value of {0} is invalid", is_light_value);
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -1582,26 +1825,26 @@ server_handler() {
     try {
       if (the_cam->start_exposure(duration_value, conv_is_light_value) == 0) {
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       } else {
         response_map["ErrorNumber"] = -1;
         response_map["ErrorMessage"] = fmt::format("Failed to start exposure");
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } catch (alpaca_exception &ex) {
       response_map["ErrorNumber"] = ex.error_code();
       response_map["ErrorMessage"] = ex.what();
       return init_resp(req->create_response())
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
   });
 
   // PUT stopexposure
-  router->http_put(
+  routes->http_put(
       "/api/v1/camera/:device_number/stopexposure",
       api_handler->device_put_handler<void, i_alpaca_camera,
                                       &i_alpaca_camera::stop_exposure>());
@@ -1632,18 +1875,18 @@ server_handler() {
     }
 
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   };
 
   // PUT setusbtraffic
-  router->http_put("/api/v1/camera/:device_number/setusbtraffic",
+  routes->http_put("/api/v1/camera/:device_number/setusbtraffic",
                    [&](auto req, auto params) {
                      return camera_action_handler("setusbtraffic", req);
                    });
 
   // PUT getusbtraffic
-  router->http_put("/api/v1/camera/:device_number/getusbtraffic",
+  routes->http_put("/api/v1/camera/:device_number/getusbtraffic",
                    [&](auto req, auto params) {
                      return camera_action_handler("getusbtraffic", req);
                    });
@@ -1654,21 +1897,21 @@ server_handler() {
 
   // GET position
   api_handler->add_route_to_router<i_alpaca_filterwheel,
-                                   &i_alpaca_filterwheel::position>(router,
+                                   &i_alpaca_filterwheel::position>(routes,
                                                                     "position");
 
   // GET names
   api_handler
       ->add_route_to_router<i_alpaca_filterwheel, &i_alpaca_filterwheel::names>(
-          router, "names");
+          routes, "names");
 
   // GET offsets
   api_handler->add_route_to_router<i_alpaca_filterwheel,
                                    &i_alpaca_filterwheel::focus_offsets>(
-      router, "focusoffsets");
+      routes, "focusoffsets");
 
   // PUT position
-  router->http_put(
+  routes->http_put(
       "/api/v1/filterwheel/:device_number/position",
       api_handler->device_put_handler<uint32_t, i_alpaca_filterwheel,
                                       &i_alpaca_filterwheel::set_position>(
@@ -1681,238 +1924,238 @@ server_handler() {
   // GET alignmentmode
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::alignment_mode>(
-      router, "alignmentmode");
+      routes, "alignmentmode");
 
   // GET altitude
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::altitude>(
-          router, "altitude");
+          routes, "altitude");
 
   // GET aperturearea
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::aperture_area>(
-      router, "aperturearea");
+      routes, "aperturearea");
 
   // GET aperturediameter
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::aperture_diameter>(
-      router, "aperturediameter");
+      routes, "aperturediameter");
 
   // GET athome
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::at_home>(
-          router, "athome");
+          routes, "athome");
 
   // GET atpark
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::at_park>(
-          router, "atpark");
+          routes, "atpark");
 
   // GET azimuth
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::azimuth>(
-          router, "azimuth");
+          routes, "azimuth");
 
   // GET canfindhome
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_find_home>(
-      router, "canfindhome");
+      routes, "canfindhome");
 
   // GET canpark
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::can_park>(
-          router, "canpark");
+          routes, "canpark");
 
   // GET canpulseguide
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_pulse_guide>(
-      router, "canpulseguide");
+      routes, "canpulseguide");
 
   // GET cansetdeclinationrate
   api_handler->add_route_to_router<
       i_alpaca_telescope, &i_alpaca_telescope::can_set_declination_rate>(
-      router, "cansetdeclinationrate");
+      routes, "cansetdeclinationrate");
 
   // GET cansetguiderates
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_set_guide_rates>(
-      router, "cansetguiderates");
+      routes, "cansetguiderates");
 
   // GET cansetpark
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_set_park>(
-      router, "cansetpark");
+      routes, "cansetpark");
 
   // GET cansetpierside
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_set_pier_side>(
-      router, "cansetpierside");
+      routes, "cansetpierside");
 
   // GET cansetrightascensionrate
   api_handler->add_route_to_router<
       i_alpaca_telescope, &i_alpaca_telescope::can_set_right_ascension_rate>(
-      router, "cansetrightascensionrate");
+      routes, "cansetrightascensionrate");
 
   // GET cansettracking
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_set_tracking>(
-      router, "cansettracking");
+      routes, "cansettracking");
 
   // GET canslew
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::can_slew>(
-          router, "canslew");
+          routes, "canslew");
 
   // GET canslewasync
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_slew_async>(
-      router, "canslewasync");
+      routes, "canslewasync");
 
   // GET canslewaltaz
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_slew_alt_az>(
-      router, "canslewaltaz");
+      routes, "canslewaltaz");
 
   // GET canslewaltazasync
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_slew_alt_az_async>(
-      router, "canslewaltazasync");
+      routes, "canslewaltazasync");
 
   // GET cansync
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::can_sync>(
-          router, "cansync");
+          routes, "cansync");
 
   // GET cansyncaltaz
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_sync_alt_az>(
-      router, "cansyncaltaz");
+      routes, "cansyncaltaz");
 
   // GET canunpark
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::can_unpark>(
-      router, "canunpark");
+      routes, "canunpark");
 
   // GET declination
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::declination>(
-      router, "declination");
+      routes, "declination");
 
   // GET declinationrate
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::declination_rate>(
-      router, "declinationrate");
+      routes, "declinationrate");
 
   // GET doesrefraction
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::does_refraction>(
-      router, "doesrefraction");
+      routes, "doesrefraction");
 
   // GET equatorialsystem
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::equatorial_system>(
-      router, "equatorialsystem");
+      routes, "equatorialsystem");
 
   // GET focallength
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::focal_length>(
-      router, "focallength");
+      routes, "focallength");
 
   // GET guideratedeclination
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::guide_rate_declination>(
-      router, "guideratedeclination");
+      routes, "guideratedeclination");
 
   // GET guideraterightascension
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::guide_rate_ascension>(
-      router, "guideraterightascension");
+      routes, "guideraterightascension");
 
   // GET ispulseguiding
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::is_pulse_guiding>(
-      router, "ispulseguiding");
+      routes, "ispulseguiding");
 
   // GET rightascension
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::right_ascension>(
-      router, "rightascension");
+      routes, "rightascension");
 
   // GET rightascensionrate
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::right_ascension_rate>(
-      router, "rightascensionrate");
+      routes, "rightascensionrate");
 
   // GET sideofpier
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::side_of_pier>(
-      router, "sideofpier");
+      routes, "sideofpier");
 
   // GET siderealtime
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::sidereal_time>(
-      router, "siderealtime");
+      routes, "siderealtime");
 
   // GET siteelevation
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::site_elevation>(
-      router, "siteelevation");
+      routes, "siteelevation");
 
   // GET sitelatitude
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::site_latitude>(
-      router, "sitelatitude");
+      routes, "sitelatitude");
 
   // GET sitelongitude
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::site_longitude>(
-      router, "sitelongitude");
+      routes, "sitelongitude");
 
   // GET slewing
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::slewing>(
-          router, "slewing");
+          routes, "slewing");
 
   // GET slewsettletime
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::slew_settle_time>(
-      router, "slewsettletime");
+      routes, "slewsettletime");
 
   // GET targetdeclination
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::target_declination>(
-      router, "targetdeclination");
+      routes, "targetdeclination");
 
   // GET targetrightascension
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::target_right_ascension>(
-      router, "targetrightascension");
+      routes, "targetrightascension");
 
   // GET tracking
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::tracking>(
-          router, "tracking");
+          routes, "tracking");
 
   // GET trackingrate
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::tracking_rate>(
-      router, "trackingrate");
+      routes, "trackingrate");
 
   // GET trackingrates
   api_handler->add_route_to_router<i_alpaca_telescope,
                                    &i_alpaca_telescope::tracking_rates>(
-      router, "trackingrates");
+      routes, "trackingrates");
 
   // GET utcdate
   api_handler
       ->add_route_to_router<i_alpaca_telescope, &i_alpaca_telescope::utc_date>(
-          router, "utcdate");
+          routes, "utcdate");
 
   // This has a specific parameter that needs to be pulled out so our
   // add_route_to_router doesn't work in its current form
   //
   // GET axisrates
-  router->http_get(
+  routes->http_get(
       "/api/v1/telescope/:device_number/axisrates", [](auto req, auto params) {
         int axis_p = 0;
         std::map<std::string, std::string> qp;
@@ -1947,12 +2190,12 @@ server_handler() {
         }
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // GET canmoveaxis
-  router->http_get(
+  routes->http_get(
       "/api/v1/telescope/:device_number/canmoveaxis",
       [](auto req, auto params) {
         int axis_p = 0;
@@ -1988,13 +2231,13 @@ server_handler() {
         }
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // TODO: this is a multiparameter GET so I'll need to hand code this one
   // GET destinationsideofpier
-  router->http_get(
+  routes->http_get(
       "/api/v1/telescope/:device_number/destinationsideofpier",
       [](auto req, auto params) {
         double ra_p = 0;
@@ -2031,18 +2274,18 @@ server_handler() {
         }
 
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT findhome
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/findhome",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::find_home>());
 
   // PUT declinationrate
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/declinationrate",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2050,14 +2293,14 @@ server_handler() {
               "DeclinationRate"));
 
   // PUT doesrefraction
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/doesrefraction",
       api_handler->device_put_handler<bool, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_does_refraction>(
           "DoesRefraction", true));
 
   // PUT guideratedeclination
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/guideratedeclination",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2065,7 +2308,7 @@ server_handler() {
               "GuideRateDeclination"));
 
   // PUT guiderateascension
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/guideraterightascension",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2073,7 +2316,7 @@ server_handler() {
               "GuideRateRightAscension"));
 
   // PUT rightascensionrate
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/rightascensionrate",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2081,42 +2324,42 @@ server_handler() {
               "RightAscensionRate"));
 
   // PUT sideofpier
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/sideofpier",
       api_handler->device_put_handler<pier_side_enum, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_side_of_pier>(
           "SideOfPier"));
 
   // PUT siteelevation
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/siteelevation",
       api_handler->device_put_handler<double, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_site_elevation>(
           "SiteElevation"));
 
   // PUT sitelatitude
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/sitelatitude",
       api_handler->device_put_handler<double, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_site_latitude>(
           "SiteLatitude"));
 
   // PUT sitelongitude
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/sitelongitude",
       api_handler->device_put_handler<double, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_site_longitude>(
           "SiteLongitude"));
 
   // PUT slewsettletime
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewsettletime",
       api_handler->device_put_handler<
           int, i_alpaca_telescope, &i_alpaca_telescope::set_slew_settle_time>(
           "SlewSettleTime"));
 
   // PUT targetdeclination
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/targetdeclination",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2124,7 +2367,7 @@ server_handler() {
               "TargetDeclination"));
 
   // PUT targetrightascension
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/targetrightascension",
       api_handler
           ->device_put_handler<double, i_alpaca_telescope,
@@ -2132,34 +2375,34 @@ server_handler() {
               "TargetRightAscension"));
 
   // PUT tracking
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/tracking",
       api_handler->device_put_handler<bool, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_tracking>(
           "Tracking", true));
 
   // PUT trackingrate
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/trackingrate",
       api_handler->device_put_handler<drive_rate_enum, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_tracking_rate>(
           "TrackingRate"));
 
   // PUT utcdate
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/utcdate",
       api_handler->device_put_handler<std::string, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_utc_date>(
           "UTCDate"));
 
   // PUT abortslew
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/abortslew",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::abort_slew>());
 
   // PUT moveaxis
-  router->http_put("/api/v1/telescope/:device_number/moveaxis", [](auto req,
+  routes->http_put("/api/v1/telescope/:device_number/moveaxis", [](auto req,
                                                                    auto) {
     auto &response_map = req->extra_data().response_map;
     const auto qp = restinio::parse_query(req->body());
@@ -2173,7 +2416,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed {}", ex.what());
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2186,7 +2429,7 @@ server_handler() {
         response_map["ErrorNumber"] = -1;
         response_map["ErrorMessage"] = fmt::format("Failed to move axis");
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } catch (alpaca_exception &ex) {
@@ -2194,18 +2437,18 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT park
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/park",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::park>());
 
   // PUT pulseguide
-  router->http_put("/api/v1/telescope/:device_number/pulseguide", [](auto req,
+  routes->http_put("/api/v1/telescope/:device_number/pulseguide", [](auto req,
                                                                      auto) {
     auto &response_map = req->extra_data().response_map;
     const auto qp = restinio::parse_query(req->body());
@@ -2219,7 +2462,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for duration");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2232,7 +2475,7 @@ server_handler() {
         response_map["ErrorNumber"] = -1;
         response_map["ErrorMessage"] = fmt::format("Failed to move axis");
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } catch (alpaca_exception &ex) {
@@ -2240,18 +2483,18 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT setpark
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/setpark",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::set_park>());
 
   // PUT slewtoaltaz
-  router->http_put("/api/v1/telescope/:device_number/slewtoaltaz", [](auto req,
+  routes->http_put("/api/v1/telescope/:device_number/slewtoaltaz", [](auto req,
                                                                       auto) {
     auto &response_map = req->extra_data().response_map;
     const auto qp = restinio::parse_query(req->body());
@@ -2265,7 +2508,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for duration");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2277,7 +2520,7 @@ server_handler() {
         response_map["ErrorNumber"] = -1;
         response_map["ErrorMessage"] = "Failed to slew";
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } catch (alpaca_exception &ex) {
@@ -2285,12 +2528,12 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT slewtoaltazasync
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewtoaltazasync", [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
         const auto qp = restinio::parse_query(req->body());
@@ -2304,7 +2547,7 @@ server_handler() {
           response_map["ErrorMessage"] =
               fmt::format("Invalid Value passed for duration");
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
 
@@ -2317,7 +2560,7 @@ server_handler() {
             response_map["ErrorNumber"] = -1;
             response_map["ErrorMessage"] = "Failed to slew";
             return init_resp(req->create_response())
-                .set_body(nlohmann::json(response_map).dump())
+                .set_body(response_map.dump())
                 .done();
           }
         } catch (alpaca_exception &ex) {
@@ -2325,12 +2568,12 @@ server_handler() {
           response_map["ErrorMessage"] = ex.what();
         }
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT slewtocoordinates
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewtocoordinates", [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
         const auto qp = restinio::parse_query(req->body());
@@ -2344,7 +2587,7 @@ server_handler() {
           response_map["ErrorMessage"] =
               fmt::format("Invalid Value passed {}", ex.what());
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
 
@@ -2357,7 +2600,7 @@ server_handler() {
             response_map["ErrorNumber"] = -1;
             response_map["ErrorMessage"] = "Failed to slew";
             return init_resp(req->create_response())
-                .set_body(nlohmann::json(response_map).dump())
+                .set_body(response_map.dump())
                 .done();
           }
         } catch (alpaca_exception &ex) {
@@ -2365,12 +2608,12 @@ server_handler() {
           response_map["ErrorMessage"] = ex.what();
         }
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT slewtocoordinatesasync
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewtocoordinatesasync",
       [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
@@ -2385,7 +2628,7 @@ server_handler() {
           response_map["ErrorMessage"] =
               fmt::format("Invalid Value passed {}", ex.what());
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
 
@@ -2398,7 +2641,7 @@ server_handler() {
             response_map["ErrorNumber"] = -1;
             response_map["ErrorMessage"] = "Failed to slew";
             return init_resp(req->create_response())
-                .set_body(nlohmann::json(response_map).dump())
+                .set_body(response_map.dump())
                 .done();
           }
         } catch (alpaca_exception &ex) {
@@ -2406,25 +2649,25 @@ server_handler() {
           response_map["ErrorMessage"] = ex.what();
         }
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT slewtotarget
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewtotarget",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::slew_to_target>());
 
   // PUT slewtotargetasync
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/slewtotargetasync",
       api_handler
           ->device_put_handler<void, i_alpaca_telescope,
                                &i_alpaca_telescope::slew_to_target_async>());
 
   // PUT synctoaltaz
-  router->http_put("/api/v1/telescope/:device_number/synctoaltaz", [](auto req,
+  routes->http_put("/api/v1/telescope/:device_number/synctoaltaz", [](auto req,
                                                                       auto) {
     auto &response_map = req->extra_data().response_map;
     const auto qp = restinio::parse_query(req->body());
@@ -2437,7 +2680,7 @@ server_handler() {
       response_map["ErrorNumber"] = alpaca_exception::INVALID_VALUE;
       response_map["ErrorMessage"] = fmt::format("Invalid Value passed Alt Az");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2449,7 +2692,7 @@ server_handler() {
         response_map["ErrorNumber"] = -1;
         response_map["ErrorMessage"] = "Failed to sync";
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       }
     } catch (alpaca_exception &ex) {
@@ -2457,12 +2700,12 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT synctocoordinates
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/synctocoordinates", [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
         const auto qp = restinio::parse_query(req->body());
@@ -2476,7 +2719,7 @@ server_handler() {
           response_map["ErrorMessage"] =
               fmt::format("Invalid Value passed {}", ex.what());
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
 
@@ -2489,7 +2732,7 @@ server_handler() {
             response_map["ErrorNumber"] = -1;
             response_map["ErrorMessage"] = "Failed to sync";
             return init_resp(req->create_response())
-                .set_body(nlohmann::json(response_map).dump())
+                .set_body(response_map.dump())
                 .done();
           }
         } catch (alpaca_exception &ex) {
@@ -2497,18 +2740,18 @@ server_handler() {
           response_map["ErrorMessage"] = ex.what();
         }
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
   // PUT synctotarget
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/synctotarget",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::sync_to_target>());
 
   // PUT unpark
-  router->http_put(
+  routes->http_put(
       "/api/v1/telescope/:device_number/unpark",
       api_handler->device_put_handler<void, i_alpaca_telescope,
                                       &i_alpaca_telescope::unpark>());
@@ -2520,69 +2763,69 @@ server_handler() {
   // GET absolute
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::absolute>(
-          router, "absolute");
+          routes, "absolute");
 
   // GET ismoving
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::is_moving>(
-          router, "ismoving");
+          routes, "ismoving");
 
   // GET maxincrement
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::max_increment>(
-          router, "maxincrement");
+          routes, "maxincrement");
 
   // GET maxstep
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::max_step>(
-          router, "maxstep");
+          routes, "maxstep");
 
   // GET position
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::position>(
-          router, "position");
+          routes, "position");
 
   // GET stepsize
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::step_size>(
-          router, "stepsize");
+          routes, "stepsize");
 
   // GET tempcomp
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::temp_comp>(
-          router, "tempcomp");
+          routes, "tempcomp");
 
   // GET tempcompavailable
   api_handler->add_route_to_router<i_alpaca_focuser,
                                    &i_alpaca_focuser::temp_comp_available>(
-      router, "tempcompavailable");
+      routes, "tempcompavailable");
 
   // GET temperature
   api_handler
       ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::temperature>(
-          router, "temperature");
+          routes, "temperature");
 
   // GET details
   // api_handler
   //     ->add_route_to_router<i_alpaca_focuser, &i_alpaca_focuser::details>(
-  //         router, "details");
+  //         routes, "details");
 
-  // router->http_get("/api/v1/")
+  // routes->http_get("/api/v1/")
 
   // PUT tempcomp
-  router->http_put(
+  routes->http_put(
       "/api/v1/focuser/:device_number/tempcomp",
       api_handler->device_put_handler<bool, i_alpaca_focuser,
                                       &i_alpaca_focuser::set_temp_comp>(
           "TempComp", true));
 
   // PUT halt
-  router->http_put("/api/v1/focuser/:device_number/halt",
+  routes->http_put("/api/v1/focuser/:device_number/halt",
                    api_handler->device_put_handler<void, i_alpaca_focuser,
                                                    &i_alpaca_focuser::halt>());
 
   // PUT move
-  router->http_put(
+  routes->http_put(
       "/api/v1/focuser/:device_number/move",
       api_handler->device_put_handler<uint32_t, i_alpaca_focuser,
                                       &i_alpaca_focuser::move>("Position"));
@@ -2594,47 +2837,47 @@ server_handler() {
   // GET maxswitch
   api_handler
       ->add_route_to_router<i_alpaca_switch, &i_alpaca_switch::max_switch>(
-          router, "maxswitch");
+          routes, "maxswitch");
 
   // GET canwrite
-  router->http_get("/api/v1/switch/:device_number/canwrite",
+  routes->http_get("/api/v1/switch/:device_number/canwrite",
                    switch_by_id_get_handler<&i_alpaca_switch::can_write>());
 
   // GET getswitch
-  router->http_get("/api/v1/switch/:device_number/getswitch",
+  routes->http_get("/api/v1/switch/:device_number/getswitch",
                    switch_by_id_get_handler<&i_alpaca_switch::get_switch>());
 
   // GET getswitchdescription
-  router->http_get(
+  routes->http_get(
       "/api/v1/switch/:device_number/getswitchdescription",
       switch_by_id_get_handler<&i_alpaca_switch::get_switch_description>());
 
   // GET getswitchname
-  router->http_get(
+  routes->http_get(
       "/api/v1/switch/:device_number/getswitchname",
       switch_by_id_get_handler<&i_alpaca_switch::get_switch_name>());
 
   // GET getswitchvalue
-  router->http_get(
+  routes->http_get(
       "/api/v1/switch/:device_number/getswitchvalue",
       switch_by_id_get_handler<&i_alpaca_switch::get_switch_value>());
 
   // GET minswitchvalue
-  router->http_get(
+  routes->http_get(
       "/api/v1/switch/:device_number/minswitchvalue",
       switch_by_id_get_handler<&i_alpaca_switch::min_switch_value>());
 
   // GET maxswitchvalue
-  router->http_get(
+  routes->http_get(
       "/api/v1/switch/:device_number/maxswitchvalue",
       switch_by_id_get_handler<&i_alpaca_switch::max_switch_value>());
 
   // GET switchstep
-  router->http_get("/api/v1/switch/:device_number/switchstep",
+  routes->http_get("/api/v1/switch/:device_number/switchstep",
                    switch_by_id_get_handler<&i_alpaca_switch::switch_step>());
 
   // PUT setswitch
-  router->http_put("/api/v1/switch/:device_number/setswitch", [](auto req,
+  routes->http_put("/api/v1/switch/:device_number/setswitch", [](auto req,
                                                                  auto) {
     auto raw_request_params = restinio::parse_query(req->header().query());
 
@@ -2667,7 +2910,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for State");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2683,12 +2926,12 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT setswitchname
-  router->http_put("/api/v1/switch/:device_number/setswitchname", [](auto req,
+  routes->http_put("/api/v1/switch/:device_number/setswitchname", [](auto req,
                                                                      auto) {
     auto raw_request_params = restinio::parse_query(req->header().query());
 
@@ -2711,7 +2954,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for Name");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2727,12 +2970,12 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT setswitchvalue
-  router->http_put("/api/v1/switch/:device_number/setswitchvalue", [](auto req,
+  routes->http_put("/api/v1/switch/:device_number/setswitchvalue", [](auto req,
                                                                       auto) {
     auto raw_request_params = restinio::parse_query(req->header().query());
 
@@ -2756,7 +2999,7 @@ server_handler() {
       response_map["ErrorMessage"] =
           fmt::format("Invalid Value passed for Value");
       return init_resp(req->create_response(restinio::status_bad_request()))
-          .set_body(nlohmann::json(response_map).dump())
+          .set_body(response_map.dump())
           .done();
     }
 
@@ -2772,12 +3015,12 @@ server_handler() {
       response_map["ErrorMessage"] = ex.what();
     }
     return init_resp(req->create_response())
-        .set_body(nlohmann::json(response_map).dump())
+        .set_body(response_map.dump())
         .done();
   });
 
   // PUT sendserialcommand
-  router->http_put(
+  routes->http_put(
       "/api/v1/switch/:device_number/sendserialcommand", [](auto req, auto) {
         auto &response_map = req->extra_data().response_map;
         const auto qp = restinio::parse_query(req->body());
@@ -2789,7 +3032,7 @@ server_handler() {
           response_map["ErrorMessage"] =
               fmt::format("Invalid Value passed for serial command");
           return init_resp(req->create_response(restinio::status_bad_request()))
-              .set_body(nlohmann::json(response_map).dump())
+              .set_body(response_map.dump())
               .done();
         }
 
@@ -2807,7 +3050,7 @@ server_handler() {
           response_map["ErrorMessage"] = ex.what();
         }
         return init_resp(req->create_response())
-            .set_body(nlohmann::json(response_map).dump())
+            .set_body(response_map.dump())
             .done();
       });
 
@@ -2818,72 +3061,72 @@ server_handler() {
   // GET canreverse
   api_handler
       ->add_route_to_router<i_alpaca_rotator, &i_alpaca_rotator::can_reverse>(
-          router, "canreverse");
+          routes, "canreverse");
 
   // GET ismoving
   api_handler
       ->add_route_to_router<i_alpaca_rotator, &i_alpaca_rotator::is_moving>(
-          router, "ismoving");
+          routes, "ismoving");
 
   // GET mechanicalposition
   api_handler->add_route_to_router<i_alpaca_rotator,
                                    &i_alpaca_rotator::mechanical_position>(
-      router, "mechanicalposition");
+      routes, "mechanicalposition");
 
   // GET position
   api_handler
       ->add_route_to_router<i_alpaca_rotator, &i_alpaca_rotator::position>(
-          router, "position");
+          routes, "position");
 
   // GET reverse
   api_handler
       ->add_route_to_router<i_alpaca_rotator, &i_alpaca_rotator::reverse>(
-          router, "reverse");
+          routes, "reverse");
 
   // GET stepsize
   api_handler
       ->add_route_to_router<i_alpaca_rotator, &i_alpaca_rotator::step_size>(
-          router, "stepsize");
+          routes, "stepsize");
 
   // GET targetposition
   api_handler->add_route_to_router<i_alpaca_rotator,
                                    &i_alpaca_rotator::target_position>(
-      router, "targetposition");
+      routes, "targetposition");
 
   // PUT reverse
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/reverse",
       api_handler->device_put_handler<bool, i_alpaca_rotator,
       &i_alpaca_rotator::set_reverse>("Reverse", true));
 
   // PUT halt
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/halt",
       api_handler->device_put_handler<void, i_alpaca_rotator,
                                       &i_alpaca_rotator::halt>());
 
   // PUT move
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/move",
       api_handler->device_put_handler<double, i_alpaca_rotator,
                                       &i_alpaca_rotator::move>("Position"));
 
   // PUT moveabsolute
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/moveabsolute",
       api_handler->device_put_handler<double, i_alpaca_rotator,
                                       &i_alpaca_rotator::moveabsolute>(
           "Position"));
 
   // PUT movemechanical
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/movemechanical",
       api_handler->device_put_handler<double, i_alpaca_rotator,
                                       &i_alpaca_rotator::movemechanical>(
           "Position"));
 
   // PUT sync
-  router->http_put(
+  routes->http_put(
       "/api/v1/rotator/:device_number/sync",
       api_handler->device_put_handler<double, i_alpaca_rotator,
                                       &i_alpaca_rotator::sync>(
@@ -2891,18 +3134,7 @@ server_handler() {
 
   // END rotator routes
 
-  router->non_matched_request_handler([](auto req) {
-    return req->create_response(restinio::status_not_found())
-        .append_header_date_field()
-        .connection_close()
-        .done();
-  });
-
-  // return router;
-  return
-      [_handler = std::move(router)](
-          const restinio::generic_request_handle_t<device_data_factory::data_t>
-              &req) { return (*_handler)(req); };
+  return routes;
 }
 
 }; // namespace alpaca_hub_server
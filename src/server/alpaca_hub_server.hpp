@@ -3,7 +3,11 @@
 
 #include "common/alpaca_exception.hpp"
 #include "common/alpaca_hub_common.hpp"
+#include "common/alpaca_response.hpp"
+#include "common/image_array_json_writer.hpp"
+#include "common/image_bytes_writer.hpp"
 #include "common/image_bytes.hpp"
+#include "common/route_table.hpp"
 #include "drivers/qhy_alpaca_camera.hpp"
 #include "drivers/qhy_alpaca_filterwheel.hpp"
 #include "http_server_logger.hpp"
@@ -36,6 +40,7 @@
 #include <map>
 #include <memory>
 #include <sstream>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -55,6 +60,12 @@ template <typename RESP> RESP init_resp(RESP resp);
 template <typename RESP> RESP init_resp_imagebytes(RESP resp);
 template <typename RESP> RESP init_resp_html(RESP resp);
 
+using chunked_response_t =
+    restinio::response_builder_t<restinio::chunked_output_t>;
+using user_controlled_response_t =
+    restinio::response_builder_t<restinio::user_controlled_output_t>;
+
+
 // I'm not sure I really need a class here...I may just leverage the namespace
 // class alpaca_hub_server {
 // public:
@@ -85,7 +96,8 @@ inline std::string slurp(const std::string &path) {
   return buffer.str();
 }
 
-using device_param_t = std::map<std::string, device_variant_t>;
+// Written straight out as JSON, see common/alpaca_response.hpp
+using device_param_t = alpaca_response_t;
 
 // This is a data structure that allows us to pass our data between
 // the various rest handlers
@@ -137,6 +149,33 @@ using device_request_handler_t =
     std::function<restinio::request_handling_status_t(
         device_request_handle_t, restinio::router::route_params_t)>;
 
+// The device API routes, /api/v1/<device_type>/<n>/<action>. By the time
+// one of these is needed the easy_parser_router in create_device_api_handler
+// has already split the path up, so rather than run it past a couple of
+// hundred regexes in the express router the handler is looked up by
+// (method, device type, action) in a table that's built once at startup.
+class device_routes_t {
+public:
+  // Paths are written like they were for the express router, e.g.
+  // "/api/v1/camera/:device_number/gain". A :device_type adds the route for
+  // every device type.
+  void http_get(std::string_view path, device_request_handler_t handler);
+  void http_put(std::string_view path, device_request_handler_t handler);
+
+  // request_not_handled() if there's no such route
+  restinio::request_handling_status_t
+  dispatch(route_method_enum method, const device_request_handle_t &req,
+           std::string_view device_type, std::string_view action) const;
+
+  size_t size() const { return _table.size(); }
+
+private:
+  void add(route_method_enum method, std::string_view path,
+           device_request_handler_t handler);
+
+  route_table_t<device_request_handler_t> _table;
+};
+
 class api_v1_handler {
 public:
   using device_num_t = uint64_t;
@@ -168,13 +207,14 @@ public:
                                               bool validate_True_False = false);
 
   template <typename T, auto F>
-  void add_route_to_router(const std::shared_ptr<device_router_t> &router,
+  void add_route_to_router(const std::shared_ptr<device_routes_t> &routes,
                            const std::string &route_action);
 };
 
 using device_lambda_t =
     std::function<device_request_handler_t(device_request_handle_t &)>;
 
+std::shared_ptr<device_routes_t> create_device_routes();
 std::function<restinio::request_handling_status_t(device_request_handle_t)>
 create_device_api_handler();
 std::function<restinio::request_handling_status_t(device_request_handle_t)>
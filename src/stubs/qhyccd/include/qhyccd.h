@@ -0,0 +1,105 @@
+#ifndef QHYCCD_STUB_QHYCCD_H
+#define QHYCCD_STUB_QHYCCD_H
+
+// Stand-in for the QHY SDK header, only declares what AlpacaHub uses. The
+// signatures follow the real qhyccd.h so the driver compiles unchanged
+// against either one.
+
+#include "qhyccdcamdef.h"
+#include "qhyccderr.h"
+#include "qhyccdstruct.h"
+#include <stdint.h>
+
+#define EXPORTC extern "C"
+#define STDCALL
+
+EXPORTC uint32_t STDCALL InitQHYCCDResource(void);
+EXPORTC uint32_t STDCALL ReleaseQHYCCDResource(void);
+EXPORTC uint32_t STDCALL ScanQHYCCD(void);
+EXPORTC uint32_t STDCALL GetQHYCCDId(uint32_t index, char *id);
+EXPORTC uint32_t STDCALL GetQHYCCDModel(char *id, char *model);
+EXPORTC qhyccd_handle *STDCALL OpenQHYCCD(char *id);
+EXPORTC uint32_t STDCALL CloseQHYCCD(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL SetQHYCCDStreamMode(qhyccd_handle *handle,
+                                             uint8_t mode);
+EXPORTC uint32_t STDCALL InitQHYCCD(qhyccd_handle *handle);
+
+EXPORTC uint32_t STDCALL IsQHYCCDControlAvailable(qhyccd_handle *handle,
+                                                  CONTROL_ID controlId);
+EXPORTC uint32_t STDCALL SetQHYCCDParam(qhyccd_handle *handle,
+                                        CONTROL_ID controlId, double value);
+EXPORTC double STDCALL GetQHYCCDParam(qhyccd_handle *handle,
+                                      CONTROL_ID controlId);
+EXPORTC uint32_t STDCALL GetQHYCCDParamMinMaxStep(qhyccd_handle *handle,
+                                                  CONTROL_ID controlId,
+                                                  double *min, double *max,
+                                                  double *step);
+
+EXPORTC uint32_t STDCALL SetQHYCCDResolution(qhyccd_handle *handle,
+                                             uint32_t x, uint32_t y,
+                                             uint32_t xsize, uint32_t ysize);
+EXPORTC uint32_t STDCALL SetQHYCCDBinMode(qhyccd_handle *handle, uint32_t wbin,
+                                          uint32_t hbin);
+EXPORTC uint32_t STDCALL SetQHYCCDBitsMode(qhyccd_handle *handle,
+                                           uint32_t bits);
+EXPORTC uint32_t STDCALL GetQHYCCDMemLength(qhyccd_handle *handle);
+
+EXPORTC uint32_t STDCALL ExpQHYCCDSingleFrame(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL GetQHYCCDSingleFrame(qhyccd_handle *handle,
+                                              uint32_t *w, uint32_t *h,
+                                              uint32_t *bpp,
+                                              uint32_t *channels,
+                                              uint8_t *imgdata);
+EXPORTC uint32_t STDCALL CancelQHYCCDExposing(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL CancelQHYCCDExposingAndReadout(qhyccd_handle *handle);
+EXPORTC double STDCALL GetQHYCCDExposureRemaining(qhyccd_handle *handle);
+
+EXPORTC uint32_t STDCALL BeginQHYCCDLive(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL GetQHYCCDLiveFrame(qhyccd_handle *handle, uint32_t *w,
+                                            uint32_t *h, uint32_t *bpp,
+                                            uint32_t *channels,
+                                            uint8_t *imgdata);
+EXPORTC uint32_t STDCALL StopQHYCCDLive(qhyccd_handle *handle);
+
+EXPORTC uint32_t STDCALL GetQHYCCDChipInfo(qhyccd_handle *handle,
+                                           double *chipw, double *chiph,
+                                           uint32_t *imagew, uint32_t *imageh,
+                                           double *pixelw, double *pixelh,
+                                           uint32_t *bpp);
+EXPORTC uint32_t STDCALL GetQHYCCDEffectiveArea(qhyccd_handle *handle,
+                                                uint32_t *startX,
+                                                uint32_t *startY,
+                                                uint32_t *sizeX,
+                                                uint32_t *sizeY);
+EXPORTC uint32_t STDCALL GetQHYCCDOverScanArea(qhyccd_handle *handle,
+                                               uint32_t *startX,
+                                               uint32_t *startY,
+                                               uint32_t *sizeX,
+                                               uint32_t *sizeY);
+EXPORTC uint32_t STDCALL GetQHYCCDFWVersion(qhyccd_handle *handle,
+                                            uint8_t *buf);
+EXPORTC uint32_t STDCALL GetQHYCCDType(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL GetQHYCCDSensorName(qhyccd_handle *handle,
+                                             char *name);
+
+EXPORTC uint32_t STDCALL GetQHYCCDNumberOfReadModes(qhyccd_handle *handle,
+                                                    uint32_t *numModes);
+EXPORTC uint32_t STDCALL GetQHYCCDReadModeName(qhyccd_handle *handle,
+                                               uint32_t modeNumber,
+                                               char *name);
+EXPORTC uint32_t STDCALL SetQHYCCDReadMode(qhyccd_handle *handle,
+                                           uint32_t modeNumber);
+EXPORTC uint32_t STDCALL GetQHYCCDReadMode(qhyccd_handle *handle,
+                                           uint32_t *modeNumber);
+
+EXPORTC uint32_t STDCALL IsQHYCCDCFWPlugged(qhyccd_handle *handle);
+EXPORTC uint32_t STDCALL GetQHYCCDCFWStatus(qhyccd_handle *handle,
+                                            char *status);
+EXPORTC uint32_t STDCALL SendOrder2QHYCCDCFW(qhyccd_handle *handle,
+                                             char *order, uint32_t length);
+
+EXPORTC void STDCALL EnableQHYCCDMessage(bool enable);
+EXPORTC void STDCALL RegisterPnpEventIn(void (*in)(char *id));
+EXPORTC void STDCALL RegisterPnpEventOut(void (*out)(char *id));
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef QHYCCD_STUB_H
+#define QHYCCD_STUB_H
+
+#include <cstdint>
+
+// Knobs for the fake QHY SDK. Anything set here applies to cameras opened
+// after the call, so configure before InitializeQHYSDK() / OpenQHYCCD().
+//
+// The same values can also be set from the environment (read once by
+// InitQHYCCDResource), handy for running AlpacaHub itself against the stub:
+//   QHY_STUB_CAMERAS, QHY_STUB_WIDTH, QHY_STUB_HEIGHT, QHY_STUB_BPP,
+//   QHY_STUB_READOUT_MS, QHY_STUB_CALL_LATENCY_US, QHY_STUB_STARS,
+//   QHY_STUB_FILTERS, QHY_STUB_SEED
+struct qhy_stub_config_t {
+  uint32_t camera_count = 1;
+  uint32_t width = 3200;
+  uint32_t height = 2200;
+  // 8 or 16, can still be changed per camera with CONTROL_TRANSFERBIT
+  uint32_t bpp = 16;
+  double pixel_size_um = 3.76;
+  // How long GetQHYCCDSingleFrame takes once the exposure is done. Live
+  // mode reads out in proportion to the ROI, so a 10% crop takes 10% of it.
+  uint32_t readout_ms = 100;
+  // Added to every SDK call to mimic a USB round trip
+  uint32_t call_latency_us = 0;
+  uint32_t star_count = 200;
+  // 0 means no filter wheel is attached
+  uint32_t filter_slots = 7;
+  uint32_t seed = 1;
+};
+
+void qhy_stub_configure(const qhy_stub_config_t &config);
+qhy_stub_config_t qhy_stub_config();
+
+// Total number of SDK calls made so far, so tests can check that a code path
+// really skipped the SDK
+uint64_t qhy_stub_call_count();
+uint64_t qhy_stub_param_set_count();
+
+#endif
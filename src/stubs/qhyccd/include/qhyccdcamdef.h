@@ -0,0 +1,7 @@
+#ifndef QHYCCD_STUB_QHYCCDCAMDEF_H
+#define QHYCCD_STUB_QHYCCDCAMDEF_H
+
+// The real header is a list of camera model ids, none of which the driver
+// uses directly
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef QHYCCD_STUB_QHYCCDERR_H
+#define QHYCCD_STUB_QHYCCDERR_H
+
+// Return codes matching the real SDK's qhyccderr.h
+#define QHYCCD_READ_DIRECTLY 0x2001
+#define QHYCCD_DELAY_200MS 0x2000
+#define QHYCCD_SUCCESS 0
+#define QHYCCD_ERROR 0xFFFFFFFF
+
+#endif
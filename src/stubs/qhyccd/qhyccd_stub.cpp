@@ -0,0 +1,825 @@
+// A fake QHY SDK so the camera / filter wheel drivers can be exercised
+// without hardware. It keeps just enough state per camera to behave like
+// the real thing from the driver's point of view: exposures take as long as
+// they should, readout takes readout_ms, the ROI / bin / bit depth are
+// honoured and the frame has a noisy background with a fixed star field so
+// anything that looks at pixel data has something to chew on.
+
+#include "qhyccd.h"
+#include "qhyccd_stub.h"
+#include "common/star_field_renderer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using stub_clock_t = std::chrono::steady_clock;
+
+struct stub_camera_t {
+  std::string id;
+  qhy_stub_config_t config;
+  std::mutex mtx;
+
+  bool initialized = false;
+  uint32_t read_mode = 0;
+  uint32_t bin = 1;
+  // ROI in binned pixels, same as the SDK
+  uint32_t start_x = 0;
+  uint32_t start_y = 0;
+  uint32_t num_x = 0;
+  uint32_t num_y = 0;
+  std::map<CONTROL_ID, double> params;
+
+  bool exposing = false;
+  std::atomic<bool> cancelled{false};
+  stub_clock_t::time_point exposure_start;
+  stub_clock_t::time_point exposure_end;
+  double exposure_seconds = 0;
+  uint32_t frame_number = 0;
+
+  // Live mode. Frames become available every frame period whether or not
+  // anybody reads them, the ones nobody picks up are lost like on a real
+  // camera.
+  uint8_t stream_mode = 0;
+  bool live = false;
+  stub_clock_t::time_point next_live_frame;
+
+  // Cooler model, just enough to see the temperature move
+  double temperature = 20;
+  double cooler_target = 20;
+  bool cooler_regulating = false;
+  double manual_pwm = 0;
+  stub_clock_t::time_point temperature_updated = stub_clock_t::now();
+
+  uint32_t filter_position = 0;
+  uint32_t filter_target = 0;
+  stub_clock_t::time_point filter_arrives;
+
+  star_field_renderer_t sky;
+};
+
+constexpr double ambient_temperature = 20;
+constexpr const char *read_mode_names[] = {"STANDARD MODE", "HIGH GAIN MODE"};
+constexpr uint32_t read_mode_count = 2;
+
+std::mutex g_stub_mtx;
+qhy_stub_config_t g_config;
+bool g_environment_read = false;
+std::vector<std::unique_ptr<stub_camera_t>> g_cameras;
+std::atomic<uint64_t> g_call_count{0};
+std::atomic<uint64_t> g_param_set_count{0};
+
+// Every SDK entry point goes through here
+void sdk_call() {
+  g_call_count++;
+  uint32_t latency_us;
+  {
+    std::lock_guard lock(g_stub_mtx);
+    latency_us = g_config.call_latency_us;
+  }
+  if (latency_us)
+    std::this_thread::sleep_for(std::chrono::microseconds(latency_us));
+}
+
+stub_camera_t *camera_from_handle(qhyccd_handle *handle) {
+  std::lock_guard lock(g_stub_mtx);
+  for (auto &cam : g_cameras)
+    if (cam.get() == handle)
+      return cam.get();
+  return nullptr;
+}
+
+void read_environment(qhy_stub_config_t &config) {
+  auto read = [](const char *name, uint32_t &value) {
+    if (const char *v = std::getenv(name))
+      value = std::strtoul(v, nullptr, 10);
+  };
+  read("QHY_STUB_CAMERAS", config.camera_count);
+  read("QHY_STUB_WIDTH", config.width);
+  read("QHY_STUB_HEIGHT", config.height);
+  read("QHY_STUB_BPP", config.bpp);
+  read("QHY_STUB_READOUT_MS", config.readout_ms);
+  read("QHY_STUB_CALL_LATENCY_US", config.call_latency_us);
+  read("QHY_STUB_STARS", config.star_count);
+  read("QHY_STUB_FILTERS", config.filter_slots);
+  read("QHY_STUB_SEED", config.seed);
+}
+
+star_field_renderer_t make_sky(const qhy_stub_config_t &config,
+                               uint32_t camera_index) {
+  star_field_config_t field;
+  field.width = config.width;
+  field.height = config.height;
+  field.star_count = config.star_count;
+  field.seed = config.seed + camera_index;
+  return star_field_renderer_t(field);
+}
+
+void update_temperature(stub_camera_t &cam) {
+  auto now = stub_clock_t::now();
+  double elapsed =
+      std::chrono::duration<double>(now - cam.temperature_updated).count();
+  cam.temperature_updated = now;
+
+  double target = ambient_temperature;
+  if (cam.cooler_regulating)
+    target = std::max(cam.cooler_target, ambient_temperature - 35);
+  else if (cam.manual_pwm > 0)
+    target = ambient_temperature - 35 * cam.manual_pwm / 255;
+
+  // Half a degree a second is roughly what a real TEC manages
+  double step = 0.5 * elapsed;
+  if (std::abs(target - cam.temperature) <= step)
+    cam.temperature = target;
+  else
+    cam.temperature += (target > cam.temperature) ? step : -step;
+
+  double pwm = cam.manual_pwm;
+  if (cam.cooler_regulating)
+    pwm = std::clamp((ambient_temperature - cam.temperature) / 35 * 255, 0.0,
+                     255.0);
+  cam.params[CONTROL_CURTEMP] = cam.temperature;
+  cam.params[CONTROL_CURPWM] = pwm;
+}
+
+uint32_t frame_width(const stub_camera_t &cam) {
+  return std::min(cam.num_x, cam.config.width / cam.bin - cam.start_x);
+}
+
+uint32_t frame_height(const stub_camera_t &cam) {
+  return std::min(cam.num_y, cam.config.height / cam.bin - cam.start_y);
+}
+
+template <typename T>
+void render_frame(const stub_camera_t &cam, T *out, uint32_t w, uint32_t h,
+                  double max_adu) {
+  double gain = cam.params.count(CONTROL_GAIN) ? cam.params.at(CONTROL_GAIN) : 0;
+  double offset =
+      cam.params.count(CONTROL_OFFSET) ? cam.params.at(CONTROL_OFFSET) : 0;
+  star_field_window_t window;
+  window.width = w;
+  window.height = h;
+  window.start_x = cam.start_x;
+  window.start_y = cam.start_y;
+  window.bin_x = cam.bin;
+  window.bin_y = cam.bin;
+  cam.sky.render_pixels(out, window, cam.exposure_seconds, gain, offset,
+                        cam.frame_number, max_adu);
+}
+
+void copy_string(char *dest, const std::string &src) {
+  std::memcpy(dest, src.c_str(), src.size() + 1);
+}
+
+} // namespace
+
+void qhy_stub_configure(const qhy_stub_config_t &config) {
+  std::lock_guard lock(g_stub_mtx);
+  g_config = config;
+  // Explicit configuration wins over the environment
+  g_environment_read = true;
+}
+
+qhy_stub_config_t qhy_stub_config() {
+  std::lock_guard lock(g_stub_mtx);
+  return g_config;
+}
+
+uint64_t qhy_stub_call_count() { return g_call_count; }
+
+uint64_t qhy_stub_param_set_count() { return g_param_set_count; }
+
+uint32_t InitQHYCCDResource(void) {
+  sdk_call();
+  std::lock_guard lock(g_stub_mtx);
+  if (!g_environment_read) {
+    read_environment(g_config);
+    g_environment_read = true;
+  }
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t ReleaseQHYCCDResource(void) {
+  sdk_call();
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t ScanQHYCCD(void) {
+  sdk_call();
+  std::lock_guard lock(g_stub_mtx);
+  return g_config.camera_count;
+}
+
+uint32_t GetQHYCCDId(uint32_t index, char *id) {
+  sdk_call();
+  std::lock_guard lock(g_stub_mtx);
+  if (index >= g_config.camera_count)
+    return QHYCCD_ERROR;
+  copy_string(id, "QHYSTUB-" + std::to_string(index) + "-0001");
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDModel(char *id, char *model) {
+  sdk_call();
+  // Like the SDK the model is the id without the serial number
+  std::string id_str(id);
+  auto pos = id_str.rfind('-');
+  copy_string(model, pos == std::string::npos ? id_str : id_str.substr(0, pos));
+  return QHYCCD_SUCCESS;
+}
+
+qhyccd_handle *OpenQHYCCD(char *id) {
+  sdk_call();
+  std::string id_str(id);
+  std::lock_guard lock(g_stub_mtx);
+  for (uint32_t i = 0; i < g_config.camera_count; i++) {
+    if (id_str != "QHYSTUB-" + std::to_string(i) + "-0001")
+      continue;
+
+    auto cam = std::make_unique<stub_camera_t>();
+    cam->id = id_str;
+    cam->config = g_config;
+    if (cam->config.bpp != 8)
+      cam->config.bpp = 16;
+    cam->num_x = cam->config.width;
+    cam->num_y = cam->config.height;
+    cam->params[CONTROL_GAIN] = 30;
+    cam->params[CONTROL_OFFSET] = 10;
+    cam->params[CONTROL_EXPOSURE] = 1000000;
+    cam->params[CONTROL_USBTRAFFIC] = 20;
+    cam->params[CONTROL_TRANSFERBIT] = cam->config.bpp;
+    cam->params[CONTROL_CURTEMP] = ambient_temperature;
+    cam->params[CONTROL_CURPWM] = 0;
+    cam->sky = make_sky(cam->config, i);
+    g_cameras.push_back(std::move(cam));
+    return g_cameras.back().get();
+  }
+  return nullptr;
+}
+
+uint32_t CloseQHYCCD(qhyccd_handle *handle) {
+  sdk_call();
+  std::lock_guard lock(g_stub_mtx);
+  auto it = std::find_if(g_cameras.begin(), g_cameras.end(),
+                         [handle](auto &cam) { return cam.get() == handle; });
+  if (it == g_cameras.end())
+    return QHYCCD_ERROR;
+  g_cameras.erase(it);
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t SetQHYCCDStreamMode(qhyccd_handle *handle, uint8_t mode) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam || mode > 1)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  if (cam->live)
+    return QHYCCD_ERROR;
+  cam->stream_mode = mode;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t InitQHYCCD(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  // Same as the SDK, this resets bin and ROI
+  cam->initialized = true;
+  cam->bin = 1;
+  cam->start_x = 0;
+  cam->start_y = 0;
+  cam->num_x = cam->config.width;
+  cam->num_y = cam->config.height;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t IsQHYCCDControlAvailable(qhyccd_handle *handle, CONTROL_ID controlId) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+
+  switch (controlId) {
+  case CONTROL_GAIN:
+  case CONTROL_OFFSET:
+  case CONTROL_EXPOSURE:
+  case CONTROL_TRANSFERBIT:
+  case CONTROL_USBTRAFFIC:
+  case CONTROL_CURTEMP:
+  case CONTROL_CURPWM:
+  case CONTROL_MANULPWM:
+  case CONTROL_COOLER:
+  case CAM_BIN1X1MODE:
+  case CAM_BIN2X2MODE:
+  case CAM_BIN4X4MODE:
+  case CAM_8BITS:
+  case CAM_16BITS:
+  case CAM_SINGLEFRAMEMODE:
+  case CAM_LIVEVIDEOMODE:
+    return QHYCCD_SUCCESS;
+  case CONTROL_CFWPORT:
+  case CONTROL_CFWSLOTSNUM:
+    return cam->config.filter_slots ? QHYCCD_SUCCESS : QHYCCD_ERROR;
+  default:
+    return QHYCCD_ERROR;
+  }
+}
+
+uint32_t SetQHYCCDParam(qhyccd_handle *handle, CONTROL_ID controlId,
+                        double value) {
+  sdk_call();
+  g_param_set_count++;
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+
+  switch (controlId) {
+  case CONTROL_GAIN:
+    if (value < 0 || value > 100)
+      return QHYCCD_ERROR;
+    break;
+  case CONTROL_OFFSET:
+    if (value < 0 || value > 255)
+      return QHYCCD_ERROR;
+    break;
+  case CONTROL_EXPOSURE:
+    if (value < 1 || value > 3600e6)
+      return QHYCCD_ERROR;
+    break;
+  case CONTROL_TRANSFERBIT:
+    if (value != 8 && value != 16)
+      return QHYCCD_ERROR;
+    break;
+  case CONTROL_USBTRAFFIC:
+    if (value < 0 || value > 60)
+      return QHYCCD_ERROR;
+    break;
+  case CONTROL_COOLER:
+    update_temperature(*cam);
+    cam->cooler_regulating = true;
+    cam->cooler_target = value;
+    break;
+  case CONTROL_MANULPWM:
+    update_temperature(*cam);
+    cam->cooler_regulating = false;
+    cam->manual_pwm = std::clamp(value, 0.0, 255.0);
+    break;
+  default:
+    return QHYCCD_ERROR;
+  }
+
+  cam->params[controlId] = value;
+  return QHYCCD_SUCCESS;
+}
+
+double GetQHYCCDParam(qhyccd_handle *handle, CONTROL_ID controlId) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+
+  if (controlId == CONTROL_CURTEMP || controlId == CONTROL_CURPWM)
+    update_temperature(*cam);
+  if (controlId == CONTROL_CFWSLOTSNUM)
+    return cam->config.filter_slots;
+
+  auto it = cam->params.find(controlId);
+  if (it == cam->params.end())
+    return QHYCCD_ERROR;
+  return it->second;
+}
+
+uint32_t GetQHYCCDParamMinMaxStep(qhyccd_handle *handle, CONTROL_ID controlId,
+                                  double *min, double *max, double *step) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+
+  auto set = [&](double mn, double mx, double st) {
+    *min = mn;
+    *max = mx;
+    *step = st;
+    return QHYCCD_SUCCESS;
+  };
+
+  switch (controlId) {
+  case CONTROL_GAIN:
+    return set(0, 100, 1);
+  case CONTROL_OFFSET:
+    return set(0, 255, 1);
+  case CONTROL_EXPOSURE:
+    return set(1, 3600e6, 1);
+  case CONTROL_USBTRAFFIC:
+    return set(0, 60, 1);
+  case CONTROL_MANULPWM:
+    return set(0, 255, 1);
+  case CONTROL_COOLER:
+    return set(-50, 50, 0.5);
+  case CONTROL_CFWPORT:
+    if (!cam->config.filter_slots)
+      return QHYCCD_ERROR;
+    return set('0', '0' + cam->config.filter_slots - 1, 1);
+  default:
+    return QHYCCD_ERROR;
+  }
+}
+
+uint32_t SetQHYCCDResolution(qhyccd_handle *handle, uint32_t x, uint32_t y,
+                             uint32_t xsize, uint32_t ysize) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  if (xsize == 0 || ysize == 0 || x >= cam->config.width / cam->bin ||
+      y >= cam->config.height / cam->bin)
+    return QHYCCD_ERROR;
+  cam->start_x = x;
+  cam->start_y = y;
+  cam->num_x = xsize;
+  cam->num_y = ysize;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t SetQHYCCDBinMode(qhyccd_handle *handle, uint32_t wbin, uint32_t hbin) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam || wbin != hbin || (wbin != 1 && wbin != 2 && wbin != 4))
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  cam->bin = wbin;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t SetQHYCCDBitsMode(qhyccd_handle *handle, uint32_t bits) {
+  return SetQHYCCDParam(handle, CONTROL_TRANSFERBIT, bits);
+}
+
+uint32_t GetQHYCCDMemLength(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return 0;
+  // The SDK always asks for a full 16 bit frame
+  return cam->config.width * cam->config.height * 2;
+}
+
+uint32_t ExpQHYCCDSingleFrame(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  if (!cam->initialized || cam->exposing || cam->stream_mode != 0)
+    return QHYCCD_ERROR;
+
+  cam->exposure_seconds = cam->params[CONTROL_EXPOSURE] / 1e6;
+  cam->exposure_start = stub_clock_t::now();
+  cam->exposure_end =
+      cam->exposure_start +
+      std::chrono::duration_cast<stub_clock_t::duration>(
+          std::chrono::duration<double>(cam->exposure_seconds));
+  cam->cancelled = false;
+  cam->exposing = true;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDSingleFrame(qhyccd_handle *handle, uint32_t *w, uint32_t *h,
+                              uint32_t *bpp, uint32_t *channels,
+                              uint8_t *imgdata) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+
+  // Like the SDK this blocks until the exposure is done, in small steps so
+  // a cancel or stop from another thread gets noticed
+  using namespace std::chrono_literals;
+  while (true) {
+    stub_clock_t::duration remaining;
+    {
+      std::lock_guard lock(cam->mtx);
+      if (!cam->exposing)
+        return QHYCCD_ERROR;
+      remaining = cam->exposure_end - stub_clock_t::now();
+    }
+    if (remaining <= 0s || cam->cancelled)
+      break;
+    std::this_thread::sleep_for(std::min<stub_clock_t::duration>(remaining, 10ms));
+  }
+
+  std::lock_guard lock(cam->mtx);
+  cam->exposing = false;
+  if (cam->cancelled)
+    return QHYCCD_ERROR;
+
+  auto readout_start = stub_clock_t::now();
+  uint32_t width = frame_width(*cam);
+  uint32_t height = frame_height(*cam);
+  uint32_t bits = cam->params[CONTROL_TRANSFERBIT] == 8 ? 8 : 16;
+
+  if (bits == 8)
+    render_frame(*cam, imgdata, width, height, 255);
+  else
+    render_frame(*cam, reinterpret_cast<uint16_t *>(imgdata), width, height,
+                 65535);
+  cam->frame_number++;
+
+  *w = width;
+  *h = height;
+  *bpp = bits;
+  *channels = 1;
+
+  // Rendering counts towards the readout time
+  std::this_thread::sleep_until(readout_start +
+                                std::chrono::milliseconds(cam->config.readout_ms));
+  return QHYCCD_SUCCESS;
+}
+
+// Stops the exposure early but the frame can still be read out
+uint32_t CancelQHYCCDExposing(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  auto now = stub_clock_t::now();
+  if (cam->exposing && now < cam->exposure_end) {
+    cam->exposure_end = now;
+    cam->exposure_seconds =
+        std::chrono::duration<double>(now - cam->exposure_start).count();
+  }
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t CancelQHYCCDExposingAndReadout(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  cam->cancelled = true;
+  std::lock_guard lock(cam->mtx);
+  cam->exposing = false;
+  return QHYCCD_SUCCESS;
+}
+
+namespace {
+
+// A new live frame every exposure, or every readout if that takes longer
+stub_clock_t::duration live_frame_period(const stub_camera_t &cam) {
+  double exposure = cam.params.at(CONTROL_EXPOSURE) / 1e6;
+  double roi_fraction = double(frame_width(cam)) * frame_height(cam) *
+                        cam.bin * cam.bin /
+                        (double(cam.config.width) * cam.config.height);
+  double readout = cam.config.readout_ms / 1000.0 * roi_fraction;
+  return std::chrono::duration_cast<stub_clock_t::duration>(
+      std::chrono::duration<double>(std::max(exposure, readout)));
+}
+
+} // namespace
+
+uint32_t BeginQHYCCDLive(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  if (!cam->initialized || cam->stream_mode != 1 || cam->live)
+    return QHYCCD_ERROR;
+  cam->live = true;
+  cam->next_live_frame = stub_clock_t::now() + live_frame_period(*cam);
+  return QHYCCD_SUCCESS;
+}
+
+// Never blocks, like the SDK it just fails if there's no new frame yet
+uint32_t GetQHYCCDLiveFrame(qhyccd_handle *handle, uint32_t *w, uint32_t *h,
+                            uint32_t *bpp, uint32_t *channels,
+                            uint8_t *imgdata) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  auto now = stub_clock_t::now();
+  if (!cam->live || now < cam->next_live_frame)
+    return QHYCCD_ERROR;
+
+  // Skip over any frames that came and went while nobody was reading
+  auto period = live_frame_period(*cam);
+  auto missed = (now - cam->next_live_frame) / period;
+  cam->frame_number += missed;
+  cam->next_live_frame += period * (missed + 1);
+
+  uint32_t width = frame_width(*cam);
+  uint32_t height = frame_height(*cam);
+  uint32_t bits = cam->params[CONTROL_TRANSFERBIT] == 8 ? 8 : 16;
+  cam->exposure_seconds = cam->params[CONTROL_EXPOSURE] / 1e6;
+  if (bits == 8)
+    render_frame(*cam, imgdata, width, height, 255);
+  else
+    render_frame(*cam, reinterpret_cast<uint16_t *>(imgdata), width, height,
+                 65535);
+  cam->frame_number++;
+
+  *w = width;
+  *h = height;
+  *bpp = bits;
+  *channels = 1;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t StopQHYCCDLive(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  cam->live = false;
+  return QHYCCD_SUCCESS;
+}
+
+double GetQHYCCDExposureRemaining(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return 0;
+  std::lock_guard lock(cam->mtx);
+  if (!cam->exposing)
+    return 0;
+  // Milliseconds, like the SDK
+  auto remaining = cam->exposure_end - stub_clock_t::now();
+  return std::max(
+      0.0, std::chrono::duration<double, std::milli>(remaining).count());
+}
+
+uint32_t GetQHYCCDChipInfo(qhyccd_handle *handle, double *chipw, double *chiph,
+                           uint32_t *imagew, uint32_t *imageh, double *pixelw,
+                           double *pixelh, uint32_t *bpp) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  *imagew = cam->config.width;
+  *imageh = cam->config.height;
+  *pixelw = cam->config.pixel_size_um;
+  *pixelh = cam->config.pixel_size_um;
+  *chipw = cam->config.width * cam->config.pixel_size_um / 1000;
+  *chiph = cam->config.height * cam->config.pixel_size_um / 1000;
+  *bpp = cam->params[CONTROL_TRANSFERBIT] == 8 ? 8 : 16;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDEffectiveArea(qhyccd_handle *handle, uint32_t *startX,
+                                uint32_t *startY, uint32_t *sizeX,
+                                uint32_t *sizeY) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  // No overscan on the stub sensor
+  *startX = 0;
+  *startY = 0;
+  *sizeX = cam->config.width;
+  *sizeY = cam->config.height;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDOverScanArea(qhyccd_handle *handle, uint32_t *startX,
+                               uint32_t *startY, uint32_t *sizeX,
+                               uint32_t *sizeY) {
+  sdk_call();
+  if (!camera_from_handle(handle))
+    return QHYCCD_ERROR;
+  *startX = 0;
+  *startY = 0;
+  *sizeX = 0;
+  *sizeY = 0;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDFWVersion(qhyccd_handle *handle, uint8_t *buf) {
+  sdk_call();
+  if (!camera_from_handle(handle))
+    return QHYCCD_ERROR;
+  // 2024-05-12 in the SDK's packed format
+  buf[0] = (0xe << 4) | 5;
+  buf[1] = 12;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDType(qhyccd_handle *handle) {
+  sdk_call();
+  return camera_from_handle(handle) ? 4000 : QHYCCD_ERROR;
+}
+
+uint32_t GetQHYCCDSensorName(qhyccd_handle *handle, char *name) {
+  sdk_call();
+  if (!camera_from_handle(handle))
+    return QHYCCD_ERROR;
+  copy_string(name, "STUB-SENSOR");
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDNumberOfReadModes(qhyccd_handle *handle, uint32_t *numModes) {
+  sdk_call();
+  if (!camera_from_handle(handle))
+    return QHYCCD_ERROR;
+  *numModes = read_mode_count;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDReadModeName(qhyccd_handle *handle, uint32_t modeNumber,
+                               char *name) {
+  sdk_call();
+  if (!camera_from_handle(handle) || modeNumber >= read_mode_count)
+    return QHYCCD_ERROR;
+  copy_string(name, read_mode_names[modeNumber]);
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t SetQHYCCDReadMode(qhyccd_handle *handle, uint32_t modeNumber) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam || modeNumber >= read_mode_count)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  cam->read_mode = modeNumber;
+  // The SDK wants InitQHYCCD again after a read mode change
+  cam->initialized = false;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t GetQHYCCDReadMode(qhyccd_handle *handle, uint32_t *modeNumber) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  *modeNumber = cam->read_mode;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t IsQHYCCDCFWPlugged(qhyccd_handle *handle) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  return (cam && cam->config.filter_slots) ? QHYCCD_SUCCESS : QHYCCD_ERROR;
+}
+
+uint32_t GetQHYCCDCFWStatus(qhyccd_handle *handle, char *status) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam || !cam->config.filter_slots)
+    return QHYCCD_ERROR;
+  std::lock_guard lock(cam->mtx);
+  // The real wheel reports 'N' while moving, the driver doesn't handle that
+  // yet so we keep reporting the old slot until it arrives
+  if (cam->filter_position != cam->filter_target &&
+      stub_clock_t::now() >= cam->filter_arrives)
+    cam->filter_position = cam->filter_target;
+  *status = '0' + cam->filter_position;
+  return QHYCCD_SUCCESS;
+}
+
+uint32_t SendOrder2QHYCCDCFW(qhyccd_handle *handle, char *order,
+                             uint32_t length) {
+  sdk_call();
+  auto cam = camera_from_handle(handle);
+  if (!cam || !cam->config.filter_slots || length < 1)
+    return QHYCCD_ERROR;
+  uint32_t target = order[0] - '0';
+  if (target >= cam->config.filter_slots)
+    return QHYCCD_ERROR;
+
+  std::lock_guard lock(cam->mtx);
+  uint32_t distance = target > cam->filter_position
+                          ? target - cam->filter_position
+                          : cam->filter_position - target;
+  cam->filter_target = target;
+  cam->filter_arrives = stub_clock_t::now() + std::chrono::milliseconds(300) * distance;
+  return QHYCCD_SUCCESS;
+}
+
+void EnableQHYCCDMessage(bool) {}
+
+// Nothing is ever hot plugged into the stub
+void RegisterPnpEventIn(void (*)(char *)) {}
+
+void RegisterPnpEventOut(void (*)(char *)) {}
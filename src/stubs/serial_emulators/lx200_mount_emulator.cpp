@@ -0,0 +1,395 @@
+#include "lx200_mount_emulator.hpp"
+#include "common/lx200_codec.hpp"
+#include "drivers/onstep_commands.hpp"
+#include "drivers/zwo_am5_commands.hpp"
+#include <cmath>
+#include <ctime>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+using lx200::reply_shape_enum;
+
+// Degrees or hours out of anything like +12*34:56, 12:34:56 or -074*00.
+// Stops at a '&' so the two halves of a :SMeq can be read one at a time.
+double sexagesimal(std::string_view text) {
+  double sign = 1;
+  size_t i = 0;
+  if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+    sign = text[0] == '-' ? -1 : 1;
+    i++;
+  }
+  double value = 0;
+  double scale = 1;
+  while (i < text.size() && text[i] != '&' && text[i] != '#' &&
+         scale >= 1 / 3600.0) {
+    if (text[i] < '0' || text[i] > '9') {
+      i++;
+      continue;
+    }
+    int field = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+      field = field * 10 + (text[i] - '0');
+    value += field * scale;
+    scale /= 60;
+  }
+  return sign * value;
+}
+
+std::string_view after_ampersand(std::string_view text) {
+  auto pos = text.find('&');
+  return pos == std::string_view::npos ? std::string_view()
+                                       : text.substr(pos + 1);
+}
+
+double normalize_hours(double hours) {
+  hours = std::fmod(hours, 24.0);
+  return hours < 0 ? hours + 24 : hours;
+}
+
+std::string hours_reply(double hours) {
+  return fmt::format("{}#", lx200::hh_mm_ss(normalize_hours(hours)));
+}
+
+std::string degrees_reply(double degrees) {
+  return fmt::format("{}#", lx200::sdd_mm_ss(degrees));
+}
+
+std::string longitude_reply(double degrees) {
+  lx200::sddd_mm_ss value(degrees);
+  return fmt::format("{}{:03d}*{:02d}:{:02d}#", value.plus_or_minus,
+                     value.ddd, value.mm, value.ss);
+}
+
+std::string azimuth_reply(double degrees) {
+  return fmt::format("{}#", lx200::ddd_mm_ss(degrees));
+}
+
+// Whatever a command of this shape says when all is well
+emulated_reply_t default_reply(const lx200::command_descriptor_t &descriptor) {
+  switch (descriptor.shape) {
+  case reply_shape_enum::none:
+    return {};
+  case reply_shape_enum::single_char:
+    return {"1"};
+  case reply_shape_enum::hash_terminated:
+    return {"0#"};
+  case reply_shape_enum::fixed_length:
+    return {std::string(descriptor.length, '0')};
+  case reply_shape_enum::zero_or_hash_terminated:
+    return {"0"};
+  }
+  return {};
+}
+
+} // namespace
+
+lx200_mount_emulator_t::lx200_mount_emulator_t(flavour_enum flavour)
+    : _flavour(flavour), _slew_time(2000), _motion(motion_enum::none),
+      _axes_moving(0), _tracking(false), _tracking_rate(0), _parked(false),
+      _at_home(true), _latitude(40), _longitude(74), _timezone("+00:00"),
+      _guide_rate("0.50") {
+  if (flavour == flavour_enum::am5)
+    _find = [](std::string_view command) {
+      return zwo_commands::find_descriptor(command);
+    };
+  else
+    _find = [](std::string_view command) {
+      return onstep_commands::find_descriptor(command);
+    };
+
+  // Powered up at home, on the pole with the counterweights down
+  _position.right_ascension = local_sidereal_time();
+  _position.declination = 90;
+  _target = _position;
+}
+
+std::string lx200_mount_emulator_t::name() const {
+  return _flavour == flavour_enum::am5 ? "AM5" : "OnStep";
+}
+
+size_t lx200_mount_emulator_t::command_length(std::string_view pending) {
+  auto end = pending.find('#');
+  return end == std::string_view::npos ? 0 : end + 1;
+}
+
+emulated_reply_t lx200_mount_emulator_t::respond(std::string_view command) {
+  update();
+  auto descriptor = _find(command);
+  if (!descriptor) {
+    // The real mounts don't answer what they don't know either
+    spdlog::debug("{} emulator ignoring unknown command {}", name(), command);
+    return {};
+  }
+  _counts[std::string(descriptor->family)]++;
+  return reply_for(*descriptor, command.substr(descriptor->prefix.size()));
+}
+
+void lx200_mount_emulator_t::set_slew_time(
+    std::chrono::milliseconds slew_time) {
+  _slew_time = slew_time;
+}
+
+astrometry::equatorial_t lx200_mount_emulator_t::position() {
+  update();
+  if (_motion == motion_enum::none)
+    return _position;
+
+  // Straight line from where it started, good enough to see it move
+  double done = std::chrono::duration<double>(emulator_clock_t::now() -
+                                              _motion_started) /
+                _slew_time;
+  astrometry::equatorial_t now;
+  now.right_ascension =
+      _motion_from.right_ascension +
+      (_position.right_ascension - _motion_from.right_ascension) * done;
+  now.declination = _motion_from.declination +
+                    (_position.declination - _motion_from.declination) * done;
+  return now;
+}
+
+bool lx200_mount_emulator_t::slewing() {
+  update();
+  return _motion != motion_enum::none || _axes_moving != 0;
+}
+
+bool lx200_mount_emulator_t::parked() {
+  update();
+  return _parked;
+}
+
+uint64_t lx200_mount_emulator_t::count(std::string_view family) const {
+  auto found = _counts.find(family);
+  return found == _counts.end() ? 0 : found->second;
+}
+
+void lx200_mount_emulator_t::update() {
+  if (_motion == motion_enum::none ||
+      emulator_clock_t::now() - _motion_started < _slew_time)
+    return;
+
+  if (_motion == motion_enum::home || _motion == motion_enum::park)
+    _at_home = true;
+  if (_motion == motion_enum::park) {
+    _parked = true;
+    _tracking = false;
+  }
+  _motion = motion_enum::none;
+}
+
+void lx200_mount_emulator_t::start_motion(motion_enum motion,
+                                          const astrometry::equatorial_t &to) {
+  _motion_from = position();
+  // _position is where it will end up, position() works out the way there
+  _position = to;
+  _motion = motion;
+  _motion_started = emulator_clock_t::now();
+  _at_home = false;
+}
+
+double lx200_mount_emulator_t::local_sidereal_time() const {
+  // astrometry has longitude east positive
+  return astrometry::local_sidereal_time(std::chrono::system_clock::now(),
+                                         -_longitude);
+}
+
+std::string lx200_mount_emulator_t::status() {
+  std::string flags;
+  if (!_tracking)
+    flags += 'n';
+  if (_at_home)
+    flags += 'H';
+  if (_parked)
+    flags += 'P';
+
+  if (_motion == motion_enum::home || _motion == motion_enum::park)
+    return flags + "2#";
+  if (_motion == motion_enum::slew || _axes_moving)
+    return flags + "4#";
+  return flags + "0#";
+}
+
+emulated_reply_t lx200_mount_emulator_t::reply_for(
+    const lx200::command_descriptor_t &descriptor,
+    std::string_view arguments) {
+  auto family = descriptor.family;
+  auto now = std::chrono::system_clock::to_time_t(
+      std::chrono::system_clock::now());
+  std::tm utc{};
+  ::gmtime_r(&now, &utc);
+
+  // Where it's pointing
+  if (family == "get_current_ra")
+    return {hours_reply(position().right_ascension)};
+  if (family == "get_current_dec")
+    return {degrees_reply(position().declination)};
+  if (family == "get_current_ra_and_dec") {
+    auto current = position();
+    auto ra = hours_reply(current.right_ascension);
+    ra.back() = '&';
+    return {ra + degrees_reply(current.declination)};
+  }
+  if (family == "get_status")
+    return {status()};
+  if (family == "get_azimuth" || family == "get_altitude" ||
+      family == "get_az_and_alt" ||
+      family == "get_current_cardinal_direction") {
+    astrometry::site_t site;
+    site.latitude = _latitude;
+    site.longitude = -_longitude;
+    auto lst = local_sidereal_time();
+    auto horizontal = astrometry::to_horizontal(position(), lst, site);
+    if (family == "get_azimuth")
+      return {azimuth_reply(horizontal.azimuth)};
+    if (family == "get_altitude")
+      return {degrees_reply(horizontal.altitude)};
+    if (family == "get_az_and_alt") {
+      auto az = azimuth_reply(horizontal.azimuth);
+      az.back() = '&';
+      return {az + degrees_reply(horizontal.altitude)};
+    }
+    return {astrometry::hour_angle(lst, position().right_ascension) < 0
+                ? "E#"
+                : "W#"};
+  }
+
+  // Targets and gotos
+  if (family == "get_target_ra")
+    return {hours_reply(_target.right_ascension)};
+  if (family == "get_target_dec")
+    return {degrees_reply(_target.declination)};
+  if (family == "get_target_ra_and_dec") {
+    auto ra = hours_reply(_target.right_ascension);
+    ra.back() = '&';
+    return {ra + degrees_reply(_target.declination)};
+  }
+  if (family == "set_target_ra") {
+    _target.right_ascension = sexagesimal(arguments);
+    return {"1"};
+  }
+  if (family == "set_target_dec") {
+    _target.declination = sexagesimal(arguments);
+    return {"1"};
+  }
+  if (family == "set_target_ra_and_dec_and_goto" ||
+      family == "set_target_ra_and_dec_and_sync") {
+    _target.right_ascension = sexagesimal(arguments);
+    _target.declination = sexagesimal(after_ampersand(arguments));
+  }
+  if (family == "goto" || family == "set_target_ra_and_dec_and_goto") {
+    if (_parked)
+      return {_flavour == flavour_enum::am5 ? "e4#" : "4"};
+    start_motion(motion_enum::slew, _target);
+    return {"0"};
+  }
+  if (family == "sync" || family == "set_target_ra_and_dec_and_sync") {
+    _motion = motion_enum::none;
+    _position = _target;
+    return {"N/A#"};
+  }
+  if (family == "stop_moving") {
+    if (_motion != motion_enum::none)
+      _position = position();
+    _motion = motion_enum::none;
+    _axes_moving = 0;
+    return {};
+  }
+  if (family == "home_position" || family == "park") {
+    astrometry::equatorial_t home;
+    home.right_ascension = local_sidereal_time();
+    home.declination = 90;
+    start_motion(family == "park" ? motion_enum::park : motion_enum::home,
+                 home);
+    return default_reply(descriptor);
+  }
+  if (family == "restore_parked_telescope") {
+    _parked = false;
+    return {"0"};
+  }
+  if (lx200::starts_with(family, "move_towards_") ||
+      lx200::starts_with(family, "stop_moving_towards_")) {
+    // One bit per direction, the family ends in _east, _west and so on
+    auto direction = family[family.rfind('_') + 1];
+    int axis = 1 << std::string_view("ewns").find(direction);
+    if (family[0] == 'm') {
+      _axes_moving |= axis;
+      _at_home = false;
+    } else {
+      _axes_moving &= ~axis;
+    }
+    return {};
+  }
+
+  // Tracking
+  if (family == "start_tracking" || family == "stop_tracking") {
+    _tracking = family == "start_tracking";
+    return {"1"};
+  }
+  if (family == "get_tracking_status")
+    return {_tracking ? "1#" : "0#"};
+  if (family == "get_tracking_rate")
+    return {fmt::format("{}#", _tracking_rate)};
+  if (family == "set_tracking_rate_to_sidereal")
+    _tracking_rate = 0;
+  if (family == "set_tracking_rate_to_lunar")
+    _tracking_rate = 1;
+  if (family == "set_tracking_rate_to_solar")
+    _tracking_rate = 2;
+  if (family == "set_tracking_rate_to_king")
+    _tracking_rate = 3;
+  if (family == "get_guide_rate")
+    return {_guide_rate + "#"};
+  if (family == "set_guide_rate") {
+    _guide_rate = std::string(arguments.substr(0, arguments.find('#')));
+    return {};
+  }
+
+  // Site, date and time. The clock always follows the host's, setting it is
+  // accepted and forgotten.
+  if (family == "get_latitude")
+    return {degrees_reply(_latitude)};
+  if (family == "get_longitude")
+    return {longitude_reply(_longitude)};
+  if (family == "get_lat_and_long") {
+    auto latitude = degrees_reply(_latitude);
+    latitude.back() = '&';
+    return {latitude + longitude_reply(_longitude)};
+  }
+  if (family == "set_latitude") {
+    _latitude = sexagesimal(arguments);
+    return {"1"};
+  }
+  if (family == "set_longitude") {
+    _longitude = sexagesimal(arguments);
+    return {"1"};
+  }
+  if (family == "set_lat_and_long") {
+    _latitude = sexagesimal(arguments);
+    _longitude = sexagesimal(after_ampersand(arguments));
+    return {"1"};
+  }
+  if (family == "get_sidereal_time")
+    return {hours_reply(local_sidereal_time())};
+  if (family == "get_date")
+    return {fmt::format("{:02d}/{:02d}/{:02d}#", utc.tm_mon + 1, utc.tm_mday,
+                        utc.tm_year % 100)};
+  if (family == "get_time")
+    return {fmt::format("{:02d}:{:02d}:{:02d}#", utc.tm_hour, utc.tm_min,
+                        utc.tm_sec)};
+  if (family == "get_date_and_time_and_tz")
+    return {fmt::format("{:02d}/{:02d}/{:02d}&{:02d}:{:02d}:{:02d}&{}#",
+                        utc.tm_mon + 1, utc.tm_mday, utc.tm_year % 100,
+                        utc.tm_hour, utc.tm_min, utc.tm_sec, _timezone)};
+  if (family == "get_timezone")
+    return {_timezone + "#"};
+  if (family == "set_timezone") {
+    _timezone = std::string(arguments.substr(0, arguments.find('#')));
+    return {"1"};
+  }
+
+  if (family == "get_version")
+    return {_flavour == flavour_enum::am5 ? "1.0.0#" : "On-Step#"};
+  if (family == "get_serial_number")
+    return {"EMULATOR#"};
+  return default_reply(descriptor);
+}
@@ -0,0 +1,79 @@
+#ifndef LX200_MOUNT_EMULATOR_HPP
+#define LX200_MOUNT_EMULATOR_HPP
+
+#include "common/astrometry.hpp"
+#include "common/lx200_protocol.hpp"
+#include "serial_emulator.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+// An AM5 or OnStep mount at the end of the LX200 '#' protocol. What each
+// command replies comes from the same descriptor tables the drivers use, so
+// the emulator and the drivers can't disagree about where a reply ends. The
+// replies themselves are the ones the drivers were written against, which
+// for a few OnStep commands isn't quite what its docs say.
+//
+// Gotos, homing and parking take slew_time however far they go and report
+// themselves in :GU# the way the drivers look for (a trailing 4 while
+// slewing, 2 while homing or parking, H once home). Everything else just
+// remembers what it was set to.
+class lx200_mount_emulator_t : public emulated_firmware_t {
+public:
+  enum class flavour_enum { am5, onstep };
+
+  explicit lx200_mount_emulator_t(flavour_enum flavour);
+
+  std::string name() const override;
+  size_t command_length(std::string_view pending) override;
+  emulated_reply_t respond(std::string_view command) override;
+
+  void set_slew_time(std::chrono::milliseconds slew_time);
+  astrometry::equatorial_t position();
+  bool slewing();
+  bool tracking() const { return _tracking; }
+  bool parked();
+  // How many commands of a family, e.g. "get_status", have come in
+  uint64_t count(std::string_view family) const;
+
+private:
+  enum class motion_enum { none, slew, home, park };
+  using emulator_clock_t = std::chrono::steady_clock;
+
+  // Finishes a motion once its time is up
+  void update();
+  void start_motion(motion_enum motion, const astrometry::equatorial_t &to);
+  double local_sidereal_time() const;
+  std::string status();
+  emulated_reply_t reply_for(const lx200::command_descriptor_t &descriptor,
+                             std::string_view arguments);
+
+  flavour_enum _flavour;
+  std::function<const lx200::command_descriptor_t *(std::string_view)> _find;
+  std::chrono::milliseconds _slew_time;
+
+  astrometry::equatorial_t _position;
+  astrometry::equatorial_t _target;
+  astrometry::equatorial_t _motion_from;
+  motion_enum _motion;
+  emulator_clock_t::time_point _motion_started;
+  // :Me# and friends, the mount is moving until they're stopped
+  int _axes_moving;
+
+  bool _tracking;
+  int _tracking_rate;
+  bool _parked;
+  bool _at_home;
+  // As LX200 has them, longitude west positive
+  double _latitude;
+  double _longitude;
+  std::string _timezone;
+  std::string _guide_rate;
+
+  std::map<std::string, uint64_t, std::less<>> _counts;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "pegasus_emulator.hpp"
+#include "common/lx200_protocol.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fmt/format.h>
+
+namespace {
+
+size_t line_length(std::string_view pending) {
+  auto end = pending.find('\n');
+  return end == std::string_view::npos ? 0 : end + 1;
+}
+
+// The command without its line ending
+std::string_view strip_line(std::string_view command) {
+  while (!command.empty() && (command.back() == '\n' || command.back() == '\r'))
+    command.remove_suffix(1);
+  return command;
+}
+
+// The number after the first ':', e.g. 255 from P3:255
+int argument(std::string_view command) {
+  auto colon = command.find(':');
+  if (colon == std::string_view::npos)
+    return 0;
+  return std::atoi(std::string(command.substr(colon + 1)).c_str());
+}
+
+} // namespace
+
+ppba_emulator_t::ppba_emulator_t()
+    : _powered_up(std::chrono::steady_clock::now()), _voltage(12.2),
+      _temperature(18.5), _humidity(45), _quadport_on(true),
+      _adj_power_on(true), _adj_power_voltage(12), _dew_a_pwm(0),
+      _dew_b_pwm(0), _autodew(false), _dew_aggressiveness(210),
+      _usb_hub_on(true) {}
+
+// The 12V outputs draw 0.8A when on and each dew heater up to 1A
+double ppba_emulator_t::amps() const {
+  return (_quadport_on ? 0.8 : 0) + (_dew_a_pwm + _dew_b_pwm) / 255.0;
+}
+
+size_t ppba_emulator_t::command_length(std::string_view pending) {
+  return line_length(pending);
+}
+
+emulated_reply_t ppba_emulator_t::respond(std::string_view command) {
+  command = strip_line(command);
+  using lx200::starts_with;
+
+  if (command == "P#")
+    return {"PPBA_OK\n"};
+  if (command == "PV")
+    return {"2.1\n"};
+  if (command == "PA") {
+    // Magnus formula, close enough for a dew point
+    double gamma = std::log(_humidity / 100.0) +
+                   17.62 * _temperature / (243.12 + _temperature);
+    double dew_point = 243.12 * gamma / (17.62 - gamma);
+    return {fmt::format(
+        "PPBA:{:.1f}:{:.0f}:{:.1f}:{}:{:.1f}:{}:{}:{}:{}:{}:0:{}\n", _voltage,
+        amps() * 65, _temperature, _humidity, dew_point, int(_quadport_on),
+        int(_adj_power_on), _dew_a_pwm, _dew_b_pwm, int(_autodew),
+        _adj_power_voltage)};
+  }
+  if (command == "PC") {
+    double quad = _quadport_on ? 0.8 : 0;
+    double dew_a = _dew_a_pwm / 255.0;
+    double dew_b = _dew_b_pwm / 255.0;
+    auto uptime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - _powered_up);
+    return {fmt::format("PC:{:.2f}:{:.2f}:{:.2f}:{:.2f}:{}\n", amps(), quad,
+                        dew_a, dew_b, uptime.count())};
+  }
+  if (command == "PS") {
+    return {fmt::format("PS:{:.2f}:{:.2f}:{:.1f}:0\n", amps(), amps() * 3600,
+                        amps() * _voltage)};
+  }
+  if (command == "DA")
+    return {fmt::format("DA:{}\n", _dew_aggressiveness)};
+
+  // The rest set something and echo the command back
+  if (starts_with(command, "P1:"))
+    _quadport_on = argument(command) != 0;
+  else if (starts_with(command, "P2:")) {
+    auto value = argument(command);
+    _adj_power_on = value != 0;
+    if (value > 1)
+      _adj_power_voltage = value;
+  } else if (starts_with(command, "P3:"))
+    _dew_a_pwm = argument(command);
+  else if (starts_with(command, "P4:"))
+    _dew_b_pwm = argument(command);
+  else if (starts_with(command, "PD:"))
+    _autodew = argument(command) != 0;
+  else if (starts_with(command, "DA:"))
+    _dew_aggressiveness = argument(command);
+  else if (starts_with(command, "PU:"))
+    _usb_hub_on = argument(command) != 0;
+  else
+    return {"ERR\n"};
+  return {fmt::format("{}\n", command)};
+}
+
+focuscube3_emulator_t::focuscube3_emulator_t()
+    : _steps_per_second(2000), _move_from(25000), _move_to(25000),
+      _temperature(18.5), _backlash(0) {}
+
+size_t focuscube3_emulator_t::command_length(std::string_view pending) {
+  return line_length(pending);
+}
+
+void focuscube3_emulator_t::set_steps_per_second(double steps_per_second) {
+  _move_from = position();
+  _move_started = emulator_clock_t::now();
+  _steps_per_second = steps_per_second;
+}
+
+int focuscube3_emulator_t::position() {
+  double elapsed = std::chrono::duration<double>(emulator_clock_t::now() -
+                                                 _move_started)
+                       .count();
+  double travelled = std::min<double>(elapsed * _steps_per_second,
+                                      std::abs(_move_to - _move_from));
+  return _move_from + (_move_to > _move_from ? 1 : -1) * int(travelled);
+}
+
+bool focuscube3_emulator_t::moving() { return position() != _move_to; }
+
+emulated_reply_t focuscube3_emulator_t::respond(std::string_view command) {
+  command = strip_line(command);
+  using lx200::starts_with;
+
+  if (command == "##")
+    return {"FC3_OK\n"};
+  if (command == "FV")
+    return {"FV:1.0\n"};
+  if (command == "FA")
+    return {fmt::format("FC3:{}:{}:{:.1f}:0:{}\n", position(), int(moving()),
+                        _temperature, _backlash)};
+  if (starts_with(command, "FM:")) {
+    _move_from = position();
+    _move_to = argument(command);
+    _move_started = emulator_clock_t::now();
+    return {fmt::format("{}\n", command)};
+  }
+  // The driver doesn't wait for an answer to a halt, so there isn't one
+  if (command == "FH") {
+    _move_from = _move_to = position();
+    return {};
+  }
+  if (starts_with(command, "FB:")) {
+    _backlash = argument(command);
+    return {fmt::format("{}\n", command)};
+  }
+  return {"ERR\n"};
+}
@@ -0,0 +1,69 @@
+#ifndef PEGASUS_EMULATOR_HPP
+#define PEGASUS_EMULATOR_HPP
+
+#include "serial_emulator.hpp"
+#include <chrono>
+#include <string>
+#include <string_view>
+
+// Pegasus Astro's protocol is a line per command and a line back, the set
+// commands echo themselves.
+
+// Pocket Power Box Advanced. Holds what the P1..P4 / PD / PU commands set and
+// reports it back through PA / PC / PS / DA with made up but plausible
+// readings for the rest.
+class ppba_emulator_t : public emulated_firmware_t {
+public:
+  ppba_emulator_t();
+
+  std::string name() const override { return "PPBA"; }
+  size_t command_length(std::string_view pending) override;
+  emulated_reply_t respond(std::string_view command) override;
+
+  bool quadport_on() const { return _quadport_on; }
+  int dew_a_pwm() const { return _dew_a_pwm; }
+  int dew_b_pwm() const { return _dew_b_pwm; }
+
+private:
+  double amps() const;
+
+  std::chrono::steady_clock::time_point _powered_up;
+  double _voltage;
+  double _temperature;
+  int _humidity;
+  bool _quadport_on;
+  bool _adj_power_on;
+  int _adj_power_voltage;
+  int _dew_a_pwm;
+  int _dew_b_pwm;
+  bool _autodew;
+  int _dew_aggressiveness;
+  bool _usb_hub_on;
+};
+
+// FocusCube3. Moves at steps_per_second towards wherever FM last sent it, FA
+// reports where it has got to.
+class focuscube3_emulator_t : public emulated_firmware_t {
+public:
+  focuscube3_emulator_t();
+
+  std::string name() const override { return "FocusCube3"; }
+  size_t command_length(std::string_view pending) override;
+  emulated_reply_t respond(std::string_view command) override;
+
+  void set_steps_per_second(double steps_per_second);
+  int position();
+  bool moving();
+
+private:
+  using emulator_clock_t = std::chrono::steady_clock;
+
+  double _steps_per_second;
+  int _move_from;
+  int _move_to;
+  emulator_clock_t::time_point _move_started;
+  double _temperature;
+  int _backlash;
+};
+
+#endif
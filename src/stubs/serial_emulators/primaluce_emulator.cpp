@@ -0,0 +1,207 @@
+#include "primaluce_emulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+double esatto_emulator_t::axis_t::position() const {
+  double elapsed =
+      std::chrono::duration<double>(emulator_clock_t::now() - started).count();
+  double travelled = std::min(elapsed * per_second, std::abs(to - from));
+  return from + (to > from ? travelled : -travelled);
+}
+
+void esatto_emulator_t::axis_t::move_to(double target) {
+  from = position();
+  to = target;
+  started = emulator_clock_t::now();
+}
+
+void esatto_emulator_t::axis_t::stop() { from = to = position(); }
+
+esatto_emulator_t::esatto_emulator_t(bool arco) : _rotator_steps(100) {
+  _focuser.per_second = 2000;
+  _focuser.from = _focuser.to = 30000;
+  _rotator.per_second = 10;
+
+  _state = {{"MODNAME", "ESATTO3"},
+            {"SN", "EMULATOR"},
+            {"SWVERS", {{"SWAPP", "3.10"}, {"SWWEB", "3.10"}}},
+            {"EXT_T", "18.5"},
+            {"VIN_12V", "12.10"},
+            {"VIN_USB", "5.02"},
+            {"DIMLEDS", "on"},
+            {"ARCO", arco ? 1 : 0},
+            {"MOT1",
+             {{"BKLASH", 0},
+              {"SPEED", 500},
+              {"COMPENSATION_POS_STEP", 0},
+              {"HEMISPHERE", "northern"}}}};
+  if (arco)
+    _state["MOT2"] = {{"REVERSE", 0},
+                      {"HEMISPHERE", "northern"},
+                      {"COMPENSATION_POS_STEP", 0},
+                      {"COMPENSATION_POS_DEG", 0.0},
+                      {"COMPENSATION_POS_ARCSEC", 0}};
+  update();
+}
+
+// A request is one JSON object, counting braces is enough to find its end.
+// Anything in front of the '{' is junk, e.g. a stray newline.
+size_t esatto_emulator_t::command_length(std::string_view pending) {
+  if (pending.empty())
+    return 0;
+  if (pending[0] != '{')
+    return 1;
+
+  int depth = 0;
+  bool quoted = false;
+  for (size_t i = 0; i < pending.size(); i++) {
+    char c = pending[i];
+    if (quoted) {
+      if (c == '\\')
+        i++;
+      else if (c == '"')
+        quoted = false;
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == '{') {
+      depth++;
+    } else if (c == '}' && --depth == 0) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+void esatto_emulator_t::set_speeds(double steps_per_second,
+                                   double degrees_per_second) {
+  _focuser.move_to(_focuser.to);
+  _rotator.move_to(_rotator.to);
+  _focuser.per_second = steps_per_second;
+  _rotator.per_second = degrees_per_second;
+}
+
+double esatto_emulator_t::focuser_position() { return _focuser.position(); }
+
+double esatto_emulator_t::rotator_position() { return _rotator.position(); }
+
+void esatto_emulator_t::update() {
+  auto &mot1 = _state["MOT1"];
+  int step = std::lround(_focuser.position());
+  int compensation = mot1["COMPENSATION_POS_STEP"];
+  mot1["ABS_POS_STEP"] = step;
+  mot1["POSITION_STEP"] = step;
+  mot1["POSITION"] = step + compensation;
+  mot1["STATUS"] = {{"MST", _focuser.moving() ? "run" : "stop"}};
+
+  if (!_state.contains("MOT2"))
+    return;
+  auto &mot2 = _state["MOT2"];
+  double degrees = _rotator.position();
+  double offset = mot2["COMPENSATION_POS_DEG"];
+  double position = std::fmod(degrees + offset + 360, 360);
+  mot2["ABS_POS_DEG"] = degrees;
+  mot2["ABS_POS_ARCSEC"] = std::lround(degrees * 3600);
+  mot2["ABS_POS_STEP"] = std::lround(degrees * _rotator_steps);
+  mot2["POSITION_DEG"] = position;
+  mot2["POSITION_ARCSEC"] = std::lround(position * 3600);
+  mot2["POSITION_STEP"] = std::lround(position * _rotator_steps);
+  mot2["POSITION"] = mot2["POSITION_STEP"];
+  mot2["COMPENSATION_POS_ARCSEC"] = std::lround(offset * 3600);
+  mot2["COMPENSATION_POS_STEP"] = std::lround(offset * _rotator_steps);
+  mot2["STATUS"] = {{"MST", _rotator.moving() ? "run" : "stop"}};
+}
+
+// Mirrors the request with the values filled in, a "" asks for everything
+// under that key
+nlohmann::json esatto_emulator_t::get(const nlohmann::json &request,
+                                      const nlohmann::json &state) {
+  if (!request.is_object())
+    return state;
+  nlohmann::json result = nlohmann::json::object();
+  for (auto &[key, value] : request.items()) {
+    if (!state.contains(key))
+      result[key] = "error: unknown key";
+    else
+      result[key] = get(value, state[key]);
+  }
+  return result;
+}
+
+void esatto_emulator_t::command_motor(const std::string &motor,
+                                      const std::string &command,
+                                      const nlohmann::json &arguments) {
+  bool focuser = motor == "MOT1";
+  if (!focuser && !_state.contains("MOT2"))
+    return;
+  auto &axis = focuser ? _focuser : _rotator;
+  if (command == "MOT_ABORT" || command == "MOT_STOP") {
+    axis.stop();
+    return;
+  }
+  if (!arguments.is_object() || arguments.empty())
+    return;
+
+  // Everything is kept in focuser steps or rotator degrees
+  auto unit = arguments.begin().key();
+  double value = arguments.begin().value();
+  if (!focuser && unit == "ARCSEC")
+    value /= 3600;
+  else if (!focuser && unit == "STEP")
+    value /= _rotator_steps;
+
+  auto &compensation = _state[motor][focuser ? "COMPENSATION_POS_STEP"
+                                             : "COMPENSATION_POS_DEG"];
+  double offset = compensation;
+  if (command == "MOVE_ABS" || command == "VERBOSE_MOVE_ABS")
+    axis.move_to(value);
+  else if (command == "MOVE" || command == "VERBOSE_MOVE")
+    axis.move_to(axis.to + value);
+  else if (command == "GOTO")
+    axis.move_to(value - offset);
+  else if (command == "SYNC_POS")
+    compensation = value - axis.position();
+}
+
+emulated_reply_t esatto_emulator_t::respond(std::string_view command) {
+  nlohmann::json request;
+  try {
+    request = nlohmann::json::parse(command).at("req");
+  } catch (std::exception &ex) {
+    spdlog::debug("Esatto emulator couldn't parse {}: {}", command, ex.what());
+    return {};
+  }
+  update();
+
+  nlohmann::json res = nlohmann::json::object();
+  for (auto &[verb, body] : request.items()) {
+    if (verb == "get") {
+      res["get"] = get(body, _state);
+    } else if (verb == "set" && body.is_object()) {
+      res["set"] = nlohmann::json::object();
+      for (auto &[key, value] : body.items()) {
+        if (value.is_object()) {
+          for (auto &[param, param_value] : value.items()) {
+            _state[key][param] = param_value;
+            res["set"][key][param] = "done";
+          }
+        } else {
+          _state[key] = value;
+          res["set"][key] = "done";
+        }
+      }
+    } else if (verb == "cmd" && body.is_object()) {
+      res["cmd"] = nlohmann::json::object();
+      for (auto &[motor, commands] : body.items()) {
+        if (!commands.is_object())
+          continue;
+        for (auto &[name, arguments] : commands.items()) {
+          command_motor(motor, name, arguments);
+          res["cmd"][motor][name] = "done";
+        }
+      }
+    }
+  }
+  update();
+  return {nlohmann::json{{"res", res}}.dump() + "\n"};
+}
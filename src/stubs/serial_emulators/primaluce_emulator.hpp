@@ -0,0 +1,57 @@
+#ifndef PRIMALUCE_EMULATOR_HPP
+#define PRIMALUCE_EMULATOR_HPP
+
+#include "serial_emulator.hpp"
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+
+// An Esatto focuser, with an ARCO rotator on MOT2 if asked for. PrimaLuce's
+// protocol is a JSON object each way, {"req":{"get":{...}}} in and
+// {"res":{"get":{...}}} back. Gets and sets are answered out of one tree of
+// everything the focuser knows, which is also what a bare "get" returns, and
+// the MOVE / MOVE_ABS / SYNC_POS / abort commands drive the two motors.
+class esatto_emulator_t : public emulated_firmware_t {
+public:
+  explicit esatto_emulator_t(bool arco);
+
+  std::string name() const override { return "Esatto"; }
+  size_t command_length(std::string_view pending) override;
+  emulated_reply_t respond(std::string_view command) override;
+
+  // Focuser steps and rotator degrees per second
+  void set_speeds(double steps_per_second, double degrees_per_second);
+  double focuser_position();
+  double rotator_position();
+
+private:
+  using emulator_clock_t = std::chrono::steady_clock;
+
+  struct axis_t {
+    double from = 0;
+    double to = 0;
+    double per_second = 0;
+    emulator_clock_t::time_point started;
+
+    double position() const;
+    bool moving() const { return position() != to; }
+    void move_to(double target);
+    void stop();
+  };
+
+  // Writes where the motors have got to into _state
+  void update();
+  void command_motor(const std::string &motor, const std::string &command,
+                     const nlohmann::json &arguments);
+  nlohmann::json get(const nlohmann::json &request,
+                     const nlohmann::json &state);
+
+  nlohmann::json _state;
+  axis_t _focuser;
+  axis_t _rotator;
+  // Rotator steps per degree
+  double _rotator_steps;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "qhy_cfw_emulator.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+qhy_cfw_emulator_t::qhy_cfw_emulator_t(int filters)
+    : _filters(filters), _position(0), _moves(0), _time_per_slot(100) {}
+
+size_t qhy_cfw_emulator_t::command_length(std::string_view pending) {
+  if (pending.empty())
+    return 0;
+  if (pending[0] >= 'A' && pending[0] <= 'Z')
+    return pending.size() >= 3 ? 3 : 0;
+  // A move, or junk that goes the same way
+  return 1;
+}
+
+void qhy_cfw_emulator_t::set_time_per_slot(
+    std::chrono::milliseconds time_per_slot) {
+  _time_per_slot = time_per_slot;
+}
+
+emulated_reply_t qhy_cfw_emulator_t::respond(std::string_view command) {
+  if (command == "VRS")
+    return {"20240101"};
+  if (command == "MXP")
+    return {std::string(1, '0' + _filters)};
+  if (command == "NOW")
+    return {std::string(1, '0' + _position)};
+
+  int target = command[0] - '0';
+  if (command.size() != 1 || target < 0 || target >= _filters)
+    return {};
+
+  // It goes round the short way
+  int slots = std::abs(target - _position);
+  slots = std::min(slots, _filters - slots);
+  _position = target;
+  _moves++;
+  return {std::string(1, command[0]), _time_per_slot * slots};
+}
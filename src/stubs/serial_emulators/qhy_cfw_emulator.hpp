@@ -0,0 +1,32 @@
+#ifndef QHY_CFW_EMULATOR_HPP
+#define QHY_CFW_EMULATOR_HPP
+
+#include "serial_emulator.hpp"
+#include <chrono>
+#include <string>
+#include <string_view>
+
+// The standalone QHY colour filter wheel. Three letter queries (VRS, MXP,
+// NOW) with fixed length replies and a bare digit to move, which is only
+// answered once the wheel has got there.
+class qhy_cfw_emulator_t : public emulated_firmware_t {
+public:
+  explicit qhy_cfw_emulator_t(int filters = 7);
+
+  std::string name() const override { return "QHY CFW"; }
+  size_t command_length(std::string_view pending) override;
+  emulated_reply_t respond(std::string_view command) override;
+
+  // How long the wheel takes to go one position
+  void set_time_per_slot(std::chrono::milliseconds time_per_slot);
+  int position() const { return _position; }
+  int moves() const { return _moves; }
+
+private:
+  int _filters;
+  int _position;
+  int _moves;
+  std::chrono::milliseconds _time_per_slot;
+};
+
+#endif
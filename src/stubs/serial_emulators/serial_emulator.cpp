@@ -0,0 +1,188 @@
+#include "serial_emulator.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <stdlib.h>
+#include <system_error>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+[[noreturn]] void throw_errno(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+} // namespace
+
+serial_emulator_t::serial_emulator_t(
+    std::unique_ptr<emulated_firmware_t> firmware, emulator_link_config_t link)
+    : _firmware(std::move(firmware)), _name(_firmware->name()), _master(-1),
+      _slave(-1), _link(link), _rng(link.seed), _running(true) {
+  _master = ::posix_openpt(O_RDWR | O_NOCTTY);
+  if (_master < 0)
+    throw_errno("posix_openpt");
+  char path[64];
+  if (::grantpt(_master) != 0 || ::unlockpt(_master) != 0 ||
+      ::ptsname_r(_master, path, sizeof(path)) != 0) {
+    ::close(_master);
+    throw_errno("setting up the pseudo terminal");
+  }
+  _device_path = path;
+
+  // Raw from the start, otherwise anything the firmware sends before the
+  // driver opens the port gets echoed back to it
+  _slave = ::open(path, O_RDWR | O_NOCTTY);
+  if (_slave < 0) {
+    ::close(_master);
+    throw_errno(fmt::format("opening {}", _device_path));
+  }
+  termios tio;
+  ::tcgetattr(_slave, &tio);
+  ::cfmakeraw(&tio);
+  ::tcsetattr(_slave, TCSANOW, &tio);
+
+  spdlog::debug("{} emulator listening on {}", _name, _device_path);
+  _emulator_thread = std::thread(&serial_emulator_t::emulator_proc, this);
+}
+
+serial_emulator_t::~serial_emulator_t() { stop(); }
+
+void serial_emulator_t::configure(const emulator_link_config_t &link) {
+  std::lock_guard lock(_emulator_mtx);
+  _link = link;
+  _rng.seed(link.seed);
+}
+
+emulator_link_config_t serial_emulator_t::link_config() {
+  std::lock_guard lock(_emulator_mtx);
+  return _link;
+}
+
+emulator_stats_t serial_emulator_t::stats() {
+  std::lock_guard lock(_emulator_mtx);
+  return _stats;
+}
+
+std::map<std::string, double> serial_emulator_t::summary() {
+  auto current = stats();
+  std::map<std::string, double> result;
+  result["commands"] = current.commands;
+  result["replies"] = current.replies;
+  result["dropped"] = current.dropped;
+  result["bytes_in"] = current.bytes_in;
+  result["bytes_out"] = current.bytes_out;
+  return result;
+}
+
+void serial_emulator_t::stop() {
+  {
+    std::lock_guard lock(_emulator_mtx);
+    if (!_running && !_emulator_thread.joinable())
+      return;
+    _running = false;
+  }
+  _emulator_cv.notify_all();
+  if (_emulator_thread.joinable())
+    _emulator_thread.join();
+  if (_slave >= 0)
+    ::close(_slave);
+  if (_master >= 0)
+    ::close(_master);
+  _slave = _master = -1;
+}
+
+bool serial_emulator_t::wait(std::chrono::microseconds delay) {
+  std::unique_lock lock(_emulator_mtx);
+  if (delay.count() > 0)
+    _emulator_cv.wait_for(lock, delay, [this]() { return !_running; });
+  return _running;
+}
+
+void serial_emulator_t::write_reply(const std::string &bytes,
+                                    std::chrono::microseconds byte_time) {
+  size_t sent = 0;
+  while (sent < bytes.size() && _running) {
+    // A byte at a time like a UART when the link is paced, otherwise all of
+    // it in one go
+    size_t chunk = byte_time.count() > 0 ? 1 : bytes.size() - sent;
+    if (byte_time.count() > 0 && !wait(byte_time))
+      return;
+    auto n = ::write(_master, bytes.data() + sent, chunk);
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+      spdlog::warn("{} emulator couldn't write its reply: {}", _name,
+                   std::strerror(errno));
+      return;
+    }
+    sent += n;
+  }
+  std::lock_guard lock(_emulator_mtx);
+  _stats.bytes_out += sent;
+}
+
+void serial_emulator_t::emulator_proc() {
+  std::string pending;
+  char buf[256];
+
+  while (_running) {
+    pollfd pfd{_master, POLLIN, 0};
+    // Short enough that stop() doesn't have to wait around
+    if (::poll(&pfd, 1, 50) <= 0 || !(pfd.revents & POLLIN))
+      continue;
+    auto n = ::read(_master, buf, sizeof(buf));
+    if (n <= 0)
+      continue;
+    pending.append(buf, n);
+
+    while (_running) {
+      std::string command;
+      emulated_reply_t reply;
+      {
+        std::lock_guard lock(_firmware_mtx);
+        auto length = _firmware->command_length(pending);
+        if (length == 0)
+          break;
+        command = pending.substr(0, length);
+        pending.erase(0, length);
+        reply = _firmware->respond(command);
+      }
+
+      emulator_link_config_t link;
+      bool dropped = false;
+      std::chrono::microseconds delay(0);
+      {
+        std::lock_guard lock(_emulator_mtx);
+        link = _link;
+        _stats.commands++;
+        _stats.bytes_in += command.size();
+        if (reply.bytes.empty())
+          continue;
+
+        // The command had to get here first
+        delay = link.byte_time * command.size() + link.reply_latency +
+                reply.after;
+        if (link.jitter.count() > 0)
+          delay += std::chrono::microseconds(
+              std::uniform_int_distribution<int64_t>(0, link.jitter.count())(
+                  _rng));
+        dropped = link.drop_probability > 0 &&
+                  std::uniform_real_distribution<double>(0, 1)(_rng) <
+                      link.drop_probability;
+        if (dropped)
+          _stats.dropped++;
+        else
+          _stats.replies++;
+      }
+      if (dropped) {
+        spdlog::trace("{} emulator dropped the reply to {}", _name, command);
+        continue;
+      }
+
+      if (!wait(delay))
+        break;
+      write_reply(reply.bytes, link.byte_time);
+    }
+  }
+}
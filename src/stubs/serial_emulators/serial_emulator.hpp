@@ -0,0 +1,123 @@
+#ifndef SERIAL_EMULATOR_HPP
+#define SERIAL_EMULATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Stand-ins for the serial devices so the drivers, tests and benches can run
+// against something that talks like the hardware without any plugged in.
+// Each emulator owns a pseudo terminal, the drivers open the slave side by
+// path through set_serial_device like they would a /dev/ttyACM0, and the
+// firmware behind it answers on the master side.
+
+// What the wire between us and the device is like
+struct emulator_link_config_t {
+  // Time to send one byte, 1040us is 9600 baud and 87us 115200. Commands are
+  // charged for their length before the firmware answers and replies go out
+  // a byte at a time this far apart.
+  std::chrono::microseconds byte_time{0};
+  // How long the firmware thinks before it starts replying
+  std::chrono::microseconds reply_latency{0};
+  // Up to this much more on top of reply_latency, picked per reply
+  std::chrono::microseconds jitter{0};
+  // Chance of the reply to a command never being sent, 0 to 1
+  double drop_probability = 0;
+  // So a run with jitter or drops can be repeated
+  uint32_t seed = 1;
+};
+
+struct emulator_stats_t {
+  uint64_t commands = 0;
+  uint64_t replies = 0;
+  uint64_t dropped = 0;
+  uint64_t bytes_in = 0;
+  uint64_t bytes_out = 0;
+};
+
+struct emulated_reply_t {
+  // Nothing is sent when empty, that isn't counted as a drop
+  std::string bytes;
+  // Extra time before replying that isn't the link, e.g. the QHY wheel only
+  // answers a move once it gets there
+  std::chrono::milliseconds after{0};
+};
+
+// The device side of one protocol. Only ever called from the emulator's
+// thread or under with_firmware() so implementations don't lock.
+class emulated_firmware_t {
+public:
+  virtual ~emulated_firmware_t() = default;
+
+  virtual std::string name() const = 0;
+  // How many bytes at the front of pending make up the next command, 0 if
+  // it hasn't all arrived yet. Junk the firmware can't frame should come
+  // back as a command of its own and get an empty reply.
+  virtual size_t command_length(std::string_view pending) = 0;
+  virtual emulated_reply_t respond(std::string_view command) = 0;
+};
+
+class serial_emulator_t {
+public:
+  // Throws std::system_error if a pseudo terminal can't be had
+  explicit serial_emulator_t(std::unique_ptr<emulated_firmware_t> firmware,
+                             emulator_link_config_t link = {});
+  ~serial_emulator_t();
+
+  serial_emulator_t(const serial_emulator_t &) = delete;
+  serial_emulator_t &operator=(const serial_emulator_t &) = delete;
+
+  // What to hand the driver's set_serial_device, e.g. /dev/pts/3
+  const std::string &device_path() const { return _device_path; }
+  const std::string &name() const { return _name; }
+
+  void configure(const emulator_link_config_t &link);
+  emulator_link_config_t link_config();
+  emulator_stats_t stats();
+  // Flattened for printing alongside serial_latency_tracker_t's summary
+  std::map<std::string, double> summary();
+
+  // For tests to look at or poke the firmware's state between commands
+  template <typename firmware_t, typename fn_t> auto with_firmware(fn_t fn) {
+    std::lock_guard lock(_firmware_mtx);
+    return fn(static_cast<firmware_t &>(*_firmware));
+  }
+
+  // Closes the pty, the driver's reads fail from here on
+  void stop();
+
+private:
+  void emulator_proc();
+  // Sleeps for delay unless stop() comes first, returns false if it did
+  bool wait(std::chrono::microseconds delay);
+  void write_reply(const std::string &bytes,
+                   std::chrono::microseconds byte_time);
+
+  std::unique_ptr<emulated_firmware_t> _firmware;
+  std::mutex _firmware_mtx;
+  std::string _name;
+
+  int _master;
+  // Held open so the master doesn't see a hangup every time the driver
+  // closes its side
+  int _slave;
+  std::string _device_path;
+
+  std::mutex _emulator_mtx;
+  std::condition_variable _emulator_cv;
+  emulator_link_config_t _link;
+  emulator_stats_t _stats;
+  std::mt19937 _rng;
+  std::atomic<bool> _running;
+  std::thread _emulator_thread;
+};
+
+#endif
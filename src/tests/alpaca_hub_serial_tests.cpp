@@ -0,0 +1,424 @@
+#include "common/alpaca_hub_serial.hpp"
+#include "common/serial_reactor.hpp"
+#include "tests/test_helpers.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// These run against a pseudo terminal so they don't need a device. Whatever
+// is written to the master side shows up on the serial port.
+struct pty_pair_t {
+  int master;
+  std::string path;
+
+  pty_pair_t() : master(::posix_openpt(O_RDWR | O_NOCTTY)) {
+    REQUIRE(master >= 0);
+    REQUIRE(::grantpt(master) == 0);
+    REQUIRE(::unlockpt(master) == 0);
+    path = ::ptsname(master);
+  }
+
+  ~pty_pair_t() { ::close(master); }
+
+  void send(const std::string &bytes) {
+    REQUIRE(::write(master, bytes.data(), bytes.size()) ==
+            ssize_t(bytes.size()));
+  }
+
+  // Reads whatever the port has written so far
+  std::string received() {
+    char buf[256];
+    auto n = ::read(master, buf, sizeof(buf));
+    return n > 0 ? std::string(buf, n) : std::string();
+  }
+};
+
+struct pty_port_t : pty_pair_t {
+  asio::io_context io_ctx;
+  asio::serial_port port;
+
+  pty_port_t() : port(io_ctx) { port.open(path); }
+  ~pty_port_t() { port.close(); }
+};
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Frames split across reads are put back together",
+          "[alpaca_hub_serial]") {
+  pty_port_t pty;
+  alpaca_hub_serial::frame_reader reader(pty.port, pty.io_ctx);
+
+  std::thread device([&pty]() {
+    pty.send("12:3");
+    std::this_thread::sleep_for(20ms);
+    pty.send("4:56#");
+  });
+
+  std::string_view frame;
+  REQUIRE(reader.read_until("#", 1000ms, frame));
+  REQUIRE(frame == "12:34:56#");
+  device.join();
+}
+
+TEST_CASE("Bytes after a frame are kept for the next read",
+          "[alpaca_hub_serial]") {
+  pty_port_t pty;
+  alpaca_hub_serial::frame_reader reader(pty.port, pty.io_ctx);
+  pty.send("1#0#ABC");
+
+  std::string_view frame;
+  REQUIRE(reader.read_until("#", 1000ms, frame));
+  REQUIRE(frame == "1#");
+  REQUIRE(reader.buffered() == 5);
+
+  // Already buffered so this one doesn't touch the port
+  REQUIRE(reader.read_until("#\n", 0ms, frame));
+  REQUIRE(frame == "0#");
+
+  REQUIRE(reader.read_exactly(3, 1000ms, frame));
+  REQUIRE(frame == "ABC");
+  REQUIRE(reader.buffered() == 0);
+}
+
+TEST_CASE("A timeout hands back the partial frame", "[alpaca_hub_serial]") {
+  pty_port_t pty;
+  alpaca_hub_serial::frame_reader reader(pty.port, pty.io_ctx, false);
+  pty.send("12:3");
+
+  auto start = std::chrono::steady_clock::now();
+  std::string_view frame;
+  REQUIRE_FALSE(reader.read_until("#", 50ms, frame));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  REQUIRE(frame == "12:3");
+  REQUIRE(elapsed >= 50ms);
+  REQUIRE(elapsed < 1000ms);
+
+  // and the reader is still usable afterwards
+  pty.send("OK#");
+  REQUIRE(reader.read_until("#", 1000ms, frame));
+  REQUIRE(frame == "OK#");
+}
+
+TEST_CASE("Frames can be found by a predicate and outgrow the buffer",
+          "[alpaca_hub_serial]") {
+  pty_port_t pty;
+  alpaca_hub_serial::frame_reader reader(pty.port, pty.io_ctx, true, 16);
+
+  // A length prefixed frame, longer than the reader's starting buffer
+  std::string body(100, 'x');
+  pty.send(std::string(1, char(body.size())) + body + "trailing");
+
+  auto length_prefixed = [](std::string_view pending) -> size_t {
+    if (pending.empty() || pending.size() < size_t(pending[0]) + 1)
+      return 0;
+    return size_t(pending[0]) + 1;
+  };
+
+  std::string_view frame;
+  REQUIRE(reader.read_frame(length_prefixed, 1000ms, frame));
+  REQUIRE(frame.size() == body.size() + 1);
+  REQUIRE(frame.substr(1) == body);
+  REQUIRE(reader.read_exactly(8, 1000ms, frame));
+  REQUIRE(frame == "trailing");
+}
+
+TEST_CASE("Channel transactions write the command and read the reply",
+          "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(pty.path, 9600);
+
+  pty.send("12:34:56#");
+  auto reply = channel->transact(
+      {":GR#", alpaca_hub_serial::ends_with_any("#"), 1000ms});
+  REQUIRE(reply.complete);
+  REQUIRE(reply.frame == "12:34:56#");
+  REQUIRE(pty.received() == ":GR#");
+
+  // No frame_length means no reply is expected
+  reply = channel->transact({":Q#", {}, 1000ms});
+  REQUIRE(reply.complete);
+  REQUIRE(reply.frame.empty());
+  REQUIRE(pty.received() == ":Q#");
+  channel->close();
+}
+
+TEST_CASE("Channel transactions queue up in order", "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(pty.path, 9600);
+
+  // Replies already waiting get split between the queued transactions in
+  // the order they were submitted
+  pty.send("1#22#333#");
+  std::vector<std::future<alpaca_hub_serial::serial_reply_t>> replies;
+  for (int i = 0; i < 3; i++)
+    replies.push_back(channel->transact_async(
+        {"?", alpaca_hub_serial::ends_with_any("#"), 1000ms}));
+
+  REQUIRE(replies[0].get().frame == "1#");
+  REQUIRE(replies[1].get().frame == "22#");
+  REQUIRE(replies[2].get().frame == "333#");
+  channel->close();
+}
+
+TEST_CASE("Channel timeouts return the partial reply and move on",
+          "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel =
+      alpaca_hub_serial::serial_reactor::instance().make_channel(false);
+  channel->open(pty.path, 9600);
+
+  pty.send("12:3");
+  auto start = std::chrono::steady_clock::now();
+  auto reply = channel->transact(
+      {":GR#", alpaca_hub_serial::ends_with_any("#"), 50ms});
+  REQUIRE_FALSE(reply.complete);
+  REQUIRE(reply.error == asio::error::timed_out);
+  REQUIRE(reply.frame == "12:3");
+  REQUIRE(std::chrono::steady_clock::now() - start >= 50ms);
+
+  pty.send("7");
+  reply =
+      channel->transact({":F#", alpaca_hub_serial::fixed_length(1), 1000ms});
+  REQUIRE(reply.complete);
+  REQUIRE(reply.frame == "7");
+
+  // Closed channels fail straight away
+  channel->close();
+  reply = channel->transact({":F#", {}, 1000ms});
+  REQUIRE_FALSE(reply.complete);
+}
+
+TEST_CASE("Polled tasks reschedule themselves until stopped",
+          "[serial_reactor]") {
+  std::atomic<int> runs{0};
+  auto task = alpaca_hub_serial::serial_reactor::instance().schedule(
+      [&runs]() {
+        runs++;
+        return 5ms;
+      });
+
+  auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (runs < 5 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(1ms);
+  REQUIRE(runs >= 5);
+
+  task->stop();
+  int runs_at_stop = runs;
+  std::this_thread::sleep_for(30ms);
+  REQUIRE(runs == runs_at_stop);
+}
+
+TEST_CASE("Waking a polled task runs it without waiting out its delay",
+          "[serial_reactor]") {
+  std::atomic<int> runs{0};
+  std::atomic<bool> hold{false};
+  auto task = alpaca_hub_serial::serial_reactor::instance().schedule(
+      [&runs, &hold]() {
+        runs++;
+        while (hold)
+          std::this_thread::sleep_for(1ms);
+        return std::chrono::milliseconds(1h);
+      });
+
+  auto wait_for_runs = [&runs](int count) {
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (runs < count && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(1ms);
+    return runs.load();
+  };
+  REQUIRE(wait_for_runs(1) == 1);
+
+  // Cuts the hour short
+  task->wake();
+  REQUIRE(wait_for_runs(2) == 2);
+
+  // A wake while it's running isn't lost, it goes again straight after
+  hold = true;
+  task->wake();
+  REQUIRE(wait_for_runs(3) == 3);
+  task->wake();
+  hold = false;
+  REQUIRE(wait_for_runs(4) == 4);
+
+  std::this_thread::sleep_for(30ms);
+  REQUIRE(runs == 4);
+  task->stop();
+  task->wake();
+  std::this_thread::sleep_for(30ms);
+  REQUIRE(runs == 4);
+}
+
+TEST_CASE("A stuck polled task doesn't hold up the others",
+          "[serial_reactor]") {
+  // Stand ins for devices that have stopped answering and sit in transact()
+  std::atomic<bool> hold{true};
+  std::atomic<int> stuck{0};
+  auto stuck_poll = [&hold, &stuck]() {
+    stuck++;
+    while (hold)
+      std::this_thread::sleep_for(1ms);
+    return std::chrono::milliseconds(1h);
+  };
+  std::vector<alpaca_hub_serial::polled_task_ptr_t> stuck_tasks;
+  for (int i = 0; i < 3; i++)
+    stuck_tasks.push_back(
+        alpaca_hub_serial::serial_reactor::instance().schedule(stuck_poll));
+  REQUIRE(eventually([&stuck]() { return stuck == 3; }));
+
+  std::atomic<int> runs{0};
+  auto task = alpaca_hub_serial::serial_reactor::instance().schedule(
+      [&runs]() {
+        runs++;
+        return 5ms;
+      });
+  REQUIRE(eventually([&runs]() { return runs >= 3; }));
+
+  task->stop();
+  hold = false;
+  for (auto &stuck_task : stuck_tasks)
+    stuck_task->stop();
+}
+
+TEST_CASE("Latency stats shrink the timeout and back off after timeouts",
+          "[serial_latency]") {
+  alpaca_hub_serial::serial_latency_tracker_t tracker;
+
+  // Not enough history yet, the request's own timeout stands
+  REQUIRE(tracker.timeout_for("GR", 250ms) == 250ms);
+  for (int i = 0; i < 16; i++)
+    tracker.record_reply("GR", 3ms);
+
+  auto timeout = tracker.timeout_for("GR", 250ms);
+  REQUIRE(timeout >= 6ms);
+  REQUIRE(timeout < 20ms);
+  auto stats = tracker.snapshot()["GR"];
+  REQUIRE(stats.count == 16);
+  REQUIRE(stats.p99_ms == 3);
+  REQUIRE(stats.ewma_ms == 3);
+
+  tracker.record_timeout("GR");
+  tracker.record_timeout("GR");
+  REQUIRE(tracker.timeout_for("GR", 250ms) == 4 * timeout);
+  REQUIRE(tracker.snapshot()["GR"].timeouts == 2);
+
+  // A good reply ends the back off, and one slow reply is enough to lift
+  // the timeout above it
+  tracker.record_reply("GR", 40ms);
+  REQUIRE(tracker.timeout_for("GR", 250ms) >= 80ms);
+
+  // Families don't affect each other
+  REQUIRE(tracker.timeout_for("GD", 250ms) == 250ms);
+  REQUIRE(tracker.summary().count("GR.p99_ms") == 1);
+}
+
+TEST_CASE("Adaptive timeouts respect the floor, ceiling and off switch",
+          "[serial_latency]") {
+  alpaca_hub_serial::adaptive_timeout_config_t config;
+  config.floor = 20ms;
+  config.ceiling = 100ms;
+  config.min_samples = 1;
+  alpaca_hub_serial::serial_latency_tracker_t tracker(config);
+
+  tracker.record_reply("PA", 1ms);
+  REQUIRE(tracker.timeout_for("PA", 250ms) == 20ms);
+
+  tracker.record_reply("PA", 500ms);
+  REQUIRE(tracker.timeout_for("PA", 250ms) == 100ms);
+
+  // and past the request's own timeout if that's what the link needs
+  config.ceiling = 5000ms;
+  tracker.configure(config);
+  REQUIRE(tracker.timeout_for("PA", 250ms) >= 1000ms);
+
+  config.enabled = false;
+  tracker.configure(config);
+  REQUIRE(tracker.timeout_for("PA", 250ms) == 250ms);
+
+  REQUIRE(alpaca_hub_serial::command_family("P1:1\n") == "P1");
+  REQUIRE(alpaca_hub_serial::command_family("##\r\n") == "##");
+  REQUIRE(alpaca_hub_serial::command_family("VRS") == "VRS");
+}
+
+TEST_CASE("Channels learn each family's timeout from its replies",
+          "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(pty.path, 9600);
+
+  for (int i = 0; i < 20; i++) {
+    pty.send("12:34:56#");
+    alpaca_hub_serial::serial_request_t request{
+        ":GR#", alpaca_hub_serial::ends_with_any("#"), 1000ms};
+    request.family = "get_current_ra";
+    REQUIRE(channel->transact(std::move(request)).complete);
+  }
+
+  auto stats = channel->latency().snapshot()["get_current_ra"];
+  REQUIRE(stats.count == 20);
+  REQUIRE(stats.timeout_ms < 1000);
+  // Requests without a family aren't tracked
+  REQUIRE(channel->latency().snapshot().size() == 1);
+  channel->close();
+}
+
+TEST_CASE("Batches write every command up front and split the replies",
+          "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(pty.path, 9600);
+
+  // All the replies show up at once, the way a pipelined mount answers
+  pty.send("12:34:56#1+45*30:15#");
+  std::vector<alpaca_hub_serial::serial_request_t> requests;
+  requests.push_back({":GR#", alpaca_hub_serial::ends_with_any("#"), 1000ms});
+  requests.push_back({":Q#", {}, 1000ms});
+  requests.push_back({":Te#", alpaca_hub_serial::fixed_length(1), 1000ms});
+  requests.push_back({":GD#", alpaca_hub_serial::ends_with_any("#"), 1000ms});
+
+  auto replies = channel->transact_batch(std::move(requests));
+  REQUIRE(replies.size() == 4);
+  REQUIRE(replies[0].frame == "12:34:56#");
+  REQUIRE(replies[1].complete);
+  REQUIRE(replies[1].frame.empty());
+  REQUIRE(replies[2].frame == "1");
+  REQUIRE(replies[3].frame == "+45*30:15#");
+  REQUIRE(pty.received() == ":GR#:Q#:Te#:GD#");
+  channel->close();
+}
+
+TEST_CASE("A reply that never comes fails the rest of the batch",
+          "[serial_reactor]") {
+  pty_pair_t pty;
+  auto channel =
+      alpaca_hub_serial::serial_reactor::instance().make_channel(false);
+  channel->open(pty.path, 9600);
+
+  pty.send("12:34:56#+45");
+  std::vector<alpaca_hub_serial::serial_request_t> requests;
+  requests.push_back({":GR#", alpaca_hub_serial::ends_with_any("#"), 1000ms});
+  requests.push_back({":GD#", alpaca_hub_serial::ends_with_any("#"), 50ms});
+  requests.push_back({":GS#", alpaca_hub_serial::ends_with_any("#"), 50ms});
+
+  auto replies = channel->transact_batch(std::move(requests));
+  REQUIRE(replies[0].complete);
+  REQUIRE_FALSE(replies[1].complete);
+  REQUIRE(replies[1].error == asio::error::timed_out);
+  REQUIRE(replies[1].frame == "+45");
+  REQUIRE_FALSE(replies[2].complete);
+  REQUIRE(replies[2].error == asio::error::operation_aborted);
+
+  // and the channel carries on afterwards
+  pty.send("OK#");
+  auto reply = channel->transact(
+      {":GV#", alpaca_hub_serial::ends_with_any("#"), 1000ms});
+  REQUIRE(reply.frame == "OK#");
+  channel->close();
+}
@@ -0,0 +1,160 @@
+#include "common/alpaca_response.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+// The server has the same one, for axisrates
+namespace nlohmann {
+static void to_json(nlohmann::json &j, const axis_rate &p) {
+  j = nlohmann::json{{"Maximum", p.Max}, {"Minimum", p.Min}};
+}
+} // namespace nlohmann
+
+namespace {
+// What the server used to do with every response
+std::string nlohmann_dump(const std::map<std::string, device_variant_t> &m) {
+  return nlohmann::json(m).dump();
+}
+
+// Puts value under key in both and checks they come out the same
+template <typename T> void require_same(const std::string &key, T value) {
+  std::map<std::string, device_variant_t> before;
+  alpaca_response_t after;
+  before["ErrorNumber"] = 0;
+  after["ErrorNumber"] = 0;
+  before[key] = value;
+  after[key] = value;
+  REQUIRE(after.dump() == nlohmann_dump(before));
+}
+} // namespace
+
+TEST_CASE("The Alpaca envelope comes out in the same order as before",
+          "[alpaca_response]") {
+  std::map<std::string, device_variant_t> before;
+  alpaca_response_t after;
+  before["ServerTransactionID"] = uint32_t(42);
+  before["ErrorNumber"] = 0;
+  before["ErrorMessage"] = "";
+  before["ClientTransactionID"] = uint32_t(7);
+  before["ClientID"] = uint32_t(1);
+  before["Value"] = 12.5;
+  after["ServerTransactionID"] = uint32_t(42);
+  after["ErrorNumber"] = 0;
+  after["ErrorMessage"] = "";
+  after["ClientTransactionID"] = uint32_t(7);
+  after["ClientID"] = uint32_t(1);
+  after["Value"] = 12.5;
+
+  REQUIRE(after.dump() == nlohmann_dump(before));
+  REQUIRE(after.dump() ==
+          R"({"ClientID":1,"ClientTransactionID":7,"ErrorMessage":"",)"
+          R"("ErrorNumber":0,"ServerTransactionID":42,"Value":12.5})");
+
+  // Keys that weren't set stay out, the same as a map that never had them
+  alpaca_response_t empty;
+  REQUIRE(empty.dump() == "{}");
+  REQUIRE_FALSE(empty.contains("Value"));
+  empty["ErrorNumber"] = 0;
+  REQUIRE(empty.contains("ErrorNumber"));
+  REQUIRE(empty.dump() == R"({"ErrorNumber":0})");
+}
+
+TEST_CASE("Extra keys are merged in sorted order", "[alpaca_response]") {
+  std::map<std::string, device_variant_t> before;
+  alpaca_response_t after;
+  const std::vector<std::string> keys = {
+      "Value", "Type", "Rank", "ErrorNumber", "AAA", "Zebra", "ClientID",
+      "Connected", "errornumber", "ServerTransactionID"};
+  int i = 0;
+  for (auto &key : keys) {
+    before[key] = i;
+    after[key] = i;
+    i++;
+  }
+  REQUIRE(after.dump() == nlohmann_dump(before));
+  REQUIRE(after.contains("Rank"));
+  REQUIRE_FALSE(after.contains("Missing"));
+}
+
+TEST_CASE("Scalars are written the way nlohmann writes them",
+          "[alpaca_response]") {
+  require_same("Value", true);
+  require_same("Value", false);
+  require_same("Value", 0);
+  require_same("Value", -2147483647 - 1);
+  require_same("Value", uint8_t(255));
+  require_same("Value", uint16_t(65535));
+  require_same("Value", uint32_t(4294967295u));
+  require_same("Value", std::numeric_limits<long>::min());
+  require_same("Value", std::numeric_limits<unsigned long>::max());
+  require_same("Value", drive_rate_enum::king);
+  require_same("Value", pier_side_enum::unknown);
+  require_same("Value", telescope_axes_enum::tertiary);
+
+  for (double d : {0.0, -0.0, 1.0, -1.0, 0.1, 1.0 / 3, 12.345678901234567,
+                   1e-5, 1e-4, 123456789012345.0, 1234567890123456.0, 1e21,
+                   5e-324, std::numeric_limits<double>::max(), -273.15,
+                   std::nan(""), std::numeric_limits<double>::infinity()})
+    require_same("Value", d);
+}
+
+TEST_CASE("Strings are escaped the way nlohmann escapes them",
+          "[alpaca_response]") {
+  require_same("ErrorMessage", std::string());
+  require_same("ErrorMessage", std::string("Invalid Value for Gain passed"));
+  require_same("ErrorMessage", std::string("quote \" backslash \\ slash /"));
+  require_same("ErrorMessage", std::string("\b\f\n\r\t"));
+  require_same("ErrorMessage", std::string("\x01\x1f\x7f", 3));
+  require_same("ErrorMessage", std::string(1, '\0'));
+  require_same("ErrorMessage", std::string("Temperature 20\xc2\xb0"
+                                           "C"));
+  require_same("ErrorMessage", std::string("\xf0\x9f\x94\xad"));
+
+  // Bad UTF-8 still throws like it did
+  alpaca_response_t bad;
+  bad["ErrorMessage"] = std::string("\xff");
+  REQUIRE_THROWS(bad.dump());
+}
+
+TEST_CASE("Collections are written the way nlohmann writes them",
+          "[alpaca_response]") {
+  require_same("Value", std::vector<std::string>{});
+  require_same("Value", std::vector<std::string>{"L", "R", "G", "B", "Ha"});
+  require_same("Value", std::vector<int>{1, -2, 3});
+  require_same("Value", std::vector<double>{0.5, 1.0, 2e-7});
+  require_same("Value", std::vector<bool>{true, false, true});
+  require_same("Value", std::vector<drive_rate_enum>{drive_rate_enum::sidereal,
+                                                     drive_rate_enum::lunar});
+  require_same("Value", std::vector<std::vector<uint32_t>>{{1, 2}, {}, {3}});
+
+  std::vector<device_mgmt_list_entry_t> devices(2);
+  devices[0]["DeviceType"] = std::string("camera");
+  devices[0]["DeviceNumber"] = 0;
+  devices[0]["DeviceName"] = std::string("QHY 268M");
+  devices[0]["UniqueID"] = std::string("abc-123");
+  devices[1]["DeviceType"] = std::string("telescope");
+  devices[1]["DeviceNumber"] = 0;
+  require_same("Value", devices);
+
+  require_same("Value", std::map<std::string, std::string>{
+                            {"ServerName", "Dave's Alpaca Hub"},
+                            {"Location", "Austin, TX"}});
+  require_same("Value", std::map<std::string, double>{});
+  require_same("Value", std::map<std::string, device_variant_intermediate_t>{
+                            {"position", uint32_t(3)},
+                            {"names", std::vector<std::string>{"L", "R"}},
+                            {"moving", false}});
+}
+
+TEST_CASE("Axis rates come out as Maximum and Minimum", "[alpaca_response]") {
+  std::vector<axis_rate> rates{axis_rate(4.0, 0.0), axis_rate(0.5, 0.25)};
+  require_same("Value", rates);
+
+  alpaca_response_t response;
+  response["Value"] = rates;
+  REQUIRE(response.dump() == R"({"Value":[{"Maximum":4.0,"Minimum":0.0},)"
+                             R"({"Maximum":0.5,"Minimum":0.25}]})");
+}
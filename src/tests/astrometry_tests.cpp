@@ -0,0 +1,118 @@
+#include "common/astrometry.hpp"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+
+// Reference values are the worked examples in Meeus, Astronomical Algorithms
+
+using namespace std::chrono_literals;
+
+// 1987 April 10 0h UT
+static const std::chrono::system_clock::time_point meeus_12a{545011200s};
+// 1987 April 10 19h21m UT
+static const std::chrono::system_clock::time_point meeus_12b{545080860s};
+
+TEST_CASE("Julian date and sidereal time", "[astrometry]") {
+  REQUIRE(astrometry::julian_date(meeus_12a) == Catch::Approx(2446895.5));
+
+  // 13h10m46.3668s
+  REQUIRE(astrometry::greenwich_sidereal_time(meeus_12a) ==
+          Catch::Approx(13.1795463).margin(1e-6));
+  // 8h34m57.0896s
+  REQUIRE(astrometry::greenwich_sidereal_time(meeus_12b) ==
+          Catch::Approx(8.5825249).margin(1e-6));
+
+  // Washington is 77d03m56s west, 5h08m15.7s behind Greenwich
+  REQUIRE(astrometry::local_sidereal_time(meeus_12b, -77.0655556) ==
+          Catch::Approx(8.5825249 - 5.1377037).margin(1e-6));
+  // and wraps round rather than going negative
+  REQUIRE(astrometry::local_sidereal_time(meeus_12a, 180) ==
+          Catch::Approx(13.1795463 + 12 - 24).margin(1e-6));
+}
+
+TEST_CASE("Equatorial to horizontal and back", "[astrometry]") {
+  // Venus seen from the US Naval Observatory, Meeus example 13.b. Meeus
+  // measures azimuth from the south, 68.0337 there is 248.0337 here.
+  astrometry::site_t site;
+  site.latitude = 38.9213889;
+  site.longitude = -77.0655556;
+  astrometry::equatorial_t venus{23.1546225, -6.7198917};
+  double lst = astrometry::local_sidereal_time(meeus_12b, site.longitude);
+
+  auto horizontal = astrometry::to_horizontal(venus, lst, site);
+  // Meeus uses apparent sidereal time, we're 3.5" off from ignoring
+  // nutation
+  REQUIRE(horizontal.altitude == Catch::Approx(15.1249).margin(0.002));
+  REQUIRE(horizontal.azimuth == Catch::Approx(248.0337).margin(0.002));
+
+  auto equatorial = astrometry::to_equatorial(horizontal, lst, site);
+  REQUIRE(equatorial.right_ascension ==
+          Catch::Approx(venus.right_ascension).margin(1e-9));
+  REQUIRE(equatorial.declination ==
+          Catch::Approx(venus.declination).margin(1e-9));
+
+  SECTION("Refraction lifts it and comes back off on the way back") {
+    site.refraction = true;
+    auto apparent = astrometry::to_horizontal(venus, lst, site);
+    REQUIRE(apparent.altitude - horizontal.altitude ==
+            Catch::Approx(3.65 / 60).margin(0.05 / 60));
+    REQUIRE(apparent.azimuth == Catch::Approx(horizontal.azimuth));
+
+    // Saemundsson and Bennett agree to a few hundredths of an arc minute
+    auto back = astrometry::to_equatorial(apparent, lst, site);
+    REQUIRE(back.declination ==
+            Catch::Approx(venus.declination).margin(0.1 / 60));
+  }
+}
+
+TEST_CASE("Refraction", "[astrometry]") {
+  astrometry::site_t site;
+  // Meeus example 16.a, 28.754' at an apparent altitude of 0d30m
+  REQUIRE(astrometry::refraction_from_apparent(0.5, site) * 60 ==
+          Catch::Approx(28.754).margin(0.001));
+  REQUIRE(astrometry::refraction(90, site) * 60 ==
+          Catch::Approx(0).margin(0.01));
+  REQUIRE(astrometry::refraction(-5, site) == 0);
+
+  // Colder, denser air bends more
+  astrometry::site_t cold = site;
+  cold.temperature_c = -10;
+  REQUIRE(astrometry::refraction(10, cold) > astrometry::refraction(10, site));
+}
+
+TEST_CASE("Destination side of pier", "[astrometry]") {
+  // Targets west of the meridian are the normal pointing state
+  REQUIRE(astrometry::destination_side_of_pier({10, 45}, 12) ==
+          pier_side_enum::east);
+  REQUIRE(astrometry::destination_side_of_pier({14, 45}, 12) ==
+          pier_side_enum::west);
+  REQUIRE(astrometry::destination_side_of_pier({12, 45}, 12) ==
+          pier_side_enum::east);
+  // across 0h
+  REQUIRE(astrometry::destination_side_of_pier({23, 0}, 1) ==
+          pier_side_enum::east);
+  REQUIRE(astrometry::destination_side_of_pier({1, 0}, 23) ==
+          pier_side_enum::west);
+}
+
+TEST_CASE("Extrapolating the position between polls", "[astrometry]") {
+  astrometry::equatorial_t from{23.999, 20};
+
+  // Tracking at sidereal the mount stays put
+  auto tracking = astrometry::extrapolate(from, 10min, true,
+                                          drive_rate_enum::sidereal);
+  REQUIRE(tracking.right_ascension == Catch::Approx(from.right_ascension));
+  REQUIRE(tracking.declination == from.declination);
+
+  // Not tracking, the sky carries RA on at the sidereal rate and past 24h
+  auto stopped = astrometry::extrapolate(from, 1h, false,
+                                         drive_rate_enum::sidereal);
+  REQUIRE(stopped.right_ascension ==
+          Catch::Approx(23.999 + 1.0027379 - 24).margin(1e-6));
+
+  // The moon tracks slower than the stars so RA creeps up
+  auto lunar = astrometry::extrapolate({10, 20}, 1h, true,
+                                       drive_rate_enum::lunar);
+  REQUIRE(lunar.right_ascension - 10 ==
+          Catch::Approx((15.041067 - 14.685) * 3600 / 54000).margin(1e-9));
+}
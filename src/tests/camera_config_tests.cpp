@@ -0,0 +1,62 @@
+#include "common/camera_config.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+static camera_config_t make_config() {
+  camera_config_t config;
+  config.readout_mode = 1;
+  config.bin = 2;
+  config.start_x = 10;
+  config.start_y = 20;
+  config.num_x = 3000;
+  config.num_y = 2000;
+  config.gain = 56;
+  config.offset = 30;
+  config.usb_traffic = 20;
+  config.exposure_us = 1000000;
+  return config;
+}
+
+TEST_CASE("Nothing applied yet means everything is sent", "[camera_config]") {
+  camera_config_tracker_t tracker;
+  REQUIRE(tracker.diff(make_config()) == CONFIG_ALL);
+  // Even if the desired values happen to match the defaults
+  REQUIRE(tracker.diff(camera_config_t{}) == CONFIG_ALL);
+}
+
+TEST_CASE("Only changed fields are reported", "[camera_config]") {
+  camera_config_tracker_t tracker;
+  auto config = make_config();
+  tracker.mark_applied(config, CONFIG_ALL);
+  REQUIRE(tracker.diff(config) == 0);
+
+  config.num_x = 1000;
+  config.gain = 100;
+  REQUIRE(tracker.diff(config) == (CONFIG_ROI | CONFIG_GAIN));
+
+  tracker.mark_applied(config, CONFIG_ROI);
+  REQUIRE(tracker.diff(config) == CONFIG_GAIN);
+
+  config.exposure_us = 500;
+  REQUIRE(tracker.diff(config) == (CONFIG_GAIN | CONFIG_EXPOSURE));
+}
+
+TEST_CASE("Invalidated fields are sent again", "[camera_config]") {
+  camera_config_tracker_t tracker;
+  auto config = make_config();
+  tracker.mark_applied(config, CONFIG_ALL);
+
+  tracker.invalidate(CONFIG_EXPOSURE);
+  REQUIRE(tracker.diff(config) == CONFIG_EXPOSURE);
+
+  // e.g. after InitQHYCCD
+  tracker.invalidate();
+  tracker.mark_applied(config, CONFIG_READOUT_MODE | CONFIG_BIN);
+  REQUIRE(tracker.diff(config) == (CONFIG_ALL & ~(CONFIG_READOUT_MODE |
+                                                  CONFIG_BIN)));
+}
+
+TEST_CASE("Field names for logging", "[camera_config]") {
+  REQUIRE(camera_config_fields_to_string(0) == "");
+  REQUIRE(camera_config_fields_to_string(CONFIG_BIN | CONFIG_EXPOSURE) ==
+          "bin,exposure");
+}
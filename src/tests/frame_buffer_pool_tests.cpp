@@ -0,0 +1,106 @@
+#include "common/alpaca_exception.hpp"
+#include "common/camera_frame.hpp"
+#include "common/frame_buffer_pool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <vector>
+
+TEST_CASE("Pool hands out distinct buffers and gets them back",
+          "[frame_buffer_pool]") {
+  // Page locking may not be allowed in the test environment, the pool
+  // should work either way
+  auto pool = frame_buffer_pool_t::create(2, 4096);
+  REQUIRE(pool->buffer_count() == 2);
+  REQUIRE(pool->free_count() == 2);
+
+  auto first = pool->acquire(100);
+  auto second = pool->acquire(4096);
+  REQUIRE(first->data() != second->data());
+  REQUIRE(first->size() == 100);
+  REQUIRE(second->size() == 4096);
+  REQUIRE(pool->free_count() == 0);
+
+  first.reset();
+  REQUIRE(pool->free_count() == 1);
+  second.reset();
+  REQUIRE(pool->free_count() == 2);
+  REQUIRE(pool->buffer_count() == 2);
+}
+
+TEST_CASE("Pool grows instead of blocking when every buffer is in use",
+          "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(1, 1024, false);
+  auto first = pool->acquire(1024);
+  auto second = pool->acquire(1024);
+  REQUIRE(pool->buffer_count() == 2);
+
+  first.reset();
+  second.reset();
+  REQUIRE(pool->free_count() == 2);
+}
+
+TEST_CASE("Oversized requests are rejected", "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(1, 1024, false);
+  REQUIRE_THROWS(pool->acquire(1025));
+
+  auto buffer = pool->acquire(512);
+  REQUIRE_THROWS(buffer->resize(2048));
+}
+
+TEST_CASE("Frames keep their buffer until the last reader lets go",
+          "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(2, 16, false);
+
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->pixel_type = image_array_element_types::BYTE;
+  frame->width = 4;
+  frame->height = 4;
+  frame->buffer = pool->acquire(frame->size_bytes());
+  std::memset(frame->data(), 42, frame->size_bytes());
+
+  // Simulates a download still holding the frame while the camera moves on
+  camera_frame_ptr_t download = frame;
+  frame.reset();
+  auto next_exposure = pool->acquire(16);
+  REQUIRE(next_exposure->data() != download->data());
+  REQUIRE(download->pixel(3, 3) == 42);
+  REQUIRE(pool->free_count() == 0);
+
+  download.reset();
+  REQUIRE(pool->free_count() == 1);
+}
+
+TEST_CASE("Buffers outlive the pool they came from", "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(1, 64, false);
+  auto buffer = pool->acquire(64);
+  pool.reset();
+  std::memset(buffer->data(), 1, buffer->size());
+  buffer.reset();
+}
+
+TEST_CASE("Pool stops growing at its limit", "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(2, 64, false, false, 4);
+  REQUIRE(pool->max_buffer_count() == 4);
+
+  std::vector<frame_buffer_ptr_t> held;
+  for (int i = 0; i < 4; i++)
+    held.push_back(pool->acquire(64));
+  REQUIRE(pool->buffer_count() == 4);
+  REQUIRE_THROWS_AS(pool->acquire(64), alpaca_exception);
+  REQUIRE(pool->buffer_count() == 4);
+
+  // Once a reader lets go there's a buffer again
+  held.pop_back();
+  auto buffer = pool->acquire(64);
+  REQUIRE(pool->buffer_count() == 4);
+}
+
+TEST_CASE("Pool without a limit keeps growing", "[frame_buffer_pool]") {
+  auto pool = frame_buffer_pool_t::create(2, 64, false);
+  REQUIRE(pool->max_buffer_count() == 0);
+
+  std::vector<frame_buffer_ptr_t> held;
+  for (int i = 0; i < 20; i++)
+    held.push_back(pool->acquire(64));
+  REQUIRE(pool->buffer_count() == 20);
+}
@@ -0,0 +1,133 @@
+#include "common/frame_stats.hpp"
+#include <algorithm>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include <random>
+
+static std::shared_ptr<camera_frame_t>
+make_frame(uint32_t width, uint32_t height, uint16_t background) {
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->pixel_type = image_array_element_types::UINT16;
+  frame->width = width;
+  frame->height = height;
+  frame->buffer = make_frame_buffer(frame->size_bytes());
+  auto pixels = reinterpret_cast<uint16_t *>(frame->data());
+  std::fill(pixels, pixels + frame->num_pixels(), background);
+  return frame;
+}
+
+static void add_star(camera_frame_t &frame, double cx, double cy, double peak,
+                     double sigma) {
+  auto pixels = reinterpret_cast<uint16_t *>(frame.data());
+  for (uint32_t y = 0; y < frame.height; y++)
+    for (uint32_t x = 0; x < frame.width; x++) {
+      double dx = x - cx, dy = y - cy;
+      double v = peak * std::exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+      auto &pixel = pixels[size_t(y) * frame.width + x];
+      // Clip like a real sensor would
+      pixel = uint16_t(std::min(65535L, pixel + std::lround(v)));
+    }
+}
+
+TEST_CASE("Basic statistics come from the histogram", "[frame_stats]") {
+  worker_pool_t pool(3);
+  auto frame = make_frame(100, 50, 0);
+  auto pixels = reinterpret_cast<uint16_t *>(frame->data());
+  for (size_t i = 0; i < frame->num_pixels(); i++)
+    pixels[i] = i % 100;
+
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.width == 100);
+  REQUIRE(stats.height == 50);
+  REQUIRE(stats.min == 0);
+  REQUIRE(stats.max == 99);
+  REQUIRE(stats.mean == Catch::Approx(49.5));
+  REQUIRE(stats.median == 49);
+  REQUIRE(stats.std_dev == Catch::Approx(28.866).epsilon(0.001));
+  REQUIRE(stats.histogram.size() == 65536);
+  REQUIRE(stats.histogram[0] == 50);
+  REQUIRE(stats.histogram[99] == 50);
+  REQUIRE(stats.histogram[100] == 0);
+}
+
+TEST_CASE("8 bit frames get a 256 bin histogram", "[frame_stats]") {
+  worker_pool_t pool(1);
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->pixel_type = image_array_element_types::BYTE;
+  frame->width = 16;
+  frame->height = 16;
+  frame->buffer = make_frame_buffer(frame->size_bytes());
+  for (size_t i = 0; i < frame->num_pixels(); i++)
+    frame->data()[i] = i;
+
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.histogram.size() == 256);
+  REQUIRE(stats.min == 0);
+  REQUIRE(stats.max == 255);
+  REQUIRE(rebin_histogram(stats.histogram, 4) ==
+          std::vector<uint32_t>{64, 64, 64, 64});
+}
+
+TEST_CASE("Background noise is a robust sigma", "[frame_stats]") {
+  worker_pool_t pool(3);
+  auto frame = make_frame(400, 300, 0);
+  auto pixels = reinterpret_cast<uint16_t *>(frame->data());
+  std::mt19937 rng(42);
+  std::normal_distribution<double> noise(1000, 20);
+  for (size_t i = 0; i < frame->num_pixels(); i++)
+    pixels[i] = uint16_t(std::lround(noise(rng)));
+  // A few hot pixels shouldn't move the robust estimates
+  for (size_t i = 0; i < 100; i++)
+    pixels[i * 997] = 60000;
+
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.background == Catch::Approx(1000).margin(1));
+  REQUIRE(stats.noise == Catch::Approx(20).epsilon(0.1));
+  // Hot pixels aren't stars
+  REQUIRE(stats.star_count == 0);
+}
+
+TEST_CASE("Stars are found and measured", "[frame_stats]") {
+  worker_pool_t pool(3);
+  auto frame = make_frame(300, 200, 500);
+  const double sigma = 2.0;
+  add_star(*frame, 50.3, 40.6, 5000, sigma);
+  add_star(*frame, 150, 100, 8000, sigma);
+  add_star(*frame, 250.5, 160.5, 3000, sigma);
+  // Right on a band boundary and close to the edge
+  add_star(*frame, 5, 100, 4000, sigma);
+
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.star_count == 4);
+  REQUIRE(stats.median_fwhm == Catch::Approx(2.35482 * sigma).epsilon(0.1));
+  // For a gaussian the flux weighted mean radius is sigma * sqrt(pi / 2)
+  REQUIRE(stats.median_hfr ==
+          Catch::Approx(sigma * std::sqrt(M_PI / 2)).epsilon(0.1));
+}
+
+TEST_CASE("Saturated stars are counted but not measured", "[frame_stats]") {
+  worker_pool_t pool(1);
+  auto frame = make_frame(100, 100, 500);
+  add_star(*frame, 50, 50, 100000, 2);
+
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.star_count == 1);
+  REQUIRE(stats.median_hfr == 0);
+}
+
+TEST_CASE("JSON only carries the histogram when asked", "[frame_stats]") {
+  worker_pool_t pool(1);
+  auto frame = make_frame(64, 64, 100);
+  auto stats = compute_frame_stats(*frame, pool);
+
+  auto j = nlohmann::json::parse(frame_stats_to_json(stats));
+  REQUIRE(j["Median"] == 100);
+  REQUIRE(j["StarCount"] == 0);
+  REQUIRE_FALSE(j.contains("Histogram"));
+
+  j = nlohmann::json::parse(frame_stats_to_json(stats, 16));
+  REQUIRE(j["Histogram"].size() == 16);
+  REQUIRE(j["Histogram"][0] == 64 * 64);
+}
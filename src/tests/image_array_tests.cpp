@@ -0,0 +1,129 @@
+#include "common/camera_frame.hpp"
+#include "common/image_array_json_writer.hpp"
+#include "common/image_bytes.hpp"
+#include "common/image_bytes_writer.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+static nlohmann::json response_fields() {
+  nlohmann::json response;
+  response["ClientTransactionID"] = 12;
+  response["ErrorMessage"] = "";
+  response["ErrorNumber"] = 0;
+  response["Rank"] = 2;
+  response["ServerTransactionID"] = 34;
+  response["Type"] = 2;
+  return response;
+}
+
+// Builds the response the way the old image_array_handler did, i.e. a
+// vector of vectors stuffed into the response map and dumped in one go
+static std::string legacy_image_array_json(const camera_frame_t &frame) {
+  std::vector<std::vector<uint32_t>> i2d(frame.width,
+                                         std::vector<uint32_t>(frame.height));
+  for (uint32_t x = 0; x < frame.width; x++)
+    for (uint32_t y = 0; y < frame.height; y++)
+      i2d[x][y] = frame.pixel(x, y);
+
+  auto response = response_fields();
+  response["Value"] = i2d;
+  return response.dump();
+}
+
+static std::string streamed_image_array_json(camera_frame_ptr_t frame,
+                                             size_t target_size) {
+  image_array_json_writer_t writer(response_fields().dump(), frame);
+  std::string result;
+  std::string chunk;
+  while (writer.next_chunk(chunk, target_size))
+    result += chunk;
+  return result;
+}
+
+static std::shared_ptr<camera_frame_t>
+make_test_frame(image_array_element_types pixel_type, uint32_t width,
+                uint32_t height) {
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->pixel_type = pixel_type;
+  frame->width = width;
+  frame->height = height;
+  frame->buffer = make_frame_buffer(frame->size_bytes());
+  if (pixel_type == image_array_element_types::BYTE) {
+    for (size_t i = 0; i < frame->data_size(); i++)
+      frame->data()[i] = i % 256;
+  } else {
+    auto pixels = reinterpret_cast<uint16_t *>(frame->data());
+    for (size_t i = 0; i < frame->num_pixels(); i++)
+      pixels[i] = (i * 977) % 65536;
+  }
+  return frame;
+}
+
+TEST_CASE("Streamed JSON matches the nlohmann output",
+          "[image_array_json_writer]") {
+  const uint32_t width = 37;
+  const uint32_t height = 23;
+
+  SECTION("8bpp frame") {
+    auto frame = make_test_frame(image_array_element_types::BYTE, width, height);
+    auto expected = legacy_image_array_json(*frame);
+    REQUIRE(streamed_image_array_json(frame, 64) == expected);
+    REQUIRE(streamed_image_array_json(frame, 1 << 20) == expected);
+  }
+
+  SECTION("16bpp frame") {
+    auto frame =
+        make_test_frame(image_array_element_types::UINT16, width, height);
+    auto expected = legacy_image_array_json(*frame);
+    REQUIRE(streamed_image_array_json(frame, 64) == expected);
+    REQUIRE(streamed_image_array_json(frame, 1000) == expected);
+  }
+
+  SECTION("Empty prefix object") {
+    auto frame = make_test_frame(image_array_element_types::BYTE, 2, 2);
+    std::memset(frame->data(), 7, 4);
+    image_array_json_writer_t writer("{}", frame);
+    std::string chunk;
+    std::string result;
+    while (writer.next_chunk(chunk))
+      result += chunk;
+    REQUIRE(result == "{\"Value\":[[7,7],[7,7]]}");
+  }
+}
+
+TEST_CASE("ImageBytes writer emits header and x-major data",
+          "[image_bytes_writer]") {
+  const uint32_t width = 130;
+  const uint32_t height = 67;
+  auto frame = make_test_frame(image_array_element_types::UINT16, width, height);
+
+  image_bytes_header_t header;
+  header.client_transaction_number = 12;
+  header.server_transaction_number = 34;
+  image_bytes_writer_t writer(header, frame);
+
+  std::string result;
+  std::string chunk;
+  while (writer.next_chunk(chunk, 1000))
+    result += chunk;
+
+  REQUIRE(result.size() == writer.content_length());
+  REQUIRE(result.size() == 44 + width * height * 2);
+
+  image_bytes_header_t written;
+  std::memcpy(&written, result.data(), sizeof(written));
+  REQUIRE(written.client_transaction_number == 12);
+  REQUIRE(written.server_transaction_number == 34);
+  REQUIRE(written.transmission_element_type ==
+          image_array_element_types::UINT16);
+  REQUIRE(written.dimension1 == width);
+  REQUIRE(written.dimension2 == height);
+
+  auto pixels = reinterpret_cast<const uint16_t *>(result.data() + 44);
+  bool matches = true;
+  for (uint32_t x = 0; x < width; x++)
+    for (uint32_t y = 0; y < height; y++)
+      matches &= pixels[x * height + y] == frame->pixel(x, y);
+  REQUIRE(matches);
+}
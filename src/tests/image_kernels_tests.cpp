@@ -0,0 +1,176 @@
+#include "common/image_kernels.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <vector>
+
+using namespace image_kernels;
+
+static const std::vector<image_array_element_types> all_element_types = {
+    image_array_element_types::INT16,  image_array_element_types::INT32,
+    image_array_element_types::DOUBLE, image_array_element_types::SINGLE,
+    image_array_element_types::UINT64, image_array_element_types::BYTE,
+    image_array_element_types::INT64,  image_array_element_types::UINT16,
+    image_array_element_types::UINT32};
+
+// Row major 16 bit test pattern that covers the whole range so the
+// saturating conversions get exercised
+static std::vector<uint16_t> make_u16_frame(uint32_t width, uint32_t height) {
+  std::vector<uint16_t> frame(static_cast<size_t>(width) * height);
+  for (size_t i = 0; i < frame.size(); i++)
+    frame[i] = (i * 977) % 65536;
+  return frame;
+}
+
+static std::vector<uint8_t> make_u8_frame(uint32_t width, uint32_t height) {
+  std::vector<uint8_t> frame(static_cast<size_t>(width) * height);
+  for (size_t i = 0; i < frame.size(); i++)
+    frame[i] = (i * 31) % 256;
+  return frame;
+}
+
+TEST_CASE("Scalar transpose puts pixels in [x][y] order", "[image_kernels]") {
+  const uint32_t width = 13;
+  const uint32_t height = 9;
+  auto src = make_u16_frame(width, height);
+
+  std::vector<int32_t> dst(src.size());
+  transpose_convert(kernel_isa_t::SCALAR, src.data(),
+                    image_array_element_types::UINT16, dst.data(),
+                    image_array_element_types::INT32, width, height, 0, width);
+
+  bool matches = true;
+  for (uint32_t x = 0; x < width; x++)
+    for (uint32_t y = 0; y < height; y++)
+      matches &= dst[x * height + y] == src[y * width + x];
+  REQUIRE(matches);
+}
+
+TEST_CASE("Narrowing conversions saturate", "[image_kernels]") {
+  uint16_t src[2] = {40000, 300};
+  int16_t to_i16[2];
+  uint8_t to_u8[2];
+
+  transpose_convert(kernel_isa_t::SCALAR, src,
+                    image_array_element_types::UINT16, to_i16,
+                    image_array_element_types::INT16, 2, 1, 0, 2);
+  REQUIRE(to_i16[0] == 32767);
+  REQUIRE(to_i16[1] == 300);
+
+  transpose_convert(kernel_isa_t::SCALAR, src,
+                    image_array_element_types::UINT16, to_u8,
+                    image_array_element_types::BYTE, 2, 1, 0, 2);
+  REQUIRE(to_u8[0] == 255);
+  REQUIRE(to_u8[1] == 255);
+}
+
+TEST_CASE("SIMD kernels match scalar for every element type",
+          "[image_kernels]") {
+  // Odd sizes so the edges that fall outside the 8x8 blocks are covered
+  const uint32_t width = 203;
+  const uint32_t height = 77;
+  auto src_u16 = make_u16_frame(width, height);
+  auto src_u8 = make_u8_frame(width, height);
+
+  for (auto src_type :
+       {image_array_element_types::BYTE, image_array_element_types::UINT16}) {
+    const void *src = src_type == image_array_element_types::BYTE
+                          ? static_cast<const void *>(src_u8.data())
+                          : static_cast<const void *>(src_u16.data());
+
+    for (auto dst_type : all_element_types) {
+      size_t size = element_size(dst_type) * width * height;
+      std::vector<uint8_t> expected(size);
+      std::vector<uint8_t> actual(size);
+
+      // A band in the middle to check x_begin / x_end handling as well
+      uint32_t x_begin = 17;
+      uint32_t x_end = 190;
+      transpose_convert(kernel_isa_t::SCALAR, src, src_type, expected.data(),
+                        dst_type, width, height, x_begin, x_end);
+      transpose_convert(active_isa(), src, src_type, actual.data(), dst_type,
+                        width, height, x_begin, x_end);
+
+      INFO("src type " << int(src_type) << " dst type " << int(dst_type)
+                       << " isa " << isa_name(active_isa()));
+      REQUIRE(std::memcmp(expected.data(), actual.data(),
+                          element_size(dst_type) * height *
+                              (x_end - x_begin)) == 0);
+    }
+  }
+}
+
+TEST_CASE("find_above matches scalar", "[image_kernels]") {
+  std::vector<uint16_t> row16(1000, 100);
+  std::vector<uint8_t> row8(1000, 10);
+  REQUIRE(find_above(row16.data(), row16.size(), 100) == row16.size());
+  REQUIRE(find_above(row8.data(), row8.size(), 10) == row8.size());
+
+  for (size_t pos : {0, 1, 15, 16, 17, 31, 32, 33, 500, 998, 999}) {
+    row16.assign(1000, 100);
+    row8.assign(1000, 10);
+    row16[pos] = 101;
+    row8[pos] = 11;
+    REQUIRE(find_above(row16.data(), row16.size(), 100) == pos);
+    REQUIRE(find_above(row8.data(), row8.size(), 10) == pos);
+    REQUIRE(find_above(kernel_isa_t::SCALAR, row16.data(), row16.size(),
+                       100) == pos);
+    REQUIRE(find_above(kernel_isa_t::SCALAR, row8.data(), row8.size(), 10) ==
+            pos);
+  }
+
+  // Values with the top bit set still compare as unsigned
+  row16.assign(64, 40000);
+  row16[40] = 40001;
+  REQUIRE(find_above(row16.data(), row16.size(), 40000) == 40);
+  REQUIRE(find_above(row16.data(), row16.size(), 65535) == row16.size());
+}
+
+// These are hidden by default, run them with:
+//   AlpacaHubTests "[image_kernels_benchmark]"
+TEST_CASE("Transpose throughput", "[.][image_kernels_benchmark]") {
+  struct frame_size {
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+  };
+
+  // Roughly QHY183 (20MP), QHY268 (26MP) and QHY600 (61MP)
+  for (auto size : {frame_size{"20MP", 5544, 3694},
+                    frame_size{"26MP", 6280, 4210},
+                    frame_size{"61MP", 9576, 6388}}) {
+    auto src_u16 = make_u16_frame(size.width, size.height);
+    auto src_u8 = make_u8_frame(size.width, size.height);
+    std::vector<int32_t> dst(src_u16.size());
+
+    struct combo {
+      const char *name;
+      image_array_element_types src_type;
+      image_array_element_types dst_type;
+    };
+
+    for (auto c : {combo{"u8->u8", image_array_element_types::BYTE,
+                         image_array_element_types::BYTE},
+                   combo{"u8->i32", image_array_element_types::BYTE,
+                         image_array_element_types::INT32},
+                   combo{"u16->u16", image_array_element_types::UINT16,
+                         image_array_element_types::UINT16},
+                   combo{"u16->i32", image_array_element_types::UINT16,
+                         image_array_element_types::INT32}}) {
+      const void *src = c.src_type == image_array_element_types::BYTE
+                            ? static_cast<const void *>(src_u8.data())
+                            : static_cast<const void *>(src_u16.data());
+
+      for (auto isa : {kernel_isa_t::SCALAR, active_isa()}) {
+        BENCHMARK(std::string(size.name) + " " + c.name + " " +
+                  isa_name(isa)) {
+          transpose_convert(isa, src, c.src_type, dst.data(), c.dst_type,
+                            size.width, size.height, 0, size.width);
+          return dst[1];
+        };
+        if (isa == active_isa())
+          break;
+      }
+    }
+  }
+}
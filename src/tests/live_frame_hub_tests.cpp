@@ -0,0 +1,155 @@
+#include "common/live_frame_hub.hpp"
+#include "common/spsc_ring.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ring rounds up and refuses pushes when full", "[spsc_ring]") {
+  spsc_ring_t<int> ring(3);
+  REQUIRE(ring.capacity() == 4);
+  REQUIRE(ring.empty());
+
+  for (int i = 0; i < 4; i++)
+    REQUIRE(ring.try_push(i));
+  REQUIRE_FALSE(ring.try_push(4));
+  REQUIRE(ring.size() == 4);
+
+  int value = -1;
+  REQUIRE(ring.try_pop(value));
+  REQUIRE(value == 0);
+  REQUIRE(ring.try_push(4));
+  for (int i = 1; i <= 4; i++) {
+    REQUIRE(ring.try_pop(value));
+    REQUIRE(value == i);
+  }
+  REQUIRE_FALSE(ring.try_pop(value));
+}
+
+TEST_CASE("Ring hands everything across threads in order", "[spsc_ring]") {
+  const int item_count = 200000;
+  spsc_ring_t<int> ring(64);
+
+  std::thread producer([&ring]() {
+    for (int i = 0; i < item_count; i++)
+      while (!ring.try_push(i))
+        std::this_thread::yield();
+  });
+
+  bool in_order = true;
+  int value;
+  for (int expected = 0; expected < item_count;) {
+    if (!ring.try_pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order &= value == expected++;
+  }
+  producer.join();
+  REQUIRE(in_order);
+  REQUIRE(ring.empty());
+}
+
+static camera_frame_ptr_t make_live_frame(uint32_t number) {
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->width = number;
+  return frame;
+}
+
+TEST_CASE("Slow subscribers lose frames without affecting others",
+          "[live_frame_hub]") {
+  live_frame_hub_t hub;
+  int fast_notified = 0;
+  auto fast = hub.subscribe(16, [&fast_notified]() { fast_notified++; });
+  auto slow = hub.subscribe(2);
+  REQUIRE(hub.subscriber_count() == 2);
+
+  for (uint32_t i = 0; i < 10; i++)
+    hub.publish(make_live_frame(i));
+
+  camera_frame_ptr_t frame;
+  for (uint32_t i = 0; i < 10; i++) {
+    REQUIRE(fast->try_pop(frame));
+    REQUIRE(frame->width == i);
+  }
+  REQUIRE(fast_notified == 10);
+  REQUIRE(fast->dropped() == 0);
+
+  // The slow one keeps the oldest frames it had room for
+  REQUIRE(slow->try_pop(frame));
+  REQUIRE(frame->width == 0);
+  REQUIRE(slow->try_pop(frame));
+  REQUIRE(frame->width == 1);
+  REQUIRE_FALSE(slow->try_pop(frame));
+  REQUIRE(slow->dropped() == 8);
+}
+
+TEST_CASE("Subscriptions share the hub's queue limit", "[live_frame_hub]") {
+  live_frame_hub_t hub(14);
+  auto first = hub.subscribe(3);
+  REQUIRE(first->depth() == 4);
+  // 10 left, which the ring can only use 8 of
+  auto second = hub.subscribe(64);
+  REQUIRE(second->depth() == 8);
+  auto third = hub.subscribe(64);
+  REQUIRE(third->depth() == 2);
+  REQUIRE_FALSE(hub.subscribe(1));
+
+  // Room again once someone leaves
+  hub.unsubscribe(second);
+  REQUIRE(hub.subscribe(64)->depth() == 8);
+
+  // A new limit only applies to later subscriptions
+  hub.set_max_queued(20);
+  REQUIRE(hub.max_queued() == 20);
+  REQUIRE(hub.subscribe(64)->depth() == 4);
+
+  // And no limit without one
+  live_frame_hub_t unlimited;
+  REQUIRE(unlimited.subscribe(64)->depth() == 64);
+  REQUIRE(unlimited.subscribe(64)->depth() == 64);
+}
+
+TEST_CASE("Closing ends subscriptions and stops delivery",
+          "[live_frame_hub]") {
+  live_frame_hub_t hub;
+  int notified = 0;
+  auto subscription = hub.subscribe(4, [&notified]() { notified++; });
+
+  hub.publish(make_live_frame(1));
+  hub.close_all();
+  REQUIRE(subscription->closed());
+  REQUIRE(notified == 2);
+  REQUIRE(hub.subscriber_count() == 0);
+
+  // Whatever was queued before the close can still be read
+  camera_frame_ptr_t frame;
+  REQUIRE(subscription->try_pop(frame));
+  REQUIRE_FALSE(subscription->try_pop(frame));
+
+  hub.publish(make_live_frame(2));
+  REQUIRE(subscription->empty());
+}
+
+TEST_CASE("Unsubscribing while frames are being published",
+          "[live_frame_hub]") {
+  live_frame_hub_t hub;
+  std::atomic<bool> stop{false};
+  std::thread producer([&]() {
+    uint32_t i = 0;
+    while (!stop)
+      hub.publish(make_live_frame(i++));
+  });
+
+  for (int i = 0; i < 200; i++) {
+    auto subscription = hub.subscribe(2);
+    camera_frame_ptr_t frame;
+    while (!subscription->try_pop(frame))
+      std::this_thread::yield();
+    hub.unsubscribe(subscription);
+  }
+
+  stop = true;
+  producer.join();
+  REQUIRE(hub.subscriber_count() == 0);
+}
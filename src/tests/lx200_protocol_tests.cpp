@@ -0,0 +1,273 @@
+#include "common/lx200_mount_link.hpp"
+#include "common/lx200_protocol.hpp"
+#include "drivers/onstep_commands.hpp"
+#include "drivers/zwo_am5_commands.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+// One call to every cmd_* builder. A new builder needs adding here and to
+// the descriptor table, otherwise send_command_to_mount refuses to send it.
+static std::vector<std::string> every_am5_command() {
+  using namespace zwo_commands;
+  return {cmd_get_version(),
+          cmd_switch_to_eq_mode(),
+          cmd_switch_to_alt_az_mode(),
+          cmd_get_date(),
+          cmd_set_date(1, 2, 24),
+          cmd_set_time(1, 2, 3),
+          cmd_get_time(),
+          cmd_get_sidereal_time(),
+          cmd_get_daylight_savings(),
+          cmd_set_daylight_savings(0),
+          cmd_set_timezone('+', 5),
+          cmd_get_timezone(),
+          cmd_set_latitude('+', 40, 1, 2),
+          cmd_get_latitude(),
+          cmd_set_longitude('-', 105, 1, 2),
+          cmd_get_longitude(),
+          cmd_get_current_cardinal_direction(),
+          cmd_get_target_ra(),
+          cmd_set_target_ra(1, 2, 3),
+          cmd_get_target_dec(),
+          cmd_set_target_dec('+', 1, 2, 3),
+          cmd_get_current_ra(),
+          cmd_get_current_dec(),
+          cmd_get_azimuth(),
+          cmd_get_altitude(),
+          cmd_goto(),
+          cmd_stop_moving(),
+          cmd_set_moving_speed(speed_0_25x),
+          cmd_set_moving_speed(speed_1440x),
+          cmd_set_0_5x_sidereal_rate(),
+          cmd_set_1x_sidereal_rate(),
+          cmd_set_720x_sidereal_rate(),
+          cmd_set_1440x_sidereal_rate(),
+          cmd_set_moving_speed_precise(2.5),
+          cmd_move_towards_east(),
+          cmd_stop_moving_towards_east(),
+          cmd_move_towards_west(),
+          cmd_stop_moving_towards_west(),
+          cmd_move_towards_north(),
+          cmd_stop_moving_towards_north(),
+          cmd_move_towards_south(),
+          cmd_stop_moving_towards_south(),
+          cmd_set_tracking_rate_to_sidereal(),
+          cmd_set_tracking_rate_to_solar(),
+          cmd_set_tracking_rate_to_lunar(),
+          cmd_get_tracking_rate(),
+          cmd_start_tracking(),
+          cmd_stop_tracking(),
+          cmd_get_tracking_status(),
+          cmd_guide('e', 500),
+          cmd_set_guide_rate(0.5),
+          cmd_get_guide_rate(),
+          cmd_set_act_of_crossing_meridian(1, 1, '+', 5),
+          cmd_get_act_of_crossing_meridian(),
+          cmd_sync(),
+          cmd_home_position(),
+          cmd_get_status(),
+          cmd_park(),
+          cmd_set_lat_and_long('+', 40, 1, 2, '-', 105, 1, 2),
+          cmd_get_lat_and_long(),
+          cmd_set_date_time_and_tz(1, 2, 24, 1, 2, 3, '+', 5),
+          cmd_get_date_and_time_and_tz(),
+          cmd_get_target_ra_and_dec(),
+          cmd_get_current_ra_and_dec(),
+          cmd_get_az_and_alt(),
+          cmd_set_target_ra_and_dec_and_goto(1, 2, 3, '+', 4, 5, 6),
+          cmd_set_target_ra_and_dec_and_sync(1, 2, 3, '+', 4, 5, 6),
+          cmd_ascom_ra_followup(),
+          cmd_ascom_dec_followup(),
+          cmd_get_serial_number(),
+          cmd_clear_sync_data()};
+}
+
+// Same again for every builder onstep_commands.hpp declares
+static std::vector<std::string> every_onstep_command() {
+  using namespace onstep_commands;
+  return {cmd_get_version(),
+          cmd_get_date(),
+          cmd_set_date(1, 2, 24),
+          cmd_set_time(1, 2, 3),
+          cmd_get_time(),
+          cmd_get_time_12h(),
+          cmd_get_sidereal_time(),
+          cmd_set_sidereal_time(1, 2, 3),
+          cmd_get_daylight_savings(),
+          cmd_set_daylight_savings(0),
+          cmd_set_timezone('+', 5),
+          cmd_get_timezone(),
+          cmd_set_latitude('+', 40, 1, 2),
+          cmd_get_latitude(),
+          cmd_set_longitude('-', 105, 1, 2),
+          cmd_get_longitude(),
+          cmd_set_site_0_name("home"),
+          cmd_set_site_1_name("dark site"),
+          cmd_set_site_2_name("club"),
+          cmd_set_site_3_name("other"),
+          cmd_get_site_0_name(),
+          cmd_get_site_1_name(),
+          cmd_get_site_2_name(),
+          cmd_get_site_3_name(),
+          cmd_select_site(2),
+          cmd_get_current_cardinal_direction(),
+          cmd_get_target_ra(),
+          cmd_set_target_ra(1, 2, 3),
+          cmd_get_target_dec(),
+          cmd_set_target_dec('+', 1, 2, 3),
+          cmd_set_target_azm(180, 1, 2),
+          cmd_set_target_alt('+', 45, 1, 2),
+          cmd_set_horizon_limit('-', 5),
+          cmd_get_horizon_limit(),
+          cmd_set_overhead_limit(85),
+          cmd_get_overhead_limit(),
+          cmd_get_current_ra(),
+          cmd_get_current_dec(),
+          cmd_get_azimuth(),
+          cmd_get_altitude(),
+          cmd_goto(),
+          cmd_goto_horizontal(),
+          cmd_stop_moving(),
+          cmd_set_moving_speed(speed_0_25x),
+          cmd_set_moving_speed(speed_1440x),
+          cmd_set_0_5x_sidereal_rate(),
+          cmd_set_1x_sidereal_rate(),
+          cmd_set_720x_sidereal_rate(),
+          cmd_set_1440x_sidereal_rate(),
+          cmd_set_moving_speed_precise(2.5),
+          cmd_move_towards_east(),
+          cmd_stop_moving_towards_east(),
+          cmd_move_towards_west(),
+          cmd_stop_moving_towards_west(),
+          cmd_move_towards_north(),
+          cmd_stop_moving_towards_north(),
+          cmd_move_towards_south(),
+          cmd_stop_moving_towards_south(),
+          cmd_set_tracking_rate_to_sidereal(),
+          cmd_set_sidereal_rate_ra(60.16427),
+          cmd_get_sidereal_rate_ra(),
+          cmd_track_sidereal_rate_reset(),
+          cmd_track_rate_increase(),
+          cmd_track_rate_decrease(),
+          cmd_set_tracking_rate_to_solar(),
+          cmd_set_tracking_rate_to_lunar(),
+          cmd_set_tracking_rate_to_king(),
+          cmd_get_tracking_rate(),
+          cmd_start_tracking(),
+          cmd_stop_tracking(),
+          cmd_enable_refraction_rate_tracking(),
+          cmd_disable_refraction_rate_tracking(),
+          cmd_get_tracking_status(),
+          cmd_guide('e', 500),
+          cmd_set_guide_rate(0.5),
+          cmd_get_guide_rate(),
+          cmd_set_act_of_crossing_meridian(1, 1, '+', 5),
+          cmd_get_act_of_crossing_meridian(),
+          cmd_sync(),
+          cmd_home_position(),
+          cmd_set_home(),
+          cmd_get_status(),
+          cmd_park(),
+          cmd_restore_parked_telescope(),
+          cmd_ascom_ra_followup(),
+          cmd_ascom_dec_followup(),
+          cmd_get_serial_number()};
+}
+
+TEST_CASE("Every AM5 command has a protocol descriptor", "[lx200_protocol]") {
+  for (auto &cmd : every_am5_command()) {
+    INFO("command: " << cmd);
+    REQUIRE(zwo_commands::find_descriptor(cmd) != nullptr);
+    REQUIRE(lx200::descriptor_table_t(zwo_commands::descriptors).find(cmd) ==
+            zwo_commands::find_descriptor(cmd));
+  }
+}
+
+TEST_CASE("Every OnStep command has a protocol descriptor",
+          "[lx200_protocol]") {
+  for (auto &cmd : every_onstep_command()) {
+    INFO("command: " << cmd);
+    REQUIRE(onstep_commands::find_descriptor(cmd) != nullptr);
+    REQUIRE(
+        lx200::descriptor_table_t(onstep_commands::descriptors).find(cmd) ==
+        onstep_commands::find_descriptor(cmd));
+  }
+}
+
+TEST_CASE("Both mounts understand the site queries", "[lx200_protocol]") {
+  // lx200::read_site sends these as they are rather than through either
+  // command set's builders
+  REQUIRE(zwo_commands::cmd_get_latitude().view() == ":Gt#");
+  REQUIRE(zwo_commands::cmd_get_longitude().view() == ":Gg#");
+  REQUIRE(zwo_commands::cmd_get_tracking_rate().view() == ":GT#");
+  REQUIRE(onstep_commands::cmd_get_latitude().view() == ":Gt#");
+  REQUIRE(onstep_commands::cmd_get_longitude().view() == ":Gg#");
+  REQUIRE(onstep_commands::cmd_get_tracking_rate().view() == ":GT#");
+}
+
+TEST_CASE("The longest matching prefix wins", "[lx200_protocol]") {
+  using lx200::reply_shape_enum;
+  auto descriptor = onstep_commands::find_descriptor(
+      onstep_commands::cmd_set_act_of_crossing_meridian(1, 1, '+', 5));
+  REQUIRE(descriptor->family == "set_act_of_crossing_meridian");
+  descriptor = onstep_commands::find_descriptor(
+      onstep_commands::cmd_set_sidereal_rate_ra(60.1));
+  REQUIRE(descriptor->family == "set_sidereal_rate_ra");
+
+  descriptor = zwo_commands::find_descriptor(":GMTI#");
+  REQUIRE(descriptor->shape == reply_shape_enum::hash_terminated);
+  descriptor = zwo_commands::find_descriptor(":SMTI01/02/24&01:02:03&+05:00#");
+  REQUIRE(descriptor->shape == reply_shape_enum::single_char);
+  REQUIRE(zwo_commands::find_descriptor(":XX#") == nullptr);
+}
+
+TEST_CASE("Motion commands are told apart from queries", "[lx200_protocol]") {
+  REQUIRE(lx200::moves_mount(
+      zwo_commands::find_descriptor(zwo_commands::cmd_goto())->family));
+  REQUIRE(lx200::moves_mount(onstep_commands::find_descriptor(
+                                 onstep_commands::cmd_goto_horizontal())
+                                 ->family));
+  REQUIRE(lx200::moves_mount(
+      zwo_commands::find_descriptor(zwo_commands::cmd_move_towards_east())
+          ->family));
+  REQUIRE(lx200::moves_mount(zwo_commands::find_descriptor(
+                                 zwo_commands::cmd_stop_moving_towards_south())
+                                 ->family));
+  REQUIRE_FALSE(lx200::moves_mount(
+      zwo_commands::find_descriptor(zwo_commands::cmd_get_current_ra())
+          ->family));
+  REQUIRE_FALSE(lx200::moves_mount(
+      zwo_commands::find_descriptor(zwo_commands::cmd_guide('e', 500))
+          ->family));
+}
+
+TEST_CASE("Reply shapes finish the frame as soon as it's complete",
+          "[lx200_protocol]") {
+  using lx200::reply_shape_enum;
+  REQUIRE_FALSE(
+      lx200::frame_length_for({":Q#", "stop", reply_shape_enum::none}));
+
+  auto single = lx200::frame_length_for(
+      {":Te#", "start_tracking", reply_shape_enum::single_char});
+  REQUIRE(single("") == 0);
+  REQUIRE(single("1") == 1);
+
+  auto hash = lx200::frame_length_for(
+      {":GR#", "get_current_ra", reply_shape_enum::hash_terminated});
+  REQUIRE(hash("12:34") == 0);
+  REQUIRE(hash("12:34:56#1") == 9);
+
+  auto fixed = lx200::frame_length_for(
+      {":X#", "fixed", reply_shape_enum::fixed_length, 4});
+  REQUIRE(fixed("abc") == 0);
+  REQUIRE(fixed("abcde") == 4);
+
+  auto goto_reply = lx200::frame_length_for(
+      {":MS#", "goto", reply_shape_enum::zero_or_hash_terminated});
+  REQUIRE(goto_reply("0") == 1);
+  REQUIRE(goto_reply("e2") == 0);
+  REQUIRE(goto_reply("e2#") == 3);
+  // Error codes with a 0 in them aren't mistaken for success
+  REQUIRE(goto_reply("e10#") == 4);
+}
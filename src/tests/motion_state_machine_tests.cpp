@@ -0,0 +1,113 @@
+#include "common/motion_state_machine.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+motion_config_t test_config() {
+  motion_config_t config;
+  config.start_grace = 50ms;
+  config.settle_time = 30ms;
+  return config;
+}
+
+auto now() { return std::chrono::steady_clock::now(); }
+} // namespace
+
+TEST_CASE("A goto goes through slewing and settling to tracking",
+          "[motion_state_machine]") {
+  motion_state_machine_t motion(test_config());
+  motion.set_tracking(true);
+  REQUIRE(motion.state() == motion_state_enum::tracking);
+
+  motion.begin(motion_kind_enum::slew);
+  REQUIRE(motion.state() == motion_state_enum::slewing);
+  REQUIRE(motion.in_motion());
+
+  motion.observe(now(), true);
+  REQUIRE(motion.state() == motion_state_enum::slewing);
+  motion.observe(now(), false);
+  REQUIRE(motion.state() == motion_state_enum::settling);
+  REQUIRE(motion.in_motion());
+  REQUIRE(motion.next_deadline().has_value());
+
+  // Nothing else calls in, the settle time runs out on its own
+  auto waited_from = now();
+  REQUIRE(motion.wait_until_settled(1s));
+  REQUIRE(now() - waited_from >= 20ms);
+  REQUIRE(motion.state() == motion_state_enum::tracking);
+  REQUIRE_FALSE(motion.in_motion());
+  REQUIRE(motion.summary()["motions"] == 1);
+}
+
+TEST_CASE("Reads from before the goto don't end it",
+          "[motion_state_machine]") {
+  motion_state_machine_t motion(test_config());
+  auto stale = now();
+  motion.begin(motion_kind_enum::slew);
+
+  motion.observe(stale, false);
+  REQUIRE(motion.state() == motion_state_enum::slewing);
+
+  // The mount never says it's moving, after the grace it's taken as there
+  motion.observe(now(), false);
+  REQUIRE(motion.state() == motion_state_enum::slewing);
+  std::this_thread::sleep_for(60ms);
+  motion.observe(now(), false);
+  REQUIRE(motion.state() == motion_state_enum::settling);
+  REQUIRE(motion.wait_until_settled(1s));
+  REQUIRE(motion.state() == motion_state_enum::idle);
+}
+
+TEST_CASE("Waiting gives up and abort wakes waiters",
+          "[motion_state_machine]") {
+  motion_state_machine_t motion(test_config());
+  motion.begin(motion_kind_enum::home);
+  motion.observe(now(), true);
+  REQUIRE_FALSE(motion.wait_until_settled(20ms));
+
+  std::thread aborter([&]() {
+    std::this_thread::sleep_for(20ms);
+    motion.abort();
+  });
+  REQUIRE(motion.wait_until_settled(1s));
+  aborter.join();
+  REQUIRE(motion.summary()["aborted"] == 1);
+  REQUIRE(motion.summary()["motions"] == 0);
+
+  // Moving on its own counts as a slew too
+  motion.observe(now(), true);
+  REQUIRE(motion.state() == motion_state_enum::slewing);
+  motion.set_parked(true);
+  REQUIRE(motion.state() == motion_state_enum::parked);
+  REQUIRE_FALSE(motion.in_motion());
+  motion.set_parked(false);
+  REQUIRE(motion.state() == motion_state_enum::idle);
+}
+
+TEST_CASE("Deferred tracking waits for the mount to come to rest",
+          "[motion_state_machine]") {
+  motion_state_machine_t motion(test_config());
+  motion.begin(motion_kind_enum::slew);
+  motion.observe(now(), true);
+
+  motion.defer_tracking(true, 0ms);
+  REQUIRE_FALSE(motion.take_deferred_tracking());
+  REQUIRE_FALSE(motion.next_deadline());
+
+  motion.observe(now(), false);
+  REQUIRE(motion.wait_until_settled(1s));
+  auto tracking = motion.take_deferred_tracking();
+  REQUIRE(tracking.has_value());
+  REQUIRE(*tracking);
+  REQUIRE_FALSE(motion.take_deferred_tracking());
+
+  motion.defer_tracking(false, 30ms);
+  REQUIRE_FALSE(motion.take_deferred_tracking());
+  auto deadline = motion.next_deadline();
+  REQUIRE(deadline.has_value());
+  std::this_thread::sleep_until(*deadline);
+  REQUIRE(motion.take_deferred_tracking() == false);
+}
@@ -0,0 +1,64 @@
+#include "common/mpsc_queue.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Single producer keeps FIFO order", "[mpsc_queue]") {
+  mpsc_queue_t<int> queue;
+  REQUIRE(queue.empty());
+
+  for (int i = 0; i < 100; i++)
+    queue.push(i);
+
+  int value = -1;
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(queue.try_pop(value));
+    REQUIRE(value == i);
+  }
+  REQUIRE_FALSE(queue.try_pop(value));
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("Move only values", "[mpsc_queue]") {
+  mpsc_queue_t<std::unique_ptr<int>> queue;
+  queue.push(std::make_unique<int>(42));
+
+  std::unique_ptr<int> value;
+  REQUIRE(queue.try_pop(value));
+  REQUIRE(*value == 42);
+}
+
+TEST_CASE("Concurrent producers deliver everything in per producer order",
+          "[mpsc_queue]") {
+  const int producer_count = 4;
+  const int items_per_producer = 20000;
+  mpsc_queue_t<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_count; p++)
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < items_per_producer; i++)
+        queue.push({p, i});
+    });
+
+  std::vector<int> next_expected(producer_count, 0);
+  int received = 0;
+  bool in_order = true;
+  std::pair<int, int> item;
+  while (received < producer_count * items_per_producer) {
+    if (!queue.try_pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order &= item.second == next_expected[item.first];
+    next_expected[item.first] = item.second + 1;
+    received++;
+  }
+
+  for (auto &producer : producers)
+    producer.join();
+
+  REQUIRE(in_order);
+  REQUIRE(queue.empty());
+}
@@ -0,0 +1,92 @@
+#include "drivers/onstep_telescope.hpp"
+#include "stubs/serial_emulators/lx200_mount_emulator.hpp"
+#include "tests/test_helpers.hpp"
+#include <catch2/catch_approx.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+// An OnStep driver connected to an emulated mount. The emulator is declared
+// first so it outlives the driver's serial port.
+struct onstep_on_emulator_t {
+  serial_emulator_t emulator{std::make_unique<lx200_mount_emulator_t>(
+      lx200_mount_emulator_t::flavour_enum::onstep)};
+  onstep_telescope telescope;
+
+  onstep_on_emulator_t() {
+    emulator.with_firmware<lx200_mount_emulator_t>(
+        [](auto &mount) { mount.set_slew_time(200ms); });
+    telescope.set_serial_device(emulator.device_path());
+    telescope.set_connected(true);
+  }
+
+  template <typename fn_t> auto mount(fn_t fn) {
+    return emulator.with_firmware<lx200_mount_emulator_t>(fn);
+  }
+
+  uint64_t count(std::string_view family) {
+    return mount([family](auto &mount) { return mount.count(family); });
+  }
+
+  bool mount_tracking() {
+    return mount([](auto &mount) { return mount.tracking(); });
+  }
+};
+} // namespace
+
+TEST_CASE("OnStep connects to the emulator", "[onstep][set_connected]") {
+  spdlog::set_level(spdlog::level::debug);
+  onstep_on_emulator_t onstep;
+  REQUIRE(onstep.telescope.connected());
+  REQUIRE(onstep.telescope.declination() == Catch::Approx(90.0).margin(1e-3));
+  REQUIRE_FALSE(onstep.telescope.slewing());
+}
+
+TEST_CASE("OnStep refuses commands without a descriptor", "[onstep]") {
+  onstep_on_emulator_t onstep;
+  REQUIRE_THROWS_AS(onstep.telescope.send_command_to_mount(":XX#"),
+                    alpaca_exception);
+  // Batched or not
+  REQUIRE_THROWS_AS(onstep.telescope.send_commands_to_mount(
+                        {onstep_commands::cmd_get_current_ra(), ":XX#"}),
+                    alpaca_exception);
+  REQUIRE(onstep.telescope.send_commands_to_mount(
+                              {onstep_commands::cmd_get_version()})
+              .front() == "On-Step#");
+}
+
+TEST_CASE("OnStep slew finishes where it was sent", "[onstep][slew]") {
+  spdlog::set_level(spdlog::level::debug);
+  onstep_on_emulator_t onstep;
+  onstep.telescope.set_tracking(true);
+
+  onstep.telescope.slew_to_coordinates_async(5.5, 20.25);
+  REQUIRE(onstep.telescope.slewing());
+  REQUIRE(eventually([&] { return !onstep.telescope.slewing(); }));
+  REQUIRE_FALSE(onstep.mount([](auto &mount) { return mount.slewing(); }));
+
+  auto position = onstep.mount([](auto &mount) { return mount.position(); });
+  REQUIRE(position.right_ascension == Catch::Approx(5.5).margin(1e-3));
+  REQUIRE(position.declination == Catch::Approx(20.25).margin(1e-3));
+  REQUIRE(onstep.telescope.right_ascension() ==
+          Catch::Approx(5.5).margin(1e-3));
+  REQUIRE(onstep.telescope.declination() == Catch::Approx(20.25).margin(1e-3));
+
+  // Once the mount has settled the motion poll has nothing left to read
+  auto reads = onstep.count("get_status");
+  std::this_thread::sleep_for(500ms);
+  REQUIRE(onstep.count("get_status") == reads);
+}
+
+TEST_CASE("OnStep tracking reaches the mount", "[onstep][tracking]") {
+  spdlog::set_level(spdlog::level::debug);
+  onstep_on_emulator_t onstep;
+  REQUIRE_FALSE(onstep.telescope.tracking());
+
+  onstep.telescope.set_tracking(true);
+  REQUIRE(onstep.telescope.tracking());
+  REQUIRE(eventually([&] { return onstep.mount_tracking(); }));
+
+  onstep.telescope.set_tracking(false);
+  REQUIRE(eventually([&] { return !onstep.mount_tracking(); }));
+}
@@ -0,0 +1,153 @@
+#include "common/alpaca_exception.hpp"
+#include "common/pulse_guide_scheduler.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Stands in for the mount, remembers what it was sent and when
+struct recorded_pulse_t {
+  char direction;
+  int duration_ms;
+  std::chrono::steady_clock::time_point at;
+};
+
+struct fake_mount_t {
+  std::mutex mtx;
+  std::vector<recorded_pulse_t> pulses;
+
+  pulse_guide_scheduler_t::issue_fn_t issue() {
+    return [this](char direction, int duration_ms) {
+      std::lock_guard lock(mtx);
+      pulses.push_back(
+          {direction, duration_ms, std::chrono::steady_clock::now()});
+    };
+  }
+};
+
+pulse_guide_config_t test_config() {
+  pulse_guide_config_t config;
+  config.max_chunk = 20ms;
+  config.realtime_priority = false;
+  return config;
+}
+} // namespace
+
+TEST_CASE("Long pulses go out in chunks as each runs out",
+          "[pulse_guide_scheduler]") {
+  fake_mount_t mount;
+  pulse_guide_scheduler_t scheduler(mount.issue(), test_config());
+
+  scheduler.submit('e', 50);
+  REQUIRE(scheduler.is_guiding());
+  REQUIRE(scheduler.wait_until_idle(1s));
+  REQUIRE_FALSE(scheduler.is_guiding());
+
+  REQUIRE(mount.pulses.size() == 3);
+  REQUIRE(mount.pulses[0].duration_ms == 20);
+  REQUIRE(mount.pulses[1].duration_ms == 20);
+  REQUIRE(mount.pulses[2].duration_ms == 10);
+  for (size_t i = 1; i < mount.pulses.size(); i++) {
+    REQUIRE(mount.pulses[i].direction == 'e');
+    REQUIRE(mount.pulses[i].at - mount.pulses[i - 1].at >= 20ms);
+  }
+
+  auto stats = scheduler.stats();
+  REQUIRE(stats.pulses == 1);
+  REQUIRE(stats.last_requested_ms == 50);
+  REQUIRE(stats.last_planned_ms == 50);
+  REQUIRE(stats.last_scheduled_ms >= 50);
+  // The third chunk goes out at least two chunks after the first
+  REQUIRE(stats.last_sent_ms >= 40);
+  REQUIRE(stats.last_sent_ms < stats.last_scheduled_ms);
+  uint64_t histogram_total = 0;
+  for (auto count : stats.lateness_histogram)
+    histogram_total += count;
+  REQUIRE(histogram_total == 1);
+  REQUIRE(scheduler.summary().count("late_ms.<1") == 1);
+}
+
+TEST_CASE("Sent comes from the writes, scheduled from the chunk lengths",
+          "[pulse_guide_scheduler]") {
+  // A mount that takes a while to answer each command
+  pulse_guide_scheduler_t scheduler(
+      [](char, int) { std::this_thread::sleep_for(5ms); }, test_config());
+
+  scheduler.submit('w', 10);
+  REQUIRE(scheduler.wait_until_idle(1s));
+
+  auto stats = scheduler.stats();
+  REQUIRE(stats.pulses == 1);
+  REQUIRE(stats.last_scheduled_ms == 10);
+  REQUIRE(stats.last_sent_ms >= 5);
+  REQUIRE(stats.max_write_ms >= 5);
+}
+
+TEST_CASE("RA and Dec pulses run side by side", "[pulse_guide_scheduler]") {
+  fake_mount_t mount;
+  pulse_guide_scheduler_t scheduler(mount.issue(), test_config());
+
+  scheduler.submit('n', 15);
+  scheduler.submit('w', 15);
+  REQUIRE(scheduler.wait_until_idle(1s));
+
+  REQUIRE(mount.pulses.size() == 2);
+  REQUIRE(scheduler.stats().pulses == 2);
+  REQUIRE(scheduler.stats().replaced == 0);
+}
+
+TEST_CASE("A new pulse on a guiding axis replaces the old one",
+          "[pulse_guide_scheduler]") {
+  fake_mount_t mount;
+  pulse_guide_scheduler_t scheduler(mount.issue(), test_config());
+
+  scheduler.submit('s', 200);
+  scheduler.submit('n', 10);
+  REQUIRE(scheduler.wait_until_idle(1s));
+
+  auto stats = scheduler.stats();
+  REQUIRE(stats.replaced == 1);
+  REQUIRE(stats.pulses == 1);
+  REQUIRE(stats.last_requested_ms == 10);
+  REQUIRE(mount.pulses.back().direction == 'n');
+}
+
+TEST_CASE("Duration scale and failures", "[pulse_guide_scheduler]") {
+  auto config = test_config();
+  config.duration_scale = 0.5;
+
+  fake_mount_t mount;
+  pulse_guide_scheduler_t scheduler(mount.issue(), config);
+  scheduler.submit('e', 30);
+  REQUIRE(scheduler.wait_until_idle(1s));
+  REQUIRE(mount.pulses.size() == 1);
+  REQUIRE(mount.pulses[0].duration_ms == 15);
+
+  REQUIRE_THROWS_AS(scheduler.submit('x', 10), alpaca_exception);
+
+  pulse_guide_scheduler_t failing(
+      [](char, int) { throw std::runtime_error("port closed"); }, config);
+  failing.submit('w', 10);
+  REQUIRE(failing.wait_until_idle(1s));
+  REQUIRE(failing.stats().failed == 1);
+  REQUIRE(failing.stats().pulses == 0);
+}
+
+TEST_CASE("Cancel drops running pulses", "[pulse_guide_scheduler]") {
+  fake_mount_t mount;
+  pulse_guide_scheduler_t scheduler(mount.issue(), test_config());
+
+  scheduler.submit('e', 1000);
+  scheduler.cancel();
+  REQUIRE_FALSE(scheduler.is_guiding());
+  REQUIRE(scheduler.wait_until_idle(0ms));
+
+  scheduler.shutdown();
+  scheduler.submit('e', 10);
+  REQUIRE_FALSE(scheduler.is_guiding());
+}
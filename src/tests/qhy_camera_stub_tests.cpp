@@ -0,0 +1,211 @@
+// Runs the real QHY camera driver against the stub SDK, only built with
+// -DALPACAHUB_QHY_SDK_STUB=ON
+#include "drivers/qhy_alpaca_camera.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <qhyccd_stub.h>
+#include <thread>
+
+static std::shared_ptr<qhy_alpaca_camera> connect_stub_camera() {
+  qhy_stub_config_t config;
+  config.width = 320;
+  config.height = 240;
+  config.readout_ms = 5;
+  config.star_count = 20;
+  config.filter_slots = 5;
+  qhy_stub_configure(config);
+
+  qhy_alpaca_camera::InitializeQHYSDK();
+  auto camera_ids = qhy_alpaca_camera::get_connected_cameras();
+  REQUIRE(camera_ids.size() == 1);
+
+  auto camera = std::make_shared<qhy_alpaca_camera>(camera_ids[0]);
+  camera->set_connected(true);
+  return camera;
+}
+
+static bool wait_for_image(qhy_alpaca_camera &camera) {
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!camera.image_ready()) {
+    if (std::chrono::steady_clock::now() > give_up)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST_CASE("Expose and read out a frame", "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  REQUIRE(camera->camera_x_size() == 320);
+  REQUIRE(camera->camera_y_size() == 240);
+
+  SECTION("Full frame") {
+    camera->start_exposure(0.01);
+    REQUIRE(wait_for_image(*camera));
+
+    auto frame = camera->last_frame();
+    REQUIRE(frame->width == 320);
+    REQUIRE(frame->height == 240);
+    REQUIRE(frame->pixel_type == image_array_element_types::UINT16);
+
+    // Background plus stars, so something well above the median
+    std::vector<uint32_t> pixels;
+    for (uint32_t y = 0; y < frame->height; y++)
+      for (uint32_t x = 0; x < frame->width; x++)
+        pixels.push_back(frame->pixel(x, y));
+    std::sort(pixels.begin(), pixels.end());
+    REQUIRE(pixels.front() > 0);
+    REQUIRE(pixels.back() > pixels[pixels.size() / 2] + 10);
+  }
+
+  SECTION("Binned subframe") {
+    // The bin change re-initializes the camera which resets the subframe, so
+    // that has to go out before the subframe is set
+    camera->set_bin_x(2);
+    camera->start_exposure(0.01);
+    REQUIRE(wait_for_image(*camera));
+    REQUIRE(camera->last_frame()->width == 160);
+    REQUIRE(camera->last_frame()->height == 120);
+
+    camera->set_num_x(100);
+    camera->set_num_y(50);
+    camera->start_exposure(0.01);
+    REQUIRE(wait_for_image(*camera));
+
+    auto frame = camera->last_frame();
+    REQUIRE(frame->width == 100);
+    REQUIRE(frame->height == 50);
+  }
+}
+
+TEST_CASE("Unchanged settings are not sent again", "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  camera->start_exposure(0.01);
+  REQUIRE(wait_for_image(*camera));
+
+  auto before = qhy_stub_param_set_count();
+  camera->start_exposure(0.01);
+  REQUIRE(wait_for_image(*camera));
+  REQUIRE(qhy_stub_param_set_count() == before);
+
+  camera->set_gain(camera->gain() + 1);
+  camera->start_exposure(0.01);
+  REQUIRE(wait_for_image(*camera));
+  REQUIRE(qhy_stub_param_set_count() == before + 1);
+}
+
+TEST_CASE("Filter wheel moves", "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  REQUIRE(camera->has_filter_wheel());
+  auto filter_wheel = camera->filter_wheel();
+  REQUIRE(filter_wheel->names().size() == 5);
+  REQUIRE(filter_wheel->position() == 0);
+
+  filter_wheel->set_position(2);
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (filter_wheel->position() != 2 &&
+         std::chrono::steady_clock::now() < give_up)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  REQUIRE(filter_wheel->position() == 2);
+}
+
+TEST_CASE("FrameStats action", "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  REQUIRE_THROWS_AS(camera->invoke_action("FrameStats", {}), alpaca_exception);
+
+  // Long enough for the stub's stars to stand out from the noise
+  camera->start_exposure(1);
+  REQUIRE(wait_for_image(*camera));
+
+  auto stats = nlohmann::json::parse(
+      camera->invoke_action("FrameStats", {{"Parameters", "8"}}));
+  REQUIRE(stats["Width"] == 320);
+  REQUIRE(stats["Height"] == 240);
+  REQUIRE(stats["StarCount"] > 0);
+  REQUIRE(stats["MedianHFR"] > 0);
+  REQUIRE(stats["Histogram"].size() == 8);
+
+  REQUIRE_THROWS_AS(camera->invoke_action("NoSuchAction", {}),
+                    alpaca_exception);
+}
+
+TEST_CASE("Live mode streams a binned crop", "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  // Same as for single frames the bin change resets the subframe
+  camera->set_bin_x(2);
+  camera->start_exposure(0.01);
+  REQUIRE(wait_for_image(*camera));
+  camera->set_num_x(64);
+  camera->set_num_y(48);
+
+  camera->start_live(0.002);
+  REQUIRE(camera->live());
+  // No single frames while live mode is running
+  REQUIRE_THROWS_AS(camera->start_exposure(0.01), alpaca_exception);
+
+  std::atomic<int> notified{0};
+  auto subscription =
+      camera->subscribe_live(64, [&notified]() { notified++; });
+
+  std::vector<camera_frame_ptr_t> frames;
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (frames.size() < 20 && std::chrono::steady_clock::now() < give_up) {
+    camera_frame_ptr_t frame;
+    if (subscription->try_pop(frame))
+      frames.push_back(frame);
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(frames.size() == 20);
+  REQUIRE(notified >= 20);
+  REQUIRE(frames[0]->width == 64);
+  REQUIRE(frames[0]->height == 48);
+  REQUIRE(frames[0]->bin_x == 2);
+
+  camera->stop_live();
+  REQUIRE_FALSE(camera->live());
+  REQUIRE(subscription->closed());
+
+  // And back to single frames
+  camera->start_exposure(0.01);
+  REQUIRE(wait_for_image(*camera));
+  REQUIRE(camera->last_frame()->width == 64);
+}
+
+TEST_CASE("A stalled live reader doesn't starve the others",
+          "[qhy_camera_stub]") {
+  auto camera = connect_stub_camera();
+  camera->set_num_x(64);
+  camera->set_num_y(48);
+  camera->start_live(0.002);
+  // Frames this small don't get anywhere near the live pool's byte budget
+  REQUIRE(camera->live_max_queued() == 64);
+
+  // Never read, it ends up holding every frame it has room for
+  auto stalled = camera->subscribe_live(32, []() {});
+  auto fast = camera->subscribe_live(32, []() {});
+  REQUIRE(stalled->depth() == 32);
+  REQUIRE(fast->depth() == 32);
+  // The other readers already have all the queue there is
+  REQUIRE_THROWS_AS(camera->subscribe_live(2, []() {}), alpaca_exception);
+
+  // Well past what the live pool could hold if the stalled reader's frames
+  // weren't limited
+  int received = 0;
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (received < 300 && std::chrono::steady_clock::now() < give_up) {
+    camera_frame_ptr_t frame;
+    if (fast->try_pop(frame))
+      received++;
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  REQUIRE(received == 300);
+  REQUIRE(fast->dropped() == 0);
+  REQUIRE(stalled->dropped() > 0);
+
+  camera->stop_live();
+}
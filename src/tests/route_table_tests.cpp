@@ -0,0 +1,69 @@
+#include "common/route_table.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include <string>
+
+TEST_CASE("The route table finds handlers by method, type and action",
+          "[route_table]") {
+  route_table_t<int> table;
+  REQUIRE(table.add(route_method_enum::get, "camera", "gain", 1));
+  REQUIRE(table.add(route_method_enum::put, "camera", "gain", 2));
+  REQUIRE(table.add(route_method_enum::get, "focuser", "position", 3));
+  REQUIRE(table.size() == 3);
+
+  REQUIRE(*table.find(route_method_enum::get, "camera", "gain") == 1);
+  REQUIRE(*table.find(route_method_enum::put, "camera", "gain") == 2);
+  REQUIRE(*table.find(route_method_enum::get, "focuser", "position") == 3);
+
+  REQUIRE(table.find(route_method_enum::put, "focuser", "position") ==
+          nullptr);
+  REQUIRE(table.find(route_method_enum::get, "rotator", "position") ==
+          nullptr);
+  REQUIRE(table.find(route_method_enum::get, "camera", "gains") == nullptr);
+  REQUIRE(table.find(route_method_enum::get, "camer", "againe") == nullptr);
+  REQUIRE(table.find(route_method_enum::get, "", "") == nullptr);
+}
+
+TEST_CASE("The route table ignores case like the express router did",
+          "[route_table]") {
+  route_table_t<int> table;
+  table.add(route_method_enum::get, "camera", "CameraState", 1);
+
+  REQUIRE(*table.find(route_method_enum::get, "camera", "camerastate") == 1);
+  REQUIRE(*table.find(route_method_enum::get, "Camera", "CAMERASTATE") == 1);
+}
+
+TEST_CASE("The first route added wins", "[route_table]") {
+  route_table_t<int> table;
+  REQUIRE(table.add(route_method_enum::get, "switch", "maxswitch", 1));
+  REQUIRE_FALSE(table.add(route_method_enum::get, "switch", "maxswitch", 2));
+  REQUIRE(table.size() == 1);
+  REQUIRE(*table.find(route_method_enum::get, "switch", "maxswitch") == 1);
+}
+
+TEST_CASE("The route table keeps every route as it grows",
+          "[route_table]") {
+  route_table_t<std::string> table;
+  const char *types[] = {"camera",  "filterwheel", "focuser",
+                         "rotator", "switch",      "telescope"};
+
+  // About as many as the server has
+  for (auto type : types)
+    for (int i = 0; i < 50; i++)
+      REQUIRE(table.add(route_method_enum::get, type,
+                        fmt::format("action{}", i),
+                        fmt::format("{}/{}", type, i)));
+  REQUIRE(table.size() == 300);
+
+  for (auto type : types)
+    for (int i = 0; i < 50; i++) {
+      auto found = table.find(route_method_enum::get, type,
+                              fmt::format("action{}", i));
+      REQUIRE(found != nullptr);
+      REQUIRE(*found == fmt::format("{}/{}", type, i));
+    }
+
+  REQUIRE(table.find(route_method_enum::get, "camera", "action50") ==
+          nullptr);
+  REQUIRE(table.max_probe() < 16);
+}
@@ -0,0 +1,257 @@
+#include "common/lx200_codec.hpp"
+#include "common/serial_reactor.hpp"
+#include "drivers/onstep_commands.hpp"
+#include "drivers/pegasus_alpaca_focuscube3.hpp"
+#include "drivers/pegasus_alpaca_ppba.hpp"
+#include "drivers/primaluce_focuser_rotator.hpp"
+#include "drivers/zwo_am5_commands.hpp"
+#include "stubs/serial_emulators/lx200_mount_emulator.hpp"
+#include "stubs/serial_emulators/pegasus_emulator.hpp"
+#include "stubs/serial_emulators/primaluce_emulator.hpp"
+#include "stubs/serial_emulators/qhy_cfw_emulator.hpp"
+#include "tests/test_helpers.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Sends cmd the way the mount drivers do, with the reply shape from the table
+template <typename find_t>
+alpaca_hub_serial::serial_reply_t
+send_lx200(alpaca_hub_serial::serial_channel_ptr_t &channel,
+           const find_t &find, std::string_view cmd) {
+  auto descriptor = find(cmd);
+  REQUIRE(descriptor);
+  return channel->transact(
+      {std::string(cmd), lx200::frame_length_for(*descriptor), 500ms});
+}
+
+auto am5_find = [](std::string_view cmd) {
+  return zwo_commands::find_descriptor(cmd);
+};
+auto onstep_find = [](std::string_view cmd) {
+  return onstep_commands::find_descriptor(cmd);
+};
+} // namespace
+
+TEST_CASE("AM5 emulator slews, syncs and tracks", "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<lx200_mount_emulator_t>(
+      lx200_mount_emulator_t::flavour_enum::am5));
+  emulator.with_firmware<lx200_mount_emulator_t>(
+      [](auto &mount) { mount.set_slew_time(100ms); });
+
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(emulator.device_path(), 9600);
+
+  REQUIRE(send_lx200(channel, am5_find, ":GAT#").frame == "0#");
+  REQUIRE(send_lx200(channel, am5_find, ":Te#").frame == "1");
+  REQUIRE(send_lx200(channel, am5_find, ":GAT#").frame == "1#");
+
+  auto goto_cmd = zwo_commands::cmd_set_target_ra_and_dec_and_goto(
+      5, 30, 0, '+', 20, 15, 0);
+  REQUIRE(send_lx200(channel, am5_find, goto_cmd).frame == "0");
+  auto status = send_lx200(channel, am5_find, ":GU#").frame;
+  REQUIRE(status.substr(status.size() - 2) == "4#");
+
+  std::this_thread::sleep_for(150ms);
+  status = send_lx200(channel, am5_find, ":GU#").frame;
+  REQUIRE(status.substr(status.size() - 2) == "0#");
+  auto ra = lx200::parse_hh_mm_ss_response(
+      send_lx200(channel, am5_find, ":GR#").frame);
+  REQUIRE(ra.hh == 5);
+  REQUIRE(ra.mm == 30);
+  auto dec = lx200::parse_sdd_mm_ss_response(
+      send_lx200(channel, am5_find, ":GD#").frame);
+  REQUIRE(dec.as_decimal() == 20.25);
+
+  auto sync_cmd = zwo_commands::cmd_set_target_ra_and_dec_and_sync(
+      6, 0, 0, '-', 10, 0, 0);
+  REQUIRE(send_lx200(channel, am5_find, sync_cmd).frame == "N/A#");
+  auto ra_and_dec = send_lx200(channel, am5_find, ":GMEQ#").frame;
+  REQUIRE(ra_and_dec == "06:00:00&-10*00:00#");
+
+  // Home reports 2 on the way and H once there
+  REQUIRE(send_lx200(channel, am5_find, ":hC#").frame.empty());
+  status = send_lx200(channel, am5_find, ":GU#").frame;
+  REQUIRE(status.substr(status.size() - 2) == "2#");
+  std::this_thread::sleep_for(150ms);
+  REQUIRE(send_lx200(channel, am5_find, ":GU#").frame.find('H') !=
+          std::string::npos);
+
+  REQUIRE(emulator.with_firmware<lx200_mount_emulator_t>(
+              [](auto &mount) { return mount.count("get_status"); }) == 4);
+  channel->close();
+}
+
+TEST_CASE("OnStep emulator answers a batch in order", "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<lx200_mount_emulator_t>(
+      lx200_mount_emulator_t::flavour_enum::onstep));
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(emulator.device_path(), 9600);
+
+  REQUIRE(send_lx200(channel, onstep_find, ":GVP#").frame == "On-Step#");
+
+  std::vector<alpaca_hub_serial::serial_request_t> batch;
+  for (auto cmd : {":Gt#", ":Gg#", ":GT#", ":GG#"})
+    batch.push_back(
+        {cmd, lx200::frame_length_for(*onstep_find(cmd)), 500ms});
+  auto replies = channel->transact_batch(std::move(batch));
+  REQUIRE(replies.size() == 4);
+  REQUIRE(lx200::parse_sdd_mm_ss_response(replies[0].frame).as_decimal() ==
+          40);
+  REQUIRE(replies[1].frame == "+074*00:00#");
+  REQUIRE(lx200::parse_standard_response(replies[2].frame) == 0);
+  REQUIRE(lx200::parse_shh_mm_response(replies[3].frame).hh == 0);
+  channel->close();
+}
+
+TEST_CASE("Link latency and dropped replies", "[serial_emulator]") {
+  emulator_link_config_t link;
+  link.reply_latency = 20ms;
+  link.jitter = 5ms;
+  serial_emulator_t emulator(std::make_unique<lx200_mount_emulator_t>(
+                                 lx200_mount_emulator_t::flavour_enum::am5),
+                             link);
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(emulator.device_path(), 9600);
+
+  auto started = std::chrono::steady_clock::now();
+  REQUIRE(send_lx200(channel, am5_find, ":GR#").complete);
+  REQUIRE(std::chrono::steady_clock::now() - started >= 20ms);
+
+  link.reply_latency = 0ms;
+  link.jitter = 0ms;
+  link.drop_probability = 1;
+  emulator.configure(link);
+  auto reply = channel->transact(
+      {":GR#", lx200::frame_length_for(*am5_find(":GR#")), 50ms});
+  REQUIRE_FALSE(reply.complete);
+
+  auto stats = emulator.stats();
+  REQUIRE(stats.commands == 2);
+  REQUIRE(stats.replies == 1);
+  REQUIRE(stats.dropped == 1);
+  REQUIRE(stats.bytes_in == 8);
+  REQUIRE(stats.bytes_out == 9);
+  channel->close();
+}
+
+TEST_CASE("A reply that turns up after its timeout isn't taken for the next",
+          "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<lx200_mount_emulator_t>(
+      lx200_mount_emulator_t::flavour_enum::am5));
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  auto config = channel->latency().config();
+  config.min_samples = 1;
+  channel->latency().configure(config);
+  channel->open(emulator.device_path(), 9600);
+
+  auto get_ra = [&]() {
+    alpaca_hub_serial::serial_request_t request{
+        ":GR#", lx200::frame_length_for(*am5_find(":GR#")), 1000ms};
+    request.family = "get_current_ra";
+    return channel->transact(std::move(request));
+  };
+  // A quick reply and the adaptive timeout drops to a few ms
+  REQUIRE(get_ra().complete);
+
+  emulator_link_config_t link;
+  link.reply_latency = 100ms;
+  emulator.configure(link);
+  auto late = get_ra();
+  REQUIRE_FALSE(late.complete);
+  REQUIRE(late.error == asio::error::timed_out);
+
+  // The RA reply is still on its way while this goes out
+  emulator.configure({});
+  auto reply = send_lx200(channel, am5_find, ":GD#");
+  REQUIRE(reply.complete);
+  REQUIRE(lx200::parse_sdd_mm_ss_response(reply.frame).as_decimal() == 90);
+  // And everything lines up again afterwards
+  reply = send_lx200(channel, am5_find, ":GR#");
+  REQUIRE(lx200::parse_hh_mm_ss_response(reply.frame).hh < 24);
+  reply = send_lx200(channel, am5_find, ":GD#");
+  REQUIRE(lx200::parse_sdd_mm_ss_response(reply.frame).as_decimal() == 90);
+  channel->close();
+}
+
+TEST_CASE("QHY CFW emulator only answers a move once it's there",
+          "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<qhy_cfw_emulator_t>(5));
+  emulator.with_firmware<qhy_cfw_emulator_t>(
+      [](auto &wheel) { wheel.set_time_per_slot(30ms); });
+  auto channel =
+      alpaca_hub_serial::serial_reactor::instance().make_channel(false);
+  channel->open(emulator.device_path(), 9600);
+
+  REQUIRE(channel->transact({"VRS", alpaca_hub_serial::fixed_length(8)})
+              .frame.size() == 8);
+  REQUIRE(channel->transact({"MXP", alpaca_hub_serial::fixed_length(1)})
+              .frame == "5");
+
+  auto started = std::chrono::steady_clock::now();
+  REQUIRE(channel->transact({"2", alpaca_hub_serial::fixed_length(1)})
+              .frame == "2");
+  REQUIRE(std::chrono::steady_clock::now() - started >= 60ms);
+  REQUIRE(channel->transact({"NOW", alpaca_hub_serial::fixed_length(1)})
+              .frame == "2");
+  channel->close();
+}
+
+TEST_CASE("PPBA driver against the emulator", "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<ppba_emulator_t>());
+  pegasus_alpaca_ppba ppba;
+  ppba.set_serial_device(emulator.device_path());
+  ppba.set_connected(true);
+
+  REQUIRE(eventually([&]() { return ppba.get_switch_value(INPUT_VOLTAGE) > 12; }));
+  REQUIRE(ppba.get_switch(QUAD12V_ON_OFF));
+
+  ppba.set_switch(QUAD12V_ON_OFF, false);
+  REQUIRE_FALSE(emulator.with_firmware<ppba_emulator_t>(
+      [](auto &box) { return box.quadport_on(); }));
+  REQUIRE(eventually([&]() { return !ppba.get_switch(QUAD12V_ON_OFF); }));
+  ppba.set_connected(false);
+}
+
+TEST_CASE("FocusCube3 driver against the emulator", "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<focuscube3_emulator_t>());
+  pegasus_alpaca_focuscube3 focuser;
+  focuser.set_serial_device(emulator.device_path());
+  focuser.set_connected(true);
+
+  REQUIRE(eventually([&]() { return focuser.position() == 25000; }));
+  focuser.move(25400);
+  REQUIRE(eventually([&]() {
+    return focuser.position() == 25400 && !focuser.is_moving();
+  }));
+  focuser.set_connected(false);
+}
+
+TEST_CASE("Esatto and ARCO drivers against the emulator",
+          "[serial_emulator]") {
+  serial_emulator_t emulator(std::make_unique<esatto_emulator_t>(true));
+  emulator.with_firmware<esatto_emulator_t>(
+      [](auto &esatto) { esatto.set_speeds(20000, 360); });
+
+  esatto_focuser focuser(emulator.device_path());
+  focuser.set_connected(true);
+  focuser.init_rotator();
+  REQUIRE(focuser.arco_present());
+  auto rotator = focuser.rotator();
+  rotator->set_connected(true);
+
+  focuser.move(31000);
+  rotator->moveabsolute(90);
+  REQUIRE(eventually([&]() {
+    return focuser.position() == 31000 && rotator->position() == 90 &&
+           !focuser.is_moving();
+  }));
+
+  rotator->sync(100);
+  REQUIRE(eventually([&]() { return rotator->position() == 100; }));
+  REQUIRE(rotator->mechanical_position() == 90);
+  focuser.set_connected(false);
+}
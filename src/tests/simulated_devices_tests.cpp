@@ -0,0 +1,228 @@
+#include "common/frame_stats.hpp"
+#include "drivers/simulated_camera.hpp"
+#include "drivers/simulated_filterwheel.hpp"
+#include "drivers/simulated_focuser.hpp"
+#include "drivers/simulated_rotator.hpp"
+#include "drivers/simulated_switch.hpp"
+#include "drivers/simulated_telescope.hpp"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Polls until done says so or it gives up
+bool wait_for(const std::function<bool()> &done,
+              std::chrono::milliseconds timeout = 5s) {
+  auto give_up_at = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() >= give_up_at)
+      return false;
+    std::this_thread::sleep_for(5ms);
+  }
+  return true;
+}
+
+simulated_camera_config_t small_camera() {
+  simulated_camera_config_t config;
+  config.width = 640;
+  config.height = 480;
+  config.star_count = 40;
+  config.readout_time = 20ms;
+  return config;
+}
+
+simulated_telescope_config_t fast_mount() {
+  simulated_telescope_config_t config;
+  config.slew_rate = 60;
+  config.acceleration = 120;
+  return config;
+}
+} // namespace
+
+TEST_CASE("The simulated camera exposes, reads out and renders stars",
+          "[simulated_devices]") {
+  simulated_camera camera(small_camera());
+  REQUIRE_THROWS_AS(camera.start_exposure(0.05), alpaca_exception);
+  camera.set_connected(true);
+
+  auto started = std::chrono::steady_clock::now();
+  camera.start_exposure(0.05);
+  REQUIRE(camera.camera_state() ==
+          i_alpaca_camera::camera_state_enum::CAMERA_EXPOSING);
+  REQUIRE_THROWS_AS(camera.start_exposure(0.05), alpaca_exception);
+
+  REQUIRE(wait_for([&camera]() { return camera.image_ready(); }));
+  REQUIRE(std::chrono::steady_clock::now() - started >= 50ms);
+  REQUIRE(camera.camera_state() ==
+          i_alpaca_camera::camera_state_enum::CAMERA_IDLE);
+  REQUIRE(camera.frame_count() == 1);
+
+  auto frame = camera.last_frame();
+  REQUIRE(frame->width == 640);
+  REQUIRE(frame->height == 480);
+
+  worker_pool_t pool(2);
+  auto stats = compute_frame_stats(*frame, pool);
+  REQUIRE(stats.star_count > 0);
+  REQUIRE(stats.max > stats.background);
+}
+
+TEST_CASE("Aborting a simulated exposure throws the frame away",
+          "[simulated_devices]") {
+  simulated_camera camera(small_camera());
+  camera.set_connected(true);
+
+  camera.start_exposure(5);
+  camera.abort_exposure();
+  REQUIRE(wait_for([&camera]() {
+    return camera.camera_state() ==
+           i_alpaca_camera::camera_state_enum::CAMERA_IDLE;
+  }));
+  REQUIRE_FALSE(camera.image_ready());
+  REQUIRE(camera.frame_count() == 0);
+}
+
+TEST_CASE("The simulated mount takes time to slew and ends up on target",
+          "[simulated_devices]") {
+  simulated_telescope mount(fast_mount());
+  mount.set_connected(true);
+  REQUIRE_FALSE(mount.at_park());
+
+  // Gotos need tracking on, like the AM5
+  REQUIRE_THROWS_AS(mount.slew_to_coordinates_async(1, 10),
+                    alpaca_exception);
+  mount.set_tracking(true);
+
+  double ra = std::fmod(mount.sidereal_time() + 1, 24.0);
+  mount.slew_to_coordinates_async(ra, 30);
+  REQUIRE(mount.slewing());
+  REQUIRE(wait_for([&mount]() { return !mount.slewing(); }));
+  REQUIRE(mount.right_ascension() == Catch::Approx(ra).margin(1e-4));
+  REQUIRE(mount.declination() == Catch::Approx(30).margin(1e-4));
+  REQUIRE(mount.side_of_pier() == pier_side_enum::west);
+
+  mount.sync_to_coordinates(std::fmod(ra + 0.5, 24.0), 31);
+  REQUIRE(mount.right_ascension() ==
+          Catch::Approx(std::fmod(ra + 0.5, 24.0)).margin(1e-4));
+  REQUIRE(mount.declination() == Catch::Approx(31).margin(1e-4));
+}
+
+TEST_CASE("Pulse guiding the simulated mount nudges it at the guide rate",
+          "[simulated_devices]") {
+  simulated_telescope mount(fast_mount());
+  mount.set_connected(true);
+  mount.set_tracking(true);
+  mount.sync_to_coordinates(5, 20);
+
+  mount.pulse_guide(guide_direction_enum::guide_north, 100);
+  REQUIRE(mount.is_pulse_guiding());
+  REQUIRE(wait_for([&mount]() { return !mount.is_pulse_guiding(); }));
+  REQUIRE(mount.declination() ==
+          Catch::Approx(20 + mount.guide_rate_declination() * 0.1)
+              .margin(1e-9));
+}
+
+TEST_CASE("The simulated mount parks and won't move until unparked",
+          "[simulated_devices]") {
+  simulated_telescope mount(fast_mount());
+  mount.set_connected(true);
+  mount.set_tracking(true);
+  mount.sync_to_coordinates(5, 20);
+
+  mount.park();
+  REQUIRE(mount.at_park());
+  REQUIRE_FALSE(mount.tracking());
+  REQUIRE(mount.declination() == Catch::Approx(90));
+  REQUIRE_THROWS_AS(mount.slew_to_coordinates_async(5, 20),
+                    alpaca_exception);
+
+  mount.unpark();
+  REQUIRE_FALSE(mount.at_park());
+  mount.set_tracking(true);
+  mount.slew_to_coordinates_async(5, 20);
+  mount.abort_slew();
+  REQUIRE_FALSE(mount.slewing());
+}
+
+TEST_CASE("The simulated focuser moves at its speed and halts",
+          "[simulated_devices]") {
+  simulated_focuser_config_t config;
+  config.start_position = 1000;
+  simulated_focuser focuser(config);
+  focuser.set_connected(true);
+  REQUIRE(focuser.position() == 1000);
+  REQUIRE_THROWS_AS(focuser.move(config.max_step + 1), alpaca_exception);
+
+  focuser.move(1200);
+  REQUIRE(focuser.is_moving());
+  REQUIRE(wait_for([&focuser]() { return !focuser.is_moving(); }));
+  REQUIRE(focuser.position() == 1200);
+
+  focuser.move(20000);
+  std::this_thread::sleep_for(50ms);
+  focuser.halt();
+  REQUIRE_FALSE(focuser.is_moving());
+  auto halted_at = focuser.position();
+  REQUIRE(halted_at > 1200);
+  REQUIRE(halted_at < 20000);
+}
+
+TEST_CASE("The simulated filter wheel reports -1 while it turns",
+          "[simulated_devices]") {
+  simulated_filterwheel_config_t config;
+  config.slot_time = 20ms;
+  simulated_filterwheel wheel(config);
+  wheel.set_connected(true);
+  REQUIRE(wheel.position() == 0);
+  REQUIRE(wheel.names().size() == wheel.focus_offsets().size());
+
+  wheel.set_position(3);
+  REQUIRE(wheel.position() == -1);
+  REQUIRE(wait_for([&wheel]() { return wheel.position() != -1; }));
+  REQUIRE(wheel.position() == 3);
+  REQUIRE_THROWS_AS(wheel.set_position(7), alpaca_exception);
+}
+
+TEST_CASE("The simulated rotator syncs and turns the short way",
+          "[simulated_devices]") {
+  simulated_rotator_config_t config;
+  config.speed = 360;
+  config.acceleration = 3600;
+  simulated_rotator rotator(config);
+  rotator.set_connected(true);
+
+  rotator.sync(350);
+  REQUIRE(rotator.position() == Catch::Approx(350));
+  REQUIRE(rotator.mechanical_position() == Catch::Approx(0));
+
+  rotator.moveabsolute(10);
+  REQUIRE(rotator.target_position() == Catch::Approx(10));
+  REQUIRE(wait_for([&rotator]() { return !rotator.is_moving(); }));
+  REQUIRE(rotator.position() == Catch::Approx(10));
+  REQUIRE(rotator.mechanical_position() == Catch::Approx(20));
+}
+
+TEST_CASE("The simulated switch draws more current with the heaters on",
+          "[simulated_devices]") {
+  simulated_switch power_box;
+  power_box.set_connected(true);
+  REQUIRE(power_box.max_switch() > 0);
+
+  uint32_t dew_a = 0;
+  while (power_box.get_switch_name(dew_a) != "Dew Heater A")
+    dew_a++;
+  double idle_current = power_box.get_switch_value(1);
+
+  power_box.set_switch_value(dew_a, 255);
+  REQUIRE(power_box.get_switch(dew_a));
+  REQUIRE(power_box.get_switch_value(1) > idle_current);
+  REQUIRE_FALSE(power_box.can_write(1));
+  REQUIRE_THROWS_AS(power_box.set_switch_value(1, 2), alpaca_exception);
+  REQUIRE_THROWS_AS(power_box.set_switch_value(dew_a, 300),
+                    alpaca_exception);
+}
@@ -0,0 +1,21 @@
+#ifndef TEST_HELPERS_HPP
+#define TEST_HELPERS_HPP
+
+#include <chrono>
+#include <thread>
+
+// The drivers poll on their own schedule, wait for them to catch up. False
+// if done() still isn't true after timeout.
+template <typename fn_t>
+bool eventually(fn_t done,
+                std::chrono::milliseconds timeout = std::chrono::seconds(3)) {
+  auto give_up_at = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > give_up_at)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+#endif
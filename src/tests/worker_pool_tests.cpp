@@ -0,0 +1,70 @@
+#include "common/worker_pool.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("parallel_for visits every index once", "[worker_pool]") {
+  worker_pool_t pool(3);
+  std::vector<std::atomic<int>> visits(1000);
+  pool.parallel_for(visits.size(), [&](size_t i) { visits[i]++; });
+  for (auto &v : visits)
+    REQUIRE(v == 1);
+}
+
+TEST_CASE("parallel_for with no pool threads runs on the caller",
+          "[worker_pool]") {
+  worker_pool_t pool(0);
+  int sum = 0;
+  pool.parallel_for(10, [&](size_t i) { sum += i; });
+  REQUIRE(sum == 45);
+}
+
+TEST_CASE("parallel_for rethrows after finishing", "[worker_pool]") {
+  worker_pool_t pool(2);
+  std::atomic<int> ran{0};
+  REQUIRE_THROWS_AS(pool.parallel_for(50,
+                                      [&](size_t i) {
+                                        ran++;
+                                        if (i == 7)
+                                          throw std::runtime_error("boom");
+                                      }),
+                    std::runtime_error);
+  REQUIRE(ran == 50);
+}
+
+TEST_CASE("parallel_for from inside a pool task doesn't deadlock",
+          "[worker_pool]") {
+  worker_pool_t pool(2);
+  std::vector<std::promise<int>> results(4);
+  for (auto &result : results)
+    pool.submit([&pool, &result]() {
+      std::atomic<int> sum{0};
+      pool.parallel_for(100, [&](size_t i) { sum += i; });
+      result.set_value(sum);
+    });
+
+  for (auto &result : results)
+    REQUIRE(result.get_future().get() == 4950);
+}
+
+TEST_CASE("grow adds threads for tasks that block", "[worker_pool]") {
+  worker_pool_t pool(1);
+  pool.grow(3);
+  REQUIRE(pool.concurrency() == 4);
+  pool.grow(2);
+  REQUIRE(pool.concurrency() == 4);
+
+  // Two tasks stuck waiting don't stop a third from running
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  for (int i = 0; i < 2; i++)
+    pool.submit([released]() { released.wait(); });
+  std::promise<void> ran;
+  pool.submit([&ran]() { ran.set_value(); });
+  REQUIRE(ran.get_future().wait_for(std::chrono::seconds(2)) ==
+          std::future_status::ready);
+  release.set_value();
+}
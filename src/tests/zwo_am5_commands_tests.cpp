@@ -126,3 +126,51 @@ TEST_CASE("Construction of ddd_mm_ss from double",
 
   spdlog::info("using formatter converted: {0} to {1}", val, converted);
 }
+
+TEST_CASE("Replies are scanned in place", "[lx200_codec]") {
+  using namespace zwo_responses;
+  // Anything after the # is left for whoever reads next, same as the regexes
+  REQUIRE(parse_hh_mm_ss_response("12:10:34#1#").ss == 34);
+  REQUIRE(parse_standard_response("1#junk") == 1);
+
+  // from_chars on its own would take these
+  REQUIRE_THROWS_AS(parse_hh_mm_ss_response("-2:10:34#"), alpaca_exception);
+  REQUIRE_THROWS_AS(parse_sdd_mm_response("+4*30#"), alpaca_exception);
+  REQUIRE_THROWS_AS(parse_sdd_mm_response("++4*30#"), alpaca_exception);
+  REQUIRE_THROWS_AS(parse_hh_mm_ss_response(""), alpaca_exception);
+
+  try {
+    parse_mm_dd_yy_response("04/10#");
+    FAIL("expected a parse error");
+  } catch (alpaca_exception &ex) {
+    REQUIRE(ex.error_code() == alpaca_exception::INVALID_VALUE);
+  }
+
+  auto lat_and_long = parse_sdd_mm_and_sddd_mm_response("+40*30&-105*20#");
+  REQUIRE(lat_and_long.sdd_mm_data.as_decimal() == 40.5);
+  REQUIRE(lat_and_long.sddd_mm_data.plus_or_minus == '-');
+  REQUIRE(lat_and_long.sddd_mm_data.ddd == 105);
+  REQUIRE(lat_and_long.sddd_mm_data.mm == 20);
+  REQUIRE_THROWS_AS(parse_sdd_mm_and_sddd_mm_response("+40*30#"),
+                    alpaca_exception);
+  REQUIRE_THROWS_AS(parse_sdd_mm_and_sddd_mm_response("+40*3&-105*20#"),
+                    alpaca_exception);
+}
+
+TEST_CASE("Commands are built in a fixed buffer", "[lx200_codec]") {
+  constexpr lx200::command_t version(":GV#");
+  static_assert(version.size() == 4);
+  REQUIRE(zwo_commands::cmd_get_version() == version);
+  REQUIRE(zwo_commands::cmd_set_target_ra(4, 38, 51) == ":Sr04:38:51#");
+  REQUIRE(zwo_commands::cmd_set_target_dec('-', 5, 6, 7) == ":Sd-05:06:07#");
+  REQUIRE(fmt::format("{}", zwo_commands::cmd_guide('n', 500)) == ":Mgn0500#");
+  REQUIRE(std::string(zwo_commands::cmd_get_status()) == ":GU#");
+
+  // Too long for the buffer is a bad value, not a cut off command
+  try {
+    lx200::command_t::format(":SM{}#", std::string(100, 'x'));
+    FAIL("expected the command to be rejected");
+  } catch (alpaca_exception &ex) {
+    REQUIRE(ex.error_code() == alpaca_exception::INVALID_VALUE);
+  }
+}
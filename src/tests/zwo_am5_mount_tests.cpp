@@ -1,258 +1,226 @@
 #include "drivers/zwo_am5_telescope.hpp"
+#include "stubs/serial_emulators/lx200_mount_emulator.hpp"
+#include "tests/test_helpers.hpp"
+#include <catch2/catch_approx.hpp>
 
-// auto format_as(pier_side_enum s) { return fmt::underlying(s); }
-// auto format_as(drive_rate_enum s) { return fmt::underlying(s); }
-// auto format_as(telescope_axes_enum s) { return fmt::underlying(s); }
-// auto format_as(guide_direction_enum s) { return fmt::underlying(s); }
+namespace zwoc = zwo_commands;
+using namespace std::chrono_literals;
+
+namespace {
+// An AM5 driver connected to an emulated mount rather than whatever happens
+// to be plugged into /dev/ttyACM0. The emulator is declared first so it
+// outlives the driver's serial port.
+struct am5_on_emulator_t {
+  serial_emulator_t emulator{std::make_unique<lx200_mount_emulator_t>(
+      lx200_mount_emulator_t::flavour_enum::am5)};
+  zwo_am5_telescope telescope;
 
-// template <typename Duration>
-// inline auto a_localtime(date::local_time<Duration> time) -> std::tm {
-//   return fmt::localtime(
-//       std::chrono::system_clock::to_time_t(date::current_zone()->to_sys(time)));
-// }
+  am5_on_emulator_t() {
+    emulator.with_firmware<lx200_mount_emulator_t>(
+        [](auto &mount) { mount.set_slew_time(200ms); });
+    telescope.set_serial_device(emulator.device_path());
+    telescope.set_connected(true);
+  }
 
-namespace zwoc = zwo_commands;
+  // How many commands of a family the mount has seen
+  uint64_t count(std::string_view family) {
+    return emulator.with_firmware<lx200_mount_emulator_t>(
+        [family](auto &mount) { return mount.count(family); });
+  }
+};
+} // namespace
 
 TEST_CASE("Serial connection attempt", "[set_connected]") {
   spdlog::set_level(spdlog::level::debug);
-  zwo_am5_telescope telescope;
   SECTION("Invalid serial device path") {
+    zwo_am5_telescope telescope;
     telescope.set_serial_device("/dev/ttyARGGWTF");
     REQUIRE_THROWS_AS(telescope.set_connected(true), alpaca_exception);
   }
 
   SECTION("Valid serial device path") {
-    telescope.set_serial_device("/dev/ttyACM0");
-    telescope.set_connected(true);
-    REQUIRE(telescope.connected());
+    am5_on_emulator_t am5;
+    REQUIRE(am5.telescope.connected());
   }
 }
 
 TEST_CASE("Test get version", "[cmd_get_version]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
 
-  auto resp = telescope.send_command_to_mount(zwoc::cmd_get_version());
+  auto resp = am5.telescope.send_command_to_mount(zwoc::cmd_get_version());
   spdlog::debug("Version data returned: {0}", resp);
-  // REQUIRE(telescope.at_home() == true);
+  REQUIRE(resp == "1.0.0#");
 }
 
-// Commenting this out because it moves the scope...
-//  - I need to figure out how to run moving tests separately
 TEST_CASE("Test mount At home", "[at_home]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
-  spdlog::trace("sending cmd_home_position()");
+  am5_on_emulator_t am5;
+  am5.telescope.set_tracking(true);
+  am5.telescope.slew_to_coordinates_async(am5.telescope.sidereal_time(), 20);
+  REQUIRE_FALSE(am5.telescope.at_home());
+  REQUIRE(eventually([&] { return !am5.telescope.slewing(); }));
 
-  // telescope.send_command_to_mount(zwoc::cmd_home_position());
-  telescope.find_home();
-  using namespace std::chrono_literals;
-  // Wait for the mount to home...
-  for (int i = 0; i < 30; i++) {
-    if (telescope.slewing())
-      spdlog::debug("slewing...");
-
-    if (telescope.at_home())
-      break;
-
-    // spdlog::debug("waiting 1 second for mount to settle");
-    // I'm not sure I need this anymore
-    std::this_thread::sleep_for(1000ms);
-  }
-  REQUIRE(telescope.at_home() == true);
+  spdlog::trace("sending cmd_home_position()");
+  am5.telescope.find_home();
+  REQUIRE(eventually([&] { return am5.telescope.at_home(); }));
+  REQUIRE(am5.telescope.declination() == Catch::Approx(90.0).margin(1e-3));
 }
 
 TEST_CASE("Test get azimuth", "[azimuth]") {
-  using namespace std::chrono_literals;
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
 
-  double val = telescope.azimuth();
+  // Home is on the pole, due north
+  double val = am5.telescope.azimuth();
   spdlog::debug("Current azimuth: {0}", val);
-  // REQUIRE(telescope.at_home() == true);
+  REQUIRE((val < 0.1 || val > 359.9));
 }
 
 TEST_CASE("Test get declination", "[declination]") {
-  using namespace std::chrono_literals;
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
 
-  double val = telescope.declination();
+  double val = am5.telescope.declination();
   spdlog::debug("Current declination: {0}", val);
-  // REQUIRE(telescope.at_home() == true);
+  REQUIRE(val == Catch::Approx(90.0).margin(1e-3));
 }
 
 TEST_CASE("Test get right_ascension", "[right_ascension]") {
-  using namespace std::chrono_literals;
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
+  am5.telescope.set_tracking(true);
+  am5.telescope.slew_to_coordinates_async(5.5, 20.25);
+  REQUIRE(eventually([&] { return !am5.telescope.slewing(); }));
 
-  double val = telescope.right_ascension();
+  double val = am5.telescope.right_ascension();
   spdlog::debug("Current right ascension: {0}", val);
-  // REQUIRE(telescope.at_home() == true);
+  REQUIRE(val == Catch::Approx(5.5).margin(1e-3));
 }
 
 TEST_CASE("Test get side_of_pier", "[side_of_pier]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
 
-  using namespace std::chrono_literals;
-  // Wait for the mount to home...
-  pier_side_enum val = telescope.side_of_pier();
+  pier_side_enum val = am5.telescope.side_of_pier();
   spdlog::debug("Current side of pier: {0}", val);
-  // REQUIRE(telescope.at_home() == true);
+  REQUIRE(am5.count("get_current_cardinal_direction") == 1);
 }
 
 TEST_CASE("Test set and get UTC", "[get_and_set_utc_time]") {
   spdlog::set_level(spdlog::level::trace);
-  using namespace std::chrono_literals;
-  auto cur_tz = date::current_zone();
-  spdlog::trace("cur_tz name {}", cur_tz->name());
-  date::sys_info sys_info;
-
-  // Chrono System Clock
-  auto tp = std::chrono::system_clock::now();
-  spdlog::trace("tp raw: {}", tp.time_since_epoch());
-  spdlog::trace("tp:     {:%F %T %Z} ", tp);
-
-  auto tp_zoned_time = date::make_zoned(cur_tz, tp);
-  spdlog::trace("tp_zoned_time: {} ",
-                tp_zoned_time.get_local_time().time_since_epoch());
-  spdlog::trace("tp_zoned_time: {:%F %T %Z}", tp_zoned_time.get_local_time());
-
-  auto l_tp = date::floor<std::chrono::seconds>(cur_tz->to_local(tp));
-  spdlog::trace("l_tp:            {} ", l_tp.time_since_epoch());
-
-  auto l_tp_zoned_time = date::make_zoned(cur_tz, l_tp);
-  spdlog::trace("l_tp_zoned_time: {} ",
-                l_tp_zoned_time.get_local_time().time_since_epoch());
-  spdlog::trace("l_tp_zoned_time: {:%F %T %Z}",
-                l_tp_zoned_time.get_local_time());
-
-  // Date UTC Clock
-  auto u_tp = date::utc_clock::now();
-  auto u_tp_cast = date::clock_cast<date::utc_clock>(u_tp);
-
-  spdlog::trace("u_tp raw:  {}", u_tp.time_since_epoch());
-  spdlog::trace("u_tp_cast: {:%F %T %Z}",
-                fmt::gmtime(date::utc_clock::to_sys(u_tp_cast)));
-
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
 
   // Clear sync data
-  telescope.send_command_to_mount(":NSC#", true, '\0');
+  am5.telescope.send_command_to_mount(zwoc::cmd_clear_sync_data());
 
-  telescope.set_site_latitude(30.33333333333);
-  telescope.set_site_longitude(-98.0);
+  am5.telescope.set_site_latitude(30.33333333333);
+  am5.telescope.set_site_longitude(-98.0);
+  REQUIRE(am5.telescope.site_latitude() ==
+          Catch::Approx(30.3333).margin(1e-3));
+  REQUIRE(am5.telescope.site_longitude() == Catch::Approx(-98.0).margin(1e-3));
 
-  auto utc_date_str = telescope.utc_date();
-  spdlog::debug("TIME ********* ");
-  spdlog::debug(utc_date_str);
-  spdlog::debug("TIME ********* ");
+  auto utc_date_str = am5.telescope.utc_date();
+  spdlog::debug("utc_date: {}", utc_date_str);
+  REQUIRE_FALSE(utc_date_str.empty());
 
+  auto tp = std::chrono::system_clock::now();
   auto set_utc_date_str = fmt::format("{0:%F}T{0:%T}.0000000Z", tp);
   spdlog::debug("calling set_utc_date with: {}", set_utc_date_str);
-  telescope.set_utc_date(set_utc_date_str);
+  am5.telescope.set_utc_date(set_utc_date_str);
+  REQUIRE(am5.count("set_date") == 1);
+  REQUIRE(am5.count("set_time") == 1);
 
-  utc_date_str = telescope.utc_date();
-  spdlog::debug("TIME ********* ");
-  spdlog::debug(utc_date_str);
-  spdlog::debug("TIME ********* ");
-
-  spdlog::debug("SIDEREAL TIME ********* ");
-  auto sidereal_tm = telescope.sidereal_time();
+  auto sidereal_tm = am5.telescope.sidereal_time();
   spdlog::debug("sidereal_tm: {}", sidereal_tm);
-  spdlog::debug("SIDEREAL TIME ********* ");
+  REQUIRE(sidereal_tm >= 0);
+  REQUIRE(sidereal_tm < 24);
 }
 
 TEST_CASE("Test mount get time", "[get_time]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
   spdlog::trace("sending cmd_get_time()");
   std::string status_str =
-      telescope.send_command_to_mount(zwoc::cmd_get_time());
+      am5.telescope.send_command_to_mount(zwoc::cmd_get_time());
   spdlog::debug("cmd_get_time() status_str: {0}", status_str);
+  auto time_data = zwo_responses::parse_hh_mm_ss_response(status_str);
+  REQUIRE(time_data.hh < 24);
 }
 
 TEST_CASE("Test mount get sidereal time", "[get_sidereal_time]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
+  am5_on_emulator_t am5;
   spdlog::trace("sending cmd_get_sidereal_time()");
   std::string status_str =
-      telescope.send_command_to_mount(zwoc::cmd_get_sidereal_time());
+      am5.telescope.send_command_to_mount(zwoc::cmd_get_sidereal_time());
+  auto lst = zwo_responses::parse_hh_mm_ss_response(status_str);
+  REQUIRE(lst.hh < 24);
+
   spdlog::trace("sending cmd_get_timezone()");
-  status_str = telescope.send_command_to_mount(zwoc::cmd_get_timezone());
-  spdlog::trace("sending cmd_get_date()");
-  status_str = telescope.send_command_to_mount(zwoc::cmd_get_date());
-  spdlog::trace("sending cmd_get_time()");
-  status_str = telescope.send_command_to_mount(zwoc::cmd_get_time());
-  spdlog::trace("sending cmd_get_daylight_savings()");
-  status_str =
-      telescope.send_command_to_mount(zwoc::cmd_get_daylight_savings());
+  status_str = am5.telescope.send_command_to_mount(zwoc::cmd_get_timezone());
+  REQUIRE(status_str == "+00:00#");
   spdlog::trace("sending cmd_get_lat_and_long()");
-  status_str = telescope.send_command_to_mount(zwoc::cmd_get_lat_and_long());
-
-  // spdlog::trace("sending cmd_set_timezone()");
-  // status_str = telescope.send_command_to_mount(
-  //   zwoc::cmd_set_timezone('-', 6), true, true);
-
-  spdlog::trace("fetching sidereal time");
-  telescope.send_command_to_mount(zwoc::cmd_get_sidereal_time());
-
-  // telescope.set_site_longitude(-98.0);
-  // telescope.set_site_latitude(30.33);
-
-  spdlog::trace("fetching sidereal time");
-  telescope.send_command_to_mount(zwoc::cmd_get_sidereal_time());
+  status_str =
+      am5.telescope.send_command_to_mount(zwoc::cmd_get_lat_and_long());
+  REQUIRE(status_str.find('&') != std::string::npos);
 
   spdlog::trace("fetching longitude");
-  telescope.send_command_to_mount(zwoc::cmd_get_longitude());
-
-  // status_str = telescope.utc_date();
-  // spdlog::debug("UTC returned from scope: {}", status_str);
-  // telescope.set_utc_date()
-  // spdlog::debug("cmd_get_sidereal_time() status_str: {0}", status_str);
+  status_str = am5.telescope.send_command_to_mount(zwoc::cmd_get_longitude());
+  REQUIRE(status_str.back() == '#');
 }
 
 TEST_CASE("Test east/west/north/south", "[move_axis]") {
   spdlog::set_level(spdlog::level::trace);
-  zwo_am5_telescope telescope;
-  telescope.set_serial_device("/dev/ttyACM0");
-  telescope.set_connected(true);
-
-  using namespace std::chrono_literals;
-  telescope.send_command_to_mount(zwoc::cmd_set_moving_speed_precise(1440.0),
-                                  false);
-  telescope.send_command_to_mount(zwoc::cmd_move_towards_east(), false);
+  am5_on_emulator_t am5;
+  auto moving = [&] {
+    return am5.emulator.with_firmware<lx200_mount_emulator_t>(
+        [](auto &mount) { return mount.slewing(); });
+  };
+
+  am5.telescope.send_command_to_mount(
+      zwoc::cmd_set_moving_speed_precise(1440.0));
+  am5.telescope.send_command_to_mount(zwoc::cmd_move_towards_east());
   spdlog::debug("moving east");
-  std::this_thread::sleep_for(2s);
+  // Neither command has a reply, so the mount may not have acted yet
+  REQUIRE(eventually(moving));
   spdlog::debug("moving stopping");
-  telescope.send_command_to_mount(zwoc::cmd_stop_moving_towards_east(), false);
+  am5.telescope.send_command_to_mount(zwoc::cmd_stop_moving_towards_east());
+  REQUIRE(eventually([&] { return !moving(); }));
+}
+
+TEST_CASE("Telemetry is served from the snapshot", "[telemetry]") {
+  spdlog::set_level(spdlog::level::trace);
+  am5_on_emulator_t am5;
+
+  // Keep the telemetry task quiet so every read below is one we asked for
+  auto config = am5.telescope.telemetry_config();
+  config.tracking_interval = 1min;
+  config.idle_interval = 1min;
+  am5.telescope.set_telemetry_config(config);
+  am5.telescope.telemetry(1min);
+  auto reads = am5.count("get_status");
+
+  for (int i = 0; i < 5; i++)
+    am5.telescope.telemetry(1s);
+  // Nothing moved the mount so none of those should have read it
+  REQUIRE(am5.count("get_status") == reads);
+
+  // No snapshot is ever that fresh
+  am5.telescope.telemetry(0ms);
+  REQUIRE(am5.count("get_status") == reads + 1);
+
+  // A motion command expires the snapshot. The task is woken as well, but
+  // between it and the getter the mount should only be read once.
+  am5.telescope.send_command_to_mount(zwoc::cmd_stop_moving());
+  am5.telescope.telemetry(1min);
+  am5.telescope.telemetry(1min);
+  REQUIRE(am5.count("get_status") == reads + 2);
 }
 
 // TODO: finish writing this case
 // TEST_CASE("Get tracking rate", "[tracking_rate]") {
 //   spdlog::set_level(spdlog::level::trace);
-//   zwo_am5_telescope telescope;
-//   telescope.set_serial_device("/dev/ttyACM0");
-//   telescope.set_connected(true);
-//   telescope.tracking_rate();
+//   am5_on_emulator_t am5;
+//   am5.telescope.tracking_rate();
 // }
@@ -0,0 +1,264 @@
+// Drives the QHY camera driver through full expose -> readout -> ImageBytes
+// cycles against the stub SDK (configure with -DALPACAHUB_QHY_SDK_STUB=ON)
+// so the host side of the pipeline can be profiled without a camera.
+//
+//   AlpacaHubCameraBench -n 50 -e 0.01 -w 6252 -H 4176 -r 150
+//
+// Per frame it reports how long start_exposure() took to return, how long
+// until image_ready() after the exposure should have ended, and how long it
+// took to serialize the frame as ImageBytes. Run it under perf / valgrind to
+// see where the time goes.
+//
+// With -live it runs live mode instead and reports the frame rate seen by a
+// subscriber, e.g. a 200x200 planetary crop:
+//
+//   AlpacaHubCameraBench -live 5 -crop 200 -e 0.001 -r 150
+
+#include "common/image_bytes_writer.hpp"
+#include "drivers/qhy_alpaca_camera.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <qhyccd_stub.h>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+using bench_clock_t = std::chrono::steady_clock;
+
+static double ms_since(bench_clock_t::time_point start) {
+  return std::chrono::duration<double, std::milli>(bench_clock_t::now() -
+                                                   start)
+      .count();
+}
+
+static void print_stats(const std::string &name, std::vector<double> values) {
+  if (values.empty())
+    return;
+  std::sort(values.begin(), values.end());
+  double total = 0;
+  for (auto v : values)
+    total += v;
+  auto percentile = [&values](double p) {
+    return values[std::min(values.size() - 1, size_t(p * values.size()))];
+  };
+  fmt::print("{:<22} mean: {:>9.3f}ms  p50: {:>9.3f}ms  p99: {:>9.3f}ms  "
+             "max: {:>9.3f}ms\n",
+             name, total / values.size(), percentile(0.5), percentile(0.99),
+             values.back());
+}
+
+static void print_timings(const std::string &title,
+                          std::map<std::string, device_variant_t> &details,
+                          const std::string &key) {
+  auto it = details.find(key);
+  if (it == details.end())
+    return;
+  auto timings = std::get_if<std::map<std::string, double>>(&it->second);
+  if (!timings)
+    return;
+
+  fmt::print("\n{}:\n", title);
+  for (auto &[name, value] : *timings)
+    if (name.size() > 8 && name.compare(name.size() - 8, 8, ".mean_ms") == 0)
+      fmt::print("  {:<40} {:>9.3f}ms\n", name.substr(0, name.size() - 8),
+                 value);
+}
+
+// Pulls frames off a live subscription as fast as they come and reports the
+// rate and the gaps between them
+static int run_live(std::string camera_id, const qhy_stub_config_t &config,
+                    short bin, uint32_t crop, double exposure,
+                    double seconds) {
+  {
+    auto camera = std::make_shared<qhy_alpaca_camera>(camera_id);
+    camera->set_connected(true);
+    camera->set_bin_x(bin);
+    // The bin change only takes effect with an exposure, and resets the ROI
+    camera->start_exposure(exposure);
+    while (!camera->image_ready())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (crop) {
+      uint32_t w = config.width / bin;
+      uint32_t h = config.height / bin;
+      crop = std::min({crop, w, h});
+      camera->set_start_x((w - crop) / 2);
+      camera->set_start_y((h - crop) / 2);
+      camera->set_num_x(crop);
+      camera->set_num_y(crop);
+    }
+
+    camera->start_live(exposure);
+    auto subscription = camera->subscribe_live(8, []() {});
+    fmt::print("live mode {}x{}, bin {}, {}s exposure for {}s\n",
+               camera->num_x(), camera->num_y(), bin, exposure, seconds);
+
+    std::vector<double> gap_ms;
+    size_t frames = 0;
+    size_t bytes = 0;
+    auto start = bench_clock_t::now();
+    auto last_frame = start;
+    while (ms_since(start) < seconds * 1000) {
+      camera_frame_ptr_t frame;
+      if (!subscription->try_pop(frame)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        continue;
+      }
+      if (frames++)
+        gap_ms.push_back(ms_since(last_frame));
+      last_frame = bench_clock_t::now();
+      bytes += frame->size_bytes();
+    }
+    double elapsed = ms_since(start) / 1000;
+    camera->stop_live();
+
+    fmt::print("\n");
+    print_stats("frame interval", gap_ms);
+    fmt::print("{:<22} {:.1f} fps, {:.1f}MB/s, {} dropped, {} SDK calls\n",
+               "totals", frames / elapsed, bytes / elapsed / (1024.0 * 1024.0),
+               subscription->dropped(), qhy_stub_call_count());
+    camera->set_connected(false);
+  }
+
+  qhy_alpaca_camera::ReleaseQHYSDK();
+  return 0;
+}
+
+static void usage(const char *name) {
+  fmt::print(
+      "usage: {} [options]\n"
+      "  -n <frames>          Number of frames (default 20)\n"
+      "  -e <seconds>         Exposure duration (default 0.01)\n"
+      "  -w <pixels>          Sensor width (default 3200)\n"
+      "  -H <pixels>          Sensor height (default 2200)\n"
+      "  -r <ms>              Simulated readout time (default 100)\n"
+      "  -l <us>              Simulated latency per SDK call (default 0)\n"
+      "  -s <stars>           Stars in the synthetic field (default 200)\n"
+      "  -bin <1|2|4>         Binning (default 1)\n"
+      "  -g                   Change the gain every frame\n"
+      "  -live <seconds>      Run live mode for this long instead\n"
+      "  -crop <pixels>       Square ROI centred on the sensor\n"
+      "  -v                   Debug logging from the driver\n",
+      name);
+}
+
+int main(int argc, char **argv) {
+  qhy_stub_config_t config;
+  int frames = 20;
+  double exposure = 0.01;
+  short bin = 1;
+  bool vary_gain = false;
+  double live_seconds = 0;
+  uint32_t crop = 0;
+  spdlog::set_level(spdlog::level::warn);
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    } else if (arg == "-g") {
+      vary_gain = true;
+    } else if (arg == "-v") {
+      spdlog::set_level(spdlog::level::debug);
+    } else if (i + 1 < argc) {
+      std::string arg_v = argv[++i];
+      if (arg == "-n")
+        frames = std::stoi(arg_v);
+      else if (arg == "-e")
+        exposure = std::stod(arg_v);
+      else if (arg == "-w")
+        config.width = std::stoul(arg_v);
+      else if (arg == "-H")
+        config.height = std::stoul(arg_v);
+      else if (arg == "-r")
+        config.readout_ms = std::stoul(arg_v);
+      else if (arg == "-l")
+        config.call_latency_us = std::stoul(arg_v);
+      else if (arg == "-s")
+        config.star_count = std::stoul(arg_v);
+      else if (arg == "-bin")
+        bin = std::stoi(arg_v);
+      else if (arg == "-live")
+        live_seconds = std::stod(arg_v);
+      else if (arg == "-crop")
+        crop = std::stoul(arg_v);
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  qhy_stub_configure(config);
+  qhy_alpaca_camera::InitializeQHYSDK();
+  auto camera_ids = qhy_alpaca_camera::get_connected_cameras();
+  if (camera_ids.empty()) {
+    fmt::print("no cameras found\n");
+    return 1;
+  }
+
+  if (live_seconds > 0)
+    return run_live(camera_ids[0], config, bin, crop, exposure, live_seconds);
+
+  std::vector<double> start_ms, ready_ms, serialize_ms, cycle_ms;
+  size_t bytes_out = 0;
+  {
+    auto camera = std::make_shared<qhy_alpaca_camera>(camera_ids[0]);
+    camera->set_connected(true);
+    camera->set_bin_x(bin);
+
+    fmt::print("{} frames of {}x{}, bin {}, {}s exposure, {}ms readout\n",
+               frames, config.width / bin, config.height / bin, bin, exposure,
+               config.readout_ms);
+
+    std::string chunk;
+    for (int i = 0; i < frames; i++) {
+      if (vary_gain)
+        camera->set_gain(i % 2 ? 10 : 20);
+
+      auto cycle_start = bench_clock_t::now();
+      camera->start_exposure(exposure);
+      start_ms.push_back(ms_since(cycle_start));
+
+      // The exposure itself isn't interesting, only what we add on top of it
+      auto exposure_end =
+          cycle_start + std::chrono::duration_cast<bench_clock_t::duration>(
+                            std::chrono::duration<double>(exposure));
+      while (!camera->image_ready())
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      ready_ms.push_back(ms_since(exposure_end));
+
+      auto serialize_start = bench_clock_t::now();
+      image_bytes_header_t header;
+      header.image_element_type = image_array_element_types::INT32;
+      image_bytes_writer_t writer(header, camera->last_frame());
+      while (writer.next_chunk(chunk))
+        bytes_out += chunk.size();
+      serialize_ms.push_back(ms_since(serialize_start));
+      cycle_ms.push_back(ms_since(cycle_start));
+    }
+
+    fmt::print("\n");
+    print_stats("start_exposure", start_ms);
+    print_stats("exposure end -> ready", ready_ms);
+    print_stats("imagebytes", serialize_ms);
+    print_stats("full cycle", cycle_ms);
+    fmt::print("{:<22} {:.1f}MB, {} SDK calls\n", "totals",
+               bytes_out / (1024.0 * 1024.0), qhy_stub_call_count());
+
+    auto details = camera->details();
+    print_timings("Exposure start phases", details, "ExposureStartTimings");
+    print_timings("SDK calls", details, "SDKTimings");
+
+    camera->set_connected(false);
+  }
+
+  qhy_alpaca_camera::ReleaseQHYSDK();
+  return 0;
+}
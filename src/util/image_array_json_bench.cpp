@@ -0,0 +1,125 @@
+// Compares the old "build a nlohmann tree and dump it" imagearray JSON path
+// with the streaming image_array_json_writer_t.
+//
+// Each mode should be run in its own process so the peak RSS numbers don't
+// bleed into each other, e.g.:
+//
+//   AlpacaHubImageJsonBench legacy 6252 4176 16
+//   AlpacaHubImageJsonBench streaming 6252 4176 16
+//
+// Output goes to /dev/null by default to stand in for the socket; pass a path
+// as the 5th argument to keep it around for comparing the two.
+
+#include "common/camera_frame.hpp"
+#include "common/image_array_json_writer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+static long peak_rss_kb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Fake sensor data in the native row major layout
+static camera_frame_ptr_t make_frame(uint32_t width, uint32_t height,
+                                     uint8_t bytes_per_pixel) {
+  auto frame = std::make_shared<camera_frame_t>();
+  frame->pixel_type = bytes_per_pixel == 1 ? image_array_element_types::BYTE
+                                           : image_array_element_types::UINT16;
+  frame->width = width;
+  frame->height = height;
+  frame->buffer = make_frame_buffer(frame->size_bytes());
+  if (bytes_per_pixel == 1) {
+    for (size_t i = 0; i < frame->data_size(); i++)
+      frame->data()[i] = i * 31;
+  } else {
+    auto pixels = reinterpret_cast<uint16_t *>(frame->data());
+    for (size_t i = 0; i < frame->num_pixels(); i++)
+      pixels[i] = i * 977;
+  }
+  return frame;
+}
+
+static nlohmann::json make_response_fields() {
+  nlohmann::json response;
+  response["ClientTransactionID"] = 1;
+  response["ErrorMessage"] = "";
+  response["ErrorNumber"] = 0;
+  response["Rank"] = 2;
+  response["ServerTransactionID"] = 1;
+  response["Type"] = 2;
+  return response;
+}
+
+// This mirrors what image_2d() + image_array_handler used to do
+static void run_legacy(const camera_frame_t &frame, FILE *out) {
+  std::vector<std::vector<uint32_t>> i2d(frame.width,
+                                         std::vector<uint32_t>(frame.height));
+  for (uint32_t x = 0; x < frame.width; x++)
+    for (uint32_t y = 0; y < frame.height; y++)
+      i2d[x][y] = frame.pixel(x, y);
+
+  auto response = make_response_fields();
+  response["Value"] = i2d;
+  std::string body = response.dump();
+  fwrite(body.data(), 1, body.size(), out);
+}
+
+static void run_streaming(camera_frame_ptr_t frame, FILE *out) {
+  image_array_json_writer_t writer(make_response_fields().dump(), frame);
+  std::string chunk;
+  while (writer.next_chunk(chunk))
+    fwrite(chunk.data(), 1, chunk.size(), out);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5) {
+    fmt::print("usage: {} <legacy|streaming> <width> <height> <8|16> "
+               "[output path]\n",
+               argv[0]);
+    return 1;
+  }
+
+  std::string mode = argv[1];
+  uint32_t width = std::stoul(argv[2]);
+  uint32_t height = std::stoul(argv[3]);
+  uint8_t bytes_per_pixel = std::stoul(argv[4]) == 8 ? 1 : 2;
+  std::string out_path = argc > 5 ? argv[5] : "/dev/null";
+
+  auto frame = make_frame(width, height, bytes_per_pixel);
+  long baseline_rss_kb = peak_rss_kb();
+
+  FILE *out = fopen(out_path.c_str(), "wb");
+  if (!out) {
+    fmt::print("unable to open {}\n", out_path);
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  if (mode == "legacy") {
+    run_legacy(*frame, out);
+  } else if (mode == "streaming") {
+    run_streaming(frame, out);
+  } else {
+    fmt::print("unknown mode: {}\n", mode);
+    return 1;
+  }
+  fflush(out);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  fclose(out);
+
+  fmt::print("mode: {}, frame: {}x{} @ {}bpp, time to last byte: {}ms, "
+             "peak rss: {}MB (frame alone: {}MB)\n",
+             mode, width, height, bytes_per_pixel * 8,
+             std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                 .count(),
+             peak_rss_kb() / 1024, baseline_rss_kb / 1024);
+  return 0;
+}
@@ -0,0 +1,614 @@
+// Puts a running AlpacaHub under the kind of load real clients do and
+// reports how the latency of each route holds up. Every virtual client has
+// its own keep-alive connection and thread, the way separate applications
+// would, and replays one of these profiles:
+//
+//   nina      A sequence in N.I.N.A.: once a second it polls the camera,
+//             mount, focuser, filter wheel, rotator and switch properties
+//             the equipment panels show. The first of these clients also
+//             runs exposures back to back and downloads each one as
+//             imagebytes.
+//   phd2      PHD2 guiding through the mount: a pulse every couple of
+//             seconds, then ispulseguiding until it's done and a position
+//             read.
+//   webui     index2.html with a device page open, the details route once a
+//             second and the device list now and then.
+//   download  imagearray as imagebytes back to back, for parallel
+//             downloads of the last frame.
+//
+// Start the hub with the simulated devices so runs can be compared:
+//
+//   AlpacaHub -sim -d -p 8080
+//   AlpacaHubLoadBench -s 30 -nina 2 -phd2 1 -webui 4 -download 2
+//   AlpacaHubLoadBench -nina 20 -rate 4 -json nina_x20.json
+//
+// -rate multiplies how often the polling profiles poll, 0 runs them flat
+// out. At the end it prints throughput and p50 / p95 / p99 / max latency
+// per route along with transport, HTTP and Alpaca errors, and -json writes
+// the same thing out for comparing runs.
+
+#include "asio/connect.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/read.hpp"
+#include "asio/read_until.hpp"
+#include "asio/streambuf.hpp"
+#include "asio/write.hpp"
+#include "common/image_bytes.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bench_clock_t = std::chrono::steady_clock;
+
+struct load_config_t {
+  std::string host = "127.0.0.1";
+  std::string port = "8080";
+  std::chrono::seconds duration{30};
+  int nina_clients = 1;
+  int phd2_clients = 1;
+  int webui_clients = 1;
+  int download_clients = 0;
+  // Multiplies how often the polling profiles poll, 0 is as fast as they
+  // can go
+  double rate = 1;
+  double exposure_seconds = 2;
+  std::string json_path;
+};
+
+struct route_stats_t {
+  std::vector<double> latencies_ms;
+  // Couldn't connect, or the connection dropped mid request
+  uint64_t transport_errors = 0;
+  // Anything but a 200
+  uint64_t http_errors = 0;
+  // A 200 with a non zero ErrorNumber
+  uint64_t alpaca_errors = 0;
+  uint64_t bytes = 0;
+
+  void merge(const route_stats_t &other) {
+    latencies_ms.insert(latencies_ms.end(), other.latencies_ms.begin(),
+                        other.latencies_ms.end());
+    transport_errors += other.transport_errors;
+    http_errors += other.http_errors;
+    alpaca_errors += other.alpaca_errors;
+    bytes += other.bytes;
+  }
+};
+
+using route_stats_map_t = std::map<std::string, route_stats_t>;
+
+struct http_response_t {
+  int status = 0;
+  int error_number = 0;
+  uint64_t bytes = 0;
+  // The start of the body, enough for a property's Value
+  std::string head;
+};
+
+// Just enough HTTP/1.1 for the hub's responses: Content-Length or chunked
+// bodies over a connection that's kept open between requests. Only the
+// start of the body is kept, for the Alpaca error number, the rest is read
+// and thrown away.
+class http_connection_t {
+public:
+  http_connection_t(const std::string &host, const std::string &port)
+      : _host(host), _port(port), _resolver(_io_ctx), _socket(_io_ctx),
+        _scratch(64 * 1024) {}
+
+  http_response_t request(const std::string &method,
+                          const std::string &target,
+                          const std::string &body = "",
+                          const std::string &accept = "application/json") {
+    if (!_socket.is_open()) {
+      asio::connect(_socket, _resolver.resolve(_host, _port));
+      _socket.set_option(asio::ip::tcp::no_delay(true));
+      _buffer.consume(_buffer.size());
+    }
+
+    std::string req = fmt::format("{} {} HTTP/1.1\r\nHost: {}:{}\r\n"
+                                  "Accept: {}\r\n",
+                                  method, target, _host, _port, accept);
+    if (method == "PUT")
+      req += fmt::format("Content-Type: application/x-www-form-urlencoded\r\n"
+                         "Content-Length: {}\r\n",
+                         body.size());
+    req += "\r\n";
+    req += body;
+
+    try {
+      asio::write(_socket, asio::buffer(req));
+      return read_response();
+    } catch (...) {
+      close();
+      throw;
+    }
+  }
+
+  void close() {
+    asio::error_code ignored;
+    _socket.close(ignored);
+  }
+
+private:
+  std::string read_line() {
+    asio::read_until(_socket, _buffer, "\r\n");
+    std::istream in(&_buffer);
+    std::string line;
+    std::getline(in, line);
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    return line;
+  }
+
+  // Reads count bytes of body, keeping the first few in _head
+  void read_body(size_t count) {
+    while (count > 0) {
+      size_t n;
+      if (_buffer.size() > 0) {
+        n = std::min(count, _buffer.size());
+        keep_head(static_cast<const char *>(_buffer.data().data()), n);
+        _buffer.consume(n);
+      } else {
+        n = _socket.read_some(
+            asio::buffer(_scratch.data(), std::min(count, _scratch.size())));
+        keep_head(_scratch.data(), n);
+      }
+      count -= n;
+    }
+  }
+
+  void keep_head(const char *data, size_t n) {
+    constexpr size_t head_size = 512;
+    if (_head.size() < head_size)
+      _head.append(data, std::min(n, head_size - _head.size()));
+  }
+
+  http_response_t read_response() {
+    http_response_t response;
+    auto status_line = read_line();
+    // HTTP/1.1 200 OK
+    auto space = status_line.find(' ');
+    if (space == std::string::npos)
+      throw std::runtime_error("bad status line: " + status_line);
+    response.status = std::atoi(status_line.c_str() + space + 1);
+
+    size_t content_length = 0;
+    bool chunked = false;
+    bool close_after = false;
+    bool image_bytes = false;
+    for (auto line = read_line(); !line.empty(); line = read_line()) {
+      auto colon = line.find(':');
+      auto value_at = line.find_first_not_of(' ', colon + 1);
+      if (colon == std::string::npos || value_at == std::string::npos)
+        continue;
+      std::string name = line.substr(0, colon);
+      std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+      std::string value = line.substr(value_at);
+      if (name == "content-length")
+        content_length = std::stoull(value);
+      else if (name == "transfer-encoding")
+        chunked = value.find("chunked") != std::string::npos;
+      else if (name == "connection")
+        close_after = value.find("close") != std::string::npos;
+      else if (name == "content-type")
+        image_bytes = value.find("imagebytes") != std::string::npos;
+    }
+
+    _head.clear();
+    if (chunked) {
+      while (true) {
+        size_t size = std::stoull(read_line(), nullptr, 16);
+        if (size == 0) {
+          // Trailers, if any, end with an empty line
+          while (!read_line().empty())
+            ;
+          break;
+        }
+        read_body(size);
+        response.bytes += size;
+        read_line();
+      }
+    } else {
+      read_body(content_length);
+      response.bytes = content_length;
+    }
+
+    if (image_bytes) {
+      image_bytes_header_t header;
+      if (_head.size() >= sizeof(header)) {
+        std::memcpy(&header, _head.data(), sizeof(header));
+        response.error_number = header.error_number;
+      }
+    } else {
+      auto at = _head.find("\"ErrorNumber\":");
+      if (at != std::string::npos)
+        response.error_number = std::atoi(_head.c_str() + at + 14);
+    }
+
+    response.head = _head;
+    if (close_after)
+      close();
+    return response;
+  }
+
+  std::string _host;
+  std::string _port;
+  asio::io_context _io_ctx;
+  asio::ip::tcp::resolver _resolver;
+  asio::ip::tcp::socket _socket;
+  asio::streambuf _buffer;
+  std::vector<char> _scratch;
+  std::string _head;
+};
+
+// One application talking to the hub
+class virtual_client_t {
+public:
+  virtual_client_t(const load_config_t &config, uint32_t client_id)
+      : _config(config), _connection(config.host, config.port),
+        _client_id(client_id), _transaction_id(0) {}
+
+  // The route is the target without the query, that's what the stats are
+  // kept under
+  http_response_t get(const std::string &route, const std::string &query = "",
+                      const std::string &accept = "application/json") {
+    auto target = fmt::format("{}?ClientID={}&ClientTransactionID={}{}{}",
+                              route, _client_id, ++_transaction_id,
+                              query.empty() ? "" : "&", query);
+    return timed("GET " + route, [&]() {
+      return _connection.request("GET", target, "", accept);
+    });
+  }
+
+  http_response_t put(const std::string &route, const std::string &form = "") {
+    auto body = fmt::format("ClientID={}&ClientTransactionID={}{}{}",
+                            _client_id, ++_transaction_id,
+                            form.empty() ? "" : "&", form);
+    return timed("PUT " + route,
+                 [&]() { return _connection.request("PUT", route, body); });
+  }
+
+  route_stats_map_t &stats() { return _stats; }
+  uint32_t client_id() const { return _client_id; }
+  const load_config_t &config() const { return _config; }
+
+private:
+  http_response_t timed(const std::string &key,
+                        const std::function<http_response_t()> &send) {
+    auto &route = _stats[key];
+    auto start = bench_clock_t::now();
+    http_response_t response;
+    try {
+      response = send();
+    } catch (std::exception &) {
+      route.transport_errors++;
+      return response;
+    }
+    route.latencies_ms.push_back(
+        std::chrono::duration<double, std::milli>(bench_clock_t::now() -
+                                                  start)
+            .count());
+    route.bytes += response.bytes;
+    if (response.status != 200)
+      route.http_errors++;
+    else if (response.error_number != 0)
+      route.alpaca_errors++;
+    return response;
+  }
+
+  const load_config_t &_config;
+  http_connection_t _connection;
+  uint32_t _client_id;
+  uint32_t _transaction_id;
+  route_stats_map_t _stats;
+};
+
+// One pass of what a client does, run every interval (scaled by -rate)
+struct profile_t {
+  std::string name;
+  std::chrono::milliseconds interval;
+  std::function<void(virtual_client_t &, uint64_t round)> round;
+};
+
+// Good enough for the bool properties, the bench doesn't need a parser
+static bool value_is_true(const http_response_t &response) {
+  auto at = response.head.find("\"Value\":");
+  if (response.error_number != 0 || at == std::string::npos)
+    return false;
+  at = response.head.find_first_not_of(' ', at + 8);
+  return at != std::string::npos &&
+         response.head.compare(at, 4, "true") == 0;
+}
+
+// The first N.I.N.A. client also takes pictures. It starts an exposure,
+// waits for imageready on its one second polls and downloads the frame.
+static void nina_round(virtual_client_t &client, uint64_t) {
+  static const std::vector<std::string> polled = {
+      "camera/0/camerastate",     "camera/0/ccdtemperature",
+      "camera/0/coolerpower",     "camera/0/connected",
+      "telescope/0/rightascension", "telescope/0/declination",
+      "telescope/0/altitude",     "telescope/0/azimuth",
+      "telescope/0/siderealtime", "telescope/0/slewing",
+      "telescope/0/tracking",     "telescope/0/atpark",
+      "telescope/0/sideofpier",   "telescope/0/connected",
+      "focuser/0/position",       "focuser/0/ismoving",
+      "focuser/0/temperature",    "filterwheel/0/position",
+      "rotator/0/position",       "rotator/0/ismoving"};
+  for (auto &property : polled)
+    client.get("/api/v1/" + property);
+  client.get("/api/v1/switch/0/getswitchvalue", "Id=0");
+
+  if (client.client_id() != 1)
+    return;
+
+  // Once the last frame is in, fetch it and start the next
+  if (value_is_true(client.get("/api/v1/camera/0/imageready"))) {
+    client.get("/api/v1/camera/0/imagearray", "",
+               "application/imagebytes");
+    client.put("/api/v1/camera/0/startexposure",
+               fmt::format("Duration={}&Light=true",
+                           client.config().exposure_seconds));
+  }
+}
+
+static void phd2_round(virtual_client_t &client, uint64_t round) {
+  static const char *directions[] = {"0", "2", "1", "3"};
+  client.put("/api/v1/telescope/0/pulseguide",
+             fmt::format("Direction={}&Duration=200", directions[round % 4]));
+
+  // PHD2 waits most of the pulse out, then checks on it until it's done
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  for (int i = 0; i < 100; i++) {
+    if (!value_is_true(client.get("/api/v1/telescope/0/ispulseguiding")))
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  client.get("/api/v1/telescope/0/rightascension");
+  client.get("/api/v1/telescope/0/declination");
+}
+
+static void webui_round(virtual_client_t &client, uint64_t round) {
+  static const std::vector<std::string> pages = {
+      "telescope", "camera", "focuser", "filterwheel", "rotator", "switch"};
+  // Each browser has a different device page open
+  auto &page = pages[client.client_id() % pages.size()];
+  client.get(fmt::format("/api/v1/{}/0/details", page));
+  if (round % 10 == 0)
+    client.get("/management/v1/configureddevices");
+}
+
+static void download_round(virtual_client_t &client, uint64_t) {
+  client.get("/api/v1/camera/0/imagearray", "", "application/imagebytes");
+}
+
+static void run_client(const profile_t &profile, virtual_client_t &client,
+                       bench_clock_t::time_point stop_at) {
+  auto interval = profile.interval;
+  if (client.config().rate > 0)
+    interval = std::chrono::duration_cast<std::chrono::milliseconds>(
+        interval / client.config().rate);
+  else
+    interval = std::chrono::milliseconds(0);
+
+  // Spread the clients out over the first interval so they don't all poll
+  // in lock step
+  auto next = bench_clock_t::now() +
+              interval * (client.client_id() % 7) / 7;
+  for (uint64_t round = 0; bench_clock_t::now() < stop_at; round++) {
+    std::this_thread::sleep_until(std::min(next, stop_at));
+    if (bench_clock_t::now() >= stop_at)
+      break;
+    profile.round(client, round);
+    // Closed loop, a round that overruns its interval just goes again
+    next = std::max(next + interval, bench_clock_t::now());
+  }
+}
+
+// Connects the devices the profiles use and makes sure there's a frame to
+// download. Returns false if the hub isn't there.
+static bool prepare_hub(const load_config_t &config) {
+  virtual_client_t setup(config, 0);
+  auto devices = setup.get("/management/v1/configureddevices");
+  if (devices.status != 200) {
+    fmt::print("Couldn't reach AlpacaHub at {}:{}\n", config.host,
+               config.port);
+    return false;
+  }
+
+  for (auto device : {"camera", "telescope", "focuser", "filterwheel",
+                      "rotator", "switch"})
+    setup.put(fmt::format("/api/v1/{}/0/connected", device),
+              "Connected=true");
+  setup.put("/api/v1/telescope/0/unpark");
+  setup.put("/api/v1/telescope/0/tracking", "Tracking=true");
+
+  // Real hardware takes as long as it likes, runs are only comparable
+  // against the simulators
+  auto driver = setup.get("/api/v1/camera/0/driverinfo");
+  if (driver.head.find("Simulator") == std::string::npos)
+    fmt::print("The camera isn't simulated, start the hub with -sim for "
+               "results that can be compared\n");
+
+  if (config.download_clients > 0 || config.nina_clients > 0) {
+    setup.put("/api/v1/camera/0/startexposure", "Duration=0.1&Light=true");
+    auto give_up_at = bench_clock_t::now() + std::chrono::seconds(30);
+    while (bench_clock_t::now() < give_up_at &&
+           !value_is_true(setup.get("/api/v1/camera/0/imageready")))
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  size_t errors = 0;
+  for (auto &[route, stats] : setup.stats())
+    errors += stats.transport_errors + stats.http_errors + stats.alpaca_errors;
+  if (errors)
+    fmt::print("{} setup requests failed\n", errors);
+  return true;
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  return sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))];
+}
+
+static nlohmann::json summarize(const std::string &name,
+                                route_stats_t &stats, double seconds) {
+  auto &values = stats.latencies_ms;
+  std::sort(values.begin(), values.end());
+  nlohmann::json summary;
+  summary["route"] = name;
+  summary["requests"] = values.size();
+  summary["per_second"] = values.size() / seconds;
+  summary["p50_ms"] = percentile(values, 0.5);
+  summary["p95_ms"] = percentile(values, 0.95);
+  summary["p99_ms"] = percentile(values, 0.99);
+  summary["max_ms"] = values.empty() ? 0 : values.back();
+  summary["transport_errors"] = stats.transport_errors;
+  summary["http_errors"] = stats.http_errors;
+  summary["alpaca_errors"] = stats.alpaca_errors;
+  summary["megabytes"] = stats.bytes / 1e6;
+  return summary;
+}
+
+static void print_summary(const nlohmann::json &summary) {
+  fmt::print("{:<46} {:>8} {:>9.1f} {:>8.2f} {:>8.2f} {:>8.2f} {:>8.2f} "
+             "{:>6} {:>6} {:>6}\n",
+             summary["route"].get<std::string>(),
+             summary["requests"].get<size_t>(),
+             summary["per_second"].get<double>(),
+             summary["p50_ms"].get<double>(), summary["p95_ms"].get<double>(),
+             summary["p99_ms"].get<double>(), summary["max_ms"].get<double>(),
+             summary["transport_errors"].get<uint64_t>(),
+             summary["http_errors"].get<uint64_t>(),
+             summary["alpaca_errors"].get<uint64_t>());
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-host address] [-p port] [-s seconds] "
+             "[-nina clients] [-phd2 clients] [-webui clients] "
+             "[-download clients] [-rate multiplier] [-exposure seconds] "
+             "[-json file]\n",
+             name);
+}
+
+int main(int argc, char **argv) {
+  load_config_t config;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    } else if (i + 1 < argc) {
+      std::string arg_v = argv[++i];
+      if (arg == "-host")
+        config.host = arg_v;
+      else if (arg == "-p")
+        config.port = arg_v;
+      else if (arg == "-s")
+        config.duration = std::chrono::seconds(std::stoi(arg_v));
+      else if (arg == "-nina")
+        config.nina_clients = std::stoi(arg_v);
+      else if (arg == "-phd2")
+        config.phd2_clients = std::stoi(arg_v);
+      else if (arg == "-webui")
+        config.webui_clients = std::stoi(arg_v);
+      else if (arg == "-download")
+        config.download_clients = std::stoi(arg_v);
+      else if (arg == "-rate")
+        config.rate = std::stod(arg_v);
+      else if (arg == "-exposure")
+        config.exposure_seconds = std::stod(arg_v);
+      else if (arg == "-json")
+        config.json_path = arg_v;
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!prepare_hub(config))
+    return 1;
+
+  std::vector<std::pair<profile_t, int>> mix = {
+      {{"nina", std::chrono::milliseconds(1000), nina_round},
+       config.nina_clients},
+      {{"phd2", std::chrono::milliseconds(2000), phd2_round},
+       config.phd2_clients},
+      {{"webui", std::chrono::milliseconds(1000), webui_round},
+       config.webui_clients},
+      {{"download", std::chrono::milliseconds(0), download_round},
+       config.download_clients}};
+
+  // Client ids count up within each profile so the first N.I.N.A. client
+  // is the one that takes pictures
+  std::vector<std::unique_ptr<virtual_client_t>> clients;
+  std::vector<const profile_t *> client_profiles;
+  for (auto &[profile, count] : mix)
+    for (int i = 0; i < count; i++) {
+      clients.push_back(std::make_unique<virtual_client_t>(config, i + 1));
+      client_profiles.push_back(&profile);
+    }
+
+  fmt::print("Running {} clients against {}:{} for {}s\n", clients.size(),
+             config.host, config.port, config.duration.count());
+  auto started = bench_clock_t::now();
+  auto stop_at = started + config.duration;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < clients.size(); i++)
+    threads.emplace_back(run_client, std::cref(*client_profiles[i]),
+                         std::ref(*clients[i]), stop_at);
+  for (auto &thread : threads)
+    thread.join();
+  double seconds =
+      std::chrono::duration<double>(bench_clock_t::now() - started).count();
+
+  route_stats_map_t routes;
+  route_stats_t total;
+  for (auto &client : clients)
+    for (auto &[route, stats] : client->stats()) {
+      routes[route].merge(stats);
+      total.merge(stats);
+    }
+
+  nlohmann::json report;
+  report["host"] = config.host;
+  report["port"] = config.port;
+  report["seconds"] = seconds;
+  report["rate"] = config.rate;
+  for (auto &[profile, count] : mix)
+    report["clients"][profile.name] = count;
+
+  fmt::print("{:<46} {:>8} {:>9} {:>8} {:>8} {:>8} {:>8} {:>6} {:>6} "
+             "{:>6}\n",
+             "route", "requests", "req/s", "p50 ms", "p95 ms", "p99 ms",
+             "max ms", "conn", "http", "alpaca");
+  for (auto &[route, stats] : routes) {
+    auto summary = summarize(route, stats, seconds);
+    print_summary(summary);
+    report["routes"].push_back(summary);
+  }
+  auto summary = summarize("total", total, seconds);
+  print_summary(summary);
+  report["total"] = summary;
+
+  if (!config.json_path.empty()) {
+    std::ofstream out(config.json_path);
+    out << report.dump(2) << std::endl;
+    fmt::print("Wrote {}\n", config.json_path);
+  }
+  return 0;
+}
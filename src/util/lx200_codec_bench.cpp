@@ -0,0 +1,184 @@
+// Compares the LX200 codec in common/lx200_codec.hpp with the std::regex
+// parsers and fmt::format builders the mount drivers used before it.
+//
+//   AlpacaHubLx200Bench -n 200000
+//
+// For each reply shape and command it reports the time per call and how many
+// heap allocations each call made, which is the number that matters when the
+// telemetry thread is polling a mount several times a second.
+
+#include "common/lx200_codec.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <functional>
+#include <new>
+#include <regex>
+#include <string>
+
+using bench_clock_t = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+// Copies of what the drivers did before the codec, kept here to compare
+// against
+namespace legacy {
+
+static lx200::hh_mm_ss parse_hh_mm_ss_response(const std::string &resp) {
+  lx200::hh_mm_ss data;
+  std::string response = resp;
+  auto expression = R"(^([0-9]{2}):([0-9]{2}):([0-9]{2})#)";
+  std::regex resp_regex(expression);
+  std::match_results<std::string::iterator> res;
+  auto is_matched =
+      std::regex_search(response.begin(), response.end(), res, resp_regex);
+  if (!is_matched)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("problem parsing response {0}", resp));
+
+  std::string hh_matched_str = res[1].str();
+  data.hh = atoi(hh_matched_str.c_str());
+  std::string mm_matched_str = res[2].str();
+  data.mm = atoi(mm_matched_str.c_str());
+  std::string ss_matched_str = res[3].str();
+  data.ss = atoi(ss_matched_str.c_str());
+  return data;
+}
+
+static lx200::sdd_mm_ss parse_sdd_mm_ss_response(const std::string &resp) {
+  lx200::sdd_mm_ss data;
+  std::string response = resp;
+  auto expression = R"(^([+-])([0-9]{2})\*([0-9]{2}):([0-9]{2})#)";
+  std::regex resp_regex(expression);
+  std::match_results<std::string::iterator> res;
+  auto is_matched =
+      std::regex_search(response.begin(), response.end(), res, resp_regex);
+  if (!is_matched)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("problem parsing response {0}", resp));
+  std::string s_matched_str = res[1].str();
+  data.plus_or_minus = s_matched_str.c_str()[0];
+  std::string dd_matched_str = res[2].str();
+  data.dd = atoi(dd_matched_str.c_str());
+  std::string mm_matched_str = res[3].str();
+  data.mm = atoi(mm_matched_str.c_str());
+  std::string ss_matched_str = res[4].str();
+  data.ss = atoi(ss_matched_str.c_str());
+  return data;
+}
+
+static int parse_standard_response(const std::string &resp) {
+  std::string response = resp;
+  std::regex resp_regex("^e?([0-9])#");
+  std::match_results<std::string::iterator> res;
+  auto is_matched =
+      std::regex_search(response.begin(), response.end(), res, resp_regex);
+  if (!is_matched)
+    throw alpaca_exception(alpaca_exception::INVALID_VALUE,
+                           fmt::format("problem parsing response {0}", resp));
+  std::string matched_str = res[1].str();
+  return atoi(matched_str.c_str());
+}
+
+} // namespace legacy
+
+// Keeps the optimiser from throwing the work away
+static volatile int sink;
+
+static void run(const std::string &name, uint64_t iterations,
+                const std::function<int()> &call) {
+  // Warm up, and get anything lazily allocated out of the way
+  for (int i = 0; i < 100; i++)
+    sink = call();
+
+  uint64_t allocations_before = allocations;
+  auto start = bench_clock_t::now();
+  for (uint64_t i = 0; i < iterations; i++)
+    sink = call();
+  auto elapsed = bench_clock_t::now() - start;
+  uint64_t allocated = allocations - allocations_before;
+
+  fmt::print("{:<34} {:>9.1f}ns/call {:>6.1f} allocs/call\n", name,
+             std::chrono::duration<double, std::nano>(elapsed).count() /
+                 iterations,
+             static_cast<double>(allocated) / iterations);
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-n iterations]\n", name);
+}
+
+int main(int argc, char **argv) {
+  uint64_t iterations = 200000;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    }
+    if (arg == "-n" && i + 1 < argc) {
+      iterations = std::stoull(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Replies as the drivers get them back from the serial channel
+  const std::string ra_reply = "04:38:51#";
+  const std::string dec_reply = "+34*11:23#";
+  const std::string standard_reply = "1#";
+
+  fmt::print("{} calls each\n\n", iterations);
+
+  run("regex hh_mm_ss", iterations,
+      [&]() { return legacy::parse_hh_mm_ss_response(ra_reply).ss; });
+  run("codec hh_mm_ss", iterations,
+      [&]() { return lx200::parse_hh_mm_ss_response(ra_reply).ss; });
+  run("regex sdd_mm_ss", iterations,
+      [&]() { return legacy::parse_sdd_mm_ss_response(dec_reply).ss; });
+  run("codec sdd_mm_ss", iterations,
+      [&]() { return lx200::parse_sdd_mm_ss_response(dec_reply).ss; });
+  run("regex standard", iterations,
+      [&]() { return legacy::parse_standard_response(standard_reply); });
+  run("codec standard", iterations,
+      [&]() { return lx200::parse_standard_response(standard_reply); });
+
+  fmt::print("\n");
+
+  // What the AM5 sends to slew, too long for std::string's small buffer
+  run("fmt::format goto", iterations, [&]() {
+    std::string cmd = fmt::format(
+        ":SMeq{0:#02d}:{1:#02d}:{2:#02d}&{3}{4:#02d}*{5:#02d}:{6:#02d}#", 4,
+        38, 51, '+', 34, 11, 23);
+    return static_cast<int>(cmd.size());
+  });
+  run("command_t goto", iterations, [&]() {
+    auto cmd = lx200::command_t::format(
+        ":SMeq{0:#02d}:{1:#02d}:{2:#02d}&{3}{4:#02d}*{5:#02d}:{6:#02d}#", 4,
+        38, 51, '+', 34, 11, 23);
+    return static_cast<int>(cmd.size());
+  });
+  run("fmt::format guide", iterations, [&]() {
+    std::string cmd = fmt::format(":Mg{0}{1:#04d}#", 'n', 500);
+    return static_cast<int>(cmd.size());
+  });
+  run("command_t guide", iterations, [&]() {
+    auto cmd = lx200::command_t::format(":Mg{0}{1:#04d}#", 'n', 500);
+    return static_cast<int>(cmd.size());
+  });
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Compares building an Alpaca response the way the server used to, a
+// std::map<std::string, device_variant_t> turned into nlohmann::json and
+// dumped, with alpaca_response_t writing it out directly.
+//
+//   AlpacaHubResponseBench -n 200000
+//
+// Each call fills in the envelope and a Value the way a handler does and
+// makes the body string, so the allocations per call are everything a small
+// property GET costs in building its response.
+
+#include "common/alpaca_response.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// The server had the same one
+namespace nlohmann {
+static void to_json(nlohmann::json &j, const axis_rate &p) {
+  j = nlohmann::json{{"Maximum", p.Max}, {"Minimum", p.Min}};
+}
+} // namespace nlohmann
+
+using bench_clock_t = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+static volatile size_t sink;
+
+static void run(const std::string &name, uint64_t iterations,
+                const std::function<size_t()> &call) {
+  // Warm up, and get anything lazily allocated out of the way
+  for (int i = 0; i < 100; i++)
+    sink = call();
+
+  uint64_t allocations_before = allocations;
+  auto start = bench_clock_t::now();
+  for (uint64_t i = 0; i < iterations; i++)
+    sink = call();
+  auto elapsed = bench_clock_t::now() - start;
+  uint64_t allocated = allocations - allocations_before;
+
+  fmt::print("{:<34} {:>9.1f}ns/call {:>6.1f} allocs/call\n", name,
+             std::chrono::duration<double, std::nano>(elapsed).count() /
+                 iterations,
+             static_cast<double>(allocated) / iterations);
+}
+
+// Fills in a response like on_get_device_common and device_get_handler do
+template <typename Response_T, typename Value_T>
+static void fill(Response_T &response, const Value_T &value) {
+  response["ErrorNumber"] = 0;
+  response["ErrorMessage"] = "";
+  response["ClientID"] = uint32_t(1);
+  response["ClientTransactionID"] = uint32_t(1234);
+  response["ServerTransactionID"] = uint32_t(56789);
+  response["Value"] = value;
+}
+
+template <typename Value_T>
+static void compare(const std::string &name, uint64_t iterations,
+                    const Value_T &value) {
+  std::map<std::string, device_variant_t> before;
+  alpaca_response_t after;
+  fill(before, value);
+  fill(after, value);
+  if (nlohmann::json(before).dump() != after.dump()) {
+    fmt::print("{} doesn't match:\n  {}\n  {}\n", name,
+               nlohmann::json(before).dump(), after.dump());
+    std::exit(1);
+  }
+
+  run(fmt::format("map + nlohmann {}", name), iterations, [&value]() {
+    std::map<std::string, device_variant_t> response;
+    fill(response, value);
+    return nlohmann::json(response).dump().size();
+  });
+  run(fmt::format("alpaca_response_t {}", name), iterations, [&value]() {
+    alpaca_response_t response;
+    fill(response, value);
+    return response.dump().size();
+  });
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-n iterations]\n", name);
+}
+
+int main(int argc, char **argv) {
+  uint64_t iterations = 200000;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    }
+    if (arg == "-n" && i + 1 < argc) {
+      iterations = std::stoull(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  fmt::print("{} calls each\n\n", iterations);
+
+  compare("bool", iterations, true);
+  compare("int", iterations, 3);
+  compare("double", iterations, 4.2736111111111111);
+  compare("string", iterations, std::string("Simulated Mount"));
+  compare("names", iterations,
+          std::vector<std::string>{"L", "R", "G", "B", "Ha", "OIII", "SII"});
+  compare("axisrates", iterations,
+          std::vector<axis_rate>{axis_rate(6.0, 0.0)});
+  return 0;
+}
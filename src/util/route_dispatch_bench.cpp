@@ -0,0 +1,340 @@
+// Compares finding a device API handler the way the express router did,
+// std::regex against every route in the order they were added, with the
+// route_table_t lookup create_device_api_handler does now.
+//
+//   AlpacaHubRouteBench -n 100000
+//
+// The routes are the ones server_handler() used to register, in the same
+// order and turned into the same regexes restinio's path2regex makes (case
+// insensitive, optional trailing slash). Each request in the mix is timed on
+// its own since the express router's cost depends on how far down the list
+// the route is, then the whole mix is run round robin.
+
+#include "common/route_table.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <functional>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using bench_clock_t = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+// Routes in the order server_handler() added them. A device type of "*" is
+// add_route_to_router<i_alpaca_device>'s alternation, ":device_type" is any
+// path fragment.
+struct route_group_t {
+  route_method_enum method;
+  const char *device_type;
+  const char *actions;
+};
+
+static const char *all_device_types =
+    "telescope|camera|focuser|filterwheel|switch|rotator";
+
+static const route_group_t device_route_groups[] = {
+    {route_method_enum::put, ":device_type",
+     "action commandblind commandbool commandstring"},
+    {route_method_enum::get, ":device_type", "details devicestate"},
+    {route_method_enum::get, "*",
+     "connected description driverinfo driverversion interfaceversion name "
+     "supportedactions"},
+    {route_method_enum::get, "camera",
+     "bayeroffsetx bayeroffsety binx biny camerastate cameraxsize "
+     "cameraysize canabortexposure canasymmetricbin canfastreadout "
+     "cangetcoolerpower canpulseguide cansetccdtemperature canstopexposure "
+     "ccdtemperature cooleron coolerpower electronsperadu exposuremax "
+     "exposuremin exposureresolution fastreadout fullwellcapacity gain "
+     "gainmax gainmin gains hasshutter heatsinktemperature imagearray "
+     "imagearrayvariant livestream imageready ispulseguiding "
+     "lastexposureduration lastexposurestarttime maxadu maxbinx maxbiny numx "
+     "numy offset offsetmax offsetmin offsets percentcompleted pixelsizex "
+     "pixelsizey readoutmode readoutmodes sensorname sensortype "
+     "setccdtemperature startx starty subexposureduration"},
+    {route_method_enum::put, "camera", "abortexposure binx biny"},
+    {route_method_enum::put, ":device_type", "connected"},
+    {route_method_enum::put, "camera",
+     "cooleron fastreadout gain numx numy offset pulseguide readoutmode "
+     "setccdtemperature startx starty subexposureduration startexposure "
+     "stopexposure setusbtraffic getusbtraffic"},
+    {route_method_enum::get, "filterwheel", "position names focusoffsets"},
+    {route_method_enum::put, "filterwheel", "position"},
+    {route_method_enum::get, "telescope",
+     "alignmentmode altitude aperturearea aperturediameter athome atpark "
+     "azimuth canfindhome canpark canpulseguide cansetdeclinationrate "
+     "cansetguiderates cansetpark cansetpierside cansetrightascensionrate "
+     "cansettracking canslew canslewasync canslewaltaz canslewaltazasync "
+     "cansync cansyncaltaz canunpark declination declinationrate "
+     "doesrefraction equatorialsystem focallength guideratedeclination "
+     "guideraterightascension ispulseguiding rightascension "
+     "rightascensionrate sideofpier siderealtime siteelevation sitelatitude "
+     "sitelongitude slewing slewsettletime targetdeclination "
+     "targetrightascension tracking trackingrate trackingrates utcdate "
+     "axisrates canmoveaxis destinationsideofpier"},
+    {route_method_enum::put, "telescope",
+     "findhome declinationrate doesrefraction guideratedeclination "
+     "guideraterightascension rightascensionrate sideofpier siteelevation "
+     "sitelatitude sitelongitude slewsettletime targetdeclination "
+     "targetrightascension tracking trackingrate utcdate abortslew moveaxis "
+     "park pulseguide setpark slewtoaltaz slewtoaltazasync "
+     "slewtocoordinates slewtocoordinatesasync slewtotarget "
+     "slewtotargetasync synctoaltaz synctocoordinates synctotarget unpark"},
+    {route_method_enum::get, "focuser",
+     "absolute ismoving maxincrement maxstep position stepsize tempcomp "
+     "tempcompavailable temperature"},
+    {route_method_enum::put, "focuser", "tempcomp halt move"},
+    {route_method_enum::get, "switch",
+     "maxswitch canwrite getswitch getswitchdescription getswitchname "
+     "getswitchvalue minswitchvalue maxswitchvalue switchstep"},
+    {route_method_enum::put, "switch",
+     "setswitch setswitchname setswitchvalue sendserialcommand"},
+    {route_method_enum::get, "rotator",
+     "canreverse ismoving mechanicalposition position reverse stepsize "
+     "targetposition"},
+    {route_method_enum::put, "rotator",
+     "reverse halt move moveabsolute movemechanical sync"},
+};
+
+// What the express router keeps per route
+struct regex_route_t {
+  route_method_enum method;
+  std::regex matcher;
+  int id;
+};
+
+// One piece of path2regex: a parameter with the default or a given pattern
+static std::string param_regex(const std::string &pattern) {
+  return fmt::format("({})", pattern.empty() ? "[^/]+?" : pattern);
+}
+
+static std::regex express_regex(const std::string &device_type_pattern,
+                                const std::string &action) {
+  return std::regex(
+      fmt::format(R"(^/api/v1/{}/{}/{}(?:/(?=$))?$)",
+                  param_regex(device_type_pattern), param_regex(""), action),
+      std::regex::ECMAScript | std::regex::icase);
+}
+
+// The routes ahead of the device ones, which every device request had to be
+// tried against first. The bad device number ones really came after the
+// unsupported PUTs but that's four routes out of two hundred.
+static void add_leading_routes(std::vector<regex_route_t> &routes) {
+  const char *paths[] = {R"(^/(?:/(?=$))?$)",
+                         R"(^/html/(?:/(?=$))?$)",
+                         R"(^/setup(?:/(?=$))?$)",
+                         R"(^/setup/v1/([^/]+?)/([^/]+?)/setup(?:/(?=$))?$)",
+                         R"(^/html/js/(.+)(?:/(?=$))?$)",
+                         R"(^/html/(.+)(?:/(?=$))?$)",
+                         R"(^/management/apiversions(?:/(?=$))?$)",
+                         R"(^/management/v1/description(?:/(?=$))?$)",
+                         R"(^/management/v1/configureddevices(?:/(?=$))?$)"};
+  for (auto path : paths)
+    routes.push_back({route_method_enum::get,
+                      std::regex(path, std::regex::ECMAScript |
+                                           std::regex::icase),
+                      -1});
+
+  // bad_device_num_path, for GET and PUT
+  for (auto method : {route_method_enum::get, route_method_enum::put})
+    routes.push_back(
+        {method,
+         std::regex(
+             R"(^/api/v1/([^/]+?)/(-\d+|[a-zA-Z][:alpha:]*))"
+             R"(/([^/]+?)(?:/(?=$))?$)",
+             std::regex::ECMAScript | std::regex::icase),
+         -1});
+}
+
+static std::vector<std::string> split_actions(const char *actions) {
+  std::vector<std::string> out;
+  std::istringstream in(actions);
+  std::string action;
+  while (in >> action)
+    out.push_back(action);
+  return out;
+}
+
+struct request_t {
+  route_method_enum method;
+  std::string path;
+  // What the easy_parser_router hands create_device_api_handler
+  std::string device_type;
+  std::string action;
+};
+
+static request_t make_request(route_method_enum method,
+                              const std::string &device_type,
+                              const std::string &action) {
+  return {method, fmt::format("/api/v1/{}/0/{}", device_type, action),
+          device_type, action};
+}
+
+static int express_find(const std::vector<regex_route_t> &routes,
+                        const request_t &request) {
+  std::smatch match;
+  for (auto &route : routes)
+    if (route.method == request.method &&
+        std::regex_match(request.path, match, route.matcher))
+      return route.id;
+  return -1;
+}
+
+// Splits /api/v1/<type>/<n>/<action> the way the easy_parser_router does,
+// to show the table lookup still wins with that counted in
+static int split_and_find(const route_table_t<int> &table,
+                          const request_t &request) {
+  std::string_view path = request.path;
+  path.remove_prefix(8);
+  auto type_end = path.find('/');
+  auto number_end = path.find('/', type_end + 1);
+  auto found = table.find(request.method, path.substr(0, type_end),
+                          path.substr(number_end + 1));
+  return found ? *found : -1;
+}
+
+static volatile int sink;
+
+static void run(const std::string &name, uint64_t iterations,
+                const std::function<int()> &call) {
+  // Warm up, and get anything lazily allocated out of the way
+  for (int i = 0; i < 100; i++)
+    sink = call();
+
+  uint64_t allocations_before = allocations;
+  auto start = bench_clock_t::now();
+  for (uint64_t i = 0; i < iterations; i++)
+    sink = call();
+  auto elapsed = bench_clock_t::now() - start;
+  uint64_t allocated = allocations - allocations_before;
+
+  fmt::print("{:<42} {:>9.1f}ns/call {:>6.1f} allocs/call\n", name,
+             std::chrono::duration<double, std::nano>(elapsed).count() /
+                 iterations,
+             static_cast<double>(allocated) / iterations);
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-n iterations]\n", name);
+}
+
+int main(int argc, char **argv) {
+  uint64_t iterations = 100000;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    }
+    if (arg == "-n" && i + 1 < argc) {
+      iterations = std::stoull(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  const char *device_types[] = {"camera",  "filterwheel", "focuser",
+                                "rotator", "switch",      "telescope"};
+
+  std::vector<regex_route_t> express_routes;
+  add_leading_routes(express_routes);
+  route_table_t<int> table;
+  int id = 0;
+
+  for (auto &group : device_route_groups) {
+    std::string type = group.device_type;
+    for (auto &action : split_actions(group.actions)) {
+      // add_route_to_router made :device_type(camera) and the like, which
+      // costs about the same as the literal in the hand written routes
+      std::string pattern = type == "*"              ? all_device_types
+                            : type == ":device_type" ? ""
+                                                     : type;
+      express_routes.push_back(
+          {group.method, express_regex(pattern, action), id});
+
+      if (type == "*" || type == ":device_type") {
+        for (auto device_type : device_types)
+          table.add(group.method, device_type, action, id);
+      } else {
+        table.add(group.method, type, action, id);
+      }
+      id++;
+    }
+  }
+
+  // A guiding and imaging session's polling, from the top of the list to
+  // the bottom
+  std::vector<request_t> mix = {
+      make_request(route_method_enum::get, "camera", "connected"),
+      make_request(route_method_enum::get, "camera", "camerastate"),
+      make_request(route_method_enum::get, "camera", "ccdtemperature"),
+      make_request(route_method_enum::get, "camera", "imageready"),
+      make_request(route_method_enum::get, "filterwheel", "position"),
+      make_request(route_method_enum::get, "telescope", "rightascension"),
+      make_request(route_method_enum::get, "telescope", "declination"),
+      make_request(route_method_enum::get, "telescope", "slewing"),
+      make_request(route_method_enum::put, "telescope", "pulseguide"),
+      make_request(route_method_enum::get, "focuser", "position"),
+      make_request(route_method_enum::get, "focuser", "temperature"),
+      make_request(route_method_enum::get, "switch", "getswitchvalue"),
+      make_request(route_method_enum::get, "rotator", "position"),
+      make_request(route_method_enum::put, "rotator", "sync"),
+  };
+
+  // Both have to agree before the timings mean anything
+  for (auto &request : mix) {
+    int expected = express_find(express_routes, request);
+    auto found =
+        table.find(request.method, request.device_type, request.action);
+    if (expected < 0 || !found || *found != expected) {
+      fmt::print("{} routed differently\n", request.path);
+      return 1;
+    }
+  }
+
+  fmt::print("{} express routes, {} table entries, longest probe {}\n",
+             express_routes.size(), table.size(), table.max_probe());
+  fmt::print("{} calls each\n\n", iterations);
+
+  for (auto &request : mix) {
+    auto label = fmt::format(
+        "{} {}/{}", request.method == route_method_enum::get ? "GET" : "PUT",
+        request.device_type, request.action);
+    run(fmt::format("regex  {}", label), iterations / 10,
+        [&]() { return express_find(express_routes, request); });
+    run(fmt::format("table  {}", label), iterations, [&]() {
+      return *table.find(request.method, request.device_type, request.action);
+    });
+  }
+
+  fmt::print("\n");
+  size_t next = 0;
+  run("regex  mix", iterations / 10, [&]() {
+    return express_find(express_routes, mix[next++ % mix.size()]);
+  });
+  run("table  mix", iterations, [&]() {
+    auto &request = mix[next++ % mix.size()];
+    return *table.find(request.method, request.device_type, request.action);
+  });
+  run("split + table  mix", iterations,
+      [&]() { return split_and_find(table, mix[next++ % mix.size()]); });
+  return 0;
+}
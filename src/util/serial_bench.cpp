@@ -0,0 +1,214 @@
+// Measures what reading a serial reply costs on our side. The emulated AM5
+// from stubs/serial_emulators answers on a pseudo terminal and the same
+// command sweep is run through the old char-at-a-time blocking_reader,
+// through frame_reader and through a serial_channel_t on the shared
+// serial_reactor.
+//
+//   AlpacaHubSerialBench -n 5000
+//   AlpacaHubSerialBench -n 500 -byte-us 1040    (9600 baud pacing)
+//   AlpacaHubSerialBench -latency-us 2000 -jitter-us 3000 -drop 0.01
+//
+// Per reader it reports the round trip latency per command and the CPU time
+// this thread spent per command (user + sys), which is where the per-byte
+// syscalls and timer churn of the old reader show up.
+
+#include "common/alpaca_hub_serial.hpp"
+#include "common/serial_reactor.hpp"
+#include "stubs/serial_emulators/lx200_mount_emulator.hpp"
+#include "asio/steady_timer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <functional>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using bench_clock_t = std::chrono::steady_clock;
+
+// A copy of the reader the drivers used before frame_reader, kept here to
+// compare against. It runs the io_context once per character with a fresh
+// timer each time.
+class legacy_char_reader {
+  asio::serial_port &_port;
+  asio::io_context &_io_ctx;
+  asio::steady_timer _timer;
+  size_t _timeout;
+  char _c;
+  bool _read_error;
+
+public:
+  legacy_char_reader(asio::serial_port &port, size_t timeout,
+                     asio::io_context &io_ctx)
+      : _port(port), _io_ctx(io_ctx), _timer(port.get_executor()),
+        _timeout(timeout), _c('\0'), _read_error(true) {}
+
+  bool read_char(char &val) {
+    val = _c = '\0';
+    _io_ctx.restart();
+    _port.async_read_some(
+        asio::buffer(&_c, 1),
+        [this](const asio::error_code &error, size_t) {
+          _read_error = bool(error);
+          if (!error)
+            _timer.cancel();
+        });
+    _timer.expires_after(std::chrono::milliseconds(_timeout));
+    _timer.async_wait([this](const asio::error_code &error) {
+      if (!error)
+        _port.cancel();
+    });
+    _io_ctx.run();
+
+    if (!_read_error)
+      val = _c;
+    return !_read_error;
+  }
+};
+
+static double thread_cpu_us() {
+  rusage usage;
+  ::getrusage(RUSAGE_THREAD, &usage);
+  return usage.ru_utime.tv_sec * 1e6 + usage.ru_utime.tv_usec +
+         usage.ru_stime.tv_sec * 1e6 + usage.ru_stime.tv_usec;
+}
+
+static void print_stats(const std::string &name, std::vector<double> values,
+                        double cpu_us) {
+  std::sort(values.begin(), values.end());
+  double total = 0;
+  for (auto v : values)
+    total += v;
+  auto percentile = [&values](double p) {
+    return values[std::min(values.size() - 1, size_t(p * values.size()))];
+  };
+  fmt::print("{:<14} mean: {:>8.1f}us  p50: {:>8.1f}us  p99: {:>8.1f}us  "
+             "max: {:>8.1f}us  cpu/cmd: {:>6.1f}us\n",
+             name, total / values.size(), percentile(0.5), percentile(0.99),
+             values.back(), cpu_us / values.size());
+}
+
+static const std::vector<std::string> sweep = {":GR#", ":GD#", ":GS#",
+                                               ":GV#"};
+
+// transact writes cmd and returns the reply
+static void
+run(const std::string &name, int commands,
+    const std::function<std::string(const std::string &)> &transact) {
+  std::vector<double> latencies;
+  latencies.reserve(commands);
+  int bad_replies = 0;
+
+  auto cpu_start = thread_cpu_us();
+  for (int i = 0; i < commands; i++) {
+    auto &cmd = sweep[i % sweep.size()];
+    auto start = bench_clock_t::now();
+    auto rsp = transact(cmd);
+    latencies.push_back(std::chrono::duration<double, std::micro>(
+                            bench_clock_t::now() - start)
+                            .count());
+    if (rsp.empty() || rsp.back() != '#')
+      bad_replies++;
+  }
+  print_stats(name, latencies, thread_cpu_us() - cpu_start);
+  if (bad_replies)
+    fmt::print("  {} bad replies\n", bad_replies);
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-n commands] [-byte-us microseconds] "
+             "[-latency-us microseconds] [-jitter-us microseconds] "
+             "[-drop probability]\n",
+             name);
+}
+
+int main(int argc, char **argv) {
+  int commands = 2000;
+  emulator_link_config_t link;
+  spdlog::set_level(spdlog::level::warn);
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    } else if (i + 1 < argc) {
+      std::string arg_v = argv[++i];
+      if (arg == "-n")
+        commands = std::stoi(arg_v);
+      else if (arg == "-byte-us")
+        link.byte_time = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-latency-us")
+        link.reply_latency = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-jitter-us")
+        link.jitter = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-drop")
+        link.drop_probability = std::stod(arg_v);
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  serial_emulator_t mount(std::make_unique<lx200_mount_emulator_t>(
+                              lx200_mount_emulator_t::flavour_enum::am5),
+                          link);
+
+  asio::io_context io_ctx;
+  asio::serial_port port(io_ctx);
+  port.open(mount.device_path());
+
+  fmt::print("{} commands per reader, {}us per reply byte, {}us + up to {}us "
+             "reply latency, {:.1f}% dropped\n\n",
+             commands, link.byte_time.count(), link.reply_latency.count(),
+             link.jitter.count(), link.drop_probability * 100);
+
+  legacy_char_reader legacy(port, 250, io_ctx);
+  run("blocking_reader", commands, [&legacy, &port](const std::string &cmd) {
+    port.write_some(asio::buffer(cmd));
+    std::string rsp;
+    char c;
+    while (legacy.read_char(c)) {
+      rsp += c;
+      if (c == '#')
+        break;
+    }
+    return rsp;
+  });
+
+  alpaca_hub_serial::frame_reader reader(port, io_ctx);
+  run("frame_reader", commands, [&reader, &port](const std::string &cmd) {
+    using namespace std::chrono_literals;
+    port.write_some(asio::buffer(cmd));
+    std::string_view frame;
+    reader.read_until("#", 250ms, frame, cmd);
+    return std::string(frame);
+  });
+  port.close();
+
+  // The reactor's threads do the I/O here, so this thread's CPU time is
+  // just the handoff. Compare the latencies.
+  auto channel = alpaca_hub_serial::serial_reactor::instance().make_channel();
+  channel->open(mount.device_path(), 9600);
+  run("serial_channel", commands, [&channel](const std::string &cmd) {
+    return channel
+        ->transact({cmd, alpaca_hub_serial::ends_with_any("#"),
+                    std::chrono::milliseconds(250)})
+        .frame;
+  });
+
+  channel->close();
+  mount.stop();
+
+  auto stats = mount.stats();
+  fmt::print("\n{}: {} commands, {} replies, {} dropped, {} bytes in, {} "
+             "bytes out\n",
+             mount.name(), stats.commands, stats.replies, stats.dropped,
+             stats.bytes_in, stats.bytes_out);
+  return 0;
+}
@@ -5,29 +5,24 @@
 asio::io_context _io_context;
 char stop_on_char = '\n';
 
-std::string send_command_to_mount(const std::string &cmd, asio::serial_port &_serial_port) {
+std::string send_command_to_mount(const std::string &cmd,
+                                  asio::serial_port &_serial_port,
+                                  alpaca_hub_serial::frame_reader &reader) {
  
    try {
+    using namespace std::chrono_literals;
     spdlog::trace("sending: {} to mount", cmd);
-    char buf[512] = {0};
     _serial_port.write_some(asio::buffer(cmd));
 
-    std::string rsp;
+    std::string_view rsp;
 
       // TODO: we may need to make the read timeout configurable here
-      alpaca_hub_serial::blocking_reader reader(cmd, _serial_port, 250,
-                                                _io_context);
-      char c;
-      while (reader.read_char(c)) {
-        rsp += c;
-        if (c == stop_on_char || stop_on_char == '\0' || c == '#') {
-          break;
-        }
-      }
+      const char terminators[] = {stop_on_char, '#'};
+      reader.read_until(std::string_view(terminators, 2), 250ms, rsp, cmd);
     
 
     std::cout << "mount returned: " << rsp << std::endl;
-    return rsp;
+    return std::string(rsp);
 
   } catch (std::exception &ex) {
     throw alpaca_exception(
@@ -53,9 +48,11 @@ int main(int argc, char **argv) {
   _serial_port.set_option(asio::serial_port_base::stop_bits(
       asio::serial_port_base::stop_bits::one));
 
+  alpaca_hub_serial::frame_reader reader(_serial_port, _io_context);
+
   std::string command;
   while (std::getline(std::cin, command)) {
-    std::string rsp = send_command_to_mount(command, _serial_port);
+    std::string rsp = send_command_to_mount(command, _serial_port, reader);
   }
 
   return 0;
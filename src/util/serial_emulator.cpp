@@ -0,0 +1,123 @@
+// Puts emulated serial devices on pseudo terminals so AlpacaHub can be run
+// without the hardware. Point the driver's serial device setting at the path
+// printed for each one.
+//
+//   AlpacaHubEmulator am5 ppba esatto-arco
+//   AlpacaHubEmulator -byte-us 1040 -latency-us 2000 -drop 0.01 onstep
+//
+// Devices: am5, onstep, ppba, focuscube3, esatto, esatto-arco, qhycfw. It
+// runs until interrupted and then prints what each device saw.
+
+#include "stubs/serial_emulators/lx200_mount_emulator.hpp"
+#include "stubs/serial_emulators/pegasus_emulator.hpp"
+#include "stubs/serial_emulators/primaluce_emulator.hpp"
+#include "stubs/serial_emulators/qhy_cfw_emulator.hpp"
+#include <chrono>
+#include <csignal>
+#include <fmt/format.h>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
+
+static std::unique_ptr<emulated_firmware_t>
+make_firmware(const std::string &device) {
+  if (device == "am5")
+    return std::make_unique<lx200_mount_emulator_t>(
+        lx200_mount_emulator_t::flavour_enum::am5);
+  if (device == "onstep")
+    return std::make_unique<lx200_mount_emulator_t>(
+        lx200_mount_emulator_t::flavour_enum::onstep);
+  if (device == "ppba")
+    return std::make_unique<ppba_emulator_t>();
+  if (device == "focuscube3")
+    return std::make_unique<focuscube3_emulator_t>();
+  if (device == "esatto")
+    return std::make_unique<esatto_emulator_t>(false);
+  if (device == "esatto-arco")
+    return std::make_unique<esatto_emulator_t>(true);
+  if (device == "qhycfw")
+    return std::make_unique<qhy_cfw_emulator_t>();
+  return nullptr;
+}
+
+static void usage(const char *name) {
+  fmt::print("usage: {} [-byte-us microseconds] [-latency-us microseconds] "
+             "[-jitter-us microseconds] [-drop probability] device...\n"
+             "devices: am5 onstep ppba focuscube3 esatto esatto-arco "
+             "qhycfw\n",
+             name);
+}
+
+int main(int argc, char **argv) {
+  emulator_link_config_t link;
+  std::vector<std::string> devices;
+  spdlog::set_level(spdlog::level::info);
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      devices.push_back(arg);
+    } else if (i + 1 < argc) {
+      std::string arg_v = argv[++i];
+      if (arg == "-byte-us")
+        link.byte_time = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-latency-us")
+        link.reply_latency = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-jitter-us")
+        link.jitter = std::chrono::microseconds(std::stoi(arg_v));
+      else if (arg == "-drop")
+        link.drop_probability = std::stod(arg_v);
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (devices.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Blocked before the emulator threads start so they inherit the mask and
+  // the signal only ever turns up in the sigwait below
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  std::vector<std::unique_ptr<serial_emulator_t>> emulators;
+  for (auto &device : devices) {
+    auto firmware = make_firmware(device);
+    if (!firmware) {
+      fmt::print("unknown device: {}\n", device);
+      usage(argv[0]);
+      return 1;
+    }
+    emulators.push_back(
+        std::make_unique<serial_emulator_t>(std::move(firmware), link));
+    fmt::print("{:<12} {}\n", device, emulators.back()->device_path());
+  }
+
+  int signal = 0;
+  sigwait(&signals, &signal);
+
+  fmt::print("\n");
+  for (auto &emulator : emulators) {
+    emulator->stop();
+    auto stats = emulator->stats();
+    fmt::print("{}: {} commands, {} replies, {} dropped, {} bytes in, {} "
+               "bytes out\n",
+               emulator->name(), stats.commands, stats.replies,
+               stats.dropped, stats.bytes_in, stats.bytes_out);
+  }
+  return 0;
+}